@@ -55,6 +55,38 @@ JNIEXPORT jbyteArray JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_ReadRegister
 JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_WriteRegister
   (JNIEnv *, jobject, jint, jbyteArray);
 
+/*
+ * Class:     com_atmel_Maxtouch_MaxtouchJni
+ * Method:    GetMessagesDirect
+ * Signature: (Ljava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_GetMessagesDirect
+  (JNIEnv *, jobject, jobject);
+
+/*
+ * Class:     com_atmel_Maxtouch_MaxtouchJni
+ * Method:    WaitMessagesDirect
+ * Signature: (Ljava/nio/ByteBuffer;I)I
+ */
+JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_WaitMessagesDirect
+  (JNIEnv *, jobject, jobject, jint);
+
+/*
+ * Class:     com_atmel_Maxtouch_MaxtouchJni
+ * Method:    ReadRegisterDirect
+ * Signature: (IILjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_ReadRegisterDirect
+  (JNIEnv *, jobject, jint, jint, jobject);
+
+/*
+ * Class:     com_atmel_Maxtouch_MaxtouchJni
+ * Method:    WriteRegisterDirect
+ * Signature: (IILjava/nio/ByteBuffer;)I
+ */
+JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_WriteRegisterDirect
+  (JNIEnv *, jobject, jint, jint, jobject);
+
 /*
  * Class:     com_atmel_Maxtouch_MaxtouchJni
  * Method:    SetDebugEnable
@@ -111,6 +143,22 @@ JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_ResetChip
 JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_CalibrateChip
   (JNIEnv *, jobject);
 
+/*
+ * Class:     com_atmel_Maxtouch_MaxtouchJni
+ * Method:    GetIoStats
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_GetIoStats
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     com_atmel_Maxtouch_MaxtouchJni
+ * Method:    ResetIoStats
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_ResetIoStats
+  (JNIEnv *, jobject);
+
 #ifdef __cplusplus
 }
 #endif
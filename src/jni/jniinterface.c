@@ -27,6 +27,7 @@
 // EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //------------------------------------------------------------------------------
 
+#include <stdio.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -146,6 +147,68 @@ JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_WriteRegister
   return ret;
 }
 
+//******************************************************************************
+/// \brief  Get address and size of a direct ByteBuffer
+/// \return #mxt_rc
+static int jni_direct_buffer(JNIEnv *env, jobject buffer, uint8_t **addr,
+                             size_t *capacity)
+{
+  jlong size;
+
+  if (!buffer)
+    return MXT_ERROR_BAD_INPUT;
+
+  *addr = (*env)->GetDirectBufferAddress(env, buffer);
+  size = (*env)->GetDirectBufferCapacity(env, buffer);
+
+  /* Heap ByteBuffers have no fixed native address */
+  if (!*addr || size < 0)
+    return MXT_ERROR_BAD_INPUT;
+
+  *capacity = size;
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Read registers from MXT chip into a direct ByteBuffer
+/// \return Zero on success, or negative #mxt_rc
+JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_ReadRegisterDirect
+  (JNIEnv *env, jobject this, jint start_register, jint count, jobject buffer)
+{
+  uint8_t *buf;
+  size_t capacity;
+  int ret;
+
+  ret = jni_direct_buffer(env, buffer, &buf, &capacity);
+  if (ret == MXT_SUCCESS && (count < 0 || (size_t)count > capacity))
+    ret = MXT_ERROR_BAD_INPUT;
+
+  if (ret == MXT_SUCCESS)
+    ret = mxt_read_register(mxt, buf, start_register, count);
+
+  return -ret;
+}
+
+//******************************************************************************
+/// \brief  Write registers to MXT chip from a direct ByteBuffer
+/// \return Zero on success, or negative #mxt_rc
+JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_WriteRegisterDirect
+  (JNIEnv *env, jobject this, jint start_register, jint count, jobject buffer)
+{
+  uint8_t *buf;
+  size_t capacity;
+  int ret;
+
+  ret = jni_direct_buffer(env, buffer, &buf, &capacity);
+  if (ret == MXT_SUCCESS && (count < 0 || (size_t)count > capacity))
+    ret = MXT_ERROR_BAD_INPUT;
+
+  if (ret == MXT_SUCCESS)
+    ret = mxt_write_register(mxt, buf, start_register, count);
+
+  return -ret;
+}
+
 //******************************************************************************
 /// \brief Enable/disable debug output
 JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_SetDebugEnable
@@ -211,8 +274,17 @@ JNIEXPORT jobjectArray JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_GetDebugMessa
   jobjectArray stringarray;
   jclass stringClass;
   char *szMessage;
+  uint8_t *records;
+  int record_size;
+  char msg_string[255];
+
+  /* Format records in place where the driver has already buffered them */
+  ret = mxt_get_msgs_view(mxt, &records, &record_size, &count);
+  if (ret == MXT_ERROR_NOT_SUPPORTED) {
+    records = NULL;
+    ret = mxt_get_msg_count(mxt, &count);
+  }
 
-  ret = mxt_get_msg_count(mxt, &count);
   /* suppress error and return empty array */
   if (ret)
     count = 0;
@@ -226,7 +298,15 @@ JNIEXPORT jobjectArray JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_GetDebugMessa
   {
     for (i = 0; i < count; i++)
     {
-      szMessage = mxt_get_msg_string(mxt);
+      if (records) {
+        mxt_format_msg_hex(msg_string, sizeof(msg_string),
+                           records + i * record_size, record_size);
+
+        szMessage = msg_string;
+      } else {
+        szMessage = mxt_get_msg_string(mxt);
+      }
+
       (*env)->SetObjectArrayElement(env, stringarray, i,
                                     (*env)->NewStringUTF(env, szMessage));
     }
@@ -235,6 +315,96 @@ JNIEXPORT jobjectArray JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_GetDebugMessa
   return stringarray;
 }
 
+//******************************************************************************
+/// \brief  Pack pending T5 messages into a buffer, each record as a length
+///         byte followed by the message bytes
+/// \return #mxt_rc
+static int jni_pack_msgs(uint8_t *buf, size_t capacity, int *count)
+{
+  struct mxt_msg msgs[MXT_MSG_BATCH_SIZE];
+  int max_msgs, n, i;
+  size_t ofs = 0;
+  int ret;
+
+  /* Leave any messages which might not fit pending for the next call */
+  max_msgs = capacity / (1 + MXT_MSG_MAX_SIZE);
+  if (max_msgs > MXT_MSG_BATCH_SIZE)
+    max_msgs = MXT_MSG_BATCH_SIZE;
+
+  *count = 0;
+  if (max_msgs == 0)
+    return MXT_ERROR_BAD_INPUT;
+
+  ret = mxt_get_msgs_batch(mxt, msgs, max_msgs, &n);
+  if (ret)
+    return ret;
+
+  for (i = 0; i < n; i++) {
+    buf[ofs++] = msgs[i].size;
+    memcpy(buf + ofs, msgs[i].data, msgs[i].size);
+    ofs += msgs[i].size;
+  }
+
+  *count = n;
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Get pending T5 messages as packed binary records in a direct
+///         ByteBuffer, see jni_pack_msgs()
+/// \return Number of records, or negative #mxt_rc
+JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_GetMessagesDirect
+  (JNIEnv *env, jobject this, jobject buffer)
+{
+  uint8_t *buf;
+  size_t capacity;
+  int count = 0;
+  int ret;
+
+  ret = jni_direct_buffer(env, buffer, &buf, &capacity);
+  if (ret == MXT_SUCCESS)
+    ret = jni_pack_msgs(buf, capacity, &count);
+
+  return ret ? -ret : count;
+}
+
+//******************************************************************************
+/// \brief  Block until T5 messages arrive, then return them as for
+///         GetMessagesDirect
+/// \param  timeout_ms  Time to wait, or negative to wait indefinitely
+/// \return Number of records, zero on timeout, or negative #mxt_rc
+JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_WaitMessagesDirect
+  (JNIEnv *env, jobject this, jobject buffer, jint timeout_ms)
+{
+  uint8_t *buf;
+  size_t capacity;
+  uint64_t deadline = mxt_io_time_us() + (uint64_t)timeout_ms * 1000;
+  int count = 0;
+  int ret;
+
+  ret = jni_direct_buffer(env, buffer, &buf, &capacity);
+  if (ret)
+    return -ret;
+
+  do {
+    /* Only read the device when the wait source shows activity */
+    ret = mxt_msg_wait(mxt, MXT_MSG_POLL_DELAY_MS);
+    if (ret == MXT_ERROR_TIMEOUT)
+      continue;
+    else if (ret)
+      return -ret;
+
+    ret = jni_pack_msgs(buf, capacity, &count);
+    if (ret)
+      return -ret;
+
+    if (count > 0)
+      return count;
+  } while (timeout_ms < 0 || mxt_io_time_us() < deadline);
+
+  return 0;
+}
+
 //******************************************************************************
 /// \brief  Get location of interface in sysfs
 /// \return directory path
@@ -281,3 +451,55 @@ JNIEXPORT jint JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_CalibrateChip
 {
   return mxt_calibrate_chip(mxt);
 }
+
+//******************************************************************************
+/// \brief  Get bus transaction statistics
+/// \return Array of counters. For each of read, write and message in turn:
+///         transactions, bytes, errors, timeouts, total us, max us and the
+///         MXT_IO_HIST_BUCKETS latency buckets. Then retries and bus errors.
+JNIEXPORT jlongArray JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_GetIoStats
+  (JNIEnv *env, jobject this)
+{
+  struct mxt_io_stats stats;
+  struct mxt_io_op_stats *s;
+  jlong values[MXT_IO_OP_COUNT * (6 + MXT_IO_HIST_BUCKETS) + 2];
+  jlongArray array;
+  int op, i;
+  int n = 0;
+
+  if (!mxt)
+    return NULL;
+
+  mxt_get_io_stats(mxt, &stats);
+
+  for (op = 0; op < MXT_IO_OP_COUNT; op++) {
+    s = &stats.ops[op];
+    values[n++] = s->transactions;
+    values[n++] = s->bytes;
+    values[n++] = s->errors;
+    values[n++] = s->timeouts;
+    values[n++] = s->total_us;
+    values[n++] = s->max_us;
+
+    for (i = 0; i < MXT_IO_HIST_BUCKETS; i++)
+      values[n++] = s->hist[i];
+  }
+
+  values[n++] = stats.retries;
+  values[n++] = stats.bus_errors;
+
+  array = (*env)->NewLongArray(env, n);
+  if (array)
+    (*env)->SetLongArrayRegion(env, array, 0, n, values);
+
+  return array;
+}
+
+//******************************************************************************
+/// \brief  Clear bus transaction statistics
+JNIEXPORT void JNICALL Java_com_atmel_Maxtouch_MaxtouchJni_ResetIoStats
+  (JNIEnv *env, jobject this)
+{
+  if (mxt)
+    mxt_reset_io_stats(mxt);
+}
@@ -6,15 +6,24 @@ LOCAL_CFLAGS += -DMXT_VERSION=\"$(GIT_VERSION)\"
 LOCAL_SRC_FILES := \
   libmaxtouch.c \
   log.c \
+  capture.c \
+  io_stats.c \
+  scan_cache.c \
   msg.c \
+  msg_decode.c \
   config.c \
+  config_image.c \
+  config_image.c \
   utilfuncs.c \
   info_block.c \
+  crc.c \
   sysfs/sysfs_device.c \
   sysfs/dmesg.c \
   i2c_dev/i2c_dev_device.c \
   debugfs/debugfs_device.c \
-  hidraw/hidraw_device.c
+  hidraw/hidraw_device.c \
+  mock/mock_device.c \
+  gpio/gpio_chg.c
 LOCAL_MODULE := maxtouch
 
 ifneq ($(MXTAPP_NO_USB_SUPPORT),true)
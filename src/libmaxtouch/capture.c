@@ -0,0 +1,240 @@
+//------------------------------------------------------------------------------
+/// \file   capture.c
+/// \brief  Delta coded capture frames
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "libmaxtouch.h"
+#include "capture.h"
+
+//******************************************************************************
+/// \brief Append one varint token
+static uint8_t *capture_put_token(uint8_t *out, uint32_t token)
+{
+  while (token >= 0x80) {
+    *out++ = (token & 0x7F) | 0x80;
+    token >>= 7;
+  }
+
+  *out++ = token;
+
+  return out;
+}
+
+//******************************************************************************
+/// \brief Code a frame of values
+/// \param  prev  Previous frame, or NULL to code a keyframe
+/// \param  out  At least MXT_CAPTURE_CODED_MAX(count) bytes
+/// \return Number of bytes written to out
+size_t mxt_capture_encode(const uint16_t *values, const uint16_t *prev,
+                          int count, uint8_t *out)
+{
+  uint8_t *p = out;
+  uint32_t run = 0;
+  uint16_t ref = 0;
+  int16_t diff;
+  uint32_t zz;
+  int i;
+
+  for (i = 0; i < count; i++) {
+    if (prev)
+      ref = prev[i];
+
+    diff = (int16_t)(values[i] - ref);
+
+    if (!prev)
+      ref = values[i];
+
+    if (diff == 0) {
+      run++;
+      continue;
+    }
+
+    if (run) {
+      p = capture_put_token(p, (run << 1) | 1);
+      run = 0;
+    }
+
+    /* Zig-zag folds the sign into the lowest bit, in unsigned arithmetic
+     * since shifting a negative value is undefined */
+    zz = (((uint32_t)(uint16_t)diff << 1) ^ (uint32_t)-(diff < 0)) & 0xFFFF;
+    p = capture_put_token(p, zz << 1);
+  }
+
+  if (run)
+    p = capture_put_token(p, (run << 1) | 1);
+
+  return p - out;
+}
+
+//******************************************************************************
+/// \brief Decode a frame of values
+/// \param  values  Previous frame, replaced by the decoded frame. Unused for a
+///                 keyframe
+/// \return #mxt_rc
+int mxt_capture_decode(const uint8_t *in, size_t size, bool keyframe,
+                       uint16_t *values, int count)
+{
+  const uint8_t *end = in + size;
+  uint32_t token, run;
+  uint16_t ref = 0;
+  uint16_t zz;
+  int shift;
+  int i = 0;
+
+  while (in < end) {
+    token = 0;
+    shift = 0;
+    do {
+      if (in >= end || shift > 21)
+        return MXT_ERROR_FILE_FORMAT;
+
+      token |= (uint32_t)(*in & 0x7F) << shift;
+      shift += 7;
+    } while (*in++ & 0x80);
+
+    if (token & 1) {
+      run = token >> 1;
+      if (run > (uint32_t)(count - i))
+        return MXT_ERROR_FILE_FORMAT;
+
+      for (; run; run--, i++)
+        values[i] = keyframe ? ref : values[i];
+    } else {
+      if (i >= count)
+        return MXT_ERROR_FILE_FORMAT;
+
+      zz = token >> 1;
+      if (!keyframe)
+        ref = values[i];
+
+      ref += (int16_t)((zz >> 1) ^ -(zz & 1));
+      values[i++] = ref;
+    }
+  }
+
+  if (i != count)
+    return MXT_ERROR_FILE_FORMAT;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Decode the record at *ofs and move *ofs on to the next record
+/// \param  values  Previous frame, replaced by the decoded frame
+/// \return #mxt_rc, MXT_ERROR_NO_MESSAGE at the end of the records
+int mxt_capture_next_frame(const uint8_t *buf, size_t len, size_t *ofs,
+                           uint16_t *values, int count,
+                           struct mxt_capture_delta_record *rec)
+{
+  const struct mxt_capture_trailer *trailer;
+  size_t end = len;
+  int ret;
+
+  /* Records stop at the index where there is one */
+  if (len >= sizeof(*trailer)) {
+    trailer = (const struct mxt_capture_trailer *)(buf + len - sizeof(*trailer));
+    if (!memcmp(trailer->magic, MXT_CAPTURE_INDEX_MAGIC, sizeof(trailer->magic))
+        && trailer->index_offset <= len)
+      end = trailer->index_offset;
+  }
+
+  if (*ofs + sizeof(*rec) > end)
+    return MXT_ERROR_NO_MESSAGE;
+
+  memcpy(rec, buf + *ofs, sizeof(*rec));
+  if (*ofs + sizeof(*rec) + rec->size > end)
+    return MXT_ERROR_FILE_FORMAT;
+
+  ret = mxt_capture_decode(buf + *ofs + sizeof(*rec), rec->size, rec->keyframe,
+                           values, count);
+  if (ret)
+    return ret;
+
+  *ofs += sizeof(*rec) + rec->size;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Decode the given record of a delta coded capture held in memory,
+///         starting from the keyframe before it found in the index
+/// \param  buf  Whole capture file, for example mapped with mmap()
+/// \param  record  Record number, counting from 0
+/// \return #mxt_rc
+int mxt_capture_seek_frame(const uint8_t *buf, size_t len, uint32_t record,
+                           uint16_t *values, int count,
+                           struct mxt_capture_delta_record *rec)
+{
+  const struct mxt_capture_trailer *trailer;
+  struct mxt_capture_index_entry entry;
+  uint32_t lo, hi, mid, n;
+  size_t ofs;
+  int ret;
+
+  if (len < sizeof(*trailer))
+    return MXT_ERROR_FILE_FORMAT;
+
+  trailer = (const struct mxt_capture_trailer *)(buf + len - sizeof(*trailer));
+  if (memcmp(trailer->magic, MXT_CAPTURE_INDEX_MAGIC, sizeof(trailer->magic))
+      || trailer->index_count == 0
+      || trailer->index_offset + (uint64_t)trailer->index_count * sizeof(entry)
+         > len - sizeof(*trailer))
+    return MXT_ERROR_FILE_FORMAT;
+
+  if (record >= trailer->record_count)
+    return MXT_ERROR_BAD_INPUT;
+
+  /* Last keyframe at or before the record */
+  lo = 0;
+  hi = trailer->index_count;
+  while (hi - lo > 1) {
+    mid = lo + (hi - lo) / 2;
+    memcpy(&entry, buf + trailer->index_offset + mid * sizeof(entry),
+           sizeof(entry));
+    if (entry.record <= record)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  memcpy(&entry, buf + trailer->index_offset + lo * sizeof(entry),
+         sizeof(entry));
+  if (entry.record > record)
+    return MXT_ERROR_FILE_FORMAT;
+
+  ofs = entry.offset;
+  for (n = entry.record; n <= record; n++) {
+    ret = mxt_capture_next_frame(buf, len, &ofs, values, count, rec);
+    if (ret)
+      return (ret == MXT_ERROR_NO_MESSAGE) ? MXT_ERROR_FILE_FORMAT : ret;
+  }
+
+  return MXT_SUCCESS;
+}
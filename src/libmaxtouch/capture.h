@@ -0,0 +1,134 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   capture.h
+/// \brief  Binary diagnostic data capture file format
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Binary capture file, see struct mxt_capture_header */
+#define MXT_CAPTURE_MAGIC         "MXTCAP01"
+#define MXT_CAPTURE_VERSION       1
+/* Delta coded frames, see struct mxt_capture_delta_record */
+#define MXT_CAPTURE_VERSION_DELTA 2
+#define MXT_CAPTURE_SELF_CAP      (1 << 0)
+#define MXT_CAPTURE_ACTIVE_STYLUS (1 << 1)
+#define MXT_CAPTURE_T15_KEYARRAY  (1 << 2)
+/* Record timestamps are CLOCK_MONOTONIC nanoseconds, see
+ * struct mxt_capture_clock. Otherwise wall clock microseconds. */
+#define MXT_CAPTURE_MONOTONIC     (1 << 3)
+
+//******************************************************************************
+/// \brief Binary capture file header
+///
+/// Followed by the raw info block (info_size bytes), then one byte per pass
+/// giving the key count when MXT_CAPTURE_T15_KEYARRAY is set, then one
+/// record_size record per frame. All fields are in host byte order.
+///
+/// With MXT_CAPTURE_MONOTONIC, struct mxt_capture_clock follows the header
+/// and is included in header_size.
+///
+/// With MXT_CAPTURE_VERSION_DELTA, record_size is 0 and each frame is a
+/// struct mxt_capture_delta_record. The file ends with the keyframe index
+/// and struct mxt_capture_trailer.
+struct mxt_capture_header {
+  char magic[8];
+  uint16_t version;
+  uint16_t header_size;
+  uint8_t mode;
+  uint8_t flags;
+  uint16_t x_size;
+  uint16_t y_size;
+  uint16_t passes;
+  uint16_t value_count;
+  uint16_t info_size;
+  uint32_t record_size;
+} __attribute__((packed));
+
+//******************************************************************************
+/// \brief Clock reference of a capture with MXT_CAPTURE_MONOTONIC
+///
+/// Wall clock and CLOCK_MONOTONIC time taken together at the start of the
+/// capture, so that record timestamps can be shown as time of day.
+struct mxt_capture_clock {
+  uint64_t wall_ns;
+  uint64_t monotonic_ns;
+} __attribute__((packed));
+
+//******************************************************************************
+/// \brief Binary capture frame record, followed by value_count int16 values
+struct mxt_capture_record {
+  uint32_t frame;
+  /* Time of the T37 read, see MXT_CAPTURE_MONOTONIC */
+  uint64_t timestamp;
+} __attribute__((packed));
+
+/* Trailer of a delta coded capture, see struct mxt_capture_trailer */
+#define MXT_CAPTURE_INDEX_MAGIC   "MXTIDX01"
+
+/* Largest coded size of count values */
+#define MXT_CAPTURE_CODED_MAX(count) ((size_t)(count) * 3)
+
+//******************************************************************************
+/// \brief Delta coded frame record, followed by size bytes of coded values
+///
+/// Values are coded as a sequence of varints, 7 bits per byte, least
+/// significant first. An even token is a zig-zag coded difference shifted
+/// left by one, an odd token a run of (token >> 1) zero differences. In a
+/// keyframe each value is coded against the previous value of the same frame,
+/// otherwise against the same value of the previous frame.
+struct mxt_capture_delta_record {
+  uint32_t frame;
+  uint64_t timestamp;
+  uint8_t keyframe;
+  uint32_t size;
+} __attribute__((packed));
+
+//******************************************************************************
+/// \brief Keyframe index entry of a delta coded capture
+struct mxt_capture_index_entry {
+  uint32_t record;
+  uint32_t frame;
+  uint64_t offset;
+} __attribute__((packed));
+
+//******************************************************************************
+/// \brief End of a delta coded capture, giving the file offset of the keyframe
+///        index so that a frame can be found without reading the whole file
+struct mxt_capture_trailer {
+  uint64_t index_offset;
+  uint32_t index_count;
+  uint32_t record_count;
+  uint32_t keyframe_interval;
+  char magic[8];
+} __attribute__((packed));
+
+size_t mxt_capture_encode(const uint16_t *values, const uint16_t *prev, int count, uint8_t *out);
+int mxt_capture_decode(const uint8_t *in, size_t size, bool keyframe, uint16_t *values, int count);
+int mxt_capture_next_frame(const uint8_t *buf, size_t len, size_t *ofs, uint16_t *values, int count, struct mxt_capture_delta_record *rec);
+int mxt_capture_seek_frame(const uint8_t *buf, size_t len, uint32_t record, uint16_t *values, int count, struct mxt_capture_delta_record *rec);
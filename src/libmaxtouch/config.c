@@ -34,20 +34,22 @@
 #include <string.h>
 #include <errno.h>
 #include <limits.h>
+#include <time.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "libmaxtouch.h"
 #include "info_block.h"
 #include "utilfuncs.h"
 #include "msg.h"
+#include "config_image.h"
 
-#define OBP_RAW_MAGIC      "OBP_RAW V1"
+/* Largest register write used when merging adjacent objects */
+#define MXT_CONFIG_SPAN_MAX 1024
 
-//******************************************************************************
-/// \brief Config file types
-enum mxt_config_type {
-  CONFIG_RAW,
-  CONFIG_XCFG
-};
+/* Unchanged bytes written rather than starting a new write in --diff */
+#define MXT_CONFIG_DIFF_GAP 4
 
 //******************************************************************************
 /// \brief Configuration data for a single object
@@ -57,6 +59,7 @@ struct mxt_object_config {
   uint32_t size;
   uint16_t start_position;
   uint8_t *data;
+  bool loaded;
   struct mxt_object_config *next;
 };
 
@@ -67,48 +70,8 @@ struct mxt_config {
   struct mxt_object_config *head;
   uint32_t info_crc;
   uint32_t config_crc;
-  enum mxt_config_type config_type;
 };
 
-//******************************************************************************
-/// \brief  Determines whether the object type is used for CRC checksum calculation
-/// \return True if used, false if not
-static bool is_type_used_for_crc(const uint32_t type)
-{
-  switch (type) {
-  case GEN_MESSAGEPROCESSOR_T5:
-  case GEN_COMMANDPROCESSOR_T6:
-  case DEBUG_DIAGNOSTIC_T37:
-  case SPT_USERDATA_T38:
-  case SPT_MESSAGECOUNT_T44:
-  case SERIAL_DATA_COMMAND_T68:
-  case SPT_MESSAGECOUNT_T144:
-    return false;
-
-  default:
-    return true;
-  }
-}
-
-//******************************************************************************
-/// \brief Some objects are volatile or read-only and should not be saved to config file
-static bool mxt_object_is_volatile(uint16_t object_type)
-{
-  switch (object_type) {
-  case DEBUG_DELTAS_T2:
-  case DEBUG_REFERENCES_T3:
-  case DEBUG_SIGNALS_T4:
-  case GEN_MESSAGEPROCESSOR_T5:
-  case GEN_COMMANDPROCESSOR_T6:
-  case SPT_MESSAGECOUNT_T44:
-  case GEN_DATASOURCE_T53:
-    return true;
-
-  default:
-    return false;
-  }
-}
-
 //******************************************************************************
 /// \brief Free memory associated with configuration
 static void mxt_free_config(struct mxt_config *cfg)
@@ -129,197 +92,294 @@ static void mxt_free_config(struct mxt_config *cfg)
 }
 
 //******************************************************************************
-/// \brief Write configuration for a single object
-static int mxt_write_object_config(struct mxt_device *mxt,
-                                   const struct mxt_object_config *objcfg)
+/// \brief Object configuration resolved to its location on the device
+struct mxt_config_write {
+  const struct mxt_object_config *objcfg;
+  uint16_t addr;
+  uint16_t num_bytes;
+  uint16_t device_size;
+  int order;
+};
+
+//******************************************************************************
+/// \brief Sort config writes by address, keeping file order for duplicates
+static int mxt_config_write_cmp(const void *a, const void *b)
 {
-  uint8_t obj_buf[MXT_OBJECT_SIZE_MAX];
+  const struct mxt_config_write *wa = a;
+  const struct mxt_config_write *wb = b;
+
+  if (wa->addr != wb->addr)
+    return (wa->addr < wb->addr) ? -1 : 1;
+
+  return wa->order - wb->order;
+}
+
+//******************************************************************************
+/// \brief Resolve object configs to device addresses, sorted by address
+/// \return #mxt_rc
+static int mxt_plan_config_writes(struct mxt_device *mxt,
+                                  struct mxt_config *cfg,
+                                  struct mxt_config_write **plan_out,
+                                  int *count_out)
+{
+  struct mxt_object_config *objcfg;
+  struct mxt_config_write *plan;
   uint16_t obj_addr;
   uint16_t device_size;
-  uint16_t num_bytes;
-  int ret;
+  int num_objcfgs = 0;
+  int count = 0;
 
-  if (mxt_object_is_volatile(objcfg->type))
-    return MXT_ERROR_OBJECT_IS_VOLATILE;
+  for (objcfg = cfg->head; objcfg; objcfg = objcfg->next)
+    num_objcfgs++;
 
-  obj_addr = mxt_get_object_address(mxt, objcfg->type, objcfg->instance);
-  if (obj_addr == OBJECT_NOT_FOUND)
-    return MXT_ERROR_OBJECT_NOT_FOUND;
+  plan = (struct mxt_config_write *)calloc(num_objcfgs ? num_objcfgs : 1,
+         sizeof(struct mxt_config_write));
+  if (!plan) {
+    mxt_err(mxt->ctx, "Failed to allocate memory");
+    return MXT_ERROR_NO_MEM;
+  }
 
-  /* Read object config. This is done to retain any device configuration
-   * remaining in trailing bytes not specified in the file. */
-  memset(obj_buf, 0, sizeof(obj_buf));
-  ret = mxt_read_register(mxt, obj_buf, obj_addr,
-                          mxt_get_object_size(mxt, objcfg->type));
-  if (ret)
-    return ret;
+  for (objcfg = cfg->head; objcfg; objcfg = objcfg->next) {
+    mxt_verb(mxt->ctx, "T%d instance %d size %d",
+             objcfg->type, objcfg->instance, objcfg->size);
 
-  device_size = mxt_get_object_size(mxt, objcfg->type);
-
-  if (device_size > objcfg->size) {
-    mxt_warn(mxt->ctx, "Extending config by %d bytes in T%u",
-             device_size - objcfg->size, objcfg->type);
-    num_bytes = objcfg->size;
-  } else if (objcfg->size > device_size) {
-    /* Either we are in fallback mode due to wrong
-     * config or config from a later fw version,
-     * or the file is corrupt or hand-edited */
-    mxt_warn(mxt->ctx, "Discarding %u bytes in T%u",
-             objcfg->size - device_size, objcfg->type);
-    num_bytes = device_size;
-  } else {
-    num_bytes = device_size;
-  }
+    if (mxt_object_is_volatile(objcfg->type)) {
+      mxt_warn(mxt->ctx, "Skipping volatile T%d", objcfg->type);
+      continue;
+    }
+
+    obj_addr = mxt_get_object_address(mxt, objcfg->type, objcfg->instance);
+    if (obj_addr == OBJECT_NOT_FOUND) {
+      mxt_warn(mxt->ctx, "T%d not present", objcfg->type);
+      continue;
+    }
 
-  /* Update bytes from config */
-  memcpy(obj_buf, objcfg->data, num_bytes);
+    device_size = MXT_SIZE(mxt->info.objects[mxt_get_object_table_num(mxt, objcfg->type)]);
+
+    plan[count].objcfg = objcfg;
+    plan[count].addr = obj_addr;
+    plan[count].device_size = device_size;
+    plan[count].order = count;
+
+    if (device_size > objcfg->size) {
+      mxt_warn(mxt->ctx, "Extending config by %d bytes in T%u",
+               device_size - objcfg->size, objcfg->type);
+      plan[count].num_bytes = objcfg->size;
+    } else if (objcfg->size > device_size) {
+      /* Either we are in fallback mode due to wrong
+       * config or config from a later fw version,
+       * or the file is corrupt or hand-edited */
+      mxt_warn(mxt->ctx, "Discarding %u bytes in T%u",
+               objcfg->size - device_size, objcfg->type);
+      plan[count].num_bytes = device_size;
+    } else {
+      plan[count].num_bytes = device_size;
+    }
 
-  /* Write object */
-  ret = mxt_write_register(mxt, obj_buf, obj_addr, num_bytes);
-  if (ret) {
-    mxt_err(mxt->ctx, "Config write error, ret=%d", ret);
-    return ret;
+    count++;
   }
 
+  qsort(plan, count, sizeof(struct mxt_config_write), mxt_config_write_cmp);
+
+  *plan_out = plan;
+  *count_out = count;
+
   return MXT_SUCCESS;
 }
 
 //******************************************************************************
-/// \brief Write configuration to chip
-static int mxt_write_device_config(struct mxt_device *mxt,
-                                   struct mxt_config *cfg)
+/// \brief Write planned objects, merging objects which are adjacent in the
+///        memory map into a single register write
+/// \return #mxt_rc
+static int mxt_write_config_spans(struct mxt_device *mxt,
+                                  const struct mxt_config_write *plan,
+                                  int count)
 {
-  struct mxt_object_config *objcfg = cfg->head;
+  uint8_t span_buf[MXT_CONFIG_SPAN_MAX];
+  const struct mxt_config_write *w;
+  uint16_t span_addr;
+  uint16_t len;
+  uint16_t gap;
+  int spans = 0;
+  int i = 0;
   int ret;
-  int err;
 
-  /* The Info Block CRC is calculated over mxt_id_info and the object table
-   * If it does not match then we are trying to load the configuration
-   * from a different chip or firmware version, so the configuration CRC
-   * is invalid anyway. */
-  if (cfg->info_crc && cfg->info_crc != mxt->info.crc)
-    mxt_warn(mxt->ctx, "Info Block CRC mismatch - device=0x%06X "
-             "file=0x%06X - attempting to apply config",
-             mxt->info.crc, cfg->info_crc);
-
-  mxt_info(mxt->ctx, "Writing config to chip");
-
-  while (objcfg) {
-    mxt_verb(mxt->ctx, "T%d instance %d size %d",
-             objcfg->type, objcfg->instance, objcfg->size);
+  while (i < count) {
+    span_addr = plan[i].addr;
+    len = 0;
 
-    if (mxt->conn->type == E_I2C_DEV)
-      mxt->mxt_crc.config_triggered = true;
+    for (;;) {
+      w = &plan[i];
+      memcpy(span_buf + len, w->objcfg->data, w->num_bytes);
+      len += w->num_bytes;
+      i++;
 
-    if (mxt->conn->type == E_SYSFS_SPI) {
-      err = sysfs_set_debug_irq(mxt, false);
-    }
-
-    ret = mxt_write_object_config(mxt, objcfg);
-    if (ret == MXT_ERROR_OBJECT_NOT_FOUND)
-      mxt_warn(mxt->ctx, "T%d not present", objcfg->type);
-    else if (ret == MXT_ERROR_OBJECT_IS_VOLATILE)
-      mxt_warn(mxt->ctx, "Skipping volatile T%d", objcfg->type);
-    else if (ret){
-      mxt->mxt_crc.config_triggered = false;
+      /* Next object must start where this one ends and fit in the span */
+      if (i >= count || plan[i].addr != w->addr + w->device_size
+          || plan[i].addr + plan[i].num_bytes - span_addr > MXT_CONFIG_SPAN_MAX)
+        break;
 
-    if (mxt->conn->type == E_SYSFS_SPI)
-      err = sysfs_set_debug_irq(mxt, true);
+      /* Bytes not given in the file are read back so that the device
+       * configuration in them is retained */
+      gap = w->device_size - w->num_bytes;
+      if (gap) {
+        ret = mxt_read_register(mxt, span_buf + len, w->addr + w->num_bytes, gap);
+        if (ret)
+          return ret;
 
-      if (mxt->conn->type == E_I2C_DEV  && mxt->debug_fs.enabled == true) {
-      	/* Allow messages to be read thru mxt-app */
-        err = debugfs_set_irq(mxt, true);
-      } else if (mxt->conn->type == E_SYSFS_I2C){
-        if (mxt->mxt_crc.crc_enabled == true)
-          err = sysfs_set_debug_irq(mxt, true);
+        len += gap;
       }
+    }
 
+    ret = mxt_write_register(mxt, span_buf, span_addr, len);
+    if (ret) {
+      mxt_err(mxt->ctx, "Config write error, ret=%d", ret);
       return ret;
     }
 
-    objcfg = objcfg->next;
+    spans++;
   }
-  
+
+  mxt_dbg(mxt->ctx, "Wrote %d objects in %d writes", count, spans);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Hold off message handling while configuration is transferred
+static void mxt_config_hold_irq(struct mxt_device *mxt)
+{
+  int err = 0;
+
+  if (mxt->conn->type == E_I2C_DEV)
+    mxt->mxt_crc.config_triggered = true;
+
+  if (mxt->conn->type == E_SYSFS_SPI)
+    err = sysfs_set_debug_irq(mxt, false);
+
+  if (err)
+    mxt_dbg(mxt->ctx, "Failed to disable debug_irq");
+
+  mxt_session_begin(mxt);
+}
+
+//******************************************************************************
+/// \brief Restore message handling after configuration transfer
+static void mxt_config_release_irq(struct mxt_device *mxt)
+{
+  int err = 0;
+
+  /* Sequence number is written back while IRQ is still held off */
+  mxt_session_end(mxt);
+
   mxt->mxt_crc.config_triggered = false;
-  
-  if (mxt->conn->type == E_I2C_DEV && mxt->debug_fs.enabled == true){
+
+  if (mxt->conn->type == E_I2C_DEV && mxt->debug_fs.enabled == true) {
+    /* Allow messages to be read thru mxt-app */
     err = debugfs_set_irq(mxt, true);
-  } else if (mxt->conn->type == E_SYSFS_I2C){
-      if (mxt->mxt_crc.crc_enabled == true)
-        err = sysfs_set_debug_irq(mxt, true);
+  } else if (mxt->conn->type == E_SYSFS_I2C) {
+    if (mxt->mxt_crc.crc_enabled == true)
+      err = sysfs_set_debug_irq(mxt, true);
+  } else if (mxt->conn->type == E_SYSFS_SPI) {
+    err = sysfs_set_debug_irq(mxt, true);
   }
 
-  if (mxt->conn->type == E_SYSFS_SPI)
-      err = sysfs_set_debug_irq(mxt, true);
+  if (err)
+    mxt_dbg(mxt->ctx, "Failed to restore IRQ");
+}
 
-  return MXT_SUCCESS;
+//******************************************************************************
+/// \brief Warn if the config file was not generated for this device
+static void mxt_check_info_crc(struct mxt_device *mxt, struct mxt_config *cfg)
+{
+  /* The Info Block CRC is calculated over mxt_id_info and the object table
+   * If it does not match then we are trying to load the configuration
+   * from a different chip or firmware version, so the configuration CRC
+   * is invalid anyway. */
+  if (cfg->info_crc && cfg->info_crc != mxt->info.crc)
+    mxt_warn(mxt->ctx, "Info Block CRC mismatch - device=0x%06X "
+             "file=0x%06X - attempting to apply config",
+             mxt->info.crc, cfg->info_crc);
 }
 
 //******************************************************************************
-/// \brief Read configuration from chip
-static int mxt_read_device_config(struct mxt_device *mxt,
-                                  struct mxt_config *cfg)
+/// \brief Write configuration to chip
+static int mxt_write_device_config(struct mxt_device *mxt,
+                                   struct mxt_config *cfg)
 {
-  int obj_idx, instance;
+  struct mxt_config_write *plan;
+  int count;
   int ret;
 
-  /* Copy ID information */
-  memcpy(&cfg->id, mxt->info.id, sizeof(struct mxt_id_info));
+  mxt_check_info_crc(mxt, cfg);
 
-  cfg->info_crc = mxt->info.crc;
+  ret = mxt_plan_config_writes(mxt, cfg, &plan, &count);
+  if (ret)
+    return ret;
 
-  cfg->config_crc = mxt_get_config_crc(mxt);
+  mxt_info(mxt->ctx, "Writing config to chip");
 
-  struct mxt_object_config **curr = &cfg->head;
+  /* Message handling is held off once for the whole config */
+  mxt_config_hold_irq(mxt);
 
-  for (obj_idx = 0; obj_idx < mxt->info.id->num_objects; obj_idx++) {
-    struct mxt_object object = mxt->info.objects[obj_idx];
+  ret = mxt_write_config_spans(mxt, plan, count);
 
-    if (mxt_object_is_volatile(object.type))
-      continue;
+  mxt_config_release_irq(mxt);
 
-    for (instance = 0; instance < MXT_INSTANCES(object); instance++) {
+  free(plan);
 
-      struct mxt_object_config *objcfg = calloc(1, sizeof(struct mxt_object_config));
-      if (!objcfg) {
-        ret = MXT_ERROR_NO_MEM;
-        goto free;
-      }
+  return ret;
+}
 
-      objcfg->type = object.type;
-      objcfg->size = MXT_SIZE(object);
-      objcfg->instance = instance;
-      objcfg->start_position = mxt_get_start_position(object, instance);
+//******************************************************************************
+/// \brief Read object data for a device configuration list, using a single
+///        register read for each run of objects which are adjacent in the
+///        memory map. Objects already loaded from the cache are skipped.
+/// \return #mxt_rc
+static int mxt_read_config_runs(struct mxt_device *mxt, struct mxt_config *cfg)
+{
+  struct mxt_object_config *first, *last, *objcfg;
+  uint8_t *buf;
+  size_t len;
+  int ret;
 
-      /* Malloc memory to store configuration */
-      objcfg->data = calloc(objcfg->size, sizeof(uint8_t));
-      if (!objcfg->data) {
-        free(objcfg);
-        mxt_err(mxt->ctx, "Failed to allocate memory");
-        ret = MXT_ERROR_NO_MEM;
-        goto free;
-      }
+  first = cfg->head;
+  while (first) {
+    if (first->loaded) {
+      first = first->next;
+      continue;
+    }
 
-      ret = mxt_read_register(mxt, objcfg->data,
-                              objcfg->start_position, objcfg->size);
-      if (ret) {
-        free(objcfg->data);
-        free(objcfg);
-        goto free;
-      }
+    last = first;
+    len = first->size;
 
-      *curr = objcfg;
-      curr = &objcfg->next;
+    while (last->next && !last->next->loaded
+           && last->next->start_position == last->start_position + last->size) {
+      last = last->next;
+      len += last->size;
     }
-  }
 
-  mxt_info(mxt->ctx, "Read config from device");
+    buf = (uint8_t *)malloc(len);
+    if (!buf) {
+      mxt_err(mxt->ctx, "Failed to allocate memory");
+      return MXT_ERROR_NO_MEM;
+    }
 
-  return MXT_SUCCESS;
+    ret = mxt_read_register(mxt, buf, first->start_position, len);
+    if (ret) {
+      free(buf);
+      return ret;
+    }
 
-free:
-  mxt_free_config(cfg);
-  return ret;
+    for (objcfg = first; objcfg != last->next; objcfg = objcfg->next)
+      memcpy(objcfg->data, buf + (objcfg->start_position - first->start_position),
+             objcfg->size);
+
+    free(buf);
+    first = last->next;
+  }
+
+  return MXT_SUCCESS;
 }
 
 //******************************************************************************
@@ -374,17 +434,188 @@ static int mxt_save_raw_file(struct libmaxtouch_ctx *ctx,
     if (ret < 0)
       goto fprintf_error;
 
-    objcfg = objcfg->next;
-  }
+    objcfg = objcfg->next;
+  }
+
+  fclose(fp);
+
+  return MXT_SUCCESS;
+
+fprintf_error:
+  fclose(fp);
+  return mxt_errno_to_rc(errno);
+}
+
+//******************************************************************************
+/// \brief Path of the device config snapshot for a config CRC
+static void mxt_config_cache_path(struct mxt_device *mxt, uint32_t config_crc,
+                                  char *path, size_t len)
+{
+  struct mxt_id_info *id = mxt->info.id;
+
+  snprintf(path, len, "%s/%02X%02X_%02X%02X_%06X_%06X.raw",
+           mxt->ctx->config_cache_dir, id->family, id->variant,
+           id->version, id->build, mxt->info.crc, config_crc);
+}
+
+//******************************************************************************
+/// \brief Fill the objects covered by the config CRC from a cached snapshot.
+///        The other objects, such as T38 user data, must still be read.
+/// \return #mxt_rc
+static int mxt_config_cache_fill(struct mxt_device *mxt, struct mxt_config *cfg)
+{
+  const struct mxt_config_image_object *obj;
+  struct mxt_config_image *image;
+  struct mxt_object_config *objcfg;
+  char path[PATH_MAX];
+  int ret;
+
+  mxt_config_cache_path(mxt, cfg->config_crc, path, sizeof(path));
+
+  if (access(path, R_OK)) {
+    mxt_dbg(mxt->ctx, "No cached config %s", path);
+    return mxt_errno_to_rc(errno);
+  }
+
+  ret = mxt_config_image_load(mxt->ctx, path, &image);
+  if (ret)
+    return ret;
+
+  if (memcmp(&image->id, mxt->info.id, offsetof(struct mxt_id_info, matrix_x_size))
+      || image->info_crc != mxt->info.crc
+      || image->config_crc != cfg->config_crc) {
+    mxt_warn(mxt->ctx, "Ignoring cached config %s, header does not match", path);
+    ret = MXT_ERROR_CHECKSUM_MISMATCH;
+    goto free;
+  }
+
+  /* Check every object is present before using any of them */
+  for (objcfg = cfg->head; objcfg; objcfg = objcfg->next) {
+    if (!mxt_object_used_for_crc(objcfg->type))
+      continue;
+
+    obj = mxt_config_image_find(image, objcfg->type, objcfg->instance);
+    if (!obj || obj->size != objcfg->size) {
+      mxt_warn(mxt->ctx, "Ignoring cached config %s, T%u does not match",
+               path, objcfg->type);
+      ret = MXT_ERROR_FILE_FORMAT;
+      goto free;
+    }
+  }
+
+  for (objcfg = cfg->head; objcfg; objcfg = objcfg->next) {
+    if (!mxt_object_used_for_crc(objcfg->type))
+      continue;
+
+    obj = mxt_config_image_find(image, objcfg->type, objcfg->instance);
+    memcpy(objcfg->data, obj->data, objcfg->size);
+    objcfg->loaded = true;
+  }
+
+  mxt_info(mxt->ctx, "Using cached config for CRC %06X", cfg->config_crc);
+  ret = MXT_SUCCESS;
+
+free:
+  mxt_config_image_free(image);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Store a device config snapshot, replacing the file atomically so
+///        that readers never see a partial snapshot
+static void mxt_config_cache_store(struct mxt_device *mxt, struct mxt_config *cfg)
+{
+  char path[PATH_MAX];
+  char tmp_path[PATH_MAX + 8];
+
+  if (mkdir(mxt->ctx->config_cache_dir, 0755) && errno != EEXIST) {
+    mxt_warn(mxt->ctx, "Could not create config cache %s: %s",
+             mxt->ctx->config_cache_dir, strerror(errno));
+    return;
+  }
+
+  mxt_config_cache_path(mxt, cfg->config_crc, path, sizeof(path));
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+  if (mxt_save_raw_file(mxt->ctx, tmp_path, cfg) || rename(tmp_path, path)) {
+    mxt_warn(mxt->ctx, "Could not update config cache %s", path);
+    unlink(tmp_path);
+    return;
+  }
+
+  mxt_dbg(mxt->ctx, "Cached config in %s", path);
+}
+
+//******************************************************************************
+/// \brief Read configuration from chip
+static int mxt_read_device_config(struct mxt_device *mxt,
+                                  struct mxt_config *cfg)
+{
+  int obj_idx, instance;
+  bool cached = false;
+  int ret;
+
+  /* Copy ID information */
+  memcpy(&cfg->id, mxt->info.id, sizeof(struct mxt_id_info));
+
+  cfg->info_crc = mxt->info.crc;
+
+  cfg->config_crc = mxt_get_config_crc(mxt);
+
+  struct mxt_object_config **curr = &cfg->head;
+
+  for (obj_idx = 0; obj_idx < mxt->info.id->num_objects; obj_idx++) {
+    struct mxt_object object = mxt->info.objects[obj_idx];
+
+    if (mxt_object_is_volatile(object.type))
+      continue;
+
+    for (instance = 0; instance < MXT_INSTANCES(object); instance++) {
+
+      struct mxt_object_config *objcfg = calloc(1, sizeof(struct mxt_object_config));
+      if (!objcfg) {
+        ret = MXT_ERROR_NO_MEM;
+        goto free;
+      }
+
+      objcfg->type = object.type;
+      objcfg->size = MXT_SIZE(object);
+      objcfg->instance = instance;
+      objcfg->start_position = mxt_get_start_position(object, instance);
+
+      /* Malloc memory to store configuration */
+      objcfg->data = calloc(objcfg->size, sizeof(uint8_t));
+      if (!objcfg->data) {
+        free(objcfg);
+        mxt_err(mxt->ctx, "Failed to allocate memory");
+        ret = MXT_ERROR_NO_MEM;
+        goto free;
+      }
+
+      *curr = objcfg;
+      curr = &objcfg->next;
+    }
+  }
+
+  /* The config CRC identifies the objects it covers, so a snapshot saved
+   * with the same CRC can stand in for most of the register reads */
+  if (mxt->ctx->config_cache_dir && cfg->config_crc)
+    cached = (mxt_config_cache_fill(mxt, cfg) == MXT_SUCCESS);
+
+  ret = mxt_read_config_runs(mxt, cfg);
+  if (ret)
+    goto free;
+
+  if (mxt->ctx->config_cache_dir && cfg->config_crc && !cached)
+    mxt_config_cache_store(mxt, cfg);
 
-  fclose(fp);
+  mxt_info(mxt->ctx, "Read config from device");
 
-  mxt_info(ctx, "Saved config to %s in OBP_RAW format", filename);
   return MXT_SUCCESS;
 
-fprintf_error:
-  fclose(fp);
-  return mxt_errno_to_rc(errno);
+free:
+  mxt_free_config(cfg);
+  return ret;
 }
 
 //******************************************************************************
@@ -467,8 +698,6 @@ static int mxt_save_xcfg_file(struct libmaxtouch_ctx *ctx,
 
   fclose(fp);
 
-  ret = MXT_SUCCESS;
-  mxt_info(ctx, "Saved config to %s in .xcfg format", filename);
   return MXT_SUCCESS;
 
 fprintf_error:
@@ -477,432 +706,262 @@ fprintf_error:
 }
 
 //******************************************************************************
-/// \brief  Load configuration from .xcfg file
+/// \brief  Copy a parsed config image into a configuration list
 /// \return #mxt_rc
-static int mxt_load_xcfg_file(struct libmaxtouch_ctx *ctx, const char *filename,
-                              struct mxt_config *cfg)
+static int mxt_config_from_image(struct libmaxtouch_ctx *ctx,
+                                 const struct mxt_config_image *image,
+                                 struct mxt_config *cfg)
 {
-  FILE *fp;
-  int c;
-  char object[255];
-  char tmp[255];
-  char *substr;
-  int object_id;
-  int instance;
-  int object_address;
-  int object_size;
-  int data;
-  int file_read = 0;
-  bool ignore_line = false;
-  int ret;
+  const struct mxt_config_image_object *obj;
   struct mxt_object_config **next = &cfg->head;
   struct mxt_object_config *objcfg;
+  int i;
 
-  cfg->config_type = CONFIG_XCFG;
-
-  fp = fopen(filename, "r");
-  if (fp == NULL) {
-    mxt_err(ctx, "Error opening %s: %s", filename, strerror(errno));
-    return mxt_errno_to_rc(errno);
-  }
-
-  while (!file_read) {
-    /* First character is expected to be '[' - skip empty lines and spaces  */
-    c = getc(fp);
-    while ((c == '\n') || (c == '\r') || (c == 0x20))
-      c = getc(fp);
-
-    if (c != '[') {
-      if (c == EOF)
-        break;
-
-      /* If we are ignoring the current section then look for the next section */
-      if (ignore_line) {
-        continue;
-      }
-
-      mxt_err(ctx, "Parse error: expected '[', read ascii char %c!", c);
-      ret = MXT_ERROR_FILE_FORMAT;
-      goto close;
-    }
-
-    if (fscanf(fp, "%[^] ]", object) != 1) {
-      mxt_err(ctx, "Object parse error");
-      ret = MXT_ERROR_FILE_FORMAT;
-      goto close;
-    }
-
-    /* Ignore the comments and file header sections */
-    if (!strcmp(object, "COMMENTS")
-        || !strcmp(object, "APPLICATION_INFO_HEADER")) {
-      ignore_line = true;
-      mxt_dbg(ctx, "Skipping %s", object);
-      continue;
-    }
-
-    ignore_line = false;
-
-    /* Extract the checksum */
-    if (!strcmp(object, "VERSION_INFO_HEADER")) {
-      while (false == ignore_line) {
-        if (fscanf(fp, "%s", tmp) != 1) {
-          mxt_err(ctx, "Version info header parse error");
-          ret = MXT_ERROR_FILE_FORMAT;
-          goto close;
-        }
-        if (!strncmp(tmp, "CHECKSUM", 8)) {
-          sscanf(tmp, "%[^'=']=%x", object, &cfg->config_crc);
-          mxt_dbg(ctx, "Config CRC from file: %s", tmp);
-          ignore_line = true;
-        }
-      }
-      continue;
-    }
-
-    if (fscanf(fp, "%s", tmp) != 1) {
-      mxt_err(ctx, "Instance parse error");
-      ret = MXT_ERROR_FILE_FORMAT;
-      goto close;
-    }
-
-    if (strcmp(tmp, "INSTANCE")) {
-      mxt_err(ctx, "Parse error, expected INSTANCE, got %s", tmp);
-      ret = MXT_ERROR_FILE_FORMAT;
-      goto close;
-    }
-
-    if (fscanf(fp, "%d", &instance) != 1) {
-      mxt_err(ctx, "Instance number parse error");
-      ret = MXT_ERROR_FILE_FORMAT;
-      goto close;
-    }
-
-    /* Read rest of header section */
-    while(c != ']') {
-      c = getc(fp);
-      if (c == '\n') {
-        mxt_err(ctx, "Parse error, expected ] before end of line");
-        ret = MXT_ERROR_FILE_FORMAT;
-        goto close;
-      }
-    }
-
-    while(c != '\n')
-      c = getc(fp);
-
-    while ((c != '=') && (c != EOF))
-      c = getc(fp);
-
-    if (fscanf(fp, "%d", &object_address) != 1) {
-      mxt_err(ctx, "Object address parse error");
-      ret = MXT_ERROR_FILE_FORMAT;
-      goto close;
-    }
-
-    c = getc(fp);
-    while((c != '=') && (c != EOF))
-      c = getc(fp);
-
-    if (fscanf(fp, "%d", &object_size) != 1) {
-      mxt_err(ctx, "Object size parse error");
-      ret = MXT_ERROR_FILE_FORMAT;
-      goto close;
-    }
-
-    c = getc(fp);
-
-    /* Find object type ID number at end of object string */
-    substr = strrchr(object, '_');
-    if (substr == NULL || (*(substr + 1) != 'T')) {
-      mxt_err(ctx, "Parse error, could not find T number in %s", object);
-      ret = MXT_ERROR_FILE_FORMAT;
-      goto close;
-    }
-
-    if (sscanf(substr + 2, "%d", &object_id) != 1) {
-      mxt_err(ctx, "Unable to get object type ID for %s", object);
-      ret = MXT_ERROR_FILE_FORMAT;
-      goto close;
-    }
+  cfg->id = image->id;
+  cfg->info_crc = image->info_crc;
+  cfg->config_crc = image->config_crc;
 
-    mxt_dbg(ctx, "%s T%u OBJECT_ADDRESS=%d OBJECT_SIZE=%d",
-            object, object_id, object_address, object_size);
+  for (i = 0; i < image->num_objects; i++) {
+    obj = &image->objects[i];
 
     objcfg = calloc(1, sizeof(struct mxt_object_config));
-    if (!objcfg) {
-      ret = MXT_ERROR_NO_MEM;
-      goto close;
-    }
+    if (!objcfg)
+      goto nomem;
 
-    objcfg->type = object_id;
-    objcfg->size = object_size;
-    objcfg->instance = instance;
-    objcfg->start_position = object_address;
+    objcfg->type = obj->type;
+    objcfg->instance = obj->instance;
+    objcfg->size = obj->size;
+    objcfg->start_position = obj->start_position;
 
     *next = objcfg;
     next = &objcfg->next;
 
-    /* Allocate memory to store configuration */
-    objcfg->data = calloc(object_size, sizeof(uint8_t));
-    if (!objcfg->data) {
-      mxt_err(ctx, "Failed to allocate memory");
-      ret = MXT_ERROR_NO_MEM;
-      goto close;
-    }
+    objcfg->data = malloc(obj->size ? obj->size : 1);
+    if (!objcfg->data)
+      goto nomem;
 
-    while (true) {
-      int offset;
-      int width;
+    memcpy(objcfg->data, obj->data, obj->size);
+  }
 
-      /* Find next line, check first character valid and rewind */
-      c = getc(fp);
-      while((c == '\n') || (c == '\r') || (c == 0x20))
-        c = getc(fp);
+  return MXT_SUCCESS;
 
-      fseek(fp, -1, SEEK_CUR);
+nomem:
+  mxt_err(ctx, "Failed to allocate memory");
+  mxt_free_config(cfg);
+  return MXT_ERROR_NO_MEM;
+}
 
-      /* End of object */
-      if (c == '[')
-        break;
+//******************************************************************************
+/// \brief  Get the configuration from file
+/// \return #mxt_rc
+static int mxt_get_config_from_file(struct libmaxtouch_ctx *ctx,
+                                    const char *filename, struct mxt_config *cfg)
+{
+  struct mxt_config_image *image;
+  int ret;
 
-      /* End of file */
-      if (c == EOF)
-        break;
+  if (!cfg) {
+    mxt_err(ctx, "Config is null");
+    return MXT_INTERNAL_ERROR;
+  }
 
-      /* Read address */
-      if (fscanf(fp, "%d", &offset) != 1) {
-        mxt_err(ctx, "Address parse error");
-        ret = MXT_ERROR_FILE_FORMAT;
-        goto close;
-      }
+  ret = mxt_config_image_load(ctx, filename, &image);
+  if (ret)
+    return ret;
 
-      /* Read byte count of this register (max 2) */
-      if (fscanf(fp, "%d", &width) != 1) {
-        mxt_err(ctx, "Byte count parse error");
-        ret = MXT_ERROR_FILE_FORMAT;
-        goto close;
-      }
+  ret = mxt_config_from_image(ctx, image, cfg);
 
-      while((c != '=') && (c != EOF)) {
-        c = getc(fp);
-      }
+  mxt_config_image_free(image);
+  return ret;
+}
 
-      if (fscanf(fp, "%d", &data) != 1) {
-        mxt_err(ctx, "Data parse error");
-        ret = MXT_ERROR_FILE_FORMAT;
-        goto close;
-      }
+//******************************************************************************
+/// \brief  Load configuration from .xcfg or RAW file, automatically detect
+//          format and write to device
+/// \return #mxt_rc
+int mxt_load_config_file(struct mxt_device *mxt, const char *filename)
+{
+  uint8_t backup_cmd = BACKUPNV_COMMAND;
+  struct mxt_config cfg = {{0}};
+  int ret;
 
-      c = getc(fp);
+  ret = mxt_get_config_from_file(mxt->ctx, filename, &cfg);
 
-      switch (width) {
-      case 1:
-        objcfg->data[offset] = (char) data;
-        break;
-      case 2:
-        objcfg->data[offset] = (char) data & 0xFF;
-        objcfg->data[offset + 1] = (char) ((data >> 8) & 0xFF);
-        break;
-      case 4:
-        objcfg->data[offset] = (char) data & 0xFF;
-        objcfg->data[offset + 1] = (char) ((data >> 8) & 0xFF);
-        objcfg->data[offset + 2] = (char) ((data >> 16) & 0xFF);
-        objcfg->data[offset + 3] = (char) ((data >> 24) & 0xFF);
-        break;
-      default:
-        mxt_err(ctx, "Only 1, 2 and 4 byte config values are supported");
-        ret = MXT_ERROR_FILE_FORMAT;
-        goto close;
-      }
-    }
+  if (ret == MXT_SUCCESS) {
+    ret = mxt_write_device_config(mxt, &cfg);
+    mxt_free_config(&cfg);
   }
 
-  ret = MXT_SUCCESS;
-  mxt_info(ctx, "Configuration read from %s in XCFG format", filename);
+  ret = mxt_backup_config(mxt, backup_cmd);
+  
+  if (ret) {
+    mxt_err(mxt->ctx, "Error backing up");
+    } else {
+        mxt_info(mxt->ctx, "Configuration backed up");
+
+        ret = mxt_reset_chip(mxt, false, 0);
+      
+        if (ret) {
+          mxt_err(mxt->ctx, "Error resetting");
+        } else {
+            mxt_info(mxt->ctx, "Chip reset");
+          }
+      }
 
-close:
-  fclose(fp);
   return ret;
 }
 
 //******************************************************************************
-/// \brief  Load configuration from RAW file
-//  \return #mxt_rc
-static int mxt_load_raw_file(struct libmaxtouch_ctx *ctx, const char *filename,
-                             struct mxt_config *cfg)
+/// \brief  Find the device copy of an object configuration
+static struct mxt_object_config *mxt_find_object_config(struct mxt_config *cfg,
+                                                        uint32_t type,
+                                                        uint8_t instance)
 {
-  FILE *fp;
-  int ret;
-  size_t i;
-  char line[2048];
-  struct mxt_object_config **next;
   struct mxt_object_config *objcfg;
 
-  cfg->config_type = CONFIG_RAW;
-
-  fp = fopen(filename, "r");
-  if (fp == NULL) {
-    mxt_err(ctx, "Error opening %s: %s", filename, strerror(errno));
-    return mxt_errno_to_rc(errno);
+  for (objcfg = cfg->head; objcfg; objcfg = objcfg->next) {
+    if (objcfg->type == type && objcfg->instance == instance)
+      return objcfg;
   }
 
-  if (fgets(line, sizeof(line), fp) == NULL) {
-    mxt_err(ctx, "Unexpected EOF");
-  }
+  return NULL;
+}
 
-  if (strncmp(line, OBP_RAW_MAGIC, strlen(OBP_RAW_MAGIC))) {
-    mxt_warn(ctx, "Not in OBP_RAW format");
-    ret = MXT_ERROR_FILE_FORMAT;
-    goto close;
-  } else {
-    mxt_dbg(ctx, "Loading OBP_RAW file");
-  }
+//******************************************************************************
+/// \brief  Write only the byte ranges of the file config which differ from
+///         the device config
+/// \return #mxt_rc
+static int mxt_write_config_diff(struct mxt_device *mxt,
+                                 struct mxt_config *file_cfg,
+                                 struct mxt_config *dev_cfg,
+                                 size_t *bytes_out, int *writes_out)
+{
+  struct mxt_object_config *objcfg, *devcfg;
+  uint32_t num_bytes;
+  uint32_t start, end, i;
+  int ret;
 
-  /* Load information block and check */
-  for (i = 0; i < sizeof(struct mxt_id_info); i++) {
-    ret = fscanf(fp, "%hhx", (unsigned char *)&cfg->id + i);
-    if (ret != 1) {
-      mxt_err(ctx, "Bad format");
-      ret = MXT_ERROR_FILE_FORMAT;
-      goto close;
+  for (objcfg = file_cfg->head; objcfg; objcfg = objcfg->next) {
+    if (mxt_object_is_volatile(objcfg->type)) {
+      mxt_warn(mxt->ctx, "Skipping volatile T%d", objcfg->type);
+      continue;
     }
-  }
-
-  /* Read CRCs */
-  ret = fscanf(fp, "%x", &cfg->info_crc);
-  if (ret != 1) {
-    mxt_err(ctx, "Bad format: failed to parse Info CRC");
-    ret = MXT_ERROR_FILE_FORMAT;
-    goto close;
-  }
-
-  ret = fscanf(fp, "%x", &cfg->config_crc);
-  if (ret != 1) {
-    mxt_err(ctx, "Bad format: failed to parse Config CRC");
-    ret = MXT_ERROR_FILE_FORMAT;
-    goto close;
-  }
-
-  next = &cfg->head;
 
-  while (true) {
-    objcfg = calloc(1, sizeof(struct mxt_object_config));
-    if (!objcfg) {
-      ret = MXT_ERROR_NO_MEM;
-      goto close;
+    devcfg = mxt_find_object_config(dev_cfg, objcfg->type, objcfg->instance);
+    if (!devcfg) {
+      mxt_warn(mxt->ctx, "T%d not present", objcfg->type);
+      continue;
     }
 
-    /* Read type, instance, length */
-    ret = fscanf(fp, "%x %" SCNx8 " %x",
-                 &objcfg->type, &objcfg->instance, &objcfg->size);
-    if (ret == EOF) {
-      free(objcfg);
-      break;
-    } else if (ret != 3) {
-      mxt_err(ctx, "Bad format: failed to parse object");
-      free(objcfg);
-      ret = MXT_ERROR_FILE_FORMAT;
-      goto close;
+    if (devcfg->size > objcfg->size) {
+      mxt_warn(mxt->ctx, "Extending config by %d bytes in T%u",
+               devcfg->size - objcfg->size, objcfg->type);
+      num_bytes = objcfg->size;
+    } else if (objcfg->size > devcfg->size) {
+      mxt_warn(mxt->ctx, "Discarding %u bytes in T%u",
+               objcfg->size - devcfg->size, objcfg->type);
+      num_bytes = devcfg->size;
+    } else {
+      num_bytes = devcfg->size;
     }
 
-    mxt_dbg(ctx, "OBP_RAW T%u instance %u", objcfg->type, objcfg->instance);
+    i = 0;
+    while (i < num_bytes) {
+      if (objcfg->data[i] == devcfg->data[i]) {
+        i++;
+        continue;
+      }
 
-    *next = objcfg;
-    next = &objcfg->next;
+      /* Extend over matching runs shorter than the cost of a new write */
+      start = i;
+      end = i + 1;
+      for (i = end; i < num_bytes && i - end < MXT_CONFIG_DIFF_GAP; i++) {
+        if (objcfg->data[i] != devcfg->data[i])
+          end = i + 1;
+      }
 
-    /* Malloc memory to store configuration */
-    objcfg->data = calloc(objcfg->size, sizeof(uint8_t));
-    if (!objcfg->data) {
-      mxt_err(ctx, "Failed to allocate memory");
-      ret = MXT_ERROR_NO_MEM;
-      goto close;
-    }
+      mxt_verb(mxt->ctx, "T%u instance %u offset %u: %u bytes differ",
+               objcfg->type, objcfg->instance, start, end - start);
 
-    /* Read bytes from file */
-    for (i = 0; i < objcfg->size; i++) {
-      uint8_t val;
-      ret = fscanf(fp, "%hhx", &val);
-      if (ret != 1) {
-        mxt_err(ctx, "Parse error in T%d", objcfg->type);
-        ret = MXT_ERROR_FILE_FORMAT;
-        free(objcfg->data);
-        goto close;
+      ret = mxt_write_register(mxt, objcfg->data + start,
+                               devcfg->start_position + start, end - start);
+      if (ret) {
+        mxt_err(mxt->ctx, "Config write error, ret=%d", ret);
+        return ret;
       }
 
-      *(objcfg->data + i) = val;
+      *bytes_out += end - start;
+      (*writes_out)++;
+      i = end;
     }
-
-    mxt_log_buffer(ctx, LOG_DEBUG, "CFG:", objcfg->data, objcfg->size);
   }
 
-  ret = MXT_SUCCESS;
-  mxt_info(ctx, "Configuration read from %s in OBP_RAW format", filename);
-
-close:
-  fclose(fp);
-  return ret;
+  return MXT_SUCCESS;
 }
 
 //******************************************************************************
-/// \brief  Get the configuration from file
+/// \brief  Load configuration from .xcfg or RAW file and write only the bytes
+///         which differ from the device configuration. NVRAM backup and
+///         reset are skipped if nothing changed.
 /// \return #mxt_rc
-static int mxt_get_config_from_file(struct libmaxtouch_ctx *ctx,
-                                    const char *filename, struct mxt_config *cfg)
+int mxt_load_config_file_diff(struct mxt_device *mxt, const char *filename)
 {
+  struct mxt_config file_cfg = {{0}};
+  struct mxt_config dev_cfg = {{0}};
+  struct timespec t1, t2;
+  size_t bytes = 0;
+  int writes = 0;
   int ret;
-  char *extension = strrchr(filename, '.');
 
-  if (cfg) {
-    if (extension && !strcmp(extension, ".xcfg")) {
-      ret = mxt_load_xcfg_file(ctx, filename, cfg);
-      if (ret)
-        return ret;
-    } else {
-      ret = mxt_load_raw_file(ctx, filename, cfg);
-      if (ret)
-        return ret;
-    }
-  } else {
-    ret = MXT_INTERNAL_ERROR;
-    mxt_err(ctx, "Config is null");
-  }
-  return ret;
-}
+  clock_gettime(CLOCK_MONOTONIC, &t1);
 
-//******************************************************************************
-/// \brief  Load configuration from .xcfg or RAW file, automatically detect
-//          format and write to device
-/// \return #mxt_rc
-int mxt_load_config_file(struct mxt_device *mxt, const char *filename)
-{
-  uint8_t backup_cmd = BACKUPNV_COMMAND;
-  struct mxt_config cfg = {{0}};
-  int ret;
+  ret = mxt_get_config_from_file(mxt->ctx, filename, &file_cfg);
+  if (ret)
+    return ret;
 
-  ret = mxt_get_config_from_file(mxt->ctx, filename, &cfg);
+  mxt_check_info_crc(mxt, &file_cfg);
+
+  mxt_config_hold_irq(mxt);
 
+  ret = mxt_read_device_config(mxt, &dev_cfg);
   if (ret == MXT_SUCCESS) {
-    ret = mxt_write_device_config(mxt, &cfg);
-    mxt_free_config(&cfg);
+    ret = mxt_write_config_diff(mxt, &file_cfg, &dev_cfg, &bytes, &writes);
+    mxt_free_config(&dev_cfg);
   }
 
-  ret = mxt_backup_config(mxt, backup_cmd);
-  
-  if (ret) {
-    mxt_err(mxt->ctx, "Error backing up");
-    } else {
-        mxt_info(mxt->ctx, "Configuration backed up");
+  mxt_config_release_irq(mxt);
+  mxt_free_config(&file_cfg);
 
-        ret = mxt_reset_chip(mxt, false, 0);
-      
-        if (ret) {
-          mxt_err(mxt->ctx, "Error resetting");
-        } else {
-            mxt_info(mxt->ctx, "Chip reset");
-          }
-      }
+  if (ret)
+    return ret;
 
-  return ret;
+  if (bytes > 0) {
+    ret = mxt_backup_config(mxt, BACKUPNV_COMMAND);
+    if (ret) {
+      mxt_err(mxt->ctx, "Error backing up");
+      return ret;
+    }
+
+    mxt_info(mxt->ctx, "Configuration backed up");
+
+    ret = mxt_reset_chip(mxt, false, 0);
+    if (ret) {
+      mxt_err(mxt->ctx, "Error resetting");
+      return ret;
+    }
+
+    mxt_info(mxt->ctx, "Chip reset");
+  } else {
+    mxt_info(mxt->ctx, "Configuration unchanged, skipping backup");
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &t2);
+
+  mxt_info(mxt->ctx, "Wrote %zu bytes in %d writes, took %ld ms", bytes, writes,
+           (long)((t2.tv_sec - t1.tv_sec) * 1000
+                  + (t2.tv_nsec - t1.tv_nsec) / 1000000));
+
+  return MXT_SUCCESS;
 }
 
 //******************************************************************************
@@ -918,14 +977,21 @@ int mxt_save_config_file(struct mxt_device *mxt, const char *filename)
   char *extension = strrchr(filename, '.');
   struct mxt_config cfg = {{0}};
 
+  mxt_session_begin(mxt);
   ret = mxt_read_device_config(mxt, &cfg);
+  mxt_session_end(mxt);
   if (ret)
     goto config_done;
 
-  if (extension && !strcmp(extension, ".xcfg"))
+  if (extension && !strcmp(extension, ".xcfg")) {
     ret = mxt_save_xcfg_file(mxt->ctx, filename, &cfg);
-  else
+    if (ret == MXT_SUCCESS)
+      mxt_info(mxt->ctx, "Saved config to %s in .xcfg format", filename);
+  } else {
     ret = mxt_save_raw_file(mxt->ctx, filename, &cfg);
+    if (ret == MXT_SUCCESS)
+      mxt_info(mxt->ctx, "Saved config to %s in OBP_RAW format", filename);
+  }
 
   mxt_free_config(&cfg);
 
@@ -980,42 +1046,31 @@ free:
 /// \return #mxt_rc
 int mxt_checkcrc(struct libmaxtouch_ctx *ctx, struct mxt_device *mxt, char *filename)
 {
-  int ret;
-  struct mxt_config cfg = {{0}};
+  struct mxt_config_image *image;
   uint16_t obj_idx = 0;
+  uint32_t calc_crc;
+  int ret;
 
   int start_pos = INT_MAX;
-  uint16_t end_pos = 0;
+  int end_pos = 0;
 
-  /* Get the mxt_config and object configurations */
-  ret = mxt_get_config_from_file(ctx, filename, &cfg);
+  ret = mxt_config_image_load(ctx, filename, &image);
   if (ret)
-    goto free;
+    return ret;
 
-  /* Find limits of CRC region */
-  struct mxt_object_config *objcfg = cfg.head;
   if (mxt == NULL) {
-    if (cfg.config_type == CONFIG_RAW) {
+    if (!image->have_addresses) {
       mxt_err(ctx, "RAW config format only supported with chip present");
       ret = MXT_ERROR_NO_DEVICE;
       goto free;
-    } else {
-      while (objcfg) {
-        if (is_type_used_for_crc(objcfg->type)) {
-          if (start_pos > objcfg->start_position)
-            start_pos = objcfg->start_position;
-
-          if (end_pos < (objcfg->start_position + objcfg->size))
-            end_pos = objcfg->start_position + objcfg->size;
-        }
-
-        objcfg = objcfg->next;
-      }
     }
+
+    ret = mxt_config_image_calc_crc(ctx, image, &calc_crc);
   } else {
+    /* Find limits of CRC region */
     for (obj_idx = 0; obj_idx < mxt->info.id->num_objects; obj_idx++) {
       struct mxt_object *object = &mxt->info.objects[obj_idx];
-      if (is_type_used_for_crc(object->type)) {
+      if (mxt_object_used_for_crc(object->type)) {
         int sp = mxt_get_object_address(mxt, object->type, 0);
         if (start_pos > sp)
           start_pos = sp;
@@ -1025,46 +1080,31 @@ int mxt_checkcrc(struct libmaxtouch_ctx *ctx, struct mxt_device *mxt, char *file
           end_pos = sp + obj_size;
       }
     }
-  }
 
-  mxt_verb(ctx, "CRC start_pos:%d end_pos:%d", start_pos, end_pos);
+    if (start_pos > end_pos)
+      start_pos = end_pos;
 
-  /* Allocate buffer for CRC calculation */
-  uint8_t *buffer = (uint8_t *)calloc(end_pos, sizeof(uint8_t));
-  if (!buffer) {
-    ret = MXT_ERROR_NO_MEM;
-    mxt_err(ctx, "Could not allocate memory for buffer");
-    goto free;
-  }
-
-  /* Loop through until all buffers have been read in order */
-  objcfg = cfg.head;
-  while (objcfg) {
-    if (is_type_used_for_crc(objcfg->type)) {
-      uint16_t off = objcfg->start_position;
-      if (cfg.config_type != CONFIG_XCFG)
-        off = mxt_get_object_address(mxt, objcfg->type, objcfg->instance);
+    mxt_verb(ctx, "CRC start_pos:%d end_pos:%d", start_pos, end_pos);
 
-      memcpy(buffer + off, objcfg->data, objcfg->size);
-    }
+    ret = mxt_config_image_resolve(image, mxt);
+    if (ret)
+      goto free;
 
-    objcfg = objcfg->next;
+    ret = mxt_config_image_crc_range(ctx, image, start_pos, end_pos, &calc_crc);
   }
 
-  uint32_t calc_crc;
-  ret = mxt_calculate_crc(ctx, &calc_crc, buffer + start_pos, end_pos - start_pos);
+  if (ret)
+    goto free;
 
-  if (calc_crc == cfg.config_crc) {
-    mxt_info(ctx, "File checksum verified: %06X", cfg.config_crc);
+  if (calc_crc == image->config_crc) {
+    mxt_info(ctx, "File checksum verified: %06X", image->config_crc);
     ret = MXT_SUCCESS;
   } else {
-    mxt_err(ctx, "Checksum error: calc=%06X file=%06X", calc_crc, cfg.config_crc);
+    mxt_err(ctx, "Checksum error: calc=%06X file=%06X", calc_crc, image->config_crc);
     ret = MXT_ERROR_CHECKSUM_MISMATCH;
   }
 
-  free(buffer);
-
 free:
-  mxt_free_config(&cfg);
+  mxt_config_image_free(image);
   return ret;
 }
@@ -0,0 +1,1168 @@
+//------------------------------------------------------------------------------
+/// \file   config_image.c
+/// \brief  Single pass .xcfg and OBP_RAW parser producing a config image
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "libmaxtouch.h"
+#include "info_block.h"
+#include "crc.h"
+#include "config_image.h"
+
+#define OBP_RAW_MAGIC      "OBP_RAW V1"
+
+/* Initial capacity of the parser object and data buffers */
+#define CFG_PARSE_OBJECTS  64
+#define CFG_PARSE_DATA     4096
+
+//******************************************************************************
+/// \brief Object being parsed, data is an offset as the buffer may move
+struct cfg_parse_object {
+  size_t data_ofs;
+  uint32_t size;
+  uint16_t type;
+  uint16_t start_position;
+  uint8_t instance;
+  bool have_address;
+  bool have_size;
+};
+
+//******************************************************************************
+/// \brief Parser state
+struct cfg_parser {
+  struct libmaxtouch_ctx *ctx;
+  const char *p;
+  const char *end;
+  int line;
+  struct mxt_config_image hdr;
+  struct cfg_parse_object *objects;
+  int num_objects;
+  int max_objects;
+  uint8_t *data;
+  size_t data_len;
+  size_t data_max;
+};
+
+//******************************************************************************
+/// \brief xcfg section types
+enum cfg_section {
+  CFG_SECTION_NONE,
+  CFG_SECTION_SKIP,
+  CFG_SECTION_VERSION,
+  CFG_SECTION_OBJECT
+};
+
+//******************************************************************************
+/// \brief  Determines whether the object type is used for CRC checksum calculation
+/// \return True if used, false if not
+bool mxt_object_used_for_crc(uint32_t type)
+{
+  switch (type) {
+  case GEN_MESSAGEPROCESSOR_T5:
+  case GEN_COMMANDPROCESSOR_T6:
+  case DEBUG_DIAGNOSTIC_T37:
+  case SPT_USERDATA_T38:
+  case SPT_MESSAGECOUNT_T44:
+  case SERIAL_DATA_COMMAND_T68:
+  case SPT_MESSAGECOUNT_T144:
+    return false;
+
+  default:
+    return true;
+  }
+}
+
+//******************************************************************************
+/// \brief Some objects are volatile or read-only and should not be saved to config file
+bool mxt_object_is_volatile(uint16_t object_type)
+{
+  switch (object_type) {
+  case DEBUG_DELTAS_T2:
+  case DEBUG_REFERENCES_T3:
+  case DEBUG_SIGNALS_T4:
+  case GEN_MESSAGEPROCESSOR_T5:
+  case GEN_COMMANDPROCESSOR_T6:
+  case SPT_MESSAGECOUNT_T44:
+  case GEN_DATASOURCE_T53:
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+static inline int cfg_hex_digit(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+
+  c |= 0x20;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+
+  return -1;
+}
+
+static inline bool cfg_is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+//******************************************************************************
+/// \brief  Parse a number from s, stopping at e. Base 0 accepts a 0x prefix
+///         for hex, base 16 accepts an optional one
+/// \return true if at least one digit was read
+static bool cfg_parse_number(const char **s, const char *e, int base, long *val)
+{
+  const char *p = *s;
+  unsigned long v = 0;
+  bool negative = false;
+  bool digits = false;
+  int d;
+
+  while (p < e && (*p == ' ' || *p == '\t'))
+    p++;
+
+  if (p < e && *p == '-') {
+    negative = true;
+    p++;
+  }
+
+  if (e - p > 2 && p[0] == '0' && (p[1] | 0x20) == 'x'
+      && cfg_hex_digit(p[2]) >= 0 && base != 10) {
+    base = 16;
+    p += 2;
+  } else if (base == 0) {
+    base = 10;
+  }
+
+  while (p < e) {
+    d = cfg_hex_digit(*p);
+    if (d < 0 || d >= base)
+      break;
+
+    v = v * base + d;
+    digits = true;
+    p++;
+  }
+
+  *s = p;
+  *val = negative ? -(long)v : (long)v;
+
+  return digits;
+}
+
+//******************************************************************************
+/// \brief  Compare a token with a string literal
+static bool cfg_token_is(const char *s, const char *e, const char *lit)
+{
+  size_t len = strlen(lit);
+
+  return (size_t)(e - s) == len && !memcmp(s, lit, len);
+}
+
+//******************************************************************************
+/// \brief  Find the next line, trimmed of surrounding white space
+/// \return false at end of buffer
+static bool cfg_next_line(struct cfg_parser *ps, const char **s, const char **e)
+{
+  const char *nl;
+
+  if (ps->p >= ps->end)
+    return false;
+
+  *s = ps->p;
+  nl = memchr(ps->p, '\n', ps->end - ps->p);
+  *e = nl ? nl : ps->end;
+  ps->p = nl ? nl + 1 : ps->end;
+  ps->line++;
+
+  while (*s < *e && cfg_is_space(**s))
+    (*s)++;
+
+  while (*e > *s && cfg_is_space((*e)[-1]))
+    (*e)--;
+
+  return true;
+}
+
+//******************************************************************************
+/// \brief  Find the next white space separated token
+/// \return false at end of buffer
+static bool cfg_next_token(struct cfg_parser *ps, const char **s, const char **e)
+{
+  const char *p = ps->p;
+
+  while (p < ps->end && cfg_is_space(*p)) {
+    if (*p == '\n')
+      ps->line++;
+    p++;
+  }
+
+  if (p >= ps->end) {
+    ps->p = p;
+    return false;
+  }
+
+  *s = p;
+  while (p < ps->end && !cfg_is_space(*p))
+    p++;
+
+  *e = p;
+  ps->p = p;
+
+  return true;
+}
+
+//******************************************************************************
+/// \brief  Parse the next token as a hex number
+/// \return true on success
+static bool cfg_next_hex(struct cfg_parser *ps, long *val)
+{
+  const char *s, *e;
+
+  if (!cfg_next_token(ps, &s, &e))
+    return false;
+
+  /* Common case of a single data byte */
+  if (e - s == 2) {
+    int hi = cfg_hex_digit(s[0]);
+    int lo = cfg_hex_digit(s[1]);
+
+    if (hi >= 0 && lo >= 0) {
+      *val = (hi << 4) | lo;
+      return true;
+    }
+  }
+
+  return cfg_parse_number(&s, e, 16, val) && s == e;
+}
+
+//******************************************************************************
+/// \brief  Add an object to the parser state
+/// \return #mxt_rc
+static int cfg_add_object(struct cfg_parser *ps, struct cfg_parse_object **objcfg)
+{
+  struct cfg_parse_object *objects;
+  int max_objects;
+
+  if (ps->num_objects >= UINT16_MAX) {
+    mxt_err(ps->ctx, "Too many objects at line %d", ps->line);
+    return MXT_ERROR_FILE_FORMAT;
+  }
+
+  if (ps->num_objects == ps->max_objects) {
+    max_objects = ps->max_objects ? ps->max_objects * 2 : CFG_PARSE_OBJECTS;
+    objects = realloc(ps->objects, max_objects * sizeof(struct cfg_parse_object));
+    if (!objects) {
+      mxt_err(ps->ctx, "Failed to allocate memory");
+      return MXT_ERROR_NO_MEM;
+    }
+
+    ps->objects = objects;
+    ps->max_objects = max_objects;
+  }
+
+  *objcfg = &ps->objects[ps->num_objects++];
+  memset(*objcfg, 0, sizeof(struct cfg_parse_object));
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Reserve zeroed data for an object
+/// \return #mxt_rc
+static int cfg_alloc_data(struct cfg_parser *ps, struct cfg_parse_object *objcfg,
+                          uint32_t size)
+{
+  uint8_t *data;
+  size_t data_max;
+
+  if (ps->data_len + size > ps->data_max) {
+    data_max = ps->data_max ? ps->data_max : CFG_PARSE_DATA;
+    while (data_max < ps->data_len + size)
+      data_max *= 2;
+
+    data = realloc(ps->data, data_max);
+    if (!data) {
+      mxt_err(ps->ctx, "Failed to allocate memory");
+      return MXT_ERROR_NO_MEM;
+    }
+
+    ps->data = data;
+    ps->data_max = data_max;
+  }
+
+  objcfg->data_ofs = ps->data_len;
+  objcfg->size = size;
+  objcfg->have_size = true;
+  memset(ps->data + ps->data_len, 0, size);
+  ps->data_len += size;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Parse an xcfg section header: [COMMENTS], [VERSION_INFO_HEADER],
+///         [APPLICATION_INFO_HEADER] or [NAME_Tnn INSTANCE n]
+/// \return #mxt_rc
+static int cfg_parse_section(struct cfg_parser *ps, const char *s, const char *e,
+                             enum cfg_section *section,
+                             struct cfg_parse_object **objcfg)
+{
+  const char *close, *name, *name_end, *t, *p;
+  long type, instance;
+  int ret;
+
+  close = memchr(s, ']', e - s);
+  if (!close) {
+    mxt_err(ps->ctx, "Parse error, expected ] before end of line %d", ps->line);
+    return MXT_ERROR_FILE_FORMAT;
+  }
+
+  name = s + 1;
+  name_end = name;
+  while (name_end < close && *name_end != ' ')
+    name_end++;
+
+  if (cfg_token_is(name, name_end, "COMMENTS")
+      || cfg_token_is(name, name_end, "APPLICATION_INFO_HEADER")) {
+    mxt_dbg(ps->ctx, "Skipping %.*s", (int)(name_end - name), name);
+    *section = CFG_SECTION_SKIP;
+    return MXT_SUCCESS;
+  }
+
+  if (cfg_token_is(name, name_end, "VERSION_INFO_HEADER")) {
+    *section = CFG_SECTION_VERSION;
+    return MXT_SUCCESS;
+  }
+
+  /* Find object type ID number at end of object string */
+  for (t = name_end - 1; t > name; t--) {
+    if (t[-1] == '_' && *t == 'T')
+      break;
+  }
+
+  p = t + 1;
+  if (t <= name || !cfg_parse_number(&p, name_end, 10, &type) || p != name_end
+      || type < 0 || type > UINT16_MAX) {
+    mxt_err(ps->ctx, "Parse error, could not find T number in %.*s",
+            (int)(name_end - name), name);
+    return MXT_ERROR_FILE_FORMAT;
+  }
+
+  p = name_end;
+  while (p < close && *p == ' ')
+    p++;
+
+  t = p;
+  while (p < close && *p != ' ')
+    p++;
+
+  if (!cfg_token_is(t, p, "INSTANCE")) {
+    mxt_err(ps->ctx, "Parse error, expected INSTANCE, got %.*s",
+            (int)(p - t), t);
+    return MXT_ERROR_FILE_FORMAT;
+  }
+
+  if (!cfg_parse_number(&p, close, 10, &instance)
+      || instance < 0 || instance > UINT8_MAX) {
+    mxt_err(ps->ctx, "Instance number parse error at line %d", ps->line);
+    return MXT_ERROR_FILE_FORMAT;
+  }
+
+  ret = cfg_add_object(ps, objcfg);
+  if (ret)
+    return ret;
+
+  (*objcfg)->type = type;
+  (*objcfg)->instance = instance;
+  *section = CFG_SECTION_OBJECT;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Parse a line of the xcfg version header
+static void cfg_parse_version(struct cfg_parser *ps, const char *s, const char *e)
+{
+  struct mxt_config_image *hdr = &ps->hdr;
+  const char *eq = memchr(s, '=', e - s);
+  const char *p;
+  long val;
+
+  if (!eq)
+    return;
+
+  p = eq + 1;
+
+  if (cfg_token_is(s, eq, "CHECKSUM")) {
+    if (cfg_parse_number(&p, e, 16, &val)) {
+      hdr->config_crc = val;
+      mxt_dbg(ps->ctx, "Config CRC from file: %06X", hdr->config_crc);
+    }
+  } else if (cfg_token_is(s, eq, "INFO_BLOCK_CHECKSUM")) {
+    if (cfg_parse_number(&p, e, 16, &val))
+      hdr->info_crc = val;
+  } else if (!cfg_parse_number(&p, e, 0, &val)) {
+    return;
+  } else if (cfg_token_is(s, eq, "FAMILY_ID")) {
+    hdr->id.family = val;
+  } else if (cfg_token_is(s, eq, "VARIANT")) {
+    hdr->id.variant = val;
+  } else if (cfg_token_is(s, eq, "VERSION")) {
+    hdr->id.version = val;
+  } else if (cfg_token_is(s, eq, "BUILD")) {
+    hdr->id.build = val;
+  }
+}
+
+//******************************************************************************
+/// \brief  Parse a line of an xcfg object section: OBJECT_ADDRESS=, OBJECT_SIZE=
+///         or "offset width NAME=value"
+/// \return #mxt_rc
+static int cfg_parse_object_line(struct cfg_parser *ps, const char *s,
+                                 const char *e)
+{
+  struct cfg_parse_object *objcfg = &ps->objects[ps->num_objects - 1];
+  const char *eq = memchr(s, '=', e - s);
+  const char *p;
+  long offset, width, val;
+  uint8_t *data;
+
+  if (*s == '-' || (*s >= '0' && *s <= '9')) {
+    p = s;
+    if (!cfg_parse_number(&p, e, 10, &offset)) {
+      mxt_err(ps->ctx, "Address parse error at line %d", ps->line);
+      return MXT_ERROR_FILE_FORMAT;
+    }
+
+    if (!cfg_parse_number(&p, e, 10, &width)) {
+      mxt_err(ps->ctx, "Byte count parse error at line %d", ps->line);
+      return MXT_ERROR_FILE_FORMAT;
+    }
+
+    p = eq ? eq + 1 : e;
+    if (!eq || !cfg_parse_number(&p, e, 10, &val)) {
+      mxt_err(ps->ctx, "Data parse error at line %d", ps->line);
+      return MXT_ERROR_FILE_FORMAT;
+    }
+
+    if (width != 1 && width != 2 && width != 4) {
+      mxt_err(ps->ctx, "Only 1, 2 and 4 byte config values are supported");
+      return MXT_ERROR_FILE_FORMAT;
+    }
+
+    if (!objcfg->have_size || offset < 0
+        || offset + width > (long)objcfg->size) {
+      mxt_err(ps->ctx, "T%u offset %ld outside object at line %d",
+              objcfg->type, offset, ps->line);
+      return MXT_ERROR_FILE_FORMAT;
+    }
+
+    data = ps->data + objcfg->data_ofs + offset;
+    data[0] = val & 0xFF;
+    if (width > 1)
+      data[1] = (val >> 8) & 0xFF;
+    if (width > 2) {
+      data[2] = (val >> 16) & 0xFF;
+      data[3] = (val >> 24) & 0xFF;
+    }
+
+    return MXT_SUCCESS;
+  }
+
+  if (!eq)
+    return MXT_SUCCESS;
+
+  p = eq + 1;
+
+  if (cfg_token_is(s, eq, "OBJECT_ADDRESS")) {
+    if (!cfg_parse_number(&p, e, 10, &val) || val < 0 || val > UINT16_MAX) {
+      mxt_err(ps->ctx, "Object address parse error at line %d", ps->line);
+      return MXT_ERROR_FILE_FORMAT;
+    }
+
+    objcfg->start_position = val;
+    objcfg->have_address = true;
+  } else if (cfg_token_is(s, eq, "OBJECT_SIZE")) {
+    if (!cfg_parse_number(&p, e, 10, &val) || val < 0 || val > UINT16_MAX
+        || objcfg->have_size) {
+      mxt_err(ps->ctx, "Object size parse error at line %d", ps->line);
+      return MXT_ERROR_FILE_FORMAT;
+    }
+
+    return cfg_alloc_data(ps, objcfg, val);
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Check the previous xcfg object was complete
+/// \return #mxt_rc
+static int cfg_end_object(struct cfg_parser *ps)
+{
+  struct cfg_parse_object *objcfg = &ps->objects[ps->num_objects - 1];
+
+  if (!objcfg->have_address || !objcfg->have_size) {
+    mxt_err(ps->ctx, "T%u instance %u missing OBJECT_ADDRESS or OBJECT_SIZE",
+            objcfg->type, objcfg->instance);
+    return MXT_ERROR_FILE_FORMAT;
+  }
+
+  mxt_dbg(ps->ctx, "T%u OBJECT_ADDRESS=%d OBJECT_SIZE=%d",
+          objcfg->type, objcfg->start_position, objcfg->size);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Parse .xcfg format
+/// \return #mxt_rc
+static int cfg_parse_xcfg(struct cfg_parser *ps)
+{
+  enum cfg_section section = CFG_SECTION_NONE;
+  struct cfg_parse_object *objcfg;
+  const char *s, *e;
+  int ret;
+
+  ps->hdr.format = MXT_CONFIG_FORMAT_XCFG;
+  ps->hdr.have_addresses = true;
+
+  while (cfg_next_line(ps, &s, &e)) {
+    if (s == e)
+      continue;
+
+    if (*s == '[') {
+      if (section == CFG_SECTION_OBJECT) {
+        ret = cfg_end_object(ps);
+        if (ret)
+          return ret;
+      }
+
+      ret = cfg_parse_section(ps, s, e, &section, &objcfg);
+      if (ret)
+        return ret;
+
+      continue;
+    }
+
+    switch (section) {
+    case CFG_SECTION_NONE:
+      mxt_err(ps->ctx, "Parse error: expected '[' at line %d", ps->line);
+      return MXT_ERROR_FILE_FORMAT;
+
+    case CFG_SECTION_SKIP:
+      break;
+
+    case CFG_SECTION_VERSION:
+      cfg_parse_version(ps, s, e);
+      break;
+
+    case CFG_SECTION_OBJECT:
+      ret = cfg_parse_object_line(ps, s, e);
+      if (ret)
+        return ret;
+      break;
+    }
+  }
+
+  if (section == CFG_SECTION_OBJECT)
+    return cfg_end_object(ps);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Parse OBP_RAW format
+/// \return #mxt_rc
+static int cfg_parse_raw(struct cfg_parser *ps)
+{
+  struct cfg_parse_object *objcfg;
+  const char *s, *e;
+  long type, instance, size, val;
+  uint8_t *data;
+  size_t i;
+  int ret;
+
+  ps->hdr.format = MXT_CONFIG_FORMAT_RAW;
+  ps->hdr.have_addresses = false;
+
+  /* Skip magic line */
+  cfg_next_line(ps, &s, &e);
+
+  /* Load information block */
+  for (i = 0; i < sizeof(struct mxt_id_info); i++) {
+    if (!cfg_next_hex(ps, &val)) {
+      mxt_err(ps->ctx, "Bad format");
+      return MXT_ERROR_FILE_FORMAT;
+    }
+
+    ((uint8_t *)&ps->hdr.id)[i] = val;
+  }
+
+  /* Read CRCs */
+  if (!cfg_next_hex(ps, &val)) {
+    mxt_err(ps->ctx, "Bad format: failed to parse Info CRC");
+    return MXT_ERROR_FILE_FORMAT;
+  }
+  ps->hdr.info_crc = val;
+
+  if (!cfg_next_hex(ps, &val)) {
+    mxt_err(ps->ctx, "Bad format: failed to parse Config CRC");
+    return MXT_ERROR_FILE_FORMAT;
+  }
+  ps->hdr.config_crc = val;
+
+  while (cfg_next_token(ps, &s, &e)) {
+    /* Read type, instance, length */
+    ps->p = s;
+    if (!cfg_next_hex(ps, &type) || !cfg_next_hex(ps, &instance)
+        || !cfg_next_hex(ps, &size) || type < 0 || type > UINT16_MAX
+        || instance < 0 || instance > UINT8_MAX || size < 0
+        || size > UINT16_MAX) {
+      mxt_err(ps->ctx, "Bad format: failed to parse object at line %d", ps->line);
+      return MXT_ERROR_FILE_FORMAT;
+    }
+
+    mxt_dbg(ps->ctx, "OBP_RAW T%ld instance %ld", type, instance);
+
+    ret = cfg_add_object(ps, &objcfg);
+    if (ret)
+      return ret;
+
+    objcfg->type = type;
+    objcfg->instance = instance;
+
+    ret = cfg_alloc_data(ps, objcfg, size);
+    if (ret)
+      return ret;
+
+    /* Read bytes from file */
+    data = ps->data + objcfg->data_ofs;
+    for (i = 0; i < (size_t)size; i++) {
+      if (!cfg_next_hex(ps, &val)) {
+        mxt_err(ps->ctx, "Parse error in T%ld", type);
+        return MXT_ERROR_FILE_FORMAT;
+      }
+
+      data[i] = val;
+    }
+
+    mxt_log_buffer(ps->ctx, LOG_DEBUG, "CFG:", data, size);
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Sort image objects by address, keeping file order for duplicates
+static int cfg_object_cmp(const void *a, const void *b)
+{
+  const struct mxt_config_image_object *oa = a;
+  const struct mxt_config_image_object *ob = b;
+
+  if (oa->start_position != ob->start_position)
+    return (oa->start_position < ob->start_position) ? -1 : 1;
+
+  return oa->order - ob->order;
+}
+
+//******************************************************************************
+/// \brief Sort image objects into file order
+static int cfg_object_order_cmp(const void *a, const void *b)
+{
+  const struct mxt_config_image_object *const *oa = a;
+  const struct mxt_config_image_object *const *ob = b;
+
+  return (*oa)->order - (*ob)->order;
+}
+
+//******************************************************************************
+/// \brief  Pack parser state into one allocation holding the image header,
+///         object array and object data
+/// \return #mxt_rc
+static int cfg_build_image(struct cfg_parser *ps, struct mxt_config_image **image)
+{
+  struct mxt_config_image *img;
+  struct mxt_config_image_object *obj;
+  size_t objects_ofs = sizeof(struct mxt_config_image);
+  size_t data_ofs = objects_ofs
+                    + ps->num_objects * sizeof(struct mxt_config_image_object);
+  uint8_t *arena;
+  int i;
+
+  arena = malloc(data_ofs + ps->data_len);
+  if (!arena) {
+    mxt_err(ps->ctx, "Failed to allocate memory");
+    return MXT_ERROR_NO_MEM;
+  }
+
+  img = (struct mxt_config_image *)arena;
+  *img = ps->hdr;
+  img->num_objects = ps->num_objects;
+  img->objects = (struct mxt_config_image_object *)(arena + objects_ofs);
+
+  if (ps->data_len)
+    memcpy(arena + data_ofs, ps->data, ps->data_len);
+
+  for (i = 0; i < ps->num_objects; i++) {
+    obj = &img->objects[i];
+    obj->data = arena + data_ofs + ps->objects[i].data_ofs;
+    obj->size = ps->objects[i].size;
+    obj->type = ps->objects[i].type;
+    obj->start_position = ps->objects[i].start_position;
+    obj->instance = ps->objects[i].instance;
+    obj->order = i;
+  }
+
+  if (img->have_addresses)
+    qsort(img->objects, img->num_objects,
+          sizeof(struct mxt_config_image_object), cfg_object_cmp);
+
+  *image = img;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Parse a .xcfg or OBP_RAW config held in memory, detecting the
+///         format from the content
+/// \return #mxt_rc
+int mxt_config_image_parse(struct libmaxtouch_ctx *ctx, const char *buf,
+                           size_t len, struct mxt_config_image **image)
+{
+  struct cfg_parser ps;
+  const char *p = buf;
+  int ret;
+
+  memset(&ps, 0, sizeof(ps));
+  ps.ctx = ctx;
+  ps.p = buf;
+  ps.end = buf + len;
+
+  while (p < ps.end && cfg_is_space(*p))
+    p++;
+
+  if ((size_t)(ps.end - p) >= strlen(OBP_RAW_MAGIC)
+      && !memcmp(p, OBP_RAW_MAGIC, strlen(OBP_RAW_MAGIC))) {
+    mxt_dbg(ctx, "Loading OBP_RAW file");
+    ret = cfg_parse_raw(&ps);
+  } else if (p < ps.end && *p == '[') {
+    ret = cfg_parse_xcfg(&ps);
+  } else {
+    mxt_warn(ctx, "Not in OBP_RAW or .xcfg format");
+    ret = MXT_ERROR_FILE_FORMAT;
+  }
+
+  if (ret == MXT_SUCCESS)
+    ret = cfg_build_image(&ps, image);
+
+  free(ps.objects);
+  free(ps.data);
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief  Map a config file and parse it
+/// \return #mxt_rc
+int mxt_config_image_load(struct libmaxtouch_ctx *ctx, const char *filename,
+                          struct mxt_config_image **image)
+{
+  struct stat st;
+  char *buf = NULL;
+  void *map = MAP_FAILED;
+  size_t len = 0;
+  ssize_t n;
+  int fd;
+  int ret;
+
+  fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    mxt_err(ctx, "Error opening %s: %s", filename, strerror(errno));
+    return mxt_errno_to_rc(errno);
+  }
+
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    len = st.st_size;
+    map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+
+  if (map != MAP_FAILED) {
+    madvise(map, len, MADV_SEQUENTIAL);
+    buf = map;
+  } else {
+    /* Not a regular file, or could not be mapped */
+    size_t max = CFG_PARSE_DATA;
+
+    len = 0;
+    buf = malloc(max);
+    while (buf) {
+      n = read(fd, buf + len, max - len);
+      if (n == 0)
+        break;
+
+      if (n < 0) {
+        mxt_err(ctx, "Error reading %s: %s", filename, strerror(errno));
+        ret = mxt_errno_to_rc(errno);
+        free(buf);
+        close(fd);
+        return ret;
+      }
+
+      len += n;
+      if (len == max) {
+        char *grown = realloc(buf, max * 2);
+        if (!grown) {
+          free(buf);
+          buf = NULL;
+          break;
+        }
+        buf = grown;
+        max *= 2;
+      }
+    }
+
+    if (!buf) {
+      mxt_err(ctx, "Failed to allocate memory");
+      close(fd);
+      return MXT_ERROR_NO_MEM;
+    }
+  }
+
+  ret = mxt_config_image_parse(ctx, buf, len, image);
+  if (ret == MXT_SUCCESS)
+    mxt_info(ctx, "Configuration read from %s in %s format", filename,
+             (*image)->format == MXT_CONFIG_FORMAT_XCFG ? "XCFG" : "OBP_RAW");
+
+  if (map != MAP_FAILED)
+    munmap(map, len);
+  else
+    free(buf);
+
+  close(fd);
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief  Free a config image
+void mxt_config_image_free(struct mxt_config_image *image)
+{
+  free(image);
+}
+
+//******************************************************************************
+/// \brief  Take object addresses from the device object table for an image
+///         without them. Objects not present on the device are dropped.
+/// \return #mxt_rc
+int mxt_config_image_resolve(struct mxt_config_image *image,
+                             struct mxt_device *mxt)
+{
+  struct mxt_config_image_object *obj;
+  uint16_t addr;
+  int i, count = 0;
+
+  if (image->have_addresses)
+    return MXT_SUCCESS;
+
+  for (i = 0; i < image->num_objects; i++) {
+    obj = &image->objects[i];
+
+    addr = mxt_get_object_address(mxt, obj->type, obj->instance);
+    if (addr == OBJECT_NOT_FOUND) {
+      mxt_warn(mxt->ctx, "T%u not present", obj->type);
+      continue;
+    }
+
+    image->objects[count] = *obj;
+    image->objects[count].start_position = addr;
+    count++;
+  }
+
+  image->num_objects = count;
+  image->have_addresses = true;
+
+  qsort(image->objects, image->num_objects,
+        sizeof(struct mxt_config_image_object), cfg_object_cmp);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Find an object, starting the search at *hint
+static const struct mxt_config_image_object *cfg_find_from(
+  const struct mxt_config_image *image, uint16_t type, uint8_t instance,
+  int *hint)
+{
+  const struct mxt_config_image_object *obj;
+  int i, n;
+
+  for (n = 0; n < image->num_objects; n++) {
+    i = (*hint + n) % image->num_objects;
+    obj = &image->objects[i];
+
+    if (obj->type == type && obj->instance == instance) {
+      *hint = i + 1;
+      return obj;
+    }
+  }
+
+  return NULL;
+}
+
+//******************************************************************************
+/// \brief  Find an object configuration within an image
+/// \return Object, or NULL if not present
+const struct mxt_config_image_object *mxt_config_image_find(
+  const struct mxt_config_image *image, uint16_t type, uint8_t instance)
+{
+  int hint = 0;
+
+  return cfg_find_from(image, type, instance, &hint);
+}
+
+//******************************************************************************
+/// \brief  CRC over a flat copy of the region, for overlapping objects where
+///         later objects in the file take precedence
+/// \return #mxt_rc
+static int cfg_crc_flat(struct libmaxtouch_ctx *ctx,
+                        const struct mxt_config_image *image,
+                        uint32_t start, uint32_t end, uint32_t *crc)
+{
+  const struct mxt_config_image_object **sorted;
+  const struct mxt_config_image_object *obj;
+  uint32_t obj_start, obj_end;
+  uint8_t *buf;
+  int i;
+
+  buf = calloc(end - start, 1);
+  sorted = malloc(image->num_objects * sizeof(*sorted) + 1);
+  if (!buf || !sorted) {
+    mxt_err(ctx, "Could not allocate memory for buffer");
+    free(buf);
+    free(sorted);
+    return MXT_ERROR_NO_MEM;
+  }
+
+  for (i = 0; i < image->num_objects; i++)
+    sorted[i] = &image->objects[i];
+
+  qsort(sorted, image->num_objects, sizeof(*sorted), cfg_object_order_cmp);
+
+  for (i = 0; i < image->num_objects; i++) {
+    obj = sorted[i];
+    if (!mxt_object_used_for_crc(obj->type))
+      continue;
+
+    obj_start = obj->start_position;
+    obj_end = obj_start + obj->size;
+    if (obj_start < start)
+      obj_start = start;
+    if (obj_end > end)
+      obj_end = end;
+
+    if (obj_start < obj_end)
+      memcpy(buf + obj_start - start,
+             obj->data + (obj_start - obj->start_position),
+             obj_end - obj_start);
+  }
+
+  *crc = mxt_crc24(buf, end - start);
+
+  free(sorted);
+  free(buf);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Calculate the config CRC over addresses start to end. Bytes not
+///         covered by a CRC object count as zero.
+/// \return #mxt_rc
+int mxt_config_image_crc_range(struct libmaxtouch_ctx *ctx,
+                               const struct mxt_config_image *image,
+                               uint32_t start, uint32_t end, uint32_t *crc)
+{
+  const struct mxt_config_image_object *obj;
+  struct mxt_crc24_ctx c;
+  uint32_t pos = start;
+  uint32_t obj_start, obj_end;
+  int i;
+
+  if (!image->have_addresses) {
+    mxt_err(ctx, "RAW config format only supported with chip present");
+    return MXT_ERROR_NO_DEVICE;
+  }
+
+  if (end < start)
+    end = start;
+
+  mxt_dbg(ctx, "Calculating CRC over %u bytes", end - start);
+
+  /* Objects are sorted by address, so the CRC is built in a single pass
+   * with gaps added as runs of zeros */
+  mxt_crc24_init(&c);
+
+  for (i = 0; i < image->num_objects; i++) {
+    obj = &image->objects[i];
+    if (!mxt_object_used_for_crc(obj->type))
+      continue;
+
+    obj_start = obj->start_position;
+    obj_end = obj_start + obj->size;
+    if (obj_start < start)
+      obj_start = start;
+    if (obj_end > end)
+      obj_end = end;
+
+    if (obj_start >= obj_end)
+      continue;
+
+    if (obj_start < pos)
+      return cfg_crc_flat(ctx, image, start, end, crc);
+
+    mxt_crc24_update_zeros(&c, obj_start - pos);
+    mxt_crc24_update(&c, obj->data + (obj_start - obj->start_position),
+                     obj_end - obj_start);
+    pos = obj_end;
+  }
+
+  mxt_crc24_update_zeros(&c, end - pos);
+
+  *crc = mxt_crc24_final(&c);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Calculate the config CRC of an image without a device, over the
+///         region covered by its CRC objects
+/// \return #mxt_rc
+int mxt_config_image_calc_crc(struct libmaxtouch_ctx *ctx,
+                              const struct mxt_config_image *image,
+                              uint32_t *crc)
+{
+  const struct mxt_config_image_object *obj;
+  uint32_t start = UINT32_MAX;
+  uint32_t end = 0;
+  int i;
+
+  for (i = 0; i < image->num_objects; i++) {
+    obj = &image->objects[i];
+    if (!mxt_object_used_for_crc(obj->type))
+      continue;
+
+    if (start > obj->start_position)
+      start = obj->start_position;
+
+    if (end < obj->start_position + obj->size)
+      end = obj->start_position + obj->size;
+  }
+
+  if (start > end)
+    start = end;
+
+  mxt_verb(ctx, "CRC start_pos:%u end_pos:%u", start, end);
+
+  return mxt_config_image_crc_range(ctx, image, start, end, crc);
+}
+
+//******************************************************************************
+/// \brief  Compare two config images object by object. Volatile objects are
+///         ignored.
+/// \return #mxt_rc
+int mxt_config_image_compare(struct libmaxtouch_ctx *ctx,
+                             const struct mxt_config_image *a,
+                             const struct mxt_config_image *b,
+                             struct mxt_config_diff *diff)
+{
+  const struct mxt_config_image_object *oa, *ob;
+  uint32_t num_bytes, i;
+  size_t differ;
+  int hint = 0;
+  int j;
+
+  memset(diff, 0, sizeof(struct mxt_config_diff));
+
+  for (j = 0; j < a->num_objects; j++) {
+    oa = &a->objects[j];
+    if (mxt_object_is_volatile(oa->type))
+      continue;
+
+    ob = cfg_find_from(b, oa->type, oa->instance, &hint);
+    if (!ob) {
+      mxt_info(ctx, "T%u instance %u only in first config",
+               oa->type, oa->instance);
+      diff->objects_missing++;
+      continue;
+    }
+
+    num_bytes = (oa->size < ob->size) ? oa->size : ob->size;
+    differ = (oa->size > ob->size) ? oa->size - ob->size : ob->size - oa->size;
+
+    for (i = 0; i < num_bytes; i++) {
+      if (oa->data[i] != ob->data[i])
+        differ++;
+    }
+
+    diff->objects_compared++;
+
+    if (differ) {
+      mxt_info(ctx, "T%u instance %u: %zu bytes differ",
+               oa->type, oa->instance, differ);
+      diff->objects_differ++;
+      diff->bytes_differ += differ;
+    }
+  }
+
+  hint = 0;
+  for (j = 0; j < b->num_objects; j++) {
+    ob = &b->objects[j];
+    if (mxt_object_is_volatile(ob->type))
+      continue;
+
+    if (!cfg_find_from(a, ob->type, ob->instance, &hint)) {
+      mxt_info(ctx, "T%u instance %u only in second config",
+               ob->type, ob->instance);
+      diff->objects_missing++;
+    }
+  }
+
+  return MXT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   config_image.h
+/// \brief  Parsed configuration file image
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "info_block.h"
+
+struct libmaxtouch_ctx;
+struct mxt_device;
+
+//******************************************************************************
+/// \brief Config file formats
+enum mxt_config_format {
+  MXT_CONFIG_FORMAT_RAW,
+  MXT_CONFIG_FORMAT_XCFG
+};
+
+//******************************************************************************
+/// \brief Object configuration within a config image
+struct mxt_config_image_object {
+  const uint8_t *data;       /*!< Object data, within the image */
+  uint32_t size;             /*!< Bytes of data */
+  uint16_t type;             /*!< Object type */
+  uint16_t start_position;   /*!< Address, if the image has addresses */
+  uint16_t order;            /*!< Position in the file */
+  uint8_t instance;          /*!< Object instance */
+};
+
+//******************************************************************************
+/// \brief Config file parsed into a single allocation
+///
+/// Objects are sorted by address, or kept in file order for OBP_RAW files
+/// which do not carry addresses until mxt_config_image_resolve() is called.
+struct mxt_config_image {
+  enum mxt_config_format format;
+  struct mxt_id_info id;
+  uint32_t info_crc;
+  uint32_t config_crc;
+  bool have_addresses;
+  int num_objects;
+  struct mxt_config_image_object *objects;
+};
+
+//******************************************************************************
+/// \brief Summary of differences between two config images
+struct mxt_config_diff {
+  int objects_compared;      /*!< Objects present in both images */
+  int objects_differ;        /*!< Objects with any differing byte */
+  int objects_missing;       /*!< Objects present in only one image */
+  size_t bytes_differ;       /*!< Differing bytes, including size mismatch */
+};
+
+bool mxt_object_used_for_crc(uint32_t type);
+bool mxt_object_is_volatile(uint16_t object_type);
+int mxt_config_image_parse(struct libmaxtouch_ctx *ctx, const char *buf,
+                           size_t len, struct mxt_config_image **image);
+int mxt_config_image_load(struct libmaxtouch_ctx *ctx, const char *filename,
+                          struct mxt_config_image **image);
+void mxt_config_image_free(struct mxt_config_image *image);
+int mxt_config_image_resolve(struct mxt_config_image *image,
+                             struct mxt_device *mxt);
+const struct mxt_config_image_object *mxt_config_image_find(
+  const struct mxt_config_image *image, uint16_t type, uint8_t instance);
+int mxt_config_image_crc_range(struct libmaxtouch_ctx *ctx,
+                               const struct mxt_config_image *image,
+                               uint32_t start, uint32_t end, uint32_t *crc);
+int mxt_config_image_calc_crc(struct libmaxtouch_ctx *ctx,
+                              const struct mxt_config_image *image,
+                              uint32_t *crc);
+int mxt_config_image_compare(struct libmaxtouch_ctx *ctx,
+                             const struct mxt_config_image *a,
+                             const struct mxt_config_image *b,
+                             struct mxt_config_diff *diff);
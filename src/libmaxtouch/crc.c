@@ -0,0 +1,348 @@
+//------------------------------------------------------------------------------
+/// \file   crc.c
+/// \brief  Table driven CRC24 and CRC8 checksum engines
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "libmaxtouch.h"
+#include "crc.h"
+
+/* The CRC24 step used by the device is crc = crc * x + word modulo
+ * P = x^24 + x^23 + x^4 + x^3 + x + 1. Eight steps are therefore
+ * crc * x^8 + sum(word[j] * x^(7 - j)): the word sum never exceeds 23 bits,
+ * so only the top byte of the old CRC needs reducing, by table lookup. */
+#define CRC24_POLY          0x0180001B
+#define CRC24_MASK          0x00FFFFFF
+#define CRC24_BLOCK_BYTES   16
+
+/* (b << 24) mod P, reduces the byte shifted out of a 24 bit state */
+static const uint32_t crc24_table[256] = {
+  0x000000, 0x80001B, 0x80002D, 0x000036, 0x800041, 0x00005A,
+  0x00006C, 0x800077, 0x800099, 0x000082, 0x0000B4, 0x8000AF,
+  0x0000D8, 0x8000C3, 0x8000F5, 0x0000EE, 0x800129, 0x000132,
+  0x000104, 0x80011F, 0x000168, 0x800173, 0x800145, 0x00015E,
+  0x0001B0, 0x8001AB, 0x80019D, 0x000186, 0x8001F1, 0x0001EA,
+  0x0001DC, 0x8001C7, 0x800249, 0x000252, 0x000264, 0x80027F,
+  0x000208, 0x800213, 0x800225, 0x00023E, 0x0002D0, 0x8002CB,
+  0x8002FD, 0x0002E6, 0x800291, 0x00028A, 0x0002BC, 0x8002A7,
+  0x000360, 0x80037B, 0x80034D, 0x000356, 0x800321, 0x00033A,
+  0x00030C, 0x800317, 0x8003F9, 0x0003E2, 0x0003D4, 0x8003CF,
+  0x0003B8, 0x8003A3, 0x800395, 0x00038E, 0x800489, 0x000492,
+  0x0004A4, 0x8004BF, 0x0004C8, 0x8004D3, 0x8004E5, 0x0004FE,
+  0x000410, 0x80040B, 0x80043D, 0x000426, 0x800451, 0x00044A,
+  0x00047C, 0x800467, 0x0005A0, 0x8005BB, 0x80058D, 0x000596,
+  0x8005E1, 0x0005FA, 0x0005CC, 0x8005D7, 0x800539, 0x000522,
+  0x000514, 0x80050F, 0x000578, 0x800563, 0x800555, 0x00054E,
+  0x0006C0, 0x8006DB, 0x8006ED, 0x0006F6, 0x800681, 0x00069A,
+  0x0006AC, 0x8006B7, 0x800659, 0x000642, 0x000674, 0x80066F,
+  0x000618, 0x800603, 0x800635, 0x00062E, 0x8007E9, 0x0007F2,
+  0x0007C4, 0x8007DF, 0x0007A8, 0x8007B3, 0x800785, 0x00079E,
+  0x000770, 0x80076B, 0x80075D, 0x000746, 0x800731, 0x00072A,
+  0x00071C, 0x800707, 0x800909, 0x000912, 0x000924, 0x80093F,
+  0x000948, 0x800953, 0x800965, 0x00097E, 0x000990, 0x80098B,
+  0x8009BD, 0x0009A6, 0x8009D1, 0x0009CA, 0x0009FC, 0x8009E7,
+  0x000820, 0x80083B, 0x80080D, 0x000816, 0x800861, 0x00087A,
+  0x00084C, 0x800857, 0x8008B9, 0x0008A2, 0x000894, 0x80088F,
+  0x0008F8, 0x8008E3, 0x8008D5, 0x0008CE, 0x000B40, 0x800B5B,
+  0x800B6D, 0x000B76, 0x800B01, 0x000B1A, 0x000B2C, 0x800B37,
+  0x800BD9, 0x000BC2, 0x000BF4, 0x800BEF, 0x000B98, 0x800B83,
+  0x800BB5, 0x000BAE, 0x800A69, 0x000A72, 0x000A44, 0x800A5F,
+  0x000A28, 0x800A33, 0x800A05, 0x000A1E, 0x000AF0, 0x800AEB,
+  0x800ADD, 0x000AC6, 0x800AB1, 0x000AAA, 0x000A9C, 0x800A87,
+  0x000D80, 0x800D9B, 0x800DAD, 0x000DB6, 0x800DC1, 0x000DDA,
+  0x000DEC, 0x800DF7, 0x800D19, 0x000D02, 0x000D34, 0x800D2F,
+  0x000D58, 0x800D43, 0x800D75, 0x000D6E, 0x800CA9, 0x000CB2,
+  0x000C84, 0x800C9F, 0x000CE8, 0x800CF3, 0x800CC5, 0x000CDE,
+  0x000C30, 0x800C2B, 0x800C1D, 0x000C06, 0x800C71, 0x000C6A,
+  0x000C5C, 0x800C47, 0x800FC9, 0x000FD2, 0x000FE4, 0x800FFF,
+  0x000F88, 0x800F93, 0x800FA5, 0x000FBE, 0x000F50, 0x800F4B,
+  0x800F7D, 0x000F66, 0x800F11, 0x000F0A, 0x000F3C, 0x800F27,
+  0x000EE0, 0x800EFB, 0x800ECD, 0x000ED6, 0x800EA1, 0x000EBA,
+  0x000E8C, 0x800E97, 0x800E79, 0x000E62, 0x000E54, 0x800E4F,
+  0x000E38, 0x800E23, 0x800E15, 0x000E0E
+};
+
+/* crc8_table[k][b] is the CRC of byte b followed by k zero bytes */
+static const uint8_t crc8_table[4][256] = {
+  {
+    0x00, 0x5E, 0xBC, 0xE2, 0x61, 0x3F, 0xDD, 0x83, 0xC2, 0x9C, 0x7E, 0x20,
+    0xA3, 0xFD, 0x1F, 0x41, 0x9D, 0xC3, 0x21, 0x7F, 0xFC, 0xA2, 0x40, 0x1E,
+    0x5F, 0x01, 0xE3, 0xBD, 0x3E, 0x60, 0x82, 0xDC, 0x23, 0x7D, 0x9F, 0xC1,
+    0x42, 0x1C, 0xFE, 0xA0, 0xE1, 0xBF, 0x5D, 0x03, 0x80, 0xDE, 0x3C, 0x62,
+    0xBE, 0xE0, 0x02, 0x5C, 0xDF, 0x81, 0x63, 0x3D, 0x7C, 0x22, 0xC0, 0x9E,
+    0x1D, 0x43, 0xA1, 0xFF, 0x46, 0x18, 0xFA, 0xA4, 0x27, 0x79, 0x9B, 0xC5,
+    0x84, 0xDA, 0x38, 0x66, 0xE5, 0xBB, 0x59, 0x07, 0xDB, 0x85, 0x67, 0x39,
+    0xBA, 0xE4, 0x06, 0x58, 0x19, 0x47, 0xA5, 0xFB, 0x78, 0x26, 0xC4, 0x9A,
+    0x65, 0x3B, 0xD9, 0x87, 0x04, 0x5A, 0xB8, 0xE6, 0xA7, 0xF9, 0x1B, 0x45,
+    0xC6, 0x98, 0x7A, 0x24, 0xF8, 0xA6, 0x44, 0x1A, 0x99, 0xC7, 0x25, 0x7B,
+    0x3A, 0x64, 0x86, 0xD8, 0x5B, 0x05, 0xE7, 0xB9, 0x8C, 0xD2, 0x30, 0x6E,
+    0xED, 0xB3, 0x51, 0x0F, 0x4E, 0x10, 0xF2, 0xAC, 0x2F, 0x71, 0x93, 0xCD,
+    0x11, 0x4F, 0xAD, 0xF3, 0x70, 0x2E, 0xCC, 0x92, 0xD3, 0x8D, 0x6F, 0x31,
+    0xB2, 0xEC, 0x0E, 0x50, 0xAF, 0xF1, 0x13, 0x4D, 0xCE, 0x90, 0x72, 0x2C,
+    0x6D, 0x33, 0xD1, 0x8F, 0x0C, 0x52, 0xB0, 0xEE, 0x32, 0x6C, 0x8E, 0xD0,
+    0x53, 0x0D, 0xEF, 0xB1, 0xF0, 0xAE, 0x4C, 0x12, 0x91, 0xCF, 0x2D, 0x73,
+    0xCA, 0x94, 0x76, 0x28, 0xAB, 0xF5, 0x17, 0x49, 0x08, 0x56, 0xB4, 0xEA,
+    0x69, 0x37, 0xD5, 0x8B, 0x57, 0x09, 0xEB, 0xB5, 0x36, 0x68, 0x8A, 0xD4,
+    0x95, 0xCB, 0x29, 0x77, 0xF4, 0xAA, 0x48, 0x16, 0xE9, 0xB7, 0x55, 0x0B,
+    0x88, 0xD6, 0x34, 0x6A, 0x2B, 0x75, 0x97, 0xC9, 0x4A, 0x14, 0xF6, 0xA8,
+    0x74, 0x2A, 0xC8, 0x96, 0x15, 0x4B, 0xA9, 0xF7, 0xB6, 0xE8, 0x0A, 0x54,
+    0xD7, 0x89, 0x6B, 0x35
+  },
+  {
+    0x00, 0xC4, 0x91, 0x55, 0x3B, 0xFF, 0xAA, 0x6E, 0x76, 0xB2, 0xE7, 0x23,
+    0x4D, 0x89, 0xDC, 0x18, 0xEC, 0x28, 0x7D, 0xB9, 0xD7, 0x13, 0x46, 0x82,
+    0x9A, 0x5E, 0x0B, 0xCF, 0xA1, 0x65, 0x30, 0xF4, 0xC1, 0x05, 0x50, 0x94,
+    0xFA, 0x3E, 0x6B, 0xAF, 0xB7, 0x73, 0x26, 0xE2, 0x8C, 0x48, 0x1D, 0xD9,
+    0x2D, 0xE9, 0xBC, 0x78, 0x16, 0xD2, 0x87, 0x43, 0x5B, 0x9F, 0xCA, 0x0E,
+    0x60, 0xA4, 0xF1, 0x35, 0x9B, 0x5F, 0x0A, 0xCE, 0xA0, 0x64, 0x31, 0xF5,
+    0xED, 0x29, 0x7C, 0xB8, 0xD6, 0x12, 0x47, 0x83, 0x77, 0xB3, 0xE6, 0x22,
+    0x4C, 0x88, 0xDD, 0x19, 0x01, 0xC5, 0x90, 0x54, 0x3A, 0xFE, 0xAB, 0x6F,
+    0x5A, 0x9E, 0xCB, 0x0F, 0x61, 0xA5, 0xF0, 0x34, 0x2C, 0xE8, 0xBD, 0x79,
+    0x17, 0xD3, 0x86, 0x42, 0xB6, 0x72, 0x27, 0xE3, 0x8D, 0x49, 0x1C, 0xD8,
+    0xC0, 0x04, 0x51, 0x95, 0xFB, 0x3F, 0x6A, 0xAE, 0x2F, 0xEB, 0xBE, 0x7A,
+    0x14, 0xD0, 0x85, 0x41, 0x59, 0x9D, 0xC8, 0x0C, 0x62, 0xA6, 0xF3, 0x37,
+    0xC3, 0x07, 0x52, 0x96, 0xF8, 0x3C, 0x69, 0xAD, 0xB5, 0x71, 0x24, 0xE0,
+    0x8E, 0x4A, 0x1F, 0xDB, 0xEE, 0x2A, 0x7F, 0xBB, 0xD5, 0x11, 0x44, 0x80,
+    0x98, 0x5C, 0x09, 0xCD, 0xA3, 0x67, 0x32, 0xF6, 0x02, 0xC6, 0x93, 0x57,
+    0x39, 0xFD, 0xA8, 0x6C, 0x74, 0xB0, 0xE5, 0x21, 0x4F, 0x8B, 0xDE, 0x1A,
+    0xB4, 0x70, 0x25, 0xE1, 0x8F, 0x4B, 0x1E, 0xDA, 0xC2, 0x06, 0x53, 0x97,
+    0xF9, 0x3D, 0x68, 0xAC, 0x58, 0x9C, 0xC9, 0x0D, 0x63, 0xA7, 0xF2, 0x36,
+    0x2E, 0xEA, 0xBF, 0x7B, 0x15, 0xD1, 0x84, 0x40, 0x75, 0xB1, 0xE4, 0x20,
+    0x4E, 0x8A, 0xDF, 0x1B, 0x03, 0xC7, 0x92, 0x56, 0x38, 0xFC, 0xA9, 0x6D,
+    0x99, 0x5D, 0x08, 0xCC, 0xA2, 0x66, 0x33, 0xF7, 0xEF, 0x2B, 0x7E, 0xBA,
+    0xD4, 0x10, 0x45, 0x81
+  },
+  {
+    0x00, 0xAB, 0x4F, 0xE4, 0x9E, 0x35, 0xD1, 0x7A, 0x25, 0x8E, 0x6A, 0xC1,
+    0xBB, 0x10, 0xF4, 0x5F, 0x4A, 0xE1, 0x05, 0xAE, 0xD4, 0x7F, 0x9B, 0x30,
+    0x6F, 0xC4, 0x20, 0x8B, 0xF1, 0x5A, 0xBE, 0x15, 0x94, 0x3F, 0xDB, 0x70,
+    0x0A, 0xA1, 0x45, 0xEE, 0xB1, 0x1A, 0xFE, 0x55, 0x2F, 0x84, 0x60, 0xCB,
+    0xDE, 0x75, 0x91, 0x3A, 0x40, 0xEB, 0x0F, 0xA4, 0xFB, 0x50, 0xB4, 0x1F,
+    0x65, 0xCE, 0x2A, 0x81, 0x31, 0x9A, 0x7E, 0xD5, 0xAF, 0x04, 0xE0, 0x4B,
+    0x14, 0xBF, 0x5B, 0xF0, 0x8A, 0x21, 0xC5, 0x6E, 0x7B, 0xD0, 0x34, 0x9F,
+    0xE5, 0x4E, 0xAA, 0x01, 0x5E, 0xF5, 0x11, 0xBA, 0xC0, 0x6B, 0x8F, 0x24,
+    0xA5, 0x0E, 0xEA, 0x41, 0x3B, 0x90, 0x74, 0xDF, 0x80, 0x2B, 0xCF, 0x64,
+    0x1E, 0xB5, 0x51, 0xFA, 0xEF, 0x44, 0xA0, 0x0B, 0x71, 0xDA, 0x3E, 0x95,
+    0xCA, 0x61, 0x85, 0x2E, 0x54, 0xFF, 0x1B, 0xB0, 0x62, 0xC9, 0x2D, 0x86,
+    0xFC, 0x57, 0xB3, 0x18, 0x47, 0xEC, 0x08, 0xA3, 0xD9, 0x72, 0x96, 0x3D,
+    0x28, 0x83, 0x67, 0xCC, 0xB6, 0x1D, 0xF9, 0x52, 0x0D, 0xA6, 0x42, 0xE9,
+    0x93, 0x38, 0xDC, 0x77, 0xF6, 0x5D, 0xB9, 0x12, 0x68, 0xC3, 0x27, 0x8C,
+    0xD3, 0x78, 0x9C, 0x37, 0x4D, 0xE6, 0x02, 0xA9, 0xBC, 0x17, 0xF3, 0x58,
+    0x22, 0x89, 0x6D, 0xC6, 0x99, 0x32, 0xD6, 0x7D, 0x07, 0xAC, 0x48, 0xE3,
+    0x53, 0xF8, 0x1C, 0xB7, 0xCD, 0x66, 0x82, 0x29, 0x76, 0xDD, 0x39, 0x92,
+    0xE8, 0x43, 0xA7, 0x0C, 0x19, 0xB2, 0x56, 0xFD, 0x87, 0x2C, 0xC8, 0x63,
+    0x3C, 0x97, 0x73, 0xD8, 0xA2, 0x09, 0xED, 0x46, 0xC7, 0x6C, 0x88, 0x23,
+    0x59, 0xF2, 0x16, 0xBD, 0xE2, 0x49, 0xAD, 0x06, 0x7C, 0xD7, 0x33, 0x98,
+    0x8D, 0x26, 0xC2, 0x69, 0x13, 0xB8, 0x5C, 0xF7, 0xA8, 0x03, 0xE7, 0x4C,
+    0x36, 0x9D, 0x79, 0xD2
+  },
+  {
+    0x00, 0x8F, 0x07, 0x88, 0x0E, 0x81, 0x09, 0x86, 0x1C, 0x93, 0x1B, 0x94,
+    0x12, 0x9D, 0x15, 0x9A, 0x38, 0xB7, 0x3F, 0xB0, 0x36, 0xB9, 0x31, 0xBE,
+    0x24, 0xAB, 0x23, 0xAC, 0x2A, 0xA5, 0x2D, 0xA2, 0x70, 0xFF, 0x77, 0xF8,
+    0x7E, 0xF1, 0x79, 0xF6, 0x6C, 0xE3, 0x6B, 0xE4, 0x62, 0xED, 0x65, 0xEA,
+    0x48, 0xC7, 0x4F, 0xC0, 0x46, 0xC9, 0x41, 0xCE, 0x54, 0xDB, 0x53, 0xDC,
+    0x5A, 0xD5, 0x5D, 0xD2, 0xE0, 0x6F, 0xE7, 0x68, 0xEE, 0x61, 0xE9, 0x66,
+    0xFC, 0x73, 0xFB, 0x74, 0xF2, 0x7D, 0xF5, 0x7A, 0xD8, 0x57, 0xDF, 0x50,
+    0xD6, 0x59, 0xD1, 0x5E, 0xC4, 0x4B, 0xC3, 0x4C, 0xCA, 0x45, 0xCD, 0x42,
+    0x90, 0x1F, 0x97, 0x18, 0x9E, 0x11, 0x99, 0x16, 0x8C, 0x03, 0x8B, 0x04,
+    0x82, 0x0D, 0x85, 0x0A, 0xA8, 0x27, 0xAF, 0x20, 0xA6, 0x29, 0xA1, 0x2E,
+    0xB4, 0x3B, 0xB3, 0x3C, 0xBA, 0x35, 0xBD, 0x32, 0xD9, 0x56, 0xDE, 0x51,
+    0xD7, 0x58, 0xD0, 0x5F, 0xC5, 0x4A, 0xC2, 0x4D, 0xCB, 0x44, 0xCC, 0x43,
+    0xE1, 0x6E, 0xE6, 0x69, 0xEF, 0x60, 0xE8, 0x67, 0xFD, 0x72, 0xFA, 0x75,
+    0xF3, 0x7C, 0xF4, 0x7B, 0xA9, 0x26, 0xAE, 0x21, 0xA7, 0x28, 0xA0, 0x2F,
+    0xB5, 0x3A, 0xB2, 0x3D, 0xBB, 0x34, 0xBC, 0x33, 0x91, 0x1E, 0x96, 0x19,
+    0x9F, 0x10, 0x98, 0x17, 0x8D, 0x02, 0x8A, 0x05, 0x83, 0x0C, 0x84, 0x0B,
+    0x39, 0xB6, 0x3E, 0xB1, 0x37, 0xB8, 0x30, 0xBF, 0x25, 0xAA, 0x22, 0xAD,
+    0x2B, 0xA4, 0x2C, 0xA3, 0x01, 0x8E, 0x06, 0x89, 0x0F, 0x80, 0x08, 0x87,
+    0x1D, 0x92, 0x1A, 0x95, 0x13, 0x9C, 0x14, 0x9B, 0x49, 0xC6, 0x4E, 0xC1,
+    0x47, 0xC8, 0x40, 0xCF, 0x55, 0xDA, 0x52, 0xDD, 0x5B, 0xD4, 0x5C, 0xD3,
+    0x71, 0xFE, 0x76, 0xF9, 0x7F, 0xF0, 0x78, 0xF7, 0x6D, 0xE2, 0x6A, 0xE5,
+    0x63, 0xEC, 0x64, 0xEB
+  }
+};
+
+//******************************************************************************
+/// \brief Add a single 16-bit word to the CRC
+static inline uint32_t crc24_word(uint32_t crc, uint8_t lsb, uint8_t msb)
+{
+  crc = (crc << 1) ^ ((uint32_t)msb << 8) ^ lsb;
+  if (crc & 0x1000000)
+    crc ^= CRC24_POLY;
+
+  return crc;
+}
+
+//******************************************************************************
+/// \brief Add whole 16-byte blocks followed by any remaining words
+static uint32_t crc24_words(uint32_t crc, const uint8_t *p, size_t len)
+{
+  uint32_t d;
+
+  while (len >= CRC24_BLOCK_BYTES) {
+    d = ((uint32_t)(p[0] | p[1] << 8) << 7)
+        ^ ((uint32_t)(p[2] | p[3] << 8) << 6)
+        ^ ((uint32_t)(p[4] | p[5] << 8) << 5)
+        ^ ((uint32_t)(p[6] | p[7] << 8) << 4)
+        ^ ((uint32_t)(p[8] | p[9] << 8) << 3)
+        ^ ((uint32_t)(p[10] | p[11] << 8) << 2)
+        ^ ((uint32_t)(p[12] | p[13] << 8) << 1)
+        ^ (uint32_t)(p[14] | p[15] << 8);
+
+    crc = ((crc << 8) & CRC24_MASK) ^ crc24_table[crc >> 16] ^ d;
+
+    p += CRC24_BLOCK_BYTES;
+    len -= CRC24_BLOCK_BYTES;
+  }
+
+  while (len >= 2) {
+    crc = crc24_word(crc, p[0], p[1]);
+    p += 2;
+    len -= 2;
+  }
+
+  return crc;
+}
+
+//******************************************************************************
+/// \brief Start a new CRC24 calculation
+void mxt_crc24_init(struct mxt_crc24_ctx *c)
+{
+  c->crc = 0;
+  c->odd_byte = 0;
+  c->odd = false;
+}
+
+//******************************************************************************
+/// \brief Add bytes to a running CRC24
+void mxt_crc24_update(struct mxt_crc24_ctx *c, const uint8_t *buf, size_t len)
+{
+  if (!len)
+    return;
+
+  if (c->odd) {
+    c->crc = crc24_word(c->crc, c->odd_byte, buf[0]);
+    c->odd = false;
+    buf++;
+    len--;
+  }
+
+  c->crc = crc24_words(c->crc, buf, len);
+
+  if (len & 1) {
+    c->odd_byte = buf[len - 1];
+    c->odd = true;
+  }
+}
+
+//******************************************************************************
+/// \brief Add a run of zero bytes, for example unused space between objects,
+///        without needing a buffer for them
+void mxt_crc24_update_zeros(struct mxt_crc24_ctx *c, size_t len)
+{
+  uint32_t crc = c->crc;
+
+  if (!len)
+    return;
+
+  if (c->odd) {
+    crc = crc24_word(crc, c->odd_byte, 0);
+    c->odd = false;
+    len--;
+  }
+
+  /* A block of zero words is a multiply by x^8 */
+  while (len >= CRC24_BLOCK_BYTES) {
+    crc = ((crc << 8) & CRC24_MASK) ^ crc24_table[crc >> 16];
+    len -= CRC24_BLOCK_BYTES;
+  }
+
+  while (len >= 2) {
+    crc = crc24_word(crc, 0, 0);
+    len -= 2;
+  }
+
+  if (len) {
+    c->odd_byte = 0;
+    c->odd = true;
+  }
+
+  c->crc = crc;
+}
+
+//******************************************************************************
+/// \brief Finish a CRC24, padding an odd length with a zero byte
+/// \return 24-bit checksum
+uint32_t mxt_crc24_final(const struct mxt_crc24_ctx *c)
+{
+  uint32_t crc = c->crc;
+
+  if (c->odd)
+    crc = crc24_word(crc, c->odd_byte, 0);
+
+  return crc & CRC24_MASK;
+}
+
+//******************************************************************************
+/// \brief Calculate the CRC24 of a buffer
+/// \return 24-bit checksum
+uint32_t mxt_crc24(const uint8_t *buf, size_t len)
+{
+  uint32_t crc = crc24_words(0, buf, len);
+
+  if (len & 1)
+    crc = crc24_word(crc, buf[len - 1], 0);
+
+  return crc & CRC24_MASK;
+}
+
+//******************************************************************************
+/// \brief Continue an 8-bit CRC over a buffer, four bytes at a time
+/// \return Updated CRC
+uint8_t mxt_crc8(uint8_t crc, const uint8_t *buf, size_t len)
+{
+  while (len >= 4) {
+    crc = crc8_table[3][crc ^ buf[0]] ^ crc8_table[2][buf[1]]
+          ^ crc8_table[1][buf[2]] ^ crc8_table[0][buf[3]];
+    buf += 4;
+    len -= 4;
+  }
+
+  while (len--)
+    crc = crc8_table[0][crc ^ *buf++];
+
+  return crc;
+}
+
+//******************************************************************************
+/// \brief Calculate the 8bit CRC
+uint8_t mxt_calc_crc8(unsigned char crc, unsigned char data)
+{
+  return crc8_table[0][(uint8_t)(crc ^ data)];
+}
@@ -0,0 +1,51 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   crc.h
+/// \brief  CRC24 and CRC8 checksum engines
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//******************************************************************************
+/// \brief Running CRC24 over a byte stream
+///
+/// The device checksum is calculated over little-endian 16-bit words, so a
+/// trailing odd byte is held until the next update or mxt_crc24_final().
+struct mxt_crc24_ctx {
+  uint32_t crc;
+  uint8_t odd_byte;
+  bool odd;
+};
+
+void mxt_crc24_init(struct mxt_crc24_ctx *c);
+void mxt_crc24_update(struct mxt_crc24_ctx *c, const uint8_t *buf, size_t len);
+void mxt_crc24_update_zeros(struct mxt_crc24_ctx *c, size_t len);
+uint32_t mxt_crc24_final(const struct mxt_crc24_ctx *c);
+uint32_t mxt_crc24(const uint8_t *buf, size_t len);
+uint8_t mxt_crc8(uint8_t crc, const uint8_t *buf, size_t len);
+uint8_t mxt_calc_crc8(unsigned char crc, unsigned char data);
@@ -46,8 +46,6 @@ int debugfs_set_debug_irq(struct mxt_device *mxt, bool debug_state);
 int debugfs_get_tx_seq_num(struct mxt_device *mxt, uint16_t *value);
 int debugfs_set_tx_seq_num(struct mxt_device *mxt, uint8_t value);
 int debugfs_get_crc_enabled(struct mxt_device *mxt, bool *value);
-static int read_debugfs_byte(struct mxt_device *mxt, char *filename, uint16_t *value);
-static int write_debugfs_byte(struct mxt_device *mxt, const char *filename, uint8_t value);
 int debugfs_update_seq_num(struct mxt_device *mxt, uint8_t value);
 
 
@@ -0,0 +1,165 @@
+//------------------------------------------------------------------------------
+/// \file   gpio_chg.c
+/// \brief  MXT CHG line monitoring via GPIO character device
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "gpio_chg.h"
+
+#define GPIO_CHG_CONSUMER "mxt-app CHG"
+
+//******************************************************************************
+/// \brief  Request CHG line events from GPIO chip
+/// \note   CHG is active low, so falling edges signal new messages
+/// \param  mxt  Device context
+/// \param  chip GPIO chip number, eg 0 for /dev/gpiochip0
+/// \param  line Line offset of CHG on GPIO chip
+/// \return #mxt_rc
+int gpio_chg_open(struct mxt_device *mxt, int chip, int line)
+{
+  struct gpioevent_request req;
+  char filename[32];
+  int fd;
+  int ret;
+
+  gpio_chg_close(mxt);
+
+  snprintf(filename, sizeof(filename), "/dev/gpiochip%d", chip);
+  fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    mxt_err(mxt->ctx, "Could not open %s, error %s (%d)", filename, strerror(errno), errno);
+    return mxt_errno_to_rc(errno);
+  }
+
+  memset(&req, 0, sizeof(req));
+  req.lineoffset = line;
+  req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+  req.eventflags = GPIOEVENT_REQUEST_FALLING_EDGE;
+  strncpy(req.consumer_label, GPIO_CHG_CONSUMER, sizeof(req.consumer_label) - 1);
+
+  ret = ioctl(fd, GPIO_GET_LINEEVENT_IOCTL, &req);
+  if (ret < 0) {
+    mxt_err(mxt->ctx, "Could not request line %d on %s, error %s (%d)",
+            line, filename, strerror(errno), errno);
+    ret = mxt_errno_to_rc(errno);
+    close(fd);
+    return ret;
+  }
+
+  close(fd);
+
+  /* Events are drained without blocking before each level check */
+  fcntl(req.fd, F_SETFL, fcntl(req.fd, F_GETFL) | O_NONBLOCK);
+
+  mxt->chg_gpio_fd = req.fd;
+
+  mxt_info(mxt->ctx, "CHG line on %s line %d", filename, line);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Release CHG line
+void gpio_chg_close(struct mxt_device *mxt)
+{
+  if (mxt->chg_gpio_fd >= 0) {
+    close(mxt->chg_gpio_fd);
+    mxt->chg_gpio_fd = -1;
+  }
+}
+
+//******************************************************************************
+/// \brief  Discard queued edge events and read CHG level
+/// \param  mxt  Device context
+/// \param  asserted true if CHG is low, ie messages are pending
+/// \return #mxt_rc
+int gpio_chg_read(struct mxt_device *mxt, bool *asserted)
+{
+  struct gpioevent_data event;
+  struct gpiohandle_data data;
+  int ret;
+
+  while (read(mxt->chg_gpio_fd, &event, sizeof(event)) == sizeof(event))
+    ;
+
+  memset(&data, 0, sizeof(data));
+
+  ret = ioctl(mxt->chg_gpio_fd, GPIOHANDLE_GET_LINE_VALUES_IOCTL, &data);
+  if (ret < 0) {
+    mxt_err(mxt->ctx, "Could not read CHG line, error %s (%d)", strerror(errno), errno);
+    return mxt_errno_to_rc(errno);
+  }
+
+  *asserted = (data.values[0] == 0);
+
+  mxt_verb(mxt->ctx, "CHG line %s", *asserted ? "LOW" : "HIGH");
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Wait for CHG to be asserted
+/// \return #mxt_rc, MXT_ERROR_TIMEOUT if no messages pending
+int gpio_chg_wait(struct mxt_device *mxt, int timeout_ms)
+{
+  struct pollfd fds[1];
+  bool asserted;
+  int ret;
+
+  ret = gpio_chg_read(mxt, &asserted);
+  if (ret)
+    return ret;
+
+  if (asserted)
+    return MXT_SUCCESS;
+
+  fds[0].fd = mxt->chg_gpio_fd;
+  fds[0].events = POLLIN;
+
+  ret = poll(fds, 1, timeout_ms);
+  if (ret == -1 && errno == EINTR) {
+    mxt_dbg(mxt->ctx, "Interrupted");
+    return MXT_ERROR_INTERRUPTED;
+  } else if (ret < 0) {
+    mxt_err(mxt->ctx, "poll returned %d (%s)", errno, strerror(errno));
+    return MXT_ERROR_IO;
+  } else if (ret == 0) {
+    return MXT_ERROR_TIMEOUT;
+  }
+
+  return MXT_SUCCESS;
+}
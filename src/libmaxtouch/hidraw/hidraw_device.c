@@ -37,25 +37,27 @@
 #include <string.h>
 #include <endian.h>
 #include <errno.h>
+#include <poll.h>
+#include <time.h>
 
 struct mxt_device;
 struct mxt_conn_info;
 
 #include "hidraw_device.h"
 #include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/info_block.h"
 
 #define HIDRAW_CMD_ID             0x51
 
 #define MXT_HID_READ_SUCCESS      0x04
 
-#define MXT_HID_READ_DATA_SIZE    15
+#define MXT_HID_READ_DATA_SIZE    HIDRAW_MAX_READ_SIZE
 #define MXT_HID_WRITE_DATA_SIZE   12
 
 #define MXT_HID_ADDR_SIZE         0x02
 
 #define HIDRAW_WRITE_RETRY_DELAY_US     25000
-#define HIDRAW_READ_RETRY_DELAY_US      250
-#define HIDRAW_TIMEOUT_DELAY_US         500
+#define HIDRAW_RESPONSE_TIMEOUT_MS      100
 
 
 struct hid_packet {
@@ -91,11 +93,22 @@ int hidraw_register(struct mxt_device *mxt)
 }
 
 //******************************************************************************
-/// \brief  Open the hidraw dev interface and set the slave address
+/// \brief  Open the hidraw dev interface
+/// \note   The file descriptor is kept open for later transfers unless the
+///         context has reopen_fd set
 /// \return #mxt_rc
 static int hidraw_open(struct mxt_device *mxt)
 {
   char filename[20];
+  uint8_t pkt[sizeof(struct hid_packet)];
+
+  if (mxt->conn->hidraw.fd >= 0) {
+    /* Discard any input reports queued since the last transfer */
+    while (read(mxt->conn->hidraw.fd, pkt, sizeof(pkt)) > 0)
+      ;
+
+    return MXT_SUCCESS;
+  }
 
   snprintf(filename, sizeof(filename), "%s", mxt->conn->hidraw.node);
   mxt->conn->hidraw.fd = open(filename, O_RDWR|O_NONBLOCK);
@@ -109,16 +122,34 @@ static int hidraw_open(struct mxt_device *mxt)
   return MXT_SUCCESS;
 }
 
+//******************************************************************************
+/// \brief  Finish with the hidraw dev interface after a transfer
+/// \note   Closes it if reopen_fd is set or the transfer failed
+static void hidraw_close(struct mxt_device *mxt, int ret)
+{
+  if (mxt->conn->hidraw.fd < 0)
+    return;
+
+  if (!mxt->ctx->reopen_fd && ret == MXT_SUCCESS)
+    return;
+
+  close(mxt->conn->hidraw.fd);
+  mxt->conn->hidraw.fd = -1;
+}
+
 //******************************************************************************
 /// \brief  Release device
 void hidraw_release(struct mxt_device *mxt)
 {
-  return;
+  if (mxt->conn->hidraw.fd >= 0) {
+    close(mxt->conn->hidraw.fd);
+    mxt->conn->hidraw.fd = -1;
+  }
 }
 
 //******************************************************************************
 /// \brief  Write packet to MXT chip
-/// \return Number of databytes sent
+/// \return #mxt_rc
 static int hidraw_write_packet(struct mxt_device *mxt, struct hid_packet *write_pkt, uint8_t *byte_count)
 {
   int ret;
@@ -126,11 +157,12 @@ static int hidraw_write_packet(struct mxt_device *mxt, struct hid_packet *write_
 
   if ((ret = write(mxt->conn->hidraw.fd, write_pkt, pkt_size)) != pkt_size) {
     mxt_verb(mxt->ctx, "HIDRAW retry");
+    mxt->io_stats.retries++;
     usleep(HIDRAW_WRITE_RETRY_DELAY_US);
-    if ((ret = write(mxt->conn->hidraw.fd, &write_pkt, pkt_size)) != pkt_size) {
+    if ((ret = write(mxt->conn->hidraw.fd, write_pkt, pkt_size)) != pkt_size) {
       mxt_err(mxt->ctx, "Error %s (%d) writing to hidraw",
               strerror(errno), errno);
-      ret = mxt_errno_to_rc(errno);
+      return ret < 0 ? mxt_errno_to_rc(errno) : MXT_ERROR_IO;
     }
   }
 
@@ -148,69 +180,186 @@ static int hidraw_write_packet(struct mxt_device *mxt, struct hid_packet *write_
 //******************************************************************************
 /// \brief  Write read command packet to MXT chip
 /// \return #mxt_rc
-static int hidraw_write_read_cmd(struct mxt_device *mxt, uint16_t start_register, uint8_t count, uint8_t *byte_count)
+static int hidraw_write_read_cmd(struct mxt_device *mxt, uint16_t start_register, uint8_t count)
 {
   struct hid_packet cmd_pkt = { 0 };
+  uint8_t byte_count;
 
   cmd_pkt.report_id = mxt->conn->hidraw.report_id;
-  cmd_pkt.cmd = 0x51;
+  cmd_pkt.cmd = HIDRAW_CMD_ID;
   cmd_pkt.rx_bytes = 2;      /* includes start address word */
   cmd_pkt.tx_bytes = count;
   cmd_pkt.address = htole16(start_register);
 
   mxt_dbg(mxt->ctx, "Sending read command");
 
-  return hidraw_write_packet(mxt, &cmd_pkt, byte_count);
+  return hidraw_write_packet(mxt, &cmd_pkt, &byte_count);
 }
 
 //******************************************************************************
-/// \brief  Read packet from MXT chip
-/// \return #mxt_rc
+/// \brief  Milliseconds left until deadline
+static int hidraw_remaining_ms(const struct timespec *deadline)
+{
+  struct timespec now;
+  long ms;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  ms = (deadline->tv_sec - now.tv_sec) * 1000
+       + (deadline->tv_nsec - now.tv_nsec) / 1000000;
+
+  return ms > 0 ? ms : 0;
+}
+
+//******************************************************************************
+/// \brief  Wait for a response packet from MXT chip
+/// \note   Input reports with another report ID (touch reports sharing the
+///         node) are skipped
+/// \param  count  Minimum length of a valid response, including report ID
+/// \return #mxt_rc, MXT_ERROR_TIMEOUT if no response arrived in time
 static int hidraw_read_response(struct mxt_device *mxt, struct hid_packet *read_pkt,
-                                size_t count)
+                                size_t count, int timeout_ms)
 {
-  ssize_t ret = 0;
-  size_t t_count = 0;
-  int timeout = 0;
-
-  do {
-    ret = read(mxt->conn->hidraw.fd, read_pkt + t_count, count);
-    if ((size_t)ret != count) {
-      mxt_dbg(mxt->ctx, "Error %s (%d) reading from hidraw",
+  struct pollfd pfd;
+  struct timespec deadline;
+  ssize_t ret;
+  int remaining;
+
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_sec += timeout_ms / 1000;
+  deadline.tv_nsec += (timeout_ms % 1000) * 1000000L;
+  if (deadline.tv_nsec >= 1000000000L) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000L;
+  }
+
+  pfd.fd = mxt->conn->hidraw.fd;
+  pfd.events = POLLIN;
+
+  while (true) {
+    ret = read(mxt->conn->hidraw.fd, read_pkt, sizeof(struct hid_packet));
+    if (ret < 0 && errno != EAGAIN && errno != EINTR) {
+      mxt_err(mxt->ctx, "Error %s (%d) reading from hidraw",
               strerror(errno), errno);
-      ret = mxt_errno_to_rc(errno);
-    } else {
-      t_count += (size_t)ret;
+      return mxt_errno_to_rc(errno);
+    } else if (ret > 0 && read_pkt->report_id == mxt->conn->hidraw.report_id) {
+      break;
+    } else if (ret > 0) {
+      mxt_verb(mxt->ctx, "Skipping input report ID %d", read_pkt->report_id);
+      ret = 0;
+    }
+
+    remaining = hidraw_remaining_ms(&deadline);
+    if (remaining == 0)
+      break;
+
+    ret = poll(&pfd, 1, remaining);
+    if (ret < 0 && errno != EINTR) {
+      mxt_err(mxt->ctx, "poll returned %d (%s)", errno, strerror(errno));
+      return MXT_ERROR_IO;
     }
-    usleep(HIDRAW_READ_RETRY_DELAY_US);
-  } while (timeout++ <= HIDRAW_TIMEOUT_DELAY_US && t_count != count);
+  }
+
+  if (ret <= 0) {
+    mxt_dbg(mxt->ctx, "Timed out waiting for hidraw response");
+    return MXT_ERROR_TIMEOUT;
+  }
 
-  mxt_dbg(mxt->ctx, "No. bytes requested: %zu, No. of bytes read: %zu",
-          count, t_count);
   mxt_log_buffer(mxt->ctx, LOG_VERBOSE, "RD PKT RX:",
-                 (const unsigned char *) read_pkt, count);
+                 (const unsigned char *) read_pkt, ret);
+
+  if ((size_t)ret < count) {
+    mxt_err(mxt->ctx, "Short hidraw response: %zd bytes, expected %zu",
+            ret, count);
+    return MXT_ERROR_IO;
+  }
+
   return MXT_SUCCESS;
 }
 
 //******************************************************************************
-/// \brief  Read packet from MXT chip
+/// \brief  Read registers with up to depth read commands outstanding
+/// \note   Responses carry no address, they are matched to commands by order
+/// \param  done  Number of bytes received in order before any error
 /// \return #mxt_rc
-static int hidraw_read_packet(struct mxt_device *mxt, struct hid_packet *read_pkt,
-                              uint16_t start_register, size_t count)
+static int hidraw_read_queued(struct mxt_device *mxt, unsigned char *buf,
+                              uint16_t start_register, size_t count,
+                              int depth, size_t *done)
 {
-  int pkt_count = count + 3;
-  int ret = 0;
-  uint8_t byte_count = 0;
+  struct hid_packet read_pkt;
+  size_t requested = 0;
+  size_t received = 0;
+  size_t len;
+  int queued = 0;
+  int ret = MXT_SUCCESS;
+
+  while (received < count) {
+    while (queued < depth && requested < count) {
+      len = count - requested;
+      if (len > MXT_HID_READ_DATA_SIZE)
+        len = MXT_HID_READ_DATA_SIZE;
+
+      ret = hidraw_write_read_cmd(mxt, start_register + requested, len);
+      if (ret)
+        goto out;
+
+      requested += len;
+      queued++;
+    }
 
-  ret = hidraw_write_read_cmd(mxt, start_register, count, &byte_count);
-  if (ret)
-    return ret;
+    len = count - received;
+    if (len > MXT_HID_READ_DATA_SIZE)
+      len = MXT_HID_READ_DATA_SIZE;
 
-  ret = hidraw_read_response(mxt, read_pkt, pkt_count);
-  if (ret < 0)
-    return ret;
+    /* report ID, result and byte count precede the data */
+    ret = hidraw_read_response(mxt, &read_pkt, len + 3,
+                               HIDRAW_RESPONSE_TIMEOUT_MS);
+    if (ret)
+      goto out;
+
+    memcpy(buf + received, read_pkt.read_data, len);
+    received += len;
+    queued--;
+  }
+
+out:
+  *done = received;
+  return ret;
+}
+
+//******************************************************************************
+/// \brief  Find out whether the firmware answers read commands sent back to back
+/// \note   Responses carry no address, so firmware which drops a command
+///         received while busy would shift every later response. Two reads of
+///         the static start of the information block are queued and both
+///         responses must arrive and match.
+static void hidraw_probe_read_depth(struct mxt_device *mxt)
+{
+  struct hid_packet pkt[2];
+  int ret, i;
+
+  mxt->conn->hidraw.read_depth = 1;
+
+  for (i = 0; i < 2; i++) {
+    ret = hidraw_write_read_cmd(mxt, 0, sizeof(struct mxt_id_info));
+    if (ret)
+      return;
+  }
+
+  for (i = 0; i < 2; i++) {
+    ret = hidraw_read_response(mxt, &pkt[i], sizeof(struct mxt_id_info) + 3,
+                               HIDRAW_RESPONSE_TIMEOUT_MS);
+    if (ret) {
+      mxt_dbg(mxt->ctx, "Firmware does not queue read commands");
+      hidraw_open(mxt);
+      return;
+    }
+  }
 
-  return ret - 3;
+  if (memcmp(pkt[0].read_data, pkt[1].read_data, sizeof(struct mxt_id_info)))
+    return;
+
+  mxt->conn->hidraw.read_depth = HIDRAW_READ_QUEUE_DEPTH;
+  mxt_dbg(mxt->ctx, "Queueing up to %d read commands", HIDRAW_READ_QUEUE_DEPTH);
 }
 
 //******************************************************************************
@@ -220,9 +369,8 @@ int hidraw_read_register(struct mxt_device *mxt, unsigned char *buf,
                          uint16_t start_register, size_t count,
                          size_t *bytes_transferred)
 {
-
   int ret;
-  struct hid_packet read_pkt = { 0 };
+  size_t bytes_read = 0;
 
   mxt_dbg(mxt->ctx, "%s - start_register:%d No. bytes requested:%zu",
           __func__, start_register, count);
@@ -231,26 +379,20 @@ int hidraw_read_register(struct mxt_device *mxt, unsigned char *buf,
   if (ret)
     return ret;
 
-  size_t bytes_read = 0;
-  while (bytes_read < count) {
-    ret = hidraw_read_packet(mxt, &read_pkt,
-                             start_register + bytes_read,
-                             (count - bytes_read <= MXT_HID_READ_DATA_SIZE ? count - bytes_read : MXT_HID_READ_DATA_SIZE));
-    if (ret < 0) {
-      mxt_dbg(mxt->ctx, "read error %s (%d)", strerror(errno), errno);
-      ret = mxt_errno_to_rc(errno);
-    }
-
-    memcpy(buf + bytes_read, read_pkt.read_data, ret);
+  if (mxt->conn->hidraw.read_depth == 0 && count > MXT_HID_READ_DATA_SIZE)
+    hidraw_probe_read_depth(mxt);
 
-    bytes_read += ret;
-  }
+  ret = hidraw_read_queued(mxt, buf, start_register, count,
+                           count > MXT_HID_READ_DATA_SIZE ? mxt->conn->hidraw.read_depth : 1,
+                           &bytes_read);
+  if (ret)
+    mxt_err(mxt->ctx, "hidraw read of %zu bytes from %d failed after %zu bytes",
+            count, start_register, bytes_read);
 
   *bytes_transferred = bytes_read;
 
-  close(mxt->conn->hidraw.fd);
-  mxt->conn->hidraw.fd = 0;
-  return MXT_SUCCESS;
+  hidraw_close(mxt, ret);
+  return ret;
 }
 
 //******************************************************************************
@@ -280,12 +422,12 @@ int hidraw_write_register(struct mxt_device *mxt, unsigned char const *val, uint
     write_pkt.rx_bytes = MXT_HID_ADDR_SIZE +
                          (datalength - bytes_written <= MXT_HID_WRITE_DATA_SIZE ? datalength - bytes_written : MXT_HID_WRITE_DATA_SIZE);
     write_pkt.address = htole16(start_register + bytes_written);
-    memcpy(write_pkt.write_data, val + bytes_written, write_pkt.rx_bytes);
+    memcpy(write_pkt.write_data, val + bytes_written,
+           write_pkt.rx_bytes - MXT_HID_ADDR_SIZE);
 
     ret =  hidraw_write_packet(mxt, &write_pkt, &byte_count);
     if (ret) {
-      mxt_err(mxt->ctx, "read error %s (%d)", strerror(errno), errno);
-      ret = mxt_errno_to_rc(errno);
+      mxt_err(mxt->ctx, "write error %s (%d)", strerror(errno), errno);
       goto close;
     }
     bytes_written += byte_count;
@@ -294,14 +436,18 @@ int hidraw_write_register(struct mxt_device *mxt, unsigned char const *val, uint
     struct hid_packet response_pkt;
     memset(&response_pkt, 0x00, sizeof(struct hid_packet));
 
-    ret = hidraw_read_response(mxt, &response_pkt, 2);
-    if (response_pkt.result != MXT_HID_READ_SUCCESS)
+    ret = hidraw_read_response(mxt, &response_pkt, 2,
+                               HIDRAW_RESPONSE_TIMEOUT_MS);
+    if (ret || response_pkt.result != MXT_HID_READ_SUCCESS) {
       mxt_err(mxt->ctx, "HIDRAW write failed: 0x%x",
               response_pkt.result);
+      if (!ret)
+        ret = MXT_ERROR_IO;
+      goto close;
+    }
   }
 
 close:
-  close(mxt->conn->hidraw.fd);
-  mxt->conn->hidraw.fd = 0;
-  return MXT_SUCCESS;
+  hidraw_close(mxt, ret);
+  return ret;
 }
@@ -30,12 +30,20 @@
 
 #define HIDRAW_REPORT_ID   0x06
 
+/* Data bytes returned by a single read response packet */
+#define HIDRAW_MAX_READ_SIZE  15
+
+/* Read commands queued ahead of their responses */
+#define HIDRAW_READ_QUEUE_DEPTH  4
+
 //******************************************************************************
 /// \brief Device information for hidraw-dev backend
 struct hidraw_conn_info {
   char node[20];
   uint8_t report_id;
   int fd;
+  /* Read commands the firmware accepts back to back, 0 until probed */
+  int read_depth;
 };
 
 int hidraw_register(struct mxt_device *mxt);
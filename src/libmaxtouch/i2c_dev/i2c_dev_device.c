@@ -35,14 +35,27 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
 
 struct mxt_device;
 struct mxt_conn_info;
 
 #include "i2c_dev_device.h"
 #include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/crc.h"
 
+#ifndef I2C_SLAVE_FORCE
 #define I2C_SLAVE_FORCE 0x0706
+#endif
+
+/* Largest payload of one CRC mode write frame */
+#define I2C_CRC_MAX_DATA 11
+
+/* Address, tx seq num and CRC8 bytes around each frame */
+#define I2C_CRC_FRAME_OVERHEAD 4
+
+#define I2C_CRC_MAX_RETRIES 10
 
 /* Deep sleep retry delay 25 ms */
 #define I2C_RETRY_DELAY 25000
@@ -64,35 +77,103 @@ int i2c_dev_open(struct mxt_device *mxt)
 /// \brief  Release device
 void i2c_dev_release(struct mxt_device *mxt)
 {
+  if (mxt->conn->i2c_dev.fd >= 0) {
+    close(mxt->conn->i2c_dev.fd);
+    mxt->conn->i2c_dev.fd = -1;
+    mxt->conn->i2c_dev.fd_address = -1;
+  }
 }
 
 //******************************************************************************
 /// \brief  Open the i2c dev interface and set the slave address
+/// \note   The file descriptor is cached on the connection and reused for
+///         later transfers unless the context has reopen_fd set
 /// \return #mxt_rc
 static int open_and_set_slave_address(struct mxt_device *mxt, int *fd_out)
 {
+  struct i2c_dev_conn_info *conn = &mxt->conn->i2c_dev;
   int fd;
   int ret;
   char filename[20];
 
-  snprintf(filename, 19, "/dev/i2c-%d", mxt->conn->i2c_dev.adapter);
-  fd = open(filename, O_RDWR);
-  if (fd < 0) {
-    mxt_err(mxt->ctx, "Could not open %s, error %s (%d)", filename, strerror(errno), errno);
-    return mxt_errno_to_rc(errno);
+  if (conn->fd >= 0) {
+    fd = conn->fd;
+  } else {
+    snprintf(filename, 19, "/dev/i2c-%d", conn->adapter);
+    fd = open(filename, O_RDWR);
+    if (fd < 0) {
+      mxt_err(mxt->ctx, "Could not open %s, error %s (%d)", filename, strerror(errno), errno);
+      return mxt_errno_to_rc(errno);
+    }
+
+    conn->fd_address = -1;
+  }
+
+  /* Address may have been changed, eg when switching to bootloader */
+  if (conn->fd_address != conn->address) {
+    ret = ioctl(fd, I2C_SLAVE_FORCE, conn->address);
+    if (ret < 0) {
+      mxt_err(mxt->ctx, "Error setting slave address, error %s (%d)", strerror(errno), errno);
+      close(fd);
+      conn->fd = -1;
+      return mxt_errno_to_rc(errno);
+    }
   }
 
-  ret = ioctl(fd, I2C_SLAVE_FORCE, mxt->conn->i2c_dev.address);
-  if (ret < 0) {
-    mxt_err(mxt->ctx, "Error setting slave address, error %s (%d)", strerror(errno), errno);
-    close(fd);
-    return mxt_errno_to_rc(errno);
+  if (!mxt->ctx->reopen_fd) {
+    conn->fd = fd;
+    conn->fd_address = conn->address;
   }
 
   *fd_out = fd;
   return MXT_SUCCESS;
 }
 
+//******************************************************************************
+/// \brief  Finish with file descriptor after a transfer
+/// \note   Closes it if reopen_fd is set or the transfer failed, so that the
+///         next transfer starts with a fresh open
+static void close_fd(struct mxt_device *mxt, int fd, int ret)
+{
+  if (!mxt->ctx->reopen_fd && ret == MXT_SUCCESS)
+    return;
+
+  close(fd);
+
+  if (mxt->conn->i2c_dev.fd == fd) {
+    mxt->conn->i2c_dev.fd = -1;
+    mxt->conn->i2c_dev.fd_address = -1;
+  }
+}
+
+//******************************************************************************
+/// \brief  Get the next tx sequence number for a CRC mode transfer
+/// \note   Inside an exclusive access session the number is tracked in
+///         memory and only written back to debugfs when the session ends
+/// \return #mxt_rc
+static int i2c_dev_get_seq_num(struct mxt_device *mxt, uint16_t *seq_num)
+{
+  if (mxt->mxt_crc.session_depth > 0) {
+    *seq_num = mxt->mxt_crc.tx_seq_num;
+    return MXT_SUCCESS;
+  }
+
+  return debugfs_get_tx_seq_num(mxt, seq_num);
+}
+
+//******************************************************************************
+/// \brief  Record the last tx sequence number used by a CRC mode transfer
+/// \return #mxt_rc
+static int i2c_dev_update_seq_num(struct mxt_device *mxt, uint8_t seq_num)
+{
+  if (mxt->mxt_crc.session_depth > 0) {
+    mxt->mxt_crc.tx_seq_num = (seq_num == 255) ? 0 : seq_num + 1;
+    return MXT_SUCCESS;
+  }
+
+  return debugfs_update_seq_num(mxt, seq_num);
+}
+
 //******************************************************************************
 /// \brief  Read register from MXT chip
 /// \return #mxt_rc
@@ -106,7 +187,6 @@ int i2c_dev_read_register(struct mxt_device *mxt, unsigned char *buf,
   uint8_t tx_value = 0; 
   uint16_t tx_seq_num;
   int ret, err;
-  int i, j;
 
   if (count > mxt->ctx->i2c_block_size)
     count = mxt->ctx->i2c_block_size;
@@ -122,6 +202,7 @@ int i2c_dev_read_register(struct mxt_device *mxt, unsigned char *buf,
 
     if (write(fd, &register_buf, 2) != 2) {
       mxt_verb(mxt->ctx, "I2C retry");
+      mxt->io_stats.retries++;
       usleep(I2C_RETRY_DELAY);
 
       if (write(fd, &register_buf, 2) != 2) {
@@ -132,12 +213,14 @@ int i2c_dev_read_register(struct mxt_device *mxt, unsigned char *buf,
     }
   } else {
       if (mxt->debug_fs.enabled == true) {
-        err = debugfs_set_irq(mxt, false);
+        if (mxt->mxt_crc.session_depth == 0) {
+          err = debugfs_set_irq(mxt, false);
 
-        if (err)
-          mxt_dbg(mxt->ctx, "Could not disable IRQ");
+          if (err)
+            mxt_dbg(mxt->ctx, "Could not disable IRQ");
+        }
 
-        err = debugfs_get_tx_seq_num(mxt, &tx_seq_num);
+        err = i2c_dev_get_seq_num(mxt, &tx_seq_num);
 
         if (err) {
           mxt_dbg(mxt->ctx, "Failed to get the tx seq num");
@@ -149,14 +232,13 @@ int i2c_dev_read_register(struct mxt_device *mxt, unsigned char *buf,
       register_buf[2] = tx_seq_num;  //Must be tx seq no
 
       //Calculate CRC byte
-      for (i = 0; i < (tx_header - 1); i++) {
-        crc_data = mxt_calc_crc8(crc_data, register_buf[i]);
-      }
+      crc_data = mxt_crc8(0, (uint8_t *)register_buf, tx_header - 1);
 
       register_buf[3] = crc_data;   //CRC8 bit checksum
 
       if (write(fd, &register_buf, 4) != 4) {
         mxt_verb(mxt->ctx, "I2C retry");
+        mxt->io_stats.retries++;
         usleep(I2C_RETRY_DELAY);
 
         if (write(fd, &register_buf, 4) != 4) {
@@ -166,7 +248,7 @@ int i2c_dev_read_register(struct mxt_device *mxt, unsigned char *buf,
         }
       }
 
-      err = debugfs_update_seq_num(mxt, (uint8_t) tx_seq_num);
+      err = i2c_dev_update_seq_num(mxt, (uint8_t) tx_seq_num);
 
       if (err) {
         mxt_dbg(mxt->ctx, "Failed to get the tx seq num");
@@ -190,39 +272,82 @@ int i2c_dev_read_register(struct mxt_device *mxt, unsigned char *buf,
   }
 
 close:
-  close(fd);
+  close_fd(mxt, fd, ret);
   return ret;
 }
 
 //******************************************************************************
-/// \brief  Write register to MXT chip
+/// \brief  Build one CRC mode write frame: address, data, tx seq num, CRC8
+/// \return length of frame
+static uint16_t i2c_dev_build_crc_frame(uint8_t *frame, uint16_t addr,
+                                        unsigned char const *data, int len,
+                                        uint8_t tx_seq_num)
+{
+  frame[0] = addr & 0xff;
+  frame[1] = (addr >> 8) & 0xff;
+
+  if (len > 0)
+    memcpy(frame + 2, data, len);
+
+  frame[len + 2] = tx_seq_num;
+  frame[len + 3] = mxt_crc8(0, frame, len + 3);
+
+  return len + I2C_CRC_FRAME_OVERHEAD;
+}
+
+//******************************************************************************
+/// \brief  Send CRC mode frames one at a time, retrying each frame
+/// \return number of frames sent
+static int i2c_dev_write_crc_frames(struct mxt_device *mxt, int fd,
+                                    struct i2c_msg *msgs, int nmsgs)
+{
+  int i, retry;
+
+  for (i = 0; i < nmsgs; i++) {
+    for (retry = 0; retry < I2C_CRC_MAX_RETRIES; retry++) {
+      if (write(fd, msgs[i].buf, msgs[i].len) == msgs[i].len)
+        break;
+
+      mxt_verb(mxt->ctx, "I2C retry");
+      mxt->io_stats.retries++;
+      usleep(I2C_RETRY_DELAY);
+    }
+
+    if (retry == I2C_CRC_MAX_RETRIES) {
+      mxt_err(mxt->ctx, "Error %s (%d) writing to i2c", strerror(errno), errno);
+      return i;
+    }
+  }
+
+  return nmsgs;
+}
+
+//******************************************************************************
+/// \brief  Write register to MXT chip in CRC mode
+/// \note   The transfer is split into frames of at most I2C_CRC_MAX_DATA
+///         bytes, which are submitted together with I2C_RDWR. If the adapter
+///         rejects a batch, the remaining frames are retried individually.
 /// \return #mxt_rc
 int i2c_dev_write_crc(struct mxt_device *mxt, unsigned char const *val,
                            int start_register, size_t datalength)
 {
+  struct i2c_msg msgs[I2C_RDWR_IOCTL_MAX_MSGS];
+  struct i2c_rdwr_ioctl_data rdwr;
   int fd = -ENODEV;
-  int count;
-  int ret, err, i, j;
-  uint16_t msg_count;
-  unsigned char *buf;
-  uint8_t msgbuf[15];
-  uint16_t tx_seq_num;
-  uint8_t txbuf[4];
-  uint8_t tx_header = 4;
-  uint8_t crc_data = 0;
-  uint16_t bytesToWrite = 0;
-  uint16_t message_length = 0;
-  uint8_t max_data_length = 11;
-  uint16_t write_addr = 0;
-  uint16_t bytesWritten = 0;
-  uint16_t retry_counter = 0;
+  int ret, err;
+  int n, sent, len;
+  uint8_t *frames;
+  size_t nframes, frame, off;
+  uint16_t tx_seq_num = 0;
 
-  err = debugfs_set_irq(mxt, false);
+  if (mxt->mxt_crc.session_depth == 0) {
+    err = debugfs_set_irq(mxt, false);
 
-  if (err)
-    mxt_dbg(mxt->ctx, "Could not disable IRQ");
+    if (err)
+      mxt_dbg(mxt->ctx, "Could not disable IRQ");
+  }
 
-  err = debugfs_get_tx_seq_num(mxt, &tx_seq_num);
+  err = i2c_dev_get_seq_num(mxt, &tx_seq_num);
 
   if (err) {
     mxt_dbg(mxt->ctx, "i2c-dev: Failed to get the tx seq num");
@@ -232,86 +357,74 @@ int i2c_dev_write_crc(struct mxt_device *mxt, unsigned char const *val,
   if (ret)
     return ret;
 
-  count = datalength + 2;     //Total bytes + header
-  bytesToWrite = datalength;  //Total bytes
-
-  //Limit the size for HA parts
+  /* A zero length write still sends one frame */
+  nframes = (datalength + I2C_CRC_MAX_DATA - 1) / I2C_CRC_MAX_DATA;
+  if (nframes == 0)
+    nframes = 1;
 
-  if (datalength > max_data_length) {
-    message_length = max_data_length;
-  } else {
-    message_length = datalength;
+  frames = malloc(nframes * (I2C_CRC_MAX_DATA + I2C_CRC_FRAME_OVERHEAD));
+  if (!frames) {
+    ret = MXT_ERROR_NO_MEM;
+    goto close;
   }
 
-  msg_count = message_length + 4;
+  frame = 0;
+  off = 0;
 
-  buf = (unsigned char *)calloc(count, sizeof(unsigned char));
-
-  if (!(datalength == 0x00))  //Prevent memory crash
-      memcpy(buf, val, datalength);
-
-  do {
+  while (frame < nframes) {
+    mxt_verb(mxt->ctx, "i2c_dev write: Reg Addr: %zx", start_register + off);
 
-    write_addr = start_register + bytesWritten;
+    /* Build as many frames as one ioctl will take */
+    for (n = 0; n < I2C_RDWR_IOCTL_MAX_MSGS && frame < nframes; n++, frame++) {
+      uint8_t *fbuf = frames + frame * (I2C_CRC_MAX_DATA + I2C_CRC_FRAME_OVERHEAD);
 
-    mxt_dbg(mxt->ctx, "i2c_dev write: Reg Addr: %x\n", write_addr);
+      len = datalength - off;
+      if (len > I2C_CRC_MAX_DATA)
+        len = I2C_CRC_MAX_DATA;
 
-    msgbuf[0] = write_addr & 0xff;
-    msgbuf[1] = (write_addr >> 8) & 0xff;
-    msgbuf[msg_count-2] = tx_seq_num;
+      msgs[n].addr = mxt->conn->i2c_dev.address;
+      msgs[n].flags = 0;
+      msgs[n].buf = fbuf;
+      msgs[n].len = i2c_dev_build_crc_frame(fbuf, start_register + off,
+                                            val + off, len, tx_seq_num);
 
-    j = 0;
-
-    while (j < message_length) {
-      msgbuf[2 + j] = buf[bytesWritten + j];
-      j++;
+      tx_seq_num = (tx_seq_num == 255) ? 0 : tx_seq_num + 1;
+      off += len;
     }
 
-    crc_data = 0;
-
-    //Calculate CRC byte
-    for (i = 0; i < (msg_count - 1); i++) {
-        crc_data = mxt_calc_crc8(crc_data, msgbuf[i]);
-        mxt_dbg(mxt->ctx, "Write CRC: Data[%d] = %x, crc = 0x%x\n",
-        i, msgbuf[i], crc_data);
-    }
+    rdwr.msgs = msgs;
+    rdwr.nmsgs = n;
 
-    msgbuf[msg_count - 1] = crc_data;   //Insert CRC, end of message
+    sent = ioctl(fd, I2C_RDWR, &rdwr);
+    if (sent < 0)
+      sent = 0;
 
-    ret = write(fd, msgbuf, msg_count);
-
-    if (ret == msg_count) {
-
-      if(tx_seq_num == 255)
-        tx_seq_num = 0;
-      else
-        tx_seq_num++;
-    
-      ret = 0;
-      bytesWritten = bytesWritten + message_length;
-      bytesToWrite = bytesToWrite - message_length;
-
-      retry_counter = 0;
-
-      if (bytesToWrite < message_length){
-        message_length = bytesToWrite;
-        msg_count = message_length + 4;
-      }
+    if (sent < n) {
+      mxt->io_stats.retries++;
+      sent += i2c_dev_write_crc_frames(mxt, fd, msgs + sent, n - sent);
     }
 
-    retry_counter++;
-
-    if (retry_counter == 10)
+    if (sent < n) {
+      /* Frames not accepted did not consume a sequence number */
+      tx_seq_num = (tx_seq_num + 256 - (n - sent)) % 256;
+      ret = MXT_ERROR_IO;
       break;
+    }
+  }
 
-} while (bytesToWrite > 0);
+  free(frames);
 
   tx_seq_num--; //Minus 1 before updating
 
-  ret = debugfs_update_seq_num(mxt, (uint8_t) tx_seq_num);
+  err = i2c_dev_update_seq_num(mxt, (uint8_t) tx_seq_num);
+  if (err) {
+    mxt_dbg(mxt->ctx, "i2c-dev: Failed to update the tx seq num");
+    if (!ret)
+      ret = err;
+  }
 
   if ((mxt->mxt_crc.reset_triggered == false) && (mxt->mxt_crc.config_triggered == false) &&
-    mxt->mxt_crc.processing_msg == false){
+    mxt->mxt_crc.processing_msg == false && mxt->mxt_crc.session_depth == 0){
 
     err = debugfs_set_irq(mxt, true);
 
@@ -320,8 +433,8 @@ int i2c_dev_write_crc(struct mxt_device *mxt, unsigned char const *val,
 
 }
 
-  free(buf);
-  close(fd);
+close:
+  close_fd(mxt, fd, ret);
   return ret;
 }
 
@@ -350,6 +463,7 @@ int i2c_dev_write_register(struct mxt_device *mxt, unsigned char const *val,
 
   if (write(fd, buf, count) != count) {
     mxt_verb(mxt->ctx, "I2C retry");
+    mxt->io_stats.retries++;
     usleep(I2C_RETRY_DELAY);
     if (write(fd, buf, count) != count) {
       mxt_err(mxt->ctx, "Error %s (%d) writing to i2c", strerror(errno), errno);
@@ -362,7 +476,7 @@ int i2c_dev_write_register(struct mxt_device *mxt, unsigned char const *val,
   }
 
   free(buf);
-  close(fd);
+  close_fd(mxt, fd, ret);
   return ret;
 }
 
@@ -387,7 +501,7 @@ int i2c_dev_bootloader_read(struct mxt_device *mxt, unsigned char *buf, int coun
     ret = MXT_SUCCESS;
   }
 
-  close(fd);
+  close_fd(mxt, fd, ret);
   return ret;
 }
 
@@ -417,6 +531,6 @@ int i2c_dev_bootloader_write(struct mxt_device *mxt, unsigned char const *buf,
   }
 
   *bytes_read = count;
-  close(fd);
+  close_fd(mxt, fd, ret);
   return ret;
 }
@@ -35,6 +35,8 @@
 struct i2c_dev_conn_info {
   int adapter;
   int address;
+  int fd;
+  int fd_address;
 };
 
 //******************************************************************************
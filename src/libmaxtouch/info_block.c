@@ -29,8 +29,10 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "libmaxtouch.h"
+#include "crc.h"
 
 /*!
  * @brief Information block checksum return function.
@@ -42,58 +44,96 @@ static uint32_t convert_crc(struct mxt_raw_crc *crc)
 }
 
 /*!
- * @brief  Checksum algorithm.
- * @return Calculated checksum.
+ * @brief  Calculate and verify checksum over a region of memory
+ * @return #mxt_rc
  */
-static uint32_t crc24(uint32_t crc, uint8_t firstbyte, uint8_t secondbyte)
+int mxt_calculate_crc(struct libmaxtouch_ctx *ctx, uint32_t *crc_result,
+                      uint8_t *base_addr, size_t size)
 {
-  static const uint32_t CRCPOLY = 0x0080001B;
-  uint32_t result;
-  uint16_t data_word;
+  mxt_dbg(ctx, "Calculating CRC over %zd bytes", size);
 
-  data_word = (uint16_t) ((uint16_t)(secondbyte << 8u) | firstbyte);
-  result = ((crc << 1u) ^ (uint32_t)data_word);
+  *crc_result = mxt_crc24(base_addr, size);
 
-  /* Check if 25th bit is set, and XOR the result to create 24-bit checksum */
-  if (result & 0x1000000) {
-    result ^= CRCPOLY;
-  }
-  return result;
+  return MXT_SUCCESS;
 }
 
 /*!
- * @brief  Calculate and verify checksum over a region of memory
- * @return #mxt_rc
+ * @param  mxt Maxtouch Device
+ * @param  object_type Object ID number.
+ *
+ * @brief  Looks up the object table index of the specified type.
+ * @return Element index, or -1 if object type not found.
  */
-int mxt_calculate_crc(struct libmaxtouch_ctx *ctx, uint32_t *crc_result,
-                      uint8_t *base_addr, size_t size)
+static int mxt_lookup_object(struct mxt_device *mxt, uint16_t object_type)
 {
-  static const uint32_t MASK_24_BITS = 0x00FFFFFF;
-  uint32_t calc_crc = 0; /* Calculated checksum */
-  uint16_t crc_byte_index = 0;
+  if (object_type >= sizeof(mxt->info.object_index))
+    return -1;
 
-  mxt_dbg(ctx, "Calculating CRC over %zd bytes", size);
+  return (int)mxt->info.object_index[object_type] - 1;
+}
 
-  /* Call the CRC function crc24() iteratively to calculate the CRC,
-   * passing it two bytes at a time.  */
-  while (crc_byte_index < ((size % 2) ? (size - 1) : size)) {
-    calc_crc = crc24(calc_crc, *(base_addr + crc_byte_index),
-                     *(base_addr + crc_byte_index + 1));
-    crc_byte_index += 2;
-  }
+/*!
+ * @param  mxt Maxtouch Device
+ * @param  object_type Object ID number.
+ *
+ * @brief  Returns the start address of the first instance of the object, or
+ *         OBJECT_NOT_FOUND.
+ */
+static uint16_t mxt_lookup_object_address(struct mxt_device *mxt,
+                                          uint16_t object_type)
+{
+  int i = mxt_lookup_object(mxt, object_type);
 
-  /* Call crc24() for the final byte, plus an extra
-   *  0 value byte to make the sequence even if it's odd */
-  if (size % 2) {
-    calc_crc = crc24(calc_crc, *(base_addr + crc_byte_index), 0);
-  }
+  if (i < 0)
+    return OBJECT_NOT_FOUND;
 
-  /* Mask 32-bit calculated checksum to 24-bit */
-  calc_crc &= calc_crc & MASK_24_BITS;
+  return mxt_get_start_position(mxt->info.objects[i], 0);
+}
 
-  *crc_result = calc_crc;
+/*!
+ * @param  mxt Maxtouch Device
+ * @param  object_type Object ID number.
+ *
+ * @brief  Returns the size of the object, or zero if not found.
+ */
+static uint16_t mxt_lookup_object_size(struct mxt_device *mxt,
+                                       uint16_t object_type)
+{
+  int i = mxt_lookup_object(mxt, object_type);
 
-  return MXT_SUCCESS;
+  if (i < 0)
+    return 0;
+
+  return MXT_SIZE(mxt->info.objects[i]);
+}
+
+/*!
+ * @brief  Builds the type indexed object table look-up and caches the
+ *         objects used on the message and diagnostic data paths.
+ */
+static void mxt_build_object_lookup(struct mxt_device *mxt)
+{
+  struct mxt_object_cache *cache = &mxt->obj_cache;
+  uint8_t type;
+  int i;
+
+  memset(mxt->info.object_index, 0, sizeof(mxt->info.object_index));
+
+  /* Keep the first entry if a type is listed more than once */
+  for (i = 0; i < mxt->info.id->num_objects; i++) {
+    type = mxt->info.objects[i].type;
+
+    if (mxt->info.object_index[type] == 0)
+      mxt->info.object_index[type] = i + 1;
+  }
+
+  cache->t5_addr = mxt_lookup_object_address(mxt, GEN_MESSAGEPROCESSOR_T5);
+  cache->t5_size = mxt_lookup_object_size(mxt, GEN_MESSAGEPROCESSOR_T5);
+  cache->t6_addr = mxt_lookup_object_address(mxt, GEN_COMMANDPROCESSOR_T6);
+  cache->t37_addr = mxt_lookup_object_address(mxt, DEBUG_DIAGNOSTIC_T37);
+  cache->t37_size = mxt_lookup_object_size(mxt, DEBUG_DIAGNOSTIC_T37);
+  cache->t44_addr = mxt_lookup_object_address(mxt, SPT_MESSAGECOUNT_T44);
+  cache->t144_addr = mxt_lookup_object_address(mxt, SPT_MESSAGECOUNT_T144);
 }
 
 /*!
@@ -104,6 +144,9 @@ int mxt_read_info_block(struct mxt_device *mxt)
 {
   uint32_t calc_crc;
   bool crc_flag = false;
+  bool cached = false;
+  uint8_t *cached_blk;
+  size_t cached_size;
   int ret = 0;
 
   /* Read the ID Information from the chip */
@@ -142,6 +185,7 @@ int mxt_read_info_block(struct mxt_device *mxt)
   ret = mxt_read_register(mxt, info_blk, 0, sizeof(struct mxt_id_info));
   if (ret) {
     mxt_err(mxt->ctx, "Failed to read ID information");
+    free(info_blk);
     return ret;
   }
 
@@ -154,17 +198,34 @@ int mxt_read_info_block(struct mxt_device *mxt)
   /* Allocate space to read Information Block AND Checksum from the chip */
   size_t info_block_size = crc_area_size + sizeof(struct mxt_raw_crc);
 
-  info_blk = (uint8_t *)realloc(info_blk, info_block_size);
-  if (info_blk == NULL) {
-    mxt_err(mxt->ctx, "Memory allocation failure");
-    return MXT_ERROR_NO_MEM;
-  }
+  /* Matching ID information means the object table is unchanged */
+  if (mxt->ctx->scan_cache_file
+      && mxt_scan_cache_info(mxt, (struct mxt_id_info *)info_blk,
+                             &cached_blk, &cached_size) == MXT_SUCCESS) {
+    free(info_blk);
+    info_blk = cached_blk;
+    cached = true;
+  } else {
+    uint8_t *blk = (uint8_t *)realloc(info_blk, info_block_size);
+    if (blk == NULL) {
+      mxt_err(mxt->ctx, "Memory allocation failure");
+      free(info_blk);
+      return MXT_ERROR_NO_MEM;
+    }
 
-  /* Read the entire Information Block from the chip */
-  ret = mxt_read_register(mxt, info_blk, 0, info_block_size);
-  if (ret) {
-    mxt_err(mxt->ctx, "Failed to read Information Block");
-    return ret;
+    info_blk = blk;
+
+    /* Only the object table and CRC are left to read. The table size is not
+     * guessed: a longer read runs into the object registers, and reading T5
+     * there would take a message off the queue */
+    ret = mxt_read_register(mxt, info_blk + sizeof(struct mxt_id_info),
+                            sizeof(struct mxt_id_info),
+                            info_block_size - sizeof(struct mxt_id_info));
+    if (ret) {
+      mxt_err(mxt->ctx, "Failed to read Information Block");
+      free(info_blk);
+      return ret;
+    }
   }
 
   /* Update pointers in device structure */
@@ -174,6 +235,8 @@ int mxt_read_info_block(struct mxt_device *mxt)
 
   mxt->info.crc = convert_crc((struct mxt_raw_crc*) (info_blk + crc_area_size));
 
+  mxt_build_object_lookup(mxt);
+
   /* Calculate and compare Information Block Checksum */
   
   ret = mxt_calculate_crc(mxt->ctx, &calc_crc, info_blk, crc_area_size);
@@ -194,6 +257,10 @@ int mxt_read_info_block(struct mxt_device *mxt)
   }
 
   mxt_dbg(mxt->ctx, "Info checksum verified %06X", calc_crc);
+
+  if (mxt->ctx->scan_cache_file && !cached)
+    mxt_scan_cache_store(mxt);
+
   return MXT_SUCCESS;
 }
 
@@ -235,6 +302,8 @@ int mxt_calc_report_ids(struct mxt_device *mxt)
       for (report_index = 0; report_index < obj.num_report_ids; report_index++) {
         mxt->report_id_map[report_id_count].object_type = obj.type;
         mxt->report_id_map[report_id_count].instance = instance;
+        mxt->report_id_map[report_id_count].report_index = report_index;
+        mxt->report_id_map[report_id_count].decode = mxt_msg_decoder_for_type(obj.type);
         report_id_count++;
       }
     }
@@ -295,7 +364,7 @@ void mxt_display_chip_info(struct mxt_device *mxt)
             MXT_INSTANCES(obj), mxt_get_start_position(obj, 0));
   }
 
-    t144_addr = mxt_get_object_address(mxt, SPT_MESSAGECOUNT_T144, 0);
+    t144_addr = mxt->obj_cache.t144_addr;
     
     if (t144_addr == OBJECT_NOT_FOUND) {
       mxt->mxt_crc.crc_enabled = false;
@@ -316,28 +385,24 @@ void mxt_display_chip_info(struct mxt_device *mxt)
  */
 uint16_t mxt_get_object_address(struct mxt_device *mxt, uint16_t object_type, uint8_t instance)
 {
-  struct mxt_id_info *id = mxt->info.id;
-  int i = 0;
+  int i = mxt_lookup_object(mxt, object_type);
   struct mxt_object obj;
 
-  for (i = 0; i < id->num_objects; i++) {
-    obj = mxt->info.objects[i];
+  if (i < 0) {
+    mxt_verb(mxt->ctx, "T%u not present on device", object_type);
+    return OBJECT_NOT_FOUND;
+  }
 
-    /* Does object type match? */
-    if (obj.type == object_type) {
-      /* Are there enough instances defined in the firmware? */
-      if (obj.instances_minus_one >= instance) {
-        return mxt_get_start_position(obj, instance);
-      } else {
-        mxt_warn(mxt->ctx, "T%u instance %u not present on device",
-                 object_type, instance);
-        return OBJECT_NOT_FOUND;
-      }
-    }
+  obj = mxt->info.objects[i];
+
+  /* Are there enough instances defined in the firmware? */
+  if (obj.instances_minus_one < instance) {
+    mxt_warn(mxt->ctx, "T%u instance %u not present on device",
+             object_type, instance);
+    return OBJECT_NOT_FOUND;
   }
 
-  mxt_verb(mxt->ctx, "T%u not present on device", object_type);
-  return OBJECT_NOT_FOUND;
+  return mxt_get_start_position(obj, instance);
 }
 
 /*!
@@ -366,16 +431,12 @@ uint8_t mxt_get_object_size(struct mxt_device *mxt, uint16_t object_type)
  */
 uint8_t mxt_get_object_instances(struct mxt_device *mxt, uint16_t object_type)
 {
-  struct mxt_id_info *id = mxt->info.id;
-  int i;
+  int i = mxt_lookup_object(mxt, object_type);
 
-  for (i = 0; i < id->num_objects; i++) {
-    if (mxt->info.objects[i].type == object_type) {
-      return MXT_INSTANCES(mxt->info.objects[i]);
-    }
-  }
+  if (i < 0)
+    return 0;
 
-  return 0;
+  return MXT_INSTANCES(mxt->info.objects[i]);
 }
 
 /*!
@@ -387,17 +448,14 @@ uint8_t mxt_get_object_instances(struct mxt_device *mxt, uint16_t object_type)
  */
 uint8_t mxt_get_object_table_num(struct mxt_device *mxt, uint16_t object_type)
 {
-  struct mxt_id_info *id = mxt->info.id;
-  int i;
+  int i = mxt_lookup_object(mxt, object_type);
 
-  for (i = 0; i < id->num_objects; i++) {
-    if (mxt->info.objects[i].type == object_type) {
-      return i;
-    }
+  if (i < 0) {
+    mxt_warn(mxt->ctx, "Could not find object type T%u in object table", object_type);
+    return 255;
   }
 
-  mxt_warn(mxt->ctx, "Could not find object type T%u in object table", object_type);
-  return 255;
+  return i;
 }
 
 /*!
@@ -422,7 +480,7 @@ uint16_t mxt_get_start_position(struct mxt_object obj, uint8_t instance)
  */
 uint16_t mxt_report_id_to_type(struct mxt_device *mxt, int report_id)
 {
-  if (report_id > mxt->info.max_report_id)
+  if (report_id >= mxt->info.max_report_id)
     return OBJECT_NOT_FOUND;
 
   return (mxt->report_id_map[report_id].object_type);
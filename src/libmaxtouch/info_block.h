@@ -32,6 +32,7 @@
 
 struct mxt_device;
 struct libmaxtouch_ctx;
+struct mxt_decoded_msg;
 
 #define MXT_INSTANCES(o) ((uint16_t)((o).instances_minus_one) + 1)
 #define MXT_SIZE(o) ((uint16_t)((o).size_minus_one) + 1)
@@ -101,6 +102,23 @@ struct mxt_info {
 
   /*! Number of valid report IDs */
   uint8_t max_report_id;
+
+  /*! Object table index plus one for each object type, zero if the type is
+   * not present. Built when the information block is read. */
+  uint8_t object_index[256];
+};
+
+/*! \brief Objects used on the message and diagnostic data paths, looked up
+ * once when the information block is read. Addresses are OBJECT_NOT_FOUND
+ * and sizes zero if the object is not present. */
+struct mxt_object_cache {
+  uint16_t t5_addr;
+  uint16_t t5_size;
+  uint16_t t6_addr;
+  uint16_t t37_addr;
+  uint16_t t37_size;
+  uint16_t t44_addr;
+  uint16_t t144_addr;
 };
 
 
@@ -109,6 +127,8 @@ struct mxt_crc_device {
   bool processing_msg;
   bool config_triggered;
   bool reset_triggered;
+  int session_depth;
+  uint8_t tx_seq_num;
 };
 
 /*!
@@ -121,6 +141,10 @@ struct mxt_crc_device {
 struct mxt_report_id_map {
   uint16_t object_type;  /*!< Object type */
   uint8_t instance;      /*!< Instance number */
+  uint8_t report_index;  /*!< Report ID relative to the first of the instance */
+  /*! Message decoder for the object, NULL when there is none */
+  int (*decode)(const struct mxt_report_id_map *map, const uint8_t *msg,
+                uint8_t size, struct mxt_decoded_msg *out);
 };
 
 /*! Object types */
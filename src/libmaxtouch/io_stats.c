@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------
+/// \file   io_stats.c
+/// \brief  Bus transaction statistics
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "libmaxtouch.h"
+#include "io_stats.h"
+
+//******************************************************************************
+/// \brief  Get monotonic time for latency measurement
+/// \return Time in microseconds
+uint64_t mxt_io_time_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//******************************************************************************
+/// \brief  Get latency bucket
+static int mxt_io_bucket(uint64_t us)
+{
+  int bucket = 0;
+
+  while (us && bucket < MXT_IO_HIST_BUCKETS - 1) {
+    us >>= 1;
+    bucket++;
+  }
+
+  return bucket;
+}
+
+//******************************************************************************
+/// \brief  Count a completed operation
+/// \param  mxt  Maxtouch Device
+/// \param  op  Operation type
+/// \param  bytes  Bytes transferred, counted on success only
+/// \param  start_us  Time from mxt_io_time_us() when the operation started
+/// \param  ret  #mxt_rc result of the operation
+void mxt_io_stats_record(struct mxt_device *mxt, enum mxt_io_op op,
+                         size_t bytes, uint64_t start_us, int ret)
+{
+  struct mxt_io_op_stats *s = &mxt->io_stats.ops[op];
+  uint64_t elapsed = mxt_io_time_us() - start_us;
+
+  s->transactions++;
+  s->total_us += elapsed;
+  s->hist[mxt_io_bucket(elapsed)]++;
+
+  if (s->max_us < elapsed)
+    s->max_us = elapsed;
+
+  if (ret == MXT_SUCCESS)
+    s->bytes += bytes;
+  else if (ret == MXT_ERROR_TIMEOUT)
+    s->timeouts++;
+  else if (ret != MXT_ERROR_NO_MESSAGE)
+    s->errors++;
+}
+
+//******************************************************************************
+/// \brief  Get a copy of the statistics for a device
+void mxt_get_io_stats(struct mxt_device *mxt, struct mxt_io_stats *stats)
+{
+  memcpy(stats, &mxt->io_stats, sizeof(struct mxt_io_stats));
+}
+
+//******************************************************************************
+/// \brief  Clear the statistics for a device
+void mxt_reset_io_stats(struct mxt_device *mxt)
+{
+  memset(&mxt->io_stats, 0, sizeof(struct mxt_io_stats));
+}
+
+//******************************************************************************
+/// \brief  Estimate a latency percentile from the histogram
+/// \return Upper bound of the bucket holding the percentile in
+///         microseconds, or zero if there are no operations
+uint64_t mxt_io_stats_percentile(const struct mxt_io_op_stats *op, int percent)
+{
+  uint64_t target, seen = 0;
+  int i;
+
+  if (!op->transactions)
+    return 0;
+
+  /* Rank of the percentile, rounded up */
+  target = (op->transactions * percent + 99) / 100;
+  if (target < 1)
+    target = 1;
+
+  for (i = 0; i < MXT_IO_HIST_BUCKETS - 1; i++) {
+    seen += op->hist[i];
+    if (seen >= target)
+      return (uint64_t)1 << i;
+  }
+
+  return op->max_us;
+}
+
+//******************************************************************************
+/// \brief  Get name of operation type
+const char *mxt_io_op_name(enum mxt_io_op op)
+{
+  switch (op) {
+  case MXT_IO_READ:
+    return "read";
+  case MXT_IO_WRITE:
+    return "write";
+  case MXT_IO_MSG:
+    return "message";
+  default:
+    return "unknown";
+  }
+}
+
+//******************************************************************************
+/// \brief  Log a summary of the statistics, if debug output is enabled
+void mxt_log_io_stats(struct mxt_device *mxt)
+{
+  const struct mxt_io_op_stats *s;
+  int op;
+
+  if (mxt_get_log_level(mxt->ctx) > LOG_DEBUG)
+    return;
+
+  mxt_info(mxt->ctx, "I/O statistics: %llu retries, %llu bus errors",
+          (unsigned long long)mxt->io_stats.retries,
+          (unsigned long long)mxt->io_stats.bus_errors);
+
+  for (op = 0; op < MXT_IO_OP_COUNT; op++) {
+    s = &mxt->io_stats.ops[op];
+    if (!s->transactions)
+      continue;
+
+    mxt_info(mxt->ctx, "%-7s %llu ops %llu bytes %llu errors %llu timeouts"
+            " mean %llu us p50 <%llu us p99 <%llu us max %llu us",
+            mxt_io_op_name(op),
+            (unsigned long long)s->transactions,
+            (unsigned long long)s->bytes,
+            (unsigned long long)s->errors,
+            (unsigned long long)s->timeouts,
+            (unsigned long long)(s->total_us / s->transactions),
+            (unsigned long long)mxt_io_stats_percentile(s, 50),
+            (unsigned long long)mxt_io_stats_percentile(s, 99),
+            (unsigned long long)s->max_us);
+  }
+}
@@ -0,0 +1,79 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   io_stats.h
+/// \brief  Bus transaction statistics
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/* Latency buckets: bucket N counts operations taking less than 2^N us, and
+ * at least 2^(N-1) us. The last bucket also takes anything slower. */
+#define MXT_IO_HIST_BUCKETS  25
+
+/* Operation types counted separately */
+enum mxt_io_op {
+  MXT_IO_READ,
+  MXT_IO_WRITE,
+  MXT_IO_MSG,
+  MXT_IO_OP_COUNT
+};
+
+//******************************************************************************
+/// \brief Counters for one type of operation
+struct mxt_io_op_stats {
+  uint64_t transactions;
+  uint64_t bytes;
+  uint64_t errors;
+  uint64_t timeouts;
+  uint64_t total_us;
+  uint64_t max_us;
+  uint64_t hist[MXT_IO_HIST_BUCKETS];
+};
+
+//******************************************************************************
+/// \brief Counters for a device
+///
+/// Reads count each bus transfer of a register read. Message operations are
+/// whole calls to the message functions, so the T44/T5 reads they make are
+/// also counted as reads.
+struct mxt_io_stats {
+  struct mxt_io_op_stats ops[MXT_IO_OP_COUNT];
+  uint64_t retries;     /* transport level retries after a failed transfer */
+  uint64_t bus_errors;  /* failed or short USB transfers */
+};
+
+struct mxt_device;
+
+uint64_t mxt_io_time_us(void);
+void mxt_io_stats_record(struct mxt_device *mxt, enum mxt_io_op op,
+                         size_t bytes, uint64_t start_us, int ret);
+void mxt_get_io_stats(struct mxt_device *mxt, struct mxt_io_stats *stats);
+void mxt_reset_io_stats(struct mxt_device *mxt);
+uint64_t mxt_io_stats_percentile(const struct mxt_io_op_stats *op, int percent);
+const char *mxt_io_op_name(enum mxt_io_op op);
+void mxt_log_io_stats(struct mxt_device *mxt);
@@ -37,8 +37,10 @@
 #include <sys/time.h>
 
 #include "libmaxtouch.h"
+#include "crc.h"
 #include "libmaxtouch/sysfs/dmesg.h"
 #include "msg.h"
+#include "utilfuncs.h"
 
 void msleep(int tms)
 { 
@@ -49,6 +51,22 @@ void msleep(int tms)
 
 }
 
+//******************************************************************************
+/// \brief  Initialise a lock which may be taken again by the thread holding it
+/// \return #mxt_rc
+static int mxt_init_lock(pthread_mutex_t *lock)
+{
+  pthread_mutexattr_t attr;
+  int ret;
+
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  ret = pthread_mutex_init(lock, &attr);
+  pthread_mutexattr_destroy(&attr);
+
+  return ret ? MXT_ERROR_NO_MEM : MXT_SUCCESS;
+}
+
 //******************************************************************************
 /// \brief  Initialise libmaxtouch library
 /// \return #mxt_rc
@@ -64,6 +82,20 @@ int mxt_new(struct libmaxtouch_ctx **ctx)
   new_ctx->query = false;
   new_ctx->log_fn = mxt_log_stderr;
   new_ctx->i2c_block_size = I2C_DEV_MAX_BLOCK;
+  new_ctx->chg_gpio_line = -1;
+  new_ctx->config_cache_dir = NULL;
+  new_ctx->scan_cache_file = NULL;
+
+  if (mxt_init_lock(&new_ctx->lock)) {
+    free(new_ctx);
+    return MXT_ERROR_NO_MEM;
+  }
+
+  if (mxt_log_init(new_ctx)) {
+    pthread_mutex_destroy(&new_ctx->lock);
+    free(new_ctx);
+    return MXT_ERROR_NO_MEM;
+  }
 
   *ctx = new_ctx;
 
@@ -78,6 +110,9 @@ int mxt_free(struct libmaxtouch_ctx *ctx)
 #ifdef HAVE_LIBUSB
   usb_close(ctx);
 #endif
+  mxt_scan_cache_free(ctx);
+  mxt_log_free(ctx);
+  pthread_mutex_destroy(&ctx->lock);
   free(ctx);
   return MXT_SUCCESS;
 }
@@ -93,19 +128,26 @@ void mxt_set_log_fn(struct libmaxtouch_ctx *ctx,
 }
 
 //******************************************************************************
-/// \brief  Scan for devices on the I2C bus and USB
-/// \note   Checks for I2C devices first
+/// \brief  Scan for devices with the context lock held
 /// \return #mxt_rc
-int mxt_scan(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conn,
-             bool query)
+static int mxt_scan_locked(struct libmaxtouch_ctx *ctx,
+                           struct mxt_conn_info **conn, bool query)
 {
   int ret = 0;
   struct mxt_conn_info *cn;
 
   ctx->query = query;
   ctx->scan_count = 0;
+  ctx->scan_cached = false;
 
   if (*conn == NULL) {
+    /* A device found by an earlier scan saves enumerating everything */
+    if (!query && ctx->scan_cache_file
+        && mxt_scan_cache_conn(ctx, conn) == MXT_SUCCESS) {
+      ctx->scan_cached = true;
+      return MXT_SUCCESS;
+    }
+
     mxt_new_conn(&cn, E_SYSFS_I2C);
     *conn = cn;
   } else {
@@ -114,7 +156,7 @@ int mxt_scan(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conn,
 
   /* Return if connector type I2C_DEV */
 
-  if (cn->type == E_I2C_DEV)
+  if (cn->type == E_I2C_DEV || cn->type == E_MOCK)
     return MXT_SUCCESS;
 
   /* Check if i2c bus and address exist */
@@ -140,6 +182,22 @@ int mxt_scan(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conn,
   return ret;
 }
 
+//******************************************************************************
+/// \brief  Scan for devices on the I2C bus and USB
+/// \note   Checks for I2C devices first
+/// \return #mxt_rc
+int mxt_scan(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conn,
+             bool query)
+{
+  int ret;
+
+  pthread_mutex_lock(&ctx->lock);
+  ret = mxt_scan_locked(ctx, conn, query);
+  pthread_mutex_unlock(&ctx->lock);
+
+  return ret;
+}
+
 //******************************************************************************
 /// \brief Create connection object
 /// \return #mxt_rc
@@ -152,8 +210,23 @@ int mxt_new_conn(struct mxt_conn_info **conn, enum mxt_device_type type)
   c->type = type;
   c->refcount = 1;
 
-  if (c->type == E_SYSFS_SPI)
-    c->sysfs.spi_found = true; 
+  switch (c->type) {
+  case E_SYSFS_SPI:
+    c->sysfs.spi_found = true;
+    break;
+
+  case E_I2C_DEV:
+    c->i2c_dev.fd = -1;
+    c->i2c_dev.fd_address = -1;
+    break;
+
+  case E_HIDRAW:
+    c->hidraw.fd = -1;
+    break;
+
+  default:
+    break;
+  }
 
   *conn = c;
 
@@ -189,6 +262,12 @@ struct mxt_conn_info *mxt_unref_conn(struct mxt_conn_info *conn)
     free(conn->sysfs.path);
     break;
 
+  case E_MOCK:
+    free(conn->mock.info_file);
+    free(conn->mock.config_file);
+    free(conn->mock.msg_file);
+    break;
+
   default:
     break;
   }
@@ -212,12 +291,23 @@ int mxt_new_device(struct libmaxtouch_ctx *ctx, struct mxt_conn_info *conn,
 
   new_dev->ctx = ctx;
   new_dev->conn = mxt_ref_conn(conn);
+  new_dev->chg_gpio_fd = -1;
 
   if (conn == NULL) {
     mxt_err(ctx, "New device connection parameters not valid");
+    free(new_dev);
     return MXT_ERROR_NO_DEVICE;
   }
 
+  if (mxt_init_lock(&new_dev->lock)) {
+    mxt_unref_conn(conn);
+    free(new_dev);
+    return MXT_ERROR_NO_MEM;
+  }
+
+  /* Opening may touch the USB context shared through ctx */
+  pthread_mutex_lock(&ctx->lock);
+
   switch (conn->type) {
   case E_SYSFS_I2C:
     ret = sysfs_open_i2c(new_dev);
@@ -241,12 +331,18 @@ int mxt_new_device(struct libmaxtouch_ctx *ctx, struct mxt_conn_info *conn,
     ret = hidraw_register(new_dev);
     break;
 
+  case E_MOCK:
+    ret = mock_open(new_dev);
+    break;
+
   default:
     mxt_err(ctx, "Device type not supported");
     ret = MXT_ERROR_NOT_SUPPORTED;
-    goto failure;
+    break;
   }
 
+  pthread_mutex_unlock(&ctx->lock);
+
   if (ret != 0)
     goto failure;
 
@@ -255,6 +351,7 @@ int mxt_new_device(struct libmaxtouch_ctx *ctx, struct mxt_conn_info *conn,
 
 failure:
   mxt_unref_conn(conn);
+  pthread_mutex_destroy(&new_dev->lock);
   free(new_dev);
   return ret;
 }
@@ -305,38 +402,24 @@ void mxt_free_device(struct mxt_device *mxt)
     hidraw_release(mxt);
     break;
 
+  case E_MOCK:
+    mock_release(mxt);
+    break;
+
   default:
     mxt_err(mxt->ctx, "Device type not supported");
   }
 
+  gpio_chg_close(mxt);
 
   mxt->conn = mxt_unref_conn(mxt->conn);
 
   free(mxt->info.raw_info);
   free(mxt->report_id_map);
+  pthread_mutex_destroy(&mxt->lock);
   free(mxt);
 }
 
-//******************************************************************************
-/// \brief Calculate the 8bit CRC
-uint8_t mxt_calc_crc8(unsigned char crc, unsigned char data)
-{
-  static const uint8_t crcpoly = 0x8C;
-  uint8_t index;
-  uint8_t fb;
-  index = 8;
-
-  do {
-    fb = (crc ^ data) & 0x01;
-    data >>=1;
-    crc >>=1;
-    if (fb)
-      crc ^= crcpoly;
-  } while (--index);
-
-  return crc;
-}
-
 //******************************************************************************
 /// \brief  Read register from MXT chip
 /// \return #mxt_rc
@@ -352,7 +435,7 @@ static int mxt_read_register_block(struct mxt_device *mxt, uint8_t *buf,
   case E_SYSFS_I2C:
 
 //Stop the handling of interrupts in driver
-  if (mxt->mxt_crc.crc_enabled == true) {
+  if (mxt->mxt_crc.crc_enabled == true && mxt->mxt_crc.session_depth == 0) {
     err = sysfs_set_debug_irq(mxt, false);
     
     if (err)
@@ -364,7 +447,7 @@ static int mxt_read_register_block(struct mxt_device *mxt, uint8_t *buf,
     if (ret)
       mxt_err(mxt->ctx, "Error reading register");
 
-    if (mxt->mxt_crc.crc_enabled == true) {
+    if (mxt->mxt_crc.crc_enabled == true && mxt->mxt_crc.session_depth == 0) {
       if ((mxt->mxt_crc.reset_triggered == false) && (mxt->mxt_crc.config_triggered == false)) {
         err = sysfs_set_debug_irq(mxt, true);
     
@@ -380,7 +463,7 @@ static int mxt_read_register_block(struct mxt_device *mxt, uint8_t *buf,
     ret = i2c_dev_read_register(mxt, buf, start_register, count, bytes);
 
     if ((mxt->mxt_crc.config_triggered == false) && (mxt->mxt_crc.processing_msg == false) &&
-      (mxt->debug_fs.enabled == true)) {
+      (mxt->debug_fs.enabled == true) && (mxt->mxt_crc.session_depth == 0)) {
 
       err = debugfs_set_irq(mxt, true);
 
@@ -400,6 +483,10 @@ static int mxt_read_register_block(struct mxt_device *mxt, uint8_t *buf,
     ret = hidraw_read_register(mxt, buf, start_register, count, bytes);
     break;
 
+  case E_MOCK:
+    ret = mock_read_register(mxt, buf, start_register, count, bytes);
+    break;
+
   default:
     mxt_err(mxt->ctx, "Device type not supported");
     ret = MXT_ERROR_NOT_SUPPORTED;
@@ -417,20 +504,31 @@ int mxt_read_register(struct mxt_device *mxt, uint8_t *buf,
   int ret;
   size_t received;
   size_t off = 0;
+  uint64_t start_us;
 
   mxt_verb(mxt->ctx, "%s start_register:%d count:%zu", __func__,
            start_register, count);
 
+  pthread_mutex_lock(&mxt->lock);
+
   while (off < count) {
+    start_us = mxt_io_time_us();
+    received = 0;
     ret = mxt_read_register_block(mxt, buf + off, start_register + off,
                                   count - off, &received);
-    if (ret)
+    mxt_io_stats_record(mxt, MXT_IO_READ, received, start_us, ret);
+    if (ret) {
+      pthread_mutex_unlock(&mxt->lock);
       return ret;
+    }
 
     off += received;
   }
 
+  pthread_mutex_unlock(&mxt->lock);
+
   mxt_log_buffer(mxt->ctx, LOG_VERBOSE, "RX:", buf, count);
+  mxt_trace(mxt->ctx, MXT_TRACE_RX, start_register, buf, count);
 
   return MXT_SUCCESS;
 }
@@ -442,14 +540,17 @@ int mxt_write_register(struct mxt_device *mxt, uint8_t const *buf,
                        int start_register, size_t count)
 {
   int ret, err;
+  uint64_t start_us = mxt_io_time_us();
 
   mxt_verb(mxt->ctx, "%s start_register:%d count:%zu", __func__,
            start_register, count);
 
+  pthread_mutex_lock(&mxt->lock);
+
   switch (mxt->conn->type) {
   case E_SYSFS_SPI:
   case E_SYSFS_I2C:
-    if (mxt->mxt_crc.crc_enabled == true) {
+    if (mxt->mxt_crc.crc_enabled == true && mxt->mxt_crc.session_depth == 0) {
       err = sysfs_set_debug_irq(mxt, false);
 
       if (err)
@@ -458,7 +559,7 @@ int mxt_write_register(struct mxt_device *mxt, uint8_t const *buf,
 
     ret = sysfs_write_register(mxt, buf, start_register, count);
 
-    if (mxt->mxt_crc.crc_enabled == true) {
+    if (mxt->mxt_crc.crc_enabled == true && mxt->mxt_crc.session_depth == 0) {
       if (mxt->mxt_crc.reset_triggered == false) {
         err = sysfs_set_debug_irq(mxt, true);
       
@@ -486,13 +587,23 @@ int mxt_write_register(struct mxt_device *mxt, uint8_t const *buf,
     ret = hidraw_write_register(mxt, buf, start_register, count);
     break;
 
+  case E_MOCK:
+    ret = mock_write_register(mxt, buf, start_register, count);
+    break;
+
   default:
     mxt_err(mxt->ctx, "Device type not supported");
     ret = MXT_ERROR_NOT_SUPPORTED;
   }
 
-  if (ret == MXT_SUCCESS)
+  mxt_io_stats_record(mxt, MXT_IO_WRITE, count, start_us, ret);
+
+  pthread_mutex_unlock(&mxt->lock);
+
+  if (ret == MXT_SUCCESS) {
     mxt_log_buffer(mxt->ctx, LOG_VERBOSE, "TX:", buf, count);
+    mxt_trace(mxt->ctx, MXT_TRACE_TX, start_register, buf, count);
+  }
 
   return ret;
 }
@@ -504,10 +615,13 @@ int mxt_write_bytes(struct mxt_device *mxt, uint8_t const *buf,
                        int start_register, size_t count)
 {
   int ret;
+  uint64_t start_us = mxt_io_time_us();
 
   mxt_verb(mxt->ctx, "%s start_register:%d count:%zu", __func__,
            start_register, count);
 
+  pthread_mutex_lock(&mxt->lock);
+
   switch (mxt->conn->type) {
   case E_SYSFS_SPI:
   case E_SYSFS_I2C:
@@ -521,13 +635,141 @@ int mxt_write_bytes(struct mxt_device *mxt, uint8_t const *buf,
       ret = i2c_dev_write_register(mxt, buf, start_register, count);
     break;
 
+  case E_MOCK:
+    ret = mock_write_register(mxt, buf, start_register, count);
+    break;
+
   default:
     mxt_err(mxt->ctx, "Device type not supported");
     ret = MXT_ERROR_NOT_SUPPORTED;
   }
 
-  if (ret == MXT_SUCCESS)
+  mxt_io_stats_record(mxt, MXT_IO_WRITE, count, start_us, ret);
+
+  pthread_mutex_unlock(&mxt->lock);
+
+  if (ret == MXT_SUCCESS) {
     mxt_log_buffer(mxt->ctx, LOG_VERBOSE, "TX:", buf, count);
+    mxt_trace(mxt->ctx, MXT_TRACE_TX, start_register, buf, count);
+  }
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief  Begin an exclusive access session
+/// \note   In CRC mode the driver's IRQ handling is disabled once for the
+///         whole session rather than around every transfer, and the tx
+///         sequence number is tracked in memory. Sessions may be nested.
+///         The device lock is held until the matching mxt_session_end().
+/// \return #mxt_rc
+int mxt_session_begin(struct mxt_device *mxt)
+{
+  int err = 0;
+  uint16_t tx_seq_num = 0;
+
+  pthread_mutex_lock(&mxt->lock);
+
+  if (mxt->mxt_crc.session_depth++ > 0)
+    return MXT_SUCCESS;
+
+  switch (mxt->conn->type) {
+  case E_SYSFS_SPI:
+  case E_SYSFS_I2C:
+    if (mxt->mxt_crc.crc_enabled == true) {
+      err = sysfs_set_debug_irq(mxt, false);
+
+      if (err)
+        mxt_dbg(mxt->ctx, "Failed to disable debug_irq");
+    }
+    break;
+
+  case E_I2C_DEV:
+    if (mxt->debug_fs.enabled == true) {
+      err = debugfs_set_irq(mxt, false);
+
+      if (err)
+        mxt_dbg(mxt->ctx, "Could not disable IRQ");
+
+      if (mxt->mxt_crc.crc_enabled == true) {
+        err = debugfs_get_tx_seq_num(mxt, &tx_seq_num);
+
+        if (err)
+          mxt_dbg(mxt->ctx, "Failed to get the tx seq num");
+      }
+    }
+
+    mxt->mxt_crc.tx_seq_num = (uint8_t)tx_seq_num;
+    break;
+
+  default:
+    break;
+  }
+
+  mxt_verb(mxt->ctx, "Exclusive access session started");
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  End an exclusive access session
+/// \note   Writes the tracked tx sequence number back and restores IRQ
+///         handling when the outermost session ends
+/// \return #mxt_rc
+int mxt_session_end(struct mxt_device *mxt)
+{
+  int ret = MXT_SUCCESS;
+  int err;
+
+  if (mxt->mxt_crc.session_depth == 0) {
+    mxt_warn(mxt->ctx, "No exclusive access session to end");
+    return MXT_ERROR_BAD_INPUT;
+  }
+
+  if (--mxt->mxt_crc.session_depth > 0) {
+    pthread_mutex_unlock(&mxt->lock);
+    return MXT_SUCCESS;
+  }
+
+  switch (mxt->conn->type) {
+  case E_SYSFS_SPI:
+  case E_SYSFS_I2C:
+    if (mxt->mxt_crc.crc_enabled == true && mxt->mxt_crc.reset_triggered == false
+        && mxt->mxt_crc.config_triggered == false) {
+      err = sysfs_set_debug_irq(mxt, true);
+
+      if (err)
+        mxt_dbg(mxt->ctx, "Failed to enable debug_irq");
+    }
+    break;
+
+  case E_I2C_DEV:
+    if (mxt->debug_fs.enabled == false)
+      break;
+
+    if (mxt->mxt_crc.crc_enabled == true) {
+      ret = debugfs_set_tx_seq_num(mxt, mxt->mxt_crc.tx_seq_num);
+
+      if (ret)
+        mxt_dbg(mxt->ctx, "Failed to set tx seq num");
+    }
+
+    if (mxt->mxt_crc.reset_triggered == false && mxt->mxt_crc.config_triggered == false
+        && mxt->mxt_crc.processing_msg == false) {
+      err = debugfs_set_irq(mxt, true);
+
+      if (err)
+        mxt_dbg(mxt->ctx, "Could not enable IRQ");
+    }
+    break;
+
+  default:
+    break;
+  }
+
+  mxt_verb(mxt->ctx, "Exclusive access session ended");
+
+  pthread_mutex_unlock(&mxt->lock);
 
   return ret;
 }
@@ -550,6 +792,7 @@ int mxt_set_debug(struct mxt_device *mxt, bool debug_state)
 #endif
   case E_I2C_DEV:
   case E_HIDRAW:
+  case E_MOCK:
    
     /* Check for debugfs files */
 
@@ -597,6 +840,63 @@ int mxt_get_debug(struct mxt_device *mxt, bool *value)
   return ret;
 }
 
+//******************************************************************************
+/// \brief Handle the T6 status message sent when the device comes out of reset
+/// \return #mxt_rc
+static int handle_reset_msg(struct mxt_device *mxt, uint8_t *msg,
+                            void *context, uint8_t size)
+{
+  struct mxt_decoded_msg dec;
+
+  (void)context;
+
+  if (mxt_decode_msg(mxt, msg, size, &dec) == MXT_SUCCESS
+      && dec.kind == MXT_MSG_T6_STATUS && (dec.t6.status & MXT_T6_STATUS_RESET))
+    return MXT_SUCCESS;
+
+  return MXT_MSG_CONTINUE;
+}
+
+//******************************************************************************
+/// \brief  Wait for the T6 reset status, waking on CHG where available.
+///         timeout_ms is the fixed reset time used before, and is still all
+///         that is waited if the status is consumed elsewhere (eg by the
+///         kernel driver)
+/// \return #mxt_rc
+static int mxt_wait_reset(struct mxt_device *mxt, int timeout_ms)
+{
+  uint64_t start_us = mxt_io_time_us();
+  int elapsed_ms = 0;
+  int flag = false;
+  int ret;
+
+  msleep((timeout_ms < MXT_RESET_INVALID_CHG_MS) ? timeout_ms
+         : MXT_RESET_INVALID_CHG_MS);
+
+  while (elapsed_ms < timeout_ms) {
+    ret = mxt_read_messages_ms(mxt, timeout_ms - elapsed_ms, NULL,
+                               handle_reset_msg, &flag);
+    elapsed_ms = (mxt_io_time_us() - start_us) / 1000;
+
+    if (ret == MXT_SUCCESS) {
+      mxt_info(mxt->ctx, "Reset completed in %d ms", elapsed_ms);
+      return MXT_SUCCESS;
+    } else if (ret == MXT_ERROR_TIMEOUT) {
+      break;
+    }
+
+    /* Device may not answer on the bus until it has started up */
+    mxt_dbg(mxt->ctx, "Reading messages after reset failed, retrying");
+    msleep(MXT_MSG_POLL_DELAY_MS);
+    elapsed_ms = (mxt_io_time_us() - start_us) / 1000;
+  }
+
+  mxt_info(mxt->ctx, "No reset status after %d ms, assuming reset completed",
+           elapsed_ms);
+
+  return MXT_SUCCESS;
+}
+
 //******************************************************************************
 /// \brief  Perform fallback reset
 /// \return #mxt_rc
@@ -611,7 +911,7 @@ static int mxt_send_reset_command(struct mxt_device *mxt, bool bootloader_mode,
   bool irq_val;
 
   /* Obtain command processor's address */
-  t6_addr = mxt_get_object_address(mxt, GEN_COMMANDPROCESSOR_T6, 0);
+  t6_addr = mxt->obj_cache.t6_addr;
   if (t6_addr == OBJECT_NOT_FOUND)
     return MXT_ERROR_OBJECT_NOT_FOUND;
 
@@ -634,37 +934,38 @@ static int mxt_send_reset_command(struct mxt_device *mxt, bool bootloader_mode,
 
   } else {
 
-      if (mxt->conn->type != E_I2C_DEV)
+      if (mxt->conn->type != E_I2C_DEV && mxt->conn->type != E_MOCK)
         err = sysfs_reset_chip(mxt);
 
       /* Direct write to command processor, if mxt_reset file not found */
-      if (err || mxt->conn->type == E_I2C_DEV) {
+      if (err || mxt->conn->type == E_I2C_DEV || mxt->conn->type == E_MOCK) {
         mxt_info(mxt->ctx, "Sending reset command");
         ret = mxt_write_register(mxt, &write_value, t6_addr + MXT_T6_RESET_OFFSET, 1);
       }
  
       /*Re-enable irq processing in sysfs mode */
-      if (mxt->mxt_crc.crc_enabled == true && mxt->conn->type != E_I2C_DEV) {
+      if (mxt->mxt_crc.crc_enabled == true && mxt->conn->type != E_I2C_DEV
+          && mxt->conn->type != E_MOCK) {
         err = sysfs_set_debug_irq(mxt, true);
 
         if (err)
           mxt_dbg(mxt->ctx, "debug_irq not available\n");
       }
 
-    if (reset_time_ms == 0)
-        msleep(MXT_SOFT_RESET_TIME);
-    else
-        msleep(reset_time_ms);
-
-    if (mxt->conn->type == E_I2C_DEV && mxt->debug_fs.enabled == true) {
+    /* Chip restarts its sequence count after reset, so the reads made while
+     * waiting for the reset status must already use the new count */
+    if (mxt->conn->type == E_I2C_DEV && mxt->debug_fs.enabled == true
+        && mxt->mxt_crc.crc_enabled == true) {
+      err = debugfs_set_tx_seq_num(mxt, 0x00);
+      if (err)
+        mxt_dbg(mxt->ctx, "Failed to set tx seq numer\n");
 
-      if (mxt->mxt_crc.crc_enabled == true) {
+      mxt->mxt_crc.tx_seq_num = 0;
+    }
 
-        err = debugfs_set_tx_seq_num(mxt, 0x00);
-        if (err)
-          mxt_dbg(mxt->ctx, "Failed to set tx seq numer\n");
-      }
+    mxt_wait_reset(mxt, reset_time_ms ? reset_time_ms : MXT_SOFT_RESET_TIME);
 
+    if (mxt->conn->type == E_I2C_DEV && mxt->debug_fs.enabled == true) {
       err = debugfs_set_irq(mxt, true);
         if (err)
           mxt_dbg(mxt->ctx, "Could not enable IRQ");
@@ -685,13 +986,11 @@ static int mxt_send_flash_command(struct mxt_device *mxt, bool bootloader_mode,
   uint16_t t6_addr;
   unsigned char write_value[5];
   unsigned char flash_command = BOOTLOADER_COMMAND;
-  int i;
   uint8_t crc_data;
   uint8_t header = 0x03;
-  uint8_t count = 0;
 
   /* Obtain command processor's address */
-  t6_addr = mxt_get_object_address(mxt, GEN_COMMANDPROCESSOR_T6, 0);
+  t6_addr = mxt->obj_cache.t6_addr;
   if (t6_addr == OBJECT_NOT_FOUND)
     return MXT_ERROR_OBJECT_NOT_FOUND;
 
@@ -708,12 +1007,9 @@ static int mxt_send_flash_command(struct mxt_device *mxt, bool bootloader_mode,
     write_value[2] = t6_addr & 0xff;    //Get lower byte
     write_value[3] = (t6_addr >> 8) & 0xff; //Get uppper byte
 
-  for (i=0; i < (header); i++){
-
-    crc_data = mxt_calc_crc8(crc_data, write_value[i]);
+  crc_data = mxt_crc8(0, write_value, header);
 
-    mxt_dbg(mxt->ctx, "Buffer[%d] = %x, count = %d, crc = 0x%x\n", i, write_value[i], count, crc_data);
-  }
+  mxt_dbg(mxt->ctx, "Flash command header crc = 0x%x", crc_data);
 }
 
   /* Write to command processor register to perform command */
@@ -742,6 +1038,7 @@ int mxt_reset_chip(struct mxt_device *mxt, bool bootloader_mode, uint16_t reset_
   case E_SYSFS_I2C:
   case E_I2C_DEV:
   case E_HIDRAW:
+  case E_MOCK:
     ret = mxt_send_reset_command(mxt, bootloader_mode, reset_time_ms);
     break;
 
@@ -766,13 +1063,16 @@ static int handle_calibrate_msg(struct mxt_device *mxt, uint8_t *msg,
                                 void *context, uint8_t size)
 {
   int *last_status = context;
-  int status = msg[1];
+  struct mxt_decoded_msg dec;
+  int status;
+
+  if (mxt_decode_msg(mxt, msg, size, &dec) == MXT_SUCCESS
+      && dec.kind == MXT_MSG_T6_STATUS) {
+    status = dec.t6.status;
 
-  if (mxt_report_id_to_type(mxt, msg[0]) == GEN_COMMANDPROCESSOR_T6) {
-    if (status & 0x10) {
+    if (status & MXT_T6_STATUS_CAL) {
       mxt_dbg(mxt->ctx, "Device calibrating");
-    } else if (!(status & 0x10) && (*last_status & 0x10)) {
-      mxt_info(mxt->ctx, "Device calibrated");
+    } else if (*last_status & MXT_T6_STATUS_CAL) {
       return MXT_SUCCESS;
     }
 
@@ -792,7 +1092,7 @@ int mxt_calibrate_chip(struct mxt_device *mxt)
   unsigned char write_value = CALIBRATE_COMMAND;
 
   /* Obtain command processor's address */
-  t6_addr = mxt_get_object_address(mxt, GEN_COMMANDPROCESSOR_T6, 0);
+  t6_addr = mxt->obj_cache.t6_addr;
   if (t6_addr == OBJECT_NOT_FOUND)
     return MXT_ERROR_OBJECT_NOT_FOUND;
 
@@ -817,11 +1117,15 @@ int mxt_calibrate_chip(struct mxt_device *mxt)
 
   int state = 0;
   int flag = false;
+  uint64_t start_us = mxt_io_time_us();
 
-  ret = mxt_read_messages(mxt, MXT_CALIBRATE_TIMEOUT, &state,
-                          handle_calibrate_msg, &flag);
+  ret = mxt_read_messages_ms(mxt, MXT_CALIBRATE_TIMEOUT * 1000, &state,
+                             handle_calibrate_msg, &flag);
 
-  if (ret == MXT_ERROR_TIMEOUT) {
+  if (ret == MXT_SUCCESS) {
+    mxt_info(mxt->ctx, "Device calibrated in %d ms",
+             (int)((mxt_io_time_us() - start_us) / 1000));
+  } else if (ret == MXT_ERROR_TIMEOUT) {
     mxt_warn(mxt->ctx, "WARN: timed out waiting for calibrate status");
     ret = MXT_SUCCESS;
   } else if (ret) {
@@ -842,16 +1146,44 @@ end:
   return ret;
 }
 
+//******************************************************************************
+/// \brief  Poll a T6 command field until the device clears it, showing that
+///         the command has been carried out
+/// \return #mxt_rc, MXT_ERROR_TIMEOUT if still set after timeout_ms
+static int mxt_wait_t6_command(struct mxt_device *mxt, uint16_t addr,
+                               int timeout_ms, int *elapsed_ms)
+{
+  uint64_t start_us = mxt_io_time_us();
+  uint8_t value;
+  int ret;
+
+  for (;;) {
+    ret = mxt_read_register(mxt, &value, addr, 1);
+    *elapsed_ms = (mxt_io_time_us() - start_us) / 1000;
+    if (ret)
+      return ret;
+
+    if (value == 0)
+      return MXT_SUCCESS;
+
+    if (*elapsed_ms >= timeout_ms)
+      return MXT_ERROR_TIMEOUT;
+
+    msleep(MXT_MSG_POLL_DELAY_MS);
+  }
+}
+
 //******************************************************************************
 /// \brief  Backup configuration settings to non-volatile memory
 /// \return #mxt_rc
 int mxt_backup_config(struct mxt_device *mxt, uint8_t backup_command)
 {
   int ret;
+  int elapsed_ms;
   uint16_t t6_addr;
 
   /* Obtain command processor's address */
-  t6_addr = mxt_get_object_address(mxt, GEN_COMMANDPROCESSOR_T6, 0);
+  t6_addr = mxt->obj_cache.t6_addr;
   if (t6_addr == OBJECT_NOT_FOUND)
     return MXT_ERROR_OBJECT_NOT_FOUND;
 
@@ -861,10 +1193,23 @@ int mxt_backup_config(struct mxt_device *mxt, uint8_t backup_command)
           mxt, &backup_command, t6_addr + MXT_T6_BACKUPNV_OFFSET, 1
         );
 
-  if (ret == MXT_SUCCESS)
-    mxt_info(mxt->ctx, "Backed up settings to the non-volatile memory");
-  else
+  if (ret) {
     mxt_err(mxt->ctx, "Failed to back up settings");
+    return ret;
+  }
+
+  /* The device clears the field once the backup has finished */
+  ret = mxt_wait_t6_command(mxt, t6_addr + MXT_T6_BACKUPNV_OFFSET,
+                            MXT_BACKUP_TIMEOUT_MS, &elapsed_ms);
+  if (ret == MXT_SUCCESS) {
+    mxt_info(mxt->ctx, "Backed up settings to the non-volatile memory in %d ms",
+             elapsed_ms);
+  } else if (ret == MXT_ERROR_TIMEOUT) {
+    mxt_warn(mxt->ctx, "WARN: backup not acknowledged after %d ms", elapsed_ms);
+    ret = MXT_SUCCESS;
+  } else {
+    mxt_err(mxt->ctx, "Failed to read backup status");
+  }
 
   return ret;
 }
@@ -879,7 +1224,7 @@ int mxt_report_all(struct mxt_device *mxt)
   const uint8_t report_all_cmd = 0xff;
 
   /* Obtain command processor's address */
-  t6_addr = mxt_get_object_address(mxt, GEN_COMMANDPROCESSOR_T6, 0);
+  t6_addr = mxt->obj_cache.t6_addr;
   if (t6_addr == OBJECT_NOT_FOUND)
     return MXT_ERROR_OBJECT_NOT_FOUND;
 
@@ -904,6 +1249,9 @@ int mxt_report_all(struct mxt_device *mxt)
 int mxt_get_msg_count(struct mxt_device *mxt, int *count)
 {
   int ret;
+  uint64_t start_us = mxt_io_time_us();
+
+  pthread_mutex_lock(&mxt->lock);
 
   switch (mxt->conn->type) {
   case E_SYSFS_I2C:
@@ -920,6 +1268,7 @@ int mxt_get_msg_count(struct mxt_device *mxt, int *count)
 #endif /* HAVE_LIBUSB */
   case E_I2C_DEV:
   case E_HIDRAW:
+  case E_MOCK:
     ret = t44_t144_get_msg_count(mxt, count);
     break;
 
@@ -929,6 +1278,10 @@ int mxt_get_msg_count(struct mxt_device *mxt, int *count)
     break;
   }
 
+  mxt_io_stats_record(mxt, MXT_IO_MSG, 0, start_us, ret);
+
+  pthread_mutex_unlock(&mxt->lock);
+
   return ret;
 }
 
@@ -939,6 +1292,8 @@ char *mxt_get_msg_string(struct mxt_device *mxt)
 {
   char *msg_string = NULL;
 
+  pthread_mutex_lock(&mxt->lock);
+
   switch (mxt->conn->type) {
   case E_SYSFS_SPI:
   case E_SYSFS_I2C:
@@ -953,6 +1308,7 @@ char *mxt_get_msg_string(struct mxt_device *mxt)
 #endif /* HAVE_LIBUSB */
   case E_I2C_DEV:
   case E_HIDRAW:
+  case E_MOCK:
     msg_string = t44_get_msg_string(mxt);
     break;
 
@@ -961,6 +1317,8 @@ char *mxt_get_msg_string(struct mxt_device *mxt)
     break;
   }
 
+  pthread_mutex_unlock(&mxt->lock);
+
   if (msg_string)
     mxt_dbg(mxt->ctx, "%s", msg_string);
 
@@ -978,6 +1336,9 @@ int mxt_get_msg_bytes(struct mxt_device *mxt, unsigned char *buf,
                       size_t buflen, int *count)
 {
   int ret;
+  uint64_t start_us = mxt_io_time_us();
+
+  pthread_mutex_lock(&mxt->lock);
 
   switch (mxt->conn->type) {
   case E_SYSFS_SPI:
@@ -993,6 +1354,7 @@ int mxt_get_msg_bytes(struct mxt_device *mxt, unsigned char *buf,
 #endif /* HAVE_LIBUSB */
   case E_I2C_DEV:
   case E_HIDRAW:
+  case E_MOCK:
     ret = t44_get_msg_bytes(mxt, buf, buflen, count);
     break;
 
@@ -1002,12 +1364,164 @@ int mxt_get_msg_bytes(struct mxt_device *mxt, unsigned char *buf,
     break;
   }
 
+  mxt_io_stats_record(mxt, MXT_IO_MSG, ret ? 0 : *count, start_us, ret);
+
+  pthread_mutex_unlock(&mxt->lock);
+
  if (ret == MXT_SUCCESS)
    mxt_log_buffer(mxt->ctx, LOG_DEBUG, MSG_PREFIX, buf, *count);
 
   return ret;
 }
 
+//******************************************************************************
+/// \brief  Get all pending T5 messages as an array of records
+/// \param  mxt  Maxtouch Device
+/// \param  msgs  Array of message records to fill
+/// \param  max_msgs  Number of records in array
+/// \param  count  Number of records returned
+/// \return #mxt_rc
+int mxt_get_msgs_batch(struct mxt_device *mxt, struct mxt_msg *msgs,
+                       int max_msgs, int *count)
+{
+  int ret;
+  int pending, len, i;
+  uint64_t start_us = mxt_io_time_us();
+  size_t bytes = 0;
+
+  /* Held from the count read through the last T5 read, so that another
+   * thread cannot take messages in between */
+  pthread_mutex_lock(&mxt->lock);
+
+  switch (mxt->conn->type) {
+#ifdef HAVE_LIBUSB
+  case E_USB:
+#endif /* HAVE_LIBUSB */
+  case E_I2C_DEV:
+  case E_HIDRAW:
+  case E_MOCK:
+    ret = t44_get_msgs_batch(mxt, msgs, max_msgs, count);
+    break;
+
+  case E_SYSFS_SPI:
+  case E_SYSFS_I2C:
+    /* Messages are already buffered by the driver */
+    *count = 0;
+
+    ret = mxt_get_msg_count(mxt, &pending);
+    if (ret)
+      goto unlock;
+
+    for (i = 0; i < pending && *count < max_msgs; i++) {
+      len = 0;
+      ret = mxt_get_msg_bytes(mxt, msgs[*count].data,
+                              sizeof(msgs[*count].data), &len);
+      if (ret == MXT_ERROR_NO_MESSAGE)
+        continue;
+      else if (ret)
+        goto unlock;
+
+      if (len > 0) {
+        msgs[*count].size = len;
+        msgs[*count].timestamp_ns = mxt_time_ns();
+        (*count)++;
+      }
+    }
+
+    ret = MXT_SUCCESS;
+    goto unlock;
+
+  default:
+    mxt_err(mxt->ctx, "Device type not supported");
+    ret = MXT_ERROR_NOT_SUPPORTED;
+    goto unlock;
+  }
+
+  if (ret == MXT_SUCCESS) {
+    for (i = 0; i < *count; i++) {
+      mxt_log_buffer(mxt->ctx, LOG_DEBUG, MSG_PREFIX, msgs[i].data, msgs[i].size);
+      bytes += msgs[i].size;
+    }
+  }
+
+  /* The driver buffered case above is counted by its own calls */
+  mxt_io_stats_record(mxt, MXT_IO_MSG, bytes, start_us, ret);
+
+unlock:
+  pthread_mutex_unlock(&mxt->lock);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief  Get all pending T5 messages in place, without copying them
+/// \note   Only supported where the transport already buffers messages in
+///         fixed size records (sysfs debug v2). The records stay valid until
+///         the next message read, callers should fall back to
+///         mxt_get_msgs_batch() on MXT_ERROR_NOT_SUPPORTED
+/// \param  mxt  Maxtouch Device
+/// \param  records  Set to the first record
+/// \param  record_size  Size of each record in bytes
+/// \param  count  Number of records
+/// \return #mxt_rc
+int mxt_get_msgs_view(struct mxt_device *mxt, uint8_t **records,
+                      int *record_size, int *count)
+{
+  int ret;
+  int pending, i;
+  uint64_t start_us = mxt_io_time_us();
+
+  switch (mxt->conn->type) {
+  case E_SYSFS_SPI:
+  case E_SYSFS_I2C:
+    if (!sysfs_has_debug_v2(mxt))
+      return MXT_ERROR_NOT_SUPPORTED;
+
+    ret = sysfs_get_msgs_v2(mxt, &pending);
+    if (ret)
+      return ret;
+
+    ret = sysfs_get_msgs_view_v2(mxt, records, record_size, count);
+    break;
+
+  default:
+    return MXT_ERROR_NOT_SUPPORTED;
+  }
+
+  mxt_io_stats_record(mxt, MXT_IO_MSG,
+                      ret ? 0 : (size_t)*count * *record_size, start_us, ret);
+
+  /* Records in the view share the time of the driver read */
+  mxt->msg_time_ns = mxt_time_ns();
+
+  if (ret == MXT_SUCCESS) {
+    for (i = 0; i < *count; i++)
+      mxt_log_buffer(mxt->ctx, LOG_DEBUG, MSG_PREFIX,
+                     *records + i * *record_size, *record_size);
+  }
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief  Get largest register read which is carried out as one bus transfer
+/// \return Number of bytes
+int mxt_get_max_read_size(struct mxt_device *mxt)
+{
+  switch (mxt->conn->type) {
+#ifdef HAVE_LIBUSB
+  case E_USB:
+    return usb_get_max_read_size(mxt);
+#endif /* HAVE_LIBUSB */
+
+  case E_HIDRAW:
+    return HIDRAW_MAX_READ_SIZE;
+
+  case E_I2C_DEV:
+  default:
+    return mxt->ctx->i2c_block_size;
+  }
+}
+
 //******************************************************************************
 /// \brief  Discard all previous messages
 /// \return #mxt_rc
@@ -1015,6 +1529,8 @@ int mxt_msg_reset(struct mxt_device *mxt)
 {
   int ret;
 
+  pthread_mutex_lock(&mxt->lock);
+
   switch (mxt->conn->type) {
   case E_SYSFS_SPI:
   case E_SYSFS_I2C:
@@ -1030,6 +1546,7 @@ int mxt_msg_reset(struct mxt_device *mxt)
 #endif /* HAVE_LIBUSB */
   case E_I2C_DEV:
   case E_HIDRAW:
+  case E_MOCK:
     ret = t44_t144_msg_reset(mxt);
     break;
 
@@ -1039,6 +1556,8 @@ int mxt_msg_reset(struct mxt_device *mxt)
     break;
   }
 
+  pthread_mutex_unlock(&mxt->lock);
+
   return ret;
 }
 
@@ -1046,27 +1565,89 @@ int mxt_msg_reset(struct mxt_device *mxt)
 /// \brief  Get fd for message polling
 int mxt_get_msg_poll_fd(struct mxt_device *mxt)
 {
-  if (sysfs_has_debug_v2(mxt))
+  if ((mxt->conn->type == E_SYSFS_I2C || mxt->conn->type == E_SYSFS_SPI)
+      && sysfs_has_debug_v2(mxt))
     return sysfs_get_debug_v2_fd(mxt);
   else
     return 0;
 }
 
+//******************************************************************************
+/// \brief  Get file descriptor which signals new messages
+/// \param  mxt  Maxtouch Device
+/// \param  pfd  Poll entry to fill in
+/// \param  timeout_ms  Set to -1 if pfd alone signals new messages, or 0 if
+///         messages are already pending; otherwise left unchanged
+/// \return true if pfd has been filled in
+bool mxt_get_msg_pollfd(struct mxt_device *mxt, struct pollfd *pfd,
+                        int *timeout_ms)
+{
+  bool asserted;
+
+  pfd->revents = 0;
+
+  /* CHG line edge events, for any transport */
+  if (mxt->chg_gpio_fd >= 0) {
+    pfd->fd = mxt->chg_gpio_fd;
+    pfd->events = POLLIN;
+
+    if (gpio_chg_read(mxt, &asserted) == MXT_SUCCESS)
+      *timeout_ms = asserted ? 0 : -1;
+
+    return true;
+  }
+
+  switch (mxt->conn->type) {
+  case E_SYSFS_SPI:
+  case E_SYSFS_I2C:
+    if (!sysfs_has_debug_v2(mxt))
+      return false;
+
+    pfd->fd = sysfs_get_debug_v2_fd(mxt);
+    pfd->events = POLLPRI;
+    *timeout_ms = sysfs_debug_v2_pending(mxt) ? 0 : -1;
+    return true;
+
+  case E_HIDRAW:
+    /* Input reports only hint at activity, keep polling as well */
+    if (mxt->conn->hidraw.fd < 0)
+      return false;
+
+    pfd->fd = mxt->conn->hidraw.fd;
+    pfd->events = POLLIN;
+    return true;
+
+  default:
+    return false;
+  }
+}
+
 //******************************************************************************
 /// \brief  Wait for messages
+/// \return #mxt_rc, MXT_ERROR_TIMEOUT if the wait source shows that no
+///         messages are pending
 int mxt_msg_wait(struct mxt_device *mxt, int timeout_ms)
 {
   int ret;
-  int fd = 0;
   int numfds = 0;
+  int poll_timeout = timeout_ms;
   struct pollfd fds[1];
 
-  fd = mxt_get_msg_poll_fd(mxt);
-  if (fd) {
-    fds[0].fd = fd;
-    fds[0].events = POLLPRI;
+  if (mxt->chg_gpio_fd >= 0)
+    return gpio_chg_wait(mxt, timeout_ms);
+
+#ifdef HAVE_LIBUSB
+  if (mxt->conn->type == E_USB && mxt->usb.bridge_chip)
+    return usb_wait_chg(mxt, timeout_ms);
+#endif /* HAVE_LIBUSB */
+
+  if (mxt_get_msg_pollfd(mxt, &fds[0], &poll_timeout))
     numfds = 1;
-  }
+
+  /* The pollfd timeout drops to 0 when data is already pending, -1 means
+   * the fd alone is enough and the caller's timeout applies */
+  if (poll_timeout >= 0 && (timeout_ms < 0 || poll_timeout < timeout_ms))
+    timeout_ms = poll_timeout;
 
   ret = poll(fds, numfds, timeout_ms);
   if (ret == -1 && errno == EINTR) {
@@ -1075,6 +1656,9 @@ int mxt_msg_wait(struct mxt_device *mxt, int timeout_ms)
   } else if (ret < 0) {
     mxt_err(mxt->ctx, "poll returned %d (%s)", errno, strerror(errno));
     return MXT_ERROR_IO;
+  } else if (ret == 0 && numfds > 0 && poll_timeout < 0) {
+    /* The fd signals every message, hidraw input reports only hint */
+    return MXT_ERROR_TIMEOUT;
   }
 
   return MXT_SUCCESS;
@@ -35,6 +35,8 @@ extern "C" {
 #include <stdbool.h>
 #include <stddef.h>
 #include <signal.h>
+#include <poll.h>
+#include <pthread.h>
 
 struct libmaxtouch_ctx;
 struct mxt_device;
@@ -42,6 +44,9 @@ struct mxt_conn_info;
 
 #include "info_block.h"
 #include "log.h"
+#include "io_stats.h"
+#include "scan_cache.h"
+#include "msg_decode.h"
 #include "sysfs/sysfs_device.h"
 #include "debugfs/debugfs_device.h"
 #include "i2c_dev/i2c_dev_device.h"
@@ -50,6 +55,8 @@ struct mxt_conn_info;
 #include "usb/usb_device.h"
 #endif
 #include "hidraw/hidraw_device.h"
+#include "gpio/gpio_chg.h"
+#include "mock/mock_device.h"
 
 /* GEN_COMMANDPROCESSOR_T6 Register offsets from T6 base address */
 #define MXT_T6_RESET_OFFSET      0x00
@@ -71,12 +78,24 @@ struct mxt_conn_info;
 /* Polling delay for continually polling messages */
 #define MXT_MSG_POLL_DELAY_MS 10
 
+/* Largest T5 message record returned by mxt_get_msgs_batch() */
+#define MXT_MSG_MAX_SIZE 20
+
+/* Messages drained per mxt_get_msgs_batch() call, covers full T44 count */
+#define MXT_MSG_BATCH_SIZE 255
+
 /* Calibrate timeout */
 #define MXT_CALIBRATE_TIMEOUT 10
 
-/* Soft reset time, no i2c activity */
+/* Soft reset time, no i2c activity. Longest wait for the T6 reset status */
 #define MXT_SOFT_RESET_TIME  1000
 
+/* CHG and the bus are not valid for this long after a reset command */
+#define MXT_RESET_INVALID_CHG_MS 100
+
+/* Longest wait for the device to clear the T6 BACKUPNV field */
+#define MXT_BACKUP_TIMEOUT_MS 2000
+
 //******************************************************************************
 /// \brief Return codes
 enum mxt_rc {
@@ -137,6 +156,7 @@ enum mxt_device_type {
   E_I2C_DEV,
   E_HIDRAW,
   E_SPI,
+  E_MOCK,
 };
 
 //******************************************************************************
@@ -144,8 +164,23 @@ enum mxt_device_type {
 struct libmaxtouch_ctx {
   bool query;
   int scan_count;
+  bool scan_cached;
   enum mxt_log_level log_level;
   int i2c_block_size;
+  bool reopen_fd;
+  int chg_gpio_chip;
+  int chg_gpio_line;
+  const char *config_cache_dir;
+  const char *scan_cache_file;
+  struct mxt_scan_cache *scan_cache;
+
+  char *log_arena;
+  size_t log_arena_size;
+  struct mxt_trace *trace;
+
+  /* Serialises logging, tracing, scanning and the scan cache so that one
+   * context can be shared by threads driving different devices */
+  pthread_mutex_t lock;
 
   void (*log_fn)(struct libmaxtouch_ctx *ctx, enum mxt_log_level level,
                  const char *format, va_list args);
@@ -168,21 +203,39 @@ struct mxt_conn_info {
     struct i2c_dev_conn_info i2c_dev;
     struct hidraw_conn_info hidraw;
     struct sysfs_conn_info sysfs;
+    struct mock_conn_info mock;
 #ifdef HAVE_LIBUSB
     struct usb_conn_info usb;
 #endif
   };
 };
 
+//******************************************************************************
+/// \brief T5 message record
+struct mxt_msg {
+  uint8_t size;
+  uint8_t data[MXT_MSG_MAX_SIZE];
+  /* CLOCK_MONOTONIC time of the T5 read, see mxt_time_ns() */
+  uint64_t timestamp_ns;
+};
+
 //******************************************************************************
 /// \brief Device context
 struct mxt_device {
   struct mxt_conn_info *conn;
   struct libmaxtouch_ctx *ctx;
   struct mxt_info info;
+  struct mxt_object_cache obj_cache;
   struct mxt_report_id_map *report_id_map;
   char msg_string[255];
+  /* Time of the T5 read of the message being handled, see struct mxt_msg */
+  uint64_t msg_time_ns;
   struct mxt_crc_device mxt_crc;
+  int chg_gpio_fd;
+  struct mxt_io_stats io_stats;
+
+  /* Held across each transfer and for the length of a session */
+  pthread_mutex_t lock;
 
   union {
     struct sysfs_device sysfs;
@@ -191,6 +244,7 @@ struct mxt_device {
     struct usb_device usb;
 #endif
     struct i2c_dev_device i2c_dev;
+    struct mock_device mock;
   };
 };
 
@@ -204,11 +258,12 @@ struct mxt_conn_info *mxt_unref_conn(struct mxt_conn_info *conn);
 int mxt_new_device(struct libmaxtouch_ctx *ctx, struct mxt_conn_info *conn, struct mxt_device **mxt);
 void mxt_set_log_fn(struct libmaxtouch_ctx *ctx, void (*log_fn)(struct libmaxtouch_ctx *ctx, enum mxt_log_level level, const char *format, va_list args));
 void mxt_free_device(struct mxt_device *mxt);
-uint8_t mxt_calc_crc8(unsigned char crc, unsigned char data);
 int mxt_get_info(struct mxt_device *mxt);
 int mxt_read_register(struct mxt_device *mxt, uint8_t *buf, int start_register, size_t count);
 int mxt_write_register(struct mxt_device *mxt, uint8_t const *buf, int start_register, size_t count);
 int mxt_write_bytes(struct mxt_device *mxt, uint8_t const *buf, int start_register, size_t count);
+int mxt_session_begin(struct mxt_device *mxt);
+int mxt_session_end(struct mxt_device *mxt);
 int sysfs_get_tx_seq_num(struct mxt_device *mxt, uint16_t *value);
 int sysfs_set_tx_seq_num(struct mxt_device *mxt, uint8_t value);
 int sysfs_set_bootloader(struct mxt_device *mxt, bool value);
@@ -220,14 +275,19 @@ int mxt_reset_chip(struct mxt_device *mxt, bool bootloader_mode, uint16_t reset_
 int mxt_calibrate_chip(struct mxt_device *mxt);
 int mxt_backup_config(struct mxt_device *mxt, uint8_t backup_command);
 int mxt_load_config_file(struct mxt_device *mxt, const char *cfg_file);
+int mxt_load_config_file_diff(struct mxt_device *mxt, const char *cfg_file);
 int mxt_save_config_file(struct mxt_device *mxt, const char *filename);
 int mxt_zero_config(struct mxt_device *mxt);
 int mxt_get_msg_count(struct mxt_device *mxt, int *count);
 char *mxt_get_msg_string(struct mxt_device *mxt);
 int mxt_get_msg_bytes(struct mxt_device *mxt, unsigned char *buf, size_t buflen, int *count);
+int mxt_get_msgs_batch(struct mxt_device *mxt, struct mxt_msg *msgs, int max_msgs, int *count);
+int mxt_get_msgs_view(struct mxt_device *mxt, uint8_t **records, int *record_size, int *count);
+int mxt_get_max_read_size(struct mxt_device *mxt);
 int mxt_msg_reset(struct mxt_device *mxt);
 int mxt_dump_messages(struct mxt_device *mxt);
 int mxt_get_msg_poll_fd(struct mxt_device *mxt);
+bool mxt_get_msg_pollfd(struct mxt_device *mxt, struct pollfd *pfd, int *timeout_ms);
 int mxt_bootloader_read(struct mxt_device *mxt, unsigned char *buf, int count);
 int mxt_bootloader_write(struct mxt_device *mxt, unsigned char const *buf, int count);
 int mxt_msg_wait(struct mxt_device *mxt, int timeout_ms);
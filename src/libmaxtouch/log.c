@@ -30,6 +30,10 @@
 #include "stdio.h"
 #include "stdint.h"
 #include "malloc.h"
+#include <string.h>
+#include <time.h>
+#include <inttypes.h>
+#include <pthread.h>
 
 #include "libmaxtouch.h"
 #include "libmaxtouch/utilfuncs.h"
@@ -42,6 +46,48 @@
 #endif
 #endif
 
+/* Initial size of the hex string arena, enough for a 256 byte transfer */
+#define MXT_LOG_ARENA_SIZE    (256 * 3 + 1)
+
+/* Bytes of each transfer kept in a trace entry */
+#define MXT_TRACE_DATA_MAX    32
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+//******************************************************************************
+/// \brief Binary trace ring entry
+struct mxt_trace_entry {
+  uint64_t timestamp_us;
+  uint16_t addr;
+  uint16_t count;
+  uint8_t dir;
+  uint8_t data[MXT_TRACE_DATA_MAX];
+};
+
+//******************************************************************************
+/// \brief Binary trace ring, oldest entries are overwritten
+struct mxt_trace {
+  struct mxt_trace_entry *entries;
+  size_t size;
+  size_t next;
+  uint64_t total;
+};
+
+//******************************************************************************
+/// \brief  Encode bytes as space separated hex, buf must hold count*3 + 1
+static void hex_encode(char *buf, const unsigned char *data, size_t count)
+{
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    *buf++ = hex_digits[data[i] >> 4];
+    *buf++ = hex_digits[data[i] & 0x0F];
+    *buf++ = ' ';
+  }
+
+  *buf = '\0';
+}
+
 //******************************************************************************
 /// \brief  Returns the input log level as a human-readable string.
 /// \return Log level string
@@ -105,37 +151,205 @@ void mxt_log_buffer(struct libmaxtouch_ctx *ctx, enum mxt_log_level level,
                     const unsigned char *data, size_t count)
 {
 #if ENABLE_DEBUG
-  unsigned int i;
   char *hexbuf;
   size_t strsize = count*3 + 1;
 
   if (mxt_get_log_level(ctx) > level)
     return;
 
-  hexbuf = (char *)calloc(strsize, sizeof(char));
-  if (hexbuf == NULL) {
-    mxt_err(ctx, "%s: calloc failure", __func__);
-    return;
+  pthread_mutex_lock(&ctx->lock);
+
+  /* Reuse the context arena, only growing it for a longer buffer */
+  if (strsize > ctx->log_arena_size) {
+    hexbuf = (char *)realloc(ctx->log_arena, strsize);
+    if (hexbuf == NULL) {
+      mxt_err(ctx, "%s: realloc failure", __func__);
+      pthread_mutex_unlock(&ctx->lock);
+      return;
+    }
+
+    ctx->log_arena = hexbuf;
+    ctx->log_arena_size = strsize;
   }
 
-  for (i = 0; i < count; i++)
-    sprintf(&hexbuf[3 * i], "%02X ", data[i]);
+  hex_encode(ctx->log_arena, data, count);
 
-  mxt_log(ctx, LOG_VERBOSE, "%s %s", prefix, hexbuf);
+  mxt_log(ctx, LOG_VERBOSE, "%s %s", prefix, ctx->log_arena);
 
-  free(hexbuf);
+  pthread_mutex_unlock(&ctx->lock);
 #endif
 }
 
+//*****************************************************************************
+/// \brief Allocate the hex string arena used by mxt_log_buffer
+/// \return #mxt_rc
+int mxt_log_init(struct libmaxtouch_ctx *ctx)
+{
+  ctx->log_arena = (char *)malloc(MXT_LOG_ARENA_SIZE);
+  if (!ctx->log_arena)
+    return MXT_ERROR_NO_MEM;
+
+  ctx->log_arena_size = MXT_LOG_ARENA_SIZE;
+
+  return MXT_SUCCESS;
+}
+
+//*****************************************************************************
+/// \brief Free logging buffers
+void mxt_log_free(struct libmaxtouch_ctx *ctx)
+{
+  mxt_trace_disable(ctx);
+
+  free(ctx->log_arena);
+  ctx->log_arena = NULL;
+  ctx->log_arena_size = 0;
+}
+
+//*****************************************************************************
+/// \brief Start recording register transfers into a ring of entries
+/// \return #mxt_rc
+int mxt_trace_enable(struct libmaxtouch_ctx *ctx, size_t entries)
+{
+  struct mxt_trace *trace;
+
+  if (entries == 0)
+    return MXT_ERROR_BAD_INPUT;
+
+  trace = (struct mxt_trace *)calloc(1, sizeof(struct mxt_trace));
+  if (!trace)
+    return MXT_ERROR_NO_MEM;
+
+  trace->entries = (struct mxt_trace_entry *)calloc(entries,
+                   sizeof(struct mxt_trace_entry));
+  if (!trace->entries) {
+    free(trace);
+    return MXT_ERROR_NO_MEM;
+  }
+
+  trace->size = entries;
+
+  pthread_mutex_lock(&ctx->lock);
+  mxt_trace_disable(ctx);
+  ctx->trace = trace;
+  pthread_mutex_unlock(&ctx->lock);
+
+  return MXT_SUCCESS;
+}
+
+//*****************************************************************************
+/// \brief Stop recording and free the trace ring
+void mxt_trace_disable(struct libmaxtouch_ctx *ctx)
+{
+  pthread_mutex_lock(&ctx->lock);
+
+  if (ctx->trace) {
+    free(ctx->trace->entries);
+    free(ctx->trace);
+    ctx->trace = NULL;
+  }
+
+  pthread_mutex_unlock(&ctx->lock);
+}
+
+//*****************************************************************************
+/// \brief Record a register transfer in the trace ring, if enabled
+void mxt_trace(struct libmaxtouch_ctx *ctx, enum mxt_trace_dir dir,
+               uint16_t addr, const unsigned char *data, size_t count)
+{
+  struct mxt_trace *trace;
+  struct mxt_trace_entry *entry;
+  struct timespec ts;
+
+  if (!ctx->trace)
+    return;
+
+  pthread_mutex_lock(&ctx->lock);
+
+  trace = ctx->trace;
+  if (!trace) {
+    pthread_mutex_unlock(&ctx->lock);
+    return;
+  }
+
+  entry = &trace->entries[trace->next];
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  entry->timestamp_us = (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  entry->dir = dir;
+  entry->addr = addr;
+  entry->count = (count > UINT16_MAX) ? UINT16_MAX : count;
+  memcpy(entry->data, data,
+         (count > MXT_TRACE_DATA_MAX) ? MXT_TRACE_DATA_MAX : count);
+
+  trace->next = (trace->next + 1) % trace->size;
+  trace->total++;
+
+  pthread_mutex_unlock(&ctx->lock);
+}
+
+//*****************************************************************************
+/// \brief Write the trace ring to a stream, oldest entry first
+/// \return #mxt_rc
+int mxt_trace_dump(struct libmaxtouch_ctx *ctx, FILE *fp)
+{
+  struct mxt_trace *trace;
+  struct mxt_trace_entry *entry;
+  char hexbuf[MXT_TRACE_DATA_MAX * 3 + 1];
+  size_t start, num, i;
+  size_t len;
+  int ret = MXT_SUCCESS;
+
+  pthread_mutex_lock(&ctx->lock);
+
+  trace = ctx->trace;
+  if (!trace) {
+    pthread_mutex_unlock(&ctx->lock);
+    return MXT_ERROR_NOT_SUPPORTED;
+  }
+
+  if (trace->total > trace->size) {
+    start = trace->next;
+    num = trace->size;
+    fprintf(fp, "# %" PRIu64 " older entries overwritten\n",
+            trace->total - trace->size);
+  } else {
+    start = 0;
+    num = trace->total;
+  }
+
+  for (i = 0; i < num; i++) {
+    entry = &trace->entries[(start + i) % trace->size];
+    len = (entry->count > MXT_TRACE_DATA_MAX) ? MXT_TRACE_DATA_MAX : entry->count;
+
+    hex_encode(hexbuf, entry->data, len);
+
+    if (fprintf(fp, "%" PRIu64 ".%06" PRIu64 " %s %04X %u: %s%s\n",
+                entry->timestamp_us / 1000000, entry->timestamp_us % 1000000,
+                (entry->dir == MXT_TRACE_RX) ? "RX" : "TX",
+                entry->addr, entry->count, hexbuf,
+                (len < entry->count) ? "..." : "") < 0) {
+      ret = MXT_ERROR_IO;
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&ctx->lock);
+
+  return ret;
+}
+
 //******************************************************************************
 /// \brief Log function
 void mxt_log(struct libmaxtouch_ctx *ctx, enum mxt_log_level level, const char *format, ...)
 {
   va_list args;
 
+  /* Keep lines from threads sharing the context whole */
+  pthread_mutex_lock(&ctx->lock);
   va_start(args, format);
   ctx->log_fn(ctx, level, format, args);
   va_end(args);
+  pthread_mutex_unlock(&ctx->lock);
 }
 
 //******************************************************************************
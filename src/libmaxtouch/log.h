@@ -30,6 +30,7 @@
 
 #include <stdint.h>
 #include <stdarg.h>
+#include <stdio.h>
 
 #define ENABLE_LOGGING   1
 
@@ -53,7 +54,14 @@ enum mxt_log_level {
   LOG_SILENT  = 8
 };
 
+/* Register transfer direction in trace */
+enum mxt_trace_dir {
+  MXT_TRACE_RX,
+  MXT_TRACE_TX
+};
+
 struct libmaxtouch_ctx;
+struct mxt_trace;
 
 enum mxt_log_level mxt_get_log_level(struct libmaxtouch_ctx *ctx);
 void mxt_set_log_level(struct libmaxtouch_ctx *ctx, uint8_t verbose);
@@ -61,6 +69,12 @@ void mxt_log_stdout(struct libmaxtouch_ctx *ctx, enum mxt_log_level level, const
 void mxt_log_stderr(struct libmaxtouch_ctx *ctx, enum mxt_log_level level, const char *format, va_list args);
 void mxt_log_android(struct libmaxtouch_ctx *ctx, enum mxt_log_level level, const char *format, va_list args);
 void mxt_log_buffer(struct libmaxtouch_ctx *ctx, enum mxt_log_level level, const char *prefix, const unsigned char *data, size_t count);
+int mxt_log_init(struct libmaxtouch_ctx *ctx);
+void mxt_log_free(struct libmaxtouch_ctx *ctx);
+int mxt_trace_enable(struct libmaxtouch_ctx *ctx, size_t entries);
+void mxt_trace_disable(struct libmaxtouch_ctx *ctx);
+void mxt_trace(struct libmaxtouch_ctx *ctx, enum mxt_trace_dir dir, uint16_t addr, const unsigned char *data, size_t count);
+int mxt_trace_dump(struct libmaxtouch_ctx *ctx, FILE *fp);
 
 static inline void __attribute__((always_inline, format(printf, 2, 3)))
 mxt_log_null(struct libmaxtouch_ctx *ctx, const char *format, ...) {}
@@ -0,0 +1,911 @@
+//------------------------------------------------------------------------------
+/// \file   mock_device.c
+/// \brief  Device emulation from a register map, replaying recorded messages
+///         and diagnostic data frames with their original timing
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/info_block.h"
+#include "libmaxtouch/config_image.h"
+#include "libmaxtouch/capture.h"
+#include "libmaxtouch/crc.h"
+#include "libmaxtouch/log.h"
+
+#include "mock_device.h"
+
+/* Whole 16-bit register address space */
+#define MOCK_MAP_SIZE         0x10000
+
+/* Messages raised by commands, returned ahead of recorded messages */
+#define MOCK_CMD_MSG_MAX      16
+
+/* Longest trace line, see mxt_trace_dump() */
+#define MOCK_TRACE_LINE_MAX   512
+
+/* T6 status message bits */
+#define MOCK_T6_STATUS_RESET  0x80
+#define MOCK_T6_STATUS_CAL    0x10
+
+/* T6 diagnostic field commands */
+#define MOCK_T37_PAGE_UP      0x01
+#define MOCK_T37_PAGE_DOWN    0x02
+#define MOCK_T37_REFS_MODE    0x11
+
+//******************************************************************************
+/// \brief Recorded T5 message
+struct mock_msg {
+  uint64_t time_us;
+  uint8_t data[MXT_MSG_MAX_SIZE];
+};
+
+//******************************************************************************
+/// \brief Mock device state
+struct mock_state {
+  uint8_t regs[MOCK_MAP_SIZE];
+  uint64_t start_us;
+
+  /* Objects taken from the info block */
+  uint16_t t5_addr;
+  uint16_t t5_size;
+  uint16_t t6_addr;
+  uint16_t t37_addr;
+  uint16_t t37_size;
+  uint16_t t44_addr;
+  uint16_t t25_addr;
+  uint8_t t6_report_id;
+  uint8_t t25_report_id;
+  uint32_t crc_start;
+  uint32_t crc_end;
+
+  /* Recorded messages, in time order, relative to the start of the trace */
+  struct mock_msg *msgs;
+  int num_msgs;
+  int next_msg;
+
+  /* Responses to T6 and T25 commands */
+  uint8_t cmd_msgs[MOCK_CMD_MSG_MAX][MXT_MSG_MAX_SIZE];
+  int cmd_head;
+  int cmd_count;
+
+  /* Binary capture holding the info block and frames to replay */
+  uint8_t *capture;
+  /* Fixed size records decoded from a delta coded capture */
+  uint8_t *decoded;
+  const struct mxt_capture_header *hdr;
+  const uint8_t *records;
+  size_t record_size;
+  int num_frames;
+  int next_frame;
+  uint64_t frame_start_us;
+  bool interleaved;
+
+  /* Diagnostic command in progress */
+  uint8_t diag_mode;
+  int diag_page;
+  const struct mxt_capture_record *diag_frame;
+  uint64_t diag_due_us;
+};
+
+//******************************************************************************
+/// \brief Get monotonic time in microseconds
+static uint64_t mock_time_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//******************************************************************************
+/// \brief Read a whole file into memory
+/// \return #mxt_rc
+static int mock_read_file(struct libmaxtouch_ctx *ctx, const char *filename,
+                          uint8_t **buf, size_t *len)
+{
+  FILE *fp;
+  long size;
+  int ret = MXT_SUCCESS;
+
+  fp = fopen(filename, "rb");
+  if (!fp) {
+    mxt_err(ctx, "Could not open %s, error %s (%d)",
+            filename, strerror(errno), errno);
+    return mxt_errno_to_rc(errno);
+  }
+
+  if (fseek(fp, 0, SEEK_END) || (size = ftell(fp)) < 0
+      || fseek(fp, 0, SEEK_SET)) {
+    ret = mxt_errno_to_rc(errno);
+    goto close;
+  }
+
+  *buf = malloc(size ? size : 1);
+  if (!*buf) {
+    ret = MXT_ERROR_NO_MEM;
+    goto close;
+  }
+
+  if (fread(*buf, 1, size, fp) != (size_t)size) {
+    mxt_err(ctx, "Could not read %s", filename);
+    free(*buf);
+    *buf = NULL;
+    ret = MXT_ERROR_IO;
+    goto close;
+  }
+
+  *len = size;
+
+close:
+  fclose(fp);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Find an object in the register map info block
+/// \return Object table entry, or NULL if not present
+static const struct mxt_object *mock_find_object(struct mock_state *s,
+                                                 uint16_t type)
+{
+  const struct mxt_id_info *id = (const struct mxt_id_info *)s->regs;
+  const struct mxt_object *objects =
+    (const struct mxt_object *)(s->regs + sizeof(struct mxt_id_info));
+  int i;
+
+  for (i = 0; i < id->num_objects; i++) {
+    if (objects[i].type == type)
+      return &objects[i];
+  }
+
+  return NULL;
+}
+
+//******************************************************************************
+/// \brief Place the info block at address 0 and locate the objects emulated
+/// \return #mxt_rc
+static int mock_load_info(struct mxt_device *mxt, struct mock_state *s,
+                          const uint8_t *info, size_t len)
+{
+  const struct mxt_id_info *id = (const struct mxt_id_info *)info;
+  const struct mxt_object *objects;
+  const struct mxt_object *obj;
+  size_t info_size;
+  uint32_t start = UINT32_MAX;
+  uint32_t end = 0;
+  uint32_t addr, size;
+  int report_id = 1;
+  int i;
+
+  if (len < sizeof(struct mxt_id_info))
+    goto bad_info;
+
+  info_size = sizeof(struct mxt_id_info)
+              + id->num_objects * sizeof(struct mxt_object)
+              + sizeof(struct mxt_raw_crc);
+  if (len < info_size)
+    goto bad_info;
+
+  memcpy(s->regs, info, info_size);
+  objects = (const struct mxt_object *)(s->regs + sizeof(struct mxt_id_info));
+
+  for (i = 0; i < id->num_objects; i++) {
+    obj = &objects[i];
+    addr = mxt_get_start_position(*obj, 0);
+    size = MXT_SIZE(*obj) * MXT_INSTANCES(*obj);
+
+    if (addr + size > MOCK_MAP_SIZE)
+      goto bad_info;
+
+    if (obj->type == GEN_COMMANDPROCESSOR_T6 && obj->num_report_ids)
+      s->t6_report_id = report_id;
+
+    if (obj->type == SPT_SELFTEST_T25 && obj->num_report_ids)
+      s->t25_report_id = report_id;
+
+    report_id += obj->num_report_ids * MXT_INSTANCES(*obj);
+
+    if (mxt_object_used_for_crc(obj->type)) {
+      if (start > addr)
+        start = addr;
+
+      if (end < addr + size)
+        end = addr + size;
+    }
+  }
+
+  s->crc_start = (start > end) ? end : start;
+  s->crc_end = end;
+
+  obj = mock_find_object(s, GEN_MESSAGEPROCESSOR_T5);
+  if (!obj || MXT_SIZE(*obj) < 2 || MXT_SIZE(*obj) - 1 > MXT_MSG_MAX_SIZE) {
+    mxt_err(mxt->ctx, "Mock info block has no usable T5");
+    return MXT_ERROR_FILE_FORMAT;
+  }
+
+  s->t5_addr = mxt_get_start_position(*obj, 0);
+  /* Records are read without the CRC byte */
+  s->t5_size = MXT_SIZE(*obj) - 1;
+
+  obj = mock_find_object(s, GEN_COMMANDPROCESSOR_T6);
+  s->t6_addr = obj ? mxt_get_start_position(*obj, 0) : OBJECT_NOT_FOUND;
+
+  obj = mock_find_object(s, DEBUG_DIAGNOSTIC_T37);
+  s->t37_addr = obj ? mxt_get_start_position(*obj, 0) : OBJECT_NOT_FOUND;
+  s->t37_size = obj ? MXT_SIZE(*obj) : 0;
+
+  obj = mock_find_object(s, SPT_SELFTEST_T25);
+  s->t25_addr = obj ? mxt_get_start_position(*obj, 0) : OBJECT_NOT_FOUND;
+
+  obj = mock_find_object(s, SPT_MESSAGECOUNT_T44);
+  s->t44_addr = obj ? mxt_get_start_position(*obj, 0) : OBJECT_NOT_FOUND;
+
+  /* sort_debug_data() reorders references from these devices */
+  if (id->family == 0xA6) {
+    switch (id->variant) {
+    case 0x06 ... 0x08:
+    case 0x0A:
+    case 0x0C ... 0x14:
+      s->interleaved = true;
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  return MXT_SUCCESS;
+
+bad_info:
+  mxt_err(mxt->ctx, "Mock info block is truncated or invalid");
+  return MXT_ERROR_FILE_FORMAT;
+}
+
+//******************************************************************************
+/// \brief Decode the frames of a delta coded capture into fixed size records
+/// \return #mxt_rc
+static int mock_load_delta_frames(struct mxt_device *mxt, struct mock_state *s,
+                                  size_t ofs, size_t len)
+{
+  const struct mxt_capture_header *hdr = s->hdr;
+  struct mxt_capture_delta_record drec;
+  struct mxt_capture_record *rec;
+  size_t record_size = sizeof(*rec) + hdr->value_count * sizeof(uint16_t);
+  size_t pos;
+  uint16_t *values;
+  uint8_t *decoded;
+  int alloc = 0;
+  int ret;
+
+  if (hdr->flags) {
+    mxt_warn(mxt->ctx, "Only mutual capacitance frames are replayed");
+    return MXT_SUCCESS;
+  }
+
+  values = (uint16_t *)calloc(hdr->value_count ? hdr->value_count : 1,
+                              sizeof(uint16_t));
+  if (!values)
+    return MXT_ERROR_NO_MEM;
+
+  for (pos = ofs;;) {
+    ret = mxt_capture_next_frame(s->capture, len, &pos, values,
+                                 hdr->value_count, &drec);
+    if (ret == MXT_ERROR_NO_MESSAGE) {
+      break;
+    } else if (ret) {
+      mxt_warn(mxt->ctx, "Bad delta coded frame, replaying %d frames",
+               s->num_frames);
+      break;
+    }
+
+    if (s->num_frames == alloc) {
+      alloc = alloc ? alloc * 2 : 16;
+      decoded = realloc(s->decoded, alloc * record_size);
+      if (!decoded) {
+        free(values);
+        return MXT_ERROR_NO_MEM;
+      }
+
+      s->decoded = decoded;
+    }
+
+    rec = (struct mxt_capture_record *)(s->decoded + s->num_frames * record_size);
+    rec->frame = drec.frame;
+    rec->timestamp = drec.timestamp;
+    memcpy(rec + 1, values, hdr->value_count * sizeof(uint16_t));
+    s->num_frames++;
+  }
+
+  free(values);
+
+  s->records = s->decoded;
+  s->record_size = record_size;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Load a raw info block, or the info block and frames of a capture
+/// \return #mxt_rc
+static int mock_load_info_file(struct mxt_device *mxt, struct mock_state *s,
+                               const char *filename)
+{
+  const struct mxt_capture_header *hdr;
+  uint8_t *buf = NULL;
+  size_t len = 0;
+  size_t ofs;
+  int ret;
+
+  ret = mock_read_file(mxt->ctx, filename, &buf, &len);
+  if (ret)
+    return ret;
+
+  hdr = (const struct mxt_capture_header *)buf;
+
+  if (len < sizeof(*hdr)
+      || memcmp(hdr->magic, MXT_CAPTURE_MAGIC, sizeof(hdr->magic))) {
+    ret = mock_load_info(mxt, s, buf, len);
+    free(buf);
+    return ret;
+  }
+
+  if ((hdr->version != MXT_CAPTURE_VERSION
+       && hdr->version != MXT_CAPTURE_VERSION_DELTA)
+      || hdr->header_size < sizeof(*hdr)
+      || (size_t)hdr->header_size + hdr->info_size > len) {
+    mxt_err(mxt->ctx, "Unsupported capture file %s", filename);
+    free(buf);
+    return MXT_ERROR_FILE_FORMAT;
+  }
+
+  ret = mock_load_info(mxt, s, buf + hdr->header_size, hdr->info_size);
+  if (ret) {
+    free(buf);
+    return ret;
+  }
+
+  ofs = hdr->header_size + hdr->info_size;
+  if (hdr->flags & MXT_CAPTURE_T15_KEYARRAY)
+    ofs += hdr->passes;
+
+  s->capture = buf;
+  s->hdr = hdr;
+
+  if (hdr->version == MXT_CAPTURE_VERSION_DELTA)
+    return mock_load_delta_frames(mxt, s, ofs, len);
+
+  if (hdr->flags || hdr->record_size < sizeof(struct mxt_capture_record)
+      + hdr->value_count * sizeof(uint16_t) || ofs > len) {
+    mxt_warn(mxt->ctx, "Only mutual capacitance frames are replayed");
+    return MXT_SUCCESS;
+  }
+
+  s->records = buf + ofs;
+  s->record_size = hdr->record_size;
+  s->num_frames = (len - ofs) / hdr->record_size;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Write a config file into the register map, by object table address
+/// \return #mxt_rc
+static int mock_load_config(struct mxt_device *mxt, struct mock_state *s,
+                            const char *filename)
+{
+  const struct mxt_config_image_object *cfg;
+  const struct mxt_object *obj;
+  struct mxt_config_image *image;
+  uint16_t addr;
+  uint32_t size;
+  int ret, i;
+
+  ret = mxt_config_image_load(mxt->ctx, filename, &image);
+  if (ret)
+    return ret;
+
+  for (i = 0; i < image->num_objects; i++) {
+    cfg = &image->objects[i];
+
+    obj = mock_find_object(s, cfg->type);
+    if (!obj || MXT_INSTANCES(*obj) <= cfg->instance) {
+      mxt_warn(mxt->ctx, "T%u not present", cfg->type);
+      continue;
+    }
+
+    addr = mxt_get_start_position(*obj, cfg->instance);
+    size = cfg->size;
+
+    if (size > (uint32_t)MXT_SIZE(*obj))
+      size = MXT_SIZE(*obj);
+
+    memcpy(s->regs + addr, cfg->data, size);
+  }
+
+  mxt_config_image_free(image);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Parse hex bytes as written by mxt_trace_dump()
+/// \return Number of bytes
+static size_t mock_parse_hex(const char *s, uint8_t *buf, size_t max)
+{
+  size_t count = 0;
+  unsigned int val;
+  int n;
+
+  while (count < max && sscanf(s, " %2x%n", &val, &n) == 1) {
+    buf[count++] = val;
+    s += n;
+  }
+
+  return count;
+}
+
+//******************************************************************************
+/// \brief Take T5 messages from the register reads in a trace file
+/// \return #mxt_rc
+static int mock_load_msgs(struct mxt_device *mxt, struct mock_state *s,
+                          const char *filename)
+{
+  char line[MOCK_TRACE_LINE_MAX];
+  uint8_t data[MOCK_TRACE_LINE_MAX / 3];
+  struct mock_msg *msgs;
+  uint64_t sec, usec, time_us;
+  uint64_t first_us = 0;
+  bool first = true;
+  char dir[3];
+  unsigned int addr, count;
+  size_t len, ofs;
+  int alloc = 0;
+  int pos;
+  FILE *fp;
+
+  fp = fopen(filename, "r");
+  if (!fp) {
+    mxt_err(mxt->ctx, "Could not open %s, error %s (%d)",
+            filename, strerror(errno), errno);
+    return mxt_errno_to_rc(errno);
+  }
+
+  while (fgets(line, sizeof(line), fp)) {
+    if (sscanf(line, "%" SCNu64 ".%" SCNu64 " %2s %x %u:%n",
+               &sec, &usec, dir, &addr, &count, &pos) != 5)
+      continue;
+
+    time_us = sec * 1000000 + usec;
+    if (first) {
+      first_us = time_us;
+      first = false;
+    }
+
+    if (strcmp(dir, "RX"))
+      continue;
+
+    /* Message count followed by the first message, or messages alone */
+    if (addr == s->t44_addr && addr + 1 == s->t5_addr)
+      ofs = 1;
+    else if (addr == s->t5_addr)
+      ofs = 0;
+    else
+      continue;
+
+    len = mock_parse_hex(line + pos, data, sizeof(data));
+    if (len > count)
+      len = count;
+
+    /* Truncated entries keep only their complete records */
+    for (; ofs + s->t5_size <= len; ofs += s->t5_size) {
+      if (data[ofs] == 0xFF)
+        continue;
+
+      if (s->num_msgs == alloc) {
+        alloc = alloc ? alloc * 2 : 256;
+        msgs = realloc(s->msgs, alloc * sizeof(struct mock_msg));
+        if (!msgs) {
+          fclose(fp);
+          return MXT_ERROR_NO_MEM;
+        }
+
+        s->msgs = msgs;
+      }
+
+      memset(&s->msgs[s->num_msgs], 0, sizeof(struct mock_msg));
+      s->msgs[s->num_msgs].time_us = time_us - first_us;
+      memcpy(s->msgs[s->num_msgs].data, data + ofs, s->t5_size);
+      s->num_msgs++;
+    }
+  }
+
+  fclose(fp);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Queue a T6 status message, carrying the config CRC of the map
+static void mock_queue_status(struct mock_state *s, uint8_t status)
+{
+  uint8_t *msg;
+  uint32_t crc;
+
+  if (!s->t6_report_id || s->cmd_count == MOCK_CMD_MSG_MAX)
+    return;
+
+  crc = mxt_crc24(s->regs + s->crc_start, s->crc_end - s->crc_start);
+
+  msg = s->cmd_msgs[(s->cmd_head + s->cmd_count) % MOCK_CMD_MSG_MAX];
+  memset(msg, 0, MXT_MSG_MAX_SIZE);
+  msg[0] = s->t6_report_id;
+  msg[1] = status;
+  msg[2] = crc & 0xFF;
+  msg[3] = (crc >> 8) & 0xFF;
+  msg[4] = (crc >> 16) & 0xFF;
+
+  s->cmd_count++;
+}
+
+//******************************************************************************
+/// \brief Queue a T25 result message. Every test passes on the mock device.
+static void mock_queue_self_test(struct mock_state *s)
+{
+  uint8_t *msg;
+
+  if (!s->t25_report_id || s->cmd_count == MOCK_CMD_MSG_MAX)
+    return;
+
+  msg = s->cmd_msgs[(s->cmd_head + s->cmd_count) % MOCK_CMD_MSG_MAX];
+  memset(msg, 0, MXT_MSG_MAX_SIZE);
+  msg[0] = s->t25_report_id;
+  msg[1] = 0xFE; /* all tests passed */
+
+  s->cmd_count++;
+}
+
+//******************************************************************************
+/// \brief Count messages available now
+static int mock_pending_msgs(struct mock_state *s, uint64_t now)
+{
+  int count = s->cmd_count;
+  int i;
+
+  for (i = s->next_msg; i < s->num_msgs && count < 255; i++) {
+    if (s->msgs[i].time_us > now - s->start_us)
+      break;
+
+    count++;
+  }
+
+  return (count > 255) ? 255 : count;
+}
+
+//******************************************************************************
+/// \brief Take the next available message, or an invalid message if none
+static void mock_pop_msg(struct mock_state *s, uint64_t now, uint8_t *buf)
+{
+  if (s->cmd_count) {
+    memcpy(buf, s->cmd_msgs[s->cmd_head], s->t5_size);
+    s->cmd_head = (s->cmd_head + 1) % MOCK_CMD_MSG_MAX;
+    s->cmd_count--;
+  } else if (s->next_msg < s->num_msgs
+             && s->msgs[s->next_msg].time_us <= now - s->start_us) {
+    memcpy(buf, s->msgs[s->next_msg].data, s->t5_size);
+    s->next_msg++;
+  } else {
+    memset(buf, 0, s->t5_size);
+    buf[0] = 0xFF;
+  }
+}
+
+//******************************************************************************
+/// \brief Get a value of the current frame in T37 page order
+static uint16_t mock_frame_value(struct mock_state *s, int i)
+{
+  const uint8_t *values = (const uint8_t *)(s->diag_frame + 1);
+  uint16_t val;
+  int y_size = s->hdr->y_size;
+  int half, p;
+
+  /* Undo sort_debug_data(): even rows then odd rows, odd last stays */
+  if (s->interleaved && s->diag_mode == MOCK_T37_REFS_MODE && y_size) {
+    half = y_size / 2;
+    p = i % y_size;
+
+    if (!(y_size % 2 && p == y_size - 1))
+      p = (p < half) ? p * 2 : (p - half) * 2 + 1;
+
+    i = i - i % y_size + p;
+  }
+
+  /* Records are packed, so values may be unaligned */
+  memcpy(&val, values + i * sizeof(uint16_t), sizeof(val));
+
+  return val;
+}
+
+//******************************************************************************
+/// \brief Fill T37 with the current page
+static void mock_fill_t37(struct mock_state *s)
+{
+  uint8_t *page = s->regs + s->t37_addr;
+  int page_values = (s->t37_size - 2) / 2;
+  int i, value;
+  uint16_t val;
+
+  memset(page, 0, s->t37_size);
+  page[0] = s->diag_mode;
+  page[1] = s->diag_page;
+
+  if (!s->diag_frame)
+    return;
+
+  for (i = 0; i < page_values; i++) {
+    value = s->diag_page * page_values + i;
+    if (value >= s->hdr->value_count)
+      break;
+
+    val = mock_frame_value(s, value);
+    page[2 + i * 2] = val & 0xFF;
+    page[3 + i * 2] = val >> 8;
+  }
+}
+
+//******************************************************************************
+/// \brief Act on a write to the T6 diagnostic field. A new mode command takes
+///        the next captured frame, and completes at its recorded time.
+static void mock_diag_command(struct mock_state *s, uint8_t cmd, uint64_t now)
+{
+  const struct mxt_capture_record *first;
+  uint64_t offset_us;
+
+  s->diag_due_us = now;
+
+  if (s->t37_addr == OBJECT_NOT_FOUND || s->t37_size < 2)
+    return;
+
+  if (cmd == MOCK_T37_PAGE_UP) {
+    s->diag_page++;
+  } else if (cmd == MOCK_T37_PAGE_DOWN) {
+    if (s->diag_page > 0)
+      s->diag_page--;
+  } else {
+    s->diag_mode = cmd;
+    s->diag_page = 0;
+    s->diag_frame = NULL;
+
+    if (s->num_frames && cmd == s->hdr->mode) {
+      /* Loop the capture, restarting its timing */
+      if (s->next_frame == s->num_frames)
+        s->next_frame = 0;
+
+      if (s->next_frame == 0)
+        s->frame_start_us = now;
+
+      first = (const struct mxt_capture_record *)s->records;
+      s->diag_frame = (const struct mxt_capture_record *)
+                      (s->records + s->next_frame * s->record_size);
+      s->next_frame++;
+
+      offset_us = s->diag_frame->timestamp - first->timestamp;
+      if (s->hdr->flags & MXT_CAPTURE_MONOTONIC)
+        offset_us /= 1000;
+
+      s->diag_due_us = s->frame_start_us + offset_us;
+    }
+  }
+
+  mock_fill_t37(s);
+}
+
+//******************************************************************************
+/// \brief Act on commands written to T6
+static void mock_t6_commands(struct mxt_device *mxt, struct mock_state *s,
+                             uint16_t start, size_t count, uint64_t now)
+{
+  uint8_t *t6 = s->regs + s->t6_addr;
+
+#define MOCK_T6_WRITTEN(ofs) \
+  ((size_t)s->t6_addr + (ofs) >= start && \
+   (size_t)s->t6_addr + (ofs) < start + count)
+
+  if (MOCK_T6_WRITTEN(MXT_T6_RESET_OFFSET) && t6[MXT_T6_RESET_OFFSET]) {
+    if (t6[MXT_T6_RESET_OFFSET] == BOOTLOADER_COMMAND)
+      mxt_warn(mxt->ctx, "Mock device has no bootloader");
+
+    s->cmd_count = 0;
+    s->diag_mode = 0;
+    mock_queue_status(s, MOCK_T6_STATUS_RESET);
+    mock_queue_status(s, 0);
+    t6[MXT_T6_RESET_OFFSET] = 0;
+  }
+
+  if (MOCK_T6_WRITTEN(MXT_T6_BACKUPNV_OFFSET))
+    t6[MXT_T6_BACKUPNV_OFFSET] = 0;
+
+  if (MOCK_T6_WRITTEN(MXT_T6_CALIBRATE_OFFSET) && t6[MXT_T6_CALIBRATE_OFFSET]) {
+    mock_queue_status(s, MOCK_T6_STATUS_CAL);
+    mock_queue_status(s, 0);
+    t6[MXT_T6_CALIBRATE_OFFSET] = 0;
+  }
+
+  if (MOCK_T6_WRITTEN(MXT_T6_REPORTALL_OFFSET) && t6[MXT_T6_REPORTALL_OFFSET]) {
+    mock_queue_status(s, 0);
+    t6[MXT_T6_REPORTALL_OFFSET] = 0;
+  }
+
+  if (MOCK_T6_WRITTEN(MXT_T6_DIAGNOSTIC_OFFSET) && t6[MXT_T6_DIAGNOSTIC_OFFSET])
+    mock_diag_command(s, t6[MXT_T6_DIAGNOSTIC_OFFSET], now);
+
+#undef MOCK_T6_WRITTEN
+}
+
+//******************************************************************************
+/// \brief  Open mock device
+/// \return #mxt_rc
+int mock_open(struct mxt_device *mxt)
+{
+  struct mock_conn_info *conn = &mxt->conn->mock;
+  struct mock_state *s;
+  int ret;
+
+  if (!conn->info_file) {
+    mxt_err(mxt->ctx, "Mock device needs an info block or capture file");
+    return MXT_ERROR_BAD_INPUT;
+  }
+
+  s = calloc(1, sizeof(struct mock_state));
+  if (!s)
+    return MXT_ERROR_NO_MEM;
+
+  mxt->mock.state = s;
+
+  ret = mock_load_info_file(mxt, s, conn->info_file);
+  if (ret)
+    goto failure;
+
+  if (conn->config_file) {
+    ret = mock_load_config(mxt, s, conn->config_file);
+    if (ret)
+      goto failure;
+  }
+
+  if (conn->msg_file) {
+    ret = mock_load_msgs(mxt, s, conn->msg_file);
+    if (ret)
+      goto failure;
+  }
+
+  s->start_us = mock_time_us();
+
+  mxt_info(mxt->ctx, "Registered mock device %s, %d frames, %d messages",
+           conn->info_file, s->num_frames, s->num_msgs);
+
+  return MXT_SUCCESS;
+
+failure:
+  mock_release(mxt);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief  Release mock device
+void mock_release(struct mxt_device *mxt)
+{
+  struct mock_state *s = mxt->mock.state;
+
+  if (!s)
+    return;
+
+  free(s->capture);
+  free(s->decoded);
+  free(s->msgs);
+  free(s);
+  mxt->mock.state = NULL;
+}
+
+//******************************************************************************
+/// \brief  Read registers from the map. T44 gives the number of messages due
+///         by now, and each T5 record read takes one of them.
+/// \return #mxt_rc
+int mock_read_register(struct mxt_device *mxt, unsigned char *buf,
+                       uint16_t start_register, size_t count,
+                       size_t *bytes_transferred)
+{
+  struct mock_state *s = mxt->mock.state;
+  uint64_t now = mock_time_us();
+  uint8_t msg[MXT_MSG_MAX_SIZE];
+  size_t ofs, len;
+
+  if (start_register + count > MOCK_MAP_SIZE) {
+    mxt_err(mxt->ctx, "Mock read past end of register map");
+    return MXT_ERROR_IO;
+  }
+
+  /* Diagnostic command completes once its frame is due */
+  if (s->t6_addr != OBJECT_NOT_FOUND && now >= s->diag_due_us)
+    s->regs[s->t6_addr + MXT_T6_DIAGNOSTIC_OFFSET] = 0;
+
+  memcpy(buf, s->regs + start_register, count);
+
+  if (s->t44_addr >= start_register && s->t44_addr < start_register + count)
+    buf[s->t44_addr - start_register] = mock_pending_msgs(s, now);
+
+  if (s->t5_addr >= start_register && s->t5_addr < start_register + count) {
+    for (ofs = s->t5_addr - start_register; ofs < count; ofs += s->t5_size) {
+      mock_pop_msg(s, now, msg);
+
+      len = count - ofs;
+      if (len > s->t5_size)
+        len = s->t5_size;
+
+      memcpy(buf + ofs, msg, len);
+    }
+  }
+
+  *bytes_transferred = count;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Write registers to the map, acting on T6 and T25 commands
+/// \return #mxt_rc
+int mock_write_register(struct mxt_device *mxt, unsigned char const *buf,
+                        uint16_t start_register, size_t count)
+{
+  struct mock_state *s = mxt->mock.state;
+
+  if (start_register + count > MOCK_MAP_SIZE) {
+    mxt_err(mxt->ctx, "Mock write past end of register map");
+    return MXT_ERROR_IO;
+  }
+
+  memcpy(s->regs + start_register, buf, count);
+
+  if (s->t6_addr != OBJECT_NOT_FOUND)
+    mock_t6_commands(mxt, s, start_register, count, mock_time_us());
+
+  /* T25 CMD register clears when the test completes */
+  if (s->t25_addr != OBJECT_NOT_FOUND
+      && (size_t)s->t25_addr + 1 >= start_register
+      && (size_t)s->t25_addr + 1 < start_register + count
+      && s->regs[s->t25_addr + 1]) {
+    mock_queue_self_test(s);
+    s->regs[s->t25_addr + 1] = 0;
+  }
+
+  return MXT_SUCCESS;
+}
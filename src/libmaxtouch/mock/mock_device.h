@@ -0,0 +1,56 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   mock_device.h
+/// \brief  headers for in-memory mock device backend
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct mxt_device;
+struct mock_state;
+
+//******************************************************************************
+/// \brief Device information for mock backend
+struct mock_conn_info {
+  /* Raw info block, or binary capture whose frames are replayed */
+  char *info_file;
+  /* Optional .xcfg or OBP_RAW config loaded into the register map */
+  char *config_file;
+  /* Optional --trace output whose T5 messages are replayed */
+  char *msg_file;
+};
+
+//******************************************************************************
+/// \brief Mock device, state is allocated on open
+struct mock_device {
+  struct mock_state *state;
+};
+
+int mock_open(struct mxt_device *mxt);
+void mock_release(struct mxt_device *mxt);
+int mock_read_register(struct mxt_device *mxt, unsigned char *buf, uint16_t start_register, size_t count, size_t *bytes_transferred);
+int mock_write_register(struct mxt_device *mxt, unsigned char const *buf, uint16_t start_register, size_t count);
@@ -34,6 +34,7 @@
 
 #include "libmaxtouch.h"
 #include "msg.h"
+#include "utilfuncs.h"
 
 //******************************************************************************
 /// \brief  Get number of messages
@@ -45,9 +46,9 @@ int t44_t144_get_msg_count(struct mxt_device *mxt, int *count_out)
   uint8_t count;
 
   if (mxt->mxt_crc.crc_enabled == true)
-    addr = mxt_get_object_address(mxt, SPT_MESSAGECOUNT_T144, 0);
+    addr = mxt->obj_cache.t144_addr;
   else
-    addr = mxt_get_object_address(mxt, SPT_MESSAGECOUNT_T44, 0);
+    addr = mxt->obj_cache.t44_addr;
 
   if (addr == OBJECT_NOT_FOUND) 
     return MXT_ERROR_OBJECT_NOT_FOUND;
@@ -66,20 +67,15 @@ int t44_t144_get_msg_count(struct mxt_device *mxt, int *count_out)
 /// \return String or NULL for error
 char *t44_get_msg_string(struct mxt_device *mxt)
 {
-  int ret, i;
+  int ret;
   int size;
-  size_t length;
   unsigned char databuf[20];
 
   ret = t44_get_msg_bytes(mxt, databuf, sizeof(databuf), &size);
   if (ret)
     return NULL;
 
-  length = snprintf(mxt->msg_string, sizeof(mxt->msg_string), MSG_PREFIX);
-  for (i = 0; i < size; i++) {
-    length += snprintf(mxt->msg_string + length, sizeof(mxt->msg_string) - length,
-                       "%02X ", databuf[i]);
-  }
+  mxt_format_msg_hex(mxt->msg_string, sizeof(mxt->msg_string), databuf, size);
 
   return &mxt->msg_string[0];
 }
@@ -94,12 +90,12 @@ int t44_get_msg_bytes(struct mxt_device *mxt, unsigned char *buf,
   uint16_t addr;
   uint16_t size;
 
-  addr = mxt_get_object_address(mxt, GEN_MESSAGEPROCESSOR_T5, 0);
+  addr = mxt->obj_cache.t5_addr;
   if (addr == OBJECT_NOT_FOUND)
     return MXT_ERROR_OBJECT_NOT_FOUND;
 
   /* Do not read CRC byte */
-  size = mxt_get_object_size(mxt, GEN_MESSAGEPROCESSOR_T5) - 1;
+  size = mxt->obj_cache.t5_size - 1;
   if (size > buflen) {
     mxt_err(mxt->ctx, "Buffer too small!");
     return MXT_ERROR_NO_MEM;
@@ -120,26 +116,134 @@ int t44_get_msg_bytes(struct mxt_device *mxt, unsigned char *buf,
 }
 
 //******************************************************************************
-/// \brief  Discard all messages
+/// \brief  Store T5 record in message array, skipping invalid messages
+static void t44_add_msg(struct mxt_msg *msgs, int *count, uint8_t *data,
+                        uint16_t size, uint64_t time_ns)
+{
+  if (data[0] == 255u)
+    return;
+
+  memcpy(msgs[*count].data, data, size);
+  msgs[*count].size = size;
+  msgs[*count].timestamp_ns = time_ns;
+  (*count)++;
+}
+
+//******************************************************************************
+/// \brief  Read message count and pending T5 messages with the fewest
+///         possible bus transfers
+/// \note   T44 normally sits directly before T5, so the count and the first
+///         message are read together. The remaining messages are read from
+///         the T5 address in chunks of whole records, since the device moves
+///         on to the next message each time a read wraps past the end of T5.
 /// \return #mxt_rc
-int t44_t144_msg_reset(struct mxt_device *mxt)
+int t44_get_msgs_batch(struct mxt_device *mxt, struct mxt_msg *msgs,
+                       int max_msgs, int *count_out)
 {
-  int count, i, ret, size;
-  unsigned char databuf[20];
+  uint8_t buf[I2C_DEV_MAX_BLOCK + 1];
+  uint16_t count_addr;
+  uint16_t t5_addr;
+  uint16_t size;
+  int max_read;
+  int count, chunk;
+  int ret, len, i;
+  uint64_t time_ns;
+
+  *count_out = 0;
+
+  if (mxt->mxt_crc.crc_enabled == true)
+    count_addr = mxt->obj_cache.t144_addr;
+  else
+    count_addr = mxt->obj_cache.t44_addr;
 
-  ret = t44_t144_get_msg_count(mxt, &count);
-  if (ret) {
-    mxt_verb(mxt->ctx, "rc = %d", ret);
+  t5_addr = mxt->obj_cache.t5_addr;
+
+  if (count_addr == OBJECT_NOT_FOUND || t5_addr == OBJECT_NOT_FOUND)
+    return MXT_ERROR_OBJECT_NOT_FOUND;
+
+  /* Do not read CRC byte */
+  size = mxt->obj_cache.t5_size - 1;
+  if (size > MXT_MSG_MAX_SIZE) {
+    mxt_err(mxt->ctx, "Buffer too small!");
+    return MXT_ERROR_NO_MEM;
+  }
+
+  max_read = mxt_get_max_read_size(mxt);
+  if (max_read > (int)sizeof(buf))
+    max_read = sizeof(buf);
+
+  /* CRC framed reads carry one record per transfer */
+  if (mxt->mxt_crc.crc_enabled || count_addr + 1 != t5_addr
+      || max_read < size + 1) {
+    ret = t44_t144_get_msg_count(mxt, &count);
+    if (ret)
+      return ret;
+
+    for (i = 0; i < count && *count_out < max_msgs; i++) {
+      ret = t44_get_msg_bytes(mxt, msgs[*count_out].data,
+                              sizeof(msgs[*count_out].data), &len);
+      if (ret == MXT_ERROR_NO_MESSAGE)
+        continue;
+      else if (ret)
+        return ret;
+
+      msgs[*count_out].size = len;
+      msgs[*count_out].timestamp_ns = mxt_time_ns();
+      (*count_out)++;
+    }
+
+    return MXT_SUCCESS;
+  }
+
+  /* Count plus first message */
+  ret = mxt_read_register(mxt, buf, count_addr, size + 1);
+  if (ret)
     return ret;
+
+  count = buf[0];
+  if (count == 0 || max_msgs == 0)
+    return MXT_SUCCESS;
+
+  if (count > max_msgs)
+    count = max_msgs;
+
+  t44_add_msg(msgs, count_out, buf + 1, size, mxt_time_ns());
+  count--;
+
+  while (count > 0) {
+    chunk = max_read / size;
+    if (chunk > count)
+      chunk = count;
+
+    ret = mxt_read_register(mxt, buf, t5_addr, chunk * size);
+    if (ret)
+      return ret;
+
+    time_ns = mxt_time_ns();
+    for (i = 0; i < chunk; i++)
+      t44_add_msg(msgs, count_out, buf + i * size, size, time_ns);
+
+    count -= chunk;
   }
 
-  for (i = 0; i < count; i++) {
-    ret = t44_get_msg_bytes(mxt, &databuf[0], sizeof(databuf), &size);
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Discard all messages
+/// \return #mxt_rc
+int t44_t144_msg_reset(struct mxt_device *mxt)
+{
+  struct mxt_msg msgs[MXT_MSG_BATCH_SIZE];
+  int count, ret;
+
+  do {
+    ret = t44_get_msgs_batch(mxt, msgs, MXT_MSG_BATCH_SIZE, &count);
     if (ret) {
       mxt_verb(mxt->ctx, "rc = %d", ret);
       return ret;
     }
-  }
+  } while (count == MXT_MSG_BATCH_SIZE);
 
   return MXT_SUCCESS;
 }
@@ -165,27 +269,26 @@ int mxt_dump_messages(struct mxt_device *mxt)
 }
 
 //******************************************************************************
-/// \brief Get messages from device and display to user
-/// \param timeout_seconds Represent the time in seconds to continuously
-///   display messages to the user. By setting timeout_seconds to 0, or
-///   MSG_NO_WAIT the T5 object is read only once. By setting timeout_seconds to
-///   -1, or  MSG_CONTINUOUS the T5 object is repeatedly read until the user
-///   presses Ctrl-C.
+/// \brief Get messages from device and pass them to msg_func
 /// \param  mxt  Maxtouch Device
+/// \param  timeout_ms  Give up after this many milliseconds. 0 reads the T5
+///   object once, -1 reads until flag is set
 /// \param  context Additional context required by msg_func
 /// \param  msg_func Pointer to function to read object status
 /// \param  flag Pointer to control flag
-/// \return #mxt_rc
-int mxt_read_messages(struct mxt_device *mxt, int timeout_seconds, void *context,
-                      int (*msg_func)(struct mxt_device *mxt, uint8_t *msg,
-                                      void *context, uint8_t size), int *flag)
+/// \return #mxt_rc, MXT_ERROR_TIMEOUT if timeout_ms passed first
+int mxt_read_messages_ms(struct mxt_device *mxt, int timeout_ms, void *context,
+                         int (*msg_func)(struct mxt_device *mxt, uint8_t *msg,
+                                         void *context, uint8_t size), int *flag)
 {
-  int count, len;
-  time_t now;
-  time_t start_time = time(NULL);
-  uint8_t buf[12];    //Fixed size for MSG
+  struct mxt_msg msgs[MXT_MSG_BATCH_SIZE];
+  uint8_t *records;
+  int record_size;
+  int count, i;
+  uint64_t start_us = mxt_io_time_us();
+  int64_t remaining_ms;
+  int wait_ms = MXT_MSG_POLL_DELAY_MS;
   int ret, err;
-  bool irq_val;
 
   if (mxt->conn->type == E_I2C_DEV && mxt->debug_fs.enabled == true) {
     err = debugfs_set_irq(mxt, false);
@@ -195,39 +298,75 @@ int mxt_read_messages(struct mxt_device *mxt, int timeout_seconds, void *context
   }
 
   while (!*flag) {
-    mxt_msg_wait(mxt, MXT_MSG_POLL_DELAY_MS);
-
-    ret = mxt_get_msg_count(mxt, &count);
-    if (ret)
-      return ret;
-
-    while (count--) {
-      len = 0;
-      ret = mxt_get_msg_bytes(mxt, buf, sizeof(buf), &len);
-      if (ret && ret != MXT_ERROR_NO_MESSAGE)
+    /* Skip the bus read if the wait source shows nothing is pending */
+    ret = mxt_msg_wait(mxt, wait_ms);
+    if (ret != MXT_ERROR_TIMEOUT) {
+      /* Hand out driver buffered records directly where possible */
+      ret = mxt_get_msgs_view(mxt, &records, &record_size, &count);
+      if (ret == MXT_SUCCESS) {
+        for (i = 0; i < count; i++) {
+          ret = ((*msg_func)(mxt, records + i * record_size, context, record_size));
+          if (ret != MXT_MSG_CONTINUE)
+            return ret;
+        }
+      } else if (ret != MXT_ERROR_NOT_SUPPORTED) {
         return ret;
-
-      if (len > 0) {
-        ret = ((*msg_func)(mxt, buf, context, len));
-        if (ret != MXT_MSG_CONTINUE)
+      } else {
+        ret = mxt_get_msgs_batch(mxt, msgs, MXT_MSG_BATCH_SIZE, &count);
+        if (ret)
           return ret;
+
+        for (i = 0; i < count; i++) {
+          mxt->msg_time_ns = msgs[i].timestamp_ns;
+          ret = ((*msg_func)(mxt, msgs[i].data, context, msgs[i].size));
+          if (ret != MXT_MSG_CONTINUE)
+            return ret;
+        }
       }
     }
 
-    if (timeout_seconds == 0) {
+    if (timeout_ms == 0) {
       return MXT_SUCCESS;
-    } else if (timeout_seconds > 0) {
-      now = time(NULL);
-      if ((now - start_time) > timeout_seconds) {
-        mxt_err(mxt->ctx, "Readmsg: Timeout");
+    } else if (timeout_ms > 0) {
+      remaining_ms = timeout_ms - (int64_t)(mxt_io_time_us() - start_us) / 1000;
+      if (remaining_ms <= 0)
         return MXT_ERROR_TIMEOUT;
-      }
+
+      /* Don't overrun the timeout in the last wait */
+      wait_ms = (remaining_ms < MXT_MSG_POLL_DELAY_MS)
+                ? (int)remaining_ms : MXT_MSG_POLL_DELAY_MS;
     }
   }
 
   return MXT_SUCCESS;
 }
 
+//******************************************************************************
+/// \brief Get messages from device and display to user
+/// \param timeout_seconds Represent the time in seconds to continuously
+///   display messages to the user. By setting timeout_seconds to 0, or
+///   MSG_NO_WAIT the T5 object is read only once. By setting timeout_seconds to
+///   -1, or  MSG_CONTINUOUS the T5 object is repeatedly read until the user
+///   presses Ctrl-C.
+/// \param  mxt  Maxtouch Device
+/// \param  context Additional context required by msg_func
+/// \param  msg_func Pointer to function to read object status
+/// \param  flag Pointer to control flag
+/// \return #mxt_rc
+int mxt_read_messages(struct mxt_device *mxt, int timeout_seconds, void *context,
+                      int (*msg_func)(struct mxt_device *mxt, uint8_t *msg,
+                                      void *context, uint8_t size), int *flag)
+{
+  int ret;
+
+  ret = mxt_read_messages_ms(mxt, (timeout_seconds > 0) ? timeout_seconds * 1000
+                             : timeout_seconds, context, msg_func, flag);
+  if (ret == MXT_ERROR_TIMEOUT)
+    mxt_err(mxt->ctx, "Readmsg: Timeout");
+
+  return ret;
+}
+
 //******************************************************************************
 /// \brief Flush messages in buffer
 /// \return #mxt_rc
@@ -246,9 +385,12 @@ int mxt_flush_msgs(struct mxt_device *mxt)
 static int get_checksum_message(struct mxt_device *mxt, uint8_t *msg,
                                 void *context, uint8_t size)
 {
-  if (mxt_report_id_to_type(mxt, msg[0]) == GEN_COMMANDPROCESSOR_T6) {
+  struct mxt_decoded_msg dec;
+
+  if (mxt_decode_msg(mxt, msg, size, &dec) == MXT_SUCCESS
+      && dec.kind == MXT_MSG_T6_STATUS) {
     uint32_t *checksum = context;
-    *checksum = msg[2] | (msg[3] << 8) | (msg[4] << 16);
+    *checksum = dec.t6.config_crc;
 
     return MXT_SUCCESS;
   }
@@ -31,7 +31,9 @@
 int t44_t144_get_msg_count(struct mxt_device *mxt, int *count);
 char *t44_get_msg_string(struct mxt_device *mxt);
 int t44_get_msg_bytes(struct mxt_device *mxt, unsigned char *buf, size_t buflen, int *count);
+int t44_get_msgs_batch(struct mxt_device *mxt, struct mxt_msg *msgs, int max_msgs, int *count);
 int t44_t144_msg_reset(struct mxt_device *mxt);
+int mxt_read_messages_ms(struct mxt_device *mxt, int timeout_ms, void *context, int (*msg_func)(struct mxt_device *mxt, uint8_t *msg, void *context, uint8_t size), int *flag);
 int mxt_read_messages(struct mxt_device *mxt, int timeout_seconds, void *context, int (*msg_func)(struct mxt_device *mxt, uint8_t *msg, void *context, uint8_t size), int *flag);
 int mxt_get_calibrate_msgs(struct mxt_device *mxt, int timeout, int *state);
 int mxt_flush_msgs(struct mxt_device *mxt);
@@ -0,0 +1,199 @@
+//------------------------------------------------------------------------------
+/// \file   msg_decode.c
+/// \brief  Decoding of T5 messages into typed records
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libmaxtouch.h"
+#include "info_block.h"
+#include "msg_decode.h"
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+//******************************************************************************
+/// \brief Decode a T6 command processor status message
+/// \return #mxt_rc
+static int mxt_decode_t6(const struct mxt_report_id_map *map,
+                         const uint8_t *msg, uint8_t size,
+                         struct mxt_decoded_msg *out)
+{
+  /* T6 has a single report ID, but the decoder signature is shared */
+  (void)map;
+
+  if (size < MXT_T6_MSG_MIN_SIZE)
+    return MXT_ERROR_NO_MESSAGE;
+
+  out->kind = MXT_MSG_T6_STATUS;
+  out->t6.status = msg[1];
+  out->t6.config_crc = msg[2] | (msg[3] << 8) | ((uint32_t)msg[4] << 16);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Decode a T9 touch message, each report ID is one touch
+/// \return #mxt_rc
+static int mxt_decode_t9(const struct mxt_report_id_map *map,
+                         const uint8_t *msg, uint8_t size,
+                         struct mxt_decoded_msg *out)
+{
+  if (size < MXT_T9_MSG_MIN_SIZE)
+    return MXT_ERROR_NO_MESSAGE;
+
+  out->kind = MXT_MSG_TOUCH;
+  out->touch.id = map->report_index;
+  out->touch.status = msg[1];
+  out->touch.detect = (msg[1] & MXT_T9_DETECT) != 0;
+  out->touch.type = 0;
+  out->touch.x = (msg[2] << 4) | (msg[4] >> 4);
+  out->touch.y = (msg[3] << 4) | (msg[4] & 0x0F);
+  out->touch.aux = msg + 5;
+  out->touch.aux_size = size - 5;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Decode a T100 message, either screen status or one touch
+/// \return #mxt_rc
+static int mxt_decode_t100(const struct mxt_report_id_map *map,
+                           const uint8_t *msg, uint8_t size,
+                           struct mxt_decoded_msg *out)
+{
+  if (map->report_index < MXT_T100_FIRST_TOUCH_REPORT) {
+    if (size < 2)
+      return MXT_ERROR_NO_MESSAGE;
+
+    out->kind = (map->report_index == 0) ? MXT_MSG_T100_SCREEN : MXT_MSG_RAW;
+    out->t100_screen_status = msg[1];
+    return MXT_SUCCESS;
+  }
+
+  if (size < MXT_T100_MSG_MIN_SIZE)
+    return MXT_ERROR_NO_MESSAGE;
+
+  out->kind = MXT_MSG_TOUCH;
+  out->touch.id = map->report_index - MXT_T100_FIRST_TOUCH_REPORT;
+  out->touch.detect = (msg[1] & MXT_T100_DETECT) != 0;
+  out->touch.type = (msg[1] & MXT_T100_TYPE_MASK) >> MXT_T100_TYPE_SHIFT;
+  out->touch.status = msg[1] & MXT_T100_EVENT_MASK;
+  out->touch.x = msg[2] | (msg[3] << 8);
+  out->touch.y = msg[4] | (msg[5] << 8);
+  out->touch.aux = msg + 6;
+  out->touch.aux_size = size - 6;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Get the decoder for messages from an object type
+/// \return Decoder, or NULL if messages are only available raw
+mxt_msg_decoder mxt_msg_decoder_for_type(uint16_t object_type)
+{
+  switch (object_type) {
+  case GEN_COMMANDPROCESSOR_T6:
+    return mxt_decode_t6;
+  case TOUCH_MULTITOUCHSCREEN_T9:
+    return mxt_decode_t9;
+  case TOUCH_MULTITOUCHSCREEN_T100:
+    return mxt_decode_t100;
+  default:
+    return NULL;
+  }
+}
+
+//******************************************************************************
+/// \brief  Look up the object, instance and decoder for a report ID
+/// \return Table entry, or NULL for a report ID which is not in use
+const struct mxt_report_id_map *mxt_report_id_lookup(struct mxt_device *mxt,
+                                                     uint8_t report_id)
+{
+  if (report_id == 0 || report_id >= mxt->info.max_report_id)
+    return NULL;
+
+  return &mxt->report_id_map[report_id];
+}
+
+//******************************************************************************
+/// \brief  Decode a message through the report ID table
+/// \note   Nothing is formatted or copied, out->data points at msg
+/// \return #mxt_rc, MXT_ERROR_NO_MESSAGE for an unknown report ID or a message
+///         too short for its object
+int mxt_decode_msg(struct mxt_device *mxt, const uint8_t *msg, uint8_t size,
+                   struct mxt_decoded_msg *out)
+{
+  const struct mxt_report_id_map *map;
+
+  if (size < 1)
+    return MXT_ERROR_NO_MESSAGE;
+
+  map = mxt_report_id_lookup(mxt, msg[0]);
+  if (!map)
+    return MXT_ERROR_NO_MESSAGE;
+
+  out->object_type = map->object_type;
+  out->instance = map->instance;
+  out->report_index = map->report_index;
+  out->kind = MXT_MSG_RAW;
+  out->data = msg;
+  out->size = size;
+
+  if (!map->decode)
+    return MXT_SUCCESS;
+
+  return map->decode(map, msg, size, out);
+}
+
+//******************************************************************************
+/// \brief  Format a message as MSG_PREFIX followed by space separated hex
+/// \return Length of string, truncated to fit buflen
+size_t mxt_format_msg_hex(char *buf, size_t buflen, const uint8_t *msg,
+                          size_t size)
+{
+  size_t len = sizeof(MSG_PREFIX) - 1;
+  size_t i;
+
+  if (buflen < len + 1) {
+    if (buflen)
+      buf[0] = '\0';
+    return 0;
+  }
+
+  memcpy(buf, MSG_PREFIX, len);
+
+  for (i = 0; i < size && len + 3 < buflen; i++) {
+    buf[len++] = hex_digits[msg[i] >> 4];
+    buf[len++] = hex_digits[msg[i] & 0x0F];
+    buf[len++] = ' ';
+  }
+
+  buf[len] = '\0';
+
+  return len;
+}
@@ -0,0 +1,121 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   msg_decode.h
+/// \brief  Decoding of T5 messages into typed records
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* T6 status bits */
+#define MXT_T6_STATUS_COMSERR   0x04
+#define MXT_T6_STATUS_CFGERR    0x08
+#define MXT_T6_STATUS_CAL       0x10
+#define MXT_T6_STATUS_SIGERR    0x20
+#define MXT_T6_STATUS_OFL       0x40
+#define MXT_T6_STATUS_RESET     0x80
+
+/* T9 touch status bits */
+#define MXT_T9_DETECT           0x80
+#define MXT_T9_PRESS            0x40
+#define MXT_T9_RELEASE          0x20
+#define MXT_T9_MOVE             0x10
+#define MXT_T9_SUPPRESS         0x02
+
+/* T100 touch status byte */
+#define MXT_T100_DETECT         0x80
+#define MXT_T100_TYPE_MASK      0x70
+#define MXT_T100_TYPE_SHIFT     4
+#define MXT_T100_EVENT_MASK     0x0F
+
+/* T100 report IDs before the first touch: screen status, reserved */
+#define MXT_T100_FIRST_TOUCH_REPORT  2
+
+/* Message size needed for the bytes each decoder reads */
+#define MXT_T6_MSG_MIN_SIZE     5
+#define MXT_T9_MSG_MIN_SIZE     7
+#define MXT_T100_MSG_MIN_SIZE   6
+
+//******************************************************************************
+/// \brief Kind of record a message was decoded into
+enum mxt_msg_kind {
+  MXT_MSG_RAW,          /*!< No decoder for the object, only data is valid */
+  MXT_MSG_T6_STATUS,    /*!< Command processor status */
+  MXT_MSG_TOUCH,        /*!< T9 or T100 touch */
+  MXT_MSG_T100_SCREEN,  /*!< T100 screen status */
+};
+
+//******************************************************************************
+/// \brief T6 command processor status
+struct mxt_t6_status {
+  uint8_t status;
+  uint32_t config_crc;
+};
+
+//******************************************************************************
+/// \brief One touch from T9 or T100
+/// \note  T9 coordinates are given at 12 bit resolution, they must be
+///        shifted right by two when the configured range is 10 bit
+struct mxt_touch {
+  uint8_t id;
+  bool detect;
+  uint8_t status;   /*!< T9 status bits, or T100 event */
+  uint8_t type;     /*!< T100 touch type, zero for T9 */
+  uint16_t x;
+  uint16_t y;
+  const uint8_t *aux;  /*!< Auxiliary data following the position */
+  uint8_t aux_size;
+};
+
+//******************************************************************************
+/// \brief Decoded message
+struct mxt_decoded_msg {
+  uint16_t object_type;
+  uint8_t instance;
+  uint8_t report_index;   /*!< Report ID relative to the instance's first */
+  enum mxt_msg_kind kind;
+  const uint8_t *data;    /*!< Raw message, report ID first */
+  uint8_t size;
+
+  union {
+    struct mxt_t6_status t6;
+    struct mxt_touch touch;
+    uint8_t t100_screen_status;
+  };
+};
+
+struct mxt_device;
+struct mxt_report_id_map;
+
+typedef int (*mxt_msg_decoder)(const struct mxt_report_id_map *map,
+                               const uint8_t *msg, uint8_t size,
+                               struct mxt_decoded_msg *out);
+
+mxt_msg_decoder mxt_msg_decoder_for_type(uint16_t object_type);
+const struct mxt_report_id_map *mxt_report_id_lookup(struct mxt_device *mxt, uint8_t report_id);
+int mxt_decode_msg(struct mxt_device *mxt, const uint8_t *msg, uint8_t size, struct mxt_decoded_msg *out);
+size_t mxt_format_msg_hex(char *buf, size_t buflen, const uint8_t *msg, size_t size);
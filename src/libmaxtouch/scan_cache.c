@@ -0,0 +1,398 @@
+//------------------------------------------------------------------------------
+/// \file   scan_cache.c
+/// \brief  Cache of the scanned device and its information block
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <unistd.h>
+#include <limits.h>
+
+#include "libmaxtouch.h"
+#include "info_block.h"
+#include "scan_cache.h"
+
+#define SCAN_CACHE_HEADER "MXT_SCAN_CACHE 1"
+
+/* Largest information block, 255 objects */
+#define SCAN_CACHE_INFO_MAX (sizeof(struct mxt_id_info) \
+                             + 255 * sizeof(struct mxt_object) \
+                             + sizeof(struct mxt_raw_crc))
+
+#define SCAN_CACHE_LINE_MAX (2 * SCAN_CACHE_INFO_MAX + 16)
+
+//******************************************************************************
+/// \brief Device string identifying a connection, in the format of -d
+/// \return #mxt_rc
+static int mxt_scan_cache_device(struct mxt_conn_info *conn, char *buf,
+                                 size_t len)
+{
+  switch (conn->type) {
+  case E_SYSFS_I2C:
+  case E_SYSFS_SPI:
+    if (!conn->sysfs.path)
+      return MXT_ERROR_NOT_SUPPORTED;
+
+    snprintf(buf, len, "sysfs:%s", conn->sysfs.path);
+    return MXT_SUCCESS;
+
+  case E_I2C_DEV:
+    snprintf(buf, len, "i2c-dev:%d-%02x", conn->i2c_dev.adapter,
+             conn->i2c_dev.address);
+    return MXT_SUCCESS;
+
+#ifdef HAVE_LIBUSB
+  case E_USB:
+    snprintf(buf, len, "usb:%03d-%03d-%x", conn->usb.bus, conn->usb.device,
+             conn->usb.b_i2c_addr);
+    return MXT_SUCCESS;
+#endif /* HAVE_LIBUSB */
+
+  case E_HIDRAW:
+    snprintf(buf, len, "hidraw:%s", conn->hidraw.node);
+    return MXT_SUCCESS;
+
+  case E_MOCK:
+    snprintf(buf, len, "mock:%s", conn->mock.info_file);
+    return MXT_SUCCESS;
+
+  default:
+    return MXT_ERROR_NOT_SUPPORTED;
+  }
+}
+
+//******************************************************************************
+/// \brief Parse a hex string
+/// \return Number of bytes, or zero on a parse error
+static size_t mxt_scan_cache_parse_hex(const char *s, uint8_t *buf, size_t max)
+{
+  size_t count = 0;
+  int n;
+
+  while (*s && *s != '\n') {
+    if (count == max || sscanf(s, "%2hhx%n", &buf[count], &n) != 1 || n != 2)
+      return 0;
+
+    s += 2;
+    count++;
+  }
+
+  return count;
+}
+
+//******************************************************************************
+/// \brief Load cache file into context, if not already loaded
+/// \return #mxt_rc
+static int mxt_scan_cache_load(struct libmaxtouch_ctx *ctx)
+{
+  struct mxt_scan_cache *cache;
+  char *line;
+  FILE *fp;
+  size_t crc_size;
+  uint32_t crc, stored_crc;
+  int ret = MXT_ERROR_FILE_FORMAT;
+
+  if (ctx->scan_cache)
+    return MXT_SUCCESS;
+
+  fp = fopen(ctx->scan_cache_file, "r");
+  if (!fp) {
+    mxt_dbg(ctx, "No scan cache %s", ctx->scan_cache_file);
+    return mxt_errno_to_rc(errno);
+  }
+
+  cache = calloc(1, sizeof(struct mxt_scan_cache));
+  line = malloc(SCAN_CACHE_LINE_MAX);
+  if (cache)
+    cache->info = malloc(SCAN_CACHE_INFO_MAX);
+
+  if (!cache || !line || !cache->info) {
+    ret = MXT_ERROR_NO_MEM;
+    goto free;
+  }
+
+  if (!fgets(line, SCAN_CACHE_LINE_MAX, fp)
+      || strncmp(line, SCAN_CACHE_HEADER, strlen(SCAN_CACHE_HEADER)))
+    goto free;
+
+  while (fgets(line, SCAN_CACHE_LINE_MAX, fp)) {
+    line[strcspn(line, "\n")] = '\0';
+
+    if (!strncmp(line, "device=", 7)) {
+      free(cache->device);
+      cache->device = strdup(line + 7);
+    } else if (!strncmp(line, "acpi=", 5)) {
+      cache->acpi = (line[5] == '1');
+    } else if (!strncmp(line, "spi=", 4)) {
+      cache->spi = (line[4] == '1');
+    } else if (!strncmp(line, "info=", 5)) {
+      cache->info_size = mxt_scan_cache_parse_hex(line + 5, cache->info,
+                                                  SCAN_CACHE_INFO_MAX);
+    }
+  }
+
+  if (!cache->device || cache->info_size < sizeof(struct mxt_id_info))
+    goto free;
+
+  /* Stored blocks were verified, so a mismatch means a damaged file */
+  crc_size = cache->info_size - sizeof(struct mxt_raw_crc);
+  stored_crc = cache->info[crc_size] | (cache->info[crc_size + 1] << 8)
+               | (cache->info[crc_size + 2] << 16);
+
+  if (mxt_calculate_crc(ctx, &crc, cache->info, crc_size) || crc != stored_crc)
+    goto free;
+
+  ctx->scan_cache = cache;
+  cache = NULL;
+  ret = MXT_SUCCESS;
+
+free:
+  if (ret == MXT_ERROR_FILE_FORMAT)
+    mxt_warn(ctx, "Ignoring invalid scan cache %s", ctx->scan_cache_file);
+
+  if (cache) {
+    free(cache->device);
+    free(cache->info);
+    free(cache);
+  }
+
+  free(line);
+  fclose(fp);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Get the connection found by a previous scan, skipping enumeration.
+///        Only transports which mxt_scan() itself finds are returned.
+/// \return #mxt_rc
+int mxt_scan_cache_conn(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conn)
+{
+  struct mxt_scan_cache *cache;
+  struct mxt_conn_info *c = NULL;
+  const char *path;
+  int ret;
+
+  ret = mxt_scan_cache_load(ctx);
+  if (ret)
+    return ret;
+
+  cache = ctx->scan_cache;
+
+  if (!strncmp(cache->device, "sysfs:", 6)) {
+    path = cache->device + 6;
+
+    /* The driver must still be bound at the same place */
+    if (access(path, F_OK)) {
+      mxt_dbg(ctx, "Cached device %s has gone", path);
+      return MXT_ERROR_NO_DEVICE;
+    }
+
+    ret = mxt_new_conn(&c, cache->spi ? E_SYSFS_SPI : E_SYSFS_I2C);
+    if (ret)
+      return ret;
+
+    c->sysfs.path = strdup(path);
+    c->sysfs.acpi = cache->acpi;
+    if (!c->sysfs.path) {
+      mxt_unref_conn(c);
+      return MXT_ERROR_NO_MEM;
+    }
+  }
+#ifdef HAVE_LIBUSB
+  else if (!strncmp(cache->device, "usb:", 4)) {
+    ret = mxt_new_conn(&c, E_USB);
+    if (ret)
+      return ret;
+
+    if (sscanf(cache->device, "usb:%d-%d-%x", &c->usb.bus, &c->usb.device,
+               &c->usb.b_i2c_addr) != 3) {
+      mxt_unref_conn(c);
+      return MXT_ERROR_FILE_FORMAT;
+    }
+  }
+#endif /* HAVE_LIBUSB */
+  else {
+    return MXT_ERROR_NOT_SUPPORTED;
+  }
+
+  mxt_dbg(ctx, "Using cached device %s", cache->device);
+
+  *conn = c;
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Copy out the cached information block with the context lock held
+/// \return #mxt_rc
+static int mxt_scan_cache_match(struct mxt_device *mxt,
+                                const struct mxt_id_info *id,
+                                uint8_t **info, size_t *info_size)
+{
+  struct mxt_scan_cache *cache;
+  char device[PATH_MAX];
+  size_t expected;
+  int ret;
+
+  ret = mxt_scan_cache_device(mxt->conn, device, sizeof(device));
+  if (ret)
+    return ret;
+
+  ret = mxt_scan_cache_load(mxt->ctx);
+  if (ret)
+    return ret;
+
+  cache = mxt->ctx->scan_cache;
+
+  expected = sizeof(struct mxt_id_info)
+             + id->num_objects * sizeof(struct mxt_object)
+             + sizeof(struct mxt_raw_crc);
+
+  if (strcmp(cache->device, device) || cache->info_size != expected
+      || memcmp(cache->info, id, sizeof(struct mxt_id_info))) {
+    mxt_dbg(mxt->ctx, "Scan cache does not match %s", device);
+    return MXT_ERROR_CHECKSUM_MISMATCH;
+  }
+
+  *info = malloc(cache->info_size);
+  if (!*info)
+    return MXT_ERROR_NO_MEM;
+
+  memcpy(*info, cache->info, cache->info_size);
+  *info_size = cache->info_size;
+
+  mxt_dbg(mxt->ctx, "Using cached information block for %s", device);
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Get a copy of the cached information block, if it was stored for
+///        this connection and its ID information matches
+/// \param  id  ID information just read from the device
+/// \return #mxt_rc
+int mxt_scan_cache_info(struct mxt_device *mxt, const struct mxt_id_info *id,
+                        uint8_t **info, size_t *info_size)
+{
+  int ret;
+
+  pthread_mutex_lock(&mxt->ctx->lock);
+  ret = mxt_scan_cache_match(mxt, id, info, info_size);
+  pthread_mutex_unlock(&mxt->ctx->lock);
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Write the cache file with the context lock held
+static void mxt_scan_cache_write(struct mxt_device *mxt)
+{
+  char device[PATH_MAX];
+  char tmp_path[PATH_MAX + 8];
+  size_t info_size, i;
+  FILE *fp;
+
+  if (mxt_scan_cache_device(mxt->conn, device, sizeof(device)))
+    return;
+
+  info_size = sizeof(struct mxt_id_info)
+              + mxt->info.id->num_objects * sizeof(struct mxt_object)
+              + sizeof(struct mxt_raw_crc);
+
+  snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", mxt->ctx->scan_cache_file);
+
+  fp = fopen(tmp_path, "w");
+  if (!fp) {
+    mxt_warn(mxt->ctx, "Could not update scan cache %s: %s",
+             mxt->ctx->scan_cache_file, strerror(errno));
+    return;
+  }
+
+  fprintf(fp, SCAN_CACHE_HEADER "\n");
+  fprintf(fp, "device=%s\n", device);
+
+  if (mxt->conn->type == E_SYSFS_I2C || mxt->conn->type == E_SYSFS_SPI) {
+    fprintf(fp, "acpi=%d\n", mxt->conn->sysfs.acpi ? 1 : 0);
+    fprintf(fp, "spi=%d\n", mxt->conn->type == E_SYSFS_SPI ? 1 : 0);
+  }
+
+  fprintf(fp, "info=");
+  for (i = 0; i < info_size; i++)
+    fprintf(fp, "%02X", mxt->info.raw_info[i]);
+  fprintf(fp, "\n");
+
+  if (fclose(fp) || rename(tmp_path, mxt->ctx->scan_cache_file)) {
+    mxt_warn(mxt->ctx, "Could not update scan cache %s",
+             mxt->ctx->scan_cache_file);
+    unlink(tmp_path);
+    return;
+  }
+
+  /* Drop any stale copy so later lookups read the new one */
+  mxt_scan_cache_free(mxt->ctx);
+
+  mxt_dbg(mxt->ctx, "Cached %s in %s", device, mxt->ctx->scan_cache_file);
+}
+
+//******************************************************************************
+/// \brief Store the connection and information block of a device, replacing
+///        the file atomically so that readers never see a partial cache
+void mxt_scan_cache_store(struct mxt_device *mxt)
+{
+  pthread_mutex_lock(&mxt->ctx->lock);
+  mxt_scan_cache_write(mxt);
+  pthread_mutex_unlock(&mxt->ctx->lock);
+}
+
+//******************************************************************************
+/// \brief Remove the cache, after the cached device could not be used
+void mxt_scan_cache_invalidate(struct libmaxtouch_ctx *ctx)
+{
+  pthread_mutex_lock(&ctx->lock);
+
+  mxt_scan_cache_free(ctx);
+
+  if (ctx->scan_cache_file && unlink(ctx->scan_cache_file) && errno != ENOENT)
+    mxt_warn(ctx, "Could not remove scan cache %s: %s",
+             ctx->scan_cache_file, strerror(errno));
+
+  pthread_mutex_unlock(&ctx->lock);
+}
+
+//******************************************************************************
+/// \brief Release loaded cache
+void mxt_scan_cache_free(struct libmaxtouch_ctx *ctx)
+{
+  if (!ctx->scan_cache)
+    return;
+
+  free(ctx->scan_cache->device);
+  free(ctx->scan_cache->info);
+  free(ctx->scan_cache);
+  ctx->scan_cache = NULL;
+}
@@ -0,0 +1,54 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   scan_cache.h
+/// \brief  Cache of the scanned device and its information block
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct libmaxtouch_ctx;
+struct mxt_conn_info;
+struct mxt_device;
+struct mxt_id_info;
+
+//******************************************************************************
+/// \brief Device found by a previous scan, with its information block
+struct mxt_scan_cache {
+  char *device;
+  bool acpi;
+  bool spi;
+  uint8_t *info;
+  size_t info_size;
+};
+
+int mxt_scan_cache_conn(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conn);
+int mxt_scan_cache_info(struct mxt_device *mxt, const struct mxt_id_info *id,
+                        uint8_t **info, size_t *info_size);
+void mxt_scan_cache_store(struct mxt_device *mxt);
+void mxt_scan_cache_invalidate(struct libmaxtouch_ctx *ctx);
+void mxt_scan_cache_free(struct libmaxtouch_ctx *ctx);
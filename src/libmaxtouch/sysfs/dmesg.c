@@ -32,6 +32,8 @@
 #include <stdint.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/klog.h>
 
 #ifndef SYSLOG_ACTION_READ_ALL
@@ -45,6 +47,9 @@
 #define MAX_DMESG_COUNT       (500)
 #define MAX_DMESG_BUFSIZE     (10E6)
 
+/* One /dev/kmsg record, see Documentation/ABI/testing/dev-kmsg */
+#define KMSG_RECORD_SIZE      (8192)
+
 #include "libmaxtouch/log.h"
 #include "libmaxtouch/libmaxtouch.h"
 #include "sysfs_device.h"
@@ -52,150 +57,227 @@
 #include "dmesg.h"
 
 //******************************************************************************
-/// Define for size of message buffer
-#define BUFFERSIZE 256
+/// \brief  Decoded message in arena
+struct dmesg_msg {
+  uint8_t size;
+  uint8_t data[MXT_MSG_MAX_SIZE];
+};
 
 //******************************************************************************
-/// \brief  Linked list item structure
-struct dmesg_item {
-  unsigned long sec;
-  unsigned long msec;
-  char msg[BUFFERSIZE];
-  struct dmesg_item *next;
-};
+/// \brief  Decode hexadecimal character
+/// \return value 0-15, or -1 if not a hex digit
+static int dmesg_hex_nibble(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  else if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  else if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+
+  return -1;
+}
 
 //******************************************************************************
-/// \brief  Add new node to linked list of dmesg items
+/// \brief  Decode MXT MSG log text into next free arena slot
 /// \param  mxt  Maxtouch Device
-/// \param  sec  Seconds value of item
-/// \param  msec Milliseconds value of item
-/// \param  msg  Message string data
-static void dmesg_list_add(struct mxt_device *mxt, unsigned long sec,
-                           unsigned long msec, char *msg)
+/// \param  text Log line text, need not be null terminated
+/// \param  len  Length of text
+/// \return true if a message was stored
+static bool dmesg_add(struct mxt_device *mxt, const char *text, size_t len)
 {
-  // create new node
-  struct dmesg_item* new_node = (struct dmesg_item *)calloc(1, sizeof(struct dmesg_item));
+  const char *end = text + len;
+  const char *p;
+  struct dmesg_msg *msg;
+  int hi, lo;
+
+  if (mxt->sysfs.dmesg_count >= MAX_DMESG_COUNT)
+    return false;
+
+  p = memmem(text, len, MSG_PREFIX, strlen(MSG_PREFIX));
+  if (!p)
+    return false;
 
-  if (!new_node) return;
+  p += strlen(MSG_PREFIX);
 
-  strncpy(new_node->msg, msg, sizeof(new_node->msg));
-  new_node->msg[sizeof(new_node->msg) - 1] = '\0';
-  new_node->sec = sec;
-  new_node->msec = msec;
+  msg = &mxt->sysfs.dmesg_msgs[mxt->sysfs.dmesg_count];
+  msg->size = 0;
 
-  new_node->next = mxt->sysfs.dmesg_head;
-  mxt->sysfs.dmesg_head = new_node;
+  while (p < end && msg->size < MXT_MSG_MAX_SIZE) {
+    if (*p == ' ') {
+      p++;
+      continue;
+    }
+
+    if (p + 1 >= end)
+      break;
+
+    hi = dmesg_hex_nibble(p[0]);
+    lo = dmesg_hex_nibble(p[1]);
+    if (hi < 0 || lo < 0)
+      break;
+
+    msg->data[msg->size++] = (hi << 4) | lo;
+    p += 2;
+  }
+
+  if (msg->size == 0)
+    return false;
 
   mxt->sysfs.dmesg_count++;
+  return true;
 }
 
 //******************************************************************************
-/// \brief  Remove all items from the linked list
-/// \param  mxt  Maxtouch Device
-static void dmesg_list_empty(struct mxt_device *mxt)
+/// \brief  Read new records from /dev/kmsg
+/// \note   The fd position is kept between calls so only new records are
+///         parsed. Records beyond the arena size are left for the next call.
+/// \return #mxt_rc
+static int dmesg_read_kmsg(struct mxt_device *mxt)
 {
-  if (mxt->sysfs.dmesg_head == NULL)
-    return;
+  char *record = mxt->sysfs.debug_msg_buf;
+  const char *text;
+  ssize_t len;
+
+  while (mxt->sysfs.dmesg_count < MAX_DMESG_COUNT) {
+    len = read(mxt->sysfs.kmsg_fd, record, KMSG_RECORD_SIZE);
+    if (len < 0) {
+      if (errno == EAGAIN)
+        break;
 
-  // reset
-  struct dmesg_item *old_node = mxt->sysfs.dmesg_head;
-  mxt->sysfs.dmesg_head = NULL;
-  mxt->sysfs.dmesg_count = 0;
+      /* Records were overwritten before we read them, position has moved
+       * on to the oldest one still available */
+      if (errno == EPIPE || errno == EINTR)
+        continue;
 
-  // release memory
-  struct dmesg_item *next_node = NULL;
-  while (old_node->next != NULL) {
-    next_node = old_node->next;
-    free(old_node);
+      mxt_warn(mxt->ctx, "kmsg read error %d (%s)", errno, strerror(errno));
+      return mxt_errno_to_rc(errno);
+    } else if (len == 0) {
+      break;
+    }
 
-    old_node = next_node;
+    /* Header is "prio,seq,timestamp,flags;" followed by the text */
+    text = memchr(record, ';', len);
+    if (!text)
+      continue;
+
+    text++;
+    dmesg_add(mxt, text, len - (text - record));
   }
-  free(old_node);
 
-  return;
+  return MXT_SUCCESS;
 }
 
 //******************************************************************************
-/// \brief  Get messages
+/// \brief  Read kernel log buffer with klogctl, for kernels without /dev/kmsg
 /// \param  mxt  Maxtouch Device
-/// \param  count Number of messages available
 /// \param  init_timestamp Read newest dmesg line and initialise timestamp
 /// \return #mxt_rc
-int dmesg_get_msgs(struct mxt_device *mxt, int *count, bool init_timestamp)
+static int dmesg_read_klog(struct mxt_device *mxt, bool init_timestamp)
 {
-  char msg[BUFFERSIZE];
+  struct dmesg_msg tmp;
+  char *line;
   int ep, sp;
-  int ret = MXT_SUCCESS;
+  int i;
+  int offset;
   unsigned long sec, msec, lastsec = 0, lastmsec = 0;
 
   // Read entire kernel log buffer
   ep = klogctl(SYSLOG_ACTION_READ_ALL, mxt->sysfs.debug_msg_buf,
-               mxt->sysfs.debug_msg_buf_size);
-  // Return if no bytes read
+               mxt->sysfs.debug_msg_buf_size - 1);
   if (ep < 0) {
     mxt_warn(mxt->ctx, "klogctl error %d (%s)", errno, strerror(errno));
-    ret = mxt_errno_to_rc(errno);
-  } else {
-    // null terminate
-    mxt->sysfs.debug_msg_buf[ep] = 0;
-    sp = ep;
+    return mxt_errno_to_rc(errno);
+  }
 
-    if (!init_timestamp)
-      dmesg_list_empty(mxt);
+  // null terminate
+  mxt->sysfs.debug_msg_buf[ep] = 0;
+  sp = ep;
 
-    // Search for next new line character
-    while (true) {
+  // Search backwards for each new line character
+  while (true) {
+    sp--;
+    while (sp >= 0 && *(mxt->sysfs.debug_msg_buf + sp) != '\n')
       sp--;
-      while (sp >= 0 && *(mxt->sysfs.debug_msg_buf + sp) != '\n')
-        sp--;
 
-      if (sp <= 0)
-        break;
+    if (sp <= 0)
+      break;
+
+    line = mxt->sysfs.debug_msg_buf + sp + 1;
+
+    // Try to parse dmesg line
+    if (sscanf(line, "< %*c>[ %lu.%06lu]%n", &sec, &msec, &offset) != 2)
+      continue;
 
-      // Try to parse dmesg line
-      if (sscanf(mxt->sysfs.debug_msg_buf+sp+1, "< %*c>[ %lu.%06lu] %255[^\n]",
-                 &sec, &msec, msg) == 3) {
-        if (init_timestamp) {
-          mxt->sysfs.timestamp = sec;
-          mxt->sysfs.mtimestamp = msec;
-          mxt_verb(mxt->ctx, "%s - init [%5lu.%06lu]", __func__, sec, msec);
-          break;
-        }
-
-        // Store time of last message in buffer
-        if (lastsec == 0) {
-          lastsec = sec;
-          lastmsec = msec;
-        }
-
-        // Only 500 at a time, otherwise we overrun JNI reference limit.
-        // Timestamp must be greater than previous messages, slightly
-        // complicated by seconds and microseconds
-        if ((mxt->sysfs.dmesg_count > MAX_DMESG_COUNT) ||
-            (sec == mxt->sysfs.timestamp && msec <= mxt->sysfs.mtimestamp) ||
-            (sec < mxt->sysfs.timestamp)) {
-          mxt->sysfs.timestamp = lastsec;
-          mxt->sysfs.mtimestamp = lastmsec;
-          break;
-        }
-
-        char* msgptr;
-        msg[sizeof(msg) - 1] = '\0';
-        msgptr = strstr(msg, "MXT MSG");
-        if (msgptr)
-          dmesg_list_add(mxt, sec, msec, msgptr);
-      }
+    if (init_timestamp) {
+      mxt->sysfs.timestamp = sec;
+      mxt->sysfs.mtimestamp = msec;
+      mxt_verb(mxt->ctx, "%s - init [%5lu.%06lu]", __func__, sec, msec);
+      break;
+    }
+
+    // Store time of last message in buffer
+    if (lastsec == 0) {
+      lastsec = sec;
+      lastmsec = msec;
     }
 
-    if (!init_timestamp) {
-      *count = mxt->sysfs.dmesg_count;
-      mxt->sysfs.dmesg_ptr = mxt->sysfs.dmesg_head;
+    // Timestamp must be greater than previous messages, slightly
+    // complicated by seconds and microseconds
+    if ((mxt->sysfs.dmesg_count >= MAX_DMESG_COUNT) ||
+        (sec == mxt->sysfs.timestamp && msec <= mxt->sysfs.mtimestamp) ||
+        (sec < mxt->sysfs.timestamp)) {
+      break;
     }
+
+    line += offset;
+    dmesg_add(mxt, line, strcspn(line, "\n"));
   }
 
-  return ret;
+  if (!init_timestamp && lastsec) {
+    mxt->sysfs.timestamp = lastsec;
+    mxt->sysfs.mtimestamp = lastmsec;
+  }
+
+  // Messages were found newest first
+  for (i = 0; i < mxt->sysfs.dmesg_count / 2; i++) {
+    tmp = mxt->sysfs.dmesg_msgs[i];
+    mxt->sysfs.dmesg_msgs[i] = mxt->sysfs.dmesg_msgs[mxt->sysfs.dmesg_count - 1 - i];
+    mxt->sysfs.dmesg_msgs[mxt->sysfs.dmesg_count - 1 - i] = tmp;
+  }
+
+  return MXT_SUCCESS;
 }
 
+//******************************************************************************
+/// \brief  Get messages
+/// \param  mxt  Maxtouch Device
+/// \param  count Number of messages available
+/// \param  init_timestamp Read newest dmesg line and initialise timestamp
+/// \return #mxt_rc
+int dmesg_get_msgs(struct mxt_device *mxt, int *count, bool init_timestamp)
+{
+  int ret;
+
+  if (!mxt->sysfs.dmesg_msgs)
+    return MXT_ERROR_NO_MEM;
+
+  // Only 500 at a time, otherwise we overrun JNI reference limit
+  mxt->sysfs.dmesg_count = 0;
+  mxt->sysfs.dmesg_ptr = 0;
+
+  if (mxt->sysfs.kmsg_fd >= 0)
+    ret = dmesg_read_kmsg(mxt);
+  else
+    ret = dmesg_read_klog(mxt, init_timestamp);
+
+  if (init_timestamp)
+    mxt->sysfs.dmesg_count = 0;
+  else if (count)
+    *count = mxt->sysfs.dmesg_count;
+
+  return ret;
+}
 
 //******************************************************************************
 /// \brief  Update the timestamp from the klog messages
@@ -206,25 +288,40 @@ static int dmesg_update_timestamp(struct mxt_device *mxt)
   return dmesg_get_msgs(mxt, NULL, true);
 }
 
+//******************************************************************************
+/// \brief  Get next message from arena
+/// \return Message, or NULL if none left or the message is invalid
+static struct dmesg_msg *dmesg_next_msg(struct mxt_device *mxt)
+{
+  struct dmesg_msg *msg;
+
+  if (mxt->sysfs.dmesg_ptr >= mxt->sysfs.dmesg_count)
+    return NULL;
+
+  msg = &mxt->sysfs.dmesg_msgs[mxt->sysfs.dmesg_ptr++];
+
+  if (msg->data[0] == 0xff)
+    return NULL;
+
+  return msg;
+}
+
 //******************************************************************************
 /// \brief  Get the next debug message
 /// \param  mxt  Maxtouch Device
 /// \return Message string
 char *dmesg_get_msg_string(struct mxt_device *mxt)
 {
-  char *msg_string;
-
-  msg_string = mxt->sysfs.dmesg_ptr->msg;
+  struct dmesg_msg *msg;
 
-  if (mxt->sysfs.dmesg_ptr != NULL) {
-    // Get next record in linked list
-    mxt->sysfs.dmesg_ptr = mxt->sysfs.dmesg_ptr->next;
-  }
-
-  if (!strncasecmp("MXT MSG:FF", msg_string, 10))
+  msg = dmesg_next_msg(mxt);
+  if (!msg)
     return NULL;
 
-  return msg_string;
+  mxt_format_msg_hex(mxt->msg_string, sizeof(mxt->msg_string),
+                     msg->data, msg->size);
+
+  return &mxt->msg_string[0];
 }
 
 //******************************************************************************
@@ -237,32 +334,15 @@ char *dmesg_get_msg_string(struct mxt_device *mxt)
 int dmesg_get_msg_bytes(struct mxt_device *mxt, unsigned char *buf,
                         size_t buflen, int *count)
 {
-  unsigned int bufidx = 0;
-  int offset;
-  char *message;
-
-  message = dmesg_get_msg_string(mxt);
+  struct dmesg_msg *msg;
 
-  if (!message)
+  msg = dmesg_next_msg(mxt);
+  if (!msg)
     return MXT_ERROR_NO_MESSAGE;
 
-  /* Check message begins with prefix */
-  if (strncmp(MSG_PREFIX, message, strlen(MSG_PREFIX))) {
-    *count = 0;
-    return MXT_SUCCESS;
-  }
-
-  message += strlen(MSG_PREFIX);
+  *count = (msg->size < buflen) ? msg->size : buflen;
+  memcpy(buf, msg->data, *count);
 
-  while (1 == sscanf(message, "%hhx%n", buf + bufidx, &offset)) {
-    message += offset;
-    bufidx++;
-
-    if (bufidx >= buflen)
-      break;
-  }
-
-  *count = bufidx;
   return MXT_SUCCESS;
 }
 
@@ -270,48 +350,86 @@ int dmesg_get_msg_bytes(struct mxt_device *mxt, unsigned char *buf,
 /// \brief  Reset the timestamp counter
 int dmesg_reset(struct mxt_device *mxt)
 {
-  int ret;
+  mxt->sysfs.dmesg_count = 0;
+  mxt->sysfs.dmesg_ptr = 0;
+
+  /* Skip everything already logged */
+  if (mxt->sysfs.kmsg_fd >= 0) {
+    if (lseek(mxt->sysfs.kmsg_fd, 0, SEEK_END) < 0) {
+      mxt_err(mxt->ctx, "kmsg seek error %d (%s)", errno, strerror(errno));
+      return mxt_errno_to_rc(errno);
+    }
+
+    return MXT_SUCCESS;
+  }
 
-  mxt->sysfs.dmesg_head = NULL;
   mxt->sysfs.mtimestamp = 0;
   mxt->sysfs.timestamp  = 0;
-  ret = dmesg_update_timestamp(mxt);
 
-  return ret;
+  return dmesg_update_timestamp(mxt);
 }
 
 //******************************************************************************
-/// \brief Allocate kernel log buffer
+/// \brief Allocate kernel log buffer and message arena
 int dmesg_alloc_buffer(struct mxt_device *mxt)
 {
   int size;
 
-  size = klogctl(SYSLOG_ACTION_SIZE_BUFFER, NULL, 0);
-  if (size == -1) {
-    mxt_err(mxt->ctx, "klogctl error %d (%s)", errno, strerror(errno));
-    return mxt_errno_to_rc(errno);
-  }
+  dmesg_free_buffer(mxt);
+
+  mxt->sysfs.dmesg_msgs = (struct dmesg_msg *)calloc(MAX_DMESG_COUNT,
+                          sizeof(struct dmesg_msg));
+  if (!mxt->sysfs.dmesg_msgs)
+    return MXT_ERROR_NO_MEM;
 
-  if (size > MAX_DMESG_BUFSIZE)
-    size = MAX_DMESG_BUFSIZE;
+  /* Prefer /dev/kmsg, which returns one record per read from a position that
+   * is kept by the fd */
+  mxt->sysfs.kmsg_fd = open("/dev/kmsg", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+  if (mxt->sysfs.kmsg_fd >= 0) {
+    lseek(mxt->sysfs.kmsg_fd, 0, SEEK_END);
+    size = KMSG_RECORD_SIZE;
+  } else {
+    mxt_dbg(mxt->ctx, "/dev/kmsg unavailable (%s), using klogctl", strerror(errno));
+
+    size = klogctl(SYSLOG_ACTION_SIZE_BUFFER, NULL, 0);
+    if (size == -1) {
+      mxt_err(mxt->ctx, "klogctl error %d (%s)", errno, strerror(errno));
+      dmesg_free_buffer(mxt);
+      return mxt_errno_to_rc(errno);
+    }
+
+    if (size > MAX_DMESG_BUFSIZE)
+      size = MAX_DMESG_BUFSIZE;
+  }
 
   mxt_dbg(mxt->ctx, "sysfs.debug_msg_buf_size: %d bytes", size);
 
   // Allocate buffer space
-  mxt->sysfs.debug_msg_buf = (char *)calloc(size, sizeof(char));
+  mxt->sysfs.debug_msg_buf = (char *)calloc(size + 1, sizeof(char));
   if (mxt->sysfs.debug_msg_buf == NULL) {
     mxt_err(mxt->ctx, "Error allocating debug_msg_buf %d bytes", size);
-    return mxt_errno_to_rc(errno);
+    dmesg_free_buffer(mxt);
+    return MXT_ERROR_NO_MEM;
   }
 
-  mxt->sysfs.debug_msg_buf_size = size;
+  mxt->sysfs.debug_msg_buf_size = size + 1;
   return MXT_SUCCESS;
 }
 
 //******************************************************************************
-/// \brief Allocate kernel log buffer
+/// \brief Free kernel log buffer and message arena
 void dmesg_free_buffer(struct mxt_device *mxt)
 {
+  /* kmsg_fd is only valid once the arena has been allocated */
+  if (mxt->sysfs.dmesg_msgs && mxt->sysfs.kmsg_fd >= 0)
+    close(mxt->sysfs.kmsg_fd);
+
+  mxt->sysfs.kmsg_fd = -1;
+
   free(mxt->sysfs.debug_msg_buf);
   mxt->sysfs.debug_msg_buf = NULL;
+  free(mxt->sysfs.dmesg_msgs);
+  mxt->sysfs.dmesg_msgs = NULL;
+  mxt->sysfs.dmesg_count = 0;
+  mxt->sysfs.dmesg_ptr = 0;
 }
@@ -79,14 +79,89 @@ static int sysfs_open_notify_fd(struct mxt_device *mxt)
 }
 
 //******************************************************************************
-/// \brief Reopen sysfs MSG notify attribute
-static void sysfs_reopen_notify_fd(struct mxt_device *mxt)
+/// \brief Re-arm sysfs MSG notify attribute
+/// \note  sysfs only signals POLLPRI again once the attribute has been read
+///        back from the start, so there is no need to reopen it
+static void sysfs_rearm_notify_fd(struct mxt_device *mxt)
 {
   uint16_t val;
 
-  close(mxt->sysfs.debug_notify_fd);
-  sysfs_open_notify_fd(mxt);
-  read(mxt->sysfs.debug_notify_fd, &val, 2);
+  if (mxt->sysfs.debug_notify_fd < 0)
+    return;
+
+  if (pread(mxt->sysfs.debug_notify_fd, &val, 2, 0) < 0)
+    mxt_dbg(mxt->ctx, "debug_notify read error %s (%d)", strerror(errno), errno);
+}
+
+//******************************************************************************
+/// \brief Size of each T5 record in the debug_msg attribute
+static uint16_t sysfs_t5_record_size(struct mxt_device *mxt)
+{
+  if (mxt->mxt_crc.crc_enabled == true)
+    return mxt->obj_cache.t5_size;  // Must match Linux driver being used
+  else
+    return mxt->obj_cache.t5_size - 1;  //Size based on chip (non-CRC)
+}
+
+//******************************************************************************
+/// \brief Open sysfs debug_msg attribute and size the message buffer
+/// \note  The attribute size reported by the driver is its maximum message
+///        buffer, so the buffer only ever grows. The file descriptor is kept
+///        open for later polls unless the context has reopen_fd set
+/// \return #mxt_rc
+static int sysfs_open_debug_msg(struct mxt_device *mxt)
+{
+  char *filename;
+  struct stat filestat;
+  uint8_t *buf;
+  int fd;
+
+  if (mxt->sysfs.debug_msg_fd >= 0)
+    return MXT_SUCCESS;
+
+  filename = make_path(mxt, "debug_msg");
+
+  fd = open(filename, O_RDWR);
+  if (fd < 0) {
+    mxt_err(mxt->ctx, "Could not open %s, error %s (%d)", filename, strerror(errno), errno);
+    return mxt_errno_to_rc(errno);
+  }
+
+  if (fstat(fd, &filestat) < 0) {
+    mxt_err(mxt->ctx, "Could not stat %s, error %s (%d)",
+            filename, strerror(errno), errno);
+    close(fd);
+    return mxt_errno_to_rc(errno);
+  }
+
+  if ((size_t)filestat.st_size > mxt->sysfs.debug_v2_size) {
+    buf = realloc(mxt->sysfs.debug_v2_msg_buf, filestat.st_size);
+    if (!buf) {
+      close(fd);
+      return MXT_ERROR_NO_MEM;
+    }
+
+    mxt->sysfs.debug_v2_msg_buf = buf;
+    mxt->sysfs.debug_v2_size = filestat.st_size;
+    mxt_dbg(mxt->ctx, "debug_msg buffer %zu bytes", mxt->sysfs.debug_v2_size);
+  }
+
+  mxt->sysfs.debug_msg_fd = fd;
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Finish with debug_msg attribute after a poll
+static void sysfs_close_debug_msg(struct mxt_device *mxt, int ret)
+{
+  if (mxt->sysfs.debug_msg_fd < 0)
+    return;
+
+  if (!mxt->ctx->reopen_fd && ret == MXT_SUCCESS)
+    return;
+
+  close(mxt->sysfs.debug_msg_fd);
+  mxt->sysfs.debug_msg_fd = -1;
 }
 
 //******************************************************************************
@@ -123,6 +198,13 @@ int sysfs_get_debug_v2_fd(struct mxt_device *mxt)
   return mxt->sysfs.debug_notify_fd;
 }
 
+//******************************************************************************
+/// \brief Check for messages already read from debug_msg but not consumed
+bool sysfs_debug_v2_pending(struct mxt_device *mxt)
+{
+  return mxt->sysfs.debug_v2_msg_ptr < mxt->sysfs.debug_v2_msg_count;
+}
+
 //******************************************************************************
 /// \brief Check sysfs device directory for correct attributes
 /// \return #mxt_rc
@@ -340,6 +422,9 @@ int sysfs_open_i2c(struct mxt_device *mxt)
   struct stat filestat;
   int ret;
 
+  mxt->sysfs.debug_msg_fd = -1;
+  mxt->sysfs.debug_notify_fd = -1;
+
   mxt->sysfs.path_max = strlen(conn->path) + 20;
 
   // Allocate temporary path space
@@ -354,6 +439,7 @@ int sysfs_open_i2c(struct mxt_device *mxt)
 
   snprintf(mxt->sysfs.mem_access_path, mxt->sysfs.path_max,
            "%s/mem_access", conn->path);
+  mxt->sysfs.mem_access_fd = -1;
 
   // Check whether debug v2 or not
   filename = make_path(mxt, "debug_msg");
@@ -386,6 +472,9 @@ int sysfs_open_spi(struct mxt_device *mxt)
   struct stat filestat;
   int ret;
 
+  mxt->sysfs.debug_msg_fd = -1;
+  mxt->sysfs.debug_notify_fd = -1;
+
   mxt->sysfs.path_max = strlen(conn->path) + 20;
 
   // Allocate temporary path space
@@ -400,6 +489,7 @@ int sysfs_open_spi(struct mxt_device *mxt)
 
   snprintf(mxt->sysfs.mem_access_path, mxt->sysfs.path_max,
            "%s/mem_access", conn->path);
+  mxt->sysfs.mem_access_fd = -1;
 
   // Check whether debug v2 or not
   filename = make_path(mxt, "debug_msg");
@@ -427,16 +517,34 @@ int sysfs_open_spi(struct mxt_device *mxt)
 void sysfs_release(struct mxt_device *mxt)
 {
   if (mxt) {
+    if (mxt->sysfs.mem_access_fd >= 0) {
+      close(mxt->sysfs.mem_access_fd);
+      mxt->sysfs.mem_access_fd = -1;
+    }
+
+    if (mxt->sysfs.debug_msg_fd >= 0) {
+      close(mxt->sysfs.debug_msg_fd);
+      mxt->sysfs.debug_msg_fd = -1;
+    }
+
+    if (mxt->sysfs.debug_notify_fd >= 0) {
+      close(mxt->sysfs.debug_notify_fd);
+      mxt->sysfs.debug_notify_fd = -1;
+    }
+
     free(mxt->sysfs.temp_path);
     mxt->sysfs.temp_path = NULL;
 
     free(mxt->sysfs.debug_v2_msg_buf);
     mxt->sysfs.debug_v2_msg_buf = NULL;
+    mxt->sysfs.debug_v2_size = 0;
   }
 }
 
 //******************************************************************************
 /// \brief Open memory access file
+/// \note  The file descriptor is kept open for later transfers unless the
+///        context has reopen_fd set
 /// \return #mxt_rc
 static int open_device_file(struct mxt_device *mxt, int *fd_out)
 {
@@ -448,19 +556,41 @@ static int open_device_file(struct mxt_device *mxt, int *fd_out)
     return MXT_ERROR_NO_DEVICE;
   }
 
+  if (mxt->sysfs.mem_access_fd >= 0) {
+    *fd_out = mxt->sysfs.mem_access_fd;
+    return MXT_SUCCESS;
+  }
+
   fd = open(mxt->sysfs.mem_access_path, O_RDWR);
 
   if (fd < 0) {
     mxt_err(mxt->ctx, "Could not open %s, error %s (%d)",
             mxt->sysfs.mem_access_path, strerror(errno), errno);
-
     return mxt_errno_to_rc(errno);
   }
 
+  if (!mxt->ctx->reopen_fd)
+    mxt->sysfs.mem_access_fd = fd;
+
   *fd_out = fd;
   return MXT_SUCCESS;
 }
 
+//******************************************************************************
+/// \brief Finish with memory access file after a transfer
+/// \note  Closes it if reopen_fd is set or the transfer failed, so that the
+///        next transfer starts with a fresh open
+static void close_device_file(struct mxt_device *mxt, int fd, int ret)
+{
+  if (!mxt->ctx->reopen_fd && ret == MXT_SUCCESS)
+    return;
+
+  close(fd);
+
+  if (mxt->sysfs.mem_access_fd == fd)
+    mxt->sysfs.mem_access_fd = -1;
+}
+
 //******************************************************************************
 /// \brief  sysfs bootloader read from MXT chip
 /// \return #mxt_rc
@@ -512,13 +642,14 @@ int sysfs_read_register(struct mxt_device *mxt, unsigned char *buf,
   if (ret)
     return ret;
 
-if ((start_register & 0xffff) != 0x0000) {
-  if (lseek(fd, start_register, 0) < 0) {
-    mxt_err(mxt->ctx, "lseek error %s (%d)", strerror(errno), errno);
-    ret = mxt_errno_to_rc(errno);
-    goto close;
+  /* Cached descriptor may be left at any offset by the previous transfer */
+  if ((start_register & 0xffff) != 0x0000 || mxt->sysfs.mem_access_fd == fd) {
+    if (lseek(fd, start_register, 0) < 0) {
+      mxt_err(mxt->ctx, "lseek error %s (%d)", strerror(errno), errno);
+      ret = mxt_errno_to_rc(errno);
+      goto close;
+    }
   }
-}
 
   *bytes_read = 0;
   while (*bytes_read < count) {
@@ -538,7 +669,7 @@ if ((start_register & 0xffff) != 0x0000) {
   ret = MXT_SUCCESS;
 
 close:
-  close(fd);
+  close_device_file(mxt, fd, ret);
   return ret;
 }
 
@@ -580,7 +711,7 @@ int sysfs_write_register(struct mxt_device *mxt, unsigned char const *buf,
   ret = MXT_SUCCESS;
 
 close:
-  close(fd);
+  close_device_file(mxt, fd, ret);
 
   return ret;
 }
@@ -770,11 +901,14 @@ int sysfs_set_debug(struct mxt_device *mxt, bool debug_state)
       ret = write_boolean_file(mxt, make_path(mxt, "debug_enable"), debug_state);
 
     if (debug_state) {
-      ret = sysfs_open_notify_fd(mxt);
-      if (ret)
-        return ret;
-    } else {
+      if (mxt->sysfs.debug_notify_fd < 0) {
+        ret = sysfs_open_notify_fd(mxt);
+        if (ret)
+          return ret;
+      }
+    } else if (mxt->sysfs.debug_notify_fd >= 0) {
       close(mxt->sysfs.debug_notify_fd);
+      mxt->sysfs.debug_notify_fd = -1;
     }
   } else {
     if (debug_state) {
@@ -817,23 +951,17 @@ int sysfs_set_debug_irq(struct mxt_device *mxt, bool debug_state)
 /// \return C string or NULL
 char *sysfs_get_msg_string_v2(struct mxt_device *mxt)
 {
-  int ret, i;
+  int ret;
   int size;
-  size_t length;
   unsigned char databuf[20];
-  static char msg_string[255];
 
   ret = sysfs_get_msg_bytes_v2(mxt, &databuf[0], sizeof(databuf), &size);
   if (ret)
     return NULL;
 
-  length = snprintf(msg_string, sizeof(msg_string), "MXT MSG:");
-  for (i = 0; i < size; i++) {
-    length += snprintf(msg_string + length, sizeof(msg_string) - length,
-                       "%02X ", databuf[i]);
-  }
+  mxt_format_msg_hex(mxt->msg_string, sizeof(mxt->msg_string), databuf, size);
 
-  return &msg_string[0];
+  return &mxt->msg_string[0];
 }
 
 //******************************************************************************
@@ -848,19 +976,13 @@ int sysfs_get_msg_bytes_v2(struct mxt_device *mxt, unsigned char *buf,
 {
   uint16_t t5_size;
 
-  if (!mxt->sysfs.debug_v2_msg_buf) //If nothing in buffer, return error
-    return MXT_INTERNAL_ERROR;
-
-  if (mxt->mxt_crc.crc_enabled == true)
-    t5_size = mxt_get_object_size(mxt, GEN_MESSAGEPROCESSOR_T5);  //Must match Linux driver
-  else 
-    t5_size = mxt_get_object_size(mxt, GEN_MESSAGEPROCESSOR_T5) - 1;
+  t5_size = sysfs_t5_record_size(mxt);
 
   if (buflen < t5_size)
     return MXT_ERROR_NO_MEM;
 
-  if (mxt->sysfs.debug_v2_msg_ptr > mxt->sysfs.debug_v2_msg_count)
-    return MXT_INTERNAL_ERROR;
+  if (mxt->sysfs.debug_v2_msg_ptr >= mxt->sysfs.debug_v2_msg_count)
+    return MXT_ERROR_NO_MESSAGE;
 
   memcpy(buf,
          mxt->sysfs.debug_v2_msg_buf + mxt->sysfs.debug_v2_msg_ptr * t5_size,
@@ -873,18 +995,45 @@ int sysfs_get_msg_bytes_v2(struct mxt_device *mxt, unsigned char *buf,
   return MXT_SUCCESS;
 }
 
+//******************************************************************************
+/// \brief Get remaining debug messages in place (V2 interface)
+/// \note  The records point into the message buffer, which stays valid
+///        until the next call to sysfs_get_msgs_v2(). They are consumed by
+///        this call.
+/// \param  mxt Device context
+/// \param  records Set to first unread record
+/// \param  record_size Size of each record in bytes
+/// \param  count Number of records
+/// \return #mxt_rc
+int sysfs_get_msgs_view_v2(struct mxt_device *mxt, uint8_t **records,
+                           int *record_size, int *count)
+{
+  uint16_t t5_size = sysfs_t5_record_size(mxt);
+
+  *record_size = t5_size;
+  *count = mxt->sysfs.debug_v2_msg_count - mxt->sysfs.debug_v2_msg_ptr;
+
+  if (*count <= 0) {
+    *count = 0;
+    *records = NULL;
+    return MXT_SUCCESS;
+  }
+
+  *records = mxt->sysfs.debug_v2_msg_buf + mxt->sysfs.debug_v2_msg_ptr * t5_size;
+  mxt->sysfs.debug_v2_msg_ptr = mxt->sysfs.debug_v2_msg_count;
+
+  return MXT_SUCCESS;
+}
+
 //******************************************************************************
 /// \brief Reset debug messages
 /// \param  mxt Device context
 int sysfs_msg_reset_v2(struct mxt_device *mxt)
 {
-  free(mxt->sysfs.debug_v2_msg_buf);
-  mxt->sysfs.debug_v2_msg_buf = NULL;
-  
+  mxt->sysfs.debug_v2_msg_count = 0;
+  mxt->sysfs.debug_v2_msg_ptr = 0;
+
   usleep(100000);   /* delay to get rid of messages */
-  
-  if (mxt->sysfs.debug_v2_msg_buf != NULL)
-    free(mxt->sysfs.debug_v2_msg_buf);
 
   return 0;
 }
@@ -904,46 +1053,27 @@ bool sysfs_has_debug_v2(struct mxt_device *mxt)
 /// \return #mxt_rc
 int sysfs_get_msgs_v2(struct mxt_device *mxt, int *count)
 {
-  int num_bytes;
+  ssize_t num_bytes;
   uint16_t t5_size;
-  char *filename;
-  struct stat filestat;
   int ret;
-  int fd;
-
-  sysfs_reopen_notify_fd(mxt);
-
-  filename = make_path(mxt, "debug_msg");
-
-  ret = stat(filename, &filestat);
-  if (ret < 0) {
-    mxt_err(mxt->ctx, "Could not stat %s, error %s (%d)",
-            filename, strerror(errno), errno);
-    return mxt_errno_to_rc(errno);
-  }
 
-  mxt->sysfs.debug_v2_size = filestat.st_size;
+  sysfs_rearm_notify_fd(mxt);
 
-  if (mxt->sysfs.debug_v2_msg_buf) {
-    free(mxt->sysfs.debug_v2_msg_buf);
-    mxt->sysfs.debug_v2_msg_buf = NULL;
-  }
+  mxt->sysfs.debug_v2_msg_count = 0;
+  mxt->sysfs.debug_v2_msg_ptr = 0;
 
-  mxt->sysfs.debug_v2_msg_buf = calloc(mxt->sysfs.debug_v2_size, sizeof(uint8_t));
+  ret = sysfs_open_debug_msg(mxt);
+  if (ret)
+    return ret;
 
-  fd = open(filename, O_RDWR);
-  if (fd < 0) {
-    mxt_err(mxt->ctx, "Could not open %s, error %s (%d)", filename, strerror(errno), errno);
-    ret = mxt_errno_to_rc(errno);
+  t5_size = sysfs_t5_record_size(mxt);
+  if (t5_size == 0) {
+    ret = MXT_INTERNAL_ERROR;
     goto close;
   }
 
-  if (mxt->mxt_crc.crc_enabled == true)
-    t5_size = mxt_get_object_size(mxt, GEN_MESSAGEPROCESSOR_T5);  // Must match Linux driver being used
-   else 
-    t5_size = mxt_get_object_size(mxt, GEN_MESSAGEPROCESSOR_T5) - 1;  //Size based on chip (non-CRC)
-
-  num_bytes = read(fd, mxt->sysfs.debug_v2_msg_buf, mxt->sysfs.debug_v2_size);
+  num_bytes = pread(mxt->sysfs.debug_msg_fd, mxt->sysfs.debug_v2_msg_buf,
+                    mxt->sysfs.debug_v2_size, 0);
   if (num_bytes < 0) {
     mxt_err(mxt->ctx, "read error %s (%d)", strerror(errno), errno);
     ret = mxt_errno_to_rc(errno);
@@ -951,14 +1081,13 @@ int sysfs_get_msgs_v2(struct mxt_device *mxt, int *count)
   }
 
   mxt->sysfs.debug_v2_msg_count = num_bytes / t5_size;
-  mxt->sysfs.debug_v2_msg_ptr = 0;
 
   ret = MXT_SUCCESS;
   *count = mxt->sysfs.debug_v2_msg_count;
   mxt_verb(mxt->ctx, "msg_count = %d", mxt->sysfs.debug_v2_msg_count);
 
 close:
-  close(fd);
+  sysfs_close_debug_msg(mxt, ret);
   return ret;
 }
 
@@ -28,7 +28,7 @@
 // EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //------------------------------------------------------------------------------
 
-struct dmesg_item;
+struct dmesg_msg;
 
 //******************************************************************************
 /// \brief sysfs device connection information
@@ -48,12 +48,14 @@ struct sysfs_conn_info {
 struct sysfs_device {
   struct sysfs_conn_info conn;
   char *mem_access_path;
+  int mem_access_fd;
   char *temp_path;
   size_t path_max;
   bool debug_v2;
   uint16_t debug_v2_msg_count;
   uint16_t debug_v2_msg_ptr;
   uint8_t *debug_v2_msg_buf;
+  int debug_msg_fd;
   char *debug_msg_buf;
   int debug_msg_buf_size;
   int debug_notify_fd;
@@ -61,9 +63,10 @@ struct sysfs_device {
   bool b_i2c_device;
   bool b_spi_device;
 
+  int kmsg_fd;
   int dmesg_count;
-  struct dmesg_item *dmesg_head;
-  struct dmesg_item *dmesg_ptr;
+  int dmesg_ptr;
+  struct dmesg_msg *dmesg_msgs;
 
   unsigned long timestamp;
   unsigned long mtimestamp;
@@ -90,5 +93,7 @@ char *sysfs_get_msg_string_v2(struct mxt_device *mxt);
 int sysfs_get_msg_bytes_v2(struct mxt_device *mxt, unsigned char *buf, size_t buflen, int *count);
 int sysfs_get_msgs_v2(struct mxt_device *mxt, int *count);
 int sysfs_msg_reset_v2(struct mxt_device *mxt);
+int sysfs_get_msgs_view_v2(struct mxt_device *mxt, uint8_t **records, int *record_size, int *count);
 int sysfs_get_debug_v2_fd(struct mxt_device *mxt);
+bool sysfs_debug_v2_pending(struct mxt_device *mxt);
 int sysfs_get_i2c_address(struct libmaxtouch_ctx *ctx, struct mxt_conn_info *conn, int *adapter, int *address);
@@ -32,6 +32,10 @@
 #include <unistd.h>
 #include <inttypes.h>
 #include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <errno.h>
+#include <sys/time.h>
 
 #include "libmaxtouch/log.h"
 #include "libmaxtouch/libmaxtouch.h"
@@ -46,6 +50,15 @@
 /* timeout in ms */
 #define USB_TRANSFER_TIMEOUT 2000
 
+/* Read requests kept in flight for multi-packet register reads */
+#define USB_ASYNC_DEPTH 4
+
+/* Most descriptors libusb asks to be polled on */
+#define USB_MAX_POLLFDS 16
+
+/* Interval between pin reads while waiting for CHG, in ms */
+#define USB_CHG_INTERVAL_MS 2
+
 #define REPORT_ID            0x01
 #define IIC_DATA_1           0x51
 #define CMD_READ_PINS        0x82
@@ -159,6 +172,7 @@ static int usb_transfer(struct mxt_device *mxt, void *cmd, int cmd_size,
 
   if (ret != LIBUSB_SUCCESS) {
     mxt_err(mxt->ctx, "USB command error %s", usb_error_name(ret));
+    mxt->io_stats.bus_errors++;
     return usberror_to_rc(ret);
   } else if (bytes_transferred != cmd_size) {
     mxt_err
@@ -167,6 +181,7 @@ static int usb_transfer(struct mxt_device *mxt, void *cmd, int cmd_size,
       "Read request failed - %d bytes transferred, returned %s",
       bytes_transferred, usb_error_name(ret)
     );
+    mxt->io_stats.bus_errors++;
     return MXT_ERROR_IO;
   } else {
     mxt_log_buffer(mxt->ctx, LOG_VERBOSE, "TX:", cmd, cmd_size);
@@ -186,6 +201,7 @@ static int usb_transfer(struct mxt_device *mxt, void *cmd, int cmd_size,
 
   if (ret != LIBUSB_SUCCESS) {
     mxt_err(mxt->ctx, "USB response error %s", usb_error_name(ret));
+    mxt->io_stats.bus_errors++;
     return usberror_to_rc(ret);
   } else if (bytes_transferred != response_size) {
     mxt_err
@@ -194,6 +210,7 @@ static int usb_transfer(struct mxt_device *mxt, void *cmd, int cmd_size,
       "Read response failed - %d bytes transferred, returned %s",
       bytes_transferred, usb_error_name(ret)
     );
+    mxt->io_stats.bus_errors++;
     return MXT_ERROR_IO;
   } else {
     mxt_log_buffer(mxt->ctx, LOG_VERBOSE, "RX:", response, response_size);
@@ -203,30 +220,28 @@ static int usb_transfer(struct mxt_device *mxt, void *cmd, int cmd_size,
 }
 
 //******************************************************************************
-/// \brief  Read register from MXT chip
-/// \return #mxt_rc
-int usb_read_register(struct mxt_device *mxt, unsigned char *buf,
-                      uint16_t start_register, size_t count,
-                      size_t *bytes_transferred)
+/// \brief  Get number of register bytes returned by a single read packet
+/// \return Number of bytes
+int usb_get_max_read_size(struct mxt_device *mxt)
 {
-  unsigned char pkt[mxt->usb.ep1_in_max_packet_size];
-  size_t cmd_size;
-  size_t max_count;
-  off_t response_ofs;
-  int ret;
-
-  /* Check a device is present before trying to read from it */
-  if (!mxt->usb.device_connected) {
-    mxt_err(mxt->ctx, "Device uninitialised");
-    return MXT_ERROR_NO_DEVICE;
-  }
+  if (mxt->usb.bridge_chip)
+    return mxt->usb.ep1_in_max_packet_size - 5;
+  else
+    return mxt->usb.ep1_in_max_packet_size - 6;
+}
 
-  memset(&pkt, 0, sizeof(pkt));
+//******************************************************************************
+/// \brief  Build a register read command packet
+/// \return Number of register bytes requested, limited to one packet
+static size_t usb_build_read_cmd(struct mxt_device *mxt, unsigned char *pkt,
+                                 uint16_t start_register, size_t count,
+                                 size_t *cmd_size, off_t *response_ofs)
+{
+  size_t max_count;
 
-  /* Command packet */
   if (mxt->usb.bridge_chip) {
-    cmd_size = 5;
-    max_count = mxt->usb.ep1_in_max_packet_size - cmd_size;
+    *cmd_size = 5;
+    max_count = mxt->usb.ep1_in_max_packet_size - *cmd_size;
 
     if (count > max_count)
       count = max_count;
@@ -237,10 +252,10 @@ int usb_read_register(struct mxt_device *mxt, unsigned char *buf,
     pkt[3] = start_register & 0xFF;
     pkt[4] = (start_register & 0xFF00) >> 8;
 
-    response_ofs = 0;
+    *response_ofs = 0;
   } else {
-    cmd_size = 6;
-    max_count = mxt->usb.ep1_in_max_packet_size - cmd_size;
+    *cmd_size = 6;
+    max_count = mxt->usb.ep1_in_max_packet_size - *cmd_size;
 
     if (count > max_count)
       count = max_count;
@@ -252,13 +267,480 @@ int usb_read_register(struct mxt_device *mxt, unsigned char *buf,
     pkt[4] = start_register & 0xFF;
     pkt[5] = (start_register & 0xFF00) >> 8;
 
-    response_ofs = 1;
+    *response_ofs = 1;
   }
 
-  mxt_verb(mxt->ctx, "Reading %" PRIuPTR " bytes starting from address %d",
-           count, start_register);
+  return count;
+}
+
+//******************************************************************************
+/// \brief  One read request in the asynchronous queue
+struct usb_async_slot {
+  struct libusb_transfer *out;
+  struct libusb_transfer *in;
+  unsigned char *cmd;
+  unsigned char *response;
+  uint8_t *dest;
+  size_t count;
+  off_t response_ofs;
+  int pending;
+};
+
+//******************************************************************************
+/// \brief  Completion callback for queued transfers
+static void LIBUSB_CALL usb_async_callback(struct libusb_transfer *transfer)
+{
+  struct usb_async_slot *slot = transfer->user_data;
+
+  slot->pending--;
+}
+
+//******************************************************************************
+/// \brief  Check the outcome of a completed queued transfer
+/// \return #mxt_rc
+static int usb_async_status(struct mxt_device *mxt,
+                            struct libusb_transfer *transfer, const char *what)
+{
+  int err;
+
+  switch (transfer->status) {
+  case LIBUSB_TRANSFER_COMPLETED:
+    if (transfer->actual_length != transfer->length) {
+      mxt_err(mxt->ctx, "Read %s failed - %d bytes transferred",
+              what, transfer->actual_length);
+      mxt->io_stats.bus_errors++;
+      return MXT_ERROR_IO;
+    }
+    return MXT_SUCCESS;
+
+  case LIBUSB_TRANSFER_TIMED_OUT:
+    err = LIBUSB_ERROR_TIMEOUT;
+    break;
+
+  case LIBUSB_TRANSFER_CANCELLED:
+    err = LIBUSB_ERROR_INTERRUPTED;
+    break;
+
+  case LIBUSB_TRANSFER_STALL:
+    err = LIBUSB_ERROR_PIPE;
+    break;
+
+  case LIBUSB_TRANSFER_NO_DEVICE:
+    err = LIBUSB_ERROR_NO_DEVICE;
+    break;
+
+  case LIBUSB_TRANSFER_OVERFLOW:
+    err = LIBUSB_ERROR_OVERFLOW;
+    break;
+
+  case LIBUSB_TRANSFER_ERROR:
+  default:
+    err = LIBUSB_ERROR_IO;
+    break;
+  }
+
+  mxt_err(mxt->ctx, "USB %s error %s", what, usb_error_name(err));
+  mxt->io_stats.bus_errors++;
+  return usberror_to_rc(err);
+}
+
+//******************************************************************************
+/// \brief  Queue the command in a slot, response first so it is waiting for
+///         the device
+/// \return #mxt_rc
+static int usb_async_submit_cmd(struct mxt_device *mxt,
+                                struct usb_async_slot *slot, size_t cmd_size)
+{
+  int ret;
+
+  libusb_fill_interrupt_transfer(slot->in, mxt->usb.handle, ENDPOINT_1_IN,
+                                 slot->response, mxt->usb.ep1_in_max_packet_size,
+                                 usb_async_callback, slot, USB_TRANSFER_TIMEOUT);
+
+  libusb_fill_interrupt_transfer(slot->out, mxt->usb.handle, ENDPOINT_2_OUT,
+                                 slot->cmd, cmd_size,
+                                 usb_async_callback, slot, USB_TRANSFER_TIMEOUT);
+
+  ret = libusb_submit_transfer(slot->in);
+  if (ret) {
+    mxt_err(mxt->ctx, "USB response submit error %s", usb_error_name(ret));
+    mxt->io_stats.bus_errors++;
+    return usberror_to_rc(ret);
+  }
+  slot->pending++;
+
+  ret = libusb_submit_transfer(slot->out);
+  if (ret) {
+    mxt_err(mxt->ctx, "USB command submit error %s", usb_error_name(ret));
+    mxt->io_stats.bus_errors++;
+    return usberror_to_rc(ret);
+  }
+  slot->pending++;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Queue a read request
+/// \return #mxt_rc
+static int usb_async_submit(struct mxt_device *mxt, struct usb_async_slot *slot,
+                            uint16_t start_register, uint8_t *dest, size_t count)
+{
+  size_t cmd_size;
+  int ret;
+
+  memset(slot->cmd, 0, mxt->usb.ep1_in_max_packet_size);
+
+  slot->count = usb_build_read_cmd(mxt, slot->cmd, start_register, count,
+                                   &cmd_size, &slot->response_ofs);
+  slot->dest = dest;
+
+  ret = usb_async_submit_cmd(mxt, slot, cmd_size);
+  if (ret)
+    return ret;
+
+  mxt_verb(mxt->ctx, "Queued read of %" PRIuPTR " bytes from address %d",
+           slot->count, start_register);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Process USB events until both transfers of a slot have completed
+/// \return #mxt_rc
+static int usb_async_wait(struct mxt_device *mxt, struct usb_async_slot *slot)
+{
+  struct timeval tv = { USB_TRANSFER_TIMEOUT / 1000, 0 };
+  int ret;
+
+  while (slot->pending > 0) {
+    ret = libusb_handle_events_timeout(mxt->ctx->usb.libusb_ctx, &tv);
+    if (ret && ret != LIBUSB_ERROR_INTERRUPTED) {
+      mxt_err(mxt->ctx, "USB event error %s", usb_error_name(ret));
+      mxt->io_stats.bus_errors++;
+      return usberror_to_rc(ret);
+    }
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Sleep on the libusb pollfds until the slot has completed
+/// \return #mxt_rc, MXT_ERROR_TIMEOUT if the deadline passes first
+static int usb_async_poll(struct mxt_device *mxt, struct usb_async_slot *slot,
+                          const struct timespec *deadline)
+{
+  libusb_context *usb_ctx = mxt->ctx->usb.libusb_ctx;
+  const struct libusb_pollfd **usb_fds;
+  struct pollfd fds[USB_MAX_POLLFDS];
+  struct timeval tv;
+  struct timespec now;
+  long timeout_ms;
+  int nfds;
+  int ret;
+
+  while (slot->pending > 0) {
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    timeout_ms = (deadline->tv_sec - now.tv_sec) * 1000
+                 + (deadline->tv_nsec - now.tv_nsec) / 1000000;
+    if (timeout_ms <= 0)
+      return MXT_ERROR_TIMEOUT;
+
+    /* libusb may need to run its own timeouts sooner */
+    if (libusb_get_next_timeout(usb_ctx, &tv) == 1) {
+      if (tv.tv_sec * 1000 + tv.tv_usec / 1000 < timeout_ms)
+        timeout_ms = tv.tv_sec * 1000 + tv.tv_usec / 1000;
+    }
+
+    usb_fds = libusb_get_pollfds(usb_ctx);
+    if (!usb_fds)
+      return MXT_ERROR_NO_MEM;
+
+    for (nfds = 0; usb_fds[nfds] && nfds < USB_MAX_POLLFDS; nfds++) {
+      fds[nfds].fd = usb_fds[nfds]->fd;
+      fds[nfds].events = usb_fds[nfds]->events;
+      fds[nfds].revents = 0;
+    }
+
+#if defined(LIBUSB_API_VERSION) && (LIBUSB_API_VERSION >= 0x01000104)
+    libusb_free_pollfds(usb_fds);
+#else
+    free(usb_fds);
+#endif
+
+    ret = poll(fds, nfds, timeout_ms);
+    if (ret < 0 && errno == EINTR) {
+      return MXT_ERROR_INTERRUPTED;
+    } else if (ret < 0) {
+      mxt_err(mxt->ctx, "USB poll error: %s (%d)", strerror(errno), errno);
+      return mxt_errno_to_rc(errno);
+    }
+
+    /* Only handle what is ready, the wait is done by poll */
+    tv.tv_sec = 0;
+    tv.tv_usec = 0;
+    ret = libusb_handle_events_timeout(usb_ctx, &tv);
+    if (ret && ret != LIBUSB_ERROR_INTERRUPTED) {
+      mxt_err(mxt->ctx, "USB event error %s", usb_error_name(ret));
+      mxt->io_stats.bus_errors++;
+      return usberror_to_rc(ret);
+    }
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Deadline timeout_ms from now
+static void usb_deadline(struct timespec *deadline, int timeout_ms)
+{
+  clock_gettime(CLOCK_MONOTONIC, deadline);
+  deadline->tv_sec += timeout_ms / 1000;
+  deadline->tv_nsec += (timeout_ms % 1000) * 1000000L;
+  if (deadline->tv_nsec >= 1000000000L) {
+    deadline->tv_sec++;
+    deadline->tv_nsec -= 1000000000L;
+  }
+}
+
+//******************************************************************************
+/// \brief  Get the device's pin read slot, allocated on first use
+/// \note   The command never changes, so it is built once
+/// \return #mxt_rc
+static int usb_chg_slot_get(struct mxt_device *mxt, struct usb_async_slot **slot)
+{
+  struct usb_async_slot *s = mxt->usb.chg_slot;
+
+  if (s) {
+    *slot = s;
+    return MXT_SUCCESS;
+  }
+
+  s = calloc(1, sizeof(struct usb_async_slot));
+  if (!s)
+    return MXT_ERROR_NO_MEM;
+
+  s->out = libusb_alloc_transfer(0);
+  s->in = libusb_alloc_transfer(0);
+  s->cmd = calloc(mxt->usb.ep1_in_max_packet_size, 1);
+  s->response = calloc(mxt->usb.ep1_in_max_packet_size, 1);
+
+  if (!s->out || !s->in || !s->cmd || !s->response) {
+    libusb_free_transfer(s->out);
+    libusb_free_transfer(s->in);
+    free(s->cmd);
+    free(s->response);
+    free(s);
+    return MXT_ERROR_NO_MEM;
+  }
+
+  s->cmd[0] = CMD_READ_PINS;
+
+  mxt->usb.chg_slot = s;
+  *slot = s;
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Free the pin read slot, once libusb has finished with it
+static void usb_chg_slot_free(struct mxt_device *mxt)
+{
+  struct usb_async_slot *s = mxt->usb.chg_slot;
+
+  if (!s)
+    return;
+
+  if (s->pending > 0) {
+    libusb_cancel_transfer(s->out);
+    libusb_cancel_transfer(s->in);
+
+    if (usb_async_wait(mxt, s)) {
+      mxt_warn(mxt->ctx, "Leaking USB transfers which did not complete");
+      mxt->usb.chg_slot = NULL;
+      return;
+    }
+  }
+
+  libusb_free_transfer(s->out);
+  libusb_free_transfer(s->in);
+  free(s->cmd);
+  free(s->response);
+  free(s);
+
+  mxt->usb.chg_slot = NULL;
+}
+
+//******************************************************************************
+/// \brief  Read registers spanning several packets with requests in flight
+/// \note   The device answers requests in order, so responses are matched
+///         to requests by their position in the queue
+/// \return #mxt_rc
+static int usb_read_register_async(struct mxt_device *mxt, unsigned char *buf,
+                                   uint16_t start_register, size_t count)
+{
+  struct usb_async_slot slots[USB_ASYNC_DEPTH];
+  struct usb_async_slot *slot;
+  size_t submitted = 0;
+  int head = 0;
+  int inflight = 0;
+  bool can_free = true;
+  int ret = MXT_SUCCESS;
+  int i;
+
+  memset(&slots, 0, sizeof(slots));
+
+  for (i = 0; i < USB_ASYNC_DEPTH; i++) {
+    slots[i].out = libusb_alloc_transfer(0);
+    slots[i].in = libusb_alloc_transfer(0);
+    slots[i].cmd = calloc(mxt->usb.ep1_in_max_packet_size, 1);
+    slots[i].response = calloc(mxt->usb.ep1_in_max_packet_size, 1);
+
+    if (!slots[i].out || !slots[i].in || !slots[i].cmd || !slots[i].response) {
+      ret = MXT_ERROR_NO_MEM;
+      goto free;
+    }
+  }
+
+  mxt_verb(mxt->ctx, "Reading %" PRIuPTR " bytes starting from address %d, "
+           "%d requests in flight", count, start_register, USB_ASYNC_DEPTH);
+
+  /* Prime the queue */
+  while (inflight < USB_ASYNC_DEPTH && submitted < count) {
+    slot = &slots[(head + inflight) % USB_ASYNC_DEPTH];
+
+    ret = usb_async_submit(mxt, slot, start_register + submitted,
+                           buf + submitted, count - submitted);
+    if (ret)
+      goto cancel;
+
+    submitted += slot->count;
+    inflight++;
+  }
+
+  while (inflight > 0) {
+    slot = &slots[head];
+
+    ret = usb_async_wait(mxt, slot);
+    if (ret)
+      goto cancel;
+
+    ret = usb_async_status(mxt, slot->out, "command");
+    if (ret)
+      goto cancel;
+
+    ret = usb_async_status(mxt, slot->in, "response");
+    if (ret)
+      goto cancel;
+
+    mxt_log_buffer(mxt->ctx, LOG_VERBOSE, "TX:", slot->cmd, slot->out->length);
+    mxt_log_buffer(mxt->ctx, LOG_VERBOSE, "RX:", slot->response, slot->in->length);
+
+    /* Check the result in the response */
+    if (slot->response[slot->response_ofs] != COMMS_STATUS_OK) {
+      mxt_err
+      (
+        mxt->ctx,
+        "Wrong result in read response - expected 0x%02X got 0x%02X",
+        COMMS_STATUS_OK, slot->response[slot->response_ofs]
+      );
+      ret = MXT_ERROR_IO;
+      goto cancel;
+    }
+
+    (void)memcpy(slot->dest, &slot->response[slot->response_ofs + 2],
+                 slot->count);
+
+    inflight--;
+    head = (head + 1) % USB_ASYNC_DEPTH;
+
+    /* Refill the slot that has just completed */
+    if (submitted < count) {
+      slot = &slots[(head + inflight) % USB_ASYNC_DEPTH];
+
+      ret = usb_async_submit(mxt, slot, start_register + submitted,
+                             buf + submitted, count - submitted);
+      if (ret)
+        goto cancel;
+
+      submitted += slot->count;
+      inflight++;
+    }
+  }
+
+  goto free;
+
+cancel:
+  /* Transfers still owned by libusb must complete before they are freed */
+  for (i = 0; i < USB_ASYNC_DEPTH; i++) {
+    if (slots[i].pending > 0) {
+      libusb_cancel_transfer(slots[i].out);
+      libusb_cancel_transfer(slots[i].in);
+    }
+  }
+
+  for (i = 0; i < USB_ASYNC_DEPTH; i++) {
+    if (usb_async_wait(mxt, &slots[i]))
+      can_free = false;
+  }
+
+free:
+  if (!can_free) {
+    mxt_warn(mxt->ctx, "Leaking USB transfers which did not complete");
+    return ret;
+  }
+
+  for (i = 0; i < USB_ASYNC_DEPTH; i++) {
+    libusb_free_transfer(slots[i].out);
+    libusb_free_transfer(slots[i].in);
+    free(slots[i].cmd);
+    free(slots[i].response);
+  }
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief  Read register from MXT chip
+/// \note   Reads longer than one packet are pipelined, see
+///         usb_read_register_async()
+/// \return #mxt_rc
+int usb_read_register(struct mxt_device *mxt, unsigned char *buf,
+                      uint16_t start_register, size_t count,
+                      size_t *bytes_transferred)
+{
+  unsigned char pkt[mxt->usb.ep1_in_max_packet_size];
+  size_t cmd_size;
+  off_t response_ofs;
+  int ret;
+
+  /* Check a device is present before trying to read from it */
+  if (!mxt->usb.device_connected) {
+    mxt_err(mxt->ctx, "Device uninitialised");
+    return MXT_ERROR_NO_DEVICE;
+  }
+
+  if (USB_ASYNC_DEPTH > 1 && count > (size_t)usb_get_max_read_size(mxt)) {
+    ret = usb_read_register_async(mxt, buf, start_register, count);
+    if (ret == MXT_SUCCESS) {
+      *bytes_transferred = count;
+      return MXT_SUCCESS;
+    } else if (ret != MXT_ERROR_NOT_SUPPORTED) {
+      return ret;
+    }
+
+    /* Fall back to one packet at a time */
+    mxt_dbg(mxt->ctx, "Asynchronous transfers not supported");
+  }
+
+  memset(&pkt, 0, sizeof(pkt));
 
   /* Command packet */
+  count = usb_build_read_cmd(mxt, pkt, start_register, count,
+                             &cmd_size, &response_ofs);
+
+  mxt_verb(mxt->ctx, "Reading %" PRIuPTR " bytes starting from address %d",
+           count, start_register);
 
   ret = usb_transfer(mxt, &pkt, cmd_size, &pkt, sizeof(pkt), false);
   if (ret)
@@ -898,6 +1380,8 @@ free_device_list:
 /// \brief  Release device
 void usb_release(struct mxt_device *mxt)
 {
+  usb_chg_slot_free(mxt);
+
   /* Are we connected to a device? */
   if (mxt->usb.device_connected) {
     libusb_release_interface(mxt->usb.handle, mxt->usb.interface);
@@ -1040,7 +1524,7 @@ int usb_reset_chip(struct mxt_device *mxt, bool bootloader_mode, uint16_t reset_
   int bytes_written;
 
   /* Obtain command processor's address */
-  t6_addr = mxt_get_object_address(mxt, GEN_COMMANDPROCESSOR_T6, 0);
+  t6_addr = mxt->obj_cache.t6_addr;
   if (t6_addr == OBJECT_NOT_FOUND)
     return MXT_ERROR_OBJECT_NOT_FOUND;
 
@@ -1220,6 +1704,91 @@ int usb_read_chg(struct mxt_device *mxt, bool *value)
   return MXT_SUCCESS;
 }
 
+//******************************************************************************
+/// \brief  Wait for CHG line to be asserted on bridge board
+/// \note   Pin reads use the device's persistent slot. The thread sleeps on
+///         the libusb pollfds until each read completes, and between reads
+///         while the line is high.
+/// \return #mxt_rc, MXT_ERROR_TIMEOUT if no messages pending
+int usb_wait_chg(struct mxt_device *mxt, int timeout_ms)
+{
+  struct usb_async_slot *slot;
+  struct timespec deadline, transfer_deadline, now;
+  long remaining_ms;
+  bool chg;
+  int ret;
+
+  ret = usb_chg_slot_get(mxt, &slot);
+  if (ret)
+    return ret;
+
+  usb_deadline(&deadline, timeout_ms);
+
+  while (true) {
+    ret = usb_async_submit_cmd(mxt, slot, mxt->usb.ep1_in_max_packet_size);
+    if (ret)
+      goto cancel;
+
+    /* A read that has been sent is always completed, otherwise its response
+     * would be taken by the next transfer on the endpoint */
+    usb_deadline(&transfer_deadline, USB_TRANSFER_TIMEOUT);
+    ret = usb_async_poll(mxt, slot, &transfer_deadline);
+    if (ret == MXT_ERROR_INTERRUPTED) {
+      if (usb_async_wait(mxt, slot))
+        goto cancel;
+      return ret;
+    } else if (ret) {
+      goto cancel;
+    }
+
+    ret = usb_async_status(mxt, slot->out, "command");
+    if (ret)
+      return ret;
+
+    ret = usb_async_status(mxt, slot->in, "response");
+    if (ret)
+      return ret;
+
+    mxt_log_buffer(mxt->ctx, LOG_VERBOSE, "RX:", slot->response,
+                   slot->in->length);
+
+    chg = slot->response[2] & 0x4;
+
+    mxt_verb(mxt->ctx, "CHG line %s", chg ? "HIGH" : "LOW");
+
+    /* CHG is active low */
+    if (!chg)
+      return MXT_SUCCESS;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    remaining_ms = (deadline.tv_sec - now.tv_sec) * 1000
+                   + (deadline.tv_nsec - now.tv_nsec) / 1000000;
+    if (remaining_ms <= 0)
+      return MXT_ERROR_TIMEOUT;
+
+    /* Line still high, pace the next pin read */
+    if (poll(NULL, 0, remaining_ms < USB_CHG_INTERVAL_MS
+                      ? remaining_ms : USB_CHG_INTERVAL_MS) < 0
+        && errno == EINTR)
+      return MXT_ERROR_INTERRUPTED;
+  }
+
+cancel:
+  /* Transfers still owned by libusb must complete before they are reused */
+  if (slot->pending > 0) {
+    libusb_cancel_transfer(slot->out);
+    libusb_cancel_transfer(slot->in);
+
+    if (usb_async_wait(mxt, slot)) {
+      /* Still owned by libusb, so it cannot be freed or reused */
+      mxt_warn(mxt->ctx, "Leaking USB transfers which did not complete");
+      mxt->usb.chg_slot = NULL;
+    }
+  }
+
+  return ret;
+}
+
 //******************************************************************************
 /// \brief  Switch to parallel digitizer mode
 /// \return #mxt_rc
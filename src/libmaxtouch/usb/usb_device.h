@@ -51,6 +51,8 @@ struct usb_conn_info {
   int b_i2c_addr;
 };
 
+struct usb_async_slot;
+
 //******************************************************************************
 /// \brief USB device information
 struct usb_device {
@@ -66,6 +68,8 @@ struct usb_device {
   int address;
   int b_i2c_addr;
   bool sent_btlr_cmd;
+  /* Pin read transfers reused by each CHG wait */
+  struct usb_async_slot *chg_slot;
 };
 
 int usb_scan(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conn);
@@ -73,11 +77,13 @@ int usb_open(struct mxt_device *mxt);
 int usb_close(struct libmaxtouch_ctx *ctx);
 void usb_release(struct mxt_device *mxt);
 int usb_reset_chip(struct mxt_device *mxt, bool bootloader_mode, uint16_t reset_time_ms);
+int usb_get_max_read_size(struct mxt_device *mxt);
 int usb_read_register(struct mxt_device *mxt, unsigned char *buf, uint16_t start_register, size_t count, size_t *bytes_transferred);
 int usb_write_register(struct mxt_device *mxt, unsigned char const *buf, uint16_t start_register, size_t count);
 int usb_bootloader_read(struct mxt_device *mxt, unsigned char *buf, size_t count);
 int usb_bootloader_write(struct mxt_device *mxt, unsigned char const *buf, size_t count);
 bool usb_is_bootloader(struct mxt_device *mxt);
 int usb_read_chg(struct mxt_device *mxt, bool *value);
+int usb_wait_chg(struct mxt_device *mxt, int timeout_ms);
 int usb_find_bus_devices(struct mxt_device *mxt, bool *device_list);
 int usb_rediscover_device(struct mxt_device *mxt, bool *device_list);
@@ -318,21 +318,63 @@ int mxt_print_timestamp(FILE *stream, bool date)
 {
   struct timeval tv;
   time_t nowtime;
-  struct tm *nowtm;
+  struct tm nowtm;
   char tmbuf[64];
   int ret;
 
   gettimeofday(&tv, NULL);
   nowtime = tv.tv_sec;
-  nowtm = localtime(&nowtime);
+  localtime_r(&nowtime, &nowtm);
 
   if (date) {
-    strftime(tmbuf, sizeof(tmbuf), "%c", nowtm);
+    strftime(tmbuf, sizeof(tmbuf), "%c", &nowtm);
     ret = fprintf(stream, "%s", tmbuf);
   } else {
-    strftime(tmbuf, sizeof(tmbuf), "%H:%M:%S", nowtm);
+    strftime(tmbuf, sizeof(tmbuf), "%H:%M:%S", &nowtm);
     ret = fprintf(stream, "%s.%06ld", tmbuf, tv.tv_usec);
   }
 
   return (ret < 0) ? MXT_ERROR_IO : MXT_SUCCESS;
 }
+
+//******************************************************************************
+/// \brief Get CLOCK_MONOTONIC time in nanoseconds
+/// \note  Used to stamp frames and messages as they are read, so that they
+///        can be correlated without wall clock steps. Only format on output.
+uint64_t mxt_time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//******************************************************************************
+/// \brief Get wall clock time in nanoseconds
+uint64_t mxt_wall_time_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_REALTIME, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+//******************************************************************************
+/// \brief Output a wall clock time in nanoseconds as local time of day with
+///        microsecond accuracy, in the same format as mxt_print_timestamp()
+/// \return #mxt_rc
+int mxt_print_time_ns(FILE *stream, uint64_t wall_ns)
+{
+  time_t secs = wall_ns / 1000000000;
+  struct tm tm;
+  char tmbuf[64];
+  int ret;
+
+  localtime_r(&secs, &tm);
+  strftime(tmbuf, sizeof(tmbuf), "%H:%M:%S", &tm);
+  ret = fprintf(stream, "%s.%06ld", tmbuf, (long)(wall_ns % 1000000000) / 1000);
+
+  return (ret < 0) ? MXT_ERROR_IO : MXT_SUCCESS;
+}
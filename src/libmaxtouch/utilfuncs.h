@@ -36,3 +36,6 @@ int mxt_read_object(struct mxt_device *dev, uint16_t object_type, uint8_t instan
 int mxt_handle_write_cmd(struct mxt_device *mxt, const uint16_t type, uint16_t count, const uint8_t inst, uint16_t address, int argc, char *argv[]);
 int mxt_convert_hex(char *hex, unsigned char *databuf, uint16_t *count, unsigned int buf_size);
 int mxt_print_timestamp(FILE *stream, bool date);
+uint64_t mxt_time_ns(void);
+uint64_t mxt_wall_time_ns(void);
+int mxt_print_time_ns(FILE *stream, uint64_t wall_ns);
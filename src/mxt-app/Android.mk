@@ -7,10 +7,16 @@ LOCAL_SRC_FILES := \
   mxt_app.c \
   broken_line.c \
   sensor_variant.c \
+  screening.c \
+  monitor.c \
+  bench.c \
+  uinput.c \
+  live.c \
   polyfit.c \
   menu.c \
   bootloader.c \
   diagnostic_data.c \
+  frame_kernels.c \
   touch_app.c \
   self_test.c \
   bridge.c \
@@ -18,6 +24,7 @@ LOCAL_SRC_FILES := \
   gr.c \
   serial_data.c \
   self_cap.c \
+  parallel.c \
   signal.c
 LOCAL_LDLIBS := -llog
 LOCAL_STATIC_LIBRARIES := maxtouch
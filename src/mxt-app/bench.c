@@ -0,0 +1,483 @@
+//------------------------------------------------------------------------------
+/// \file   bench.c
+/// \brief  Transport and capture benchmarks
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <time.h>
+#include <limits.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/info_block.h"
+#include "libmaxtouch/msg.h"
+#include "libmaxtouch/crc.h"
+#include "libmaxtouch/config_image.h"
+#include "libmaxtouch/log.h"
+
+#include "mxt_app.h"
+#include "bench.h"
+
+#define BENCH_MAX_RESULTS  32
+#define BENCH_CRC_SIZE     65536
+
+/* Register transfer sizes, capped to the readable address range */
+static const size_t bench_sizes[] = { 1, 2, 4, 8, 16, 32, 64, 128, 256 };
+
+//******************************************************************************
+/// \brief Benchmark run state
+struct bench_ctx {
+  struct mxt_device *mxt;
+  int iterations;
+  /* Slow tests (frames, config) run this many times */
+  int passes;
+  double *samples;
+  struct bench_result results[BENCH_MAX_RESULTS];
+  int count;
+};
+
+//******************************************************************************
+/// \brief Monotonic time in microseconds
+static double bench_now_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+//******************************************************************************
+/// \brief Compare doubles for qsort
+static int bench_cmp(const void *a, const void *b)
+{
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
+
+//******************************************************************************
+/// \brief Nearest rank percentile of sorted samples
+static double bench_percentile(const double *sorted, int count, int pct)
+{
+  int rank = (pct * count + 99) / 100;
+
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+//******************************************************************************
+/// \brief Fill in the latency fields of r from count samples, which are
+///        sorted in place
+void bench_summarise(double *samples_us, int count, struct bench_result *r)
+{
+  double sum = 0;
+  int i;
+
+  r->count = count;
+  if (count == 0) {
+    r->mean_us = r->p50_us = r->p90_us = r->p99_us = r->max_us = 0;
+    r->rate = 0;
+    return;
+  }
+
+  qsort(samples_us, count, sizeof(double), bench_cmp);
+
+  for (i = 0; i < count; i++)
+    sum += samples_us[i];
+
+  r->mean_us = sum / count;
+  r->p50_us = bench_percentile(samples_us, count, 50);
+  r->p90_us = bench_percentile(samples_us, count, 90);
+  r->p99_us = bench_percentile(samples_us, count, 99);
+  r->max_us = samples_us[count - 1];
+  r->rate = (r->mean_us > 0) ? r->size * 1e6 / r->mean_us : 0;
+}
+
+//******************************************************************************
+/// \brief Record a result from the collected samples
+static void bench_add(struct bench_ctx *b, const char *test, const char *param,
+                      size_t size, const char *unit, int count)
+{
+  struct bench_result *r;
+
+  if (b->count >= BENCH_MAX_RESULTS)
+    return;
+
+  r = &b->results[b->count++];
+  r->test = test;
+  r->param = param;
+  r->size = size;
+  r->unit = unit;
+  bench_summarise(b->samples, count, r);
+
+  mxt_info(b->mxt->ctx, "%s %s %zu: mean %0.1f us, p99 %0.1f us",
+           test, param, size, r->mean_us, r->p99_us);
+}
+
+//******************************************************************************
+/// \brief Register read and write latency by transfer size
+/// \return #mxt_rc
+static int bench_registers(struct bench_ctx *b)
+{
+  struct mxt_device *mxt = b->mxt;
+  uint8_t buf[256];
+  size_t limit = 0;
+  uint16_t addr;
+  unsigned int s;
+  int obj_idx, i;
+  double t;
+  int ret;
+
+  /* Everything up to the end of the last object is readable */
+  for (obj_idx = 0; obj_idx < mxt->info.id->num_objects; obj_idx++) {
+    struct mxt_object obj = mxt->info.objects[obj_idx];
+    size_t end = mxt_get_start_position(obj, 0)
+                 + (size_t)MXT_SIZE(obj) * MXT_INSTANCES(obj);
+
+    if (end > limit)
+      limit = end;
+  }
+
+  for (s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++) {
+    if (bench_sizes[s] > limit)
+      break;
+
+    for (i = 0; i < b->iterations; i++) {
+      t = bench_now_us();
+      ret = mxt_read_register(mxt, buf, 0, bench_sizes[s]);
+      if (ret)
+        return ret;
+      b->samples[i] = bench_now_us() - t;
+    }
+
+    bench_add(b, "read", "", bench_sizes[s], "B/s", b->iterations);
+  }
+
+  /* Write back the current contents of T38 user data, or T7 without it */
+  addr = mxt_get_object_address(mxt, SPT_USERDATA_T38, 0);
+  limit = mxt_get_object_size(mxt, SPT_USERDATA_T38);
+  if (addr == OBJECT_NOT_FOUND) {
+    addr = mxt_get_object_address(mxt, GEN_POWERCONFIG_T7, 0);
+    limit = mxt_get_object_size(mxt, GEN_POWERCONFIG_T7);
+  }
+
+  if (addr == OBJECT_NOT_FOUND) {
+    mxt_warn(mxt->ctx, "No object to benchmark writes");
+    return MXT_SUCCESS;
+  }
+
+  ret = mxt_read_register(mxt, buf, addr, limit);
+  if (ret)
+    return ret;
+
+  for (s = 0; s < sizeof(bench_sizes) / sizeof(bench_sizes[0]); s++) {
+    if (bench_sizes[s] > limit)
+      break;
+
+    for (i = 0; i < b->iterations; i++) {
+      t = bench_now_us();
+      ret = mxt_write_register(mxt, buf, addr, bench_sizes[s]);
+      if (ret)
+        return ret;
+      b->samples[i] = bench_now_us() - t;
+    }
+
+    bench_add(b, "write", "", bench_sizes[s], "B/s", b->iterations);
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Time draining the messages generated by REPORTALL
+/// \return #mxt_rc
+static int bench_messages(struct bench_ctx *b)
+{
+  struct mxt_device *mxt = b->mxt;
+  struct mxt_msg msgs[MXT_MSG_BATCH_SIZE];
+  struct timespec settle = { 0, 50000000L };
+  int total = 0;
+  int count, i;
+  double t;
+  int ret;
+
+  ret = mxt_flush_msgs(mxt);
+  if (ret)
+    return ret;
+
+  for (i = 0; i < b->passes; i++) {
+    ret = mxt_report_all(mxt);
+    if (ret)
+      return ret;
+
+    /* Let the device queue every message before timing the reads */
+    nanosleep(&settle, NULL);
+
+    t = bench_now_us();
+    do {
+      ret = mxt_get_msgs_batch(mxt, msgs, MXT_MSG_BATCH_SIZE, &count);
+      if (ret)
+        return ret;
+      total += count;
+    } while (count > 0);
+    b->samples[i] = bench_now_us() - t;
+  }
+
+  bench_add(b, "msg_drain", "report_all", b->passes ? total / b->passes : 0,
+            "msg/s", b->passes);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief T37 frame and page capture rate for one mode
+/// \return #mxt_rc
+static int bench_t37_mode(struct bench_ctx *b, uint8_t mode, const char *name)
+{
+  struct t37_ctx t37;
+  int pages;
+  double t;
+  int i;
+  int ret;
+
+  ret = mxt_dd_stream_start(b->mxt, &t37, mode, 0);
+  if (ret)
+    return ret;
+
+  pages = t37.pages_per_pass;
+
+  for (i = 0; i < b->passes; i++) {
+    t = bench_now_us();
+    ret = mxt_dd_stream_frame(b->mxt, &t37);
+    if (ret)
+      goto stop;
+    b->samples[i] = bench_now_us() - t;
+  }
+
+  bench_add(b, "t37_frame", name,
+            (size_t)t37.x_size * t37.y_size * sizeof(uint16_t), "B/s",
+            b->passes);
+
+  /* Per page time, averaged over each frame */
+  for (i = 0; i < b->passes; i++)
+    b->samples[i] /= pages;
+
+  bench_add(b, "t37_page", name, t37.page_size, "B/s", b->passes);
+
+stop:
+  mxt_dd_stream_stop(&t37);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Config save and load time, and host CRC and parse throughput
+/// \return #mxt_rc
+static int bench_config(struct bench_ctx *b)
+{
+  struct mxt_device *mxt = b->mxt;
+  struct mxt_config_image *img;
+  const char *tmpdir = getenv("TMPDIR");
+  char path[PATH_MAX];
+  uint8_t *crc_buf = NULL;
+  size_t file_size = 0;
+  FILE *fp;
+  double t;
+  int fd, i;
+  int ret;
+
+  snprintf(path, sizeof(path), "%s/mxt-bench-XXXXXX", tmpdir ? tmpdir : "/tmp");
+  fd = mkstemp(path);
+  if (fd < 0) {
+    mxt_err(mxt->ctx, "Could not create temporary file in %s",
+            tmpdir ? tmpdir : "/tmp");
+    return MXT_ERROR_IO;
+  }
+  close(fd);
+
+  for (i = 0; i < b->passes; i++) {
+    t = bench_now_us();
+    ret = mxt_save_config_file(mxt, path);
+    if (ret)
+      goto unlink;
+    b->samples[i] = bench_now_us() - t;
+  }
+
+  fp = fopen(path, "r");
+  if (fp) {
+    fseek(fp, 0, SEEK_END);
+    file_size = ftell(fp);
+    fclose(fp);
+  }
+
+  bench_add(b, "config_save", "raw", file_size, "B/s", b->passes);
+
+  /* Loading the config just saved compares equal, so nothing is written
+   * and there is no backup or reset */
+  for (i = 0; i < b->passes; i++) {
+    t = bench_now_us();
+    ret = mxt_load_config_file_diff(mxt, path);
+    if (ret)
+      goto unlink;
+    b->samples[i] = bench_now_us() - t;
+  }
+
+  bench_add(b, "config_load", "diff", file_size, "B/s", b->passes);
+
+  for (i = 0; i < b->iterations; i++) {
+    t = bench_now_us();
+    ret = mxt_config_image_load(mxt->ctx, path, &img);
+    if (ret)
+      goto unlink;
+    mxt_config_image_free(img);
+    b->samples[i] = bench_now_us() - t;
+  }
+
+  bench_add(b, "config_parse", "raw", file_size, "B/s", b->iterations);
+
+  crc_buf = malloc(BENCH_CRC_SIZE);
+  if (!crc_buf) {
+    ret = MXT_ERROR_NO_MEM;
+    goto unlink;
+  }
+
+  for (i = 0; i < BENCH_CRC_SIZE; i++)
+    crc_buf[i] = (uint8_t)(i * 37 + 11);
+
+  for (i = 0; i < b->iterations; i++) {
+    t = bench_now_us();
+    crc_buf[0] ^= (uint8_t)mxt_crc24(crc_buf, BENCH_CRC_SIZE);
+    b->samples[i] = bench_now_us() - t;
+  }
+
+  bench_add(b, "crc24", "", BENCH_CRC_SIZE, "B/s", b->iterations);
+
+  for (i = 0; i < b->iterations; i++) {
+    t = bench_now_us();
+    crc_buf[0] ^= mxt_crc8(0, crc_buf, BENCH_CRC_SIZE);
+    b->samples[i] = bench_now_us() - t;
+  }
+
+  bench_add(b, "crc8", "", BENCH_CRC_SIZE, "B/s", b->iterations);
+
+  ret = MXT_SUCCESS;
+
+unlink:
+  free(crc_buf);
+  unlink(path);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Print results as JSON or CSV
+void bench_print_results(FILE *fp, enum bench_format format,
+                         struct mxt_device *mxt,
+                         const struct bench_result *results, int count)
+{
+  struct mxt_id_info *id = mxt->info.id;
+  int i;
+
+  if (format == BENCH_FORMAT_CSV) {
+    fprintf(fp, "test,param,size,count,mean_us,p50_us,p90_us,p99_us,max_us,rate,unit\n");
+
+    for (i = 0; i < count; i++) {
+      const struct bench_result *r = &results[i];
+
+      fprintf(fp, "%s,%s,%zu,%d,%0.1f,%0.1f,%0.1f,%0.1f,%0.1f,%0.0f,%s\n",
+              r->test, r->param, r->size, r->count, r->mean_us, r->p50_us,
+              r->p90_us, r->p99_us, r->max_us, r->rate, r->unit);
+    }
+    return;
+  }
+
+  fprintf(fp, "{\n");
+  fprintf(fp, "  \"device\": {\"family\": %u, \"variant\": %u, "
+          "\"version\": \"%u.%u\", \"build\": \"%02X\", "
+          "\"matrix\": \"%ux%u\", \"objects\": %u},\n",
+          id->family, id->variant, (id->version & 0xF0) >> 4,
+          id->version & 0x0F, id->build, id->matrix_x_size,
+          id->matrix_y_size, id->num_objects);
+  fprintf(fp, "  \"results\": [\n");
+
+  for (i = 0; i < count; i++) {
+    const struct bench_result *r = &results[i];
+
+    fprintf(fp, "    {\"test\": \"%s\", \"param\": \"%s\", \"size\": %zu, "
+            "\"count\": %d, \"mean_us\": %0.1f, \"p50_us\": %0.1f, "
+            "\"p90_us\": %0.1f, \"p99_us\": %0.1f, \"max_us\": %0.1f, "
+            "\"rate\": %0.0f, \"unit\": \"%s\"}%s\n",
+            r->test, r->param, r->size, r->count, r->mean_us, r->p50_us,
+            r->p90_us, r->p99_us, r->max_us, r->rate, r->unit,
+            (i < count - 1) ? "," : "");
+  }
+
+  fprintf(fp, "  ]\n}\n");
+}
+
+//******************************************************************************
+/// \brief Run all benchmarks on the device and print the results to stdout
+/// \return #mxt_rc
+int mxt_bench(struct mxt_device *mxt, int iterations, enum bench_format format)
+{
+  struct bench_ctx b;
+  int ret;
+
+  memset(&b, 0, sizeof(b));
+  b.mxt = mxt;
+  b.iterations = (iterations > 0) ? iterations : BENCH_DEFAULT_ITERATIONS;
+  b.passes = (b.iterations >= 10) ? b.iterations / 10 : 1;
+
+  b.samples = calloc(b.iterations, sizeof(double));
+  if (!b.samples)
+    return MXT_ERROR_NO_MEM;
+
+  ret = bench_registers(&b);
+  if (ret)
+    goto free;
+
+  ret = bench_messages(&b);
+  if (ret)
+    mxt_warn(mxt->ctx, "Message benchmark failed, skipping");
+
+  ret = bench_t37_mode(&b, DELTAS_MODE, "deltas");
+  if (!ret)
+    ret = bench_t37_mode(&b, REFS_MODE, "refs");
+  if (ret)
+    mxt_warn(mxt->ctx, "T37 benchmark failed, skipping");
+
+  ret = bench_config(&b);
+  if (ret)
+    goto free;
+
+  bench_print_results(stdout, format, mxt, b.results, b.count);
+
+free:
+  free(b.samples);
+  return ret;
+}
@@ -0,0 +1,60 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   bench.h
+/// \brief  Transport and capture benchmarks
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#define BENCH_DEFAULT_ITERATIONS  100
+
+struct mxt_device;
+
+//******************************************************************************
+/// \brief Output format for benchmark results
+enum bench_format {
+  BENCH_FORMAT_JSON,
+  BENCH_FORMAT_CSV,
+};
+
+//******************************************************************************
+/// \brief Summary of one benchmark
+struct bench_result {
+  const char *test;
+  const char *param;
+  size_t size;
+  int count;
+  double mean_us;
+  double p50_us;
+  double p90_us;
+  double p99_us;
+  double max_us;
+  /* Units of size per second, or 0 if not meaningful */
+  double rate;
+  const char *unit;
+};
+
+void bench_summarise(double *samples_us, int count, struct bench_result *r);
+void bench_print_results(FILE *fp, enum bench_format format, struct mxt_device *mxt, const struct bench_result *results, int count);
+int mxt_bench(struct mxt_device *mxt, int iterations, enum bench_format format);
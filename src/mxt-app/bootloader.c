@@ -29,9 +29,13 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <ctype.h>
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <pthread.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 
@@ -63,6 +67,39 @@
 
 #define MXT_RESET_TIME           1
 #define MXT_BOOTLOADER_DELAY     50000
+#define MXT_BOOTLOADER_CHG_TIMEOUT 1000
+
+//******************************************************************************
+/// \brief Firmware frame within decoded image
+struct fw_frame {
+  size_t offset;
+  uint16_t size;
+};
+
+//******************************************************************************
+/// \brief Decoded firmware image
+struct fw_image {
+  uint8_t *data;
+  size_t size;
+  struct fw_frame *frames;
+  int num_frames;
+};
+
+//******************************************************************************
+/// \brief Flashing worker for one device in multi-device mode
+struct flash_worker {
+  pthread_t thread;
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_conn_info *conn;
+  const char *name;
+  const struct fw_image *image;
+  const char *new_version;
+  int percent;
+  int ret;
+  double elapsed;
+};
+
+static pthread_mutex_t flash_progress_lock = PTHREAD_MUTEX_INITIALIZER;
 
 //******************************************************************************
 /// \brief Bootloader context object
@@ -72,8 +109,7 @@ struct flash_context {
   struct libmaxtouch_ctx *ctx;
   bool have_bootloader_version;
   bool extended_id_mode;
-  FILE *fp;
-  long file_size;
+  const struct fw_image *image;
   char curr_version[MXT_FW_VER_LEN];
   int i2c_adapter;
   int appmode_address;
@@ -81,6 +117,7 @@ struct flash_context {
   bool check_version;
   const char *new_version;
   bool usb_bootloader;
+  struct flash_worker *worker;
 };
 
 //******************************************************************************
@@ -88,9 +125,18 @@ struct flash_context {
 /// \return #mxt_rc
 static int wait_for_chg(struct mxt_device *mxt)
 {
+  int ret;
+
+  if (mxt->chg_gpio_fd >= 0) {
+    ret = gpio_chg_wait(mxt, MXT_BOOTLOADER_CHG_TIMEOUT);
+    if (ret == MXT_ERROR_TIMEOUT)
+      mxt_warn(mxt->ctx, "Timed out awaiting CHG");
+
+    return ret;
+  }
+
 #ifdef HAVE_LIBUSB
   int try = 0;
-  int ret;
   bool chg;
 
   if (mxt->conn->type == E_USB) {
@@ -243,22 +289,153 @@ recheck:
 }
 
 //******************************************************************************
-/// \brief Read hexadecimal value from file
-static int get_hex_value(struct flash_context *fw, unsigned char *ptr)
+/// \brief Decode hexadecimal character
+/// \return value 0-15, or -1 if not a hex digit
+static int hex_nibble(int c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  else if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  else if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+
+  return -1;
+}
+
+//******************************************************************************
+/// \brief Free decoded firmware image
+static void mxt_free_firmware(struct fw_image *image)
+{
+  free(image->data);
+  free(image->frames);
+  memset(image, 0, sizeof(*image));
+}
+
+//******************************************************************************
+/// \brief Read firmware file, decode to binary and build frame index
+/// \note  The whole file is validated before the device is touched
+/// \return #mxt_rc
+static int mxt_load_firmware(struct libmaxtouch_ctx *ctx, const char *filename,
+                             struct fw_image *image)
 {
-  char str[] = "00\0";
-  int val;
+  FILE *fp;
+  char *text;
+  long file_size;
+  size_t text_size;
+  size_t pos;
+  size_t offset;
+  int hi, lo;
+  int frame_size;
   int ret;
 
-  str[0] = fgetc(fw->fp);
-  str[1] = fgetc(fw->fp);
+  memset(image, 0, sizeof(*image));
+
+  mxt_info(ctx, "Opening firmware file %s", filename);
+
+  fp = fopen(filename, "r");
+  if (!fp) {
+    mxt_err(ctx, "Cannot open firmware file %s!", filename);
+    return mxt_errno_to_rc(errno);
+  }
+
+  fseek(fp, 0L, SEEK_END);
+  file_size = ftell(fp);
+  rewind(fp);
+
+  if (file_size <= 0) {
+    mxt_err(ctx, "Firmware file is empty");
+    fclose(fp);
+    return MXT_ERROR_FILE_FORMAT;
+  }
+
+  text = malloc(file_size);
+  if (!text) {
+    fclose(fp);
+    return MXT_ERROR_NO_MEM;
+  }
+
+  text_size = fread(text, 1, file_size, fp);
+  fclose(fp);
+
+  image->data = malloc(text_size / 2 + 1);
+  if (!image->data) {
+    free(text);
+    return MXT_ERROR_NO_MEM;
+  }
+
+  /* Decode hex pairs, ignoring whitespace such as line endings */
+  for (pos = 0; pos < text_size; pos++) {
+    if (isspace((unsigned char)text[pos]))
+      continue;
+
+    hi = hex_nibble(text[pos]);
+    lo = (pos + 1 < text_size) ? hex_nibble(text[pos + 1]) : -1;
+    if (hi < 0 || lo < 0) {
+      mxt_err(ctx, "Invalid hex data at offset %zu", pos);
+      ret = MXT_ERROR_FILE_FORMAT;
+      goto fail;
+    }
+
+    image->data[image->size++] = (hi << 4) | lo;
+    pos++;
+  }
+
+  free(text);
+  text = NULL;
+
+  /* Index frames */
+  for (offset = 0; offset < image->size; offset += frame_size) {
+    if (offset + 2 > image->size) {
+      mxt_err(ctx, "Unexpected end of firmware file");
+      ret = MXT_ERROR_FILE_FORMAT;
+      goto fail;
+    }
+
+    /* Allow for CRC bytes at end of frame */
+    frame_size = ((image->data[offset] << 8) | image->data[offset + 1]) + 2;
+
+    if (frame_size > FIRMWARE_BUFFER_SIZE) {
+      mxt_err(ctx, "Frame %d too big", image->num_frames + 1);
+      ret = MXT_ERROR_FILE_FORMAT;
+      goto fail;
+    }
+
+    if (offset + frame_size > image->size) {
+      mxt_err(ctx, "Unexpected end of firmware file");
+      ret = MXT_ERROR_FILE_FORMAT;
+      goto fail;
+    }
+
+    image->num_frames++;
+  }
 
-  if (feof(fw->fp)) return EOF;
+  if (image->num_frames == 0) {
+    mxt_err(ctx, "No frames in firmware file");
+    ret = MXT_ERROR_FILE_FORMAT;
+    goto fail;
+  }
+
+  image->frames = calloc(image->num_frames, sizeof(struct fw_frame));
+  if (!image->frames) {
+    ret = MXT_ERROR_NO_MEM;
+    goto fail;
+  }
+
+  offset = 0;
+  for (hi = 0; hi < image->num_frames; hi++) {
+    image->frames[hi].offset = offset;
+    image->frames[hi].size = ((image->data[offset] << 8) | image->data[offset + 1]) + 2;
+    offset += image->frames[hi].size;
+  }
 
-  ret = sscanf(str, "%x", &val);
+  mxt_info(ctx, "Firmware image %zu bytes in %d frames", image->size, image->num_frames);
 
-  *ptr =  val;
+  return MXT_SUCCESS;
 
+fail:
+  free(text);
+  mxt_free_firmware(image);
   return ret;
 }
 
@@ -267,15 +444,14 @@ static int get_hex_value(struct flash_context *fw, unsigned char *ptr)
 /// \return #mxt_rc
 static int send_frames(struct flash_context *fw)
 {
-  unsigned char buffer[FIRMWARE_BUFFER_SIZE];
+  const struct fw_image *image = fw->image;
+  const struct fw_frame *f;
   uint8_t last_percent = 100;
   uint8_t cur_percent = 0;
   int ret;
-  int i;
-  int frame_size = 0;
   int frame;
   int frame_retry = 0;
-  int bytes_sent = 0;
+  size_t bytes_sent = 0;
 
   fw->have_bootloader_version = false;
   fw->extended_id_mode = false;
@@ -300,41 +476,13 @@ static int send_frames(struct flash_context *fw)
 
   mxt_info(fw->ctx, "Sending frames...");
 
-  frame = 1;
-
-  while (!feof(fw->fp)) {
-    if (frame_retry == 0) {
-      if (get_hex_value(fw, &buffer[0]) == EOF) {
-        mxt_info(fw->ctx, "End of file");
-        break;
-      }
-
-      if (get_hex_value(fw, &buffer[1]) == EOF) {
-        mxt_err(fw->ctx, "Unexpected end of firmware file");
-        return MXT_ERROR_FILE_FORMAT;
-      }
-
-      frame_size = (buffer[0] << 8) | buffer[1];
-
-      mxt_dbg(fw->ctx, "Frame %d: size %d", frame, frame_size);
-
-      /* Allow for CRC bytes at end of frame */
-      frame_size += 2;
+  frame = 0;
 
-      if (frame_size > FIRMWARE_BUFFER_SIZE) {
-        mxt_err(fw->ctx, "Frame too big");
-        return MXT_ERROR_NO_MEM;
-      }
-
-      for (i = 2; i < frame_size; i++) {
-        ret = get_hex_value(fw, &buffer[i]);
+  while (frame < image->num_frames) {
+    f = &image->frames[frame];
 
-        if (ret == EOF) {
-          mxt_err(fw->ctx, "Unexpected end of firmware file");
-          return MXT_ERROR_FILE_FORMAT;
-        }
-      }
-    }
+    if (frame_retry == 0)
+      mxt_dbg(fw->ctx, "Frame %d: size %d", frame + 1, f->size - 2);
 
     if (mxt_check_bootloader(fw, MXT_WAITING_FRAME_DATA) < 0) {
       mxt_err(fw->ctx, "Unexpected bootloader state");
@@ -342,7 +490,7 @@ static int send_frames(struct flash_context *fw)
     }
 
     /* Write one frame to device */
-    ret = mxt_bootloader_write(fw->mxt, buffer, frame_size);
+    ret = mxt_bootloader_write(fw->mxt, image->data + f->offset, f->size);
     if (ret)
       return ret;
 
@@ -351,11 +499,11 @@ static int send_frames(struct flash_context *fw)
     ret = mxt_check_bootloader(fw, MXT_FRAME_CRC_PASS);
     if (ret == MXT_ERROR_BOOTLOADER_FRAME_CRC_FAIL) {
       if (frame_retry > 0) {
-        mxt_err(fw->ctx, "Failure sending frame %d - aborting", frame);
+        mxt_err(fw->ctx, "Failure sending frame %d - aborting", frame + 1);
         return MXT_ERROR_BOOTLOADER_FRAME_CRC_FAIL;
       } else {
         frame_retry++;
-        mxt_err(fw->ctx, "Frame %d: CRC fail, retry %d", frame, frame_retry);
+        mxt_err(fw->ctx, "Frame %d: CRC fail, retry %d", frame + 1, frame_retry);
       }
     } else if (ret) {
       mxt_err(fw->ctx, "Unexpected bootloader state");
@@ -364,21 +512,29 @@ static int send_frames(struct flash_context *fw)
       mxt_verb(fw->ctx, "CRC pass");
       frame_retry = 0;
       frame++;
-      bytes_sent += frame_size;
-      cur_percent = (unsigned char)(0.5f + (100.0 * ftell(fw->fp)) / fw->file_size);
+      bytes_sent += f->size;
+      cur_percent = (unsigned char)(0.5f + (100.0 * bytes_sent) / image->size);
 
       /* Display at 10% or difference is greater than 10% */
       if (cur_percent % 10 == 0 || (cur_percent - last_percent) > 10) {
         /* No need to repeat for the same percentage */
         if (last_percent != cur_percent) {
-          mxt_info(fw->ctx, "Sent %d frames, %d bytes. % 3d%%", frame, bytes_sent, cur_percent);
+          mxt_info(fw->ctx, "Sent %d frames, %zu bytes. % 3d%%", frame, bytes_sent, cur_percent);
           last_percent = cur_percent;
+
+          if (fw->worker) {
+            pthread_mutex_lock(&flash_progress_lock);
+            fw->worker->percent = cur_percent;
+            printf("%s: %3d%%\n", fw->worker->name, cur_percent);
+            fflush(stdout);
+            pthread_mutex_unlock(&flash_progress_lock);
+          }
         }
       }
     }
   }
 
-  fclose(fw->fp);
+  mxt_info(fw->ctx, "End of firmware image");
 
   return MXT_SUCCESS;
 }
@@ -461,6 +617,7 @@ static int mxt_bootloader_init_chip(struct flash_context *fw)
     break;
 
   case E_HIDRAW:
+  case E_MOCK:
     mxt_err(fw->ctx, "Device type not supported");
 
     return MXT_ERROR_NOT_SUPPORTED;
@@ -571,11 +728,24 @@ static int mxt_enter_bootloader_mode(struct flash_context *fw)
 }
 
 //******************************************************************************
-/// \brief  Flash firmware to chip
-int mxt_flash_firmware(struct libmaxtouch_ctx *ctx,
-                       struct mxt_device *maxtouch,
-                       const char *filename, const char *new_version,
-                       struct mxt_conn_info *conn)
+/// \brief  Open CHG line for bootloader pacing if one was given
+static void mxt_bootloader_open_chg(struct flash_context *fw)
+{
+  if (fw->ctx->chg_gpio_line < 0)
+    return;
+
+  if (gpio_chg_open(fw->mxt, fw->ctx->chg_gpio_chip, fw->ctx->chg_gpio_line))
+    mxt_warn(fw->ctx, "CHG line not available, using fixed delay");
+}
+
+//******************************************************************************
+/// \brief  Flash decoded firmware image to chip
+static int mxt_flash_image(struct libmaxtouch_ctx *ctx,
+                           struct mxt_device *maxtouch,
+                           const struct fw_image *image,
+                           const char *new_version,
+                           struct mxt_conn_info *conn,
+                           struct flash_worker *worker)
 {
   struct flash_context fw = { 0 };
   int ret;
@@ -583,17 +753,8 @@ int mxt_flash_firmware(struct libmaxtouch_ctx *ctx,
   fw.ctx = ctx;
   fw.mxt = maxtouch;
   fw.conn = conn;
-
-  mxt_info(fw.ctx, "Opening firmware file %s", filename);
-
-  fw.fp = fopen(filename, "r");
-  if (!fw.fp) {
-    mxt_err(fw.ctx, "Cannot open firmware file %s!", filename);
-    return mxt_errno_to_rc(errno);
-  }
-  fseek(fw.fp, 0L, SEEK_END);
-  fw.file_size = ftell(fw.fp);
-  rewind(fw.fp);
+  fw.image = image;
+  fw.worker = worker;
 
   ret = mxt_bootloader_init_chip(&fw);
   if (ret && (ret != MXT_DEVICE_IN_BOOTLOADER))
@@ -632,6 +793,8 @@ int mxt_flash_firmware(struct libmaxtouch_ctx *ctx,
       return ret;
     }
 
+  mxt_bootloader_open_chg(&fw);
+
   ret = send_frames(&fw);
   if (ret)
     return ret;
@@ -717,7 +880,10 @@ int mxt_flash_firmware(struct libmaxtouch_ctx *ctx,
   }
 #endif
 
+  /* Info block verify runs as one session rather than toggling per read */
+  mxt_session_begin(fw.mxt);
   ret = mxt_get_info(fw.mxt);
+  mxt_session_end(fw.mxt);
   if (ret) {
     mxt_err(fw.ctx, "Failed to get info block");
     goto release;
@@ -745,6 +911,143 @@ release:
   return ret;
 }
 
+//******************************************************************************
+/// \brief  Flash firmware to chip
+int mxt_flash_firmware(struct libmaxtouch_ctx *ctx,
+                       struct mxt_device *maxtouch,
+                       const char *filename, const char *new_version,
+                       struct mxt_conn_info *conn)
+{
+  struct fw_image image;
+  int ret;
+
+  ret = mxt_load_firmware(ctx, filename, &image);
+  if (ret)
+    return ret;
+
+  ret = mxt_flash_image(ctx, maxtouch, &image, new_version, conn, NULL);
+
+  mxt_free_firmware(&image);
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief  Flash one device of a multi-device run
+static void *flash_worker_thread(void *arg)
+{
+  struct flash_worker *worker = arg;
+  struct timespec start, end;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  worker->ret = mxt_flash_image(worker->ctx, NULL, worker->image,
+                                worker->new_version, worker->conn, worker);
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  worker->elapsed = (end.tv_sec - start.tv_sec)
+                    + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+  return NULL;
+}
+
+//******************************************************************************
+/// \brief  Flash firmware to several devices concurrently
+/// \note   Each worker has its own library context so that log buffers and
+///         USB state are not shared between threads
+/// \return #mxt_rc
+int mxt_flash_firmware_multi(struct libmaxtouch_ctx *ctx,
+                             struct mxt_conn_info **conns, const char **names,
+                             int count, const char *filename,
+                             const char *new_version)
+{
+  struct flash_worker workers[MXT_FLASH_MAX_DEVICES];
+  struct fw_image image;
+  struct timespec start, end;
+  int started = 0;
+  int passed = 0;
+  int ret;
+  int i;
+
+  if (count > MXT_FLASH_MAX_DEVICES)
+    return MXT_ERROR_BAD_INPUT;
+
+  ret = mxt_load_firmware(ctx, filename, &image);
+  if (ret)
+    return ret;
+
+  memset(workers, 0, sizeof(workers));
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (i = 0; i < count; i++) {
+    struct flash_worker *w = &workers[i];
+
+    w->conn = conns[i];
+    w->name = names[i];
+    w->image = &image;
+    w->new_version = new_version;
+    w->ret = MXT_ERROR_NO_DEVICE;
+
+    ret = mxt_new(&w->ctx);
+    if (ret) {
+      w->ret = ret;
+      mxt_unref_conn(w->conn);
+      continue;
+    }
+
+    w->ctx->log_level = ctx->log_level;
+    w->ctx->log_fn = ctx->log_fn;
+    w->ctx->i2c_block_size = ctx->i2c_block_size;
+    w->ctx->reopen_fd = ctx->reopen_fd;
+
+    ret = pthread_create(&w->thread, NULL, flash_worker_thread, w);
+    if (ret) {
+      mxt_err(ctx, "%s: could not start worker, error %s (%d)",
+              w->name, strerror(ret), ret);
+      w->ret = MXT_ERROR_NO_MEM;
+      mxt_free(w->ctx);
+      w->ctx = NULL;
+      mxt_unref_conn(w->conn);
+      continue;
+    }
+
+    started++;
+  }
+
+  mxt_info(ctx, "Flashing %d devices", started);
+
+  for (i = 0; i < count; i++) {
+    if (!workers[i].ctx)
+      continue;
+
+    pthread_join(workers[i].thread, NULL);
+    mxt_free(workers[i].ctx);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  mxt_free_firmware(&image);
+
+  printf("Flash summary:\n");
+  for (i = 0; i < count; i++) {
+    struct flash_worker *w = &workers[i];
+
+    if (w->ret == MXT_SUCCESS || w->ret == MXT_FIRMWARE_UPDATE_NOT_REQUIRED) {
+      passed++;
+      printf("  %-24s %s  %.1f s\n", w->name,
+             (w->ret == MXT_SUCCESS) ? "PASS" : "SKIP", w->elapsed);
+    } else {
+      printf("  %-24s FAIL  %.1f s (error %d)\n", w->name, w->elapsed, w->ret);
+    }
+  }
+
+  printf("%d of %d devices passed in %.1f s\n", passed, count,
+         (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+
+  return (passed == count) ? MXT_SUCCESS : MXT_ERROR_FIRMWARE_UPDATE_FAILED;
+}
+
 //******************************************************************************
 /// \brief  Bootloader version query
 int mxt_bootloader_version(struct libmaxtouch_ctx *ctx, struct mxt_device *mxt, struct mxt_conn_info *conn)
@@ -778,6 +1081,8 @@ int mxt_bootloader_version(struct libmaxtouch_ctx *ctx, struct mxt_device *mxt,
     goto release;
   }
 
+  mxt_bootloader_open_chg(&fw);
+
   ret = mxt_check_bootloader(&fw, MXT_WAITING_BOOTLOAD_CMD);
   if (ret)
     goto release;
@@ -42,6 +42,9 @@
 #include <netdb.h>
 #include <inttypes.h>
 #include <poll.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
 
 #include "libmaxtouch/libmaxtouch.h"
 #include "libmaxtouch/log.h"
@@ -52,104 +55,392 @@
 
 #define MAX_LINESIZE 12000
 
+#define MXT_ADB_CLIENT_MSG_PREFIX "MSG "
+
+/* Binary protocol, selected by sending "PROTO BIN" in ASCII mode. Each frame
+ * is a type byte, a little-endian 16-bit payload length, then the payload.
+ * Responses have the request type with bit 7 set and a leading status byte */
+#define BRIDGE_BIN_HDR_SIZE     3
+#define BRIDGE_BIN_MAX_PAYLOAD  0xffff
+#define BRIDGE_BIN_REA          0x01 /* address(2) count(2) */
+#define BRIDGE_BIN_WRI          0x02 /* address(2) data */
+#define BRIDGE_BIN_RST          0x03 /* reset time(2) */
+#define BRIDGE_BIN_MSGCFG       0x04
+#define BRIDGE_BIN_T37_START    0x05 /* mode(1) instance(1) */
+#define BRIDGE_BIN_T37_STOP     0x06
+#define BRIDGE_BIN_RESPONSE     0x80
+#define BRIDGE_BIN_MSG          0x90 /* size(1) data, repeated */
+#define BRIDGE_BIN_CDT          0x91
+#define BRIDGE_BIN_T37_FRAME    0x92 /* frame(4) timestamp_us(8) values(2 each) */
+#define BRIDGE_BIN_UNKNOWN      0xff
+#define BRIDGE_BIN_STATUS_OK    0x00
+#define BRIDGE_BIN_STATUS_ERR   0x01
+
+#define BRIDGE_T37_FRAME_HDR    12
+
+#define BRIDGE_RX_SIZE   (BRIDGE_BIN_HDR_SIZE + BRIDGE_BIN_MAX_PAYLOAD + 1)
+#define BRIDGE_TX_SIZE   (BRIDGE_BIN_HDR_SIZE + MXT_MSG_BATCH_SIZE * \
+                          (sizeof(MXT_ADB_CLIENT_MSG_PREFIX) + MXT_MSG_MAX_SIZE * 2))
+
+/* Server limits */
+#define BRIDGE_MAX_CLIENTS      8
+#define BRIDGE_CLIENT_QUEUE     1024 /* messages held per client */
+#define BRIDGE_DRAIN_INTERVAL   25   /* milliseconds */
+
 struct bridge_context {
   int sockfd;
   bool msgs_enabled;
+  bool binary;
+  bool closed;
+  uint8_t eol_pending; /* second half of a line end split across reads */
+  struct mxt_buffer rx;
+  uint8_t *tx;
+  size_t tx_len;
+  size_t tx_pos;
+
+  /* Server mode responses, written without blocking after any partial
+   * message batch in tx */
+  bool server;
+  struct mxt_buffer out;
+
+  /* Server mode message queue, oldest entries dropped when full */
+  struct mxt_msg *queue;
+  int queue_head;
+  int queue_count;
+  unsigned long dropped;
+  bool want_write;
+
+  /* Diagnostic frame stream */
+  struct t37_ctx *t37;
+  uint8_t *t37_frame;
+  uint32_t t37_count;
 };
 
+static const char hex_chars[] = "0123456789ABCDEF";
+
+/* Only one connection may drive T37 at a time */
+static struct bridge_context *t37_owner;
 
 //******************************************************************************
-/// \brief Read command on a single line
-/// \return #mxt_rc
-static int readline(struct mxt_device *mxt, int fd, struct mxt_buffer *linebuf)
+/// \brief Send vector to socket, resuming after partial writes
+/// \return number of bytes written, or -1 with errno set
+static ssize_t bridge_sendv(int fd, struct iovec *iov, int iovcnt, int flags)
 {
-  int ret;
-  int n;
-  int readcount;
-  char c;
+  struct msghdr msg;
+  ssize_t written;
+  ssize_t total = 0;
 
-  mxt_buf_reset(linebuf);
+  while (iovcnt > 0) {
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iovcnt;
 
-  for (n = 1; n < MAX_LINESIZE; n++) {
-    /* read 1 character at a time */
-    readcount = read(fd, &c, 1);
-    if (readcount == 1) {
-      if ((c == '\n') || (c == '\r'))
-        break;
+    written = sendmsg(fd, &msg, flags | MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
 
-      ret = mxt_buf_add(linebuf, c);
-      if (ret)
-        return ret;
-    } else if (readcount == 0) {
-      if (n == 1)
-        return MXT_SUCCESS;
-      else
-        break;
-    } else {
-      mxt_err(mxt->ctx, "Read error: %s (%d)", strerror(errno), errno);
-      return mxt_errno_to_rc(errno);
+      return (total > 0 && errno == EAGAIN) ? total : -1;
+    }
+
+    total += written;
+
+    while (iovcnt > 0 && (size_t)written >= iov->iov_len) {
+      written -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+
+    if (iovcnt > 0) {
+      iov->iov_base = (uint8_t *)iov->iov_base + written;
+      iov->iov_len -= written;
     }
   }
 
-  /* null-terminate the buffer */
-  ret = mxt_buf_add(linebuf, '\0');
-  if (ret)
-    return ret;
+  return total;
+}
+
+//******************************************************************************
+/// \brief Write any queued message output before a command response
+/// \return 0 on success, or -1 with errno set
+static int bridge_flush_pending(struct bridge_context *bridge_ctx)
+{
+  struct iovec iov;
+
+  if (bridge_ctx->tx_pos >= bridge_ctx->tx_len)
+    return 0;
+
+  iov.iov_base = bridge_ctx->tx + bridge_ctx->tx_pos;
+  iov.iov_len = bridge_ctx->tx_len - bridge_ctx->tx_pos;
+
+  if (bridge_sendv(bridge_ctx->sockfd, &iov, 1, 0) < 0)
+    return -1;
+
+  bridge_ctx->tx_pos = bridge_ctx->tx_len = 0;
+  return 0;
+}
+
+//******************************************************************************
+/// \brief Add vector to server client output, written later from the loop
+/// \return 0 on success, or -1 with errno set
+static int bridge_queue_output(struct bridge_context *client,
+                               const struct iovec *iov, int iovcnt)
+{
+  int i;
+
+  for (i = 0; i < iovcnt; i++) {
+    if (mxt_buf_append(&client->out, iov[i].iov_base, iov[i].iov_len)) {
+      errno = ENOMEM;
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+//******************************************************************************
+/// \brief Write vector to socket after any pending message output
+/// \return 0 on success, or -1 with errno set
+static int bridge_output(struct bridge_context *bridge_ctx,
+                         struct iovec *iov, int iovcnt)
+{
+  if (bridge_ctx->server)
+    return bridge_queue_output(bridge_ctx, iov, iovcnt);
+
+  if (bridge_flush_pending(bridge_ctx) < 0
+      || bridge_sendv(bridge_ctx->sockfd, iov, iovcnt, 0) < 0)
+    return -1;
+
+  return 0;
+}
+
+//******************************************************************************
+/// \brief Write buffer to socket
+/// \return number of bytes written, or -1 with errno set
+static ssize_t bridge_send(struct bridge_context *bridge_ctx, const void *buf,
+                           size_t len)
+{
+  struct iovec iov;
+
+  iov.iov_base = (void *)buf;
+  iov.iov_len = len;
+
+  if (bridge_output(bridge_ctx, &iov, 1) < 0)
+    return -1;
+
+  return len;
+}
+
+//******************************************************************************
+/// \brief Write vector to socket after any pending message output
+/// \return #mxt_rc
+static int bridge_writev(struct mxt_device *mxt, struct bridge_context *bridge_ctx,
+                         struct iovec *iov, int iovcnt)
+{
+  if (bridge_output(bridge_ctx, iov, iovcnt) < 0) {
+    mxt_err(mxt->ctx, "Socket write error: %s (%d)", strerror(errno), errno);
+    return mxt_errno_to_rc(errno);
+  }
 
   return MXT_SUCCESS;
 }
 
-#define MXT_ADB_CLIENT_MSG_PREFIX "MSG "
+//******************************************************************************
+/// \brief Send binary response frame with status byte and optional data
+/// \return #mxt_rc
+static int bridge_send_response(struct mxt_device *mxt,
+                                struct bridge_context *bridge_ctx,
+                                uint8_t type, uint8_t status,
+                                const uint8_t *data, uint16_t len)
+{
+  uint8_t hdr[BRIDGE_BIN_HDR_SIZE + 1];
+  struct iovec iov[2];
+
+  hdr[0] = type;
+  hdr[1] = (len + 1) & 0xff;
+  hdr[2] = (len + 1) >> 8;
+  hdr[3] = status;
+
+  iov[0].iov_base = hdr;
+  iov[0].iov_len = sizeof(hdr);
+  iov[1].iov_base = (void *)data;
+  iov[1].iov_len = data ? len : 0;
+
+  return bridge_writev(mxt, bridge_ctx, iov, 2);
+}
+
+//******************************************************************************
+/// \brief Encode batch of messages into the output buffer
+/// \note  tx must be empty, the batch is sent later as a single write
+static void bridge_encode_msgs(struct bridge_context *bridge_ctx,
+                               const struct mxt_msg *msgs, int count)
+{
+  uint8_t *out = bridge_ctx->tx;
+  size_t len;
+  int i, j;
+
+  if (bridge_ctx->binary)
+    out += BRIDGE_BIN_HDR_SIZE;
+
+  for (i = 0; i < count; i++) {
+    if (bridge_ctx->binary) {
+      *out++ = msgs[i].size;
+      memcpy(out, msgs[i].data, msgs[i].size);
+      out += msgs[i].size;
+    } else {
+      memcpy(out, MXT_ADB_CLIENT_MSG_PREFIX, strlen(MXT_ADB_CLIENT_MSG_PREFIX));
+      out += strlen(MXT_ADB_CLIENT_MSG_PREFIX);
+
+      for (j = 0; j < msgs[i].size; j++) {
+        *out++ = hex_chars[msgs[i].data[j] >> 4];
+        *out++ = hex_chars[msgs[i].data[j] & 0xf];
+      }
+
+      *out++ = '\n';
+    }
+  }
+
+  len = out - bridge_ctx->tx;
+
+  if (bridge_ctx->binary) {
+    bridge_ctx->tx[0] = BRIDGE_BIN_MSG;
+    bridge_ctx->tx[1] = (len - BRIDGE_BIN_HDR_SIZE) & 0xff;
+    bridge_ctx->tx[2] = (len - BRIDGE_BIN_HDR_SIZE) >> 8;
+  }
+
+  bridge_ctx->tx_pos = 0;
+  bridge_ctx->tx_len = len;
+}
 
 //******************************************************************************
 /// \brief Read MXT messages and send them to other end
+/// \note  All messages from one batch are sent with a single write
 /// \return #mxt_rc
 static int handle_messages(struct mxt_device *mxt, struct bridge_context *bridge_ctx)
 {
-  int msg_count, length;
+  struct mxt_msg msgs[MXT_MSG_BATCH_SIZE];
+  int msg_count;
   int ret;
-  int i, j;
-
-  unsigned char databuf[20];
 
   if (!bridge_ctx->msgs_enabled)
     return MXT_SUCCESS;
 
-  ret = mxt_get_msg_count(mxt, &msg_count);
+  ret = mxt_get_msgs_batch(mxt, msgs, MXT_MSG_BATCH_SIZE, &msg_count);
   if (ret)
     return ret;
 
-  for (i = 0; i < msg_count; i++) {
-    int num_bytes;
-    ret = mxt_get_msg_bytes(mxt, databuf, sizeof(databuf), &num_bytes);
-    if (ret == MXT_ERROR_NO_MESSAGE)
-      continue;
-    else if (ret)
-      return ret;
+  if (msg_count == 0)
+    return MXT_SUCCESS;
 
-    length = snprintf(mxt->msg_string, sizeof(mxt->msg_string),
-                      MXT_ADB_CLIENT_MSG_PREFIX);
+  bridge_encode_msgs(bridge_ctx, msgs, msg_count);
 
-    for (j = 0; j < num_bytes; j++) {
-      length += snprintf(mxt->msg_string + length,
-                         sizeof(mxt->msg_string) - length,
-                         "%02X", databuf[j]);
-    }
+  if (bridge_flush_pending(bridge_ctx) < 0) {
+    mxt_err(mxt->ctx, "Write failure: %s (%d)", strerror(errno), errno);
+    return mxt_errno_to_rc(errno);
+  }
 
-    ret = write(bridge_ctx->sockfd, mxt->msg_string, strlen(mxt->msg_string));
-    if (ret < 0) {
-      mxt_err(mxt->ctx, "Write failure: %s (%d)", strerror(errno), errno);
-      return mxt_errno_to_rc(ret);
-    }
+  return MXT_SUCCESS;
+}
 
-    ret = write(bridge_ctx->sockfd, "\n", 1);
-    if (ret < 0) {
-      mxt_err(mxt->ctx, "Write failure: %s (%d)", strerror(errno), errno);
-      return mxt_errno_to_rc(ret);
+//******************************************************************************
+/// \brief Add messages to client queue, dropping the oldest when full
+static void bridge_queue_msgs(struct mxt_device *mxt,
+                              struct bridge_context *client,
+                              const struct mxt_msg *msgs, int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++) {
+    if (client->queue_count == BRIDGE_CLIENT_QUEUE) {
+      client->queue_head = (client->queue_head + 1) % BRIDGE_CLIENT_QUEUE;
+      client->queue_count--;
+
+      if (client->dropped++ == 0)
+        mxt_warn(mxt->ctx, "Client %d too slow, dropping messages",
+                 client->sockfd);
     }
+
+    client->queue[(client->queue_head + client->queue_count) % BRIDGE_CLIENT_QUEUE]
+      = msgs[i];
+    client->queue_count++;
   }
+}
 
-  return MXT_SUCCESS;
+//******************************************************************************
+/// \brief Write as much of buffer as the socket takes without blocking
+/// \return number of bytes written, 0 if the socket is full, or -1 with errno
+///         set
+static ssize_t bridge_send_nonblock(int fd, void *buf, size_t len)
+{
+  struct iovec iov;
+  ssize_t written;
+
+  iov.iov_base = buf;
+  iov.iov_len = len;
+
+  written = bridge_sendv(fd, &iov, 1, MSG_DONTWAIT);
+  if (written < 0 && errno == EAGAIN)
+    return 0;
+
+  return written;
+}
+
+//******************************************************************************
+/// \brief Send partial batch, queued responses, then queued messages to client
+///        without blocking
+/// \return #mxt_rc
+static int bridge_flush_queue(struct mxt_device *mxt,
+                              struct bridge_context *client)
+{
+  ssize_t written;
+  int count;
+
+  while (true) {
+    if (client->tx_pos < client->tx_len) {
+      written = bridge_send_nonblock(client->sockfd, client->tx + client->tx_pos,
+                                     client->tx_len - client->tx_pos);
+      if (written < 0) {
+        mxt_dbg(mxt->ctx, "Write failure: %s (%d)", strerror(errno), errno);
+        return mxt_errno_to_rc(errno);
+      }
+
+      client->tx_pos += written;
+      if (client->tx_pos < client->tx_len) {
+        client->want_write = true;
+        return MXT_SUCCESS;
+      }
+
+      client->tx_pos = client->tx_len = 0;
+    } else if (client->out.size > 0) {
+      written = bridge_send_nonblock(client->sockfd, client->out.data,
+                                     client->out.size);
+      if (written < 0) {
+        mxt_dbg(mxt->ctx, "Write failure: %s (%d)", strerror(errno), errno);
+        return mxt_errno_to_rc(errno);
+      }
+
+      mxt_buf_consume(&client->out, written);
+      if (client->out.size > 0) {
+        client->want_write = true;
+        return MXT_SUCCESS;
+      }
+    } else if (client->queue_count > 0) {
+      /* Encode up to the end of the ring, wrapped part goes next time */
+      count = BRIDGE_CLIENT_QUEUE - client->queue_head;
+      if (count > client->queue_count)
+        count = client->queue_count;
+      if (count > MXT_MSG_BATCH_SIZE)
+        count = MXT_MSG_BATCH_SIZE;
+
+      bridge_encode_msgs(client, client->queue + client->queue_head, count);
+
+      client->queue_head = (client->queue_head + count) % BRIDGE_CLIENT_QUEUE;
+      client->queue_count -= count;
+    } else {
+      client->want_write = false;
+      return MXT_SUCCESS;
+    }
+  }
 }
 
 //******************************************************************************
@@ -194,7 +485,7 @@ static int bridge_rea_cmd(struct mxt_device *mxt, struct bridge_context *bridge_
     response[response_len - 1] = '\n';
   }
 
-  ret = write(bridge_ctx->sockfd, response, response_len);
+  ret = bridge_send(bridge_ctx, response, response_len);
   if (ret < 0) {
     mxt_err(mxt->ctx, "Socket write error: %s (%d)", strerror(errno), errno);
     ret = mxt_errno_to_rc(errno);
@@ -242,7 +533,7 @@ static int bridge_wri_cmd(struct mxt_device *mxt, struct bridge_context *bridge_
     }
   }
 
-  ret = write(bridge_ctx->sockfd, response, strlen(response));
+  ret = bridge_send(bridge_ctx, response, strlen(response));
   if (ret < 0) {
     mxt_err(mxt->ctx, "Socket write error: %s (%d)", strerror(errno), errno);
     ret = mxt_errno_to_rc(errno);
@@ -294,7 +585,7 @@ static int bridge_handle_reset(struct mxt_device *mxt,
     response_len = strlen(response);
   }
 
-  ret = write(bridge_ctx->sockfd, response, response_len);
+  ret = bridge_send(bridge_ctx, response, response_len);
   if (ret < 0) {
     mxt_err(mxt->ctx, "Socket write error: %s (%d)", strerror(errno), errno);
     ret = mxt_errno_to_rc(errno);
@@ -322,7 +613,7 @@ static int bridge_info_version(struct mxt_device *mxt, struct bridge_context *br
     return MXT_ERROR_NO_MEM;
   }
 
-  ret = write(bridge_ctx->sockfd, outstr, strlen(outstr));
+  ret = bridge_send(bridge_ctx, outstr, strlen(outstr));
   if (ret < 0) {
     mxt_err(mxt->ctx, "Socket write error: %s (%d)", strerror(errno), errno);
     ret = mxt_errno_to_rc(errno);
@@ -370,6 +661,10 @@ static int bridge_info_connection(struct mxt_device *mxt, struct bridge_context
   case E_HIDRAW:
     typestring = "HIDI2C";
     break;
+
+  case E_MOCK:
+    typestring = "MOCK";
+    break;
   }
 
   ret = asprintf(&outstr, "INFO CONNECTION %s %X %04X %04X\n",
@@ -379,7 +674,7 @@ static int bridge_info_connection(struct mxt_device *mxt, struct bridge_context
     return MXT_ERROR_NO_MEM;
   }
 
-  ret = write(bridge_ctx->sockfd, outstr, strlen(outstr));
+  ret = bridge_send(bridge_ctx, outstr, strlen(outstr));
   if (ret < 0) {
     mxt_err(mxt->ctx, "Socket write error: %s (%d)", strerror(errno), errno);
     ret = mxt_errno_to_rc(errno);
@@ -414,15 +709,13 @@ static int bridge_info_cmd(struct mxt_device *mxt, struct bridge_context *bridge
 /// \return #mxt_rc
 static int send_chip_attach(struct mxt_device *mxt, struct bridge_context *bridge_ctx)
 {
-  int ret;
   const char * const msg = "CAT\n";
 
   mxt_dbg(mxt->ctx, "Sending chip attach");
 
-  ret = write(bridge_ctx->sockfd, msg, strlen(msg));
-  if (ret < 0) {
+  if (bridge_send(bridge_ctx, msg, strlen(msg)) < 0) {
     mxt_err(mxt->ctx, "Socket write error: %s (%d)", strerror(errno), errno);
-    ret = mxt_errno_to_rc(errno);
+    return mxt_errno_to_rc(errno);
   }
 
   return MXT_SUCCESS;
@@ -437,7 +730,15 @@ static int send_chip_detach(struct mxt_device *mxt,
   int ret;
   const char * const msg = "CDT\n";
 
-  ret = write(bridge_ctx->sockfd, msg, strlen(msg));
+  if (bridge_ctx->binary) {
+    uint8_t frame[BRIDGE_BIN_HDR_SIZE] = { BRIDGE_BIN_CDT, 0, 0 };
+    struct iovec iov = { frame, sizeof(frame) };
+
+    bridge_writev(mxt, bridge_ctx, &iov, 1);
+    return MXT_SUCCESS;
+  }
+
+  ret = bridge_send(bridge_ctx, msg, strlen(msg));
   if (ret < 0) {
     mxt_err(mxt->ctx, "Socket write error: %s (%d)", strerror(errno), errno);
     ret = mxt_errno_to_rc(errno);
@@ -447,41 +748,256 @@ static int send_chip_detach(struct mxt_device *mxt,
 }
 
 //******************************************************************************
-/// \brief Read and deal with incoming command
+/// \brief Stop diagnostic frame stream
+static void bridge_t37_stop(struct bridge_context *bridge_ctx)
+{
+  if (!bridge_ctx->t37)
+    return;
+
+  mxt_dd_stream_stop(bridge_ctx->t37);
+  free(bridge_ctx->t37);
+  bridge_ctx->t37 = NULL;
+  free(bridge_ctx->t37_frame);
+  bridge_ctx->t37_frame = NULL;
+
+  if (t37_owner == bridge_ctx)
+    t37_owner = NULL;
+}
+
+//******************************************************************************
+/// \brief Start streaming diagnostic frames in given mode
 /// \return #mxt_rc
-static int handle_cmd(struct mxt_device *mxt, struct bridge_context *bridge_ctx)
+static int bridge_t37_start(struct mxt_device *mxt, struct bridge_context *bridge_ctx,
+                            uint8_t *payload, uint16_t len)
+{
+  const uint8_t response_type = BRIDGE_BIN_T37_START | BRIDGE_BIN_RESPONSE;
+  struct t37_ctx *t37;
+  uint8_t info[10];
+  int ret;
+
+  if (len != 2 || (t37_owner && t37_owner != bridge_ctx))
+    return bridge_send_response(mxt, bridge_ctx, response_type,
+                                BRIDGE_BIN_STATUS_ERR, NULL, 0);
+
+  bridge_t37_stop(bridge_ctx);
+
+  t37 = calloc(1, sizeof(struct t37_ctx));
+  if (!t37)
+    return MXT_ERROR_NO_MEM;
+
+  ret = mxt_dd_stream_start(mxt, t37, payload[0], payload[1]);
+  if (ret == MXT_SUCCESS
+      && BRIDGE_T37_FRAME_HDR + t37->data_values * 2 > BRIDGE_BIN_MAX_PAYLOAD) {
+    mxt_dd_stream_stop(t37);
+    ret = MXT_ERROR_NOT_SUPPORTED;
+  }
+
+  if (ret) {
+    free(t37);
+    mxt_warn(mxt->ctx, "T37 stream start failed");
+    return bridge_send_response(mxt, bridge_ctx, response_type,
+                                BRIDGE_BIN_STATUS_ERR, NULL, 0);
+  }
+
+  bridge_ctx->t37_frame = malloc(BRIDGE_BIN_HDR_SIZE + BRIDGE_T37_FRAME_HDR
+                                 + t37->data_values * 2);
+  if (!bridge_ctx->t37_frame) {
+    mxt_dd_stream_stop(t37);
+    free(t37);
+    return MXT_ERROR_NO_MEM;
+  }
+
+  bridge_ctx->t37 = t37;
+  bridge_ctx->t37_count = 0;
+  t37_owner = bridge_ctx;
+
+  mxt_info(mxt->ctx, "Streaming T37 mode %02X instance %d, %d values",
+           t37->mode, t37->instance, t37->data_values);
+
+  info[0] = t37->mode;
+  info[1] = (t37->self_cap ? 0x01 : 0) | (t37->active_stylus ? 0x02 : 0)
+            | (t37->t15_keyarray ? 0x04 : 0);
+  info[2] = t37->x_size & 0xff;
+  info[3] = t37->x_size >> 8;
+  info[4] = t37->y_size & 0xff;
+  info[5] = t37->y_size >> 8;
+  info[6] = t37->passes & 0xff;
+  info[7] = t37->passes >> 8;
+  info[8] = t37->data_values & 0xff;
+  info[9] = t37->data_values >> 8;
+
+  return bridge_send_response(mxt, bridge_ctx, response_type,
+                              BRIDGE_BIN_STATUS_OK, info, sizeof(info));
+}
+
+//******************************************************************************
+/// \brief Capture one diagnostic frame and send it to the stream owner
+/// \return #mxt_rc
+static int bridge_t37_send_frame(struct mxt_device *mxt,
+                                 struct bridge_context *bridge_ctx)
+{
+  struct t37_ctx *t37 = bridge_ctx->t37;
+  uint8_t *out = bridge_ctx->t37_frame;
+  struct iovec iov;
+  size_t payload;
+  uint64_t frame_time_us;
+  int ret;
+  int i;
+
+  ret = mxt_dd_stream_frame(mxt, t37);
+  if (ret) {
+    mxt_warn(mxt->ctx, "T37 stream stopped, error %d", ret);
+    bridge_t37_stop(bridge_ctx);
+    return bridge_send_response(mxt, bridge_ctx,
+                                BRIDGE_BIN_T37_STOP | BRIDGE_BIN_RESPONSE,
+                                BRIDGE_BIN_STATUS_ERR, NULL, 0);
+  }
+
+  payload = BRIDGE_T37_FRAME_HDR + t37->data_values * 2;
+
+  *out++ = BRIDGE_BIN_T37_FRAME;
+  *out++ = payload & 0xff;
+  *out++ = payload >> 8;
+
+  for (i = 0; i < 4; i++)
+    *out++ = (bridge_ctx->t37_count >> (i * 8)) & 0xff;
+
+  frame_time_us = mxt_dd_frame_wall_ns(t37) / 1000;
+  for (i = 0; i < 8; i++)
+    *out++ = (frame_time_us >> (i * 8)) & 0xff;
+
+  for (i = 0; i < t37->data_values; i++) {
+    *out++ = t37->data_buf[i] & 0xff;
+    *out++ = t37->data_buf[i] >> 8;
+  }
+
+  bridge_ctx->t37_count++;
+
+  iov.iov_base = bridge_ctx->t37_frame;
+  iov.iov_len = out - bridge_ctx->t37_frame;
+
+  return bridge_writev(mxt, bridge_ctx, &iov, 1);
+}
+
+//******************************************************************************
+/// \brief Handle binary protocol frame
+/// \return #mxt_rc
+static int handle_bin_frame(struct mxt_device *mxt, struct bridge_context *bridge_ctx,
+                            uint8_t type, uint8_t *payload, uint16_t len)
+{
+  uint8_t response_type = type | BRIDGE_BIN_RESPONSE;
+  uint8_t status = BRIDGE_BIN_STATUS_OK;
+  uint16_t address = 0;
+  uint16_t count;
+  uint8_t *databuf;
+  int ret;
+
+  if (len >= 2)
+    address = payload[0] | (payload[1] << 8);
+
+  switch (type) {
+  case BRIDGE_BIN_REA:
+    if (len != 4)
+      return bridge_send_response(mxt, bridge_ctx, response_type,
+                                  BRIDGE_BIN_STATUS_ERR, NULL, 0);
+
+    count = payload[2] | (payload[3] << 8);
+    if (count == BRIDGE_BIN_MAX_PAYLOAD)
+      return bridge_send_response(mxt, bridge_ctx, response_type,
+                                  BRIDGE_BIN_STATUS_ERR, NULL, 0);
+
+    databuf = malloc(count);
+    if (!databuf)
+      return MXT_ERROR_NO_MEM;
+
+    ret = mxt_read_register(mxt, databuf, address, count);
+    if (ret) {
+      mxt_warn(mxt->ctx, "RRP ERR");
+      ret = bridge_send_response(mxt, bridge_ctx, response_type,
+                                 BRIDGE_BIN_STATUS_ERR, NULL, 0);
+    } else {
+      ret = bridge_send_response(mxt, bridge_ctx, response_type,
+                                 BRIDGE_BIN_STATUS_OK, databuf, count);
+    }
+
+    free(databuf);
+    return ret;
+
+  case BRIDGE_BIN_WRI:
+    if (len < 2 || mxt_write_register(mxt, payload + 2, address, len - 2))
+      status = BRIDGE_BIN_STATUS_ERR;
+    break;
+
+  case BRIDGE_BIN_RST:
+    if (address < (uint16_t)(MXT_SOFT_RESET_TIME/1000))
+      address = (uint16_t)(MXT_SOFT_RESET_TIME/1000);
+
+    if (mxt_reset_chip(mxt, false, address))
+      status = BRIDGE_BIN_STATUS_ERR;
+    break;
+
+  case BRIDGE_BIN_MSGCFG:
+    mxt_info(mxt->ctx, "Configuring Messages");
+
+    if (mxt_msg_reset(mxt)) {
+      mxt_warn(mxt->ctx, "Failure to reset msgs");
+      status = BRIDGE_BIN_STATUS_ERR;
+    } else {
+      bridge_ctx->msgs_enabled = true;
+    }
+    break;
+
+  case BRIDGE_BIN_T37_START:
+    return bridge_t37_start(mxt, bridge_ctx, payload, len);
+
+  case BRIDGE_BIN_T37_STOP:
+    bridge_t37_stop(bridge_ctx);
+    break;
+
+  default:
+    mxt_warn(mxt->ctx, "UNKNOWN frame type %02X", type);
+    response_type = BRIDGE_BIN_UNKNOWN;
+    status = BRIDGE_BIN_STATUS_ERR;
+    break;
+  }
+
+  return bridge_send_response(mxt, bridge_ctx, response_type, status, NULL, 0);
+}
+
+//******************************************************************************
+/// \brief Deal with incoming ASCII command line
+/// \return #mxt_rc
+static int handle_line(struct mxt_device *mxt, struct bridge_context *bridge_ctx,
+                       char *line)
 {
   int ret;
   const char * const unknown_cmd = "UNKNOWN COMMAND\n";
   const char * const msgcfg_ok = "MSGCFG OK\n";
   const char * const msgcfg_err = "MSGCFG ERR\n";
+  const char * const proto_bin_ok = "PROTO BIN OK\n";
   const char * msgcfg_response;
   const char * const info_cmd = "INFO ";
   uint16_t address;
   uint16_t count;
-  struct mxt_buffer linebuf;
-  char *line;
   int offset;
 
-  ret = mxt_buf_init(&linebuf);
-  if (ret)
-    return ret;
+  if (strlen(line) == 0)
+    return MXT_SUCCESS;
 
-  ret = readline(mxt, bridge_ctx->sockfd, &linebuf);
-  if (ret) {
-    mxt_dbg(mxt->ctx, "Error reading or peer closed socket");
-    goto free;
-  }
+  mxt_verb(mxt->ctx, "%s", line);
 
-  line = (char *)linebuf.data;
-  if (strlen(line) == 0) {
-    ret = MXT_SUCCESS;
-    goto free;
-  }
+  if (!strcmp(line, "PROTO BIN")) {
+    mxt_info(mxt->ctx, "Switching to binary protocol");
 
-  mxt_verb(mxt->ctx, "%s", line);
+    ret = bridge_send(bridge_ctx, proto_bin_ok, strlen(proto_bin_ok));
+    if (ret < 0) {
+      mxt_err(mxt->ctx, "Socket write error: %s (%d)", strerror(errno), errno);
+      return mxt_errno_to_rc(errno);
+    }
 
-  if (!strcmp(line, "SAT")) {
+    bridge_ctx->binary = true;
+    ret = MXT_SUCCESS;
+  } else if (!strcmp(line, "SAT")) {
     mxt_info(mxt->ctx, "Server attached");
     ret = MXT_SUCCESS;
   } else if (!strcmp(line, "SDT")) {
@@ -511,7 +1027,7 @@ static int handle_cmd(struct mxt_device *mxt, struct bridge_context *bridge_ctx)
       msgcfg_response = msgcfg_ok;
     }
 
-    ret = write(bridge_ctx->sockfd, msgcfg_response, strlen(msgcfg_response));
+    ret = bridge_send(bridge_ctx, msgcfg_response, strlen(msgcfg_response));
     if (ret < 0) {
       mxt_err(mxt->ctx, "Socket write error: %s (%d)", strerror(errno), errno);
       ret = mxt_errno_to_rc(errno);
@@ -521,7 +1037,7 @@ static int handle_cmd(struct mxt_device *mxt, struct bridge_context *bridge_ctx)
   } else if (!strncmp(line, info_cmd, strlen(info_cmd))) {
     ret = bridge_info_cmd(mxt, bridge_ctx, line + strlen(info_cmd));
   } else {
-    ret = write(bridge_ctx->sockfd, unknown_cmd, strlen(unknown_cmd));
+    ret = bridge_send(bridge_ctx, unknown_cmd, strlen(unknown_cmd));
     if (ret < 0) {
       mxt_err(mxt->ctx, "Socket write error: %s (%d)", strerror(errno), errno);
       ret = mxt_errno_to_rc(errno);
@@ -531,8 +1047,96 @@ static int handle_cmd(struct mxt_device *mxt, struct bridge_context *bridge_ctx)
     ret = MXT_SUCCESS;
   }
 
-free:
-  mxt_buf_free(&linebuf);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Read available data from socket and deal with complete commands
+/// \return #mxt_rc
+static int handle_cmd(struct mxt_device *mxt, struct bridge_context *bridge_ctx)
+{
+  size_t readcount;
+  uint8_t *rx;
+  size_t rx_len;
+  size_t pos = 0;
+  size_t plen;
+  uint8_t *eol;
+  uint8_t term;
+  int ret = MXT_SUCCESS;
+
+  ret = mxt_buf_read_fd(&bridge_ctx->rx, bridge_ctx->sockfd,
+                        BRIDGE_RX_SIZE, &readcount);
+  if (ret) {
+    if (errno == EINTR || errno == EAGAIN)
+      return MXT_SUCCESS;
+
+    mxt_err(mxt->ctx, "Read error: %s (%d)", strerror(errno), errno);
+    return ret;
+  } else if (readcount == 0) {
+    mxt_dbg(mxt->ctx, "Peer closed socket");
+    bridge_ctx->closed = true;
+    return MXT_SUCCESS;
+  }
+
+  rx = bridge_ctx->rx.data;
+  rx_len = bridge_ctx->rx.size;
+
+  if (bridge_ctx->eol_pending) {
+    if (rx[0] == bridge_ctx->eol_pending)
+      pos++;
+
+    bridge_ctx->eol_pending = 0;
+  }
+
+  while (pos < rx_len) {
+    if (bridge_ctx->binary) {
+      if (rx_len - pos < BRIDGE_BIN_HDR_SIZE)
+        break;
+
+      plen = rx[pos + 1] | (rx[pos + 2] << 8);
+      if (rx_len - pos < BRIDGE_BIN_HDR_SIZE + plen)
+        break;
+
+      ret = handle_bin_frame(mxt, bridge_ctx, rx[pos],
+                             rx + pos + BRIDGE_BIN_HDR_SIZE, plen);
+      pos += BRIDGE_BIN_HDR_SIZE + plen;
+    } else {
+      for (eol = rx + pos; eol < rx + rx_len; eol++) {
+        if (*eol == '\n' || *eol == '\r')
+          break;
+      }
+
+      if (eol == rx + rx_len) {
+        if (rx_len - pos >= MAX_LINESIZE) {
+          mxt_warn(mxt->ctx, "Discarding overlong line");
+          pos = rx_len;
+        }
+        break;
+      }
+
+      term = *eol;
+      *eol = '\0';
+
+      ret = handle_line(mxt, bridge_ctx, (char *)rx + pos);
+      pos = eol - rx + 1;
+
+      /* Take CR LF or LF CR as one line end, so that after PROTO BIN the
+       * second byte is not parsed as the start of a binary frame */
+      if (pos < rx_len) {
+        if ((rx[pos] == '\r' || rx[pos] == '\n') && rx[pos] != term)
+          pos++;
+      } else if (bridge_ctx->binary) {
+        bridge_ctx->eol_pending = (term == '\r') ? '\n' : '\r';
+      }
+    }
+
+    if (ret)
+      break;
+  }
+
+  /* Keep partial command for next read */
+  mxt_buf_consume(&bridge_ctx->rx, pos);
+
   return ret;
 }
 
@@ -544,27 +1148,42 @@ static int bridge(struct mxt_device *mxt, struct bridge_context *bridge_ctx)
   int ret, pollret;
   struct pollfd fds[2];
   int fopts = 0;
-  int debug_ng_fd = 0;
   int numfds = 1;
   int timeout;
 
   fds[0].fd = bridge_ctx->sockfd;
   fds[0].events = POLLIN | POLLERR;
 
+  bridge_ctx->binary = false;
+  bridge_ctx->closed = false;
+  bridge_ctx->eol_pending = 0;
+  bridge_ctx->tx_len = 0;
+  bridge_ctx->tx_pos = 0;
+  bridge_ctx->t37 = NULL;
+  bridge_ctx->t37_frame = NULL;
+  mxt_buf_init_fixed(&bridge_ctx->rx, malloc(BRIDGE_RX_SIZE), BRIDGE_RX_SIZE);
+  bridge_ctx->tx = malloc(BRIDGE_TX_SIZE);
+  if (!bridge_ctx->rx.data || !bridge_ctx->tx) {
+    ret = MXT_ERROR_NO_MEM;
+    goto free;
+  }
+
   ret = send_chip_attach(mxt, bridge_ctx);
   if (ret)
-    return ret;
+    goto free;
 
   while (1) {
-    debug_ng_fd = mxt_get_msg_poll_fd(mxt);
-    if (debug_ng_fd) {
-      fds[1].fd = debug_ng_fd;
-      fds[1].events = POLLPRI;
+    timeout = 25; // milliseconds
+
+    fds[1].revents = 0;
+    if (mxt_get_msg_pollfd(mxt, &fds[1], &timeout))
       numfds = 2;
-      timeout = -1;
-    } else {
-      timeout = 25; // milliseconds
-    }
+    else
+      numfds = 1;
+
+    /* Frames are captured back to back while streaming */
+    if (bridge_ctx->t37)
+      timeout = 0;
 
     pollret = poll(fds, numfds, timeout);
     if (pollret == -1 && errno == EINTR) {
@@ -589,6 +1208,9 @@ static int bridge(struct mxt_device *mxt, struct bridge_context *bridge_ctx)
         mxt_err(mxt->ctx, "handle_cmd returned %d", ret);
         goto disconnect;
       }
+
+      if (bridge_ctx->closed)
+        goto disconnect;
     }
 
     /* If timeout or msg poll fd event */
@@ -599,12 +1221,23 @@ static int bridge(struct mxt_device *mxt, struct bridge_context *bridge_ctx)
         goto disconnect;
       }
     }
+
+    if (bridge_ctx->t37) {
+      ret = bridge_t37_send_frame(mxt, bridge_ctx);
+      if (ret)
+        goto disconnect;
+    }
   }
 
 disconnect:
 
   send_chip_detach(mxt, bridge_ctx);
   mxt_info(mxt->ctx, "Disconnected");
+
+free:
+  bridge_t37_stop(bridge_ctx);
+  free(bridge_ctx->rx.data);
+  free(bridge_ctx->tx);
   return ret;
 }
 
@@ -653,15 +1286,217 @@ int mxt_socket_client(struct mxt_device *mxt, char *ip_address, uint16_t port)
   return ret;
 }
 
+//******************************************************************************
+/// \brief Update epoll interest in client writes
+static void bridge_update_client_events(int epfd, struct bridge_context *client)
+{
+  struct epoll_event ev;
+
+  ev.events = EPOLLIN | (client->want_write ? EPOLLOUT : 0);
+  ev.data.ptr = client;
+  epoll_ctl(epfd, EPOLL_CTL_MOD, client->sockfd, &ev);
+}
+
+//******************************************************************************
+/// \brief Write client output without blocking, leaving the rest for EPOLLOUT
+/// \return #mxt_rc
+static int bridge_write_client(struct mxt_device *mxt, int epfd,
+                               struct bridge_context *client)
+{
+  int ret;
+
+  /* Clients already waiting for EPOLLOUT are flushed from there */
+  if (client->want_write)
+    return MXT_SUCCESS;
+
+  ret = bridge_flush_queue(mxt, client);
+  if (ret)
+    return ret;
+
+  if (client->want_write)
+    bridge_update_client_events(epfd, client);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Create client on accepted socket
+/// \return #mxt_rc
+static int bridge_add_client(struct mxt_device *mxt, int epfd, int sockfd,
+                             struct bridge_context **clients)
+{
+  struct bridge_context *client;
+  struct epoll_event ev;
+  int ret = MXT_ERROR_NO_MEM;
+  int i;
+
+  for (i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+    if (!clients[i])
+      break;
+  }
+
+  if (i == BRIDGE_MAX_CLIENTS) {
+    mxt_warn(mxt->ctx, "Too many clients, rejecting connection");
+    close(sockfd);
+    return MXT_SUCCESS;
+  }
+
+  client = calloc(1, sizeof(struct bridge_context));
+  if (!client)
+    goto fail;
+
+  client->sockfd = sockfd;
+  client->server = true;
+  mxt_buf_init_fixed(&client->rx, malloc(BRIDGE_RX_SIZE), BRIDGE_RX_SIZE);
+  client->tx = malloc(BRIDGE_TX_SIZE);
+  client->queue = calloc(BRIDGE_CLIENT_QUEUE, sizeof(struct mxt_msg));
+  if (!client->rx.data || !client->tx || !client->queue)
+    goto fail;
+
+  ev.events = EPOLLIN;
+  ev.data.ptr = client;
+  if (epoll_ctl(epfd, EPOLL_CTL_ADD, sockfd, &ev) < 0) {
+    mxt_err(mxt->ctx, "epoll_ctl error: %s (%d)", strerror(errno), errno);
+    ret = MXT_ERROR_CONNECTION_FAILURE;
+    goto fail;
+  }
+
+  ret = send_chip_attach(mxt, client);
+  if (!ret)
+    ret = bridge_write_client(mxt, epfd, client);
+
+  if (ret) {
+    epoll_ctl(epfd, EPOLL_CTL_DEL, sockfd, NULL);
+    goto fail;
+  }
+
+  clients[i] = client;
+
+  mxt_info(mxt->ctx, "Client %d connected", sockfd);
+  printf("CONNECTED\n");
+  fflush(stdout);
+
+  return MXT_SUCCESS;
+
+fail:
+  if (client) {
+    free(client->rx.data);
+    free(client->tx);
+    free(client->queue);
+    mxt_buf_free(&client->out);
+    free(client);
+  }
+  close(sockfd);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Close client connection
+static void bridge_remove_client(struct mxt_device *mxt, int epfd,
+                                 struct bridge_context **clients,
+                                 struct bridge_context *client)
+{
+  int i;
+
+  for (i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+    if (clients[i] == client)
+      clients[i] = NULL;
+  }
+
+  if (client->dropped)
+    mxt_info(mxt->ctx, "Client %d dropped %lu messages",
+             client->sockfd, client->dropped);
+
+  mxt_info(mxt->ctx, "Client %d disconnected", client->sockfd);
+  printf("DISCONNECTED\n");
+  fflush(stdout);
+
+  bridge_t37_stop(client);
+
+  epoll_ctl(epfd, EPOLL_CTL_DEL, client->sockfd, NULL);
+  close(client->sockfd);
+  free(client->rx.data);
+  free(client->tx);
+  free(client->queue);
+  mxt_buf_free(&client->out);
+  free(client);
+}
+
+//******************************************************************************
+/// \brief Read messages once and queue them for every subscribed client
+/// \return #mxt_rc
+static int bridge_drain_messages(struct mxt_device *mxt, int epfd,
+                                 struct bridge_context **clients)
+{
+  struct mxt_msg msgs[MXT_MSG_BATCH_SIZE];
+  struct bridge_context *client;
+  bool subscribed = false;
+  int msg_count;
+  int ret;
+  int i;
+
+  for (i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+    if (clients[i] && clients[i]->msgs_enabled)
+      subscribed = true;
+  }
+
+  if (!subscribed)
+    return MXT_SUCCESS;
+
+  ret = mxt_get_msgs_batch(mxt, msgs, MXT_MSG_BATCH_SIZE, &msg_count);
+  if (ret)
+    return ret;
+
+  for (i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+    client = clients[i];
+    if (!client || !client->msgs_enabled)
+      continue;
+
+    bridge_queue_msgs(mxt, client, msgs, msg_count);
+
+    if (bridge_write_client(mxt, epfd, client))
+      bridge_remove_client(mxt, epfd, clients, client);
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Get monotonic time in milliseconds
+static uint64_t bridge_time_ms(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
 //******************************************************************************
 /// \brief Bridge server
+/// \note  Serves several clients from one epoll loop. Commands are handled one
+///         at a time so register accesses are serialized onto the device,
+///         while messages are read once and fanned out to every client which
+///         has sent MSGCFG. The server keeps running when clients disconnect.
 int mxt_socket_server(struct mxt_device *mxt, uint16_t portno)
 {
   int serversock;
-  struct bridge_context bridge_ctx;
-  bridge_ctx.msgs_enabled = false;
+  struct bridge_context *clients[BRIDGE_MAX_CLIENTS] = { NULL };
+  struct bridge_context *client;
+  struct epoll_event ev;
+  struct epoll_event events[BRIDGE_MAX_CLIENTS + 2];
+  struct pollfd msg_pfd;
+  int msg_fd = -1;
+  int epfd;
   int ret;
   int one = 1;
+  int timeout;
+  int nfds;
+  int clientsock;
+  int i;
+  bool drain;
+  uint64_t last_drain = 0;
+  uint64_t now;
   struct sockaddr_in server_addr, client_addr;
   socklen_t sin_size = sizeof(client_addr);
 
@@ -694,29 +1529,139 @@ int mxt_socket_server(struct mxt_device *mxt, uint16_t portno)
   }
 
   /* Start listening */
-  ret = listen(serversock, 1);
+  ret = listen(serversock, BRIDGE_MAX_CLIENTS);
   if (ret < 0) {
     mxt_err(mxt->ctx, "Listen error: %s (%d)", strerror(errno), errno);
     close(serversock);
     return MXT_ERROR_CONNECTION_FAILURE;
   }
 
-  /* This string is used by ADB bridge client to signal it can connect */
-  printf("AWAITING_CONNECTION\n");
-  bridge_ctx.sockfd = accept(serversock, (struct sockaddr *) &client_addr, &sin_size);
-  if (bridge_ctx.sockfd < 0) {
-    mxt_err(mxt->ctx, "Accept error: %s (%d)", strerror(errno), errno);
+  epfd = epoll_create1(EPOLL_CLOEXEC);
+  if (epfd < 0) {
+    mxt_err(mxt->ctx, "epoll_create error: %s (%d)", strerror(errno), errno);
     close(serversock);
     return MXT_ERROR_CONNECTION_FAILURE;
   }
 
-  printf("CONNECTED\n");
+  /* Listening socket is identified by a NULL pointer, message fd by epfd */
+  ev.events = EPOLLIN;
+  ev.data.ptr = NULL;
+  epoll_ctl(epfd, EPOLL_CTL_ADD, serversock, &ev);
 
-  ret = bridge(mxt, &bridge_ctx);
+  /* This string is used by ADB bridge client to signal it can connect */
+  printf("AWAITING_CONNECTION\n");
+  fflush(stdout);
 
-  close(serversock);
+  while (1) {
+    timeout = BRIDGE_DRAIN_INTERVAL;
+
+    /* The message fd may be reopened between reads, so track it */
+    if (mxt_get_msg_pollfd(mxt, &msg_pfd, &timeout)) {
+      if (msg_pfd.fd != msg_fd) {
+        if (msg_fd >= 0)
+          epoll_ctl(epfd, EPOLL_CTL_DEL, msg_fd, NULL);
+
+        ev.events = ((msg_pfd.events & POLLIN) ? EPOLLIN : 0)
+                    | ((msg_pfd.events & POLLPRI) ? EPOLLPRI : 0);
+        ev.data.ptr = &epfd;
+        msg_fd = (epoll_ctl(epfd, EPOLL_CTL_ADD, msg_pfd.fd, &ev) == 0)
+                 ? msg_pfd.fd : -1;
+      }
 
-  printf("DISCONNECTED\n");
+      if (timeout < 0)
+        timeout = BRIDGE_DRAIN_INTERVAL * 40;
+    } else if (msg_fd >= 0) {
+      epoll_ctl(epfd, EPOLL_CTL_DEL, msg_fd, NULL);
+      msg_fd = -1;
+    }
+
+    /* Frames are captured back to back while streaming, as long as the
+     * client keeps up */
+    if (t37_owner && !t37_owner->want_write)
+      timeout = 0;
+
+    nfds = epoll_wait(epfd, events, BRIDGE_MAX_CLIENTS + 2, timeout);
+    if (nfds == -1 && errno == EINTR) {
+      mxt_dbg(mxt->ctx, "Interrupted");
+      continue;
+    } else if (nfds == -1) {
+      mxt_err(mxt->ctx, "epoll_wait returned %d (%s)", errno, strerror(errno));
+      ret = mxt_errno_to_rc(errno);
+      break;
+    }
+
+    drain = false;
+
+    for (i = 0; i < nfds; i++) {
+      client = events[i].data.ptr;
+
+      if (events[i].data.ptr == &epfd) {
+        drain = true;
+      } else if (!client) {
+        clientsock = accept(serversock, (struct sockaddr *) &client_addr, &sin_size);
+        if (clientsock < 0) {
+          mxt_warn(mxt->ctx, "Accept error: %s (%d)", strerror(errno), errno);
+          continue;
+        }
+
+        bridge_add_client(mxt, epfd, clientsock, clients);
+      } else {
+        if (events[i].events & EPOLLOUT) {
+          ret = bridge_flush_queue(mxt, client);
+          if (ret) {
+            bridge_remove_client(mxt, epfd, clients, client);
+            continue;
+          }
+
+          if (!client->want_write)
+            bridge_update_client_events(epfd, client);
+        }
+
+        if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+          ret = handle_cmd(mxt, client);
+          if (!ret && !client->closed)
+            ret = bridge_write_client(mxt, epfd, client);
+
+          if (ret || client->closed) {
+            bridge_remove_client(mxt, epfd, clients, client);
+            continue;
+          }
+        }
+      }
+    }
+
+    /* Drain on message signal, or at least every interval so that busy
+     * command traffic cannot starve message delivery */
+    now = bridge_time_ms();
+    if (drain || nfds == 0 || now - last_drain >= BRIDGE_DRAIN_INTERVAL) {
+      last_drain = now;
+
+      ret = bridge_drain_messages(mxt, epfd, clients);
+      if (ret) {
+        mxt_err(mxt->ctx, "handle_messages returned %d", ret);
+        break;
+      }
+    }
+
+    /* One frame per cycle, so commands from other clients are interleaved */
+    if (t37_owner && !t37_owner->want_write) {
+      client = t37_owner;
+      if (bridge_t37_send_frame(mxt, client)
+          || bridge_write_client(mxt, epfd, client))
+        bridge_remove_client(mxt, epfd, clients, client);
+    }
+  }
+
+  for (i = 0; i < BRIDGE_MAX_CLIENTS; i++) {
+    if (clients[i]) {
+      send_chip_detach(mxt, clients[i]);
+      bridge_flush_queue(mxt, clients[i]);
+      bridge_remove_client(mxt, epfd, clients, clients[i]);
+    }
+  }
+
+  close(epfd);
+  close(serversock);
 
   return ret;
 }
@@ -48,7 +48,7 @@
 //******************************************************************************
 /// \brief Set T8.CHRGTIME
 /// \return #mxt_rc
-static int set_chrgtime(struct mxt_device *mxt, struct broken_line_options *bl_opts)
+int broken_line_set_chrgtime(struct mxt_device *mxt, struct broken_line_options *bl_opts)
 {
   int ret;
   uint8_t val;
@@ -118,9 +118,9 @@ static int micro_defect_scan(struct libmaxtouch_ctx *ctx,
 //******************************************************************************
 /// \brief Perform broken line calculation
 /// \return #mxt_rc
-static int broken_line_calc(struct t37_ctx *frame,
-                            struct mxt_touchscreen_info *ts,
-                            struct broken_line_options *bl_opts)
+int broken_line_calc(struct t37_ctx *frame,
+                     struct mxt_touchscreen_info *ts,
+                     struct broken_line_options *bl_opts)
 {
   uint16_t last_x = ts->xorigin + (ts->xsize - (bl_opts->dualx ? 2 : 1));
   uint16_t last_y = ts->yorigin + (ts->ysize - 1);
@@ -225,7 +225,7 @@ int mxt_broken_line(struct mxt_device *mxt, struct broken_line_options *bl_opts)
   if (ret)
     return ret;
 
-  ret = set_chrgtime(mxt, bl_opts);
+  ret = broken_line_set_chrgtime(mxt, bl_opts);
   if (ret)
     return ret;
 
@@ -275,6 +275,8 @@ free:
   mxt_ts_info = NULL;
   free(frame.data_buf);
   frame.data_buf = NULL;
+  free(frame.temp_buf);
+  frame.temp_buf = NULL;
   free(frame.t37_buf);
   frame.t37_buf = NULL;
 
@@ -34,6 +34,9 @@
 /* Broken Line Detection Default Options */
 #define BROKEN_LINE_DEFAULT_THRESHOLD 20
 
+struct t37_ctx;
+struct mxt_touchscreen_info;
+
 //******************************************************************************
 /// \brief Broken line detection context options
 struct broken_line_options
@@ -46,4 +49,6 @@ struct broken_line_options
   uint8_t pattern;
 };
 
+int broken_line_set_chrgtime(struct mxt_device *mxt, struct broken_line_options *bl_opts);
+int broken_line_calc(struct t37_ctx *frame, struct mxt_touchscreen_info *ts, struct broken_line_options *bl_opts);
 int mxt_broken_line(struct mxt_device *mxt, struct broken_line_options *bl_opts);
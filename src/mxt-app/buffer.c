@@ -28,6 +28,11 @@
 //------------------------------------------------------------------------------
 
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <errno.h>
 
 #include "libmaxtouch/libmaxtouch.h"
 #include "libmaxtouch/log.h"
@@ -45,6 +50,7 @@ int mxt_buf_init(struct mxt_buffer *ctx)
 
   ctx->capacity = BUFFER_BLOCKSIZE;
   ctx->size = 0;
+  ctx->fixed = false;
   ptr = calloc(ctx->capacity, sizeof(uint8_t));
 
   if (ptr) {
@@ -56,22 +62,40 @@ int mxt_buf_init(struct mxt_buffer *ctx)
 }
 
 //******************************************************************************
-/// \brief Reallocate buffer memory if necessary
+/// \brief Initialise buffer over caller supplied storage
+void mxt_buf_init_fixed(struct mxt_buffer *ctx, uint8_t *storage, size_t capacity)
+{
+  ctx->data = storage;
+  ctx->capacity = capacity;
+  ctx->size = 0;
+  ctx->fixed = true;
+}
+
+//******************************************************************************
+/// \brief Make room for at least len more bytes
+/// \note  Capacity is doubled until it fits, so appending is amortised O(1)
 /// \return #mxt_rc
-static int mxt_buf_realloc(struct mxt_buffer *ctx, size_t new_size)
+int mxt_buf_reserve(struct mxt_buffer *ctx, size_t len)
 {
-  int *ptr = 0;
+  uint8_t *ptr;
+  size_t new_size = ctx->size + len;
   size_t new_capacity;
 
   /* Check whether we are still within bounds of buffer */
   if (new_size <= ctx->capacity)
     return MXT_SUCCESS;
 
-  new_capacity = ctx->capacity + BUFFER_BLOCKSIZE;
+  if (ctx->fixed)
+    return MXT_ERROR_NO_MEM;
+
+  new_capacity = ctx->capacity ? ctx->capacity : BUFFER_BLOCKSIZE;
+  while (new_capacity < new_size)
+    new_capacity *= 2;
+
   ptr = realloc(ctx->data, new_capacity * sizeof(uint8_t));
 
   if (ptr) {
-    ctx->data = (uint8_t *)ptr;
+    ctx->data = ptr;
     ctx->capacity = new_capacity;
     return MXT_SUCCESS;
   } else {
@@ -85,25 +109,87 @@ static int mxt_buf_realloc(struct mxt_buffer *ctx, size_t new_size)
 int mxt_buf_add(struct mxt_buffer *ctx, uint8_t value)
 {
   int ret;
-  size_t new_size = ctx->size + 1;
 
-  ret = mxt_buf_realloc(ctx, new_size);
+  if (ctx->size == ctx->capacity) {
+    ret = mxt_buf_reserve(ctx, 1);
+    if (ret)
+      return ret;
+  }
+
+  ctx->data[ctx->size++] = value;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Append block of bytes to buffer
+/// \return #mxt_rc
+int mxt_buf_append(struct mxt_buffer *ctx, const uint8_t *data, size_t len)
+{
+  int ret;
+
+  ret = mxt_buf_reserve(ctx, len);
   if (ret)
     return ret;
 
-  *(ctx->data + ctx->size) = value;
+  memcpy(ctx->data + ctx->size, data, len);
+  ctx->size += len;
 
-  /* update new size */
-  ctx->size = new_size;
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Read up to max bytes from file descriptor onto end of buffer
+/// \note  A fixed buffer reads only as much as it has room for. On error
+///        errno is left as set by read().
+/// \return #mxt_rc, count set to 0 at end of file
+int mxt_buf_read_fd(struct mxt_buffer *ctx, int fd, size_t max, size_t *count)
+{
+  ssize_t readcount;
+  int ret;
+
+  *count = 0;
+
+  if (ctx->fixed) {
+    if (max > ctx->capacity - ctx->size)
+      max = ctx->capacity - ctx->size;
+  } else {
+    ret = mxt_buf_reserve(ctx, max);
+    if (ret)
+      return ret;
+  }
+
+  if (max == 0)
+    return MXT_ERROR_NO_MEM;
+
+  readcount = read(fd, ctx->data + ctx->size, max);
+  if (readcount < 0)
+    return mxt_errno_to_rc(errno);
+
+  ctx->size += readcount;
+  *count = readcount;
 
   return MXT_SUCCESS;
 }
 
+//******************************************************************************
+/// \brief Remove bytes from start of buffer, keeping the remainder
+void mxt_buf_consume(struct mxt_buffer *ctx, size_t len)
+{
+  if (len >= ctx->size) {
+    ctx->size = 0;
+    return;
+  }
+
+  memmove(ctx->data, ctx->data + len, ctx->size - len);
+  ctx->size -= len;
+}
+
 //******************************************************************************
 /// \brief Free memory associated with buffer
 void mxt_buf_free(struct mxt_buffer *ctx)
 {
-  if (ctx->data) {
+  if (ctx->data && !ctx->fixed) {
     free(ctx->data);
     ctx->data = 0;
   }
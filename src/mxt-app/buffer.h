@@ -28,15 +28,27 @@
 // EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 //------------------------------------------------------------------------------
 
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
 //******************************************************************************
 /// \brief Buffer object
+/// \note  A fixed buffer uses storage supplied by the caller, which it never
+///        reallocates or frees
 struct mxt_buffer {
   size_t size;
   size_t capacity;
   uint8_t *data;
+  bool fixed;
 };
 
 int mxt_buf_init(struct mxt_buffer *ctx);
+void mxt_buf_init_fixed(struct mxt_buffer *ctx, uint8_t *storage, size_t capacity);
+int mxt_buf_reserve(struct mxt_buffer *ctx, size_t len);
 int mxt_buf_add(struct mxt_buffer *ctx, uint8_t value);
+int mxt_buf_append(struct mxt_buffer *ctx, const uint8_t *data, size_t len);
+int mxt_buf_read_fd(struct mxt_buffer *ctx, int fd, size_t max, size_t *count);
+void mxt_buf_consume(struct mxt_buffer *ctx, size_t len);
 void mxt_buf_free(struct mxt_buffer *ctx);
 void mxt_buf_reset(struct mxt_buffer *ctx);
@@ -38,6 +38,9 @@
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/time.h>
+#include <errno.h>
+#include <pthread.h>
 #include <math.h>
 #include <inttypes.h>
 
@@ -45,17 +48,67 @@
 #include "libmaxtouch/info_block.h"
 #include "libmaxtouch/log.h"
 #include "libmaxtouch/utilfuncs.h"
+#include "libmaxtouch/capture.h"
 
 #include "mxt_app.h"
+#include "frame_kernels.h"
+#include "live.h"
 
 #define MAX_FILENAME_LENGTH     255
 
+/* Diagnostic command completion polling, in microseconds */
+#define T37_CMD_DELAY_INITIAL_US  500
+#define T37_CMD_DELAY_MIN_US      100
+#define T37_CMD_DELAY_MAX_US      20000
+#define T37_CMD_TIMEOUT_US        250000
+
+/* Output stream buffer size */
+#define DD_FILE_BUFFER_SIZE       (1024 * 1024)
+
+/* Frames between keyframes in a delta coded capture */
+#define DD_DELTA_KEYFRAME_INTERVAL  256
+
+//******************************************************************************
+/// \brief Frame ring between acquisition and writer threads
+///
+/// The acquisition thread fills the slot at head and never waits for the
+/// writer: if every slot is in use the frame is dropped and counted.
+struct dd_ring {
+  pthread_t writer;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+
+  /* Writer thread copy of the capture context */
+  struct t37_ctx wctx;
+
+  uint16_t *data;
+  uint16_t *frames;
+  uint64_t *times;
+  /* Bus counters as of the newest frame, for the live view */
+  struct mxt_io_stats io_stats;
+
+  int slots;
+  int head;
+  int tail;
+  int count;
+  int high_water;
+  unsigned int dropped;
+  bool done;
+  int ret;
+};
+
 //******************************************************************************
-/// \brief T37 Diagnostic Data object
-struct t37_diagnostic_data {
-  uint8_t mode;
-  uint8_t page;
-  uint8_t data[];
+/// \brief Delta coded capture writer state
+struct dd_delta {
+  uint16_t *prev;
+  uint8_t *coded;
+  struct mxt_capture_index_entry *index;
+  uint32_t index_count;
+  uint32_t index_alloc;
+  uint32_t records;
+  /* File offset of the next record */
+  uint64_t offset;
+  uint64_t record_bytes;
 };
 
 //******************************************************************************
@@ -66,20 +119,25 @@ static int get_objects_addr(struct t37_ctx *ctx)
   int t6_addr;
 
   /* Obtain command processor's address */
-  t6_addr = mxt_get_object_address(ctx->mxt, GEN_COMMANDPROCESSOR_T6, 0);
+  t6_addr = ctx->mxt->obj_cache.t6_addr;
   if (t6_addr == OBJECT_NOT_FOUND) return MXT_ERROR_OBJECT_NOT_FOUND;
 
   /* T37 command address */
   ctx->diag_cmd_addr = t6_addr + MXT_T6_DIAGNOSTIC_OFFSET;
 
   /* Obtain Debug Diagnostic object's address */
-  ctx->t37_addr = mxt_get_object_address(ctx->mxt, DEBUG_DIAGNOSTIC_T37, 0);
+  ctx->t37_addr = ctx->mxt->obj_cache.t37_addr;
   if (ctx->t37_addr == OBJECT_NOT_FOUND) return MXT_ERROR_OBJECT_NOT_FOUND;
 
   /* Obtain Debug Diagnostic object's size */
-  ctx->t37_size = mxt_get_object_size(ctx->mxt, DEBUG_DIAGNOSTIC_T37);
+  ctx->t37_size = ctx->mxt->obj_cache.t37_size;
   if (ctx->t37_size == OBJECT_NOT_FOUND) return MXT_ERROR_OBJECT_NOT_FOUND;
 
+  /* If T37 directly follows the T6 diagnostic field, the command status and
+   * the page can be fetched with a single read */
+  ctx->cmd_merged_read = (ctx->t37_addr == ctx->diag_cmd_addr + 1);
+  ctx->cmd_delay_us = T37_CMD_DELAY_INITIAL_US;
+
   ctx->t111_instances = mxt_get_object_instances(ctx->mxt,
                         SPT_SELFCAPCONFIG_T111);
 
@@ -96,55 +154,251 @@ static int get_objects_addr(struct t37_ctx *ctx)
 }
 
 //******************************************************************************
-/// \brief Retrieve a single page of diagnostic data
+/// \brief Get monotonic time in microseconds
+static uint64_t get_time_us(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+//******************************************************************************
+/// \brief Get wall clock time of the current frame in nanoseconds
+/// \note  Frame times are monotonic, the capture start gives the offset
+uint64_t mxt_dd_frame_wall_ns(const struct t37_ctx *ctx)
+{
+  return ctx->wall_base_ns + (ctx->frame_time_ns - ctx->mono_base_ns);
+}
+
+//******************************************************************************
+/// \brief Add the acquisition time and interval of a frame to the statistics
+static void dd_timing_update(struct dd_timing *t, uint64_t start_ns,
+                             uint64_t end_ns)
+{
+  uint64_t acq_ns = end_ns - start_ns;
+  double interval, delta;
+
+  if (t->frames == 0 || acq_ns < t->acq_min_ns)
+    t->acq_min_ns = acq_ns;
+  if (acq_ns > t->acq_max_ns)
+    t->acq_max_ns = acq_ns;
+  t->acq_total_ns += acq_ns;
+
+  /* Running variance of the frame interval (Welford) */
+  if (t->frames > 0) {
+    interval = (double)(end_ns - t->last_ns);
+    t->intervals++;
+    delta = interval - t->interval_mean;
+    t->interval_mean += delta / t->intervals;
+    t->interval_m2 += delta * (interval - t->interval_mean);
+
+    if (t->intervals == 1 || interval < t->interval_min)
+      t->interval_min = interval;
+    if (interval > t->interval_max)
+      t->interval_max = interval;
+  }
+
+  t->last_ns = end_ns;
+  t->frames++;
+}
+
+//******************************************************************************
+/// \brief Log frame acquisition time and jitter of the frame interval
+static void dd_timing_report(struct t37_ctx *ctx)
+{
+  const struct dd_timing *t = &ctx->timing;
+
+  if (t->frames == 0)
+    return;
+
+  mxt_info(ctx->lc, "Acquisition min/mean/max %.3f/%.3f/%.3f ms",
+           t->acq_min_ns / 1e6, t->acq_total_ns / 1e6 / t->frames,
+           t->acq_max_ns / 1e6);
+
+  if (t->intervals == 0)
+    return;
+
+  mxt_info(ctx->lc, "Interval mean %.3f ms (%.1f fps), jitter %.3f ms RMS, %.3f ms peak to peak",
+           t->interval_mean / 1e6, 1e9 / t->interval_mean,
+           sqrt(t->interval_m2 / t->intervals) / 1e6,
+           (t->interval_max - t->interval_min) / 1e6);
+}
+
+//******************************************************************************
+/// \brief Update command completion estimate after a page has been fetched
+/// \note  If the first poll succeeded, try a shorter delay next time,
+///        otherwise use the measured completion time
+static void update_cmd_delay(struct t37_ctx *ctx, int polls, uint64_t elapsed_us)
+{
+  if (polls == 1)
+    ctx->cmd_delay_us -= ctx->cmd_delay_us / 8;
+  else
+    ctx->cmd_delay_us = elapsed_us;
+
+  if (ctx->cmd_delay_us < T37_CMD_DELAY_MIN_US)
+    ctx->cmd_delay_us = T37_CMD_DELAY_MIN_US;
+  else if (ctx->cmd_delay_us > T37_CMD_DELAY_MAX_US)
+    ctx->cmd_delay_us = T37_CMD_DELAY_MAX_US;
+}
+
+//******************************************************************************
+/// \brief Wait for diagnostic command to be actioned, reading the page at the
+///        same time if T37 directly follows the T6 diagnostic field
+/// \note  First poll is after the measured command latency, then with
+///        exponential backoff until T37_CMD_TIMEOUT_US
+/// \param  read_page  Fetch the page into t37_buf, otherwise only wait
 /// \return #mxt_rc
-static int mxt_get_t37_page(struct t37_ctx *ctx)
+static int wait_t37_cmd(struct t37_ctx *ctx, bool read_page)
 {
-  int failures;
+  uint8_t buf[ctx->t37_size + 1];
+  int read_size = (ctx->cmd_merged_read && read_page) ? ctx->t37_size + 1 : 1;
+  uint64_t start = get_time_us();
+  uint64_t elapsed;
+  int delay = ctx->cmd_delay_us;
+  int polls = 0;
   int ret;
-  uint8_t read_command = 1;
-  uint8_t page_up_cmd = PAGE_UP;
 
-  if (ctx->pass == 0 && ctx->page == 0) {
-    mxt_dbg(ctx->lc, "Writing mode command %02X", ctx->mode);
-    ret = mxt_write_register(ctx->mxt, &ctx->mode, ctx->diag_cmd_addr, 1);
-    if (ret)
-      return ret;
-  } else {
-    ret = mxt_write_register(ctx->mxt, &page_up_cmd, ctx->diag_cmd_addr, 1);
-    if (ret)
+  while (1) {
+    usleep(delay);
+    polls++;
+
+    /* Read back diagnostic register in T6 command processor until it has
+     * been cleared. This means that the chip has actioned the command */
+    ret = mxt_read_register(ctx->mxt, buf, ctx->diag_cmd_addr, read_size);
+    if (ret) {
+      mxt_err(ctx->lc, "Failed to read the status of diagnostic mode command");
       return ret;
+    }
+
+    elapsed = get_time_us() - start;
+
+    if (buf[0] == 0)
+      break;
+
+    if (elapsed > T37_CMD_TIMEOUT_US) {
+      mxt_err(ctx->lc, "Timeout waiting for command to be actioned");
+      return MXT_ERROR_TIMEOUT;
+    }
+
+    /* Back off from a quarter of the estimate */
+    if (polls == 1)
+      delay = ctx->cmd_delay_us / 4;
+
+    delay *= 2;
+    if (delay < T37_CMD_DELAY_MIN_US)
+      delay = T37_CMD_DELAY_MIN_US;
+    else if (delay > T37_CMD_DELAY_MAX_US)
+      delay = T37_CMD_DELAY_MAX_US;
   }
 
-  /* Read back diagnostic register in T6 command processor until it has been
-   * cleared. This means that the chip has actioned the command */
-  failures = 0;
+  update_cmd_delay(ctx, polls, elapsed);
 
-  while (read_command) {
-    usleep(500);
-    ret = mxt_read_register(ctx->mxt, &read_command, ctx->diag_cmd_addr, 1);
+  mxt_verb(ctx->lc, "Command actioned after %d polls, %" PRIu64 " us",
+           polls, elapsed);
+
+  if (!read_page) {
+    return MXT_SUCCESS;
+  } else if (ctx->cmd_merged_read) {
+    memcpy(ctx->t37_buf, buf + 1, ctx->t37_size);
+  } else {
+    ret = mxt_read_register(ctx->mxt, (uint8_t *)ctx->t37_buf,
+                            ctx->t37_addr, ctx->t37_size);
     if (ret) {
-      mxt_err(ctx->lc, "Failed to read the status of diagnostic mode command");
+      mxt_err(ctx->lc, "Failed to read page");
       return ret;
     }
+  }
 
-    if (read_command) {
-      failures++;
+  return MXT_SUCCESS;
+}
 
-      if (failures > 500) {
-        mxt_err(ctx->lc, "Timeout waiting for command to be actioned");
-        return MXT_ERROR_TIMEOUT;
-      }
-    }
+//******************************************************************************
+/// \brief Send the mode command for the first page, or page up for the others
+/// \return #mxt_rc
+static int mxt_send_t37_page_cmd(struct t37_ctx *ctx)
+{
+  uint8_t page_up_cmd = PAGE_UP;
+
+  if (ctx->pass == 0 && ctx->page == 0) {
+    mxt_dbg(ctx->lc, "Writing mode command %02X", ctx->mode);
+    return mxt_write_register(ctx->mxt, &ctx->mode, ctx->diag_cmd_addr, 1);
   }
 
-  ret = mxt_read_register(ctx->mxt, (uint8_t *)ctx->t37_buf,
-                          ctx->t37_addr, ctx->t37_size);
-  if (ret) {
-    mxt_err(ctx->lc, "Failed to read page");
+  return mxt_write_register(ctx->mxt, &page_up_cmd, ctx->diag_cmd_addr, 1);
+}
+
+//******************************************************************************
+/// \brief Move T37 on to a page without reading it
+/// \return #mxt_rc
+static int mxt_skip_t37_page(struct t37_ctx *ctx)
+{
+  int ret;
+
+  ret = mxt_send_t37_page_cmd(ctx);
+  if (ret)
     return ret;
+
+  return wait_t37_cmd(ctx, false);
+}
+
+//******************************************************************************
+/// \brief Whether a self cap, active stylus or key array pass is captured
+static bool dd_pass_selected(const struct t37_ctx *ctx, int pass)
+{
+  return !ctx->pass_mask || (ctx->pass_mask & (1 << pass));
+}
+
+//******************************************************************************
+/// \brief Last pass which has to be paged through
+static int dd_last_pass(const struct t37_ctx *ctx)
+{
+  int pass;
+
+  for (pass = ctx->passes - 1; pass > 0; pass--) {
+    if (dd_pass_selected(ctx, pass))
+      break;
   }
 
+  return pass;
+}
+
+//******************************************************************************
+/// \brief Work out the pages of a self cap or active stylus pass which hold
+///         the selected axes
+static void dd_self_cap_pages(const struct t37_ctx *ctx, int *first_page,
+                              int *last_page)
+{
+  int count = ctx->page_size / 2;
+  int start = 0;
+  int end = ctx->y_size + ctx->x_size - 1;
+
+  /* Each pass holds the Y lines followed by the X lines */
+  if (ctx->axes == DD_AXIS_Y)
+    end = ctx->y_size - 1;
+  else if (ctx->axes == DD_AXIS_X)
+    start = ctx->y_size;
+
+  *first_page = start / count;
+  *last_page = end / count;
+}
+
+//******************************************************************************
+/// \brief Retrieve a single page of diagnostic data
+/// \return #mxt_rc
+static int mxt_get_t37_page(struct t37_ctx *ctx)
+{
+  int ret;
+
+  ret = mxt_send_t37_page_cmd(ctx);
+  if (ret)
+    return ret;
+
+  ret = wait_t37_cmd(ctx, true);
+  if (ret)
+    return ret;
+
   if (ctx->t37_buf->mode != ctx->mode) {
     mxt_err(ctx->lc, "Bad mode in diagnostic data read");
     return MXT_ERROR_UNEXPECTED_DEVICE_STATE;
@@ -179,6 +433,10 @@ static int mxt_generate_hawkeye_header(struct t37_ctx *ctx)
   if (ctx->self_cap) {
     for (pass = 0; pass < ctx->passes; pass++) {
       const char *set;
+
+      if (!dd_pass_selected(ctx, pass))
+        continue;
+
       switch (pass) {
       default:
       case 0:
@@ -206,13 +464,13 @@ static int mxt_generate_hawkeye_header(struct t37_ctx *ctx)
         break;
       }
 
-      for (y = 0; y < ctx->y_size; y++) {
+      for (y = 0; y < ctx->y_size && ctx->axes != DD_AXIS_X; y++) {
         ret = fprintf(ctx->hawkeye, "Y%d_SC_%s_%s,", y, set, mode);
         if (ret < 0)
           return MXT_ERROR_IO;
       }
 
-      for (x = 0; x < ctx->x_size; x++) {
+      for (x = 0; x < ctx->x_size && ctx->axes != DD_AXIS_Y; x++) {
         int x_real;
 
         if (id->matrix_x_size > ctx->y_size) {
@@ -231,6 +489,10 @@ static int mxt_generate_hawkeye_header(struct t37_ctx *ctx)
   } else if (ctx->active_stylus) {
     for (pass = 0; pass < ctx->passes; pass++) {
       const char *mode;
+
+      if (!dd_pass_selected(ctx, pass))
+        continue;
+
       switch (ctx->mode) {
       default:
       case AST_DELTAS:
@@ -241,7 +503,7 @@ static int mxt_generate_hawkeye_header(struct t37_ctx *ctx)
         break;
       }
 
-      for (y = 0; y < ctx->y_size; y++) {
+      for (y = 0; y < ctx->y_size && ctx->axes != DD_AXIS_X; y++) {
         int y_real;
         const char* set;
 
@@ -257,7 +519,7 @@ static int mxt_generate_hawkeye_header(struct t37_ctx *ctx)
           return MXT_ERROR_IO;
       }
 
-      for (x = 0; x < ctx->x_size; x++) {
+      for (x = 0; x < ctx->x_size && ctx->axes != DD_AXIS_Y; x++) {
         int x_real;
         const char* set;
 
@@ -279,6 +541,10 @@ static int mxt_generate_hawkeye_header(struct t37_ctx *ctx)
   else if (ctx->t15_keyarray) {
     for (pass = 0; pass < ctx->passes; pass++) {
       const char *mode;
+
+      if (!dd_pass_selected(ctx, pass))
+        continue;
+
       switch (ctx->mode) {
       default:
       case KEY_DELTAS_MODE:
@@ -306,7 +572,8 @@ static int mxt_generate_hawkeye_header(struct t37_ctx *ctx)
     if (ctx->fformat == false) {    /* Check for format 0 */
       for (x = 0; x < ctx->x_size; x++) {
         for (y = 0; y < ctx->y_size; y++) {
-          ret = fprintf(ctx->hawkeye, "X%dY%d_%s16,", x, y,
+          ret = fprintf(ctx->hawkeye, "X%dY%d_%s16,", x + ctx->roi_x_origin,
+                        y + ctx->roi_y_origin,
                         (ctx->mode == DELTAS_MODE) ? "Delta" : "Reference");
           if (ret < 0)
             return MXT_ERROR_IO;
@@ -326,44 +593,19 @@ static int mxt_generate_hawkeye_header(struct t37_ctx *ctx)
 //******************************************************************************
 /// \brief Sort interleaved debug data
 /// \return #mxt_rc
-static int sort_debug_data(struct mxt_device *mxt, struct t37_ctx *ctx)
+int sort_debug_data(struct mxt_device *mxt, struct t37_ctx *ctx)
 {
-  uint16_t offset1 = 0;
-  uint16_t offset2 = 0;
-  uint16_t count = 0;
-  int i, j;
-
-  ctx->temp_buf = (uint16_t *)calloc(ctx->data_values, sizeof(uint16_t));
-  if (!ctx->temp_buf)
-    mxt_err(ctx->lc, "Buffer calloc failure");
-  
-  offset2 = ctx->y_size/2;    //For interleaved
+  size_t rows;
 
-  while (count < ctx->data_values)
-  {
-    for (i = 0; i < 2; i++) {	//Odd and Even sort
-      for (j = 0; j < ctx->y_size/2 ; j++) {
-
-        ctx->temp_buf[count] = ctx->data_buf[j + offset1]; //First data element
-        ctx->temp_buf[count + 1] = ctx->data_buf[j + offset2];  //Second data element
-        count = count + 2;
-      
-      }
-      //zero the counts and continue to next two rows until all data_values are done
-      offset1 = offset1 + (ctx->y_size);
-      offset2 = offset2 + (ctx->y_size);
-    }
-  }
+  if (!ctx->temp_buf || ctx->y_size == 0)
+    return MXT_INTERNAL_ERROR;
 
-  count = 0;
+  rows = ctx->data_values / ctx->y_size;
 
-  while (count < ctx->data_values)
-  {
+  //Odd and even halves of each row are interleaved
+  frame_kernels_get()->interleave(ctx->temp_buf, ctx->data_buf, rows, ctx->y_size);
 
-    //Reorder data elements into data buf
-    ctx->data_buf[count] = ctx->temp_buf[count];
-    count++;
-  }
+  memcpy(ctx->data_buf, ctx->temp_buf, rows * ctx->y_size * sizeof(uint16_t));
 
   return MXT_SUCCESS;
 }
@@ -381,12 +623,13 @@ static int mxt_debug_insert_data_self_cap(struct t37_ctx *ctx)
   for (i = 0; i < ctx->page_size; i += 2) {
     int data_pos = ctx->page * ctx->page_size/2 + i/2;
 
-    if (data_pos > (ctx->data_values/ctx->passes))
+    /* The last page of a pass runs past its values */
+    if (data_pos >= (ctx->data_values/ctx->passes))
       return MXT_SUCCESS;
 
     ofs = pass_ofs + data_pos;
 
-    if (ofs > ctx->data_values)
+    if (ofs >= ctx->data_values)
       return MXT_INTERNAL_ERROR;
 
     val = (ctx->t37_buf->data[i+1] << 8) | ctx->t37_buf->data[i];
@@ -405,20 +648,20 @@ static int mxt_debug_insert_data_key_array(struct t37_ctx *ctx)
   int offset = 0;
   int pass_ofs = 0;
   int data_pos = 0;
+  int pass;
   uint16_t val;
 
-  /* Manage key array and multiple instance */
+  /* Manage key array and multiple instance, keys of each instance follow
+   * those of the instances before it */
+  for (pass = 0; pass < ctx->pass; pass++)
+    pass_ofs += ctx->key_buf[pass];
 
   for (offset = 0; offset < (ctx->key_buf[ctx->pass]); offset++) {
 
     val = (ctx->t37_buf->data[data_pos+1] << 8) | ctx->t37_buf->data[data_pos];
 
     data_pos +=2;
-    
-    if (ctx->passes != 0) {
-      pass_ofs = ctx->key_buf[(ctx->pass - 1)];
-    }
-      
+
     ctx->data_buf[offset + pass_ofs] = val;
   }
   
@@ -428,35 +671,64 @@ static int mxt_debug_insert_data_key_array(struct t37_ctx *ctx)
 //******************************************************************************
 /// \brief Insert page of data into buffer at appropriate co-ordinates
 /// \return #mxt_rc
-static int mxt_debug_insert_data(struct t37_ctx *ctx)
+int mxt_debug_insert_data(struct t37_ctx *ctx)
 {
-  int i;
-  uint16_t value;
-  int ofs;
+  int count = ctx->page_size / 2;
 
-  for (i = 0; i < ctx->page_size; i += 2) {
-    
-    value = (ctx->t37_buf->data[i+1] << 8) | ctx->t37_buf->data[i];
+  /* The last page may overlap the end of the matrix */
+  if (ctx->y_ptr + count > ctx->data_values)
+    count = ctx->data_values - ctx->y_ptr;
 
-    ofs = ctx->y_ptr;
-    
-    /* The last page may overlap the end of the matrix */
-    if (ofs >= ctx->data_values)
-      return MXT_SUCCESS;
+  if (count <= 0)
+    return MXT_SUCCESS;
+
+  frame_kernels_get()->unpack_le16(ctx->data_buf + ctx->y_ptr,
+                                   ctx->t37_buf->data, count);
+
+  ctx->y_ptr += count;
 
-    ctx->data_buf[ofs] = value;
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Copy the part of the current page inside the region of interest
+/// \return #mxt_rc
+int mxt_debug_insert_data_roi(struct t37_ctx *ctx)
+{
+  int count = ctx->page_size / 2;
+  int start = ctx->page * count;
+  int i, x, y;
+
+  /* The last page may overlap the end of the matrix */
+  if (start + count > ctx->matrix_values)
+    count = ctx->matrix_values - start;
+
+  for (i = 0; i < count; i++) {
+    x = (start + i) / ctx->matrix_y_size - ctx->roi_x_origin;
+    y = (start + i) % ctx->matrix_y_size - ctx->roi_y_origin;
 
-    ctx->y_ptr++;
+    if (x < 0 || x >= ctx->x_size || y < 0 || y >= ctx->y_size)
+      continue;
 
+    ctx->data_buf[x * ctx->y_size + y] = ctx->t37_buf->data[2 * i]
+                                         | (ctx->t37_buf->data[2 * i + 1] << 8);
   }
 
   return MXT_SUCCESS;
 }
 
+//******************************************************************************
+/// \brief Print the time at which the current frame was read
+/// \return #mxt_rc
+static int print_frame_timestamp(struct t37_ctx *ctx)
+{
+  return mxt_print_time_ns(ctx->hawkeye, mxt_dd_frame_wall_ns(ctx));
+}
+
 //******************************************************************************
 /// \brief Write data to file
 /// \return #mxt_rc
-static int mxt_hawkeye_output(struct t37_ctx *ctx)
+int mxt_hawkeye_output(struct t37_ctx *ctx)
 {
   int x, y, i;
   int pass;
@@ -465,7 +737,6 @@ static int mxt_hawkeye_output(struct t37_ctx *ctx)
   int ofs = 0;
   int data_ofs = 0;
   int32_t value = 0;
-  uint8_t totalkeys = 0;
   uint8_t ts_xsize = 0;
   uint8_t ts_ysize = 0;
   uint8_t ts_xorigin = 0;
@@ -474,7 +745,7 @@ static int mxt_hawkeye_output(struct t37_ctx *ctx)
   struct mxt_touchscreen_info *ts_info = NULL;
   
   if (ctx->fformat == false) {
-     ret = mxt_print_timestamp(ctx->hawkeye, false);
+     ret = print_frame_timestamp(ctx);
      if (ret)
         return ret;
   
@@ -488,7 +759,10 @@ static int mxt_hawkeye_output(struct t37_ctx *ctx)
     for (pass = 0; pass < ctx->passes; pass++) {
       int pass_ofs = (ctx->y_size + ctx->x_size) * pass;
 
-      for (y = 0; y < ctx->y_size; y++) {
+      if (!dd_pass_selected(ctx, pass))
+        continue;
+
+      for (y = 0; y < ctx->y_size && ctx->axes != DD_AXIS_X; y++) {
         value = (int16_t)ctx->data_buf[pass_ofs + y];
         ret = fprintf(ctx->hawkeye, "%d,",
                       (ctx->mode == SELF_CAP_DELTAS) ? (int16_t)value : value);
@@ -496,7 +770,7 @@ static int mxt_hawkeye_output(struct t37_ctx *ctx)
           return MXT_ERROR_IO;
       }
 
-      for (x = 0; x < ctx->x_size; x++) {
+      for (x = 0; x < ctx->x_size && ctx->axes != DD_AXIS_Y; x++) {
         value = (int16_t)ctx->data_buf[pass_ofs + ctx->y_size + x];
         ret = fprintf(ctx->hawkeye, "%d,",
                       (ctx->mode == SELF_CAP_DELTAS) ? (int16_t)value : value);
@@ -505,17 +779,17 @@ static int mxt_hawkeye_output(struct t37_ctx *ctx)
       }
     }
   } else if (ctx->t15_keyarray) {
-      for (i = 0; i < ctx->passes; i++) {
-        totalkeys = totalkeys + ctx->key_buf[i];
-      }
+      for (pass = 0; pass < ctx->passes; pass++) {
+        for (i = 0; i < ctx->key_buf[pass] && dd_pass_selected(ctx, pass); i++) {
+          value = (int16_t)ctx->data_buf[ofs + i];
+          ret = fprintf(ctx->hawkeye, "%d,",
+                        (ctx->mode == KEY_DELTAS_MODE) ? (int16_t)value : value);
+          if (ret < 0)
+            return MXT_ERROR_IO;
+        }
 
-      for (i = 0; i < totalkeys; i++) {
-        value = (int16_t)ctx->data_buf[i];
-        ret = fprintf(ctx->hawkeye, "%d,",
-                      (ctx->mode == KEY_DELTAS_MODE) ? (int16_t)value : value);
-        if (ret < 0)
-          return MXT_ERROR_IO;
-    }
+        ofs += ctx->key_buf[pass];
+      }
   } else {
 
       if (ctx->fformat == false ) {
@@ -540,15 +814,8 @@ static int mxt_hawkeye_output(struct t37_ctx *ctx)
       } else {  //Start of format 1
 
         pass = ctx->instance;
-        
-        ret = mxt_read_touchscreen_info (ctx->mxt, &ts_info);
-          
-        if (ret != MXT_SUCCESS) {
-          mxt_err(ctx->lc, "Read touchscreen info failed\n");
-          free(ts_info);
-          return MXT_INTERNAL_ERROR;
-        }
-         
+        ts_info = ctx->ts_info;
+
         /* Setup X Axis columns for touchscreen matrix */
     
         ret = fprintf(ctx->hawkeye, "Frame %d", ctx->frame);
@@ -570,7 +837,8 @@ static int mxt_hawkeye_output(struct t37_ctx *ctx)
            
           ret = fprintf(ctx->hawkeye, ",");
         
-          if (pass == 0) {
+          /* A region of interest is already cut to the instance */
+          if (pass == 0 || ctx->roi) {
             data_ofs = 0;
           } else {
             data_ofs = ((ts_info[pass].xorigin * ctx->y_size) + (ts_info[pass].yorigin));
@@ -633,7 +901,7 @@ static int get_instance_num(uint16_t *instance)
 /// \return #mxt_rc
 static int get_file_format(uint16_t *fformat)
 {
-  printf("Enter file format 0/1: ");
+  printf("Enter file format 0/1/2/3 (2 - binary, 3 - delta coded): ");
 
   if (scanf("%hu", fformat) == EOF) {
     fprintf(stderr, "Could not handle the input, exiting");
@@ -689,6 +957,11 @@ int mxt_debug_dump_initialise(struct mxt_device *mxt, struct t37_ctx *ctx)
   ctx->self_cap = false;
   ctx->t15_keyarray = false;
 
+  /* Reference for showing monotonic frame times as time of day */
+  ctx->wall_base_ns = mxt_wall_time_ns();
+  ctx->mono_base_ns = mxt_time_ns();
+  memset(&ctx->timing, 0, sizeof(ctx->timing));
+
   ret = get_objects_addr(ctx);
   if (ret) {
     mxt_err(ctx->lc, "Failed to get object information");
@@ -855,15 +1128,41 @@ int mxt_debug_dump_initialise(struct mxt_device *mxt, struct t37_ctx *ctx)
     return MXT_ERROR_NO_MEM;
   }
 
+  /* allocate scratch frame used when reordering data */
+  ctx->temp_buf = (uint16_t *)calloc(ctx->data_values, sizeof(uint16_t));
+  if (!ctx->temp_buf) {
+    mxt_err(ctx->lc, "calloc failure");
+    return MXT_ERROR_NO_MEM;
+  }
+
   return MXT_SUCCESS;
 }
 
+//******************************************************************************
+/// \brief Check whether the device interleaves the rows of reference frames
+static bool dd_needs_sort(struct mxt_id_info *id, uint8_t mode)
+{
+  if (id->family != 0xA6 || mode != REFS_MODE)
+    return false;
+
+  switch (id->variant) {
+  case 0x06 ... 0x08:
+  case 0x0A:
+  case 0x0C ... 0x14:
+    return true;
+
+  default:
+    return false;
+  }
+}
+
 //******************************************************************************
 /// \brief Read one frame of diagnostic data
 /// \return #mxt_rc
 int mxt_read_diagnostic_data_frame(struct mxt_device *mxt, struct t37_ctx* ctx)
 {
   struct mxt_id_info *id = mxt->info.id;
+  int last_page = ctx->roi ? ctx->last_page : ctx->pages_per_pass - 1;
   int ret;
 
     /* iterate through stripes */
@@ -874,31 +1173,41 @@ int mxt_read_diagnostic_data_frame(struct mxt_device *mxt, struct t37_ctx* ctx)
     ctx->y_ptr = ctx->stripe_starty;
     ctx->pass = 0;
 
-    for (ctx->page = 0; ctx->page < ctx->pages_per_pass; ctx->page++) {
+    ret = mxt_session_begin(mxt);
+    if (ret)
+      return ret;
+
+    /* Pages after the region of interest are never requested */
+    for (ctx->page = 0; ctx->page <= last_page; ctx->page++) {
       mxt_dbg(ctx->lc, "Frame %d Pass %d Page %d Stripe Start %d Stripe Width %d\n", ctx->frame, ctx->pass,
               ctx->page, ctx->stripe_starty, ctx->stripe_width);
 
+      if (ctx->roi && ctx->page < ctx->first_page) {
+        ret = mxt_skip_t37_page(ctx);
+        if (ret) {
+          mxt_session_end(mxt);
+          return ret;
+        }
+
+        continue;
+      }
+
       ret = mxt_get_t37_page(ctx);
-      if (ret)
+      if (ret) {
+        mxt_session_end(mxt);
         return ret;
+      }
 
-      mxt_debug_insert_data(ctx);
+      if (ctx->roi)
+        mxt_debug_insert_data_roi(ctx);
+      else
+        mxt_debug_insert_data(ctx);
     }
 
-    if (id->family == 0xA6 && ctx->mode == REFS_MODE) {
-
-      switch (id->variant) {
-      case 0x06 ... 0x08:
-      case 0x0A:
-      case 0x0C ... 0x14:
-
-        sort_debug_data(mxt, ctx);
-        break;
+    mxt_session_end(mxt);
 
-      default:
-        break;
-      }
-    }
+    if (dd_needs_sort(id, ctx->mode))
+      sort_debug_data(mxt, ctx);
 
   return MXT_SUCCESS;
 }
@@ -908,22 +1217,47 @@ int mxt_read_diagnostic_data_frame(struct mxt_device *mxt, struct t37_ctx* ctx)
 /// \return #mxt_rc
 static int mxt_read_diagnostic_data_self_cap(struct t37_ctx* ctx)
 {
+  int last_pass = dd_last_pass(ctx);
+  int first_page, last_page;
   int ret;
 
-  for (ctx->pass = 0; ctx->pass < ctx->passes; ctx->pass++) {
+  dd_self_cap_pages(ctx, &first_page, &last_page);
+
+  /* Hold off the driver for the whole frame rather than per T37 page */
+  ret = mxt_session_begin(ctx->mxt);
+  if (ret)
+    return ret;
+
+  for (ctx->pass = 0; ctx->pass <= last_pass; ctx->pass++) {
     for (ctx->page = 0; ctx->page < ctx->pages_per_pass; ctx->page++) {
+      /* Pages after the last selected one are never requested */
+      if (ctx->pass == last_pass && ctx->page > last_page)
+        break;
+
       mxt_dbg(ctx->lc, "Frame %d Pass %d Page %d", ctx->frame, ctx->pass,
               ctx->page);
 
+      /* T37 only pages forwards, so step through unwanted pages */
+      if (!dd_pass_selected(ctx, ctx->pass)
+          || ctx->page < first_page || ctx->page > last_page) {
+        ret = mxt_skip_t37_page(ctx);
+        if (ret)
+          goto end;
+
+        continue;
+      }
+
       ret = mxt_get_t37_page(ctx);
       if (ret)
-        return ret;
+        goto end;
 
       mxt_debug_insert_data_self_cap(ctx);
     }
   }
 
-  return MXT_SUCCESS;
+end:
+  mxt_session_end(ctx->mxt);
+  return ret;
 }
 
 //******************************************************************************
@@ -939,70 +1273,711 @@ static int mxt_read_diagnostic_data_ast(struct t37_ctx* ctx)
 /// \return #mxt_rc
 static int mxt_read_diagnostic_data_t15key (struct t37_ctx* ctx)
 {
+  int last_pass = dd_last_pass(ctx);
   int ret;
-  
-  /* iterate through stripes */
-  for (ctx->pass = 0; ctx->pass < ctx->passes; ctx->pass++) {
+
+  ret = mxt_session_begin(ctx->mxt);
+  if (ret)
+    return ret;
+
+  /* iterate through stripes, instances after the last selected one are
+   * never requested */
+  for (ctx->pass = 0; ctx->pass <= last_pass; ctx->pass++) {
     for (ctx->page = 0; ctx->page < ctx->pages_per_pass; ctx->page++) {
       mxt_dbg(ctx->lc, "Frame %d Pass %d Page %d", ctx->frame, ctx->pass,
               ctx->page);
 
+      if (!dd_pass_selected(ctx, ctx->pass)) {
+        ret = mxt_skip_t37_page(ctx);
+        if (ret)
+          goto end;
+
+        continue;
+      }
+
       ret = mxt_get_t37_page(ctx);
       if (ret)
-        return ret;
+        goto end;
 
       mxt_debug_insert_data_key_array(ctx);
     }
   }
 
-  return MXT_SUCCESS;
+end:
+  mxt_session_end(ctx->mxt);
+  return ret;
 }
 
 //******************************************************************************
-/// \brief Retrieve data from the T37 Diagnostic Data object
+/// \brief Write binary capture file header
 /// \return #mxt_rc
-int mxt_debug_dump(struct mxt_device *mxt, int mode, const char *csv_file,
-                   uint16_t frames, uint16_t instance, uint16_t format, uint16_t file_attr)
+static int mxt_capture_write_header(struct t37_ctx *ctx)
 {
-  struct t37_ctx ctx;
-  time_t t1;
-  time_t t2;
-  int ret;
+  struct mxt_id_info *id = ctx->mxt->info.id;
+  struct mxt_capture_header hdr;
+  struct mxt_capture_clock clock;
+  size_t info_size;
+
+  info_size = sizeof(struct mxt_id_info)
+              + id->num_objects * sizeof(struct mxt_object)
+              + sizeof(struct mxt_raw_crc);
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, MXT_CAPTURE_MAGIC, sizeof(hdr.magic));
+  hdr.version = MXT_CAPTURE_VERSION;
+  hdr.header_size = sizeof(hdr) + sizeof(clock);
+  hdr.mode = ctx->mode;
+  hdr.flags = MXT_CAPTURE_MONOTONIC;
+
+  if (ctx->self_cap)
+    hdr.flags |= MXT_CAPTURE_SELF_CAP;
+  if (ctx->active_stylus)
+    hdr.flags |= MXT_CAPTURE_ACTIVE_STYLUS;
+
+  if (ctx->t15_keyarray) {
+    hdr.flags |= MXT_CAPTURE_T15_KEYARRAY;
+  } else {
+    hdr.x_size = ctx->x_size;
+    hdr.y_size = ctx->y_size;
+  }
 
-  ctx.lc = mxt->ctx;
-  ctx.mxt = mxt;
-  ctx.mode = mode;
-  ctx.fformat = format;
-  ctx.file_attr = file_attr;
+  hdr.passes = ctx->passes;
+  hdr.value_count = ctx->data_values;
+  hdr.info_size = info_size;
 
-  if (frames == 0) {
-    mxt_warn(ctx.lc, "Warning: Defaulting to 1 frame");
-    frames = 1;
+  if (ctx->delta) {
+    hdr.version = MXT_CAPTURE_VERSION_DELTA;
+    hdr.record_size = 0;
+    ctx->delta->offset = hdr.header_size + info_size
+                         + (ctx->t15_keyarray ? ctx->passes : 0);
+  } else {
+    hdr.record_size = ctx->capture_size;
   }
 
-  ret = mxt_debug_dump_initialise(mxt, &ctx);
-  if (ret)
-    return ret;
-  
-  if (ctx.t100_instances) {
-    if (instance >= ctx.t100_instances) {
-      mxt_warn(ctx.lc, "Warning: Instance %d does not exist. Defaulting to T100 instance 0", instance);
-      instance = 0;
-    }
-    
-  } else if (ctx.t9_instances) {
-    if (instance >= ctx.t9_instances) {
-      mxt_warn(ctx.lc, "Warning: Instance %d does not exist. Defaulting to T9 instance 0", instance);
-      instance = 0;
-    }
-  }
-  
-  ctx.instance = instance;
+  clock.wall_ns = ctx->wall_base_ns;
+  clock.monotonic_ns = ctx->mono_base_ns;
 
-  /* Append or overwrite check */
-  /* Open Hawkeye output file */
-  if (ctx.file_attr == 1) {
-    ctx.hawkeye = fopen(csv_file, "a");
+  if (fwrite(&hdr, sizeof(hdr), 1, ctx->hawkeye) != 1
+      || fwrite(&clock, sizeof(clock), 1, ctx->hawkeye) != 1)
+    return MXT_ERROR_IO;
+
+  if (fwrite(ctx->mxt->info.raw_info, info_size, 1, ctx->hawkeye) != 1)
+    return MXT_ERROR_IO;
+
+  if (ctx->t15_keyarray
+      && fwrite(ctx->key_buf, ctx->passes, 1, ctx->hawkeye) != 1)
+    return MXT_ERROR_IO;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Write one frame record to binary capture file
+/// \return #mxt_rc
+static int mxt_capture_write_frame(struct t37_ctx *ctx)
+{
+  struct mxt_capture_record *rec = (struct mxt_capture_record *)ctx->capture_buf;
+
+  rec->frame = ctx->frame;
+  rec->timestamp = ctx->frame_time_ns;
+  memcpy(ctx->capture_buf + sizeof(*rec), ctx->data_buf,
+         ctx->data_values * sizeof(uint16_t));
+
+  if (fwrite(ctx->capture_buf, ctx->capture_size, 1, ctx->hawkeye) != 1)
+    return MXT_ERROR_IO;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Allocate delta coded capture state
+/// \return #mxt_rc
+static int dd_delta_init(struct t37_ctx *ctx)
+{
+  struct dd_delta *d;
+
+  d = (struct dd_delta *)calloc(1, sizeof(*d));
+  if (!d)
+    return MXT_ERROR_NO_MEM;
+
+  ctx->delta = d;
+
+  d->prev = (uint16_t *)calloc(ctx->data_values, sizeof(uint16_t));
+  d->coded = (uint8_t *)malloc(MXT_CAPTURE_CODED_MAX(ctx->data_values));
+  if (!d->prev || !d->coded)
+    return MXT_ERROR_NO_MEM;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Free delta coded capture state
+static void dd_delta_free(struct t37_ctx *ctx)
+{
+  if (!ctx->delta)
+    return;
+
+  free(ctx->delta->prev);
+  free(ctx->delta->coded);
+  free(ctx->delta->index);
+  free(ctx->delta);
+  ctx->delta = NULL;
+}
+
+//******************************************************************************
+/// \brief Write one delta coded frame record, as a keyframe every
+///        DD_DELTA_KEYFRAME_INTERVAL records
+/// \return #mxt_rc
+static int dd_delta_write_frame(struct t37_ctx *ctx)
+{
+  struct dd_delta *d = ctx->delta;
+  struct mxt_capture_delta_record rec;
+  struct mxt_capture_index_entry *index;
+  bool keyframe = (d->records % DD_DELTA_KEYFRAME_INTERVAL) == 0;
+
+  rec.frame = ctx->frame;
+  rec.timestamp = ctx->frame_time_ns;
+  rec.keyframe = keyframe;
+  rec.size = mxt_capture_encode(ctx->data_buf, keyframe ? NULL : d->prev,
+                                ctx->data_values, d->coded);
+
+  if (keyframe) {
+    if (d->index_count == d->index_alloc) {
+      d->index_alloc = d->index_alloc ? d->index_alloc * 2 : 64;
+      index = realloc(d->index, d->index_alloc * sizeof(*index));
+      if (!index)
+        return MXT_ERROR_NO_MEM;
+
+      d->index = index;
+    }
+
+    d->index[d->index_count].record = d->records;
+    d->index[d->index_count].frame = ctx->frame;
+    d->index[d->index_count].offset = d->offset;
+    d->index_count++;
+  }
+
+  if (fwrite(&rec, sizeof(rec), 1, ctx->hawkeye) != 1
+      || (rec.size && fwrite(d->coded, rec.size, 1, ctx->hawkeye) != 1))
+    return MXT_ERROR_IO;
+
+  memcpy(d->prev, ctx->data_buf, ctx->data_values * sizeof(uint16_t));
+  d->offset += sizeof(rec) + rec.size;
+  d->record_bytes += sizeof(rec) + rec.size;
+  d->records++;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Write the keyframe index and trailer of a delta coded capture
+/// \return #mxt_rc
+static int dd_delta_finish(struct t37_ctx *ctx)
+{
+  struct dd_delta *d = ctx->delta;
+  struct mxt_capture_trailer trailer;
+  uint64_t fixed_bytes;
+
+  memset(&trailer, 0, sizeof(trailer));
+  trailer.index_offset = d->offset;
+  trailer.index_count = d->index_count;
+  trailer.record_count = d->records;
+  trailer.keyframe_interval = DD_DELTA_KEYFRAME_INTERVAL;
+  memcpy(trailer.magic, MXT_CAPTURE_INDEX_MAGIC, sizeof(trailer.magic));
+
+  if ((d->index_count
+       && fwrite(d->index, sizeof(*d->index), d->index_count, ctx->hawkeye)
+          != d->index_count)
+      || fwrite(&trailer, sizeof(trailer), 1, ctx->hawkeye) != 1)
+    return MXT_ERROR_IO;
+
+  fixed_bytes = (uint64_t)d->records * ctx->capture_size;
+  if (fixed_bytes)
+    mxt_info(ctx->lc, "Delta coded %u frames in %" PRIu64 " bytes, %.1f%% of fixed records",
+             d->records, d->record_bytes, 100.0 * d->record_bytes / fixed_bytes);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Write one frame in the selected output format
+/// \return #mxt_rc
+static int dd_output_frame(struct t37_ctx *ctx)
+{
+  if (ctx->live)
+    return live_render(ctx->live, ctx);
+
+  if (ctx->delta)
+    return dd_delta_write_frame(ctx);
+
+  if (ctx->binary)
+    return mxt_capture_write_frame(ctx);
+
+  return mxt_hawkeye_output(ctx);
+}
+
+//******************************************************************************
+/// \brief Writer thread, outputs frames from the ring until it is stopped
+static void *dd_ring_writer(void *arg)
+{
+  struct dd_ring *ring = arg;
+  struct t37_ctx *ctx = &ring->wctx;
+  int slot;
+  int ret;
+
+  pthread_mutex_lock(&ring->lock);
+
+  for (;;) {
+    while (ring->count == 0 && !ring->done)
+      pthread_cond_wait(&ring->cond, &ring->lock);
+
+    /* Stopped and drained */
+    if (ring->count == 0)
+      break;
+
+    slot = ring->tail;
+    if (ctx->live) {
+      ctx->live->io = ring->io_stats;
+      ctx->live->dropped = ring->dropped;
+    }
+    pthread_mutex_unlock(&ring->lock);
+
+    ctx->data_buf = ring->data + slot * ctx->data_values;
+    ctx->frame = ring->frames[slot];
+    ctx->frame_time_ns = ring->times[slot];
+
+    ret = dd_output_frame(ctx);
+
+    pthread_mutex_lock(&ring->lock);
+    ring->tail = (slot + 1) % ring->slots;
+    ring->count--;
+
+    if (ret) {
+      ring->ret = ret;
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(&ring->lock);
+
+  return NULL;
+}
+
+//******************************************************************************
+/// \brief Allocate frame ring and start writer thread
+/// \return #mxt_rc
+static int dd_ring_start(struct dd_ring *ring, struct t37_ctx *ctx, int slots)
+{
+  int ret;
+
+  memset(ring, 0, sizeof(*ring));
+  ring->slots = slots;
+  ring->wctx = *ctx;
+
+  ring->data = (uint16_t *)calloc(slots * ctx->data_values, sizeof(uint16_t));
+  ring->frames = (uint16_t *)calloc(slots, sizeof(uint16_t));
+  ring->times = (uint64_t *)calloc(slots, sizeof(uint64_t));
+  if (!ring->data || !ring->frames || !ring->times) {
+    mxt_err(ctx->lc, "calloc failure");
+    ret = MXT_ERROR_NO_MEM;
+    goto free;
+  }
+
+  pthread_mutex_init(&ring->lock, NULL);
+  pthread_cond_init(&ring->cond, NULL);
+
+  ret = pthread_create(&ring->writer, NULL, dd_ring_writer, ring);
+  if (ret) {
+    mxt_err(ctx->lc, "Failed to start writer thread");
+    pthread_cond_destroy(&ring->cond);
+    pthread_mutex_destroy(&ring->lock);
+    ret = mxt_errno_to_rc(ret);
+    goto free;
+  }
+
+  mxt_dbg(ctx->lc, "Started writer thread with %d frame ring", slots);
+
+  return MXT_SUCCESS;
+
+free:
+  free(ring->data);
+  free(ring->frames);
+  free(ring->times);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Queue the frame in ctx->data_buf for the writer thread
+/// \return #mxt_rc, or error reported by the writer thread
+static int dd_ring_push(struct dd_ring *ring, struct t37_ctx *ctx)
+{
+  int slot;
+  int ret;
+
+  pthread_mutex_lock(&ring->lock);
+  ret = ring->ret;
+
+  if (!ret && ring->count == ring->slots) {
+    ring->dropped++;
+    mxt_verb(ctx->lc, "Ring full, dropped frame %u", ctx->frame);
+    pthread_mutex_unlock(&ring->lock);
+    return MXT_SUCCESS;
+  }
+
+  slot = ring->head;
+  pthread_mutex_unlock(&ring->lock);
+
+  if (ret)
+    return ret;
+
+  /* The writer does not touch free slots, so copy without the lock */
+  memcpy(ring->data + slot * ctx->data_values, ctx->data_buf,
+         ctx->data_values * sizeof(uint16_t));
+  ring->frames[slot] = ctx->frame;
+  ring->times[slot] = ctx->frame_time_ns;
+
+  pthread_mutex_lock(&ring->lock);
+  /* Only this thread updates the counters, the copy is for the writer */
+  if (ctx->live)
+    mxt_get_io_stats(ctx->mxt, &ring->io_stats);
+  ring->head = (slot + 1) % ring->slots;
+  ring->count++;
+  if (ring->count > ring->high_water)
+    ring->high_water = ring->count;
+
+  pthread_cond_signal(&ring->cond);
+  pthread_mutex_unlock(&ring->lock);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Drain ring, stop writer thread and report ring statistics
+/// \return #mxt_rc reported by the writer thread
+static int dd_ring_stop(struct dd_ring *ring, struct t37_ctx *ctx)
+{
+  int ret;
+
+  pthread_mutex_lock(&ring->lock);
+  ring->done = true;
+  pthread_cond_signal(&ring->cond);
+  pthread_mutex_unlock(&ring->lock);
+
+  pthread_join(ring->writer, NULL);
+
+  ret = ring->ret;
+
+  mxt_info(ctx->lc, "Ring high water mark %d/%d, %u frames dropped",
+           ring->high_water, ring->slots, ring->dropped);
+
+  pthread_cond_destroy(&ring->cond);
+  pthread_mutex_destroy(&ring->lock);
+  free(ring->data);
+  free(ring->frames);
+  free(ring->times);
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Select touchscreen instance, falling back to instance 0
+static void dd_set_instance(struct t37_ctx *ctx, uint16_t instance)
+{
+  if (ctx->t100_instances) {
+    if (instance >= ctx->t100_instances) {
+      mxt_warn(ctx->lc, "Warning: Instance %d does not exist. Defaulting to T100 instance 0", instance);
+      instance = 0;
+    }
+
+  } else if (ctx->t9_instances) {
+    if (instance >= ctx->t9_instances) {
+      mxt_warn(ctx->lc, "Warning: Instance %d does not exist. Defaulting to T9 instance 0", instance);
+      instance = 0;
+    }
+  }
+
+  ctx->instance = instance;
+}
+
+//******************************************************************************
+/// \brief Restrict a self cap, active stylus or key array capture to some
+///         passes and axes
+/// \return #mxt_rc
+static int dd_set_selection(struct t37_ctx *ctx, const struct dd_roi *roi)
+{
+  uint8_t all = (ctx->passes >= 8) ? 0xff : (1 << ctx->passes) - 1;
+
+  if (!roi->passes && !roi->axes)
+    return MXT_SUCCESS;
+
+  if (!ctx->self_cap && !ctx->active_stylus && !ctx->t15_keyarray) {
+    mxt_warn(ctx->lc, "Warning: Pass and axis selection only apply to self cap, active stylus and key array data");
+    return MXT_SUCCESS;
+  }
+
+  if (roi->passes && !(roi->passes & all)) {
+    mxt_err(ctx->lc, "No selected pass in the %d passes of this mode",
+            ctx->passes);
+    return MXT_ERROR_BAD_INPUT;
+  }
+
+  if (roi->axes && ctx->t15_keyarray)
+    mxt_warn(ctx->lc, "Warning: Key array data has no axes, capturing all keys");
+
+  ctx->pass_mask = roi->passes & all;
+  ctx->axes = ctx->t15_keyarray ? 0 : roi->axes;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Restrict a mutual capture to a region, shrinking the frame buffers
+///         and working out the T37 pages which hold it, or a self cap capture
+///         to the selected passes and axes
+/// \return #mxt_rc
+int mxt_dd_set_roi(struct t37_ctx *ctx, const struct dd_roi *roi)
+{
+  struct mxt_touchscreen_info *ts_info;
+  int x_start, x_end, y_start, y_end;
+  int count = ctx->page_size / 2;
+  uint16_t *buf;
+  int ret;
+
+  if (!roi)
+    return MXT_SUCCESS;
+
+  ret = dd_set_selection(ctx, roi);
+  if (ret || !roi->enabled)
+    return ret;
+
+  if (ctx->self_cap || ctx->active_stylus || ctx->t15_keyarray
+      || ctx->passes != 1 || dd_needs_sort(ctx->mxt->info.id, ctx->mode)) {
+    mxt_warn(ctx->lc, "Warning: Region of interest not supported in this mode, capturing full frame");
+    return MXT_SUCCESS;
+  }
+
+  if (roi->instance) {
+    ret = mxt_read_touchscreen_info(ctx->mxt, &ts_info);
+    if (ret) {
+      mxt_err(ctx->lc, "Read touchscreen info failed");
+      return ret;
+    }
+
+    x_start = ts_info[ctx->instance].xorigin;
+    x_end = x_start + ts_info[ctx->instance].xsize - 1;
+    y_start = ts_info[ctx->instance].yorigin;
+    y_end = y_start + ts_info[ctx->instance].ysize - 1;
+    free(ts_info);
+  } else {
+    x_start = roi->x_start;
+    x_end = roi->x_end;
+    y_start = roi->y_start;
+    y_end = roi->y_end;
+  }
+
+  if (x_start < 0 || x_start > x_end || x_end >= ctx->x_size
+      || y_start < 0 || y_start > y_end || y_end >= ctx->y_size) {
+    mxt_err(ctx->lc, "Region X%d-%d Y%d-%d outside %dx%d matrix",
+            x_start, x_end, y_start, y_end, ctx->x_size, ctx->y_size);
+    return MXT_ERROR_BAD_INPUT;
+  }
+
+  ctx->roi = true;
+  ctx->matrix_y_size = ctx->y_size;
+  ctx->matrix_values = ctx->data_values;
+  ctx->first_page = (x_start * ctx->y_size + y_start) / count;
+  ctx->last_page = (x_end * ctx->y_size + y_end) / count;
+
+  ctx->roi_x_origin = x_start;
+  ctx->roi_y_origin = y_start;
+  ctx->x_size = x_end - x_start + 1;
+  ctx->y_size = y_end - y_start + 1;
+  ctx->data_values = ctx->x_size * ctx->y_size;
+  ctx->stripe_width = ctx->y_size;
+
+  buf = realloc(ctx->data_buf, ctx->data_values * sizeof(uint16_t));
+  if (buf)
+    ctx->data_buf = buf;
+
+  buf = realloc(ctx->temp_buf, ctx->data_values * sizeof(uint16_t));
+  if (buf)
+    ctx->temp_buf = buf;
+
+  /* Format 1 labels the region rather than the whole instance */
+  if (ctx->ts_info) {
+    ctx->ts_info[ctx->instance].xorigin = x_start;
+    ctx->ts_info[ctx->instance].xsize = ctx->x_size;
+    ctx->ts_info[ctx->instance].yorigin = y_start;
+    ctx->ts_info[ctx->instance].ysize = ctx->y_size;
+  }
+
+  mxt_info(ctx->lc, "Region X%d-%d Y%d-%d, reading T37 pages %d to %d of %d",
+           x_start, x_end, y_start, y_end, ctx->first_page, ctx->last_page,
+           ctx->pages_per_pass - 1);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Read one frame in the mode set up by mxt_debug_dump_initialise()
+/// \return #mxt_rc
+static int dd_read_frame(struct mxt_device *mxt, struct t37_ctx *ctx)
+{
+  uint64_t start_ns = mxt_time_ns();
+  int ret;
+
+  /* Each reader holds off the driver for the whole frame */
+  if (ctx->self_cap)
+    ret = mxt_read_diagnostic_data_self_cap(ctx);
+  else if (ctx->active_stylus)
+    ret = mxt_read_diagnostic_data_ast(ctx);
+  else if (ctx->t15_keyarray)
+    ret = mxt_read_diagnostic_data_t15key(ctx);
+  else /* Mutual */
+    ret = mxt_read_diagnostic_data_frame(mxt, ctx);
+
+  /* Stamped as soon as the last page is in */
+  if (ret == MXT_SUCCESS) {
+    ctx->frame_time_ns = mxt_time_ns();
+    dd_timing_update(&ctx->timing, start_ns, ctx->frame_time_ns);
+  }
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Release continuous capture buffers
+void mxt_dd_stream_stop(struct t37_ctx *ctx)
+{
+  free(ctx->data_buf);
+  ctx->data_buf = NULL;
+  free(ctx->temp_buf);
+  ctx->temp_buf = NULL;
+  free(ctx->t37_buf);
+  ctx->t37_buf = NULL;
+  free(ctx->key_buf);
+  ctx->key_buf = NULL;
+}
+
+//******************************************************************************
+/// \brief Set up continuous capture of diagnostic frames
+/// \return #mxt_rc
+int mxt_dd_stream_start(struct mxt_device *mxt, struct t37_ctx *ctx,
+                        uint8_t mode, uint16_t instance)
+{
+  int ret;
+
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->lc = mxt->ctx;
+  ctx->mxt = mxt;
+  ctx->mode = mode;
+
+  ret = mxt_debug_dump_initialise(mxt, ctx);
+  if (ret) {
+    mxt_dd_stream_stop(ctx);
+    return ret;
+  }
+
+  dd_set_instance(ctx, instance);
+
+  ctx->frame = 1;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Capture next frame into ctx->data_buf and timestamp it
+/// \return #mxt_rc
+int mxt_dd_stream_frame(struct mxt_device *mxt, struct t37_ctx *ctx)
+{
+  int ret;
+
+  ret = dd_read_frame(mxt, ctx);
+  if (ret)
+    return ret;
+
+  ctx->frame++;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Retrieve data from the T37 Diagnostic Data object
+/// \return #mxt_rc
+int mxt_debug_dump(struct mxt_device *mxt, int mode, const char *csv_file,
+                   uint16_t frames, uint16_t instance, uint16_t format, uint16_t file_attr,
+                   uint16_t ring_frames, const struct dd_roi *roi)
+{
+  struct t37_ctx ctx;
+  struct dd_ring ring;
+  struct dd_roi selection;
+  uint64_t start_ns;
+  int ret, stop_ret;
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.lc = mxt->ctx;
+  ctx.mxt = mxt;
+  ctx.mode = mode;
+  ctx.fformat = (format == DD_FORMAT_MATRIX);
+  ctx.binary = (format == DD_FORMAT_BINARY || format == DD_FORMAT_DELTA);
+  ctx.file_attr = file_attr;
+  ctx.ts_info = NULL;
+  ctx.file_buf = NULL;
+  ctx.capture_buf = NULL;
+
+  if (frames == 0) {
+    mxt_warn(ctx.lc, "Warning: Defaulting to 1 frame");
+    frames = 1;
+  }
+
+  ret = mxt_debug_dump_initialise(mxt, &ctx);
+  if (ret)
+    return ret;
+
+  dd_set_instance(&ctx, instance);
+
+  /* Touchscreen geometry for format 1 does not change during capture */
+  if (ctx.fformat && !ctx.self_cap && !ctx.active_stylus && !ctx.t15_keyarray) {
+    ret = mxt_read_touchscreen_info(mxt, &ctx.ts_info);
+    if (ret) {
+      mxt_err(ctx.lc, "Read touchscreen info failed");
+      goto free;
+    }
+  }
+
+  /* The capture header has no room for the origin of a region, passes and
+   * axes keep the full frame layout with unread values left at zero */
+  if (ctx.binary && roi && roi->enabled) {
+    mxt_warn(ctx.lc, "Warning: Region of interest not supported with binary capture, capturing full frame");
+    selection = *roi;
+    selection.enabled = false;
+    roi = &selection;
+  }
+
+  ret = mxt_dd_set_roi(&ctx, roi);
+  if (ret)
+    goto free;
+
+  if (ctx.binary) {
+    ctx.capture_size = sizeof(struct mxt_capture_record)
+                       + ctx.data_values * sizeof(uint16_t);
+    ctx.capture_buf = (uint8_t *)calloc(1, ctx.capture_size);
+    if (!ctx.capture_buf
+        || (format == DD_FORMAT_DELTA && dd_delta_init(&ctx))) {
+      mxt_err(ctx.lc, "calloc failure");
+      ret = MXT_ERROR_NO_MEM;
+      goto free;
+    }
+
+    if (ctx.file_attr == 1)
+      mxt_warn(ctx.lc, "Warning: Binary capture cannot be appended, overwriting");
+
+    ctx.hawkeye = fopen(csv_file, "wb");
+
+  /* Append or overwrite check */
+  /* Open Hawkeye output file */
+  } else if (ctx.file_attr == 1) {
+    ctx.hawkeye = fopen(csv_file, "a");
   } else {
     ctx.hawkeye = fopen(csv_file, "w");
   }
@@ -1013,48 +1988,342 @@ int mxt_debug_dump(struct mxt_device *mxt, int mode, const char *csv_file,
     goto free;
   }
 
-  ret = mxt_generate_hawkeye_header(&ctx);
+  ctx.file_buf = (char *)malloc(DD_FILE_BUFFER_SIZE);
+  if (ctx.file_buf)
+    setvbuf(ctx.hawkeye, ctx.file_buf, _IOFBF, DD_FILE_BUFFER_SIZE);
+
+  if (ctx.binary)
+    ret = mxt_capture_write_header(&ctx);
+  else
+    ret = mxt_generate_hawkeye_header(&ctx);
   if (ret)
     goto close;
 
+  /* Output from a separate thread so file stalls do not delay acquisition */
+  if (ring_frames) {
+    ret = dd_ring_start(&ring, &ctx, ring_frames);
+    if (ret)
+      goto close;
+  }
+
   mxt_info(ctx.lc, "Reading %u frames", frames);
 
-  t1 = time(NULL);
+  start_ns = mxt_time_ns();
 
   for (ctx.frame = 1; ctx.frame <= frames; ctx.frame++) {
-    if (ctx.self_cap) {
-      ret = mxt_read_diagnostic_data_self_cap(&ctx);
-    } else if (ctx.active_stylus) {
-      ret = mxt_read_diagnostic_data_ast(&ctx);
-    } else if (ctx.t15_keyarray) {
-      ret = mxt_read_diagnostic_data_t15key(&ctx);
-    } else { /* Mutual */
-      ret = mxt_read_diagnostic_data_frame(mxt, &ctx);
-    }
+    ret = dd_read_frame(mxt, &ctx);
     if (ret)
-      goto close;
+      break;
 
-    ret = mxt_hawkeye_output(&ctx);
+    if (ring_frames)
+      ret = dd_ring_push(&ring, &ctx);
+    else
+      ret = dd_output_frame(&ctx);
+    if (ret)
+      break;
+  }
+
+  if (ring_frames) {
+    stop_ret = dd_ring_stop(&ring, &ctx);
+    if (!ret)
+      ret = stop_ret;
+  }
+
+  if (ret)
+    goto close;
+
+  if (ctx.delta) {
+    ret = dd_delta_finish(&ctx);
     if (ret)
       goto close;
   }
 
-  t2 = time(NULL);
-  mxt_info(ctx.lc, "%u frames in %d seconds", frames, (int)(t2-t1));
+  mxt_info(ctx.lc, "%u frames in %.3f seconds", frames,
+           (mxt_time_ns() - start_ns) / 1e9);
+  dd_timing_report(&ctx);
 
   ret = MXT_SUCCESS;
 
 close:
-  fclose(ctx.hawkeye);
+  /* Buffered data is only written out here */
+  if (fclose(ctx.hawkeye) && ret == MXT_SUCCESS)
+    ret = MXT_ERROR_IO;
 free:
+  free(ctx.file_buf);
+  ctx.file_buf = NULL;
+  free(ctx.capture_buf);
+  ctx.capture_buf = NULL;
+  dd_delta_free(&ctx);
+  free(ctx.ts_info);
+  ctx.ts_info = NULL;
   free(ctx.data_buf);
   ctx.data_buf = NULL;
+  free(ctx.temp_buf);
+  ctx.temp_buf = NULL;
   free(ctx.t37_buf);
   ctx.t37_buf = NULL;
 
   return ret;
 }
 
+//******************************************************************************
+/// \brief Show diagnostic data as a heatmap on the terminal until Ctrl-C
+/// \note  Drawing runs on the ring writer thread, so a slow terminal drops
+///        frames from the display rather than slowing acquisition
+/// \return #mxt_rc
+int mxt_dd_live(struct mxt_device *mxt, int mode, uint16_t instance,
+                uint16_t ring_frames, const struct dd_roi *roi)
+{
+  struct t37_ctx ctx;
+  struct dd_ring ring;
+  struct live_ctx live;
+  struct sigaction sa;
+  int ret, stop_ret;
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.lc = mxt->ctx;
+  ctx.mxt = mxt;
+  ctx.mode = mode;
+
+  ret = mxt_debug_dump_initialise(mxt, &ctx);
+  if (ret)
+    goto free;
+
+  dd_set_instance(&ctx, instance);
+
+  ret = mxt_dd_set_roi(&ctx, roi);
+  if (ret)
+    goto free;
+
+  ret = live_init(&live, &ctx, stdout);
+  if (ret)
+    goto free;
+
+  ctx.live = &live;
+
+  ret = dd_ring_start(&ring, &ctx,
+                      ring_frames ? ring_frames : LIVE_DEFAULT_RING_FRAMES);
+  if (ret)
+    goto free_live;
+
+  mxt_init_sigint_handler(mxt, &sa);
+
+  for (ctx.frame = 1; !mxt_sigint_rx; ctx.frame++) {
+    ret = dd_read_frame(mxt, &ctx);
+    if (ret)
+      break;
+
+    ret = dd_ring_push(&ring, &ctx);
+    if (ret)
+      break;
+  }
+
+  mxt_release_sigint_handler(mxt, &sa);
+
+  stop_ret = dd_ring_stop(&ring, &ctx);
+  if (!ret)
+    ret = stop_ret;
+
+  live_finish(&live);
+  dd_timing_report(&ctx);
+
+free_live:
+  live_free(&live);
+free:
+  mxt_dd_stream_stop(&ctx);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Convert binary capture file to Hawkeye CSV (format 0)
+/// \return #mxt_rc
+int mxt_convert_capture(struct libmaxtouch_ctx *lc, const char *capture_file,
+                        const char *csv_file)
+{
+  struct mxt_capture_header hdr;
+  struct mxt_capture_record *rec;
+  struct mxt_capture_delta_record drec;
+  struct mxt_capture_trailer trailer;
+  struct mxt_capture_clock clock;
+  struct mxt_device mxt;
+  struct t37_ctx ctx;
+  uint8_t *raw_info = NULL;
+  uint8_t *coded = NULL;
+  uint32_t frames = 0;
+  uint64_t ts_scale = 1;
+  bool delta;
+  long records_end = -1;
+  FILE *fp;
+  int ret;
+
+  memset(&mxt, 0, sizeof(mxt));
+  memset(&ctx, 0, sizeof(ctx));
+  mxt.ctx = lc;
+  ctx.lc = lc;
+  ctx.mxt = &mxt;
+
+  fp = fopen(capture_file, "rb");
+  if (!fp) {
+    mxt_err(lc, "Failed to open %s", capture_file);
+    return MXT_ERROR_IO;
+  }
+
+  if (fread(&hdr, sizeof(hdr), 1, fp) != 1
+      || memcmp(hdr.magic, MXT_CAPTURE_MAGIC, sizeof(hdr.magic))) {
+    mxt_err(lc, "%s is not a capture file", capture_file);
+    ret = MXT_ERROR_FILE_FORMAT;
+    goto close_in;
+  }
+
+  delta = (hdr.version == MXT_CAPTURE_VERSION_DELTA);
+
+  if ((hdr.version != MXT_CAPTURE_VERSION && !delta)
+      || hdr.header_size < sizeof(hdr)
+      || hdr.info_size < sizeof(struct mxt_id_info)
+      || (!delta && hdr.record_size != sizeof(*rec) + hdr.value_count * sizeof(uint16_t))) {
+    mxt_err(lc, "Unsupported capture file version %u", hdr.version);
+    ret = MXT_ERROR_FILE_FORMAT;
+    goto close_in;
+  }
+
+  /* Older captures have wall clock microsecond timestamps */
+  if (hdr.flags & MXT_CAPTURE_MONOTONIC) {
+    if (hdr.header_size < sizeof(hdr) + sizeof(clock)
+        || fread(&clock, sizeof(clock), 1, fp) != 1) {
+      mxt_err(lc, "%s has no clock reference", capture_file);
+      ret = MXT_ERROR_FILE_FORMAT;
+      goto close_in;
+    }
+
+    ctx.wall_base_ns = clock.wall_ns;
+    ctx.mono_base_ns = clock.monotonic_ns;
+  } else {
+    ts_scale = 1000;
+  }
+
+  /* Records end at the index, or at the end of an unfinished capture */
+  if (delta && !fseek(fp, -(long)sizeof(trailer), SEEK_END)
+      && fread(&trailer, sizeof(trailer), 1, fp) == 1
+      && !memcmp(trailer.magic, MXT_CAPTURE_INDEX_MAGIC, sizeof(trailer.magic)))
+    records_end = trailer.index_offset;
+
+  if (fseek(fp, hdr.header_size, SEEK_SET)) {
+    ret = mxt_errno_to_rc(errno);
+    goto close_in;
+  }
+
+  raw_info = (uint8_t *)calloc(1, hdr.info_size);
+  ctx.capture_size = sizeof(*rec) + hdr.value_count * sizeof(uint16_t);
+  ctx.capture_buf = (uint8_t *)calloc(1, ctx.capture_size);
+  ctx.key_buf = (uint8_t *)calloc(hdr.passes ? hdr.passes : 1, sizeof(uint8_t));
+  if (delta)
+    coded = (uint8_t *)malloc(MXT_CAPTURE_CODED_MAX(hdr.value_count));
+  if (!raw_info || !ctx.capture_buf || !ctx.key_buf || (delta && !coded)) {
+    mxt_err(lc, "calloc failure");
+    ret = MXT_ERROR_NO_MEM;
+    goto free;
+  }
+
+  if (fread(raw_info, hdr.info_size, 1, fp) != 1) {
+    ret = MXT_ERROR_FILE_FORMAT;
+    goto free;
+  }
+
+  if ((hdr.flags & MXT_CAPTURE_T15_KEYARRAY)
+      && fread(ctx.key_buf, hdr.passes, 1, fp) != 1) {
+    ret = MXT_ERROR_FILE_FORMAT;
+    goto free;
+  }
+
+  mxt.info.raw_info = raw_info;
+  mxt.info.id = (struct mxt_id_info *)raw_info;
+
+  ctx.mode = hdr.mode;
+  ctx.self_cap = hdr.flags & MXT_CAPTURE_SELF_CAP;
+  ctx.active_stylus = hdr.flags & MXT_CAPTURE_ACTIVE_STYLUS;
+  ctx.t15_keyarray = hdr.flags & MXT_CAPTURE_T15_KEYARRAY;
+  ctx.x_size = hdr.x_size;
+  ctx.y_size = hdr.y_size;
+  ctx.passes = hdr.passes;
+  ctx.data_values = hdr.value_count;
+  ctx.fformat = false;
+
+  /* Values are output directly from the record */
+  rec = (struct mxt_capture_record *)ctx.capture_buf;
+  ctx.data_buf = (uint16_t *)(ctx.capture_buf + sizeof(*rec));
+
+  ctx.hawkeye = fopen(csv_file, "w");
+  if (!ctx.hawkeye) {
+    mxt_err(lc, "Failed to open %s", csv_file);
+    ret = MXT_ERROR_IO;
+    goto free;
+  }
+
+  ctx.file_buf = (char *)malloc(DD_FILE_BUFFER_SIZE);
+  if (ctx.file_buf)
+    setvbuf(ctx.hawkeye, ctx.file_buf, _IOFBF, DD_FILE_BUFFER_SIZE);
+
+  ret = mxt_generate_hawkeye_header(&ctx);
+  if (ret)
+    goto close_out;
+
+  while (delta) {
+    if ((records_end >= 0 && ftell(fp) >= records_end)
+        || fread(&drec, sizeof(drec), 1, fp) != 1)
+      break;
+
+    if (drec.size > MXT_CAPTURE_CODED_MAX(hdr.value_count)
+        || (drec.size && fread(coded, drec.size, 1, fp) != 1)
+        || mxt_capture_decode(coded, drec.size, drec.keyframe, ctx.data_buf,
+                              ctx.data_values)) {
+      mxt_err(lc, "Bad delta coded frame after %u frames", frames);
+      ret = MXT_ERROR_FILE_FORMAT;
+      goto close_out;
+    }
+
+    ctx.frame = drec.frame;
+    ctx.frame_time_ns = drec.timestamp * ts_scale;
+
+    ret = mxt_hawkeye_output(&ctx);
+    if (ret)
+      goto close_out;
+
+    frames++;
+  }
+
+  while (!delta && fread(ctx.capture_buf, ctx.capture_size, 1, fp) == 1) {
+    ctx.frame = rec->frame;
+    ctx.frame_time_ns = rec->timestamp * ts_scale;
+
+    ret = mxt_hawkeye_output(&ctx);
+    if (ret)
+      goto close_out;
+
+    frames++;
+  }
+
+  if (ferror(fp)) {
+    ret = MXT_ERROR_IO;
+    goto close_out;
+  }
+
+  mxt_info(lc, "Converted %u frames", frames);
+  ret = MXT_SUCCESS;
+
+close_out:
+  if (fclose(ctx.hawkeye) && ret == MXT_SUCCESS)
+    ret = MXT_ERROR_IO;
+free:
+  free(ctx.file_buf);
+  free(ctx.capture_buf);
+  free(ctx.key_buf);
+  free(coded);
+  free(raw_info);
+close_in:
+  fclose(fp);
+  return ret;
+}
+
 //******************************************************************************
 /// \brief Handle menu input for diagnostic data functions
 static void mxt_dd_cmd(struct mxt_device *mxt, char menu_1, char menu_2, const char *csv_file)
@@ -1078,11 +2347,11 @@ static void mxt_dd_cmd(struct mxt_device *mxt, char menu_1, char menu_2, const c
     switch (menu_2) {
     case 'd':
       if (ret == MXT_SUCCESS)
-        mxt_debug_dump(mxt, DELTAS_MODE, csv_file, frames, instance, format, file_attr);
+        mxt_debug_dump(mxt, DELTAS_MODE, csv_file, frames, instance, format, file_attr, 0, NULL);
       break;
     case 'r':
       if (ret == MXT_SUCCESS)
-        mxt_debug_dump(mxt, REFS_MODE, csv_file, frames, instance, format, file_attr);
+        mxt_debug_dump(mxt, REFS_MODE, csv_file, frames, instance, format, file_attr, 0, NULL);
       break;
         
     default:
@@ -1094,11 +2363,11 @@ static void mxt_dd_cmd(struct mxt_device *mxt, char menu_1, char menu_2, const c
     switch (menu_2) {
     case 'd':
       if (ret == MXT_SUCCESS)
-        mxt_debug_dump(mxt, SELF_CAP_DELTAS, csv_file, frames, instance, format, file_attr);
+        mxt_debug_dump(mxt, SELF_CAP_DELTAS, csv_file, frames, instance, format, file_attr, 0, NULL);
       break;
     case 'r':
       if (ret == MXT_SUCCESS) 
-        mxt_debug_dump(mxt, SELF_CAP_REFS, csv_file, frames, instance, format, file_attr);
+        mxt_debug_dump(mxt, SELF_CAP_REFS, csv_file, frames, instance, format, file_attr, 0, NULL);
       break;
         
       default:
@@ -1110,15 +2379,15 @@ static void mxt_dd_cmd(struct mxt_device *mxt, char menu_1, char menu_2, const c
     switch (menu_2) {
     case 'd':
       if (ret == MXT_SUCCESS)
-        mxt_debug_dump(mxt, KEY_DELTAS_MODE, csv_file, frames, instance, format, file_attr);
+        mxt_debug_dump(mxt, KEY_DELTAS_MODE, csv_file, frames, instance, format, file_attr, 0, NULL);
       break;
     case 'r':
       if (ret == MXT_SUCCESS) 
-        mxt_debug_dump(mxt, KEY_REFS_MODE, csv_file, frames, instance, format, file_attr);
+        mxt_debug_dump(mxt, KEY_REFS_MODE, csv_file, frames, instance, format, file_attr, 0, NULL);
       break;
     case 's':
       if (ret == MXT_SUCCESS)
-        mxt_debug_dump(mxt, KEY_SIGS_MODE, csv_file, frames, instance, format, file_attr); 
+        mxt_debug_dump(mxt, KEY_SIGS_MODE, csv_file, frames, instance, format, file_attr, 0, NULL); 
       break;
         
       default:
@@ -1130,11 +2399,11 @@ static void mxt_dd_cmd(struct mxt_device *mxt, char menu_1, char menu_2, const c
     switch (menu_2) {
     case 'd':
       if (ret == MXT_SUCCESS)
-        mxt_debug_dump(mxt, AST_DELTAS, csv_file, frames, instance, format, file_attr);
+        mxt_debug_dump(mxt, AST_DELTAS, csv_file, frames, instance, format, file_attr, 0, NULL);
       break;
     case 'r':
       if (ret == MXT_SUCCESS) 
-        mxt_debug_dump(mxt, AST_REFS, csv_file, frames, instance, format, file_attr);
+        mxt_debug_dump(mxt, AST_REFS, csv_file, frames, instance, format, file_attr, 0, NULL);
       break;
         
       default:
@@ -1420,27 +2689,17 @@ int16_t get_value(struct t37_ctx *ctx, int x, int y)
 /// \brief Calculate stats for the data frame
 int debug_frame_calc_stats(struct t37_ctx *ctx)
 {
-  int x, y;
-  ctx->mean = 0;
-  ctx->variance = 0;
+  struct frame_stats stats;
 
-  /* mean */
-  for (x = 0; x < ctx->x_size; x++) {
-    for (y = 0; y < ctx->y_size; y++) {
-      ctx->mean += get_value(ctx, x, y);
-    }
-  }
-  ctx->mean /= (ctx->x_size * ctx->y_size);
-  mxt_dbg(ctx->lc, "Mean of dataset: %0.2f", ctx->mean);
+  frame_kernels_get()->stats(ctx->data_buf, ctx->x_size * ctx->y_size, &stats);
 
-  /* variance */
-  for (x = 0; x < ctx->x_size; x++) {
-    for (y = 0; y < ctx->y_size; y++) {
-      ctx->variance += fabs(get_value(ctx, x, y) - ctx->mean);
-    }
-  }
-  ctx->variance /= (ctx->x_size * ctx->y_size);
+  ctx->mean = stats.mean;
+  ctx->variance = stats.variance;
+  ctx->min_value = stats.min;
+  ctx->max_value = stats.max;
+  mxt_dbg(ctx->lc, "Mean of dataset: %0.2f", ctx->mean);
   mxt_dbg(ctx->lc, "Variance of dataset: %0.2f", ctx->variance);
+  mxt_dbg(ctx->lc, "Range of dataset: %d to %d", ctx->min_value, ctx->max_value);
 
   /* standard deviation */
   ctx->std_dev = sqrt(ctx->variance);
@@ -1453,13 +2712,11 @@ int debug_frame_calc_stats(struct t37_ctx *ctx)
 /// \brief Normalise a data frame
 int debug_frame_normalise(struct t37_ctx *ctx)
 {
-  int x, y;
-  for (x = 0; x < ctx->x_size; x++) {
-    for (y = 0; y < ctx->y_size; y++) {
-      ctx->data_buf[x * ctx->y_size + y] =
-        (ctx->data_buf[x * ctx->y_size + y] - ctx->mean)/ctx->std_dev;
-    }
-  }
+  int i;
+
+  for (i = 0; i < ctx->x_size * ctx->y_size; i++)
+    ctx->data_buf[i] = ((int16_t)ctx->data_buf[i] - ctx->mean)/ctx->std_dev;
+
   return MXT_SUCCESS;
 
 }
@@ -0,0 +1,388 @@
+//------------------------------------------------------------------------------
+/// \file   frame_kernels.c
+/// \brief  Diagnostic frame processing kernels with SSE2/NEON variants
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "frame_kernels.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FRAME_KERNELS_SSE2 1
+#include <emmintrin.h>
+#define SSE2_FN __attribute__((target("sse2")))
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FRAME_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* Vectors summed into 32-bit lanes before they are folded into 64 bits,
+ * each lane gains at most 2 * 32768 per vector */
+#define STATS_BLOCK_VECTORS  16384
+
+//******************************************************************************
+/// \brief Convert accumulated sums to frame statistics
+static void stats_finish(struct frame_stats *stats, size_t count,
+                         int64_t sum, uint64_t sum_sq)
+{
+  double mean;
+
+  if (count == 0) {
+    memset(stats, 0, sizeof(*stats));
+    return;
+  }
+
+  mean = (double)sum / count;
+
+  stats->mean = mean;
+  stats->variance = (double)sum_sq / count - mean * mean;
+  if (stats->variance < 0)
+    stats->variance = 0;
+}
+
+//******************************************************************************
+/// \brief Scalar little-endian unpack
+static void unpack_le16_scalar(uint16_t *dst, const uint8_t *src, size_t count)
+{
+  size_t i;
+
+  for (i = 0; i < count; i++)
+    dst[i] = (src[2 * i + 1] << 8) | src[2 * i];
+}
+
+//******************************************************************************
+/// \brief Scalar interleave of one row
+static void interleave_row_scalar(uint16_t *dst, const uint16_t *src,
+                                  size_t start, size_t row_len)
+{
+  size_t half = row_len / 2;
+  size_t j;
+
+  for (j = start; j < half; j++) {
+    dst[2 * j] = src[j];
+    dst[2 * j + 1] = src[half + j];
+  }
+
+  if (row_len & 1)
+    dst[row_len - 1] = src[row_len - 1];
+}
+
+//******************************************************************************
+/// \brief Scalar interleave
+static void interleave_scalar(uint16_t *dst, const uint16_t *src, size_t rows,
+                              size_t row_len)
+{
+  size_t r;
+
+  for (r = 0; r < rows; r++)
+    interleave_row_scalar(dst + r * row_len, src + r * row_len, 0, row_len);
+}
+
+//******************************************************************************
+/// \brief Scalar statistics over values from start to count
+static void stats_tail(const uint16_t *data, size_t start, size_t count,
+                       int64_t *sum, uint64_t *sum_sq,
+                       int16_t *min, int16_t *max)
+{
+  size_t i;
+  int16_t v;
+
+  for (i = start; i < count; i++) {
+    v = (int16_t)data[i];
+
+    *sum += v;
+    *sum_sq += (int32_t)v * v;
+
+    if (v < *min)
+      *min = v;
+    if (v > *max)
+      *max = v;
+  }
+}
+
+//******************************************************************************
+/// \brief Scalar statistics
+static void stats_scalar(const uint16_t *data, size_t count,
+                         struct frame_stats *stats)
+{
+  int64_t sum = 0;
+  uint64_t sum_sq = 0;
+  int16_t min = INT16_MAX;
+  int16_t max = INT16_MIN;
+
+  stats_tail(data, 0, count, &sum, &sum_sq, &min, &max);
+  stats_finish(stats, count, sum, sum_sq);
+  stats->min = count ? min : 0;
+  stats->max = count ? max : 0;
+}
+
+const struct frame_kernels frame_kernels_scalar = {
+  .name = "scalar",
+  .unpack_le16 = unpack_le16_scalar,
+  .interleave = interleave_scalar,
+  .stats = stats_scalar,
+};
+
+#if defined(FRAME_KERNELS_SSE2) || defined(FRAME_KERNELS_NEON)
+//******************************************************************************
+/// \brief Little-endian unpack for little-endian SIMD hosts
+/// \note  T37 words are already in host order, so this is a straight copy
+static void unpack_le16_copy(uint16_t *dst, const uint8_t *src, size_t count)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  memcpy(dst, src, count * sizeof(uint16_t));
+#else
+  unpack_le16_scalar(dst, src, count);
+#endif
+}
+#endif
+
+#ifdef FRAME_KERNELS_SSE2
+//******************************************************************************
+/// \brief SSE2 interleave
+SSE2_FN static void interleave_sse2(uint16_t *dst, const uint16_t *src,
+                                    size_t rows, size_t row_len)
+{
+  size_t half = row_len / 2;
+  const uint16_t *row;
+  uint16_t *out;
+  __m128i a, b;
+  size_t r, j;
+
+  for (r = 0; r < rows; r++) {
+    row = src + r * row_len;
+    out = dst + r * row_len;
+
+    for (j = 0; j + 8 <= half; j += 8) {
+      a = _mm_loadu_si128((const __m128i *)(row + j));
+      b = _mm_loadu_si128((const __m128i *)(row + half + j));
+
+      _mm_storeu_si128((__m128i *)(out + 2 * j), _mm_unpacklo_epi16(a, b));
+      _mm_storeu_si128((__m128i *)(out + 2 * j + 8), _mm_unpackhi_epi16(a, b));
+    }
+
+    interleave_row_scalar(out, row, j, row_len);
+  }
+}
+
+//******************************************************************************
+/// \brief SSE2 statistics
+SSE2_FN static void stats_sse2(const uint16_t *data, size_t count,
+                               struct frame_stats *stats)
+{
+  const __m128i ones = _mm_set1_epi16(1);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i vmin = _mm_set1_epi16(INT16_MAX);
+  __m128i vmax = _mm_set1_epi16(INT16_MIN);
+  __m128i vsum, vsq, sq, v;
+  int32_t lanes32[4];
+  uint64_t lanes64[2];
+  int16_t lanes16[8];
+  int64_t sum = 0;
+  uint64_t sum_sq = 0;
+  int16_t min, max;
+  size_t i = 0;
+  size_t block;
+  int k;
+
+  vsq = _mm_setzero_si128();
+
+  while (i + 8 <= count) {
+    vsum = _mm_setzero_si128();
+
+    for (block = 0; block < STATS_BLOCK_VECTORS && i + 8 <= count; block++, i += 8) {
+      v = _mm_loadu_si128((const __m128i *)(data + i));
+
+      vmin = _mm_min_epi16(vmin, v);
+      vmax = _mm_max_epi16(vmax, v);
+
+      vsum = _mm_add_epi32(vsum, _mm_madd_epi16(v, ones));
+
+      /* Pairs of squares fit in unsigned 32 bits, widen before adding */
+      sq = _mm_madd_epi16(v, v);
+      vsq = _mm_add_epi64(vsq, _mm_unpacklo_epi32(sq, zero));
+      vsq = _mm_add_epi64(vsq, _mm_unpackhi_epi32(sq, zero));
+    }
+
+    _mm_storeu_si128((__m128i *)lanes32, vsum);
+    for (k = 0; k < 4; k++)
+      sum += lanes32[k];
+  }
+
+  _mm_storeu_si128((__m128i *)lanes64, vsq);
+  sum_sq = lanes64[0] + lanes64[1];
+
+  _mm_storeu_si128((__m128i *)lanes16, vmin);
+  min = INT16_MAX;
+  for (k = 0; k < 8; k++)
+    if (lanes16[k] < min)
+      min = lanes16[k];
+
+  _mm_storeu_si128((__m128i *)lanes16, vmax);
+  max = INT16_MIN;
+  for (k = 0; k < 8; k++)
+    if (lanes16[k] > max)
+      max = lanes16[k];
+
+  stats_tail(data, i, count, &sum, &sum_sq, &min, &max);
+  stats_finish(stats, count, sum, sum_sq);
+  stats->min = count ? min : 0;
+  stats->max = count ? max : 0;
+}
+
+static const struct frame_kernels frame_kernels_sse2 = {
+  .name = "sse2",
+  .unpack_le16 = unpack_le16_copy,
+  .interleave = interleave_sse2,
+  .stats = stats_sse2,
+};
+#endif /* FRAME_KERNELS_SSE2 */
+
+#ifdef FRAME_KERNELS_NEON
+//******************************************************************************
+/// \brief NEON interleave
+static void interleave_neon(uint16_t *dst, const uint16_t *src, size_t rows,
+                            size_t row_len)
+{
+  size_t half = row_len / 2;
+  const uint16_t *row;
+  uint16_t *out;
+  uint16x8x2_t pair;
+  size_t r, j;
+
+  for (r = 0; r < rows; r++) {
+    row = src + r * row_len;
+    out = dst + r * row_len;
+
+    for (j = 0; j + 8 <= half; j += 8) {
+      pair.val[0] = vld1q_u16(row + j);
+      pair.val[1] = vld1q_u16(row + half + j);
+
+      /* Interleaving store */
+      vst2q_u16(out + 2 * j, pair);
+    }
+
+    interleave_row_scalar(out, row, j, row_len);
+  }
+}
+
+//******************************************************************************
+/// \brief NEON statistics
+static void stats_neon(const uint16_t *data, size_t count,
+                       struct frame_stats *stats)
+{
+  int16x8_t vmin = vdupq_n_s16(INT16_MAX);
+  int16x8_t vmax = vdupq_n_s16(INT16_MIN);
+  int64x2_t vsq = vdupq_n_s64(0);
+  int32x4_t vsum;
+  int16x8_t v;
+  int32_t lanes32[4];
+  int64_t lanes64[2];
+  int16_t lanes16[8];
+  int64_t sum = 0;
+  uint64_t sum_sq = 0;
+  int16_t min, max;
+  size_t i = 0;
+  size_t block;
+  int k;
+
+  while (i + 8 <= count) {
+    vsum = vdupq_n_s32(0);
+
+    for (block = 0; block < STATS_BLOCK_VECTORS && i + 8 <= count; block++, i += 8) {
+      v = vreinterpretq_s16_u16(vld1q_u16(data + i));
+
+      vmin = vminq_s16(vmin, v);
+      vmax = vmaxq_s16(vmax, v);
+
+      vsum = vpadalq_s16(vsum, v);
+
+      vsq = vpadalq_s32(vsq, vmull_s16(vget_low_s16(v), vget_low_s16(v)));
+      vsq = vpadalq_s32(vsq, vmull_s16(vget_high_s16(v), vget_high_s16(v)));
+    }
+
+    vst1q_s32(lanes32, vsum);
+    for (k = 0; k < 4; k++)
+      sum += lanes32[k];
+  }
+
+  vst1q_s64(lanes64, vsq);
+  sum_sq = lanes64[0] + lanes64[1];
+
+  vst1q_s16(lanes16, vmin);
+  min = INT16_MAX;
+  for (k = 0; k < 8; k++)
+    if (lanes16[k] < min)
+      min = lanes16[k];
+
+  vst1q_s16(lanes16, vmax);
+  max = INT16_MIN;
+  for (k = 0; k < 8; k++)
+    if (lanes16[k] > max)
+      max = lanes16[k];
+
+  stats_tail(data, i, count, &sum, &sum_sq, &min, &max);
+  stats_finish(stats, count, sum, sum_sq);
+  stats->min = count ? min : 0;
+  stats->max = count ? max : 0;
+}
+
+static const struct frame_kernels frame_kernels_neon = {
+  .name = "neon",
+  .unpack_le16 = unpack_le16_copy,
+  .interleave = interleave_neon,
+  .stats = stats_neon,
+};
+#endif /* FRAME_KERNELS_NEON */
+
+//******************************************************************************
+/// \brief Pick the best implementation for the running CPU
+static const struct frame_kernels *frame_kernels_select(void)
+{
+#ifdef FRAME_KERNELS_SSE2
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    return &frame_kernels_sse2;
+#elif defined(FRAME_KERNELS_NEON)
+  return &frame_kernels_neon;
+#endif
+
+  return &frame_kernels_scalar;
+}
+
+//******************************************************************************
+/// \brief Get frame kernels for this CPU, selected on first use
+const struct frame_kernels *frame_kernels_get(void)
+{
+  static const struct frame_kernels *selected;
+
+  if (!selected)
+    selected = frame_kernels_select();
+
+  return selected;
+}
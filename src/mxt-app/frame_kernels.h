@@ -0,0 +1,61 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   frame_kernels.h
+/// \brief  Diagnostic frame processing kernels
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdint.h>
+
+//******************************************************************************
+/// \brief Statistics of a frame of signed 16-bit values
+struct frame_stats {
+  double mean;
+  double variance;
+  int16_t min;
+  int16_t max;
+};
+
+//******************************************************************************
+/// \brief Frame kernel implementation
+struct frame_kernels {
+  const char *name;
+
+  /* Convert count little-endian T37 words to host order */
+  void (*unpack_le16)(uint16_t *dst, const uint8_t *src, size_t count);
+
+  /* Interleave the two halves of each row: dst[2j] = src[j],
+   * dst[2j+1] = src[row_len/2 + j]. An odd last value stays in place */
+  void (*interleave)(uint16_t *dst, const uint16_t *src, size_t rows,
+                     size_t row_len);
+
+  /* Mean, population variance, minimum and maximum in a single pass */
+  void (*stats)(const uint16_t *data, size_t count, struct frame_stats *stats);
+};
+
+extern const struct frame_kernels frame_kernels_scalar;
+
+const struct frame_kernels *frame_kernels_get(void);
@@ -108,66 +108,106 @@ static int mxt_gr_get_status(struct mxt_device *mxt, uint8_t *msg,
 }
 
 //******************************************************************************
-/// \brief Send command then check status
+/// \brief Step of the golden reference sequence, and the T66 state which
+///        shows it has finished
+struct gr_step {
+  const char *name;
+  uint8_t cmd;
+  uint8_t wanted_fcal_state;
+  uint8_t wanted_statebit;
+};
+
+static const struct gr_step gr_steps[] = {
+  { "Priming",    GR_FCALCMD_PRIME,    GR_STATE_PRIMED,    GR_STATE_PRIMED },
+  { "Generating", GR_FCALCMD_GENERATE, GR_STATE_GENERATED, GR_STATE_FCALPASS },
+  { "Storing",    GR_FCALCMD_STORE,    GR_STATE_IDLE,      GR_STATE_FCALSEQDONE },
+};
+
+#define GR_NUM_STEPS  (int)(sizeof(gr_steps) / sizeof(gr_steps[0]))
+
+//******************************************************************************
+/// \brief Golden reference sequence state
+struct gr_seq {
+  uint16_t addr;
+  int step;
+};
+
+//******************************************************************************
+/// \brief Write the command of the current step to the ctrl register
 /// \return #mxt_rc
-static int mxt_gr_run_command(struct mxt_device *mxt, uint16_t addr, uint8_t cmd,
-                              uint8_t wanted_fcal_state, uint8_t wanted_statebit)
+static int mxt_gr_dispatch(struct mxt_device *mxt, struct gr_seq *seq)
 {
-  int ret;
-  uint8_t actual_state;
-
-  cmd |= GR_ENABLE | GR_RPTEN;
+  const struct gr_step *step = &gr_steps[seq->step];
+  uint8_t cmd = step->cmd | GR_ENABLE | GR_RPTEN;
 
+  mxt_info(mxt->ctx, "%s", step->name);
   mxt_info(mxt->ctx, "Writing %u to ctrl register", cmd);
-  ret = mxt_write_register(mxt, &cmd, addr + GR_CTRL, 1);
-  if (ret)
-    return ret;
 
-  ret = mxt_read_messages_sigint(mxt, GR_TIMEOUT, &actual_state, mxt_gr_get_status);
-  if (ret)
+  return mxt_write_register(mxt, &cmd, seq->addr + GR_CTRL, 1);
+}
+
+//******************************************************************************
+/// \brief Check the state reached by a step and start the next one
+/// \return #mxt_rc
+static int mxt_gr_handle_messages(struct mxt_device *mxt, uint8_t *msg,
+                                  void *context, uint8_t size)
+{
+  struct gr_seq *seq = context;
+  const struct gr_step *step = &gr_steps[seq->step];
+  uint8_t actual_state;
+  int ret;
+
+  ret = mxt_gr_get_status(mxt, msg, &actual_state, size);
+  if (ret == MXT_MSG_CONTINUE)
     return ret;
 
-  if (((actual_state & GR_STATE_FCALSTATE_MASK) == wanted_fcal_state)
-      && (actual_state & wanted_statebit)) {
-    return MXT_SUCCESS;
-  } else {
+  if (((actual_state & GR_STATE_FCALSTATE_MASK) != step->wanted_fcal_state)
+      || !(actual_state & step->wanted_statebit)) {
     mxt_err(mxt->ctx, "Failed to enter correct state");
     return MXT_ERROR_UNEXPECTED_DEVICE_STATE;
   }
+
+  if (++seq->step == GR_NUM_STEPS)
+    return MXT_SUCCESS;
+
+  ret = mxt_gr_dispatch(mxt, seq);
+  if (ret)
+    return ret;
+
+  return MXT_MSG_CONTINUE;
 }
 
 //******************************************************************************
 /// \brief Store golden reference calibration
+/// \note  Each command is written as soon as the T66 status of the previous
+///        one is received, within a single message read loop
 int mxt_store_golden_refs(struct mxt_device *mxt)
 {
-  uint16_t addr;
+  struct gr_seq seq;
   int ret;
 
   ret = mxt_msg_reset(mxt);
   if (ret)
     return ret;
 
-  addr = mxt_get_object_address(mxt, SPT_GOLDENREFERENCES_T66, 0);
-  if (addr == OBJECT_NOT_FOUND)
+  memset(&seq, 0, sizeof(seq));
+
+  seq.addr = mxt_get_object_address(mxt, SPT_GOLDENREFERENCES_T66, 0);
+  if (seq.addr == OBJECT_NOT_FOUND)
     return MXT_ERROR_OBJECT_NOT_FOUND;
 
-  mxt_info(mxt->ctx, "Priming");
-  ret = mxt_gr_run_command(mxt, addr, GR_FCALCMD_PRIME,
-                           GR_STATE_PRIMED, GR_STATE_PRIMED);
+  ret = mxt_gr_dispatch(mxt, &seq);
   if (ret)
     return ret;
 
-  mxt_info(mxt->ctx, "Generating");
-  ret = mxt_gr_run_command(mxt, addr, GR_FCALCMD_GENERATE,
-                           GR_STATE_GENERATED, GR_STATE_FCALPASS);
+  ret = mxt_read_messages_sigint(mxt, GR_TIMEOUT * GR_NUM_STEPS, &seq,
+                                 mxt_gr_handle_messages);
   if (ret)
     return ret;
 
-  mxt_info(mxt->ctx, "Storing");
-  ret = mxt_gr_run_command(mxt, addr, GR_FCALCMD_STORE,
-                           GR_STATE_IDLE, GR_STATE_FCALSEQDONE);
-  if (ret)
-    return ret;
+  /* Interrupted before the last step */
+  if (seq.step != GR_NUM_STEPS)
+    return MXT_ERROR_INTERRUPTED;
 
   mxt_info(mxt->ctx, "Done");
   return MXT_SUCCESS;
@@ -0,0 +1,375 @@
+//------------------------------------------------------------------------------
+/// \file   live.c
+/// \brief  Live terminal heatmap of diagnostic data
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/log.h"
+#include "libmaxtouch/utilfuncs.h"
+
+#include "mxt_app.h"
+#include "live.h"
+
+/* First row of the matrix, after the title and column labels */
+#define LIVE_FIRST_ROW        3
+
+/* Smallest range of the delta colour scale, so noise stays dark */
+#define LIVE_MIN_DELTA_SCALE  32
+
+/* Escape sequences and text of one cell, with margin */
+#define LIVE_CELL_BYTES       40
+
+/* 256 colour palette backgrounds, low to high */
+static const uint8_t live_ramp[] = {
+  17, 19, 20, 26, 32, 38, 44, 83, 190, 220, 208, 202, 196
+};
+
+/* Blue for negative, grey about zero, red for positive */
+static const uint8_t live_diverging[] = {
+  21, 27, 33, 39, 45, 236, 215, 209, 203, 197, 196
+};
+
+//******************************************************************************
+/// \brief Get the value shown in a cell
+static int32_t live_value(const struct t37_ctx *ctx, int row, int col)
+{
+  uint16_t raw;
+
+  if (ctx->self_cap) {
+    raw = ctx->data_buf[row * (ctx->y_size + ctx->x_size) + col];
+    return (ctx->mode == SELF_CAP_DELTAS) ? (int16_t)raw : raw;
+  }
+
+  raw = ctx->data_buf[row * ctx->y_size + col];
+  return (ctx->mode == DELTAS_MODE) ? (int16_t)raw : raw;
+}
+
+//******************************************************************************
+/// \brief Get the name of the capture mode for the title
+static const char *live_mode_name(uint8_t mode)
+{
+  switch (mode) {
+  case DELTAS_MODE:
+    return "mutual deltas";
+  case REFS_MODE:
+    return "mutual references";
+  case SELF_CAP_DELTAS:
+    return "self cap deltas";
+  case SELF_CAP_REFS:
+    return "self cap references";
+  case SELF_CAP_SIGNALS:
+    return "self cap signals";
+  default:
+    return "diagnostic data";
+  }
+}
+
+//******************************************************************************
+/// \brief Allocate live view of the frames captured in ctx
+/// \return #mxt_rc
+int live_init(struct live_ctx *live, const struct t37_ctx *ctx, FILE *out)
+{
+  memset(live, 0, sizeof(*live));
+  live->out = out;
+
+  if (ctx->self_cap) {
+    live->rows = ctx->passes;
+    live->cols = ctx->y_size + ctx->x_size;
+    live->diverging = (ctx->mode == SELF_CAP_DELTAS);
+  } else if (!ctx->active_stylus && !ctx->t15_keyarray
+             && (ctx->mode == DELTAS_MODE || ctx->mode == REFS_MODE)) {
+    live->rows = ctx->x_size;
+    live->cols = ctx->y_size;
+    live->diverging = (ctx->mode == DELTAS_MODE);
+  } else {
+    mxt_err(ctx->lc, "Live view supports mutual or self cap data only");
+    return MXT_ERROR_NOT_SUPPORTED;
+  }
+
+  live->shown = (int32_t *)calloc(live->rows * live->cols, sizeof(int32_t));
+  live->buf_size = (size_t)(live->rows * live->cols + live->rows + live->cols)
+                   * LIVE_CELL_BYTES + 1024;
+  live->buf = (char *)malloc(live->buf_size);
+  if (!live->shown || !live->buf) {
+    live_free(live);
+    return MXT_ERROR_NO_MEM;
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Free live view buffers
+void live_free(struct live_ctx *live)
+{
+  free(live->shown);
+  live->shown = NULL;
+  free(live->buf);
+  live->buf = NULL;
+}
+
+//******************************************************************************
+/// \brief Widen the colour scale to take in the frame
+/// \return true if the scale changed and every cell must be redrawn
+static bool live_update_scale(struct live_ctx *live, const struct t37_ctx *ctx)
+{
+  int32_t min = INT32_MAX;
+  int32_t max = INT32_MIN;
+  int32_t value, margin;
+  int row, col;
+
+  for (row = 0; row < live->rows; row++) {
+    for (col = 0; col < live->cols; col++) {
+      value = live_value(ctx, row, col);
+      if (value < min)
+        min = value;
+      if (value > max)
+        max = value;
+    }
+  }
+
+  if (live->drawn && min >= live->scale_min && max <= live->scale_max)
+    return false;
+
+  /* Leave headroom so that the scale does not change on every frame */
+  if (live->drawn) {
+    margin = (live->scale_max - live->scale_min) / 8;
+    if (min < live->scale_min)
+      live->scale_min = min - margin;
+    if (max > live->scale_max)
+      live->scale_max = max + margin;
+  } else {
+    live->scale_min = min;
+    live->scale_max = max;
+  }
+
+  if (live->diverging) {
+    max = (-live->scale_min > live->scale_max) ? -live->scale_min
+                                               : live->scale_max;
+    if (max < LIVE_MIN_DELTA_SCALE)
+      max = LIVE_MIN_DELTA_SCALE;
+    live->scale_min = -max;
+    live->scale_max = max;
+  } else if (live->scale_max == live->scale_min) {
+    live->scale_max++;
+  }
+
+  return true;
+}
+
+//******************************************************************************
+/// \brief Get the background colour of a value on the current scale
+static uint8_t live_colour(const struct live_ctx *live, int32_t value)
+{
+  const uint8_t *ramp = live->diverging ? live_diverging : live_ramp;
+  int n = live->diverging ? sizeof(live_diverging) : sizeof(live_ramp);
+  int64_t range = (int64_t)live->scale_max - live->scale_min;
+  int64_t i;
+
+  i = (((int64_t)value - live->scale_min) * (n - 1) + range / 2) / range;
+  if (i < 0)
+    i = 0;
+  else if (i >= n)
+    i = n - 1;
+
+  return ramp[i];
+}
+
+//******************************************************************************
+/// \brief Append one cell, positioned and coloured, to the output buffer
+static char *live_put_cell(struct live_ctx *live, char *p, const char *end,
+                           int row, int col, int32_t value)
+{
+  /* Keep within the cell */
+  if (value > 99999)
+    value = 99999;
+  else if (value < -9999)
+    value = -9999;
+
+  p += snprintf(p, end - p, "\033[%d;%dH\033[97;48;5;%um%*d",
+                LIVE_FIRST_ROW + row, LIVE_CELL_WIDTH * (col + 1) + 1,
+                live_colour(live, value), LIVE_CELL_WIDTH, (int)value);
+
+  return p;
+}
+
+//******************************************************************************
+/// \brief Append the title, line labels and every cell to the output buffer
+static char *live_put_all(struct live_ctx *live, const struct t37_ctx *ctx,
+                          char *p, const char *end)
+{
+  char label[16];
+  int32_t value;
+  int row, col;
+
+  /* Hide cursor and clear */
+  p += snprintf(p, end - p, "\033[?25l\033[0m\033[2J\033[H");
+  p += snprintf(p, end - p, "%s, scale %d to %d, Ctrl-C to stop",
+                live_mode_name(ctx->mode), (int)live->scale_min,
+                (int)live->scale_max);
+
+  p += snprintf(p, end - p, "\033[%d;1H%*s", LIVE_FIRST_ROW - 1,
+                LIVE_CELL_WIDTH, "");
+  for (col = 0; col < live->cols; col++) {
+    if (ctx->self_cap && col >= ctx->y_size)
+      snprintf(label, sizeof(label), "X%d", col - ctx->y_size);
+    else
+      snprintf(label, sizeof(label), "Y%d", ctx->roi_y_origin + col);
+
+    p += snprintf(p, end - p, "%*s", LIVE_CELL_WIDTH, label);
+  }
+
+  for (row = 0; row < live->rows; row++) {
+    if (ctx->self_cap)
+      snprintf(label, sizeof(label), "P%d", row);
+    else
+      snprintf(label, sizeof(label), "X%d", ctx->roi_x_origin + row);
+
+    p += snprintf(p, end - p, "\033[0m\033[%d;1H%-*s", LIVE_FIRST_ROW + row,
+                  LIVE_CELL_WIDTH, label);
+
+    for (col = 0; col < live->cols; col++) {
+      value = live_value(ctx, row, col);
+      live->shown[row * live->cols + col] = value;
+      p = live_put_cell(live, p, end, row, col, value);
+    }
+  }
+
+  return p;
+}
+
+//******************************************************************************
+/// \brief Work out rates over the last status period
+/// \return true if the status line changed
+static bool live_update_status(struct live_ctx *live, const struct t37_ctx *ctx)
+{
+  const struct mxt_io_op_stats *rd = &live->io.ops[MXT_IO_READ];
+  uint64_t now = mxt_time_ns();
+  uint16_t frames;
+  double frame_s, display_s, reads;
+
+  if (live->window_ns && now - live->window_ns < LIVE_STATUS_PERIOD_NS)
+    return false;
+
+  frame_s = (ctx->frame_time_ns - live->window_frame_ns) / 1e9;
+  display_s = (now - live->window_ns) / 1e9;
+
+  if (live->window_ns && frame_s > 0) {
+    frames = ctx->frame - live->window_frame;
+    reads = rd->transactions - live->window_reads;
+
+    snprintf(live->status, sizeof(live->status),
+             "Frame %u  capture %.1f fps  display %.1f fps  dropped %u  "
+             "bus %.1f kB/s %.0f reads/s %.1f us/read  errors %" PRIu64,
+             ctx->frame, frames / frame_s,
+             (live->displayed - live->window_displayed) / display_s,
+             live->dropped,
+             (rd->bytes - live->window_read_bytes) / frame_s / 1000,
+             reads / frame_s,
+             reads ? (rd->total_us - live->window_read_us) / reads : 0.0,
+             rd->errors);
+  } else {
+    snprintf(live->status, sizeof(live->status), "Frame %u", ctx->frame);
+  }
+
+  live->window_ns = now;
+  live->window_frame = ctx->frame;
+  live->window_frame_ns = ctx->frame_time_ns;
+  live->window_displayed = live->displayed;
+  live->window_read_bytes = rd->bytes;
+  live->window_reads = rd->transactions;
+  live->window_read_us = rd->total_us;
+
+  return true;
+}
+
+//******************************************************************************
+/// \brief Draw the frame in ctx->data_buf, only rewriting changed cells
+/// \return #mxt_rc
+int live_render(struct live_ctx *live, const struct t37_ctx *ctx)
+{
+  const char *end = live->buf + live->buf_size;
+  char *p = live->buf;
+  bool redraw;
+  int32_t value;
+  int row, col;
+
+  redraw = live_update_scale(live, ctx);
+  if (redraw) {
+    p = live_put_all(live, ctx, p, end);
+    live->drawn = true;
+  } else {
+    for (row = 0; row < live->rows; row++) {
+      for (col = 0; col < live->cols; col++) {
+        value = live_value(ctx, row, col);
+        if (value == live->shown[row * live->cols + col])
+          continue;
+
+        live->shown[row * live->cols + col] = value;
+        p = live_put_cell(live, p, end, row, col, value);
+      }
+    }
+  }
+
+  live->displayed++;
+
+  /* Status below the matrix */
+  if (live_update_status(live, ctx) || redraw)
+    p += snprintf(p, end - p, "\033[0m\033[%d;1H\033[K%s",
+                  LIVE_FIRST_ROW + live->rows + 1, live->status);
+
+  if (p == live->buf)
+    return MXT_SUCCESS;
+
+  /* Park the cursor under the status line for log output */
+  p += snprintf(p, end - p, "\033[0m\033[%d;1H",
+                LIVE_FIRST_ROW + live->rows + 2);
+
+  if (fwrite(live->buf, p - live->buf, 1, live->out) != 1
+      || fflush(live->out))
+    return MXT_ERROR_IO;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Restore the terminal after the last frame
+void live_finish(struct live_ctx *live)
+{
+  if (!live->drawn)
+    return;
+
+  fprintf(live->out, "\033[0m\033[?25h\033[%d;1H",
+          LIVE_FIRST_ROW + live->rows + 2);
+  fflush(live->out);
+}
@@ -0,0 +1,83 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   live.h
+/// \brief  Live terminal heatmap of diagnostic data
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/* Characters per cell, values are clamped to fit */
+#define LIVE_CELL_WIDTH       5
+
+/* Frames held between acquisition and display */
+#define LIVE_DEFAULT_RING_FRAMES  4
+
+/* Status line update period */
+#define LIVE_STATUS_PERIOD_NS  500000000ULL
+
+struct t37_ctx;
+
+//******************************************************************************
+/// \brief Live heatmap state
+///
+/// Rendered from the ring writer thread. io and dropped are copied from the
+/// acquisition side under the ring lock before each frame.
+struct live_ctx
+{
+  FILE *out;
+  int rows;
+  int cols;
+  /* Signed values, colour scale is symmetric about zero */
+  bool diverging;
+  int32_t scale_min;
+  int32_t scale_max;
+  /* Values on screen, valid once drawn is set */
+  int32_t *shown;
+  bool drawn;
+  char *buf;
+  size_t buf_size;
+
+  struct mxt_io_stats io;
+  unsigned int dropped;
+
+  /* Rates over the last status period */
+  uint32_t displayed;
+  uint64_t window_ns;
+  uint32_t window_frame;
+  uint64_t window_frame_ns;
+  uint32_t window_displayed;
+  uint64_t window_read_bytes;
+  uint64_t window_reads;
+  uint64_t window_read_us;
+  char status[160];
+};
+
+int live_init(struct live_ctx *live, const struct t37_ctx *ctx, FILE *out);
+void live_free(struct live_ctx *live);
+int live_render(struct live_ctx *live, const struct t37_ctx *ctx);
+void live_finish(struct live_ctx *live);
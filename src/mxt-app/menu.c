@@ -245,7 +245,7 @@ static void print_messages_command(struct mxt_device *mxt)
   if (sscanf(tmp_buf, "%d", &msgs_timeout) == EOF)
     printf("Please Press Ctrl-C to Return to Main Menu.\n");
 
-  print_raw_messages(mxt, msgs_timeout, 0);
+  print_raw_messages(mxt, msgs_timeout, 0, false);
 
 }
 
@@ -0,0 +1,297 @@
+//------------------------------------------------------------------------------
+/// \file   monitor.c
+/// \brief  Continuous sensor health monitor
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <signal.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/log.h"
+
+#include "mxt_app.h"
+#include "monitor.h"
+
+/* Floor on the variance so that quiet nodes are not flagged for a count */
+#define MONITOR_MIN_VARIANCE  1.0
+
+//******************************************************************************
+/// \brief Allocate running statistics
+/// \return #mxt_rc
+static int monitor_stats_init(struct monitor_stats *st, int count)
+{
+  st->count = count;
+  st->mean = calloc(2 * count, sizeof(double));
+  st->out = calloc(count, sizeof(bool));
+  if (!st->mean || !st->out)
+    return MXT_ERROR_NO_MEM;
+
+  st->variance = st->mean + count;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Release monitor state
+void monitor_free(struct monitor_ctx *mon)
+{
+  free(mon->node.mean);
+  free(mon->node.out);
+  free(mon->xline.mean);
+  free(mon->xline.out);
+  free(mon->yline.mean);
+  free(mon->yline.out);
+  free(mon->x_avg);
+  memset(mon, 0, sizeof(*mon));
+}
+
+//******************************************************************************
+/// \brief Initialise monitor state for an x_size by y_size frame
+/// \return #mxt_rc
+int monitor_init(struct monitor_ctx *mon, int x_size, int y_size,
+                 uint16_t warmup, uint8_t sigma)
+{
+  int ret;
+
+  memset(mon, 0, sizeof(*mon));
+
+  mon->x_size = x_size;
+  mon->y_size = y_size;
+  mon->warmup = warmup ? warmup : 1;
+  mon->sigma = sigma;
+
+  ret = monitor_stats_init(&mon->node, x_size * y_size);
+  if (!ret)
+    ret = monitor_stats_init(&mon->xline, x_size);
+  if (!ret)
+    ret = monitor_stats_init(&mon->yline, y_size);
+  if (ret)
+    goto free;
+
+  mon->x_avg = calloc(x_size + y_size, sizeof(double));
+  if (!mon->x_avg) {
+    ret = MXT_ERROR_NO_MEM;
+    goto free;
+  }
+
+  mon->y_avg = mon->x_avg + x_size;
+
+  return MXT_SUCCESS;
+
+free:
+  monitor_free(mon);
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Update the statistics of one node or line with a new sample
+///
+/// The first warmup samples give the cumulative mean and variance. After
+/// that the statistics are exponentially weighted, and samples further
+/// than sigma standard deviations from the mean are flagged as out of
+/// bounds and left out so that a fault does not become the new baseline.
+/// \return true if the element went out of or back in bounds
+static bool monitor_sample(struct monitor_ctx *mon, struct monitor_stats *st,
+                           int i, double value)
+{
+  double d = value - st->mean[i];
+  double variance = st->variance[i];
+  double alpha;
+  bool out = false;
+
+  if (mon->samples <= mon->warmup) {
+    alpha = 1.0 / mon->samples;
+  } else {
+    alpha = 1.0 / mon->warmup;
+
+    if (variance < MONITOR_MIN_VARIANCE)
+      variance = MONITOR_MIN_VARIANCE;
+
+    out = (d * d > mon->sigma * mon->sigma * variance);
+  }
+
+  if (!out) {
+    st->mean[i] += alpha * d;
+    st->variance[i] = (1.0 - alpha) * (st->variance[i] + alpha * d * d);
+  }
+
+  if (out == st->out[i])
+    return false;
+
+  st->out[i] = out;
+  return true;
+}
+
+//******************************************************************************
+/// \brief Report a node or line that changed state
+static void monitor_report(struct monitor_ctx *mon, struct monitor_stats *st,
+                           int i, double value, const char *fmt, ...)
+{
+  char name[32];
+  va_list args;
+
+  va_start(args, fmt);
+  vsnprintf(name, sizeof(name), fmt, args);
+  va_end(args);
+
+  printf("Sample %u: %s %s bounds, value %0.1f mean %0.1f sd %0.1f\n",
+         mon->samples, name, st->out[i] ? "out of" : "back in", value,
+         st->mean[i], sqrt(st->variance[i]));
+}
+
+//******************************************************************************
+/// \brief Update monitor with a frame of x_size by y_size signed values
+/// \return number of nodes and lines that changed state
+int monitor_update(struct monitor_ctx *mon, const uint16_t *data)
+{
+  int events = 0;
+  int x, y;
+
+  mon->samples++;
+
+  for (y = 0; y < mon->y_size; y++)
+    mon->y_avg[y] = 0;
+
+  for (x = 0; x < mon->x_size; x++) {
+    const uint16_t *line = data + x * mon->y_size;
+    double sum = 0;
+
+    for (y = 0; y < mon->y_size; y++) {
+      double value = (int16_t)line[y];
+
+      if (monitor_sample(mon, &mon->node, x * mon->y_size + y, value)) {
+        monitor_report(mon, &mon->node, x * mon->y_size + y, value,
+                       "Node X%dY%d", x, y);
+        events++;
+      }
+
+      sum += value;
+      mon->y_avg[y] += value;
+    }
+
+    mon->x_avg[x] = sum / mon->y_size;
+  }
+
+  for (x = 0; x < mon->x_size; x++) {
+    if (monitor_sample(mon, &mon->xline, x, mon->x_avg[x])) {
+      monitor_report(mon, &mon->xline, x, mon->x_avg[x], "Line X%d", x);
+      events++;
+    }
+  }
+
+  for (y = 0; y < mon->y_size; y++) {
+    mon->y_avg[y] /= mon->x_size;
+
+    if (monitor_sample(mon, &mon->yline, y, mon->y_avg[y])) {
+      monitor_report(mon, &mon->yline, y, mon->y_avg[y], "Line Y%d", y);
+      events++;
+    }
+  }
+
+  return events;
+}
+
+//******************************************************************************
+/// \brief Sample diagnostic data until Ctrl-C, reporting nodes and lines
+///        that go out of bounds
+/// \return #mxt_rc
+int mxt_monitor(struct mxt_device *mxt, struct monitor_options *opts)
+{
+  struct monitor_ctx mon;
+  struct t37_ctx t37;
+  struct sigaction sa;
+  struct timespec next, now;
+  int events = 0;
+  int ret;
+
+  if (opts->mode != DELTAS_MODE && opts->mode != REFS_MODE) {
+    mxt_err(mxt->ctx, "Monitor supports mutual deltas or references only");
+    return MXT_ERROR_BAD_INPUT;
+  }
+
+  ret = mxt_dd_stream_start(mxt, &t37, opts->mode, opts->instance);
+  if (ret)
+    return ret;
+
+  ret = monitor_init(&mon, t37.x_size, t37.y_size, opts->warmup, opts->sigma);
+  if (ret)
+    goto stop;
+
+  mxt_info(mxt->ctx, "Monitoring %s every %u ms, baseline %u samples, limit %u sigma",
+           (opts->mode == REFS_MODE) ? "references" : "deltas",
+           opts->interval_ms, mon.warmup, opts->sigma);
+  mxt_info(mxt->ctx, "Press Ctrl-C to stop");
+
+  mxt_init_sigint_handler(mxt, &sa);
+
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  while (!mxt_sigint_rx) {
+    ret = mxt_dd_stream_frame(mxt, &t37);
+    if (ret)
+      break;
+
+    debug_frame_calc_stats(&t37);
+
+    events += monitor_update(&mon, t37.data_buf);
+    if (mon.samples == mon.warmup)
+      mxt_info(mxt->ctx, "Baseline established");
+
+    fflush(stdout);
+
+    /* Fixed sample period, independent of the time taken to read */
+    next.tv_sec += opts->interval_ms / 1000;
+    next.tv_nsec += (opts->interval_ms % 1000) * 1000000L;
+    if (next.tv_nsec >= 1000000000L) {
+      next.tv_sec++;
+      next.tv_nsec -= 1000000000L;
+    }
+
+    /* Drop samples rather than catch up after a slow read */
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > next.tv_sec ||
+        (now.tv_sec == next.tv_sec && now.tv_nsec > next.tv_nsec))
+      next = now;
+
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+  }
+
+  mxt_release_sigint_handler(mxt, &sa);
+
+  mxt_info(mxt->ctx, "%u samples, %d events", mon.samples, events);
+
+  monitor_free(&mon);
+stop:
+  mxt_dd_stream_stop(&t37);
+  return ret;
+}
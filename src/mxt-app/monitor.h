@@ -0,0 +1,77 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   monitor.h
+/// \brief  Continuous sensor health monitor
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#define MONITOR_DEFAULT_INTERVAL_MS  1000
+#define MONITOR_DEFAULT_WARMUP       16
+#define MONITOR_DEFAULT_SIGMA        6
+
+struct mxt_device;
+
+//******************************************************************************
+/// \brief Health monitor options
+struct monitor_options
+{
+  uint8_t mode;
+  uint8_t instance;
+  uint32_t interval_ms;
+  uint16_t warmup;
+  uint8_t sigma;
+};
+
+//******************************************************************************
+/// \brief Running statistics for a set of nodes or lines
+struct monitor_stats
+{
+  int count;
+  double *mean;
+  double *variance;
+  bool *out;
+};
+
+//******************************************************************************
+/// \brief Health monitor state
+struct monitor_ctx
+{
+  int x_size;
+  int y_size;
+  uint32_t samples;
+  uint16_t warmup;
+  double sigma;
+  struct monitor_stats node;
+  struct monitor_stats xline;
+  struct monitor_stats yline;
+  /* Line averages of the current frame */
+  double *x_avg;
+  double *y_avg;
+};
+
+int monitor_init(struct monitor_ctx *mon, int x_size, int y_size, uint16_t warmup, uint8_t sigma);
+void monitor_free(struct monitor_ctx *mon);
+int monitor_update(struct monitor_ctx *mon, const uint16_t *data);
+int mxt_monitor(struct mxt_device *mxt, struct monitor_options *opts);
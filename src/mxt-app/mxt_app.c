@@ -44,10 +44,17 @@
 
 #include "broken_line.h"
 #include "sensor_variant.h"
+#include "screening.h"
+#include "monitor.h"
+#include "bench.h"
+#include "uinput.h"
 #include "mxt_app.h"
 
 #define BUF_SIZE 1024
 
+/* Register transfers kept by --trace */
+#define TRACE_ENTRIES 4096
+
 //******************************************************************************
 /// \brief Initialize mXT device and read the info block
 /// \return #mxt_rc
@@ -56,6 +63,7 @@ static int mxt_init_chip(struct libmaxtouch_ctx *ctx, struct mxt_device **mxt,
 {
   int ret;
 
+retry:
   ret = mxt_scan(ctx, conn, false);
   
   if (ret == MXT_ERROR_NO_DEVICE) {
@@ -68,7 +76,7 @@ static int mxt_init_chip(struct libmaxtouch_ctx *ctx, struct mxt_device **mxt,
 
   ret = mxt_new_device(ctx, *conn, mxt);
   if (ret)
-    return ret;
+    goto stale;
 
 #ifdef HAVE_LIBUSB
   if ((*mxt)->conn->type == E_USB && usb_is_bootloader(*mxt)) {
@@ -78,8 +86,96 @@ static int mxt_init_chip(struct libmaxtouch_ctx *ctx, struct mxt_device **mxt,
   }
 #endif
   ret = mxt_get_info(*mxt);
-  if (ret)
+  if (ret && ctx->scan_cached) {
+    mxt_free_device(*mxt);
+    *mxt = NULL;
+    goto stale;
+  } else if (ret) {
     return ret;
+  }
+
+  return MXT_SUCCESS;
+
+stale:
+  /* The device may have moved since it was cached, so scan for it again */
+  if (ctx->scan_cached) {
+    mxt_warn(ctx, "Cached device not usable, scanning");
+    mxt_scan_cache_invalidate(ctx);
+    *conn = mxt_unref_conn(*conn);
+    goto retry;
+  }
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Write recorded register transfers to file
+static void write_trace(struct libmaxtouch_ctx *ctx, const char *filename)
+{
+  FILE *fp;
+
+  fp = fopen(filename, "w");
+  if (!fp) {
+    mxt_err(ctx, "Failed to open %s", filename);
+    return;
+  }
+
+  if (mxt_trace_dump(ctx, fp))
+    mxt_err(ctx, "Failed to write trace to %s", filename);
+
+  fclose(fp);
+}
+
+//******************************************************************************
+/// \brief Copy one colon separated field of a device string
+/// \return Field, or NULL if it is empty or allocation fails
+static char *mock_conn_field(const char **arg)
+{
+  const char *end = strchr(*arg, ':');
+  size_t len = end ? (size_t)(end - *arg) : strlen(*arg);
+  char *field = NULL;
+
+  if (len)
+    field = strndup(*arg, len);
+
+  *arg += end ? len + 1 : len;
+
+  return field;
+}
+
+//******************************************************************************
+/// \brief Parse mock device string INFO[:CONFIG[:TRACE]]
+/// \return #mxt_rc
+static int mock_conn_parse(struct mxt_conn_info *conn, const char *arg)
+{
+  conn->mock.info_file = mock_conn_field(&arg);
+  conn->mock.config_file = mock_conn_field(&arg);
+  conn->mock.msg_file = mock_conn_field(&arg);
+
+  if (!conn->mock.info_file || *arg)
+    return MXT_ERROR_BAD_INPUT;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Parse comma separated list of pass numbers into a bit per pass
+/// \return #mxt_rc
+static int pass_list_parse(uint8_t *passes, const char *arg)
+{
+  char *end;
+  long pass;
+
+  *passes = 0;
+
+  do {
+    pass = strtol(arg, &end, 0);
+    if (end == arg || pass < 0 || pass > 7 || (*end && *end != ','))
+      return MXT_ERROR_BAD_INPUT;
+
+    *passes |= 1 << pass;
+    arg = end + 1;
+  } while (*end);
 
   return MXT_SUCCESS;
 }
@@ -96,6 +192,9 @@ static void print_usage(char *prog_name)
           "  -i [--info]                : print device information\n"
           "  -M [--messages] [TIMEOUT]  : print the messages (for TIMEOUT seconds)\n"
           "  -F [--msg-filter] TYPE     : message filtering by object TYPE\n"
+          "  --timestamps               : prefix messages with monotonic time of read\n"
+          "  --uinput                   : inject touches into a uinput multitouch\n"
+          "                               device until Ctrl-C\n"
           "  --reset                    : reset device\n"
           "  --calibrate                : send calibrate command\n"
           "  -g                         : store golden references\n"
@@ -103,12 +202,17 @@ static void print_usage(char *prog_name)
           "  --self-cap-tune-nvram      : tune self capacitance settings to NVRAM\n"
           "  --version                  : print version\n"
           "  --block-size BLOCKSIZE     : set the maximum block size used for i2c transfers (default %d)\n"
+          "  --reopen-fd                : reopen device node for every transfer\n"
+          "  --trace FILE               : write last register transfers to FILE on exit\n"
           "\n"
           "Configuration file commands:\n"
           "  --load FILE                : upload cfg from FILE in .xcfg or OBP_RAW format\n"
           "  --save FILE                : save cfg to FILE in .xcfg or OBP_RAW format\n"
+          "  --diff                     : with --load, only write bytes which differ\n"
           "  --backup[=COMMAND]         : backup configuration to NVRAM\n"
           "  --checksum FILE            : verify .xcfg or OBP_RAW file config checksum\n"
+          "  --config-cache DIR         : keep device config snapshots in DIR, keyed by\n"
+          "                               config CRC, to speed up --save and --diff\n"
           "\n"
           "Register read/write commands:\n"
           "  -R [--read]                : read from object\n"
@@ -139,15 +243,27 @@ static void print_usage(char *prog_name)
           "T25 Self Test commands:\n"
           "  -t [--test]                : run all self tests\n"
           "  -tXX [--test=XX]           : run individual test, write XX to CMD register\n"
+          "  -tXXYY.. [--test=XXYY..]   : queue several tests and print a JSON report\n"
           "\n"
           "T10 On-Deman Test command:\n"
           "  --odtest                   : run all on-demand self tests\n"
           "\n"
           "T37 Diagnostic Data commands:\n"
           "  --debug-dump FILE          : capture diagnostic data to FILE\n"
+          "  --live                     : show deltas, references or self cap data as\n"
+          "                               a terminal heatmap until Ctrl-C\n"
           "  --frames N                 : capture N frames of data\n"
+          "  --ring-frames N            : buffer N frames for a separate writer thread\n"
           "  --instance INSTANCE        : select object INSTANCE\n"
-	  "  --format 0/1               : capture using format 0 or 1\n"
+          "  --roi instance|X0-X1,Y0-Y1 : capture only the INSTANCE touchscreen, or\n"
+          "                               lines X0 to X1 and Y0 to Y1\n"
+          "  --passes N[,N...]          : capture only these self cap, active stylus\n"
+          "                               or key array passes\n"
+          "  --axis x|y                 : capture only the X or Y self cap or active\n"
+          "                               stylus lines\n"
+	  "  --format 0/1/2/3           : capture using format 0, 1, 2 (binary) or\n"
+          "                               3 (delta coded binary)\n"
+          "  --convert-capture IN OUT   : convert binary capture IN to CSV file OUT\n"
           "  --references               : capture references data\n"
           "  --self-cap-signals         : capture self cap signals\n"
           "  --self-cap-deltas          : capture self cap deltas\n"
@@ -176,9 +292,38 @@ static void print_usage(char *prog_name)
           "  --lower-limit N            : Lower limit for regression, in %%\n"
           "  --matrix-size N            : The allowed matrix size\n"
           "\n"
+          "Screening commands:\n"
+          "  --screen                   : Run sensor variant and broken line tests\n"
+          "                               on combined reference frames\n"
+          "  --frames N                 : combine N frames per test (default 1)\n"
+          "  --median                   : combine frames by median, not mean\n"
+          "\n"
+          "Health monitor commands:\n"
+          "  --monitor                  : sample deltas until Ctrl-C and report nodes\n"
+          "                               and lines that go out of bounds\n"
+          "  --references               : monitor references instead of deltas\n"
+          "  --interval MS              : sample every MS milliseconds (default 1000)\n"
+          "  --warmup N                 : build the baseline from N samples (default 16)\n"
+          "  --sigma N                  : report samples over N std devs from the mean\n"
+          "                               (default 6)\n"
+          "\n"
+          "Benchmark commands:\n"
+          "  --bench                    : measure transport, capture and config\n"
+          "                               performance, print results as JSON\n"
+          "  --bench-csv                : print results as CSV instead\n"
+          "  --bench-iterations N       : N samples per register test (default 100)\n"
+          "\n"
           "Device connection options:\n"
           "  -q [--query]               : scan for devices\n"
-          "  -d [--device] DEVICESTRING : DEVICESTRING as output by --query\n\n"
+          "  -d [--device] DEVICESTRING : DEVICESTRING as output by --query\n"
+          "                               repeat with --flash, -t, --odtest, -i,\n"
+          "                               --debug-dump or --load to run on several\n"
+          "                               devices concurrently\n"
+          "  --chg-gpio CHIP:LINE       : wait for messages on CHG GPIO, eg \"0:23\" for\n"
+          "                               /dev/gpiochip0 line 23. Also paces\n"
+          "                               bootloader frames when flashing\n"
+          "  --scan-cache FILE          : reuse the device and info block found by\n"
+          "                               the last scan, kept in FILE\n\n"
           "  Examples:\n"
           "  -d i2c-dev:ADAPTER:ADDRESS : raw i2c device, eg \"i2c-dev:2-004a\"\n"
 #ifdef HAVE_LIBUSB
@@ -187,6 +332,9 @@ static void print_usage(char *prog_name)
 #endif
           "  -d sysfs:PATH              : sysfs interface\n"
           "  -d hidraw:PATH             : HIDRAW device, eg \"hidraw:/dev/hidraw0\"\n"
+          "  -d mock:INFO[:CONFIG[:TRACE]] : emulated device, from a raw info block\n"
+          "                               or binary capture, a config file and a\n"
+          "                               --trace file of messages to replay\n"
           "\n"
 #ifdef HAVE_LIBUSB
           "5030 Bridge Board commands:\n"
@@ -205,30 +353,46 @@ int main (int argc, char *argv[])
 {
   int ret;
   int c;
+  int i;
   int msgs_timeout = MSG_CONTINUOUS;
   bool msgs_enabled = false;
   uint8_t backup_cmd = BACKUPNV_COMMAND;
-  unsigned char self_test_cmd = SELF_TEST_ALL;
-  unsigned char ondemand_test_cmd = OND_RUN_ALL_TEST;
+  uint8_t self_test_cmds[SELF_TEST_MAX_CMDS] = { SELF_TEST_ALL };
+  uint16_t num_self_test_cmds = 1;
+  struct self_test_result self_test_results[SELF_TEST_MAX_CMDS];
   uint16_t address = 0;
   uint16_t count = 0;
   struct mxt_conn_info *conn = NULL;
+  struct mxt_conn_info *flash_conns[MXT_FLASH_MAX_DEVICES];
+  const char *flash_names[MXT_FLASH_MAX_DEVICES];
+  int num_devices = 0;
   uint16_t object_type = 0;
   uint16_t msg_filter_type = 0;
+  bool msg_timestamps = false;
   uint8_t instance = 0;
   uint8_t verbose = 2;
   uint16_t t37_frames = 1;
   uint8_t t37_file_attr = 0;   /* 0 - write, 1 - append */
+  uint16_t t37_ring_frames = 0;
+  struct dd_roi t37_roi = { 0 };
   uint8_t t37_mode = DELTAS_MODE;
   uint8_t bi2c_addr = 0x4a;
-  bool format = false;
+  uint16_t format = 0;
   uint16_t port = 4000;
   int i2c_block_size = I2C_DEV_MAX_BLOCK;
+  bool reopen_fd = false;
+  bool load_diff = false;
+  int chg_gpio_chip = 0;
+  int chg_gpio_line = -1;
   uint8_t t68_datatype = 1;
   unsigned char databuf;
   char strbuf2[BUF_SIZE];
   char strbuf[BUF_SIZE];
+  char trace_file[BUF_SIZE];
+  char config_cache_dir[BUF_SIZE];
+  char scan_cache_file[BUF_SIZE];
   bool dualx = false;
+  bool screen_median = false;
   struct broken_line_options bl_opts = {0};
   bl_opts.pattern = BROKEN_LINE_PATTERN_ITO;
   bl_opts.x_center_threshold = BROKEN_LINE_DEFAULT_THRESHOLD;
@@ -240,8 +404,18 @@ int main (int argc, char *argv[])
   sv_opts.upper_limit = 15;
   sv_opts.lower_limit = 15;
   sv_opts.matrix_size = 0;
+  struct screening_options screen_opts = {0};
+  struct monitor_options monitor_opts = {0};
+  monitor_opts.interval_ms = MONITOR_DEFAULT_INTERVAL_MS;
+  monitor_opts.warmup = MONITOR_DEFAULT_WARMUP;
+  monitor_opts.sigma = MONITOR_DEFAULT_SIGMA;
+  enum bench_format bench_format = BENCH_FORMAT_JSON;
+  int bench_iterations = BENCH_DEFAULT_ITERATIONS;
   strbuf[0] = '\0';
   strbuf2[0] = '\0';
+  trace_file[0] = '\0';
+  config_cache_dir[0] = '\0';
+  scan_cache_file[0] = '\0';
   mxt_app_cmd cmd = CMD_NONE;
 
   while (1) {
@@ -254,11 +428,16 @@ int main (int argc, char *argv[])
       {"bridge-client",    required_argument, 0, 'C'},
       {"calibrate",        no_argument,       0, 0},
       {"checksum",         required_argument, 0, 0},
+      {"config-cache",     required_argument, 0, 0},
+      {"scan-cache",       required_argument, 0, 0},
+      {"chg-gpio",         required_argument, 0, 0},
+      {"convert-capture",  required_argument, 0, 0},
       {"debug-dump",       required_argument, 0, 0},
       {"device",           required_argument, 0, 'd'},
       {"t68-file",         required_argument, 0, 0},
       {"t68-datatype",     required_argument, 0, 0},
       {"msg-filter",       required_argument, 0, 'F'},
+      {"timestamps",       no_argument,       0, 0},
       {"format",           required_argument, 0, 'f'},
       {"flash",            required_argument, 0, 0},
       {"firmware-version", required_argument, 0, 0},
@@ -267,8 +446,13 @@ int main (int argc, char *argv[])
       {"info",             no_argument,       0, 'i'},
       {"instance",         required_argument, 0, 'I'},
       {"file-attr",        required_argument, 0, 0},
+      {"ring-frames",      required_argument, 0, 0},
+      {"roi",              required_argument, 0, 0},
+      {"passes",           required_argument, 0, 0},
+      {"axis",             required_argument, 0, 0},
       {"load",             required_argument, 0, 0},
       {"save",             required_argument, 0, 0},
+      {"diff",             no_argument,       0, 0},
       {"messages",         optional_argument, 0, 'M'},
       {"broken-line",      no_argument,       0, 0},
       {"dualx",            no_argument,       0, 0},
@@ -277,6 +461,17 @@ int main (int argc, char *argv[])
       {"y-center-threshold",  required_argument, 0,0},
       {"y-border-threshold",  required_argument, 0,0},
       {"sensor-variant",      no_argument,       0, 0},
+      {"screen",           no_argument,       0, 0},
+      {"monitor",          no_argument,       0, 0},
+      {"bench",            no_argument,       0, 0},
+      {"uinput",           no_argument,       0, 0},
+      {"live",             no_argument,       0, 0},
+      {"bench-csv",        no_argument,       0, 0},
+      {"bench-iterations", required_argument, 0, 0},
+      {"interval",         required_argument, 0, 0},
+      {"warmup",           required_argument, 0, 0},
+      {"sigma",            required_argument, 0, 0},
+      {"median",           no_argument,       0, 0},
       {"fail-if-any",         no_argument,       0, 0},
       {"matrix-size",         required_argument, 0,0},
       {"max-defects",      required_argument, 0,  0},
@@ -289,6 +484,8 @@ int main (int argc, char *argv[])
       {"read",             no_argument,       0, 'R'},
       {"reset",            no_argument,       0, 0},
       {"reset-bootloader", no_argument,       0, 0},
+      {"reopen-fd",        no_argument,       0, 0},
+      {"trace",            required_argument, 0, 0},
       {"register",         required_argument, 0, 'r'},
       {"references",       no_argument,       0, 0},
       {"self-cap-tune-config", no_argument,       0, 0},
@@ -366,6 +563,15 @@ int main (int argc, char *argv[])
           print_usage(argv[0]);
           return MXT_ERROR_BAD_INPUT;
         }
+      } else if (!strcmp(long_options[option_index].name, "convert-capture")) {
+        if (cmd == CMD_NONE) {
+          cmd = CMD_CONVERT_CAPTURE;
+          strncpy(strbuf, optarg, sizeof(strbuf));
+          strbuf[sizeof(strbuf) - 1] = '\0';
+        } else {
+          print_usage(argv[0]);
+          return MXT_ERROR_BAD_INPUT;
+        }
       } else if (!strcmp(long_options[option_index].name, "debug-dump")) {
         if (cmd == CMD_NONE) {
           cmd = CMD_DEBUG_DUMP;
@@ -427,6 +633,57 @@ int main (int argc, char *argv[])
           print_usage(argv[0]);
           return MXT_ERROR_BAD_INPUT;
         }
+      } else if (!strcmp(long_options[option_index].name, "screen")) {
+        if (cmd == CMD_NONE) {
+          cmd = CMD_SCREENING;
+        } else {
+          print_usage(argv[0]);
+          return MXT_ERROR_BAD_INPUT;
+        }
+      } else if (!strcmp(long_options[option_index].name, "median")) {
+        screen_median = true;
+      } else if (!strcmp(long_options[option_index].name, "monitor")) {
+        if (cmd == CMD_NONE) {
+          cmd = CMD_MONITOR;
+        } else {
+          print_usage(argv[0]);
+          return MXT_ERROR_BAD_INPUT;
+        }
+      } else if (!strcmp(long_options[option_index].name, "bench")) {
+        if (cmd == CMD_NONE) {
+          cmd = CMD_BENCH;
+        } else {
+          print_usage(argv[0]);
+          return MXT_ERROR_BAD_INPUT;
+        }
+      } else if (!strcmp(long_options[option_index].name, "uinput")) {
+        if (cmd == CMD_NONE) {
+          cmd = CMD_UINPUT;
+        } else {
+          print_usage(argv[0]);
+          return MXT_ERROR_BAD_INPUT;
+        }
+      } else if (!strcmp(long_options[option_index].name, "live")) {
+        if (cmd == CMD_NONE) {
+          cmd = CMD_LIVE;
+        } else {
+          print_usage(argv[0]);
+          return MXT_ERROR_BAD_INPUT;
+        }
+      } else if (!strcmp(long_options[option_index].name, "bench-csv")) {
+        bench_format = BENCH_FORMAT_CSV;
+      } else if (!strcmp(long_options[option_index].name, "bench-iterations")) {
+        bench_iterations = strtol(optarg, NULL, 0);
+      } else if (!strcmp(long_options[option_index].name, "interval")) {
+        monitor_opts.interval_ms = strtol(optarg, NULL, 0);
+      } else if (!strcmp(long_options[option_index].name, "warmup")) {
+        monitor_opts.warmup = strtol(optarg, NULL, 0);
+      } else if (!strcmp(long_options[option_index].name, "sigma")) {
+        monitor_opts.sigma = strtol(optarg, NULL, 0);
+        if (monitor_opts.sigma < 1) {
+          print_usage(argv[0]);
+          return MXT_ERROR_BAD_INPUT;
+        }
       } else if (!strcmp(long_options[option_index].name, "fail-if-any")) {
         if (optarg) {
           sv_opts.max_defects = 0;
@@ -471,14 +728,14 @@ int main (int argc, char *argv[])
         } 
       } else if (!strcmp(long_options[option_index].name, "odtest")) { 
         if (cmd == CMD_NONE) {
+          self_test_cmds[0] = OND_RUN_ALL_TEST;
           if (optarg) {
-            ret = mxt_convert_hex(optarg, &databuf, &count, sizeof(databuf));
-              if (ret) {
+            ret = mxt_convert_hex(optarg, self_test_cmds, &num_self_test_cmds,
+                                  sizeof(self_test_cmds));
+              if (ret || num_self_test_cmds == 0) {
                 fprintf(stderr, "Hex convert error\n");
-                ret = MXT_ERROR_BAD_INPUT;
-              } else {
-                ondemand_test_cmd = databuf;
-              } 
+                return MXT_ERROR_BAD_INPUT;
+              }
           }
             cmd = CMD_OD_TEST;
           } else {
@@ -584,6 +841,31 @@ int main (int argc, char *argv[])
         t37_frames = strtol(optarg, NULL, 0);
       } else if (!strcmp(long_options[option_index].name, "file-attr")) {
         t37_file_attr = strtol(optarg, NULL, 0);
+      } else if (!strcmp(long_options[option_index].name, "ring-frames")) {
+        t37_ring_frames = strtol(optarg, NULL, 0);
+      } else if (!strcmp(long_options[option_index].name, "roi")) {
+        t37_roi.enabled = true;
+        if (!strcmp(optarg, "instance")) {
+          t37_roi.instance = true;
+        } else if (sscanf(optarg, "%d-%d,%d-%d", &t37_roi.x_start, &t37_roi.x_end,
+                          &t37_roi.y_start, &t37_roi.y_end) != 4) {
+          fprintf(stderr, "Invalid region %s\n", optarg);
+          return MXT_ERROR_BAD_INPUT;
+        }
+      } else if (!strcmp(long_options[option_index].name, "passes")) {
+        if (pass_list_parse(&t37_roi.passes, optarg)) {
+          fprintf(stderr, "Invalid pass list %s\n", optarg);
+          return MXT_ERROR_BAD_INPUT;
+        }
+      } else if (!strcmp(long_options[option_index].name, "axis")) {
+        if (!strcmp(optarg, "x")) {
+          t37_roi.axes = DD_AXIS_X;
+        } else if (!strcmp(optarg, "y")) {
+          t37_roi.axes = DD_AXIS_Y;
+        } else {
+          fprintf(stderr, "Invalid axis %s\n", optarg);
+          return MXT_ERROR_BAD_INPUT;
+        }
       } else if (!strcmp(long_options[option_index].name, "references")) {
         t37_mode = REFS_MODE;
       } else if (!strcmp(long_options[option_index].name, "self-cap-signals")) {
@@ -604,6 +886,26 @@ int main (int argc, char *argv[])
         t37_mode = AST_REFS;
       } else if (!strcmp(long_options[option_index].name, "block-size")) {
         i2c_block_size = atoi(optarg);
+      } else if (!strcmp(long_options[option_index].name, "trace")) {
+        strncpy(trace_file, optarg, sizeof(trace_file));
+        trace_file[sizeof(trace_file) - 1] = '\0';
+      } else if (!strcmp(long_options[option_index].name, "config-cache")) {
+        strncpy(config_cache_dir, optarg, sizeof(config_cache_dir));
+        config_cache_dir[sizeof(config_cache_dir) - 1] = '\0';
+      } else if (!strcmp(long_options[option_index].name, "scan-cache")) {
+        strncpy(scan_cache_file, optarg, sizeof(scan_cache_file));
+        scan_cache_file[sizeof(scan_cache_file) - 1] = '\0';
+      } else if (!strcmp(long_options[option_index].name, "diff")) {
+        load_diff = true;
+      } else if (!strcmp(long_options[option_index].name, "timestamps")) {
+        msg_timestamps = true;
+      } else if (!strcmp(long_options[option_index].name, "reopen-fd")) {
+        reopen_fd = true;
+      } else if (!strcmp(long_options[option_index].name, "chg-gpio")) {
+        if (sscanf(optarg, "%d:%d", &chg_gpio_chip, &chg_gpio_line) != 2) {
+          fprintf(stderr, "Invalid CHG GPIO %s\n", optarg);
+          return MXT_ERROR_BAD_INPUT;
+        }
       } else if (!strcmp(long_options[option_index].name, "version")) {
         printf("mxt-app %s%s\n", MXT_VERSION, ENABLE_DEBUG ? " DEBUG":"");
         return MXT_SUCCESS;
@@ -615,6 +917,19 @@ int main (int argc, char *argv[])
 
     case 'd':
       if (optarg) {
+        /* Further devices are run in parallel, see mxt_run_parallel() */
+        if (conn) {
+          if (num_devices + 1 >= MXT_FLASH_MAX_DEVICES) {
+            fprintf(stderr, "Too many devices\n");
+            return MXT_ERROR_BAD_INPUT;
+          }
+
+          flash_conns[num_devices++] = conn;
+          conn = NULL;
+        }
+
+        flash_names[num_devices] = optarg;
+
         if (!strncmp(optarg, "i2c-dev:", 8)) {
           ret = mxt_new_conn(&conn, E_I2C_DEV);
           if (ret)
@@ -696,6 +1011,16 @@ int main (int argc, char *argv[])
             conn = mxt_unref_conn(conn);
             return MXT_ERROR_NO_MEM;
           }
+        } else if (!strncmp(optarg, "mock:", 5)) {
+          ret = mxt_new_conn(&conn, E_MOCK);
+          if (ret)
+            return ret;
+
+          if (mock_conn_parse(conn, optarg + 5)) {
+            fprintf(stderr, "Invalid device string %s\n", optarg);
+            conn = mxt_unref_conn(conn);
+            return MXT_ERROR_BAD_INPUT;
+          }
         } else {
           fprintf(stderr, "Invalid device string %s\n", optarg);
           conn = mxt_unref_conn(conn);
@@ -818,12 +1143,11 @@ int main (int argc, char *argv[])
     case 't':
       if (cmd == CMD_NONE) {
         if (optarg) {
-          ret = mxt_convert_hex(optarg, &databuf, &count, sizeof(databuf));
-          if (ret) {
+          ret = mxt_convert_hex(optarg, self_test_cmds, &num_self_test_cmds,
+                                sizeof(self_test_cmds));
+          if (ret || num_self_test_cmds == 0) {
             fprintf(stderr, "Hex convert error\n");
-            ret = MXT_ERROR_BAD_INPUT;
-          } else {
-            self_test_cmd = databuf;
+            return MXT_ERROR_BAD_INPUT;
           }
         }
         cmd = CMD_TEST;
@@ -856,6 +1180,21 @@ int main (int argc, char *argv[])
     }
   }
 
+  if (num_devices > 0) {
+    if (cmd != CMD_FLASH && cmd != CMD_TEST && cmd != CMD_OD_TEST
+        && cmd != CMD_INFO && cmd != CMD_DEBUG_DUMP && cmd != CMD_LOAD_CFG
+        && cmd != CMD_GOLDEN_REFERENCES && cmd != CMD_SELF_CAP_TUNE_CONFIG
+        && cmd != CMD_SELF_CAP_TUNE_NVRAM) {
+      fprintf(stderr, "Multiple devices are only supported with --flash, "
+              "--test, --odtest, --info, --debug-dump, --load, -g and "
+              "--self-cap-tune-*\n");
+      return MXT_ERROR_BAD_INPUT;
+    }
+
+    flash_conns[num_devices++] = conn;
+    conn = NULL;
+  }
+
   struct mxt_device *mxt = NULL;
   struct libmaxtouch_ctx *ctx;
 
@@ -875,6 +1214,22 @@ int main (int argc, char *argv[])
     ctx->i2c_block_size = i2c_block_size;
   }
 
+  ctx->reopen_fd = reopen_fd;
+  ctx->chg_gpio_chip = chg_gpio_chip;
+  ctx->chg_gpio_line = chg_gpio_line;
+
+  if (config_cache_dir[0] != '\0')
+    ctx->config_cache_dir = config_cache_dir;
+
+  if (scan_cache_file[0] != '\0')
+    ctx->scan_cache_file = scan_cache_file;
+
+  if (trace_file[0] != '\0') {
+    ret = mxt_trace_enable(ctx, TRACE_ENTRIES);
+    if (ret)
+      goto free;
+  }
+
   if (cmd == CMD_WRITE || cmd == CMD_READ) {
     mxt_verb(ctx, "instance:%u", instance);
     mxt_verb(ctx, "count:%u", count);
@@ -887,6 +1242,39 @@ int main (int argc, char *argv[])
     ret = mxt_scan(ctx, &conn, true);
     goto free;
 
+  } else if (cmd == CMD_CONVERT_CAPTURE) {
+    if (optind >= argc) {
+      mxt_err(ctx, "No output file given");
+      ret = MXT_ERROR_BAD_INPUT;
+    } else {
+      ret = mxt_convert_capture(ctx, strbuf, argv[optind]);
+    }
+    goto free;
+
+
+  } else if (num_devices > 1 && (cmd == CMD_TEST || cmd == CMD_OD_TEST)) {
+    ret = mxt_self_test_multi(ctx, flash_conns, flash_names, num_devices,
+                              self_test_cmds, num_self_test_cmds,
+                              cmd == CMD_OD_TEST);
+    goto free;
+
+  } else if (num_devices > 1 && cmd != CMD_FLASH) {
+    struct parallel_cmd pc = {
+      .cmd = cmd,
+      .names = flash_names,
+      .filename = strbuf,
+      .load_diff = load_diff,
+      .t37_mode = t37_mode,
+      .t37_frames = t37_frames,
+      .instance = instance,
+      .format = format,
+      .t37_file_attr = t37_file_attr,
+      .t37_ring_frames = t37_ring_frames,
+      .t37_roi = t37_roi,
+    };
+
+    ret = mxt_parallel_cmd(ctx, flash_conns, num_devices, &pc);
+    goto free;
 
   /* Initialization of chip, scan new device */
   } else if (cmd != CMD_FLASH && cmd != CMD_BOOTLOADER_VERSION) {
@@ -896,6 +1284,12 @@ int main (int argc, char *argv[])
 
     if (mxt)
       mxt_set_debug(mxt, true);
+
+    if (mxt && ctx->chg_gpio_line >= 0) {
+      ret = gpio_chg_open(mxt, ctx->chg_gpio_chip, ctx->chg_gpio_line);
+      if (ret)
+        goto free;
+    }
   }
 
   switch (cmd) {
@@ -941,18 +1335,27 @@ int main (int argc, char *argv[])
     break;
 
   case CMD_TEST:
-    mxt_verb(ctx, "CMD_TEST");
-    ret = run_self_tests(mxt, self_test_cmd, 0);
-    break;
-
   case CMD_OD_TEST:
     mxt_verb(ctx, "CMD_TEST");
-    ret = run_self_tests(mxt, ondemand_test_cmd, 1);
+    for (i = 0; i < num_self_test_cmds; i++)
+      self_test_results[i].cmd = self_test_cmds[i];
+
+    ret = mxt_self_test_run(mxt, self_test_results, num_self_test_cmds,
+                            cmd == CMD_OD_TEST);
+
+    /* Summarise when several tests were queued */
+    if (num_self_test_cmds > 1)
+      mxt_self_test_print_results(stdout, self_test_results, num_self_test_cmds,
+                                  cmd == CMD_OD_TEST, ret);
     break;
 
   case CMD_FLASH:
     mxt_verb(ctx, "CMD_FLASH");
-    ret = mxt_flash_firmware(ctx, mxt, strbuf, strbuf2, conn);
+    if (num_devices > 1)
+      ret = mxt_flash_firmware_multi(ctx, flash_conns, flash_names, num_devices,
+                                     strbuf, strbuf2);
+    else
+      ret = mxt_flash_firmware(ctx, mxt, strbuf, strbuf2, conn);
     break;
 
   case CMD_RESET:
@@ -974,6 +1377,41 @@ int main (int argc, char *argv[])
     ret = mxt_sensor_variant(mxt, &sv_opts);
     break;
 
+  case CMD_SCREENING:
+    if (dualx) {
+      sv_opts.dualx = dualx;
+      bl_opts.dualx = dualx;
+    }
+    screen_opts.frames = t37_frames;
+    screen_opts.median = screen_median;
+    screen_opts.sv_opts = &sv_opts;
+    screen_opts.bl_opts = &bl_opts;
+    mxt_verb(ctx, "CMD_SCREENING");
+    ret = mxt_screening(mxt, &screen_opts);
+    break;
+
+  case CMD_MONITOR:
+    mxt_verb(ctx, "CMD_MONITOR");
+    monitor_opts.mode = t37_mode;
+    monitor_opts.instance = instance;
+    ret = mxt_monitor(mxt, &monitor_opts);
+    break;
+
+  case CMD_BENCH:
+    mxt_verb(ctx, "CMD_BENCH");
+    ret = mxt_bench(mxt, bench_iterations, bench_format);
+    break;
+
+  case CMD_UINPUT:
+    mxt_verb(ctx, "CMD_UINPUT");
+    ret = mxt_uinput(mxt);
+    break;
+
+  case CMD_LIVE:
+    mxt_verb(ctx, "CMD_LIVE");
+    ret = mxt_dd_live(mxt, t37_mode, instance, t37_ring_frames, &t37_roi);
+    break;
+
   case CMD_RESET_BOOTLOADER:
     mxt_verb(ctx, "CMD_RESET_BOOTLOADER");
     ret = mxt_reset_chip(mxt, true, 0);
@@ -1018,7 +1456,8 @@ int main (int argc, char *argv[])
     mxt_verb(ctx, "CMD_DEBUG_DUMP");
     mxt_verb(ctx, "mode:%u", t37_mode);
     mxt_verb(ctx, "frames:%u", t37_frames);
-    ret = mxt_debug_dump(mxt, t37_mode, strbuf, t37_frames, instance, format, t37_file_attr);
+    ret = mxt_debug_dump(mxt, t37_mode, strbuf, t37_frames, instance, format, t37_file_attr,
+                         t37_ring_frames, &t37_roi);
     break;
 
   case CMD_ZERO_CFG:
@@ -1031,7 +1470,10 @@ int main (int argc, char *argv[])
   case CMD_LOAD_CFG:
     mxt_verb(ctx, "CMD_LOAD_CFG");
     mxt_verb(ctx, "filename:%s", strbuf);
-    ret = mxt_load_config_file(mxt, strbuf);
+    if (load_diff)
+      ret = mxt_load_config_file_diff(mxt, strbuf);
+    else
+      ret = mxt_load_config_file(mxt, strbuf);
     if (ret) {
       mxt_err(ctx, "Error loading the configuration");
     } else {
@@ -1076,16 +1518,20 @@ int main (int argc, char *argv[])
     if (cmd == CMD_MESSAGES && !msg_filter_type)
       msg_filter_type = object_type;
 
-    ret = print_raw_messages(mxt, msgs_timeout, msg_filter_type);
+    ret = print_raw_messages(mxt, msgs_timeout, msg_filter_type, msg_timestamps);
   }
 
   if (cmd != CMD_FLASH && cmd != CMD_BOOTLOADER_VERSION && mxt) {
     mxt_set_debug(mxt, false);
+    mxt_log_io_stats(mxt);
     mxt_free_device(mxt);
     mxt_unref_conn(conn);
   }
 
 free:
+  if (trace_file[0] != '\0')
+    write_trace(ctx, trace_file);
+
   mxt_free(ctx);
 
   return ret;
@@ -114,6 +114,22 @@
 #define MSG_NO_WAIT            0
 #define MSG_CONTINUOUS         -1
 
+/* Debug Dump File Formats */
+#define DD_FORMAT_HAWKEYE      0
+#define DD_FORMAT_MATRIX       1
+#define DD_FORMAT_BINARY       2
+#define DD_FORMAT_DELTA        3
+
+/* Self cap and active stylus axes, see struct dd_roi */
+#define DD_AXIS_X              (1 << 0)
+#define DD_AXIS_Y              (1 << 1)
+
+/* Maximum devices flashed concurrently */
+#define MXT_FLASH_MAX_DEVICES  16
+
+/* Maximum self test commands queued per run */
+#define SELF_TEST_MAX_CMDS     16
+
 //******************************************************************************
 /// \brief Commands for mxt-app
 typedef enum mxt_app_cmd_t {
@@ -146,15 +162,46 @@ typedef enum mxt_app_cmd_t {
   CMD_ZERO_CFG,
   CMD_BROKEN_LINE,
   CMD_SENSOR_VARIANT,
+  CMD_SCREENING,
+  CMD_MONITOR,
+  CMD_BENCH,
+  CMD_UINPUT,
+  CMD_LIVE,
   CMD_CRC_CHECK,
+  CMD_CONVERT_CAPTURE,
 } mxt_app_cmd;
 
 //******************************************************************************
 /// \brief Signal handler semaphore
 extern volatile sig_atomic_t mxt_sigint_rx;
 
-struct t37_diagnostic_data;
 struct mxt_conn_info;
+struct mxt_touchscreen_info;
+struct sigaction;
+
+//******************************************************************************
+/// \brief T37 Diagnostic Data object
+struct t37_diagnostic_data {
+  uint8_t mode;
+  uint8_t page;
+  uint8_t data[];
+};
+
+//******************************************************************************
+/// \brief Frame acquisition statistics, times in nanoseconds
+struct dd_timing {
+  uint32_t frames;
+  uint64_t acq_total_ns;
+  uint64_t acq_min_ns;
+  uint64_t acq_max_ns;
+  uint64_t last_ns;
+  /* Interval between frame timestamps */
+  uint32_t intervals;
+  double interval_mean;
+  double interval_m2;
+  double interval_min;
+  double interval_max;
+};
 
 //******************************************************************************
 /// \brief T37 Diagnostic Data context object
@@ -166,6 +213,7 @@ struct t37_ctx {
   bool active_stylus;
   bool t15_keyarray;
   bool fformat;
+  bool binary;
 
   int x_size;
   int y_size;
@@ -182,6 +230,8 @@ struct t37_ctx {
   int diag_cmd_addr;
   int t37_addr;
   int t37_size;
+  bool cmd_merged_read;
+  int cmd_delay_us;
   uint8_t t111_instances;
   uint8_t t107_instances;
   uint8_t t15_instances;
@@ -196,16 +246,68 @@ struct t37_ctx {
   int x_ptr;
   int y_ptr;
 
+  /* x_size by y_size region at this origin, read from the first_page to
+   * last_page of a matrix_y_size high frame */
+  bool roi;
+  int roi_x_origin;
+  int roi_y_origin;
+  int matrix_y_size;
+  int matrix_values;
+  int first_page;
+  int last_page;
+
+  /* Self cap, active stylus and key array passes to read, bit per pass or
+   * 0 for all, and DD_AXIS_X or DD_AXIS_Y to read one axis or 0 for both */
+  uint8_t pass_mask;
+  uint8_t axes;
+
   double mean;
   double variance;
   double std_dev;
+  int16_t min_value;
+  int16_t max_value;
 
   struct t37_diagnostic_data *t37_buf;
   uint16_t *data_buf;
+  /* Scratch frame for reordering, allocated with data_buf */
   uint16_t *temp_buf;
   uint8_t *key_buf;
+  struct mxt_touchscreen_info *ts_info;
 
   FILE *hawkeye;
+  char *file_buf;
+  uint8_t *capture_buf;
+  size_t capture_size;
+  /* Delta coded binary capture, NULL for fixed records */
+  struct dd_delta *delta;
+  /* Terminal heatmap instead of file output, see live.h */
+  struct live_ctx *live;
+  /* CLOCK_MONOTONIC time of the T37 read, see mxt_time_ns() */
+  uint64_t frame_time_ns;
+  /* Wall clock and monotonic time at the start of the capture */
+  uint64_t wall_base_ns;
+  uint64_t mono_base_ns;
+  struct dd_timing timing;
+};
+
+struct dd_delta;
+struct live_ctx;
+
+//******************************************************************************
+/// \brief Region of the mutual matrix to capture, line numbers inclusive,
+///        and passes and axes of self cap, active stylus or key array data
+struct dd_roi {
+  bool enabled;
+  /* Use the area of the selected touchscreen instance */
+  bool instance;
+  int x_start;
+  int x_end;
+  int y_start;
+  int y_end;
+  /* Bit per pass, 0 for all */
+  uint8_t passes;
+  /* DD_AXIS_X or DD_AXIS_Y, 0 for both */
+  uint8_t axes;
 };
 
 //******************************************************************************
@@ -229,12 +331,38 @@ struct mxt_t15_info {
   uint8_t t15_enable;
 };
 
+//******************************************************************************
+/// \brief Result of one queued self test command
+struct self_test_result {
+  uint8_t cmd;
+  int ret;
+  double duration;
+};
+
+//******************************************************************************
+/// \brief Command and options run on each device of a parallel run
+struct parallel_cmd {
+  mxt_app_cmd cmd;
+  const char **names;
+  const char *filename;
+  bool load_diff;
+  uint8_t t37_mode;
+  uint16_t t37_frames;
+  uint8_t instance;
+  uint16_t format;
+  uint8_t t37_file_attr;
+  uint16_t t37_ring_frames;
+  struct dd_roi t37_roi;
+};
+
 
 
 int mxt_flash_firmware(struct libmaxtouch_ctx *ctx, struct mxt_device *mxt, const char *filename, const char *new_version, struct mxt_conn_info *conn);
+int mxt_flash_firmware_multi(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conns, const char **names, int count, const char *filename, const char *new_version);
 int mxt_socket_server(struct mxt_device *mxt, uint16_t port);
 int mxt_socket_client(struct mxt_device *mxt, char *ip_address, uint16_t port);
-int mxt_debug_dump(struct mxt_device *mxt, int mode, const char *csv_file, uint16_t frames, uint16_t obj_inst, uint16_t format, uint16_t file_attr);
+int mxt_debug_dump(struct mxt_device *mxt, int mode, const char *csv_file, uint16_t frames, uint16_t obj_inst, uint16_t format, uint16_t file_attr, uint16_t ring_frames, const struct dd_roi *roi);
+int mxt_convert_capture(struct libmaxtouch_ctx *ctx, const char *capture_file, const char *csv_file);
 void mxt_dd_menu(struct mxt_device *mxt);
 void mxt_dd_menu2(struct mxt_device *mxt, char selection);
 void mxt_mutual_menu(struct mxt_device *mxt, char selection);
@@ -245,15 +373,32 @@ int mxt_store_golden_refs(struct mxt_device *mxt);
 int mxt_menu(struct mxt_device *mxt);
 uint8_t self_test_main_menu(struct mxt_device *mxt);
 int run_self_tests(struct mxt_device *mxt, uint8_t cmd, bool type);
+int mxt_self_test_run(struct mxt_device *mxt, struct self_test_result *results, int count, bool type);
+void mxt_self_test_print_results(FILE *fp, const struct self_test_result *results, int count, bool type, int ret);
+int mxt_self_test_multi(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conns, const char **names, int num_devices, const uint8_t *cmds, int count, bool type);
+int mxt_run_parallel(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conns, const char **names, int num_devices, int (*run)(struct mxt_device *mxt, int index, void *context), int (*report)(struct mxt_device *mxt, int index, void *context, int ret), void *context);
+int mxt_parallel_cmd(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conns, int num_devices, const struct parallel_cmd *pc);
 uint8_t self_test_t10_menu(struct mxt_device *mxt);
 int mxt_serial_data_upload(struct mxt_device *mxt, const char *filename, uint16_t datatype);
-int print_raw_messages(struct mxt_device *mxt, int timeout, uint16_t object_type);
+int print_raw_messages(struct mxt_device *mxt, int timeout, uint16_t object_type, bool timestamps);
 int print_raw_messages_t44(struct mxt_device *mxt);
 void print_t6_status(uint8_t status);
 int mxt_self_cap_tune(struct mxt_device *mxt, mxt_app_cmd cmd);
 int mxt_read_diagnostic_data_frame(struct mxt_device *mxt, struct t37_ctx *ctx);
 int mxt_debug_dump_initialise(struct mxt_device *mxt, struct t37_ctx *ctx);
+int mxt_dd_stream_start(struct mxt_device *mxt, struct t37_ctx *ctx, uint8_t mode, uint16_t instance);
+int mxt_dd_stream_frame(struct mxt_device *mxt, struct t37_ctx *ctx);
+uint64_t mxt_dd_frame_wall_ns(const struct t37_ctx *ctx);
+int mxt_dd_live(struct mxt_device *mxt, int mode, uint16_t instance, uint16_t ring_frames, const struct dd_roi *roi);
+void mxt_dd_stream_stop(struct t37_ctx *ctx);
+int mxt_debug_insert_data(struct t37_ctx *ctx);
+int mxt_debug_insert_data_roi(struct t37_ctx *ctx);
+int mxt_dd_set_roi(struct t37_ctx *ctx, const struct dd_roi *roi);
+int sort_debug_data(struct mxt_device *mxt, struct t37_ctx *ctx);
+int mxt_hawkeye_output(struct t37_ctx *ctx);
 sig_atomic_t mxt_get_sigint_flag(void);
+void mxt_init_sigint_handler(struct mxt_device *mxt, struct sigaction *sa);
+void mxt_release_sigint_handler(struct mxt_device *mxt, struct sigaction *sa);
 int mxt_read_messages_sigint(struct mxt_device *mxt, int timeout_seconds, void *context, int (*msg_func)(struct mxt_device *mxt, uint8_t *msg, void *context, uint8_t size));
 int mxt_bootloader_version(struct libmaxtouch_ctx *ctx, struct mxt_device *mxt, struct mxt_conn_info *conn);
 int disable_gr(struct mxt_device *mxt);
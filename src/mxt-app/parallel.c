@@ -0,0 +1,265 @@
+//------------------------------------------------------------------------------
+/// \file   parallel.c
+/// \brief  Run one command on several devices concurrently
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include <limits.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/log.h"
+#include "libmaxtouch/utilfuncs.h"
+
+#include "mxt_app.h"
+
+//******************************************************************************
+/// \brief Worker for one device of a parallel run
+struct parallel_worker {
+  pthread_t thread;
+  bool started;
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_conn_info *conn;
+  struct mxt_device *mxt;
+  int index;
+  int (*run)(struct mxt_device *mxt, int index, void *context);
+  void *context;
+  int ret;
+  double elapsed;
+};
+
+//******************************************************************************
+/// \brief Open the device and run the command, leaving the device open for
+///        the report
+static void *parallel_worker_thread(void *arg)
+{
+  struct parallel_worker *w = arg;
+  struct timespec start, end;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  w->ret = mxt_new_device(w->ctx, w->conn, &w->mxt);
+  if (w->ret)
+    goto done;
+
+  w->ret = mxt_get_info(w->mxt);
+  if (w->ret)
+    goto done;
+
+  if (w->run) {
+    mxt_set_debug(w->mxt, true);
+    w->ret = w->run(w->mxt, w->index, w->context);
+    mxt_set_debug(w->mxt, false);
+  }
+
+done:
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  w->elapsed = (end.tv_sec - start.tv_sec)
+               + (end.tv_nsec - start.tv_nsec) / 1e9;
+  return NULL;
+}
+
+//******************************************************************************
+/// \brief  Run a command on several devices, one thread per device
+/// \note   The library context is shared by the workers. Output which goes to
+///         stdout belongs in report, which is called for each device in turn
+///         once every worker has finished. The connections are released.
+/// \param  run  Called in the worker thread, may be NULL
+/// \param  report  Called in order after all workers have finished, given the
+///         result of run, may be NULL
+/// \return #mxt_rc of the first device which failed
+int mxt_run_parallel(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conns,
+                     const char **names, int num_devices,
+                     int (*run)(struct mxt_device *mxt, int index, void *context),
+                     int (*report)(struct mxt_device *mxt, int index, void *context, int ret),
+                     void *context)
+{
+  struct parallel_worker workers[MXT_FLASH_MAX_DEVICES];
+  int passed = 0;
+  int ret;
+  int i;
+
+  if (num_devices > MXT_FLASH_MAX_DEVICES)
+    return MXT_ERROR_BAD_INPUT;
+
+  memset(workers, 0, sizeof(workers));
+
+  for (i = 0; i < num_devices; i++) {
+    struct parallel_worker *w = &workers[i];
+
+    w->ctx = ctx;
+    w->conn = conns[i];
+    w->index = i;
+    w->run = run;
+    w->context = context;
+
+    ret = pthread_create(&w->thread, NULL, parallel_worker_thread, w);
+    if (ret) {
+      mxt_err(ctx, "%s: could not start worker, error %s (%d)",
+              names[i], strerror(ret), ret);
+      w->ret = MXT_ERROR_NO_MEM;
+      continue;
+    }
+
+    w->started = true;
+  }
+
+  for (i = 0; i < num_devices; i++) {
+    if (workers[i].started)
+      pthread_join(workers[i].thread, NULL);
+  }
+
+  ret = MXT_SUCCESS;
+
+  for (i = 0; i < num_devices; i++) {
+    struct parallel_worker *w = &workers[i];
+
+    if (report && w->mxt)
+      w->ret = report(w->mxt, i, context, w->ret);
+
+    if (w->mxt)
+      mxt_free_device(w->mxt);
+
+    mxt_unref_conn(w->conn);
+
+    if (w->ret == MXT_SUCCESS) {
+      mxt_info(ctx, "%s: PASS %.1f s", names[i], w->elapsed);
+      passed++;
+    } else {
+      mxt_info(ctx, "%s: FAIL %.1f s (error %d)", names[i], w->elapsed, w->ret);
+      if (ret == MXT_SUCCESS)
+        ret = w->ret;
+    }
+  }
+
+  mxt_info(ctx, "%d of %d devices passed", passed, num_devices);
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Give each device of a parallel debug dump its own output file, by
+///        adding the device number before the extension
+static void parallel_filename(char *buf, size_t size, const char *filename,
+                              int index)
+{
+  const char *ext = strrchr(filename, '.');
+  const char *slash = strrchr(filename, '/');
+
+  if (!ext || (slash && ext < slash))
+    ext = filename + strlen(filename);
+
+  snprintf(buf, size, "%.*s-%d%s", (int)(ext - filename), filename, index, ext);
+}
+
+//******************************************************************************
+/// \brief Run the command given by a struct parallel_cmd on one device
+static int parallel_cmd_run(struct mxt_device *mxt, int index, void *context)
+{
+  const struct parallel_cmd *pc = context;
+  char filename[PATH_MAX];
+  int ret;
+
+  switch (pc->cmd) {
+  case CMD_DEBUG_DUMP:
+    parallel_filename(filename, sizeof(filename), pc->filename, index);
+    mxt_info(mxt->ctx, "%s: writing %s", pc->names[index], filename);
+    ret = mxt_debug_dump(mxt, pc->t37_mode, filename, pc->t37_frames,
+                         pc->instance, pc->format, pc->t37_file_attr,
+                         pc->t37_ring_frames, &pc->t37_roi);
+    break;
+
+  case CMD_LOAD_CFG:
+    if (pc->load_diff)
+      ret = mxt_load_config_file_diff(mxt, pc->filename);
+    else
+      ret = mxt_load_config_file(mxt, pc->filename);
+
+    if (ret)
+      mxt_err(mxt->ctx, "%s: Error loading the configuration", pc->names[index]);
+    break;
+
+  case CMD_GOLDEN_REFERENCES:
+    ret = mxt_store_golden_refs(mxt);
+    break;
+
+  case CMD_SELF_CAP_TUNE_CONFIG:
+  case CMD_SELF_CAP_TUNE_NVRAM:
+    ret = mxt_self_cap_tune(mxt, pc->cmd);
+    break;
+
+  case CMD_INFO:
+  default:
+    ret = MXT_SUCCESS;
+    break;
+  }
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Print the per device output of a parallel command
+static int parallel_cmd_report(struct mxt_device *mxt, int index, void *context,
+                               int ret)
+{
+  const struct parallel_cmd *pc = context;
+
+  if (pc->cmd == CMD_INFO && ret == MXT_SUCCESS) {
+    printf("Device %s:\n", pc->names[index]);
+    mxt_print_info_block(mxt);
+  }
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief  Run --info, --debug-dump, --load, golden reference storage or self
+///         cap tuning on several devices concurrently
+/// \return #mxt_rc
+int mxt_parallel_cmd(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conns,
+                     int num_devices, const struct parallel_cmd *pc)
+{
+  switch (pc->cmd) {
+  case CMD_INFO:
+  case CMD_DEBUG_DUMP:
+  case CMD_LOAD_CFG:
+  case CMD_GOLDEN_REFERENCES:
+  case CMD_SELF_CAP_TUNE_CONFIG:
+  case CMD_SELF_CAP_TUNE_NVRAM:
+    break;
+
+  default:
+    return MXT_ERROR_NOT_SUPPORTED;
+  }
+
+  return mxt_run_parallel(ctx, conns, pc->names, num_devices,
+                          parallel_cmd_run, parallel_cmd_report, (void *)pc);
+}
@@ -168,3 +168,101 @@ bool ft_polyfit(struct libmaxtouch_ctx *ctx, double *xdata, double *ydata,
 
   return true;
 }
+
+/* Fills pinv with the n = (degree+1) by len pseudoinverse of the
+ * Vandermonde matrix for xdata, so that the coefficients fitting any
+ * ydata are pinv * ydata. */
+bool ft_polyfit_pinv(struct libmaxtouch_ctx *ctx, double *xdata, int len,
+                     double *pinv)
+{
+  int k, j, i;
+  int n = POLY_DEGREE + 1;
+  double mat1[n * n];
+  double inv[n * n];
+  double pw[2 * n - 1];
+  double d;
+
+  /* normal matrix - sums of powers of x values */
+  for (i = 0; i < 2 * n - 1; i++)
+    pw[i] = 0;
+
+  for (k = 0; k < len; k++) {
+    d = 1.0;
+    for (i = 0; i < 2 * n - 1; i++) {
+      pw[i] += d;
+      d *= xdata[k];
+    }
+  }
+
+  for (i = 0; i < n; i++)
+    for (j = 0; j < n; j++) {
+      mat1[i * n + j] = pw[i + j];
+      inv[i * n + j] = (i == j) ? 1.0 : 0.0;
+    }
+
+  print_matrix(ctx, mat1, n);
+
+  /* Gauss-Jordan elimination of mat1, applied to the identity */
+  for (i = 0; i < n; i++) {
+    int lindex = i;
+    double largest = fabs(mat1[i * n + i]);
+
+    for (j = i + 1; j < n; j++) {
+      if (fabs(mat1[j * n + i]) > largest) {
+        largest = fabs(mat1[j * n + i]);
+        lindex = j;
+      }
+    }
+    if (lindex != i) {
+      for (k = 0; k < n; k++) {
+        d = mat1[i * n + k];
+        mat1[i * n + k] = mat1[lindex * n + k];
+        mat1[lindex * n + k] = d;
+        d = inv[i * n + k];
+        inv[i * n + k] = inv[lindex * n + k];
+        inv[lindex * n + k] = d;
+      }
+    }
+
+    if (mat1[i * n + i] == 0.0) {
+      mxt_err(ctx, "ERROR: Non-zero pivot");
+      return false;
+    }
+
+    d = mat1[i * n + i];
+    for (k = 0; k < n; k++) {
+      mat1[i * n + k] /= d;
+      inv[i * n + k] /= d;
+    }
+
+    for (j = 0; j < n; j++) {
+      if (j == i)
+        continue;
+
+      d = mat1[j * n + i];
+      for (k = 0; k < n; k++) {
+        mat1[j * n + k] -= d * mat1[i * n + k];
+        inv[j * n + k] -= d * inv[i * n + k];
+      }
+    }
+  }
+
+  /* pinv = inverse(normal matrix) * transpose(Vandermonde) */
+  for (k = 0; k < len; k++) {
+    double v[n];
+
+    v[0] = 1.0;
+    for (j = 1; j < n; j++)
+      v[j] = v[j - 1] * xdata[k];
+
+    for (i = 0; i < n; i++) {
+      d = 0;
+      for (j = 0; j < n; j++)
+        d += inv[i * n + j] * v[j];
+
+      pinv[i * len + k] = d;
+    }
+  }
+
+  return true;
+}
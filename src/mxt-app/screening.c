@@ -0,0 +1,251 @@
+//------------------------------------------------------------------------------
+/// \file   screening.c
+/// \brief  Combined sensor screening
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/info_block.h"
+#include "libmaxtouch/log.h"
+
+#include "mxt_app.h"
+#include "broken_line.h"
+#include "sensor_variant.h"
+#include "screening.h"
+
+//******************************************************************************
+/// \brief Median of a small set of values, sorted in place
+static int16_t median_value(int16_t *vals, int count)
+{
+  int i, j;
+
+  for (i = 1; i < count; i++) {
+    int16_t v = vals[i];
+
+    for (j = i; j > 0 && vals[j - 1] > v; j--)
+      vals[j] = vals[j - 1];
+
+    vals[j] = v;
+  }
+
+  if (count & 1)
+    return vals[count / 2];
+
+  return (int16_t)(((int32_t)vals[count / 2 - 1] + vals[count / 2]) / 2);
+}
+
+//******************************************************************************
+/// \brief Combine num_frames consecutive frames of frame_len values into dst,
+///        by rounded mean or by per node median
+/// \return #mxt_rc
+int screening_combine_frames(uint16_t *dst, const uint16_t *frames,
+                             int num_frames, int frame_len, bool median)
+{
+  int16_t *vals = NULL;
+  int i, f;
+
+  if (median) {
+    vals = calloc(num_frames, sizeof(int16_t));
+    if (!vals)
+      return MXT_ERROR_NO_MEM;
+  }
+
+  for (i = 0; i < frame_len; i++) {
+    if (median) {
+      for (f = 0; f < num_frames; f++)
+        vals[f] = (int16_t)frames[f * frame_len + i];
+
+      dst[i] = (uint16_t)median_value(vals, num_frames);
+    } else {
+      int32_t sum = 0;
+
+      for (f = 0; f < num_frames; f++)
+        sum += (int16_t)frames[f * frame_len + i];
+
+      if (sum >= 0)
+        sum = (sum + num_frames / 2) / num_frames;
+      else
+        sum = -((-sum + num_frames / 2) / num_frames);
+
+      dst[i] = (uint16_t)(int16_t)sum;
+    }
+  }
+
+  free(vals);
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Capture a set of reference frames and combine them into data_buf
+/// \return #mxt_rc
+static int screening_capture(struct mxt_device *mxt, struct t37_ctx *frame,
+                             struct screening_options *opts, uint16_t *frames)
+{
+  int frame_len = frame->x_size * frame->y_size;
+  int ret;
+
+  for (frame->frame = 1; frame->frame <= opts->frames; frame->frame++) {
+    ret = mxt_read_diagnostic_data_frame(mxt, frame);
+    if (ret)
+      return ret;
+
+    memcpy(frames + (frame->frame - 1) * frame_len, frame->data_buf,
+           frame_len * sizeof(uint16_t));
+  }
+
+  if (opts->frames > 1) {
+    ret = screening_combine_frames(frame->data_buf, frames, opts->frames,
+                                   frame_len, opts->median);
+    if (ret)
+      return ret;
+  }
+
+  debug_frame(frame);
+
+  debug_frame_calc_stats(frame);
+  mxt_info(mxt->ctx, "References: mean %0.2f, std dev %0.2f, range %d to %d",
+           frame->mean, frame->std_dev, frame->min_value, frame->max_value);
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Run sensor variant and broken line detection in one session
+/// \return #mxt_rc
+int mxt_screening(struct mxt_device *mxt, struct screening_options *opts)
+{
+  struct mxt_touchscreen_info *mxt_ts_info = NULL;
+  struct t37_ctx frame = {0};
+  uint16_t *frames = NULL;
+  int sv_ret, bl_ret;
+  int ret;
+
+  ret = validate_sensor_variant_options(mxt, opts->sv_opts);
+  if (ret)
+    return ret;
+
+  if (opts->frames < 1) {
+    mxt_warn(mxt->ctx, "Warning: Defaulting to 1 frame");
+    opts->frames = 1;
+  }
+
+  ret = mxt_disable_touch(mxt);
+  if (ret)
+    return ret;
+
+  /* From here on the chip config has been changed, so every exit resets
+   * the device */
+  ret = disable_gr(mxt);
+  if (ret)
+    goto reset;
+
+  ret = mxt_free_run_mode(mxt);
+  if (ret)
+    goto reset;
+
+  ret = mxt_calibrate_chip(mxt);
+  if (ret)
+    goto reset;
+
+  frame.mxt = mxt;
+  frame.lc = mxt->ctx;
+  frame.mode = REFS_MODE;
+
+  ret = mxt_debug_dump_initialise(mxt, &frame);
+  if (ret)
+    goto reset;
+
+  ret = mxt_read_touchscreen_info(mxt, &mxt_ts_info);
+  if (ret)
+    goto reset;
+
+  if (!mxt_ts_info) {
+    ret = MXT_ERROR_OBJECT_NOT_FOUND;
+    goto reset;
+  }
+
+  frames = calloc((size_t)opts->frames * frame.x_size * frame.y_size,
+                  sizeof(uint16_t));
+  if (!frames) {
+    ret = MXT_ERROR_NO_MEM;
+    goto reset;
+  }
+
+  mxt_info(mxt->ctx, "Acquiring %u frames of reference data (%s)",
+           opts->frames, opts->median ? "median" : "mean");
+
+  ret = screening_capture(mxt, &frame, opts, frames);
+  if (ret)
+    goto reset;
+
+  sv_ret = sensor_variant_algorithm(&frame, mxt_ts_info, opts->sv_opts);
+  if (sv_ret && sv_ret != MXT_SENSOR_VARIANT_DETECTED) {
+    ret = sv_ret;
+    goto reset;
+  }
+
+  /* Broken line detection needs a different charge time, so the second
+   * set of frames reuses the T37 setup but not the references */
+  ret = broken_line_set_chrgtime(mxt, opts->bl_opts);
+  if (ret)
+    goto reset;
+
+  ret = mxt_calibrate_chip(mxt);
+  if (ret)
+    goto reset;
+
+  mxt_info(mxt->ctx, "Acquiring %u frames at broken line charge time",
+           opts->frames);
+
+  ret = screening_capture(mxt, &frame, opts, frames);
+  if (ret)
+    goto reset;
+
+  bl_ret = broken_line_calc(&frame, mxt_ts_info, opts->bl_opts);
+
+  mxt_info(mxt->ctx, "Screening: sensor variant %s, broken line %s",
+           sv_ret ? "FAIL" : "PASS", bl_ret ? "FAIL" : "PASS");
+
+  ret = sv_ret ? sv_ret : bl_ret;
+
+reset:
+  mxt_info(mxt->ctx, "Resetting device");
+  if (mxt_reset_chip(mxt, false, 0))
+    mxt_err(mxt->ctx, "Unable to reset device");
+
+  free(frames);
+  free(mxt_ts_info);
+  free(frame.data_buf);
+  free(frame.temp_buf);
+  free(frame.t37_buf);
+
+  return ret;
+}
@@ -45,6 +45,7 @@
 #include "mxt_app.h"
 
 #define T109_TIMEOUT                    30
+#define T109_STORE_TIMEOUT              100
 
 #define T109_CMD_OFFSET                 3
 #define T109_CMD_TUNE                   1
@@ -77,9 +78,64 @@ static int mxt_self_cap_command(struct mxt_device *mxt, uint8_t *msg,
   return MXT_MSG_CONTINUE;
 }
 
+//******************************************************************************
+/// \brief Self cap tuning sequence state
+struct self_cap_seq {
+  uint16_t cmd_addr;
+  /* Command whose T109 status is awaited */
+  uint8_t cmd;
+  uint8_t store_cmd;
+  bool stored;
+};
+
+//******************************************************************************
+/// \brief Write a command to the T109 CMD register
+/// \return #mxt_rc
+static int mxt_self_cap_dispatch(struct mxt_device *mxt,
+                                 struct self_cap_seq *seq, uint8_t cmd)
+{
+  seq->cmd = cmd;
+
+  mxt_info(mxt->ctx, "Writing %u to T109 CMD register", cmd);
+
+  return mxt_write_register(mxt, &seq->cmd, seq->cmd_addr, 1);
+}
+
+//******************************************************************************
+/// \brief Store the tuning result as soon as tuning has finished
+/// \return #mxt_rc
+static int mxt_self_cap_handle_messages(struct mxt_device *mxt, uint8_t *msg,
+                                        void *context, uint8_t size)
+{
+  struct self_cap_seq *seq = context;
+  int ret;
+
+  ret = mxt_self_cap_command(mxt, msg, &seq->cmd, size);
+  if (ret != MXT_SUCCESS)
+    return ret;
+
+  if (seq->cmd != T109_CMD_TUNE) {
+    seq->stored = true;
+    return MXT_SUCCESS;
+  }
+
+  if (seq->store_cmd == T109_CMD_STORE_TO_CONFIG_RAM)
+    mxt_info(mxt->ctx, "Store to Config");
+  else
+    mxt_info(mxt->ctx, "Store to NVRAM");
+
+  ret = mxt_self_cap_dispatch(mxt, seq, seq->store_cmd);
+  if (ret)
+    return ret;
+
+  return MXT_MSG_CONTINUE;
+}
+
 //******************************************************************************
 /// \brief Run self cap tuning procedure without updating the config
 /// checksum
+/// \note  The store command is written as soon as the T109 tune status is
+///        received, within a single message read loop
 /// \return #mxt_rc
 int mxt_self_cap_tune(struct mxt_device *mxt, mxt_app_cmd cmd)
 {
@@ -87,7 +143,7 @@ int mxt_self_cap_tune(struct mxt_device *mxt, mxt_app_cmd cmd)
   uint16_t t6_addr;
   uint16_t t109_addr;
   uint8_t backupnv_value;
-  uint8_t t109_command;
+  struct self_cap_seq seq;
 
   mxt_msg_reset(mxt);
 
@@ -100,6 +156,20 @@ int mxt_self_cap_tune(struct mxt_device *mxt, mxt_app_cmd cmd)
   if (t109_addr == OBJECT_NOT_FOUND)
     return MXT_ERROR_OBJECT_NOT_FOUND;
 
+  memset(&seq, 0, sizeof(seq));
+  seq.cmd_addr = t109_addr + T109_CMD_OFFSET;
+
+  switch (cmd) {
+  case CMD_SELF_CAP_TUNE_CONFIG:
+    seq.store_cmd = T109_CMD_STORE_TO_CONFIG_RAM;
+    break;
+
+  default:
+  case CMD_SELF_CAP_TUNE_NVRAM:
+    seq.store_cmd = T109_CMD_STORE_TO_NVM;
+    break;
+  }
+
   mxt_info(mxt->ctx, "Stopping T70");
   backupnv_value = 0x33;
   ret = mxt_write_register(mxt, &backupnv_value, t6_addr + MXT_T6_BACKUPNV_OFFSET, 1);
@@ -110,36 +180,18 @@ int mxt_self_cap_tune(struct mxt_device *mxt, mxt_app_cmd cmd)
   mxt_msg_wait(mxt, 100);
 
   mxt_info(mxt->ctx, "Tuning");
-  t109_command = T109_CMD_TUNE;
-  mxt_info(mxt->ctx, "Writing %u to T109 CMD register", cmd);
-  ret = mxt_write_register(mxt, &t109_command, t109_addr + T109_CMD_OFFSET, 1);
+  ret = mxt_self_cap_dispatch(mxt, &seq, T109_CMD_TUNE);
   if (ret)
     return ret;
 
-  ret = mxt_read_messages(mxt, T109_TIMEOUT, &t109_command, mxt_self_cap_command, (int *)&mxt_sigint_rx);
+  ret = mxt_read_messages(mxt, T109_TIMEOUT + T109_STORE_TIMEOUT, &seq,
+                          mxt_self_cap_handle_messages, (int *)&mxt_sigint_rx);
   if (ret)
     return ret;
 
-  switch (cmd) {
-  case CMD_SELF_CAP_TUNE_CONFIG:
-    mxt_info(mxt->ctx, "Store to Config");
-    t109_command = T109_CMD_STORE_TO_CONFIG_RAM;
-    break;
-
-  default:
-  case CMD_SELF_CAP_TUNE_NVRAM:
-    mxt_info(mxt->ctx, "Store to NVRAM");
-    t109_command = T109_CMD_STORE_TO_NVM;
-    break;
-  }
-  mxt_info(mxt->ctx, "Writing %u to T109 CMD register", cmd);
-  ret = mxt_write_register(mxt, &t109_command, t109_addr + T109_CMD_OFFSET, 1);
-  if (ret)
-    return ret;
-
-  ret = mxt_read_messages(mxt, 100, (void *) &t109_command, mxt_self_cap_command, (int *)&mxt_sigint_rx);
-  if (ret)
-    return ret;
+  /* Interrupted before the store command finished */
+  if (!seq.stored)
+    return MXT_ERROR_INTERRUPTED;
 
   mxt_info(mxt->ctx, "Saving configuration");
   ret = mxt_backup_config(mxt, BACKUPNV_COMMAND);
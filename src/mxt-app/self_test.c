@@ -35,6 +35,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdbool.h>
+#include <time.h>
 
 #include "libmaxtouch/libmaxtouch.h"
 #include "libmaxtouch/info_block.h"
@@ -45,6 +46,28 @@
 
 #define SELFTEST_TIMEOUT   10
 
+//******************************************************************************
+/// \brief Queue of self test commands run on one device
+struct self_test_sched {
+  uint16_t cmd_addr;
+  bool type;
+  struct self_test_result *results;
+  int count;
+  int current;
+  struct timespec start;
+};
+
+//******************************************************************************
+/// \brief Self test queue run on one of several devices
+struct self_test_worker {
+  const char *name;
+  bool type;
+  struct self_test_result results[SELF_TEST_MAX_CMDS];
+  int count;
+  int ret;
+  double elapsed;
+};
+
 //******************************************************************************
 /// \brief Handle messages from the self test object
 /// \return #mxt_rc
@@ -368,8 +391,10 @@ static void disable_noise_suppression(struct mxt_device *mxt)
 }
 
 //******************************************************************************
-/// \brief Run self test
-int run_self_tests(struct mxt_device *mxt, uint8_t cmd, bool type)
+/// \brief Enable the self test object and log its limits
+/// \return #mxt_rc, MXT_ERROR_OBJECT_NOT_FOUND if the object is not present
+static int self_test_prepare(struct mxt_device *mxt, bool type,
+                             uint16_t *cmd_addr)
 {
   uint16_t t25_addr;
   uint16_t t10_addr;
@@ -384,7 +409,7 @@ int run_self_tests(struct mxt_device *mxt, uint8_t cmd, bool type)
     
     if (t25_addr == OBJECT_NOT_FOUND) {
       mxt_info(mxt->ctx, "T25 Self Test Object not Found ... Exiting\n");
-      return MXT_SUCCESS;
+      return MXT_ERROR_OBJECT_NOT_FOUND;
     }
 
    // Enable self test object & reporting
@@ -399,41 +424,7 @@ int run_self_tests(struct mxt_device *mxt, uint8_t cmd, bool type)
    if (ret)
      return ret;
 
-   switch (cmd) {
-   case SELF_TEST_ANALOG:
-     mxt_info(mxt->ctx, "Running Analog power test");
-    break;
-   case SELF_TEST_PIN_FAULT:
-     mxt_info(mxt->ctx, "Running Pin fault test");
-     break;
-   case SELF_TEST_PIN_FAULT_2:
-     mxt_info(mxt->ctx, "Running Pin fault 2 test");
-     break;
-   case SELF_TEST_AND_GATE:
-     mxt_info(mxt->ctx, "Running AND Gate test");
-     break;
-   case SELF_TEST_SIGNAL_LIMIT:
-     mxt_info(mxt->ctx, "Running Signal Limit test");
-     break;
-   case SELF_TEST_GAIN:
-     mxt_info(mxt->ctx, "Running Gain test");
-     break;
-   case SELF_TEST_OFFSET:
-     mxt_info(mxt->ctx, "Running Offset test");
-     break;
-   case SELF_TEST_ALL:
-     mxt_info(mxt->ctx, "Running all tests");
-     break;
-   default:
-     mxt_info(mxt->ctx, "Writing %02X to CMD register", cmd);
-     break;
-   }
-
-   mxt_msg_reset(mxt);
-
-   mxt_dump_messages(mxt);
-
-   mxt_write_register(mxt, &cmd, t25_addr + 1, 1);
+   *cmd_addr = t25_addr + 1;
  } else {
 
    // Enable self test object & reporting
@@ -441,7 +432,7 @@ int run_self_tests(struct mxt_device *mxt, uint8_t cmd, bool type)
     
     if (t10_addr == OBJECT_NOT_FOUND) {
       mxt_info(mxt->ctx, "T10 Self Test Object not Found ... Exiting\n");
-      return MXT_SUCCESS;
+      return MXT_ERROR_OBJECT_NOT_FOUND;
     }
 
    t12_addr = mxt_get_object_address(mxt, SPT_SELFTESTSIGLIMIT_T12,  0);
@@ -463,33 +454,274 @@ int run_self_tests(struct mxt_device *mxt, uint8_t cmd, bool type)
    if (ret)
      return ret;
 
-   switch (cmd) {
-   case OND_POWER_TEST:
-     mxt_info(mxt->ctx, "Running power test");
-     break;
-   case OND_PIN_FAULT_TEST:
-     mxt_info(mxt->ctx, "Running Pin fault test");
-     break;
-   case OND_SIGNAL_LIMIT_TEST:
-     mxt_info(mxt->ctx, "Running signal limit test");
-     break;
-   case OND_RUN_ALL_TEST:
-     mxt_info(mxt->ctx, "Running all tests");
-     break;
-   default:
-     mxt_info(mxt->ctx, "Writing %02X to CMD register", cmd);
-     break;
-   }
+   *cmd_addr = t10_addr + 1;
+ }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Get name of self test command
+static const char *self_test_name(uint8_t cmd, bool type)
+{
+  if (type == 0) {
+    switch (cmd) {
+    case SELF_TEST_ANALOG:       return "Analog power";
+    case SELF_TEST_PIN_FAULT:    return "Pin fault";
+    case SELF_TEST_PIN_FAULT_2:  return "Pin fault 2";
+    case SELF_TEST_AND_GATE:     return "AND Gate";
+    case SELF_TEST_SIGNAL_LIMIT: return "Signal Limit";
+    case SELF_TEST_GAIN:         return "Gain";
+    case SELF_TEST_OFFSET:       return "Offset";
+    case SELF_TEST_ALL:          return "all";
+    default:                     return NULL;
+    }
+  }
+
+  switch (cmd) {
+  case OND_POWER_TEST:         return "power";
+  case OND_PIN_FAULT_TEST:     return "Pin fault";
+  case OND_SIGNAL_LIMIT_TEST:  return "signal limit";
+  case OND_RUN_ALL_TEST:       return "all";
+  default:                     return NULL;
+  }
+}
+
+//******************************************************************************
+/// \brief Elapsed time in seconds since start
+static double self_test_elapsed(const struct timespec *start)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+//******************************************************************************
+/// \brief Write the next queued command to the self test object
+/// \return #mxt_rc
+static int self_test_dispatch(struct mxt_device *mxt, struct self_test_sched *sched)
+{
+  struct self_test_result *r = &sched->results[sched->current];
+  const char *name = self_test_name(r->cmd, sched->type);
+
+  if (name)
+    mxt_info(mxt->ctx, "Running %s test%s", name,
+             (r->cmd == SELF_TEST_ALL || r->cmd == OND_RUN_ALL_TEST) ? "s" : "");
+  else
+    mxt_info(mxt->ctx, "Writing %02X to CMD register", r->cmd);
+
+  clock_gettime(CLOCK_MONOTONIC, &sched->start);
+
+  return mxt_write_register(mxt, &r->cmd, sched->cmd_addr, 1);
+}
+
+//******************************************************************************
+/// \brief Record a test result and start the next queued command
+/// \return #mxt_rc
+static int self_test_sched_handle_messages(struct mxt_device *mxt, uint8_t *msg,
+                                           void *context, uint8_t size)
+{
+  struct self_test_sched *sched = context;
+  struct self_test_result *r = &sched->results[sched->current];
+  int ret;
+
+  ret = self_test_handle_messages(mxt, msg, NULL, size);
+  if (ret == MXT_MSG_CONTINUE)
+    return ret;
+
+  r->ret = ret;
+  r->duration = self_test_elapsed(&sched->start);
+
+  if (++sched->current == sched->count)
+    return MXT_SUCCESS;
+
+  ret = self_test_dispatch(mxt, sched);
+  if (ret)
+    return ret;
+
+  return MXT_MSG_CONTINUE;
+}
+
+//******************************************************************************
+/// \brief Run queued self test commands
+/// \note  Each command is written as soon as the result of the previous one
+///        is received, within a single message read loop
+/// \return #mxt_rc of the first failing test
+int mxt_self_test_run(struct mxt_device *mxt, struct self_test_result *results,
+                      int count, bool type)
+{
+  struct self_test_sched sched;
+  int ret;
+  int i;
+
+  for (i = 0; i < count; i++) {
+    results[i].ret = MXT_ERROR_TIMEOUT;
+    results[i].duration = 0;
+  }
+
+  if (count == 0)
+    return MXT_SUCCESS;
+
+  memset(&sched, 0, sizeof(sched));
+  sched.results = results;
+  sched.count = count;
+  sched.type = type;
+
+  ret = self_test_prepare(mxt, type, &sched.cmd_addr);
+  if (ret == MXT_ERROR_OBJECT_NOT_FOUND) {
+    for (i = 0; i < count; i++)
+      results[i].ret = MXT_SUCCESS;
+    return MXT_SUCCESS;
+  } else if (ret) {
+    return ret;
+  }
 
   mxt_msg_reset(mxt);
 
   mxt_dump_messages(mxt);
 
-  mxt_write_register(mxt, &cmd, t10_addr + 1, 1);
+  ret = self_test_dispatch(mxt, &sched);
+  if (ret)
+    return ret;
 
- }
+  ret = mxt_read_messages_sigint(mxt, SELFTEST_TIMEOUT * count, &sched,
+                                 self_test_sched_handle_messages);
+  if (ret)
+    return ret;
+
+  for (i = 0; i < count; i++) {
+    if (results[i].ret)
+      return results[i].ret;
+  }
+
+  return MXT_SUCCESS;
+}
 
-   return mxt_read_messages_sigint(mxt, SELFTEST_TIMEOUT, NULL, self_test_handle_messages);
+//******************************************************************************
+/// \brief Run self test
+int run_self_tests(struct mxt_device *mxt, uint8_t cmd, bool type)
+{
+  struct self_test_result result = { .cmd = cmd };
+
+  return mxt_self_test_run(mxt, &result, 1, type);
+}
+
+//******************************************************************************
+/// \brief Print self test results for one device as JSON
+static void self_test_print_device(FILE *fp, const char *name,
+                                   const struct self_test_result *results,
+                                   int count, bool type, int ret, double elapsed)
+{
+  const char *test;
+  int i;
+
+  fprintf(fp, "    {\"device\": \"%s\", \"object\": \"T%d\", "
+          "\"result\": \"%s\", \"error\": %d, \"duration_s\": %0.3f, "
+          "\"tests\": [\n",
+          name ? name : "", type ? 10 : 25, ret ? "FAIL" : "PASS", ret, elapsed);
+
+  for (i = 0; i < count; i++) {
+    test = self_test_name(results[i].cmd, type);
+
+    fprintf(fp, "      {\"cmd\": \"%02X\", \"name\": \"%s\", "
+            "\"result\": \"%s\", \"error\": %d, \"duration_s\": %0.3f}%s\n",
+            results[i].cmd, test ? test : "", results[i].ret ? "FAIL" : "PASS",
+            results[i].ret, results[i].duration, (i < count - 1) ? "," : "");
+  }
+
+  fprintf(fp, "    ]}");
+}
+
+//******************************************************************************
+/// \brief Print aggregated self test report as JSON
+static void self_test_print_report(FILE *fp, struct self_test_worker *workers,
+                                   int count)
+{
+  int i;
+
+  fprintf(fp, "{\n  \"self_test\": [\n");
+
+  for (i = 0; i < count; i++) {
+    self_test_print_device(fp, workers[i].name, workers[i].results,
+                           workers[i].count, workers[i].type,
+                           workers[i].ret, workers[i].elapsed);
+    fprintf(fp, "%s\n", (i < count - 1) ? "," : "");
+  }
+
+  fprintf(fp, "  ]\n}\n");
+}
+
+//******************************************************************************
+/// \brief Print self test report for a single device as JSON
+void mxt_self_test_print_results(FILE *fp, const struct self_test_result *results,
+                                 int count, bool type, int ret)
+{
+  double elapsed = 0;
+  int i;
+
+  for (i = 0; i < count; i++)
+    elapsed += results[i].duration;
+
+  fprintf(fp, "{\n  \"self_test\": [\n");
+  self_test_print_device(fp, NULL, results, count, type, ret, elapsed);
+  fprintf(fp, "\n  ]\n}\n");
+}
+
+//******************************************************************************
+/// \brief Run the self test queue on one device of a parallel run
+static int self_test_parallel_run(struct mxt_device *mxt, int index,
+                                  void *context)
+{
+  struct self_test_worker *w = (struct self_test_worker *)context + index;
+  struct timespec start;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  w->ret = mxt_self_test_run(mxt, w->results, w->count, w->type);
+
+  w->elapsed = self_test_elapsed(&start);
+
+  return w->ret;
+}
+
+//******************************************************************************
+/// \brief Run the same self test queue on several devices concurrently
+/// \return #mxt_rc
+int mxt_self_test_multi(struct libmaxtouch_ctx *ctx, struct mxt_conn_info **conns,
+                        const char **names, int num_devices,
+                        const uint8_t *cmds, int count, bool type)
+{
+  struct self_test_worker workers[MXT_FLASH_MAX_DEVICES];
+  int ret;
+  int i, j;
+
+  if (num_devices > MXT_FLASH_MAX_DEVICES || count > SELF_TEST_MAX_CMDS)
+    return MXT_ERROR_BAD_INPUT;
+
+  memset(workers, 0, sizeof(workers));
+
+  for (i = 0; i < num_devices; i++) {
+    struct self_test_worker *w = &workers[i];
+
+    w->name = names[i];
+    w->type = type;
+    w->count = count;
+    w->ret = MXT_ERROR_NO_DEVICE;
+
+    for (j = 0; j < count; j++) {
+      w->results[j].cmd = cmds[j];
+      w->results[j].ret = MXT_ERROR_NO_DEVICE;
+    }
+  }
+
+  ret = mxt_run_parallel(ctx, conns, names, num_devices,
+                         self_test_parallel_run, NULL, workers);
+
+  self_test_print_report(stdout, workers, num_devices);
+
+  return ret;
 }
 
 //******************************************************************************
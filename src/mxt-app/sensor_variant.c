@@ -211,57 +211,161 @@ int get_yline_data(struct t37_ctx *frame, uint16_t y, uint16_t xsize,
 }
 
 //******************************************************************************
-/// \brief Perform Sensor variant algorithm
+/// \brief Release sensor variant workspace
+void sensor_variant_workspace_free(struct sensor_variant_workspace *ws)
+{
+  free(ws->pinv_x);
+  free(ws->status);
+  memset(ws, 0, sizeof(*ws));
+}
+
+//******************************************************************************
+/// \brief Precompute the least squares fit for abscissa 0..len-1
 /// \return #mxt_rc
-int sensor_variant_algorithm(struct t37_ctx *frame,
-                             struct mxt_touchscreen_info *ts,
-                             struct sensor_variant_options *sv_opts)
+static int sensor_variant_fit_init(struct libmaxtouch_ctx *ctx, int len,
+                                   double *pinv, double *vander)
+{
+  int n = POLY_DEGREE + 1;
+  double xdata[len];
+  int i, k;
+
+  for (k = 0; k < len; k++) {
+    xdata[k] = (double)k;
+
+    vander[k * n] = 1.0;
+    for (i = 1; i < n; i++)
+      vander[k * n + i] = vander[k * n + i - 1] * xdata[k];
+  }
+
+  if (!ft_polyfit_pinv(ctx, xdata, len, pinv)) {
+    mxt_err(ctx, "  Error: Failed to fit polynomial");
+    return MXT_INTERNAL_ERROR;
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Allocate sensor variant workspace for num_x by num_y lines
+///
+/// The workspace holds the fits for both axes and the frame buffers, so
+/// it may be reused for any number of frames of the same size.
+/// \return #mxt_rc
+int sensor_variant_workspace_init(struct libmaxtouch_ctx *ctx,
+                                  struct sensor_variant_workspace *ws,
+                                  int num_x, int num_y)
 {
+  int n = POLY_DEGREE + 1;
+  int nodes = num_x * num_y;
+  int longest = (num_x > num_y) ? num_x : num_y;
   int ret;
-  int x,y;
-  uint32_t total_failed = 0;
-  uint16_t num_x = ts->xsize;
 
-  mxt_dbg(frame->lc, "debug frame: x_size: %d, y_size: %d",
-          frame->x_size, frame->y_size);
-  mxt_dbg(frame->lc, "TS xorigin: %d, yorigin: %d", ts->xorigin, ts->yorigin);
-  mxt_dbg(frame->lc, "TS size: xsize: %d, ysize: %d", ts->xsize, ts->ysize);
-  mxt_dbg(frame->lc, "Dual X lines: %s", (sv_opts->dualx ? "ON" : "OFF"));
+  memset(ws, 0, sizeof(*ws));
 
-  if (sv_opts->dualx)
-    num_x--;
+  if (num_x <= POLY_DEGREE || num_y <= POLY_DEGREE) {
+    mxt_err(ctx, "Sensor variant needs more than %d lines on each axis",
+            POLY_DEGREE);
+    return MXT_ERROR_BAD_INPUT;
+  }
 
-  /* Init matrix memory */
-  double *xval = calloc(num_x, sizeof(double));
-  if (!xval) {
+  ws->lc = ctx;
+  ws->num_x = num_x;
+  ws->num_y = num_y;
+
+  /* All double arrays share one allocation, and the bool arrays another */
+  ws->pinv_x = calloc(2 * n * (num_x + num_y) + 2 * nodes + longest,
+                      sizeof(double));
+  ws->status = calloc(2 * nodes, sizeof(bool));
+  if (!ws->pinv_x || !ws->status) {
+    sensor_variant_workspace_free(ws);
     return MXT_ERROR_NO_MEM;
   }
 
-  double *yval = calloc(ts->ysize, sizeof(double));
-  if (!yval) {
-    free(xval);
-    return MXT_ERROR_NO_MEM;
+  ws->vander_x = ws->pinv_x + n * num_y;
+  ws->pinv_y = ws->vander_x + n * num_y;
+  ws->vander_y = ws->pinv_y + n * num_x;
+  ws->xlines = ws->vander_y + n * num_x;
+  ws->ylines = ws->xlines + nodes;
+  ws->fit = ws->ylines + nodes;
+  ws->ystatus = ws->status + nodes;
+
+  ret = sensor_variant_fit_init(ctx, num_y, ws->pinv_x, ws->vander_x);
+  if (!ret)
+    ret = sensor_variant_fit_init(ctx, num_x, ws->pinv_y, ws->vander_y);
+
+  if (ret)
+    sensor_variant_workspace_free(ws);
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief Fit one line with a precomputed pseudoinverse and test it
+/// \return number of failures
+static uint32_t sensor_variant_check_line(struct sensor_variant_workspace *ws,
+                                          struct sensor_variant_options *sv_opts,
+                                          const double *pinv,
+                                          const double *vander,
+                                          double *data, int len,
+                                          bool *status, double *coeff)
+{
+  int n = POLY_DEGREE + 1;
+  int i, k;
+
+  for (i = 0; i < n; i++) {
+    const double *row = pinv + i * len;
+    double c = 0.0;
+
+    for (k = 0; k < len; k++)
+      c += row[k] * data[k];
+
+    coeff[i] = c;
   }
 
-  bool *status = calloc(num_x * ts->ysize, sizeof(bool));
-  if (!status) {
-    ret = MXT_ERROR_NO_MEM;
-    goto free;
+  for (k = 0; k < len; k++) {
+    const double *v = vander + k * n;
+    double y = 0.0;
+
+    for (i = 0; i < n; i++)
+      y += v[i] * coeff[i];
+
+    ws->fit[k] = y;
   }
 
-  /* Test X lines */
-  for (x = 0; x < num_x; x++)
-    xval[x] = (double)x;
+  return failure_scan(ws->lc, ws->fit, data, len, status, sv_opts);
+}
+
+//******************************************************************************
+/// \brief Perform Sensor variant algorithm using a workspace
+/// \return #mxt_rc
+int sensor_variant_run(struct sensor_variant_workspace *ws,
+                       struct t37_ctx *frame,
+                       struct sensor_variant_options *sv_opts)
+{
+  int num_x = ws->num_x;
+  int num_y = ws->num_y;
+  uint32_t total_failed = 0;
+  int x, y;
+
+  /* Copy the frame once into X major and Y major line buffers */
+  for (x = 0; x < num_x; x++) {
+    const uint16_t *src = frame->data_buf + x * frame->y_size;
+    double *xline = ws->xlines + x * num_y;
+
+    for (y = 0; y < num_y; y++) {
+      xline[y] = (double)src[y];
+      ws->ylines[y * num_x + x] = xline[y];
+    }
+  }
 
+  /* Test X lines */
   for (x = 0; x < num_x; x++) {
     uint32_t failures;
     double coeff[POLY_DEGREE + 1];
-    get_xline_data(frame, x, ts->ysize, yval);
 
-    ret = check_line(frame->lc, sv_opts, xval, yval, ts->ysize,
-                     &failures, status + (x * ts->ysize), coeff);
-    if (ret)
-      goto free;
+    failures = sensor_variant_check_line(ws, sv_opts, ws->pinv_x, ws->vander_x,
+                                         ws->xlines + x * num_y, num_y,
+                                         ws->status + x * num_y, coeff);
 
     mxt_dbg(frame->lc, "X%d coefficients (%0.2f,%0.2f,%0.2f) failures %d",
             x, coeff[0], coeff[1], coeff[2], failures);
@@ -270,24 +374,13 @@ int sensor_variant_algorithm(struct t37_ctx *frame,
   }
 
   /* Test Y lines */
-  for (y = 0; y < ts->ysize; y++)
-    yval[y] = (double)y;
-
-  for (y = 0; y < ts->ysize; y++) {
+  for (y = 0; y < num_y; y++) {
     uint32_t failures;
     double coeff[POLY_DEGREE + 1];
-    bool yline_status[num_x];
-    get_yline_data(frame, y, num_x, xval);
 
-    ret = check_line(frame->lc, sv_opts, yval, xval, num_x,
-                     &failures, yline_status, coeff);
-    if (ret)
-      goto free;
-
-    /* status array is not contiguous for y */
-    for (x = 0; x < num_x; x++)
-      if (yline_status[x])
-        status[(x * ts->ysize) + y] = true;
+    failures = sensor_variant_check_line(ws, sv_opts, ws->pinv_y, ws->vander_y,
+                                         ws->ylines + y * num_x, num_x,
+                                         ws->ystatus + y * num_x, coeff);
 
     mxt_dbg(frame->lc, "Y%d coefficients (%0.2f,%0.2f,%0.2f) failures %d",
                 y, coeff[0], coeff[1], coeff[2], failures);
@@ -295,6 +388,11 @@ int sensor_variant_algorithm(struct t37_ctx *frame,
     total_failed += failures;
   }
 
+  /* Merge Y line results into the X major status map */
+  for (x = 0; x < num_x; x++)
+    for (y = 0; y < num_y; y++)
+      ws->status[x * num_y + y] |= ws->ystatus[y * num_x + x];
+
   /* check results */
   if (total_failed) {
     printf("Sensor Variant defects detected:\n");
@@ -305,30 +403,54 @@ int sensor_variant_algorithm(struct t37_ctx *frame,
     }
     printf("\n");
 
-    for (y = 0; y < ts->ysize; y++) {
+    for (y = 0; y < num_y; y++) {
       printf("Y%-3d", y);
       for (x = 0; x < num_x; x++) {
-        printf("%c   ", (status[(x * ts->ysize) +  y] ? 'O' : '-'));
+        printf("%c   ", (ws->status[(x * num_y) + y] ? 'O' : '-'));
       }
       printf("\n");
     }
   }
 
   if (sv_opts->matrix_size)
-    total_failed = check_sub_matrix(frame, status, num_x, ts->ysize, sv_opts);
+    total_failed = check_sub_matrix(frame, ws->status, num_x, num_y, sv_opts);
 
   if (total_failed > sv_opts->max_defects) {
     mxt_err(frame->lc, "FAIL: %d Sensor Variant issues detected", total_failed);
-    ret = MXT_SENSOR_VARIANT_DETECTED;
-  } else {
-    mxt_info(frame->lc, "PASS: Sensor Variant issues not detected");
-    ret = MXT_SUCCESS;
+    return MXT_SENSOR_VARIANT_DETECTED;
   }
 
-free:
-  free(xval);
-  free(yval);
-  free(status);
+  mxt_info(frame->lc, "PASS: Sensor Variant issues not detected");
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Perform Sensor variant algorithm
+/// \return #mxt_rc
+int sensor_variant_algorithm(struct t37_ctx *frame,
+                             struct mxt_touchscreen_info *ts,
+                             struct sensor_variant_options *sv_opts)
+{
+  struct sensor_variant_workspace ws;
+  uint16_t num_x = ts->xsize;
+  int ret;
+
+  mxt_dbg(frame->lc, "debug frame: x_size: %d, y_size: %d",
+          frame->x_size, frame->y_size);
+  mxt_dbg(frame->lc, "TS xorigin: %d, yorigin: %d", ts->xorigin, ts->yorigin);
+  mxt_dbg(frame->lc, "TS size: xsize: %d, ysize: %d", ts->xsize, ts->ysize);
+  mxt_dbg(frame->lc, "Dual X lines: %s", (sv_opts->dualx ? "ON" : "OFF"));
+
+  if (sv_opts->dualx)
+    num_x--;
+
+  ret = sensor_variant_workspace_init(frame->lc, &ws, num_x, ts->ysize);
+  if (ret)
+    return ret;
+
+  ret = sensor_variant_run(&ws, frame, sv_opts);
+
+  sensor_variant_workspace_free(&ws);
 
   return ret;
 }
@@ -421,6 +543,8 @@ free:
   mxt_ts_info = NULL;
   free(frame->data_buf);
   frame->data_buf = NULL;
+  free(frame->temp_buf);
+  frame->temp_buf = NULL;
   free(frame->t37_buf);
   frame->t37_buf = NULL;
   free(frame);
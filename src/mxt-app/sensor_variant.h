@@ -48,13 +48,39 @@ struct sensor_variant_options
   uint8_t lower_limit;
 };
 
+//******************************************************************************
+/// \brief Sensor Variant workspace, reusable across frames of one size
+struct sensor_variant_workspace
+{
+  struct libmaxtouch_ctx *lc;
+  int num_x;
+  int num_y;
+  /* Least squares fit along X lines (num_y points) and Y lines (num_x
+   * points): pseudoinverse rows by coefficient, Vandermonde rows by point */
+  double *pinv_x;
+  double *vander_x;
+  double *pinv_y;
+  double *vander_y;
+  /* Frame references, X major and transposed to Y major */
+  double *xlines;
+  double *ylines;
+  double *fit;
+  /* Defect map, X major, and Y line results, Y major */
+  bool *status;
+  bool *ystatus;
+};
+
 int check_sub_matrix(struct t37_ctx *ctx, bool *status, int x_size, int y_size, struct sensor_variant_options *sv_opts);
 int sensor_variant_algorithm(struct t37_ctx *frame, struct mxt_touchscreen_info *ts, struct sensor_variant_options *sv_opts);
+int sensor_variant_workspace_init(struct libmaxtouch_ctx *ctx, struct sensor_variant_workspace *ws, int num_x, int num_y);
+void sensor_variant_workspace_free(struct sensor_variant_workspace *ws);
+int sensor_variant_run(struct sensor_variant_workspace *ws, struct t37_ctx *frame, struct sensor_variant_options *sv_opts);
 int validate_sensor_variant_options(struct mxt_device *mxt, struct sensor_variant_options *sv_opts);
 int mxt_sensor_variant(struct mxt_device *mxt, struct sensor_variant_options *sv_opts);
 int calculate_poly(double *data, double *coeff, int len, double *result);
 int check_line(struct libmaxtouch_ctx *ctx, struct sensor_variant_options *sv_opts, double *xval, double *yval, int len, uint32_t *num_failed, bool *status, double *coeff);
 double ft_peval(double x, double *coeffs);
 bool ft_polyfit(struct libmaxtouch_ctx *ctx, double *xdata, double *ydata, double *result, int len);
+bool ft_polyfit_pinv(struct libmaxtouch_ctx *ctx, double *xdata, int len, double *pinv);
 int get_xline_data(struct t37_ctx *frame, uint16_t x, uint16_t ysize, double *yval);
 int get_yline_data(struct t37_ctx *frame, uint16_t y, uint16_t xsize, double *xval);
@@ -35,6 +35,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <limits.h>
+#include <sys/stat.h>
 
 #include "libmaxtouch/libmaxtouch.h"
 #include "libmaxtouch/info_block.h"
@@ -59,6 +60,9 @@
 
 #define T68_TIMEOUT                30
 
+/* Values parsed from file before appending to buffer */
+#define T68_LOAD_CHUNK             256
+
 //******************************************************************************
 /// \brief T68 Serial Data Command Context object
 struct t68_ctx {
@@ -113,21 +117,6 @@ static int mxt_t68_get_status(struct mxt_device *mxt, uint8_t *msg,
   return MXT_MSG_CONTINUE;
 }
 
-//******************************************************************************
-/// \brief  Send command then check status
-/// \return #mxt_rc
-static int mxt_t68_command(struct t68_ctx *ctx, uint8_t cmd)
-{
-  int ret;
-
-  mxt_verb(ctx->lc, "Writing %u to CMD register", cmd);
-  ret = mxt_write_register(ctx->mxt, &cmd, ctx->t68_cmd_addr, 1);
-  if (ret)
-    return ret;
-
-  return mxt_read_messages_sigint(ctx->mxt, T68_TIMEOUT, ctx, mxt_t68_get_status);
-}
-
 //******************************************************************************
 /// \brief  Enable T68
 /// \return #mxt_rc
@@ -156,6 +145,9 @@ static int mxt_t68_load_file(struct t68_ctx *ctx)
   FILE *fp;
   bool file_read = false;
   char buf[256];
+  uint8_t chunk[T68_LOAD_CHUNK];
+  size_t chunk_len = 0;
+  struct stat st;
   uint16_t hexcount;
   int c;
 
@@ -172,6 +164,13 @@ static int mxt_t68_load_file(struct t68_ctx *ctx)
     goto close;
   }
 
+  /* Each value takes at least five characters, eg "0xAB," */
+  if (fstat(fileno(fp), &st) == 0 && st.st_size > 0) {
+    ret = mxt_buf_reserve(&ctx->buf, st.st_size / 5);
+    if (ret)
+      goto fail;
+  }
+
   while (!file_read) {
     /* Read next value from file */
     c = getc(fp);
@@ -219,9 +218,15 @@ static int mxt_t68_load_file(struct t68_ctx *ctx)
       if (ret)
         goto fail;
 
-      ret = mxt_buf_add(&ctx->buf, value);
-      if (ret)
-        goto fail;
+      chunk[chunk_len++] = value;
+
+      if (chunk_len == sizeof(chunk)) {
+        ret = mxt_buf_append(&ctx->buf, chunk, chunk_len);
+        if (ret)
+          goto fail;
+
+        chunk_len = 0;
+      }
     } else {
       mxt_err(ctx->lc, "Unexpected character \"%c\"", c);
       ret = MXT_ERROR_FILE_FORMAT;
@@ -229,6 +234,10 @@ static int mxt_t68_load_file(struct t68_ctx *ctx)
     }
   }
 
+  ret = mxt_buf_append(&ctx->buf, chunk, chunk_len);
+  if (ret)
+    goto fail;
+
   mxt_info(ctx->lc, "Loaded file %s, %zu bytes", ctx->filename, ctx->buf.size);
 
   return MXT_SUCCESS;
@@ -266,50 +275,80 @@ static int mxt_t68_zero_data(struct t68_ctx *ctx)
                             sizeof(zeros));
 }
 
+//******************************************************************************
+/// \brief Build frame of T68 data
+/// \note  CMD directly follows the DATA array, so LENGTH, DATA and CMD are
+///        laid out as one register block. DATA is zero padded after LENGTH.
+/// \return number of payload bytes in frame
+static size_t mxt_t68_build_frame(struct t68_ctx *ctx, uint8_t *frame,
+                                  size_t offset, int frame_num)
+{
+  size_t frame_size = MIN(ctx->buf.size - offset, ctx->t68_data_size);
+  uint8_t cmd;
+
+  if (frame_num == 1)
+    cmd = T68_CMD_START;
+  else if (offset + frame_size >= ctx->buf.size)
+    cmd = T68_CMD_END;
+  else
+    cmd = T68_CMD_CONTINUE;
+
+  frame[0] = frame_size;
+  memcpy(frame + 1, ctx->buf.data + offset, frame_size);
+  memset(frame + 1 + frame_size, 0, ctx->t68_data_size - frame_size);
+  frame[1 + ctx->t68_data_size] = cmd;
+
+  return frame_size;
+}
+
 //******************************************************************************
 /// \brief Send frames of T68 data to chip
+/// \note  Each frame is a single register write. The next frame is prepared
+///        while the chip processes the current one.
 /// \return #mxt_rc
 static int mxt_t68_send_frames(struct t68_ctx *ctx)
 {
   int ret;
   size_t offset = 0;
-  uint16_t frame_size;
+  size_t frame_size, next_size = 0;
+  size_t frame_len = ctx->t68_data_size + 2;
+  uint8_t frames[2][frame_len];
   int frame = 1;
-  uint8_t cmd;
+  int cur = 0;
 
-  while (offset < ctx->buf.size) {
-    frame_size = MIN(ctx->buf.size - offset, ctx->t68_data_size);
+  if (ctx->buf.size == 0)
+    return MXT_SUCCESS;
 
-    mxt_info(ctx->lc, "Writing frame %u, %u bytes", frame, frame_size);
+  if (MIN(ctx->buf.size, ctx->t68_data_size) > UCHAR_MAX) {
+    mxt_err(ctx->lc, "Serial data frame size miscalculation");
+    return MXT_INTERNAL_ERROR;
+  }
 
-    if (frame_size > UCHAR_MAX) {
-      mxt_err(ctx->lc, "Serial data frame size miscalculation");
-      return MXT_INTERNAL_ERROR;
-    }
+  frame_size = mxt_t68_build_frame(ctx, frames[cur], offset, frame);
 
-    ret = mxt_write_register(ctx->mxt, ctx->buf.data + offset,
-                             ctx->t68_addr + T68_DATA,
-                             frame_size);
-    if (ret)
-      return ret;
+  while (true) {
+    mxt_info(ctx->lc, "Writing frame %u, %zu bytes", frame, frame_size);
+    mxt_verb(ctx->lc, "Writing %u to CMD register", frames[cur][frame_len - 1]);
 
-    ret = mxt_t68_write_length(ctx, frame_size);
+    ret = mxt_write_register(ctx->mxt, frames[cur],
+                             ctx->t68_addr + T68_LENGTH, frame_len);
     if (ret)
       return ret;
 
     offset += frame_size;
+    cur ^= 1;
 
-    if (frame == 1)
-      cmd = T68_CMD_START;
-    else if (offset >= ctx->buf.size)
-      cmd = T68_CMD_END;
-    else
-      cmd = T68_CMD_CONTINUE;
+    if (offset < ctx->buf.size)
+      next_size = mxt_t68_build_frame(ctx, frames[cur], offset, frame + 1);
 
-    ret = mxt_t68_command(ctx, cmd);
+    ret = mxt_read_messages_sigint(ctx->mxt, T68_TIMEOUT, ctx, mxt_t68_get_status);
     if (ret)
       return ret;
 
+    if (offset >= ctx->buf.size)
+      break;
+
+    frame_size = next_size;
     frame++;
   }
 
@@ -421,7 +460,9 @@ int mxt_serial_data_upload(struct mxt_device *mxt, const char *filename, uint16_
     goto release;
 
   mxt_info(ctx.lc, "Sending data");
+  mxt_session_begin(mxt);
   ret = mxt_t68_send_frames(&ctx);
+  mxt_session_end(mxt);
   if (ret) {
     mxt_err(ctx.lc, "Error sending data");
     goto release;
@@ -35,6 +35,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdbool.h>
+#include <pthread.h>
 
 #include "libmaxtouch/libmaxtouch.h"
 #include "libmaxtouch/info_block.h"
@@ -48,6 +49,11 @@
 /// \brief Signal handler semaphore
 volatile sig_atomic_t mxt_sigint_rx = 0;
 
+/* The handler is process wide, so it is installed by the first of several
+ * threads reading messages and restored by the last */
+static pthread_mutex_t sigint_lock = PTHREAD_MUTEX_INITIALIZER;
+static int sigint_users;
+
 //******************************************************************************
 /// \brief Signal handler to catch SIGINT (Ctrl-C) when viewing continuous msgs
 static void mxt_signal_handler(int signal_num)
@@ -59,25 +65,35 @@ static void mxt_signal_handler(int signal_num)
 
 //******************************************************************************
 /// \brief Handles SIGINT signal
-static void mxt_init_sigint_handler(struct mxt_device *mxt, struct sigaction *sa)
+void mxt_init_sigint_handler(struct mxt_device *mxt, struct sigaction *sa)
 {
   sa->sa_handler = mxt_signal_handler;
   sigemptyset(&sa->sa_mask);
   sa->sa_flags = SA_RESTART;
 
-  if (sigaction(SIGINT, sa, NULL) == -1)
+  pthread_mutex_lock(&sigint_lock);
+
+  if (sigint_users++ == 0 && sigaction(SIGINT, sa, NULL) == -1)
     mxt_err(mxt->ctx, "Can't catch SIGINT");
+
+  pthread_mutex_unlock(&sigint_lock);
 }
 
 //******************************************************************************
 /// \brief Sets default function for SIGINT signal
-static void mxt_release_sigint_handler(struct mxt_device *mxt, struct sigaction *sa)
+void mxt_release_sigint_handler(struct mxt_device *mxt, struct sigaction *sa)
 {
-  sa->sa_handler = SIG_DFL;
-  if (sigaction(SIGINT, sa, NULL) == -1)
-    mxt_err(mxt->ctx, "Can't return SIGINT to default handler");
+  pthread_mutex_lock(&sigint_lock);
+
+  if (sigint_users > 0 && --sigint_users == 0) {
+    sa->sa_handler = SIG_DFL;
+    if (sigaction(SIGINT, sa, NULL) == -1)
+      mxt_err(mxt->ctx, "Can't return SIGINT to default handler");
+
+    mxt_sigint_rx = 0;
+  }
 
-  mxt_sigint_rx = 0;
+  pthread_mutex_unlock(&sigint_lock);
 }
 
 //******************************************************************************
@@ -30,6 +30,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <errno.h>
 #include <linux/input.h>
 #include <stdlib.h>
@@ -44,40 +45,56 @@
 
 #include "mxt_app.h"
 
+//******************************************************************************
+/// \brief Message print options
+struct msg_print_ctx {
+  uint16_t object_type;
+  bool timestamps;
+};
+
 //******************************************************************************
 /// \brief Print message as hex
 /// \return #mxt_rc
 static int print_message_hex(struct mxt_device *mxt, uint8_t *msg,
                              void *context, uint8_t size)
 {
-  const uint16_t object_type = *((uint16_t*)context);
-  int j;
-  int len;
-
-  if (object_type == 0 || object_type == mxt_report_id_to_type(mxt, msg[0])) {
-    len = snprintf(mxt->msg_string, sizeof(mxt->msg_string), MSG_PREFIX);
-    for (j = 0; j < size; j++) {
-      len += snprintf(mxt->msg_string + len, sizeof(mxt->msg_string) - len,
-                      "%02X ", msg[j]);
-    }
-
-    printf("%s\n", mxt->msg_string);
-    fflush(stdout);
+  const struct msg_print_ctx *pctx = context;
+  const struct mxt_report_id_map *map;
+
+  /* Filtered out messages cost one table lookup, nothing is formatted */
+  if (pctx->object_type != 0) {
+    map = mxt_report_id_lookup(mxt, msg[0]);
+    if (!map || map->object_type != pctx->object_type)
+      return MXT_MSG_CONTINUE;
   }
 
+  mxt_format_msg_hex(mxt->msg_string, sizeof(mxt->msg_string), msg, size);
+
+  if (pctx->timestamps)
+    printf("%" PRIu64 ".%09" PRIu64 " ", mxt->msg_time_ns / 1000000000,
+           mxt->msg_time_ns % 1000000000);
+
+  printf("%s\n", mxt->msg_string);
+  fflush(stdout);
+
   return MXT_MSG_CONTINUE;
 }
 
 //******************************************************************************
 /// \brief Print messages
+/// \param timestamps  Prefix each message with the CLOCK_MONOTONIC time of
+///                    its T5 read, on the same clock as binary captures
 /// \return #mxt_rc
-int print_raw_messages(struct mxt_device *mxt, int timeout, uint16_t object_type)
+int print_raw_messages(struct mxt_device *mxt, int timeout, uint16_t object_type,
+                       bool timestamps)
 {
+  struct msg_print_ctx pctx = { .object_type = object_type,
+                                .timestamps = timestamps };
   int err;
 
   mxt_msg_reset(mxt);
 
-  mxt_read_messages_sigint(mxt, timeout, &object_type, print_message_hex);
+  mxt_read_messages_sigint(mxt, timeout, &pctx, print_message_hex);
 
   if (mxt->conn->type == E_I2C_DEV && mxt->debug_fs.enabled == true){
     err = debugfs_set_irq(mxt, true);
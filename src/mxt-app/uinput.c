@@ -0,0 +1,491 @@
+//------------------------------------------------------------------------------
+/// \file   uinput.c
+/// \brief  Touch event injection through uinput
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <linux/input.h>
+#include <linux/uinput.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/info_block.h"
+#include "libmaxtouch/log.h"
+
+#include "mxt_app.h"
+#include "uinput.h"
+
+/* T9 configuration offsets */
+#define T9_ORIENT              9
+#define T9_ORIENT_SWITCH       0x01
+#define T9_XRANGE              18
+#define T9_YRANGE              20
+
+/* T100 configuration offsets */
+#define T100_CFG1              1
+#define T100_CFG1_SWITCHXY     0x20
+#define T100_XRANGE            13
+#define T100_YRANGE            24
+
+/* Range used by the firmware when none is configured */
+#define UINPUT_DEFAULT_RANGE   1023
+
+/* Longest wait before checking for Ctrl-C */
+#define UINPUT_WAIT_MS         100
+
+//******************************************************************************
+/// \brief Initialise multitouch state
+/// \param  max_touches  Most touch messages expected between syncs
+/// \return #mxt_rc
+int uinput_ctx_init(struct uinput_ctx *ui, int num_slots, uint16_t x_max,
+                    uint16_t y_max, uint8_t x_shift, uint8_t y_shift,
+                    int max_touches)
+{
+  int i;
+
+  memset(ui, 0, sizeof(*ui));
+  ui->fd = -1;
+  ui->num_slots = (num_slots > UINPUT_MAX_SLOTS) ? UINPUT_MAX_SLOTS : num_slots;
+  ui->x_max = x_max;
+  ui->y_max = y_max;
+  ui->x_shift = x_shift;
+  ui->y_shift = y_shift;
+  ui->current_slot = -1;
+
+  for (i = 0; i < UINPUT_MAX_SLOTS; i++)
+    ui->tracking_id[i] = -1;
+
+  ui->max_events = max_touches * UINPUT_EVENTS_PER_TOUCH + UINPUT_EVENTS_PER_SYNC;
+  ui->events = calloc(ui->max_events, sizeof(struct input_event));
+  if (!ui->events)
+    return MXT_ERROR_NO_MEM;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Free multitouch state
+void uinput_ctx_free(struct uinput_ctx *ui)
+{
+  free(ui->events);
+  ui->events = NULL;
+}
+
+//******************************************************************************
+/// \brief Queue one input event
+static void uinput_queue(struct uinput_ctx *ui, uint16_t type, uint16_t code,
+                         int32_t value)
+{
+  struct input_event *ev;
+
+  if (ui->num_events >= ui->max_events)
+    return;
+
+  ev = &ui->events[ui->num_events++];
+  ev->type = type;
+  ev->code = code;
+  ev->value = value;
+}
+
+//******************************************************************************
+/// \brief Queue the events for one decoded touch
+void uinput_add_touch(struct uinput_ctx *ui, const struct mxt_touch *touch)
+{
+  int slot = touch->id;
+
+  /* Leave room for ending the frame */
+  if (slot >= ui->num_slots || ui->num_events + UINPUT_EVENTS_PER_TOUCH
+      > ui->max_events - UINPUT_EVENTS_PER_SYNC)
+    return;
+
+  if (!touch->detect && ui->tracking_id[slot] < 0)
+    return;
+
+  if (slot != ui->current_slot) {
+    uinput_queue(ui, EV_ABS, ABS_MT_SLOT, slot);
+    ui->current_slot = slot;
+  }
+
+  if (touch->detect) {
+    if (ui->tracking_id[slot] < 0) {
+      ui->tracking_id[slot] = ui->next_tracking_id++ & 0xFFFF;
+      uinput_queue(ui, EV_ABS, ABS_MT_TRACKING_ID, ui->tracking_id[slot]);
+    }
+
+    ui->x[slot] = touch->x >> ui->x_shift;
+    ui->y[slot] = touch->y >> ui->y_shift;
+    uinput_queue(ui, EV_ABS, ABS_MT_POSITION_X, ui->x[slot]);
+    uinput_queue(ui, EV_ABS, ABS_MT_POSITION_Y, ui->y[slot]);
+  } else {
+    ui->tracking_id[slot] = -1;
+    uinput_queue(ui, EV_ABS, ABS_MT_TRACKING_ID, -1);
+  }
+
+  ui->changed = true;
+}
+
+//******************************************************************************
+/// \brief Queue the single touch emulation and SYN_REPORT ending a frame
+void uinput_add_sync(struct uinput_ctx *ui)
+{
+  bool touching = false;
+  int i;
+
+  if (!ui->changed)
+    return;
+
+  /* Pointer emulation follows the lowest active slot */
+  for (i = 0; i < ui->num_slots; i++) {
+    if (ui->tracking_id[i] >= 0) {
+      touching = true;
+      break;
+    }
+  }
+
+  if (touching != ui->touching) {
+    uinput_queue(ui, EV_KEY, BTN_TOUCH, touching);
+    ui->touching = touching;
+  }
+
+  if (touching) {
+    uinput_queue(ui, EV_ABS, ABS_X, ui->x[i]);
+    uinput_queue(ui, EV_ABS, ABS_Y, ui->y[i]);
+  }
+
+  uinput_queue(ui, EV_SYN, SYN_REPORT, 0);
+
+  ui->changed = false;
+}
+
+//******************************************************************************
+/// \brief Read a little endian 16 bit configuration value
+/// \return #mxt_rc
+static int uinput_read_u16(struct mxt_device *mxt, uint16_t addr, uint16_t *value)
+{
+  uint8_t buf[2];
+  int ret;
+
+  ret = mxt_read_register(mxt, buf, addr, sizeof(buf));
+  if (ret)
+    return ret;
+
+  *value = buf[0] | (buf[1] << 8);
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Find the touch object and read its ranges and orientation
+/// \return #mxt_rc
+static int uinput_read_touch_config(struct mxt_device *mxt, uint16_t *object_type,
+                                    int *num_slots, uint16_t *x_max,
+                                    uint16_t *y_max, uint8_t *x_shift,
+                                    uint8_t *y_shift)
+{
+  uint16_t addr, tmp;
+  uint8_t orient;
+  uint8_t num_report_ids;
+  bool switch_xy;
+  int ret;
+
+  *object_type = TOUCH_MULTITOUCHSCREEN_T100;
+  addr = mxt_get_object_address(mxt, *object_type, 0);
+  if (addr == OBJECT_NOT_FOUND) {
+    *object_type = TOUCH_MULTITOUCHSCREEN_T9;
+    addr = mxt_get_object_address(mxt, *object_type, 0);
+    if (addr == OBJECT_NOT_FOUND) {
+      mxt_err(mxt->ctx, "No T100 or T9 touch object");
+      return MXT_ERROR_OBJECT_NOT_FOUND;
+    }
+  }
+
+  num_report_ids = mxt->info.objects[mxt_get_object_table_num(mxt, *object_type)].num_report_ids;
+
+  if (*object_type == TOUCH_MULTITOUCHSCREEN_T100) {
+    *num_slots = num_report_ids - MXT_T100_FIRST_TOUCH_REPORT;
+
+    ret = mxt_read_register(mxt, &orient, addr + T100_CFG1, 1);
+    if (ret)
+      return ret;
+    switch_xy = orient & T100_CFG1_SWITCHXY;
+
+    ret = uinput_read_u16(mxt, addr + T100_XRANGE, x_max);
+    if (ret)
+      return ret;
+
+    ret = uinput_read_u16(mxt, addr + T100_YRANGE, y_max);
+    if (ret)
+      return ret;
+  } else {
+    *num_slots = num_report_ids;
+
+    ret = mxt_read_register(mxt, &orient, addr + T9_ORIENT, 1);
+    if (ret)
+      return ret;
+    switch_xy = orient & T9_ORIENT_SWITCH;
+
+    ret = uinput_read_u16(mxt, addr + T9_XRANGE, x_max);
+    if (ret)
+      return ret;
+
+    ret = uinput_read_u16(mxt, addr + T9_YRANGE, y_max);
+    if (ret)
+      return ret;
+  }
+
+  if (*x_max == 0)
+    *x_max = UINPUT_DEFAULT_RANGE;
+  if (*y_max == 0)
+    *y_max = UINPUT_DEFAULT_RANGE;
+
+  if (switch_xy) {
+    tmp = *x_max;
+    *x_max = *y_max;
+    *y_max = tmp;
+  }
+
+  /* T9 positions are 12 bit, scaled down on each axis whose range is
+   * 10 bit, as the firmware and kernel driver do */
+  *x_shift = 0;
+  *y_shift = 0;
+  if (*object_type == TOUCH_MULTITOUCHSCREEN_T9) {
+    if (*x_max < 1024)
+      *x_shift = 2;
+    if (*y_max < 1024)
+      *y_shift = 2;
+  }
+
+  if (*num_slots < 1) {
+    mxt_err(mxt->ctx, "T%u has no touch report IDs", *object_type);
+    return MXT_ERROR_OBJECT_NOT_FOUND;
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Set up one absolute axis
+static void uinput_set_abs(struct uinput_user_dev *dev, int fd, int code, int max)
+{
+  ioctl(fd, UI_SET_ABSBIT, code);
+  dev->absmin[code] = 0;
+  dev->absmax[code] = max;
+}
+
+//******************************************************************************
+/// \brief Create the uinput multitouch device
+/// \return #mxt_rc
+static int uinput_create(struct mxt_device *mxt, struct uinput_ctx *ui)
+{
+  struct uinput_user_dev dev;
+  int fd;
+
+  fd = open("/dev/uinput", O_WRONLY | O_NONBLOCK);
+  if (fd < 0) {
+    mxt_err(mxt->ctx, "Could not open /dev/uinput, error %s (%d)",
+            strerror(errno), errno);
+    return mxt_errno_to_rc(errno);
+  }
+
+  memset(&dev, 0, sizeof(dev));
+  snprintf(dev.name, UINPUT_MAX_NAME_SIZE, UINPUT_DEVICE_NAME);
+  dev.id.bustype = BUS_VIRTUAL;
+  dev.id.vendor = 0x03EB;
+  dev.id.product = (mxt->info.id->family << 8) | mxt->info.id->variant;
+  dev.id.version = mxt->info.id->version;
+
+  ioctl(fd, UI_SET_EVBIT, EV_SYN);
+  ioctl(fd, UI_SET_EVBIT, EV_KEY);
+  ioctl(fd, UI_SET_KEYBIT, BTN_TOUCH);
+  ioctl(fd, UI_SET_EVBIT, EV_ABS);
+  ioctl(fd, UI_SET_PROPBIT, INPUT_PROP_DIRECT);
+
+  uinput_set_abs(&dev, fd, ABS_X, ui->x_max);
+  uinput_set_abs(&dev, fd, ABS_Y, ui->y_max);
+  uinput_set_abs(&dev, fd, ABS_MT_SLOT, ui->num_slots - 1);
+  uinput_set_abs(&dev, fd, ABS_MT_TRACKING_ID, 0xFFFF);
+  uinput_set_abs(&dev, fd, ABS_MT_POSITION_X, ui->x_max);
+  uinput_set_abs(&dev, fd, ABS_MT_POSITION_Y, ui->y_max);
+
+  if (write(fd, &dev, sizeof(dev)) != sizeof(dev)
+      || ioctl(fd, UI_DEV_CREATE) < 0) {
+    mxt_err(mxt->ctx, "Could not create uinput device, error %s (%d)",
+            strerror(errno), errno);
+    close(fd);
+    return MXT_ERROR_IO;
+  }
+
+  ui->fd = fd;
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Decode a set of messages and write the resulting frame in one go
+/// \return #mxt_rc
+static int uinput_handle_msgs(struct mxt_device *mxt, struct uinput_ctx *ui,
+                              uint16_t object_type, const uint8_t *records,
+                              int record_size, const struct mxt_msg *msgs,
+                              int count)
+{
+  struct mxt_decoded_msg dec;
+  const uint8_t *msg;
+  uint8_t size;
+  ssize_t len;
+  int i;
+
+  ui->num_events = 0;
+
+  for (i = 0; i < count; i++) {
+    if (records) {
+      msg = records + i * record_size;
+      size = record_size;
+    } else {
+      msg = msgs[i].data;
+      size = msgs[i].size;
+    }
+
+    if (mxt_decode_msg(mxt, msg, size, &dec) == MXT_SUCCESS
+        && dec.kind == MXT_MSG_TOUCH && dec.object_type == object_type
+        && dec.instance == 0)
+      uinput_add_touch(ui, &dec.touch);
+  }
+
+  uinput_add_sync(ui);
+
+  if (ui->num_events == 0)
+    return MXT_SUCCESS;
+
+  len = ui->num_events * sizeof(struct input_event);
+  if (write(ui->fd, ui->events, len) != len) {
+    mxt_err(mxt->ctx, "uinput write failed, error %s (%d)",
+            strerror(errno), errno);
+    return MXT_ERROR_IO;
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief  Feed touches from the device to the uinput device until Ctrl-C
+/// \return #mxt_rc
+int uinput_run(struct mxt_device *mxt, struct uinput_ctx *ui,
+               uint16_t object_type)
+{
+  struct mxt_msg msgs[MXT_MSG_BATCH_SIZE];
+  struct sigaction sa;
+  uint8_t *records;
+  int record_size;
+  int count;
+  int ret = MXT_SUCCESS;
+
+  mxt_init_sigint_handler(mxt, &sa);
+  mxt_session_begin(mxt);
+
+  while (!mxt_sigint_rx) {
+    ret = mxt_msg_wait(mxt, UINPUT_WAIT_MS);
+    if (ret == MXT_ERROR_TIMEOUT || ret == MXT_ERROR_INTERRUPTED) {
+      continue;
+    } else if (ret) {
+      break;
+    }
+
+    ret = mxt_get_msgs_view(mxt, &records, &record_size, &count);
+    if (ret == MXT_ERROR_NOT_SUPPORTED) {
+      records = NULL;
+      record_size = 0;
+      ret = mxt_get_msgs_batch(mxt, msgs, MXT_MSG_BATCH_SIZE, &count);
+    }
+    if (ret)
+      break;
+
+    ret = uinput_handle_msgs(mxt, ui, object_type, records, record_size,
+                             msgs, count);
+    if (ret)
+      break;
+  }
+
+  /* Ctrl-C is the normal way to stop. Checked before the handler is
+   * released, which clears the flag */
+  if (mxt_sigint_rx &&
+      (ret == MXT_ERROR_TIMEOUT || ret == MXT_ERROR_INTERRUPTED))
+    ret = MXT_SUCCESS;
+
+  mxt_session_end(mxt);
+  mxt_release_sigint_handler(mxt, &sa);
+
+  return ret;
+}
+
+//******************************************************************************
+/// \brief  Inject touches from the device into a uinput multitouch device
+///         until Ctrl-C
+/// \return #mxt_rc
+int mxt_uinput(struct mxt_device *mxt)
+{
+  struct uinput_ctx ui;
+  uint16_t object_type;
+  uint16_t x_max, y_max;
+  uint8_t x_shift, y_shift;
+  int num_slots;
+  int ret;
+
+  ret = uinput_read_touch_config(mxt, &object_type, &num_slots, &x_max, &y_max,
+                                 &x_shift, &y_shift);
+  if (ret)
+    return ret;
+
+  ret = uinput_ctx_init(&ui, num_slots, x_max, y_max, x_shift, y_shift,
+                        MXT_MSG_BATCH_SIZE);
+  if (ret)
+    return ret;
+
+  ret = uinput_create(mxt, &ui);
+  if (ret)
+    goto free;
+
+  mxt_info(mxt->ctx, "Injecting T%u touches, %d slots, range %ux%u",
+           object_type, ui.num_slots, x_max, y_max);
+  mxt_info(mxt->ctx, "Press Ctrl-C to stop");
+
+  mxt_msg_reset(mxt);
+
+  ret = uinput_run(mxt, &ui, object_type);
+
+  ioctl(ui.fd, UI_DEV_DESTROY);
+  close(ui.fd);
+
+free:
+  uinput_ctx_free(&ui);
+  return ret;
+}
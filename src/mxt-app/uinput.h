@@ -0,0 +1,76 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file   uinput.h
+/// \brief  Touch event injection through uinput
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <linux/input.h>
+
+/* Contacts tracked, further touch IDs are ignored */
+#define UINPUT_MAX_SLOTS       32
+
+/* Events for one touch: slot, tracking ID, X, Y */
+#define UINPUT_EVENTS_PER_TOUCH  4
+
+/* Events added on each sync: BTN_TOUCH, ABS_X, ABS_Y, SYN_REPORT */
+#define UINPUT_EVENTS_PER_SYNC   4
+
+#define UINPUT_DEVICE_NAME     "Atmel maXTouch mxt-app"
+
+struct mxt_device;
+struct mxt_touch;
+
+//******************************************************************************
+/// \brief Multitouch state and pending events for the uinput device
+struct uinput_ctx {
+  int fd;
+  int num_slots;
+  uint16_t x_max;
+  uint16_t y_max;
+  /* T9 reports 12 bit positions, scaled down for each axis with a 10 bit
+   * range */
+  uint8_t x_shift;
+  uint8_t y_shift;
+  int tracking_id[UINPUT_MAX_SLOTS];
+  uint16_t x[UINPUT_MAX_SLOTS];
+  uint16_t y[UINPUT_MAX_SLOTS];
+  int next_tracking_id;
+  int current_slot;
+  bool touching;
+  bool changed;
+  struct input_event *events;
+  int num_events;
+  int max_events;
+};
+
+int uinput_ctx_init(struct uinput_ctx *ui, int num_slots, uint16_t x_max, uint16_t y_max, uint8_t x_shift, uint8_t y_shift, int max_touches);
+void uinput_ctx_free(struct uinput_ctx *ui);
+void uinput_add_touch(struct uinput_ctx *ui, const struct mxt_touch *touch);
+void uinput_add_sync(struct uinput_ctx *ui);
+int uinput_run(struct mxt_device *mxt, struct uinput_ctx *ui, uint16_t object_type);
+int mxt_uinput(struct mxt_device *mxt);
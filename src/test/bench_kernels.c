@@ -0,0 +1,654 @@
+//------------------------------------------------------------------------------
+/// \file   bench_kernels.c
+/// \brief  Offline microbenchmarks for the hot data paths
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <float.h>
+#include <time.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/log.h"
+#include "libmaxtouch/crc.h"
+#include "libmaxtouch/utilfuncs.h"
+
+#include "mxt-app/mxt_app.h"
+#include "mxt-app/sensor_variant.h"
+#include "mxt-app/broken_line.h"
+
+/* Each result is the fastest of several rounds, which is far more stable
+ * between runs than the mean */
+#define BENCH_ROUNDS    5
+#define BENCH_ROUND_NS  40000000ULL
+/* Calls per clock read are doubled until a batch takes this long */
+#define BENCH_BATCH_NS  1000000ULL
+
+#define T37_PAGE_SIZE   128
+
+//******************************************************************************
+/// \brief Synthetic inputs for one matrix size
+struct bench_fixture {
+  const char *size;
+  int x_size;
+  int y_size;
+
+  struct libmaxtouch_ctx lc;
+  struct mxt_device mxt;
+  struct mxt_touchscreen_info ts;
+  struct t37_ctx ctx;
+  struct sensor_variant_options sv_opts;
+  struct sensor_variant_workspace ws;
+  struct broken_line_options bl_opts;
+
+  /* Reference frame, and the T37 pages and interleaved frame it came from */
+  uint16_t *frame;
+  uint16_t *interleaved;
+  uint8_t *pages;
+  int num_pages;
+  /* Hawkeye output is formatted into memory */
+  char *text;
+  size_t text_size;
+
+  /* Generic byte buffer, its hex encoding and a polyfit line */
+  uint8_t *bytes;
+  size_t bytes_len;
+  char *hex;
+  double *xdata;
+  double *ydata;
+  int line_len;
+};
+
+//******************************************************************************
+/// \brief Benchmark descriptor
+struct kernel_bench {
+  const char *name;
+  uint32_t (*fn)(struct bench_fixture *f);
+  /* Bytes of input handled per call, for throughput */
+  size_t (*bytes)(struct bench_fixture *f);
+  /* Reference implementation which must give the same result */
+  uint32_t (*ref)(struct bench_fixture *f);
+};
+
+//******************************************************************************
+/// \brief Deterministic generator, so inputs do not depend on the libc rand()
+static uint32_t lcg_next(uint32_t *state)
+{
+  *state = *state * 1664525u + 1013904223u;
+  return *state >> 8;
+}
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+//******************************************************************************
+/// \brief Bitwise CRC24 word step, as previously used by info_block.c
+static uint32_t bitwise_crc24_word(uint32_t crc, uint8_t firstbyte,
+                                   uint8_t secondbyte)
+{
+  static const uint32_t CRCPOLY = 0x0080001B;
+  uint32_t result;
+  uint16_t data_word;
+
+  data_word = (uint16_t) ((uint16_t)(secondbyte << 8u) | firstbyte);
+  result = ((crc << 1u) ^ (uint32_t)data_word);
+
+  if (result & 0x1000000)
+    result ^= CRCPOLY;
+
+  return result;
+}
+
+static uint32_t bitwise_crc24(struct bench_fixture *f)
+{
+  uint32_t crc = 0;
+  size_t i;
+
+  for (i = 0; i + 1 < f->bytes_len; i += 2)
+    crc = bitwise_crc24_word(crc, f->bytes[i], f->bytes[i + 1]);
+
+  if (f->bytes_len % 2)
+    crc = bitwise_crc24_word(crc, f->bytes[f->bytes_len - 1], 0);
+
+  return crc & 0x00FFFFFF;
+}
+
+//******************************************************************************
+/// \brief Bitwise CRC8, as previously used by libmaxtouch.c
+static uint32_t bitwise_crc8(struct bench_fixture *f)
+{
+  static const uint8_t crcpoly = 0x8C;
+  uint8_t crc = 0;
+  uint8_t data, fb;
+  size_t i;
+  int bit;
+
+  for (i = 0; i < f->bytes_len; i++) {
+    data = f->bytes[i];
+
+    for (bit = 0; bit < 8; bit++) {
+      fb = (crc ^ data) & 0x01;
+      data >>= 1;
+      crc >>= 1;
+      if (fb)
+        crc ^= crcpoly;
+    }
+  }
+
+  return crc;
+}
+
+static uint32_t run_crc24(struct bench_fixture *f)
+{
+  return mxt_crc24(f->bytes, f->bytes_len);
+}
+
+static uint32_t run_crc8(struct bench_fixture *f)
+{
+  return mxt_crc8(0, f->bytes, f->bytes_len);
+}
+
+static uint32_t run_convert_hex(struct bench_fixture *f)
+{
+  uint16_t count = 0;
+
+  if (mxt_convert_hex(f->hex, f->bytes, &count, f->bytes_len * 2))
+    return 0;
+
+  return mxt_crc24(f->bytes, count);
+}
+
+static uint32_t run_polyfit(struct bench_fixture *f)
+{
+  double coeff[POLY_DEGREE + 1];
+
+  if (!ft_polyfit(&f->lc, f->xdata, f->ydata, coeff, f->line_len))
+    return 0;
+
+  return (uint32_t)(coeff[0] * 1000.0) ^ (uint32_t)(coeff[1] * 1000.0);
+}
+
+static uint32_t run_sensor_variant(struct bench_fixture *f)
+{
+  return sensor_variant_algorithm(&f->ctx, &f->ts, &f->sv_opts);
+}
+
+static uint32_t run_sensor_variant_ws(struct bench_fixture *f)
+{
+  return sensor_variant_run(&f->ws, &f->ctx, &f->sv_opts);
+}
+
+static uint32_t run_broken_line(struct bench_fixture *f)
+{
+  return broken_line_calc(&f->ctx, &f->ts, &f->bl_opts);
+}
+
+static uint32_t frame_check(struct bench_fixture *f)
+{
+  return mxt_crc24((uint8_t *)f->ctx.data_buf,
+                   f->ctx.data_values * sizeof(uint16_t));
+}
+
+//******************************************************************************
+/// \brief Check of the reference frame, which insert and sort must rebuild
+static uint32_t reference_frame(struct bench_fixture *f)
+{
+  return mxt_crc24((uint8_t *)f->frame, f->ctx.data_values * sizeof(uint16_t));
+}
+
+//******************************************************************************
+/// \brief Insert every T37 page of one frame, as mxt_read_diagnostic_data_frame
+static uint32_t run_t37_insert(struct bench_fixture *f)
+{
+  struct t37_ctx *ctx = &f->ctx;
+
+  ctx->y_ptr = 0;
+
+  for (ctx->page = 0; ctx->page < f->num_pages; ctx->page++) {
+    ctx->t37_buf = (struct t37_diagnostic_data *)
+                   (f->pages + ctx->page * (T37_PAGE_SIZE + 2));
+    mxt_debug_insert_data(ctx);
+  }
+
+  return frame_check(f);
+}
+
+//******************************************************************************
+/// \brief Sort one interleaved frame, restoring the input first since the sort
+/// works in place. The copy is included in the time.
+static uint32_t run_t37_sort(struct bench_fixture *f)
+{
+  memcpy(f->ctx.data_buf, f->interleaved,
+         f->ctx.data_values * sizeof(uint16_t));
+
+  sort_debug_data(&f->mxt, &f->ctx);
+
+  return frame_check(f);
+}
+
+static uint32_t hawkeye_output(struct bench_fixture *f, bool fformat)
+{
+  long len;
+
+  memcpy(f->ctx.data_buf, f->frame, f->ctx.data_values * sizeof(uint16_t));
+  f->ctx.fformat = fformat;
+
+  rewind(f->ctx.hawkeye);
+  if (mxt_hawkeye_output(&f->ctx))
+    return 0;
+
+  len = ftell(f->ctx.hawkeye);
+  if (len <= 0)
+    return 0;
+
+  return mxt_crc24((uint8_t *)f->text, (size_t)len);
+}
+
+static uint32_t run_hawkeye(struct bench_fixture *f)
+{
+  return hawkeye_output(f, false);
+}
+
+static uint32_t run_hawkeye_fformat(struct bench_fixture *f)
+{
+  return hawkeye_output(f, true);
+}
+
+static size_t bytes_buffer(struct bench_fixture *f)
+{
+  return f->bytes_len;
+}
+
+static size_t bytes_hex(struct bench_fixture *f)
+{
+  return f->bytes_len * 2;
+}
+
+static size_t bytes_line(struct bench_fixture *f)
+{
+  return f->line_len * 2 * sizeof(double);
+}
+
+static size_t bytes_frame(struct bench_fixture *f)
+{
+  return f->ctx.data_values * sizeof(uint16_t);
+}
+
+static const struct kernel_bench buffer_benches[] = {
+  { "crc24",       run_crc24,       bytes_buffer, bitwise_crc24 },
+  { "crc24_bitwise", bitwise_crc24, bytes_buffer, NULL },
+  { "crc8",        run_crc8,        bytes_buffer, bitwise_crc8 },
+  { "crc8_bitwise", bitwise_crc8,   bytes_buffer, NULL },
+  { "convert_hex", run_convert_hex, bytes_hex,    NULL },
+};
+
+static const struct kernel_bench line_benches[] = {
+  { "ft_polyfit",  run_polyfit,     bytes_line,   NULL },
+};
+
+static const struct kernel_bench frame_benches[] = {
+  { "t37_insert",  run_t37_insert,  bytes_frame,  reference_frame },
+  { "t37_sort",    run_t37_sort,    bytes_frame,  reference_frame },
+  { "hawkeye",     run_hawkeye,     bytes_frame,  NULL },
+  { "hawkeye_fformat", run_hawkeye_fformat, bytes_frame, NULL },
+  { "sensor_variant", run_sensor_variant, bytes_frame, NULL },
+  { "sensor_variant_ws", run_sensor_variant_ws, bytes_frame, NULL },
+  { "broken_line", run_broken_line, bytes_frame,  NULL },
+};
+
+//******************************************************************************
+/// \brief Time a kernel
+/// \return Nanoseconds per call of the fastest round
+static double bench(const struct kernel_bench *kb, struct bench_fixture *f,
+                    uint32_t *check)
+{
+  volatile uint32_t sink = 0;
+  uint64_t batch = 1;
+  uint64_t iterations, start, elapsed;
+  double best = DBL_MAX;
+  uint64_t i;
+  int round;
+
+  /* Batch calls so the clock read does not dominate small kernels */
+  do {
+    start = now_ns();
+    for (i = 0; i < batch; i++)
+      sink ^= kb->fn(f);
+    elapsed = now_ns() - start;
+    batch *= 2;
+  } while (elapsed < BENCH_BATCH_NS);
+
+  for (round = 0; round < BENCH_ROUNDS; round++) {
+    iterations = 0;
+    start = now_ns();
+    do {
+      for (i = 0; i < batch; i++)
+        sink ^= kb->fn(f);
+
+      iterations += batch;
+      elapsed = now_ns() - start;
+    } while (elapsed < BENCH_ROUND_NS);
+
+    if ((double)elapsed / (double)iterations < best)
+      best = (double)elapsed / (double)iterations;
+  }
+
+  *check = kb->fn(f);
+  (void)sink;
+
+  return best;
+}
+
+//******************************************************************************
+/// \brief Run a table of benchmarks against a fixture
+/// \return false if a result differs from its reference implementation
+static bool run_benches(const struct kernel_bench *table, size_t count,
+                        struct bench_fixture *f, const char *filter)
+{
+  bool ok = true;
+  uint32_t check, ref_check;
+  double ns;
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    const struct kernel_bench *kb = &table[i];
+    bool match = true;
+
+    if (filter && !strstr(kb->name, filter))
+      continue;
+
+    ns = bench(kb, f, &check);
+
+    if (kb->ref) {
+      ref_check = kb->ref(f);
+      match = (ref_check == check);
+      ok &= match;
+    }
+
+    printf("%-18s %-8s %12.1f ns %9.1f MB/s  check %08x%s\n",
+           kb->name, f->size, ns, kb->bytes(f) * 1000.0 / ns, check,
+           match ? "" : "  MISMATCH");
+  }
+
+  return ok;
+}
+
+static void fixture_init_ctx(struct bench_fixture *f)
+{
+  memset(&f->lc, 0, sizeof(f->lc));
+  f->lc.log_level = LOG_SILENT;
+  f->lc.log_fn = mxt_log_stdout;
+
+  memset(&f->mxt, 0, sizeof(f->mxt));
+  f->mxt.ctx = &f->lc;
+}
+
+//******************************************************************************
+/// \brief Fill the byte buffer and its hex encoding
+/// \return #mxt_rc
+static int fixture_init_buffer(struct bench_fixture *f, const char *size,
+                               size_t len)
+{
+  uint32_t seed = 24;
+  size_t i;
+
+  fixture_init_ctx(f);
+  f->size = size;
+  f->bytes_len = len;
+
+  f->bytes = malloc(len);
+  f->hex = malloc(len * 2 + 1);
+  if (!f->bytes || !f->hex)
+    return MXT_ERROR_NO_MEM;
+
+  for (i = 0; i < len; i++) {
+    f->bytes[i] = (uint8_t)lcg_next(&seed);
+    sprintf(f->hex + i * 2, "%02X", f->bytes[i]);
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Fill a noisy quadratic line for polyfit
+/// \return #mxt_rc
+static int fixture_init_line(struct bench_fixture *f, const char *size, int len)
+{
+  uint32_t seed = 37;
+  int i;
+
+  fixture_init_ctx(f);
+  f->size = size;
+  f->line_len = len;
+
+  f->xdata = calloc(len, sizeof(double));
+  f->ydata = calloc(len, sizeof(double));
+  if (!f->xdata || !f->ydata)
+    return MXT_ERROR_NO_MEM;
+
+  for (i = 0; i < len; i++) {
+    f->xdata[i] = i;
+    f->ydata[i] = 8000.0 + 12.0 * i - 0.05 * i * i
+                  + (double)(lcg_next(&seed) % 41) - 20.0;
+  }
+
+  return MXT_SUCCESS;
+}
+
+//******************************************************************************
+/// \brief Build a reference frame of the given size, plus the T37 pages and
+/// interleaved layout it would be read from
+/// \return #mxt_rc
+static int fixture_init_frame(struct bench_fixture *f, const char *size,
+                              int x_size, int y_size)
+{
+  struct t37_ctx *ctx = &f->ctx;
+  uint32_t seed = (uint32_t)(x_size * 256 + y_size);
+  int values = x_size * y_size;
+  int x, y, i, half;
+  int ret;
+
+  fixture_init_ctx(f);
+  f->size = size;
+  f->x_size = x_size;
+  f->y_size = y_size;
+  f->num_pages = (values * 2 + T37_PAGE_SIZE - 1) / T37_PAGE_SIZE;
+
+  f->frame = calloc(values, sizeof(uint16_t));
+  f->interleaved = calloc(values, sizeof(uint16_t));
+  f->pages = calloc(f->num_pages, T37_PAGE_SIZE + 2);
+
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->data_buf = calloc(values, sizeof(uint16_t));
+  ctx->temp_buf = calloc(values, sizeof(uint16_t));
+
+  if (!f->frame || !f->interleaved || !f->pages
+      || !ctx->data_buf || !ctx->temp_buf)
+    return MXT_ERROR_NO_MEM;
+
+  /* Smooth references with a little noise, within sensor variant limits */
+  for (x = 0; x < x_size; x++)
+    for (y = 0; y < y_size; y++)
+      f->frame[x * y_size + y] = (uint16_t)(8000 + 10 * x - 5 * y
+                                 + (x * y) / 8 + (int)(lcg_next(&seed) % 21) - 10);
+
+  /* Interleaved rows: the inverse of sort_debug_data */
+  half = y_size / 2;
+  for (x = 0; x < x_size; x++) {
+    for (y = 0; y < y_size; y++) {
+      int dst = (y % 2) ? half + y / 2 : y / 2;
+
+      /* An odd last value stays in place */
+      if (y_size % 2 && y == y_size - 1)
+        dst = y;
+
+      f->interleaved[x * y_size + dst] = f->frame[x * y_size + y];
+    }
+  }
+
+  for (i = 0; i < values; i++) {
+    uint8_t *page = f->pages + (i * 2 / T37_PAGE_SIZE) * (T37_PAGE_SIZE + 2);
+    int ofs = 2 + (i * 2) % T37_PAGE_SIZE;
+
+    page[ofs] = f->frame[i] & 0xff;
+    page[ofs + 1] = f->frame[i] >> 8;
+  }
+
+  ctx->mxt = &f->mxt;
+  ctx->lc = &f->lc;
+  ctx->mode = REFS_MODE;
+  ctx->x_size = x_size;
+  ctx->y_size = y_size;
+  ctx->data_values = values;
+  ctx->passes = 1;
+  ctx->pages_per_pass = f->num_pages;
+  ctx->page_size = T37_PAGE_SIZE;
+  ctx->t37_size = T37_PAGE_SIZE + 2;
+  ctx->frame_time_ns = 1000000000000ULL;
+  ctx->ts_info = &f->ts;
+
+  memcpy(ctx->data_buf, f->frame, values * sizeof(uint16_t));
+
+  /* Up to six characters per value, plus the format 1 row and column labels */
+  f->text_size = values * 8 + (x_size + y_size) * 16 + 256;
+  f->text = malloc(f->text_size);
+  if (!f->text)
+    return MXT_ERROR_NO_MEM;
+
+  ctx->hawkeye = fmemopen(f->text, f->text_size, "w");
+  if (!ctx->hawkeye)
+    return MXT_ERROR_IO;
+
+  f->ts.xorigin = 0;
+  f->ts.yorigin = 0;
+  f->ts.xsize = x_size;
+  f->ts.ysize = y_size;
+
+  f->sv_opts.dualx = false;
+  f->sv_opts.max_defects = 0;
+  f->sv_opts.matrix_size = 0;
+  f->sv_opts.upper_limit = UPPER_LIMIT;
+  f->sv_opts.lower_limit = LOWER_LIMIT;
+
+  f->bl_opts.dualx = false;
+  f->bl_opts.x_center_threshold = BROKEN_LINE_DEFAULT_THRESHOLD;
+  f->bl_opts.x_border_threshold = BROKEN_LINE_DEFAULT_THRESHOLD;
+  f->bl_opts.y_center_threshold = BROKEN_LINE_DEFAULT_THRESHOLD;
+  f->bl_opts.y_border_threshold = BROKEN_LINE_DEFAULT_THRESHOLD;
+  f->bl_opts.pattern = BROKEN_LINE_PATTERN_ITO;
+
+  ret = sensor_variant_workspace_init(&f->lc, &f->ws, x_size, y_size);
+  if (ret)
+    return ret;
+
+  return MXT_SUCCESS;
+}
+
+static void fixture_free(struct bench_fixture *f)
+{
+  if (f->ctx.hawkeye)
+    fclose(f->ctx.hawkeye);
+
+  if (f->ws.pinv_x)
+    sensor_variant_workspace_free(&f->ws);
+
+  free(f->ctx.data_buf);
+  free(f->ctx.temp_buf);
+  free(f->frame);
+  free(f->interleaved);
+  free(f->pages);
+  free(f->text);
+  free(f->bytes);
+  free(f->hex);
+  free(f->xdata);
+  free(f->ydata);
+}
+
+//******************************************************************************
+/// \brief Run all benchmarks, or those whose name contains argv[1]
+int main(int argc, char *argv[])
+{
+  /* Info block of a typical device, a CRC mode I2C write, a T37 page,
+   * a config and the largest object table span */
+  static const struct { const char *name; size_t len; } buffers[] = {
+    { "4", 4 }, { "15", 15 }, { "151", 151 }, { "4096", 4096 },
+    { "65535", 65535 },
+  };
+  static const struct { const char *name; int len; } lines[] = {
+    { "14", 14 }, { "41", 41 }, { "128", 128 },
+  };
+  static const struct { const char *name; int x; int y; } frames[] = {
+    { "24x14", 24, 14 }, { "41x26", 41, 26 }, { "64x128", 64, 128 },
+  };
+  const char *filter = (argc > 1) ? argv[1] : NULL;
+  struct bench_fixture f;
+  bool ok = true;
+  size_t i;
+
+  /* Hawkeye timestamps are local time */
+  setenv("TZ", "UTC", 1);
+  tzset();
+
+  printf("%-18s %-8s %15s %14s  %s\n", "kernel", "size", "time/call",
+         "throughput", "result");
+
+  for (i = 0; ok && i < sizeof(buffers)/sizeof(buffers[0]); i++) {
+    memset(&f, 0, sizeof(f));
+    ok = !fixture_init_buffer(&f, buffers[i].name, buffers[i].len)
+         && run_benches(buffer_benches,
+                        sizeof(buffer_benches)/sizeof(buffer_benches[0]),
+                        &f, filter);
+    fixture_free(&f);
+  }
+
+  for (i = 0; ok && i < sizeof(lines)/sizeof(lines[0]); i++) {
+    memset(&f, 0, sizeof(f));
+    ok = !fixture_init_line(&f, lines[i].name, lines[i].len)
+         && run_benches(line_benches,
+                        sizeof(line_benches)/sizeof(line_benches[0]),
+                        &f, filter);
+    fixture_free(&f);
+  }
+
+  for (i = 0; ok && i < sizeof(frames)/sizeof(frames[0]); i++) {
+    memset(&f, 0, sizeof(f));
+    ok = !fixture_init_frame(&f, frames[i].name, frames[i].x, frames[i].y)
+         && run_benches(frame_benches,
+                        sizeof(frame_benches)/sizeof(frame_benches[0]),
+                        &f, filter);
+    fixture_free(&f);
+  }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
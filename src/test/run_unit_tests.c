@@ -54,6 +54,40 @@ int main(int argc, char *argv[])
     unit_test(calculate_poly_test),
     unit_test(check_line_test),
     unit_test(sensor_variant_algorithm_test),
+    unit_test(polyfit_pinv_test),
+    unit_test(sensor_variant_workspace_test),
+    unit_test(frame_kernels_unpack_test),
+    unit_test(frame_kernels_interleave_test),
+    unit_test(frame_kernels_stats_test),
+    unit_test(crc24_test),
+    unit_test(crc24_stream_test),
+    unit_test(crc24_zeros_test),
+    unit_test(crc8_test),
+    unit_test(config_image_xcfg_test),
+    unit_test(config_image_raw_test),
+    unit_test(config_image_compare_test),
+    unit_test(screening_combine_test),
+    unit_test(monitor_update_test),
+    unit_test(bench_summarise_test),
+    unit_test(mock_register_test),
+    unit_test(mock_replay_test),
+    unit_test(mock_msg_timestamp_test),
+    unit_test(mock_session_test),
+    unit_test(mock_command_wait_test),
+    unit_test(mock_info_read_test),
+    unit_test(io_stats_test),
+    unit_test(scan_cache_test),
+    unit_test(buffer_append_test),
+    unit_test(buffer_fixed_test),
+    unit_test(self_test_queue_test),
+    unit_test(parallel_run_test),
+    unit_test(msg_decode_test),
+    unit_test(uinput_events_test),
+    unit_test(uinput_sigint_test),
+    unit_test(dd_roi_test),
+    unit_test(dd_selection_test),
+    unit_test(capture_codec_test),
+    unit_test(live_render_test),
   };
 
   return cmocka_run_group_tests(tests, NULL, NULL);
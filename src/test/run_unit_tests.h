@@ -36,6 +36,10 @@ int init_mxt_device_struct(struct mxt_device **mxt);
 int init_t37_ctx_struct(struct mxt_device *mxt, struct t37_ctx **f_p);
 int init_mxt_touchscreen_info_struct(struct mxt_device *mxt,
     struct mxt_touchscreen_info **mxt_ts_p);
+char *test_write_temp_file(const void *data, size_t len);
+char *test_write_mock_info(void);
+struct mxt_device *test_open_mock(struct libmaxtouch_ctx *ctx,
+                                  char *info_file, char *msg_file);
 
 /* test functions */
 void mxt_convert_hex_test(void **state);
@@ -45,3 +49,37 @@ void sensor_variant_algorithm_test(void **state);
 void calculate_poly_test(void **state);
 void check_line_test(void **state);
 void polyfit_test(void **state);
+void polyfit_pinv_test(void **state);
+void sensor_variant_workspace_test(void **state);
+void frame_kernels_unpack_test(void **state);
+void frame_kernels_interleave_test(void **state);
+void frame_kernels_stats_test(void **state);
+void crc24_test(void **state);
+void crc24_stream_test(void **state);
+void crc24_zeros_test(void **state);
+void crc8_test(void **state);
+void config_image_xcfg_test(void **state);
+void config_image_raw_test(void **state);
+void config_image_compare_test(void **state);
+void screening_combine_test(void **state);
+void monitor_update_test(void **state);
+void bench_summarise_test(void **state);
+void mock_register_test(void **state);
+void mock_replay_test(void **state);
+void mock_msg_timestamp_test(void **state);
+void mock_session_test(void **state);
+void mock_command_wait_test(void **state);
+void mock_info_read_test(void **state);
+void io_stats_test(void **state);
+void scan_cache_test(void **state);
+void buffer_append_test(void **state);
+void buffer_fixed_test(void **state);
+void self_test_queue_test(void **state);
+void parallel_run_test(void **state);
+void msg_decode_test(void **state);
+void uinput_events_test(void **state);
+void uinput_sigint_test(void **state);
+void dd_roi_test(void **state);
+void dd_selection_test(void **state);
+void capture_codec_test(void **state);
+void live_render_test(void **state);
@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------
+/// \file   test_bench.c
+/// \brief  Tests against mxt-app/bench.h
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+
+#include "mxt-app/bench.h"
+#include "run_unit_tests.h"
+
+void bench_summarise_test(void **state)
+{
+  struct bench_result r = {0};
+  double samples[100];
+  int i;
+
+  /* 1..100 us in reverse order */
+  for (i = 0; i < 100; i++)
+    samples[i] = 100 - i;
+
+  r.size = 64;
+  bench_summarise(samples, 100, &r);
+
+  assert_int_equal(r.count, 100);
+  assert_float_equal(r.mean_us, 50.5);
+  assert_float_equal(r.p50_us, 50);
+  assert_float_equal(r.p90_us, 90);
+  assert_float_equal(r.p99_us, 99);
+  assert_float_equal(r.max_us, 100);
+  assert_float_equal(r.rate, 64 * 1e6 / 50.5);
+
+  /* Nearest rank with few samples */
+  samples[0] = 30;
+  samples[1] = 10;
+  samples[2] = 20;
+  bench_summarise(samples, 3, &r);
+  assert_float_equal(r.p50_us, 20);
+  assert_float_equal(r.p99_us, 30);
+
+  bench_summarise(samples, 0, &r);
+  assert_int_equal(r.count, 0);
+  assert_float_equal(r.rate, 0);
+}
@@ -0,0 +1,111 @@
+//------------------------------------------------------------------------------
+/// \file   test_buffer.c
+/// \brief  Unit tests for buffer functions
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "mxt-app/buffer.h"
+#include "run_unit_tests.h"
+
+void buffer_append_test(void **state)
+{
+  struct mxt_buffer buf;
+  uint8_t data[100];
+  size_t i;
+
+  for (i = 0; i < sizeof(data); i++)
+    data[i] = i;
+
+  assert_int_equal(mxt_buf_init(&buf), MXT_SUCCESS);
+
+  assert_int_equal(mxt_buf_add(&buf, 0xAA), MXT_SUCCESS);
+  assert_int_equal(mxt_buf_append(&buf, data, sizeof(data)), MXT_SUCCESS);
+  assert_int_equal(buf.size, sizeof(data) + 1);
+  assert_true(buf.capacity >= buf.size);
+  assert_int_equal(buf.data[0], 0xAA);
+  assert_memory_equal(buf.data + 1, data, sizeof(data));
+
+  /* Reserve does not change contents */
+  assert_int_equal(mxt_buf_reserve(&buf, 1000), MXT_SUCCESS);
+  assert_true(buf.capacity >= buf.size + 1000);
+  assert_memory_equal(buf.data + 1, data, sizeof(data));
+
+  mxt_buf_consume(&buf, 11);
+  assert_int_equal(buf.size, sizeof(data) - 10);
+  assert_int_equal(buf.data[0], 10);
+
+  mxt_buf_free(&buf);
+}
+
+void buffer_fixed_test(void **state)
+{
+  struct mxt_buffer buf;
+  uint8_t storage[8];
+  const uint8_t data[] = "abcdefghij";
+  size_t count;
+  int fds[2];
+
+  mxt_buf_init_fixed(&buf, storage, sizeof(storage));
+
+  assert_int_equal(mxt_buf_append(&buf, data, 6), MXT_SUCCESS);
+  assert_true(buf.data == storage);
+
+  /* Fixed buffers never grow */
+  assert_int_equal(mxt_buf_append(&buf, data, 6), MXT_ERROR_NO_MEM);
+  assert_int_equal(buf.size, 6);
+
+  /* Reads are limited to the remaining space */
+  assert_int_equal(pipe(fds), 0);
+  assert_int_equal(write(fds[1], data, 10), 10);
+  assert_int_equal(mxt_buf_read_fd(&buf, fds[0], 10, &count), MXT_SUCCESS);
+  assert_int_equal(count, 2);
+  assert_memory_equal(storage + 6, "ab", 2);
+
+  mxt_buf_consume(&buf, 8);
+  assert_int_equal(mxt_buf_read_fd(&buf, fds[0], 10, &count), MXT_SUCCESS);
+  assert_int_equal(count, 8);
+  assert_memory_equal(storage, "cdefghij", 8);
+
+  /* End of file */
+  close(fds[1]);
+  mxt_buf_consume(&buf, 8);
+  assert_int_equal(mxt_buf_read_fd(&buf, fds[0], 10, &count), MXT_SUCCESS);
+  assert_int_equal(count, 0);
+  close(fds[0]);
+
+  mxt_buf_free(&buf);
+  assert_true(buf.data == storage);
+}
@@ -0,0 +1,176 @@
+//------------------------------------------------------------------------------
+/// \file   test_capture.c
+/// \brief  Delta coded capture tests
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/capture.h"
+#include "run_unit_tests.h"
+
+#define CAPTURE_COUNT     48
+#define CAPTURE_FRAMES    10
+#define CAPTURE_INTERVAL  4
+
+static void capture_fill_frame(uint16_t *values, unsigned int frame)
+{
+  int i;
+
+  for (i = 0; i < CAPTURE_COUNT; i++) {
+    /* Mostly static with a moving touch and a wrap around node */
+    values[i] = 0x4000 + i;
+    if (i == (int)(frame % CAPTURE_COUNT))
+      values[i] += 300 * frame;
+  }
+
+  values[CAPTURE_COUNT - 1] = (frame & 1) ? 0xFFFF : 0;
+}
+
+void capture_codec_test(void **state)
+{
+  uint16_t values[CAPTURE_COUNT];
+  uint16_t prev[CAPTURE_COUNT];
+  uint16_t out[CAPTURE_COUNT];
+  uint8_t coded[MXT_CAPTURE_CODED_MAX(CAPTURE_COUNT)];
+  uint8_t *buf;
+  struct mxt_capture_delta_record rec;
+  struct mxt_capture_index_entry index[CAPTURE_FRAMES];
+  struct mxt_capture_trailer trailer;
+  size_t size, ofs, len = 0;
+  unsigned int frame, n = 0;
+
+  /* Keyframe */
+  capture_fill_frame(values, 1);
+  size = mxt_capture_encode(values, NULL, CAPTURE_COUNT, coded);
+  assert_true(size > 0 && size <= sizeof(coded));
+  assert_int_equal(mxt_capture_decode(coded, size, true, out, CAPTURE_COUNT),
+                   MXT_SUCCESS);
+  assert_memory_equal(out, values, sizeof(values));
+
+  /* Identical frame codes as a single zero run */
+  size = mxt_capture_encode(values, values, CAPTURE_COUNT, coded);
+  assert_int_equal(size, 1);
+  assert_int_equal(mxt_capture_decode(coded, size, false, out, CAPTURE_COUNT),
+                   MXT_SUCCESS);
+  assert_memory_equal(out, values, sizeof(values));
+
+  /* Delta frame with 0xFFFF to 0 wrap around */
+  memcpy(prev, values, sizeof(prev));
+  capture_fill_frame(values, 2);
+  size = mxt_capture_encode(values, prev, CAPTURE_COUNT, coded);
+  assert_true(size < CAPTURE_COUNT);
+  assert_int_equal(mxt_capture_decode(coded, size, false, out, CAPTURE_COUNT),
+                   MXT_SUCCESS);
+  assert_memory_equal(out, values, sizeof(values));
+
+  /* Truncated record and wrong node count are rejected */
+  assert_int_equal(mxt_capture_decode(coded, size, false, out, CAPTURE_COUNT - 1),
+                   MXT_ERROR_FILE_FORMAT);
+  coded[0] = 0x80;
+  assert_int_equal(mxt_capture_decode(coded, 1, false, out, CAPTURE_COUNT),
+                   MXT_ERROR_FILE_FORMAT);
+
+  /* Build a capture body with a keyframe index */
+  buf = malloc(CAPTURE_FRAMES * (sizeof(rec) + sizeof(coded))
+               + sizeof(index) + sizeof(trailer));
+  assert_non_null(buf);
+
+  for (frame = 0; frame < CAPTURE_FRAMES; frame++) {
+    capture_fill_frame(values, frame);
+
+    rec.frame = frame;
+    rec.timestamp = frame * 1000;
+    rec.keyframe = (frame % CAPTURE_INTERVAL) == 0;
+    rec.size = mxt_capture_encode(values, rec.keyframe ? NULL : prev,
+                                  CAPTURE_COUNT, coded);
+
+    if (rec.keyframe) {
+      index[n].record = frame;
+      index[n].frame = frame;
+      index[n].offset = len;
+      n++;
+    }
+
+    memcpy(buf + len, &rec, sizeof(rec));
+    memcpy(buf + len + sizeof(rec), coded, rec.size);
+    len += sizeof(rec) + rec.size;
+    memcpy(prev, values, sizeof(prev));
+  }
+
+  memset(&trailer, 0, sizeof(trailer));
+  trailer.index_offset = len;
+  trailer.index_count = n;
+  trailer.record_count = CAPTURE_FRAMES;
+  trailer.keyframe_interval = CAPTURE_INTERVAL;
+  memcpy(trailer.magic, MXT_CAPTURE_INDEX_MAGIC, sizeof(trailer.magic));
+
+  memcpy(buf + len, index, n * sizeof(index[0]));
+  len += n * sizeof(index[0]);
+  memcpy(buf + len, &trailer, sizeof(trailer));
+  len += sizeof(trailer);
+
+  /* Sequential read stops at the index */
+  ofs = 0;
+  for (frame = 0; frame < CAPTURE_FRAMES; frame++) {
+    assert_int_equal(mxt_capture_next_frame(buf, len, &ofs, out, CAPTURE_COUNT,
+                                            &rec), MXT_SUCCESS);
+    assert_int_equal(rec.frame, frame);
+    capture_fill_frame(values, frame);
+    assert_memory_equal(out, values, sizeof(values));
+  }
+  assert_int_equal(mxt_capture_next_frame(buf, len, &ofs, out, CAPTURE_COUNT,
+                                          &rec), MXT_ERROR_NO_MESSAGE);
+
+  /* Seek to every record from its keyframe */
+  for (frame = 0; frame < CAPTURE_FRAMES; frame++) {
+    memset(out, 0, sizeof(out));
+    assert_int_equal(mxt_capture_seek_frame(buf, len, frame, out, CAPTURE_COUNT,
+                                            &rec), MXT_SUCCESS);
+    assert_int_equal(rec.frame, frame);
+    capture_fill_frame(values, frame);
+    assert_memory_equal(out, values, sizeof(values));
+  }
+
+  assert_int_equal(mxt_capture_seek_frame(buf, len, CAPTURE_FRAMES, out,
+                                          CAPTURE_COUNT, &rec),
+                   MXT_ERROR_BAD_INPUT);
+
+  /* No trailer */
+  assert_int_equal(mxt_capture_seek_frame(buf, trailer.index_offset, 0, out,
+                                          CAPTURE_COUNT, &rec),
+                   MXT_ERROR_FILE_FORMAT);
+
+  free(buf);
+}
@@ -0,0 +1,219 @@
+//------------------------------------------------------------------------------
+/// \file   test_config_image.c
+/// \brief  Tests against libmaxtouch/config_image.h
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/config_image.h"
+#include "run_unit_tests.h"
+
+/* T6 and T38 are not part of the CRC, the T38 bytes count as zero */
+static const char test_xcfg[] =
+  "[COMMENTS]\n"
+  "Date and time: [not a section]\n"
+  "[VERSION_INFO_HEADER]\n"
+  "FAMILY_ID=164\n"
+  "VARIANT=45\n"
+  "VERSION=32\n"
+  "BUILD=170\n"
+  "CHECKSUM=0x0048C7\n"
+  "INFO_BLOCK_CHECKSUM=0x123456\n"
+  "[APPLICATION_INFO_HEADER]\n"
+  "NAME=libmaxtouch\n"
+  "[SPT_USERDATA_T38 INSTANCE 0]\r\n"
+  "OBJECT_ADDRESS=106\r\n"
+  "OBJECT_SIZE=2\r\n"
+  "0 2 DATA=2313\r\n"
+  "[GEN_POWERCONFIG_T7 INSTANCE 0]\n"
+  "OBJECT_ADDRESS=102\n"
+  "OBJECT_SIZE=4\n"
+  "0 1 IDLEACQINT=1\n"
+  "1 1 ACTVACQINT=2\n"
+  "2 1 ACTV2IDLETO=3\n"
+  "3 1 CFG=4\n"
+  "[GEN_COMMANDPROCESSOR_T6 INSTANCE 0]\n"
+  "OBJECT_ADDRESS=96\n"
+  "OBJECT_SIZE=6\n"
+  "0 1 RESET=255\n"
+  "[GEN_ACQUISITIONCONFIG_T8 INSTANCE 0]\n"
+  "OBJECT_ADDRESS=108\n"
+  "OBJECT_SIZE=5\n"
+  "0 4 CHRGTIME=4660\n"
+  "4 1 TCHDRIFT=7\n";
+
+static const char test_raw[] =
+  "OBP_RAW V1\n"
+  "A4 2D 20 AA 18 20 03\n"
+  "123456\n"
+  "0048C7\n"
+  "0007 0000 0004 01 02 03 04\n"
+  "0026 0000 0002 09 09\n"
+  "0008 0000 0005 34 12 00 00 07\n";
+
+static struct mxt_config_image *parse_test_config(struct libmaxtouch_ctx *ctx,
+    const char *buf)
+{
+  struct mxt_config_image *image = NULL;
+
+  assert_int_equal(MXT_SUCCESS,
+                   mxt_config_image_parse(ctx, buf, strlen(buf), &image));
+  assert_non_null(image);
+
+  return image;
+}
+
+void config_image_xcfg_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_config_image *image;
+  const struct mxt_config_image_object *obj;
+  static const uint8_t t8[] = { 0x34, 0x12, 0, 0, 7 };
+  uint32_t crc;
+
+  assert_int_equal(MXT_SUCCESS, mxt_new(&ctx));
+  image = parse_test_config(ctx, test_xcfg);
+
+  assert_int_equal(MXT_CONFIG_FORMAT_XCFG, image->format);
+  assert_true(image->have_addresses);
+  assert_int_equal(164, image->id.family);
+  assert_int_equal(170, image->id.build);
+  assert_int_equal(0x48C7, image->config_crc);
+  assert_int_equal(0x123456, image->info_crc);
+  assert_int_equal(4, image->num_objects);
+
+  /* Sorted by address */
+  assert_int_equal(6, image->objects[0].type);
+  assert_int_equal(7, image->objects[1].type);
+  assert_int_equal(38, image->objects[2].type);
+  assert_int_equal(8, image->objects[3].type);
+
+  obj = mxt_config_image_find(image, 8, 0);
+  assert_non_null(obj);
+  assert_int_equal(108, obj->start_position);
+  assert_int_equal(sizeof(t8), obj->size);
+  assert_memory_equal(t8, obj->data, sizeof(t8));
+  assert_null(mxt_config_image_find(image, 8, 1));
+
+  assert_int_equal(MXT_SUCCESS, mxt_config_image_calc_crc(ctx, image, &crc));
+  assert_int_equal(0x48C7, crc);
+
+  mxt_config_image_free(image);
+  mxt_free(ctx);
+}
+
+void config_image_raw_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_config_image *image;
+  uint32_t crc;
+
+  assert_int_equal(MXT_SUCCESS, mxt_new(&ctx));
+  image = parse_test_config(ctx, test_raw);
+
+  assert_int_equal(MXT_CONFIG_FORMAT_RAW, image->format);
+  assert_false(image->have_addresses);
+  assert_int_equal(0xA4, image->id.family);
+  assert_int_equal(3, image->id.num_objects);
+  assert_int_equal(0x48C7, image->config_crc);
+  assert_int_equal(3, image->num_objects);
+  assert_int_equal(38, image->objects[1].type);
+  assert_int_equal(9, image->objects[1].data[1]);
+
+  /* No addresses without a device */
+  assert_int_equal(MXT_ERROR_NO_DEVICE,
+                   mxt_config_image_calc_crc(ctx, image, &crc));
+
+  mxt_config_image_free(image);
+  mxt_free(ctx);
+}
+
+void config_image_compare_test(void **state)
+{
+  static const char *bad_configs[] = {
+    "[GEN_POWERCONFIG_T7 INSTANCE 0\n",
+    "[GEN_POWERCONFIG INSTANCE 0]\n",
+    "[GEN_POWERCONFIG_T7 INSTANCE 0]\nOBJECT_ADDRESS=1\nOBJECT_SIZE=2\n1 2 X=1\n",
+    "[GEN_POWERCONFIG_T7 INSTANCE 0]\nOBJECT_ADDRESS=1\nOBJECT_SIZE=2\n0 3 X=1\n",
+    "[GEN_POWERCONFIG_T7 INSTANCE 0]\nOBJECT_SIZE=2\n",
+    "OBP_RAW V1\nA4 2D 20 AA 18 20 03\n123456\n0048C7\n0007 0000 0004 01 02\n",
+    "garbage\n",
+  };
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_config_image *xcfg, *raw, *image;
+  struct mxt_config_diff diff;
+  char *changed;
+  size_t i;
+
+  assert_int_equal(MXT_SUCCESS, mxt_new(&ctx));
+  xcfg = parse_test_config(ctx, test_xcfg);
+  raw = parse_test_config(ctx, test_raw);
+
+  /* T6 is volatile and ignored, the configs are otherwise the same */
+  assert_int_equal(MXT_SUCCESS, mxt_config_image_compare(ctx, xcfg, raw, &diff));
+  assert_int_equal(3, diff.objects_compared);
+  assert_int_equal(0, diff.objects_differ);
+  assert_int_equal(0, diff.objects_missing);
+  assert_int_equal(0, diff.bytes_differ);
+
+  /* Change T7 and drop the T6 and T8 sections after it */
+  changed = strdup(test_xcfg);
+  assert_non_null(changed);
+  *strstr(changed, "CFG=4") = '\0';
+  strcat(changed, "CFG=5\n");
+
+  image = parse_test_config(ctx, changed);
+  assert_int_equal(MXT_SUCCESS, mxt_config_image_compare(ctx, image, raw, &diff));
+  assert_int_equal(2, diff.objects_compared);
+  assert_int_equal(1, diff.objects_differ);
+  assert_int_equal(1, diff.objects_missing);
+  assert_int_equal(1, diff.bytes_differ);
+
+  mxt_config_image_free(image);
+  free(changed);
+
+  for (i = 0; i < sizeof(bad_configs) / sizeof(bad_configs[0]); i++) {
+    image = NULL;
+    assert_int_equal(MXT_ERROR_FILE_FORMAT,
+                     mxt_config_image_parse(ctx, bad_configs[i],
+                                            strlen(bad_configs[i]), &image));
+    assert_null(image);
+  }
+
+  mxt_config_image_free(raw);
+  mxt_config_image_free(xcfg);
+  mxt_free(ctx);
+}
@@ -0,0 +1,134 @@
+//------------------------------------------------------------------------------
+/// \file   test_crc.c
+/// \brief  Tests against libmaxtouch/crc.h
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+
+#include "libmaxtouch/crc.h"
+#include "run_unit_tests.h"
+
+#define TEST_CRC_LEN 301
+
+static const uint8_t check_string[] = "123456789";
+
+static void fill_test_crc_buf(uint8_t *buf, size_t len)
+{
+  size_t i;
+
+  for (i = 0; i < len; i++)
+    buf[i] = (uint8_t)(i * 37 + 11);
+}
+
+void crc24_test(void **state)
+{
+  uint8_t buf[TEST_CRC_LEN];
+
+  fill_test_crc_buf(buf, sizeof(buf));
+
+  /* Values from the bitwise crc24() previously in info_block.c */
+  assert_int_equal(0x022A0B, mxt_crc24(check_string, 9));
+  assert_int_equal(0xDABD06, mxt_crc24(buf, TEST_CRC_LEN - 1));
+  assert_int_equal(0x357A70, mxt_crc24(buf, TEST_CRC_LEN));
+  assert_int_equal(0, mxt_crc24(buf, 0));
+}
+
+void crc24_stream_test(void **state)
+{
+  uint8_t buf[TEST_CRC_LEN];
+  struct mxt_crc24_ctx c;
+  size_t split;
+  size_t step;
+  size_t i;
+
+  fill_test_crc_buf(buf, sizeof(buf));
+
+  /* Split points on both odd and even offsets */
+  for (split = 0; split <= TEST_CRC_LEN; split += 13) {
+    mxt_crc24_init(&c);
+    mxt_crc24_update(&c, buf, split);
+    mxt_crc24_update(&c, buf + split, TEST_CRC_LEN - split);
+    assert_int_equal(0x357A70, mxt_crc24_final(&c));
+  }
+
+  for (step = 1; step < 20; step++) {
+    mxt_crc24_init(&c);
+    for (i = 0; i < TEST_CRC_LEN; i += step)
+      mxt_crc24_update(&c, buf + i,
+                       (i + step > TEST_CRC_LEN) ? TEST_CRC_LEN - i : step);
+    assert_int_equal(0x357A70, mxt_crc24_final(&c));
+  }
+}
+
+void crc24_zeros_test(void **state)
+{
+  uint8_t buf[TEST_CRC_LEN];
+  struct mxt_crc24_ctx c;
+  size_t start;
+  size_t len;
+
+  fill_test_crc_buf(buf, sizeof(buf));
+
+  for (start = 0; start < 40; start += 3) {
+    for (len = 0; len < 70; len += 5) {
+      memset(buf + start, 0, len);
+
+      mxt_crc24_init(&c);
+      mxt_crc24_update(&c, buf, start);
+      mxt_crc24_update_zeros(&c, len);
+      mxt_crc24_update(&c, buf + start + len, TEST_CRC_LEN - start - len);
+      assert_int_equal(mxt_crc24(buf, TEST_CRC_LEN), mxt_crc24_final(&c));
+
+      fill_test_crc_buf(buf, sizeof(buf));
+    }
+  }
+}
+
+void crc8_test(void **state)
+{
+  uint8_t buf[TEST_CRC_LEN];
+  uint8_t crc = 0;
+  size_t i;
+
+  fill_test_crc_buf(buf, sizeof(buf));
+
+  assert_int_equal(0xA1, mxt_crc8(0, check_string, 9));
+  assert_int_equal(0x17, mxt_crc8(0, buf, TEST_CRC_LEN));
+
+  for (i = 0; i < TEST_CRC_LEN; i++)
+    crc = mxt_calc_crc8(crc, buf[i]);
+
+  assert_int_equal(0x17, crc);
+}
@@ -0,0 +1,196 @@
+//------------------------------------------------------------------------------
+/// \file   test_diagnostic_data.c
+/// \brief  T37 region of interest tests
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "mxt-app/mxt_app.h"
+#include "run_unit_tests.h"
+
+/* 8x6 matrix, 4 values per T37 page */
+#define ROI_X_SIZE     8
+#define ROI_Y_SIZE     6
+#define ROI_PAGE_SIZE  8
+
+void dd_roi_test(void **state)
+{
+  struct libmaxtouch_ctx *lc;
+  struct mxt_device mxt;
+  struct mxt_id_info id = { .family = 0xA4, .matrix_x_size = ROI_X_SIZE,
+                            .matrix_y_size = ROI_Y_SIZE };
+  struct t37_ctx ctx;
+  struct dd_roi roi = { .enabled = true, .x_start = 2, .x_end = 3,
+                        .y_start = 1, .y_end = 4 };
+  struct dd_roi bad = { .enabled = true, .x_start = 6, .x_end = 8,
+                        .y_start = 0, .y_end = 0 };
+  int values = ROI_PAGE_SIZE / 2;
+  int i, x, y;
+
+  assert_int_equal(mxt_new(&lc), MXT_SUCCESS);
+  memset(&mxt, 0, sizeof(mxt));
+  mxt.ctx = lc;
+  mxt.info.id = &id;
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.mxt = &mxt;
+  ctx.lc = lc;
+  ctx.mode = DELTAS_MODE;
+  ctx.x_size = ROI_X_SIZE;
+  ctx.y_size = ROI_Y_SIZE;
+  ctx.data_values = ROI_X_SIZE * ROI_Y_SIZE;
+  ctx.passes = 1;
+  ctx.page_size = ROI_PAGE_SIZE;
+  ctx.pages_per_pass = ctx.data_values / values;
+  ctx.data_buf = calloc(ctx.data_values, sizeof(uint16_t));
+  ctx.temp_buf = calloc(ctx.data_values, sizeof(uint16_t));
+  ctx.t37_buf = calloc(1, ROI_PAGE_SIZE + 2);
+  assert_non_null(ctx.data_buf);
+  assert_non_null(ctx.temp_buf);
+  assert_non_null(ctx.t37_buf);
+
+  assert_int_equal(mxt_dd_set_roi(&ctx, &bad), MXT_ERROR_BAD_INPUT);
+  assert_false(ctx.roi);
+
+  /* X2Y1 is value 13 on page 3, X3Y4 is value 22 on page 5 */
+  assert_int_equal(mxt_dd_set_roi(&ctx, &roi), MXT_SUCCESS);
+  assert_true(ctx.roi);
+  assert_int_equal(ctx.first_page, 3);
+  assert_int_equal(ctx.last_page, 5);
+  assert_int_equal(ctx.x_size, 2);
+  assert_int_equal(ctx.y_size, 4);
+  assert_int_equal(ctx.data_values, 8);
+
+  /* Each value holds its position in the full frame */
+  for (ctx.page = ctx.first_page; ctx.page <= ctx.last_page; ctx.page++) {
+    for (i = 0; i < values; i++) {
+      ctx.t37_buf->data[2 * i] = (ctx.page * values + i) & 0xFF;
+      ctx.t37_buf->data[2 * i + 1] = 0x10;
+    }
+
+    assert_int_equal(mxt_debug_insert_data_roi(&ctx), MXT_SUCCESS);
+  }
+
+  for (x = 0; x < ctx.x_size; x++) {
+    for (y = 0; y < ctx.y_size; y++) {
+      assert_int_equal(ctx.data_buf[x * ctx.y_size + y],
+                       0x1000 | ((x + 2) * ROI_Y_SIZE + y + 1));
+    }
+  }
+
+  free(ctx.data_buf);
+  free(ctx.temp_buf);
+  free(ctx.t37_buf);
+  mxt_free(lc);
+}
+
+/* Three self cap passes of 4 Y lines then 3 X lines */
+#define SEL_PASSES     3
+#define SEL_X_SIZE     3
+#define SEL_Y_SIZE     4
+
+void dd_selection_test(void **state)
+{
+  struct libmaxtouch_ctx *lc;
+  struct mxt_device mxt;
+  struct mxt_id_info id = { .family = 0xA4, .matrix_x_size = SEL_X_SIZE,
+                            .matrix_y_size = SEL_Y_SIZE };
+  struct t37_ctx ctx;
+  struct dd_roi sel = { .passes = (1 << 0) | (1 << 2), .axes = DD_AXIS_X };
+  struct dd_roi bad = { .passes = 1 << 3 };
+  struct dd_roi keys = { .passes = 1 << 1 };
+  uint8_t key_buf[SEL_PASSES] = { 2, 3, 1 };
+  char *out;
+  size_t out_size;
+  int i;
+
+  assert_int_equal(mxt_new(&lc), MXT_SUCCESS);
+  memset(&mxt, 0, sizeof(mxt));
+  mxt.ctx = lc;
+  mxt.info.id = &id;
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.mxt = &mxt;
+  ctx.lc = lc;
+  ctx.mode = SELF_CAP_REFS;
+  ctx.self_cap = true;
+  ctx.fformat = true;
+  ctx.x_size = SEL_X_SIZE;
+  ctx.y_size = SEL_Y_SIZE;
+  ctx.passes = SEL_PASSES;
+  ctx.data_values = SEL_PASSES * (SEL_X_SIZE + SEL_Y_SIZE);
+  ctx.data_buf = calloc(ctx.data_values, sizeof(uint16_t));
+  assert_non_null(ctx.data_buf);
+
+  for (i = 0; i < ctx.data_values; i++)
+    ctx.data_buf[i] = i;
+
+  assert_int_equal(mxt_dd_set_roi(&ctx, &bad), MXT_ERROR_BAD_INPUT);
+  assert_int_equal(ctx.pass_mask, 0);
+
+  /* Only the X lines of the first and last pass are written */
+  assert_int_equal(mxt_dd_set_roi(&ctx, &sel), MXT_SUCCESS);
+  assert_int_equal(ctx.pass_mask, sel.passes);
+  assert_int_equal(ctx.axes, DD_AXIS_X);
+
+  ctx.hawkeye = open_memstream(&out, &out_size);
+  assert_non_null(ctx.hawkeye);
+  assert_int_equal(mxt_hawkeye_output(&ctx), MXT_SUCCESS);
+  fclose(ctx.hawkeye);
+  assert_string_equal(out, "4,5,6,18,19,20,");
+  free(out);
+
+  /* Keys of the second instance follow the two keys of the first */
+  ctx.self_cap = false;
+  ctx.t15_keyarray = true;
+  ctx.mode = KEY_REFS_MODE;
+  ctx.key_buf = key_buf;
+  ctx.pass_mask = 0;
+  ctx.axes = 0;
+
+  assert_int_equal(mxt_dd_set_roi(&ctx, &keys), MXT_SUCCESS);
+  assert_int_equal(ctx.axes, 0);
+
+  ctx.hawkeye = open_memstream(&out, &out_size);
+  assert_non_null(ctx.hawkeye);
+  assert_int_equal(mxt_hawkeye_output(&ctx), MXT_SUCCESS);
+  fclose(ctx.hawkeye);
+  assert_string_equal(out, "2,3,4,");
+  free(out);
+
+  free(ctx.data_buf);
+  mxt_free(lc);
+}
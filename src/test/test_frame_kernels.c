@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------
+/// \file   test_frame_kernels.c
+/// \brief  Tests against mxt-app/frame_kernels.h
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+
+#include "mxt-app/frame_kernels.h"
+#include "run_unit_tests.h"
+
+/* Odd lengths exercise the vector tails */
+#define TEST_ROWS     5
+#define TEST_ROW_LEN  43
+#define TEST_VALUES   (TEST_ROWS * TEST_ROW_LEN)
+
+static void fill_test_frame(uint16_t *buf, size_t count)
+{
+  size_t i;
+
+  srand(37);
+  for (i = 0; i < count; i++)
+    buf[i] = (uint16_t)(rand() - RAND_MAX / 2);
+
+  buf[3] = (uint16_t)INT16_MIN;
+  buf[count - 1] = INT16_MAX;
+}
+
+void frame_kernels_unpack_test(void **state)
+{
+  const struct frame_kernels *k = frame_kernels_get();
+  uint8_t page[2 * TEST_VALUES];
+  uint16_t expected[TEST_VALUES];
+  uint16_t actual[TEST_VALUES];
+  size_t i;
+
+  for (i = 0; i < sizeof(page); i++)
+    page[i] = i * 7;
+
+  frame_kernels_scalar.unpack_le16(expected, page, TEST_VALUES);
+  k->unpack_le16(actual, page, TEST_VALUES);
+
+  assert_int_equal(expected[1], (21 << 8) | 14);
+  assert_memory_equal(expected, actual, sizeof(expected));
+}
+
+void frame_kernels_interleave_test(void **state)
+{
+  const struct frame_kernels *k = frame_kernels_get();
+  uint16_t src[TEST_VALUES];
+  uint16_t expected[TEST_VALUES];
+  uint16_t actual[TEST_VALUES];
+  size_t half = TEST_ROW_LEN / 2;
+
+  fill_test_frame(src, TEST_VALUES);
+
+  frame_kernels_scalar.interleave(expected, src, TEST_ROWS, TEST_ROW_LEN);
+  k->interleave(actual, src, TEST_ROWS, TEST_ROW_LEN);
+
+  /* second row: even positions from first half, odd from second half */
+  assert_int_equal(expected[TEST_ROW_LEN + 4], src[TEST_ROW_LEN + 2]);
+  assert_int_equal(expected[TEST_ROW_LEN + 5], src[TEST_ROW_LEN + half + 2]);
+  assert_int_equal(expected[TEST_ROW_LEN - 1], src[TEST_ROW_LEN - 1]);
+  assert_memory_equal(expected, actual, sizeof(expected));
+}
+
+void frame_kernels_stats_test(void **state)
+{
+  const struct frame_kernels *k = frame_kernels_get();
+  uint16_t buf[TEST_VALUES];
+  struct frame_stats expected, actual;
+  const uint16_t flat[] = { 10, 20, 30, 40 };
+
+  frame_kernels_scalar.stats(flat, 4, &expected);
+  assert_true(expected.mean == 25.0);
+  assert_true(expected.variance == 125.0);
+  assert_int_equal(expected.min, 10);
+  assert_int_equal(expected.max, 40);
+
+  fill_test_frame(buf, TEST_VALUES);
+
+  frame_kernels_scalar.stats(buf, TEST_VALUES, &expected);
+  k->stats(buf, TEST_VALUES, &actual);
+
+  assert_true(expected.mean == actual.mean);
+  assert_true(expected.variance == actual.variance);
+  assert_int_equal(expected.min, INT16_MIN);
+  assert_int_equal(expected.max, INT16_MAX);
+  assert_int_equal(expected.min, actual.min);
+  assert_int_equal(expected.max, actual.max);
+}
@@ -0,0 +1,92 @@
+//------------------------------------------------------------------------------
+/// \file   test_io_stats.c
+/// \brief  Tests against libmaxtouch/io_stats.h
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/io_stats.h"
+#include "run_unit_tests.h"
+
+void io_stats_test(void **state)
+{
+  struct mxt_device mxt;
+  struct mxt_io_stats stats;
+  struct mxt_io_op_stats *read;
+  uint64_t now;
+  int i;
+
+  memset(&mxt, 0, sizeof(mxt));
+
+  /* Ninety fast reads and ten which took over a second */
+  now = mxt_io_time_us();
+  for (i = 0; i < 90; i++)
+    mxt_io_stats_record(&mxt, MXT_IO_READ, 10, now, MXT_SUCCESS);
+
+  now = mxt_io_time_us();
+  for (i = 0; i < 10; i++)
+    mxt_io_stats_record(&mxt, MXT_IO_READ, 10, now - 1500000, MXT_SUCCESS);
+
+  mxt_io_stats_record(&mxt, MXT_IO_WRITE, 4, mxt_io_time_us(), MXT_ERROR_TIMEOUT);
+  mxt_io_stats_record(&mxt, MXT_IO_WRITE, 4, mxt_io_time_us(), MXT_ERROR_IO);
+  mxt_io_stats_record(&mxt, MXT_IO_MSG, 0, mxt_io_time_us(), MXT_ERROR_NO_MESSAGE);
+
+  mxt_get_io_stats(&mxt, &stats);
+  read = &stats.ops[MXT_IO_READ];
+
+  assert_int_equal(read->transactions, 100);
+  assert_int_equal(read->bytes, 1000);
+  assert_int_equal(read->errors, 0);
+  assert_true(read->max_us >= 1500000);
+  assert_true(read->hist[21] >= 10);
+
+  /* Percentiles give the upper bound of the bucket they fall in */
+  assert_true(mxt_io_stats_percentile(read, 50) <= 1024);
+  assert_int_equal(mxt_io_stats_percentile(read, 99), 1 << 21);
+
+  /* Failed transfers are counted but their bytes are not */
+  assert_int_equal(stats.ops[MXT_IO_WRITE].transactions, 2);
+  assert_int_equal(stats.ops[MXT_IO_WRITE].bytes, 0);
+  assert_int_equal(stats.ops[MXT_IO_WRITE].timeouts, 1);
+  assert_int_equal(stats.ops[MXT_IO_WRITE].errors, 1);
+
+  /* An empty message queue is not an error */
+  assert_int_equal(stats.ops[MXT_IO_MSG].errors, 0);
+
+  mxt_reset_io_stats(&mxt);
+  mxt_get_io_stats(&mxt, &stats);
+  assert_int_equal(stats.ops[MXT_IO_READ].transactions, 0);
+  assert_int_equal(mxt_io_stats_percentile(&stats.ops[MXT_IO_READ], 50), 0);
+}
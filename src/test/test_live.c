@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------
+/// \file   test_live.c
+/// \brief  Live heatmap tests
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "mxt-app/mxt_app.h"
+#include "mxt-app/live.h"
+#include "run_unit_tests.h"
+
+#define LIVE_TEST_X  2
+#define LIVE_TEST_Y  3
+
+/* Render one frame, returning what was written to the terminal */
+static char *live_test_render(struct live_ctx *live, struct t37_ctx *ctx)
+{
+  char *out = NULL;
+  size_t len = 0;
+
+  live->out = open_memstream(&out, &len);
+  assert_non_null(live->out);
+  assert_int_equal(live_render(live, ctx), MXT_SUCCESS);
+  fclose(live->out);
+  ctx->frame++;
+
+  return out;
+}
+
+void live_render_test(void **state)
+{
+  uint16_t data[LIVE_TEST_X * LIVE_TEST_Y] = { 0, 5, 0xFFFB, 0, 0, 0 };
+  struct live_ctx live;
+  struct t37_ctx ctx;
+  char *out;
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.mode = DELTAS_MODE;
+  ctx.x_size = LIVE_TEST_X;
+  ctx.y_size = LIVE_TEST_Y;
+  ctx.data_values = LIVE_TEST_X * LIVE_TEST_Y;
+  ctx.data_buf = data;
+  ctx.frame = 1;
+
+  assert_int_equal(live_init(&live, &ctx, NULL), MXT_SUCCESS);
+
+  /* First frame draws labels and every cell on a symmetric delta scale */
+  out = live_test_render(&live, &ctx);
+  assert_non_null(strstr(out, "\033[2J"));
+  assert_non_null(strstr(out, "scale -32 to 32"));
+  assert_non_null(strstr(out, "\033[3;11H"));
+  assert_non_null(strstr(out, "   -5"));
+  assert_int_equal(live.scale_min, -32);
+  assert_int_equal(live.scale_max, 32);
+  free(out);
+
+  /* Unchanged frame writes nothing */
+  out = live_test_render(&live, &ctx);
+  assert_string_equal(out, "");
+  free(out);
+
+  /* Only the changed cell is rewritten, in place */
+  data[4] = 7;
+  out = live_test_render(&live, &ctx);
+  assert_non_null(strstr(out, "\033[4;11H"));
+  assert_non_null(strstr(out, "    7"));
+  assert_null(strstr(out, "\033[2J"));
+  assert_null(strstr(out, "\033[3;6H"));
+  free(out);
+
+  /* Out of scale value widens it and redraws */
+  data[0] = 100;
+  out = live_test_render(&live, &ctx);
+  assert_non_null(strstr(out, "\033[2J"));
+  assert_true(live.scale_max >= 100);
+  assert_int_equal(live.scale_min, -live.scale_max);
+  free(out);
+
+  live_free(&live);
+}
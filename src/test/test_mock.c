@@ -0,0 +1,328 @@
+//------------------------------------------------------------------------------
+/// \file   test_mock.c
+/// \brief  Tests against libmaxtouch/mock/mock_device.h
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/crc.h"
+#include "libmaxtouch/utilfuncs.h"
+#include "run_unit_tests.h"
+
+#define TEST_T5_ADDR  0x101
+#define TEST_T6_ADDR  0x10B
+#define TEST_T7_ADDR  0x111
+
+/* Object table: type, address, size - 1, instances - 1, report IDs */
+static const uint8_t test_objects[] = {
+  SPT_MESSAGECOUNT_T44,       0x00, 0x01, 0, 0, 0,
+  GEN_MESSAGEPROCESSOR_T5,    0x01, 0x01, 9, 0, 0,
+  GEN_COMMANDPROCESSOR_T6,    0x0B, 0x01, 5, 0, 1,
+  GEN_POWERCONFIG_T7,         0x11, 0x01, 3, 0, 0,
+  TOUCH_MULTITOUCHSCREEN_T100, 0x15, 0x01, 9, 0, 2,
+  SPT_SELFTEST_T25,           0x1F, 0x01, 5, 0, 1,
+};
+
+/* Two T100 messages read after T44, due as soon as the device is opened */
+static const char test_trace[] =
+  "100.000000 RX 0000 7: A4 01 10 AA 08 06 05 \n"
+  "100.000000 RX 0100 10: 01 03 00 00 10 00 20 00 00 00 \n"
+  "100.000000 RX 0100 10: 02 03 01 00 10 00 20 00 00 00 \n";
+
+char *test_write_temp_file(const void *data, size_t len)
+{
+  char *filename = strdup("/tmp/test_mock_XXXXXX");
+  int fd;
+
+  assert_non_null(filename);
+
+  fd = mkstemp(filename);
+  assert_true(fd >= 0);
+  assert_int_equal(write(fd, data, len), (ssize_t)len);
+  close(fd);
+
+  return filename;
+}
+
+char *test_write_mock_info(void)
+{
+  uint8_t info[7 + sizeof(test_objects) + 3] = { 0xA4, 0x01, 0x10, 0xAA, 8, 6 };
+  uint32_t crc;
+
+  info[6] = sizeof(test_objects) / sizeof(struct mxt_object);
+  memcpy(info + 7, test_objects, sizeof(test_objects));
+
+  crc = mxt_crc24(info, 7 + sizeof(test_objects));
+  info[7 + sizeof(test_objects)] = crc & 0xFF;
+  info[8 + sizeof(test_objects)] = (crc >> 8) & 0xFF;
+  info[9 + sizeof(test_objects)] = (crc >> 16) & 0xFF;
+
+  return test_write_temp_file(info, sizeof(info));
+}
+
+struct mxt_device *test_open_mock(struct libmaxtouch_ctx *ctx,
+                                 char *info_file, char *msg_file)
+{
+  struct mxt_conn_info *conn;
+  struct mxt_device *mxt;
+
+  assert_int_equal(mxt_new_conn(&conn, E_MOCK), MXT_SUCCESS);
+  conn->mock.info_file = strdup(info_file);
+  conn->mock.msg_file = msg_file ? strdup(msg_file) : NULL;
+
+  assert_int_equal(mxt_new_device(ctx, conn, &mxt), MXT_SUCCESS);
+  mxt_unref_conn(conn);
+
+  assert_int_equal(mxt_get_info(mxt), MXT_SUCCESS);
+
+  return mxt;
+}
+
+void mock_register_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_device *mxt;
+  char *info_file = test_write_mock_info();
+  const uint8_t t7[4] = { 50, 255, 10, 0 };
+  uint8_t buf[10];
+  uint8_t calibrate = 1;
+  int count;
+
+  assert_int_equal(mxt_new(&ctx), MXT_SUCCESS);
+  mxt = test_open_mock(ctx, info_file, NULL);
+
+  assert_int_equal(mxt_get_object_address(mxt, GEN_POWERCONFIG_T7, 0),
+                   TEST_T7_ADDR);
+
+  /* Writes are kept in the register map */
+  assert_int_equal(mxt_write_register(mxt, t7, TEST_T7_ADDR, sizeof(t7)),
+                   MXT_SUCCESS);
+  assert_int_equal(mxt_read_register(mxt, buf, TEST_T7_ADDR, sizeof(t7)),
+                   MXT_SUCCESS);
+  assert_memory_equal(buf, t7, sizeof(t7));
+
+  /* Nothing is pending until a command is sent */
+  assert_int_equal(mxt_get_msg_count(mxt, &count), MXT_SUCCESS);
+  assert_int_equal(count, 0);
+
+  /* Calibrate reports the CAL status bit and then clears it */
+  assert_int_equal(mxt_write_register(mxt, &calibrate,
+                                      TEST_T6_ADDR + MXT_T6_CALIBRATE_OFFSET, 1),
+                   MXT_SUCCESS);
+  assert_int_equal(mxt_get_msg_count(mxt, &count), MXT_SUCCESS);
+  assert_int_equal(count, 2);
+
+  assert_int_equal(mxt_read_register(mxt, buf, TEST_T5_ADDR, 9), MXT_SUCCESS);
+  assert_int_equal(buf[0], 1);
+  assert_int_equal(buf[1], 0x10);
+  assert_int_equal(mxt_read_register(mxt, buf, TEST_T5_ADDR, 9), MXT_SUCCESS);
+  assert_int_equal(buf[0], 1);
+  assert_int_equal(buf[1], 0);
+
+  /* An empty queue gives an invalid report ID */
+  assert_int_equal(mxt_read_register(mxt, buf, TEST_T5_ADDR, 9), MXT_SUCCESS);
+  assert_int_equal(buf[0], 0xFF);
+
+  mxt_free_device(mxt);
+  mxt_free(ctx);
+  unlink(info_file);
+  free(info_file);
+}
+
+void mock_replay_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_device *mxt;
+  char *info_file = test_write_mock_info();
+  char *msg_file = test_write_temp_file(test_trace, strlen(test_trace));
+  uint8_t buf[9];
+  int count;
+
+  assert_int_equal(mxt_new(&ctx), MXT_SUCCESS);
+  mxt = test_open_mock(ctx, info_file, msg_file);
+
+  assert_int_equal(mxt_get_msg_count(mxt, &count), MXT_SUCCESS);
+  assert_int_equal(count, 2);
+
+  /* Recorded messages come back in order, without the T5 CRC byte */
+  assert_int_equal(mxt_read_register(mxt, buf, TEST_T5_ADDR, sizeof(buf)),
+                   MXT_SUCCESS);
+  assert_int_equal(buf[0], 3);
+  assert_int_equal(buf[1], 0);
+  assert_int_equal(mxt_read_register(mxt, buf, TEST_T5_ADDR, sizeof(buf)),
+                   MXT_SUCCESS);
+  assert_int_equal(buf[0], 3);
+  assert_int_equal(buf[1], 1);
+
+  assert_int_equal(mxt_get_msg_count(mxt, &count), MXT_SUCCESS);
+  assert_int_equal(count, 0);
+
+  mxt_free_device(mxt);
+  mxt_free(ctx);
+  unlink(msg_file);
+  free(msg_file);
+  unlink(info_file);
+  free(info_file);
+}
+
+void mock_msg_timestamp_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_device *mxt;
+  char *info_file = test_write_mock_info();
+  struct mxt_msg msgs[MXT_MSG_BATCH_SIZE];
+  uint8_t calibrate = 1;
+  uint64_t before, after;
+  int count;
+
+  assert_int_equal(mxt_new(&ctx), MXT_SUCCESS);
+  mxt = test_open_mock(ctx, info_file, NULL);
+
+  assert_int_equal(mxt_write_register(mxt, &calibrate,
+                                      TEST_T6_ADDR + MXT_T6_CALIBRATE_OFFSET, 1),
+                   MXT_SUCCESS);
+
+  /* Each message is stamped with the monotonic time of its T5 read */
+  before = mxt_time_ns();
+  assert_int_equal(mxt_get_msgs_batch(mxt, msgs, MXT_MSG_BATCH_SIZE, &count),
+                   MXT_SUCCESS);
+  after = mxt_time_ns();
+
+  assert_int_equal(count, 2);
+  assert_true(msgs[0].timestamp_ns >= before);
+  assert_true(msgs[1].timestamp_ns >= msgs[0].timestamp_ns);
+  assert_true(msgs[1].timestamp_ns <= after);
+
+  mxt_free_device(mxt);
+  mxt_free(ctx);
+  unlink(info_file);
+  free(info_file);
+}
+
+void mock_session_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_device *mxt;
+  char *info_file = test_write_mock_info();
+  const uint8_t t7[4] = { 32, 10, 50, 0 };
+  uint8_t buf[4];
+
+  assert_int_equal(mxt_new(&ctx), MXT_SUCCESS);
+  mxt = test_open_mock(ctx, info_file, NULL);
+
+  /* Sessions nest and transfers work normally inside them */
+  assert_int_equal(mxt_session_begin(mxt), MXT_SUCCESS);
+  assert_int_equal(mxt_session_begin(mxt), MXT_SUCCESS);
+  assert_int_equal(mxt_write_register(mxt, t7, TEST_T7_ADDR, sizeof(t7)),
+                   MXT_SUCCESS);
+  assert_int_equal(mxt_session_end(mxt), MXT_SUCCESS);
+  assert_int_equal(mxt->mxt_crc.session_depth, 1);
+  assert_int_equal(mxt_read_register(mxt, buf, TEST_T7_ADDR, sizeof(buf)),
+                   MXT_SUCCESS);
+  assert_memory_equal(buf, t7, sizeof(t7));
+  assert_int_equal(mxt_session_end(mxt), MXT_SUCCESS);
+  assert_int_equal(mxt->mxt_crc.session_depth, 0);
+
+  /* Unbalanced end is rejected */
+  assert_int_equal(mxt_session_end(mxt), MXT_ERROR_BAD_INPUT);
+
+  mxt_free_device(mxt);
+  mxt_free(ctx);
+  unlink(info_file);
+  free(info_file);
+}
+
+void mock_command_wait_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_device *mxt;
+  char *info_file = test_write_mock_info();
+  uint64_t start_us;
+  uint8_t backup;
+
+  assert_int_equal(mxt_new(&ctx), MXT_SUCCESS);
+  mxt = test_open_mock(ctx, info_file, NULL);
+
+  /* Reset finishes on the T6 status, not the fixed reset time */
+  start_us = mxt_io_time_us();
+  assert_int_equal(mxt_reset_chip(mxt, false, 0), MXT_SUCCESS);
+  assert_true(mxt_io_time_us() - start_us < MXT_SOFT_RESET_TIME * 1000 / 2);
+
+  /* Backup returns once the device has cleared the command */
+  assert_int_equal(mxt_backup_config(mxt, BACKUPNV_COMMAND), MXT_SUCCESS);
+  assert_int_equal(mxt_read_register(mxt, &backup,
+                                     TEST_T6_ADDR + MXT_T6_BACKUPNV_OFFSET, 1),
+                   MXT_SUCCESS);
+  assert_int_equal(backup, 0);
+
+  assert_int_equal(mxt_calibrate_chip(mxt), MXT_SUCCESS);
+
+  mxt_free_device(mxt);
+  mxt_free(ctx);
+  unlink(info_file);
+  free(info_file);
+}
+
+void mock_info_read_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_device *mxt;
+  struct mxt_io_stats stats;
+  char *info_file = test_write_mock_info();
+  char *msg_file = test_write_temp_file(test_trace, strlen(test_trace));
+  int count;
+
+  assert_int_equal(mxt_new(&ctx), MXT_SUCCESS);
+  mxt = test_open_mock(ctx, info_file, msg_file);
+
+  /* The ID information is read once, then the object table and CRC */
+  mxt_get_io_stats(mxt, &stats);
+  assert_int_equal(stats.ops[MXT_IO_READ].transactions, 2);
+  assert_int_equal(stats.ops[MXT_IO_READ].bytes,
+                   7 + sizeof(test_objects) + 3);
+
+  /* Nothing past the table is read, so no message has been taken */
+  assert_int_equal(mxt_get_msg_count(mxt, &count), MXT_SUCCESS);
+  assert_int_equal(count, 2);
+
+  mxt_free_device(mxt);
+  mxt_free(ctx);
+  unlink(msg_file);
+  free(msg_file);
+  unlink(info_file);
+  free(info_file);
+}
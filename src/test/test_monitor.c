@@ -0,0 +1,90 @@
+//------------------------------------------------------------------------------
+/// \file   test_monitor.c
+/// \brief  Tests against mxt-app/monitor.h
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+
+#include "mxt-app/monitor.h"
+#include "run_unit_tests.h"
+
+#define TEST_X  6
+#define TEST_Y  5
+
+static void fill_monitor_frame(uint16_t *data, int sample)
+{
+  int i;
+
+  /* Small repeatable noise around a fixed level */
+  for (i = 0; i < TEST_X * TEST_Y; i++)
+    data[i] = (uint16_t)(int16_t)(100 + ((i + sample) % 3) - 1);
+}
+
+void monitor_update_test(void **state)
+{
+  struct monitor_ctx mon;
+  uint16_t data[TEST_X * TEST_Y];
+  int events = 0;
+  int i;
+
+  assert_int_equal(monitor_init(&mon, TEST_X, TEST_Y, 8, 6), 0);
+
+  /* No events while the baseline is built or while the data is steady */
+  for (i = 0; i < 20; i++) {
+    fill_monitor_frame(data, i);
+    events += monitor_update(&mon, data);
+  }
+  assert_int_equal(events, 0);
+
+  /* A large negative delta on one node is reported once, with its lines */
+  fill_monitor_frame(data, 20);
+  data[2 * TEST_Y + 3] = (uint16_t)(int16_t)-200;
+  events = monitor_update(&mon, data);
+  assert_true(mon.node.out[2 * TEST_Y + 3]);
+  assert_true(mon.xline.out[2]);
+  assert_true(mon.yline.out[3]);
+  assert_int_equal(events, 3);
+
+  fill_monitor_frame(data, 21);
+  data[2 * TEST_Y + 3] = (uint16_t)(int16_t)-200;
+  assert_int_equal(monitor_update(&mon, data), 0);
+
+  /* The fault was kept out of the statistics, so recovery is reported */
+  fill_monitor_frame(data, 22);
+  assert_int_equal(monitor_update(&mon, data), 3);
+  assert_false(mon.node.out[2 * TEST_Y + 3]);
+
+  monitor_free(&mon);
+  assert_null(mon.node.mean);
+}
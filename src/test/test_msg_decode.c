@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------
+/// \file   test_msg_decode.c
+/// \brief  Unit tests for report ID dispatch and message decoding
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/info_block.h"
+#include "run_unit_tests.h"
+
+/* Report IDs: T6 1, T9 2-3 for each of two instances, T100 6-9 */
+static struct mxt_object decode_objects[] = {
+  { GEN_COMMANDPROCESSOR_T6,     0x00, 0x01, 5, 0, 1 },
+  { GEN_POWERCONFIG_T7,          0x06, 0x01, 3, 0, 0 },
+  { TOUCH_MULTITOUCHSCREEN_T9,   0x0A, 0x01, 9, 1, 2 },
+  { TOUCH_MULTITOUCHSCREEN_T100, 0x1E, 0x01, 9, 0, 4 },
+};
+
+void msg_decode_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_device mxt;
+  struct mxt_id_info id = { .num_objects = 4 };
+  struct mxt_decoded_msg dec;
+  char buf[32];
+  const uint8_t t6[] = { 1, 0x90, 0x56, 0x34, 0x12 };
+  const uint8_t t9[] = { 5, 0xC0, 0x12, 0x34, 0x56, 0x08, 0x20 };
+  const uint8_t t100_screen[] = { 6, 0x81 };
+  const uint8_t t100_touch[] = { 9, 0x94, 0x34, 0x12, 0x78, 0x05, 0xAA };
+  const uint8_t unknown[] = { 10, 0x00 };
+
+  assert_int_equal(mxt_new(&ctx), MXT_SUCCESS);
+  memset(&mxt, 0, sizeof(mxt));
+  mxt.ctx = ctx;
+  mxt.info.id = &id;
+  mxt.info.objects = decode_objects;
+  assert_int_equal(mxt_calc_report_ids(&mxt), MXT_SUCCESS);
+  assert_int_equal(mxt.info.max_report_id, 10);
+
+  assert_int_equal(mxt_decode_msg(&mxt, t6, sizeof(t6), &dec), MXT_SUCCESS);
+  assert_int_equal(dec.kind, MXT_MSG_T6_STATUS);
+  assert_int_equal(dec.t6.status, MXT_T6_STATUS_RESET | MXT_T6_STATUS_CAL);
+  assert_int_equal(dec.t6.config_crc, 0x123456);
+
+  /* Second instance of T9, second touch */
+  assert_int_equal(mxt_decode_msg(&mxt, t9, sizeof(t9), &dec), MXT_SUCCESS);
+  assert_int_equal(dec.kind, MXT_MSG_TOUCH);
+  assert_int_equal(dec.object_type, TOUCH_MULTITOUCHSCREEN_T9);
+  assert_int_equal(dec.instance, 1);
+  assert_int_equal(dec.touch.id, 1);
+  assert_true(dec.touch.detect);
+  assert_int_equal(dec.touch.x, 0x125);
+  assert_int_equal(dec.touch.y, 0x346);
+  assert_int_equal(dec.touch.aux_size, 2);
+
+  assert_int_equal(mxt_decode_msg(&mxt, t100_screen, sizeof(t100_screen), &dec),
+                   MXT_SUCCESS);
+  assert_int_equal(dec.kind, MXT_MSG_T100_SCREEN);
+  assert_int_equal(dec.t100_screen_status, 0x81);
+
+  /* Report index 3 is the second touch after screen status and reserved */
+  assert_int_equal(mxt_decode_msg(&mxt, t100_touch, sizeof(t100_touch), &dec),
+                   MXT_SUCCESS);
+  assert_int_equal(dec.kind, MXT_MSG_TOUCH);
+  assert_int_equal(dec.touch.id, 1);
+  assert_true(dec.touch.detect);
+  assert_int_equal(dec.touch.type, 1);
+  assert_int_equal(dec.touch.status, 4);
+  assert_int_equal(dec.touch.x, 0x1234);
+  assert_int_equal(dec.touch.y, 0x0578);
+  assert_int_equal(dec.touch.aux_size, 1);
+  assert_int_equal(dec.touch.aux[0], 0xAA);
+
+  /* Too short for T100, and a report ID outside the table */
+  assert_int_equal(mxt_decode_msg(&mxt, t100_touch, 4, &dec), MXT_ERROR_NO_MESSAGE);
+  assert_int_equal(mxt_decode_msg(&mxt, unknown, sizeof(unknown), &dec),
+                   MXT_ERROR_NO_MESSAGE);
+  assert_null(mxt_report_id_lookup(&mxt, 0));
+
+  assert_int_equal(mxt_format_msg_hex(buf, sizeof(buf), t6, sizeof(t6)),
+                   strlen(MSG_PREFIX "01 90 56 34 12 "));
+  assert_string_equal(buf, MSG_PREFIX "01 90 56 34 12 ");
+
+  /* Output is truncated to whole bytes */
+  mxt_format_msg_hex(buf, sizeof(MSG_PREFIX) + 4, t6, sizeof(t6));
+  assert_string_equal(buf, MSG_PREFIX "01 ");
+
+  free(mxt.report_id_map);
+  mxt_free(ctx);
+}
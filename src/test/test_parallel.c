@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------------
+/// \file   test_parallel.c
+/// \brief  Unit tests for running a command on several devices
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/info_block.h"
+#include "mxt-app/mxt_app.h"
+#include "run_unit_tests.h"
+
+#define TEST_PARALLEL_DEVICES  4
+#define TEST_PARALLEL_READS    50
+
+static int test_log_lines;
+
+static void test_parallel_log(struct libmaxtouch_ctx *ctx,
+                              enum mxt_log_level level,
+                              const char *format, va_list args)
+{
+  /* Called with the context lock held, so no atomics are needed */
+  test_log_lines++;
+}
+
+static int test_parallel_run(struct mxt_device *mxt, int index, void *context)
+{
+  int *reads = context;
+  uint8_t buf[4];
+  uint16_t addr = mxt_get_object_address(mxt, GEN_POWERCONFIG_T7, 0);
+  int i;
+
+  for (i = 0; i < TEST_PARALLEL_READS; i++) {
+    if (mxt_read_register(mxt, buf, addr, sizeof(buf)))
+      return MXT_ERROR_IO;
+
+    mxt_info(mxt->ctx, "device %d read %d", index, i);
+    reads[index]++;
+  }
+
+  /* One device fails, the others must still complete */
+  return (index == 1) ? MXT_ERROR_NOT_SUPPORTED : MXT_SUCCESS;
+}
+
+static int test_parallel_report(struct mxt_device *mxt, int index,
+                                void *context, int ret)
+{
+  int *reads = context;
+
+  assert_int_equal(reads[index], TEST_PARALLEL_READS);
+
+  return ret;
+}
+
+void parallel_run_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_conn_info *conns[TEST_PARALLEL_DEVICES];
+  const char *names[TEST_PARALLEL_DEVICES] = { "a", "b", "c", "d" };
+  int reads[TEST_PARALLEL_DEVICES] = { 0 };
+  char *info_file = test_write_mock_info();
+  FILE *fp;
+  int i;
+
+  assert_int_equal(mxt_new(&ctx), MXT_SUCCESS);
+  mxt_set_log_fn(ctx, test_parallel_log);
+  ctx->log_level = LOG_INFO;
+  assert_int_equal(mxt_trace_enable(ctx, 16), MXT_SUCCESS);
+
+  for (i = 0; i < TEST_PARALLEL_DEVICES; i++) {
+    assert_int_equal(mxt_new_conn(&conns[i], E_MOCK), MXT_SUCCESS);
+    conns[i]->mock.info_file = strdup(info_file);
+  }
+
+  /* The shared context logs and traces from every worker */
+  assert_int_equal(mxt_run_parallel(ctx, conns, names, TEST_PARALLEL_DEVICES,
+                                    test_parallel_run, test_parallel_report,
+                                    reads),
+                   MXT_ERROR_NOT_SUPPORTED);
+
+  for (i = 0; i < TEST_PARALLEL_DEVICES; i++)
+    assert_int_equal(reads[i], TEST_PARALLEL_READS);
+
+  assert_true(test_log_lines >= TEST_PARALLEL_DEVICES * TEST_PARALLEL_READS);
+
+  fp = fopen("/dev/null", "w");
+  assert_non_null(fp);
+  assert_int_equal(mxt_trace_dump(ctx, fp), MXT_SUCCESS);
+  fclose(fp);
+
+  mxt_free(ctx);
+  unlink(info_file);
+  free(info_file);
+}
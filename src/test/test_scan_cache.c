@@ -0,0 +1,105 @@
+//------------------------------------------------------------------------------
+/// \file   test_scan_cache.c
+/// \brief  Tests against libmaxtouch/scan_cache.h
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "libmaxtouch/scan_cache.h"
+#include "run_unit_tests.h"
+
+/* Info block bytes read while opening the mock device */
+static uint64_t info_bytes_read(struct libmaxtouch_ctx *ctx, char *info_file,
+                                int *num_objects)
+{
+  struct mxt_device *mxt;
+  struct mxt_io_stats stats;
+
+  mxt = test_open_mock(ctx, info_file, NULL);
+  mxt_get_io_stats(mxt, &stats);
+  *num_objects = mxt->info.id->num_objects;
+  mxt_free_device(mxt);
+
+  return stats.ops[MXT_IO_READ].bytes;
+}
+
+void scan_cache_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_conn_info *conn = NULL;
+  char *info_file = test_write_mock_info();
+  char *cache_file = test_write_temp_file("", 0);
+  int num_objects;
+  FILE *fp;
+
+  assert_int_equal(mxt_new(&ctx), MXT_SUCCESS);
+  ctx->scan_cache_file = cache_file;
+
+  /* An empty file is ignored, and replaced after a full read */
+  assert_true(info_bytes_read(ctx, info_file, &num_objects)
+              > sizeof(struct mxt_id_info));
+  assert_int_equal(num_objects, 6);
+
+  /* Later opens only read the ID information */
+  assert_int_equal(info_bytes_read(ctx, info_file, &num_objects),
+                   sizeof(struct mxt_id_info));
+  assert_int_equal(num_objects, 6);
+
+  /* A damaged cache is not used */
+  mxt_scan_cache_free(ctx);
+  fp = fopen(cache_file, "r+");
+  assert_non_null(fp);
+  assert_int_equal(fseek(fp, -5, SEEK_END), 0);
+  fputs("00", fp);
+  fclose(fp);
+
+  assert_true(info_bytes_read(ctx, info_file, &num_objects)
+              > sizeof(struct mxt_id_info));
+
+  /* Only devices which mxt_scan() finds are handed back from the cache */
+  mxt_scan_cache_free(ctx);
+  assert_int_equal(mxt_scan_cache_conn(ctx, &conn), MXT_ERROR_NOT_SUPPORTED);
+  assert_null(conn);
+
+  mxt_scan_cache_invalidate(ctx);
+  assert_int_not_equal(access(cache_file, F_OK), 0);
+
+  mxt_free(ctx);
+  unlink(info_file);
+  free(info_file);
+  free(cache_file);
+}
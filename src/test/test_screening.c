@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------------
+/// \file   test_screening.c
+/// \brief  Tests against mxt-app/screening.h
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "mxt-app/screening.h"
+#include "run_unit_tests.h"
+
+#define TEST_NODES 4
+
+void screening_combine_test(void **state)
+{
+  /* Node 0 has an outlier, node 2 is negative, node 3 needs rounding */
+  const int16_t frames[5][TEST_NODES] = {
+    { 100, 20, -10, 1 },
+    { 101, 20, -11, 2 },
+    { 102, 20, -12, 2 },
+    { 103, 20, -13, 1 },
+    { 900, 20, -14, 2 },
+  };
+  const int16_t mean[TEST_NODES] = { 261, 20, -12, 2 };
+  const int16_t median_odd[TEST_NODES] = { 102, 20, -12, 2 };
+  const int16_t median_even[TEST_NODES] = { 101, 20, -11, 1 };
+  uint16_t buf[5 * TEST_NODES];
+  uint16_t out[TEST_NODES];
+  int i;
+
+  memcpy(buf, frames, sizeof(buf));
+
+  assert_int_equal(screening_combine_frames(out, buf, 5, TEST_NODES, false),
+                   MXT_SUCCESS);
+  for (i = 0; i < TEST_NODES; i++)
+    assert_int_equal((int16_t)out[i], mean[i]);
+
+  assert_int_equal(screening_combine_frames(out, buf, 5, TEST_NODES, true),
+                   MXT_SUCCESS);
+  for (i = 0; i < TEST_NODES; i++)
+    assert_int_equal((int16_t)out[i], median_odd[i]);
+
+  assert_int_equal(screening_combine_frames(out, buf, 4, TEST_NODES, true),
+                   MXT_SUCCESS);
+  for (i = 0; i < TEST_NODES; i++)
+    assert_int_equal((int16_t)out[i], median_even[i]);
+
+  /* The input frames are left untouched */
+  assert_memory_equal(buf, frames, sizeof(buf));
+}
@@ -0,0 +1,74 @@
+//------------------------------------------------------------------------------
+/// \file   test_self_test.c
+/// \brief  Unit tests for self test scheduler
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "mxt-app/mxt_app.h"
+#include "run_unit_tests.h"
+
+void self_test_queue_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_device *mxt;
+  char *info_file = test_write_mock_info();
+  struct self_test_result results[3] = {
+    { .cmd = SELF_TEST_ANALOG },
+    { .cmd = SELF_TEST_PIN_FAULT },
+    { .cmd = SELF_TEST_SIGNAL_LIMIT },
+  };
+  int i;
+
+  assert_int_equal(mxt_new(&ctx), MXT_SUCCESS);
+  mxt = test_open_mock(ctx, info_file, NULL);
+
+  /* Every queued command is dispatched in turn and gets its own result */
+  assert_int_equal(mxt_self_test_run(mxt, results, 3, 0), MXT_SUCCESS);
+
+  for (i = 0; i < 3; i++) {
+    assert_int_equal(results[i].ret, MXT_SUCCESS);
+    assert_true(results[i].duration >= 0);
+    assert_true(results[i].duration < 10);
+  }
+
+  assert_int_equal(results[2].cmd, SELF_TEST_SIGNAL_LIMIT);
+
+  mxt_free_device(mxt);
+  mxt_free(ctx);
+  unlink(info_file);
+  free(info_file);
+}
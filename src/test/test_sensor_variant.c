@@ -295,3 +295,84 @@ void sensor_variant_algorithm_test(void **state)
   ret = sensor_variant_algorithm(&frame, &ts_info, &sv_opts);
   assert_int_equal(ret, MXT_SENSOR_VARIANT_DETECTED);
 }
+
+void polyfit_pinv_test(void **state)
+{
+  struct libmaxtouch_ctx ctx;
+  ctx.log_level = LOG_SILENT;
+  ctx.log_fn = mxt_log_stderr;
+
+  double xval[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+  double yval[] = { 7991, 7984, 7979, 7976, 7975, 7976, 7979, 7984, 7991, 8000 };
+  double pinv[3 * 10];
+  double coeff[3];
+  int i, k;
+
+  assert_true(ft_polyfit_pinv(&ctx, xval, 10, pinv));
+
+  for (i = 0; i < 3; i++) {
+    coeff[i] = 0;
+    for (k = 0; k < 10; k++)
+      coeff[i] += pinv[i * 10 + k] * yval[k];
+  }
+
+  assert_float_equal(coeff[0], 8000);
+  assert_float_equal(coeff[1], -10);
+  assert_float_equal(coeff[2], 1);
+}
+
+void sensor_variant_workspace_test(void **state)
+{
+  struct libmaxtouch_ctx ctx;
+  ctx.log_level = LOG_SILENT;
+  ctx.log_fn = mxt_log_stdout;
+
+  struct mxt_device mxt;
+  mxt.ctx = &ctx;
+
+  uint16_t data[38 * 23];
+  int x, y;
+
+  /* Smooth synthetic references, as data_buf_pass is altered above */
+  for (x = 0; x < 38; x++)
+    for (y = 0; y < 23; y++)
+      data[x * 23 + y] = 8000 + 10 * x - 5 * y + (x * y) / 4;
+
+  struct t37_ctx frame;
+  frame.mxt = &mxt;
+  frame.lc = &ctx;
+  frame.mode = REFS_MODE;
+  frame.x_size = 38;
+  frame.y_size = 23;
+  frame.data_buf = data;
+
+  struct sensor_variant_options sv_opts;
+  sv_opts.upper_limit = 15;
+  sv_opts.lower_limit = 15;
+  sv_opts.dualx = 0;
+  sv_opts.max_defects = 0;
+  sv_opts.matrix_size = 0;
+
+  struct sensor_variant_workspace ws;
+
+  /* Too few lines to fit */
+  assert_int_equal(sensor_variant_workspace_init(&ctx, &ws, 38, 2),
+                   MXT_ERROR_BAD_INPUT);
+
+  assert_int_equal(sensor_variant_workspace_init(&ctx, &ws, 38, 22),
+                   MXT_SUCCESS);
+
+  /* One workspace serves consecutive frames */
+  assert_int_equal(sensor_variant_run(&ws, &frame, &sv_opts), MXT_SUCCESS);
+
+  data[100] = 2000;
+  assert_int_equal(sensor_variant_run(&ws, &frame, &sv_opts),
+                   MXT_SENSOR_VARIANT_DETECTED);
+  assert_true(ws.status[100 / 23 * 22 + 100 % 23]);
+
+  data[100] = 8000 + 10 * 4 - 5 * 8 + (4 * 8) / 4;
+  assert_int_equal(sensor_variant_run(&ws, &frame, &sv_opts), MXT_SUCCESS);
+
+  sensor_variant_workspace_free(&ws);
+  assert_null(ws.pinv_x);
+}
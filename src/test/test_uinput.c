@@ -0,0 +1,164 @@
+//------------------------------------------------------------------------------
+/// \file   test_uinput.c
+/// \brief  uinput event batching tests
+//------------------------------------------------------------------------------
+// Copyright 2026 Microchip Corporation. All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//    1. Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//    2. Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY MICROCHIP ''AS IS'' AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+// MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+// EVENT SHALL MICROCHIP OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+// OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+// EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "libmaxtouch/libmaxtouch.h"
+#include "mxt-app/mxt_app.h"
+#include "mxt-app/uinput.h"
+#include "run_unit_tests.h"
+
+static void check_event(struct uinput_ctx *ui, int i, uint16_t type,
+                        uint16_t code, int32_t value)
+{
+  assert_true(i < ui->num_events);
+  assert_int_equal(ui->events[i].type, type);
+  assert_int_equal(ui->events[i].code, code);
+  assert_int_equal(ui->events[i].value, value);
+}
+
+void uinput_events_test(void **state)
+{
+  struct uinput_ctx ui;
+  struct mxt_touch touch;
+
+  assert_int_equal(uinput_ctx_init(&ui, 10, 1023, 767, 2, 2, 2), MXT_SUCCESS);
+
+  /* Nothing changed, no frame */
+  uinput_add_sync(&ui);
+  assert_int_equal(ui.num_events, 0);
+
+  /* First touch down, 12 bit T9 position scaled to the 10 bit range */
+  memset(&touch, 0, sizeof(touch));
+  touch.id = 3;
+  touch.detect = true;
+  touch.x = 400;
+  touch.y = 800;
+  uinput_add_touch(&ui, &touch);
+  uinput_add_sync(&ui);
+  assert_int_equal(ui.num_events, 8);
+  check_event(&ui, 0, EV_ABS, ABS_MT_SLOT, 3);
+  check_event(&ui, 1, EV_ABS, ABS_MT_TRACKING_ID, 0);
+  check_event(&ui, 2, EV_ABS, ABS_MT_POSITION_X, 100);
+  check_event(&ui, 3, EV_ABS, ABS_MT_POSITION_Y, 200);
+  check_event(&ui, 4, EV_KEY, BTN_TOUCH, 1);
+  check_event(&ui, 5, EV_ABS, ABS_X, 100);
+  check_event(&ui, 6, EV_ABS, ABS_Y, 200);
+  check_event(&ui, 7, EV_SYN, SYN_REPORT, 0);
+
+  /* Move in the same slot, slot not repeated */
+  ui.num_events = 0;
+  touch.x = 404;
+  uinput_add_touch(&ui, &touch);
+  uinput_add_sync(&ui);
+  assert_int_equal(ui.num_events, 5);
+  check_event(&ui, 0, EV_ABS, ABS_MT_POSITION_X, 101);
+  check_event(&ui, 4, EV_SYN, SYN_REPORT, 0);
+
+  /* Out of range slot and release of an idle slot are dropped */
+  ui.num_events = 0;
+  touch.id = 10;
+  uinput_add_touch(&ui, &touch);
+  touch.id = 5;
+  touch.detect = false;
+  uinput_add_touch(&ui, &touch);
+  assert_int_equal(ui.num_events, 0);
+
+  /* Release, then the frame ends with the pointer lifted */
+  touch.id = 3;
+  uinput_add_touch(&ui, &touch);
+  uinput_add_sync(&ui);
+  assert_int_equal(ui.num_events, 3);
+  check_event(&ui, 0, EV_ABS, ABS_MT_TRACKING_ID, -1);
+  check_event(&ui, 1, EV_KEY, BTN_TOUCH, 0);
+  check_event(&ui, 2, EV_SYN, SYN_REPORT, 0);
+
+  /* Batch is capped, leaving room for the sync */
+  ui.num_events = 0;
+  touch.detect = true;
+  for (touch.id = 0; touch.id < 4; touch.id++)
+    uinput_add_touch(&ui, &touch);
+  uinput_add_sync(&ui);
+  assert_true(ui.num_events <= ui.max_events);
+  check_event(&ui, ui.num_events - 1, EV_SYN, SYN_REPORT, 0);
+
+  uinput_ctx_free(&ui);
+}
+
+/* Ctrl-C arrives while the loop is waiting for messages */
+static void uinput_test_alarm(int signal_num)
+{
+  (void)signal_num;
+  raise(SIGINT);
+}
+
+void uinput_sigint_test(void **state)
+{
+  struct libmaxtouch_ctx *ctx;
+  struct mxt_device *mxt;
+  struct uinput_ctx ui;
+  struct sigaction sa, old_sa;
+  struct itimerval timer = { { 0, 0 }, { 0, 50000 } };
+  char *info_file = test_write_mock_info();
+
+  assert_int_equal(mxt_new(&ctx), MXT_SUCCESS);
+  mxt = test_open_mock(ctx, info_file, NULL);
+
+  assert_int_equal(uinput_ctx_init(&ui, 10, 4095, 4095, 0, 0, 2), MXT_SUCCESS);
+  ui.fd = -1;
+
+  sa.sa_handler = uinput_test_alarm;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = 0;
+  sigaction(SIGALRM, &sa, &old_sa);
+  setitimer(ITIMER_REAL, &timer, NULL);
+
+  /* Stopping with Ctrl-C is success, and the flag is cleared on release */
+  assert_int_equal(uinput_run(mxt, &ui, TOUCH_MULTITOUCHSCREEN_T100),
+                   MXT_SUCCESS);
+  assert_int_equal(mxt_sigint_rx, 0);
+
+  sigaction(SIGALRM, &old_sa, NULL);
+
+  uinput_ctx_free(&ui);
+  mxt_free_device(mxt);
+  mxt_free(ctx);
+  unlink(info_file);
+  free(info_file);
+}